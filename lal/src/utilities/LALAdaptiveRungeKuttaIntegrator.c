@@ -17,6 +17,11 @@
 *  MA  02111-1307  USA
 */
 
+#include <math.h>
+#include <float.h>
+#include <string.h>
+
+#include <lal/AVFactories.h>
 #include <lal/LALAdaptiveRungeKuttaIntegrator.h>
 
 #define XLAL_BEGINGSL \
@@ -28,6 +33,374 @@
           gsl_set_error_handler( saveGSLErrorHandler_ ); \
         }
 
+/* Stepping engine given to integrators created by XLALAdaptiveRungeKutta4Init();
+ * the inlined engines are opt-in through XLALAdaptiveRungeKuttaSetDefaultStepper() */
+static LALAdaptiveRungeKuttaStepper lalAdaptiveRungeKuttaDefaultStepper = LAL_ADAPTIVE_RK_STEPPER_GSL;
+
+/* Stages of the inlined steppers. The arrays have a fixed size so that the
+ * stage loops index them with compile-time strides, and are kept between
+ * steps for the dense output and for reusing the derivatives at the end of
+ * an accepted step as the first stage of the next one. */
+typedef struct tagLALAdaptiveRungeKuttaWork {
+    REAL8 k[7][LAL_ADAPTIVE_RK_MAX_DIM];        /* stages; k[0] holds the derivatives at the start of the step */
+    REAL8 y0[LAL_ADAPTIVE_RK_MAX_DIM];          /* state at the start of the step */
+    REAL8 ytmp[LAL_ADAPTIVE_RK_MAX_DIM];        /* state at which the next stage is evaluated */
+    REAL8 yerr[LAL_ADAPTIVE_RK_MAX_DIM];        /* error estimate, used by rk_evolve_apply() */
+    REAL8 dydt_in[LAL_ADAPTIVE_RK_MAX_DIM];     /* derivatives at the current state, used by rk_evolve_apply() */
+    REAL8 dydt_out[LAL_ADAPTIVE_RK_MAX_DIM];    /* derivatives at the end of the step, used by rk_evolve_apply() */
+    int have_dydt_in;                           /* whether dydt_in is current */
+} LALAdaptiveRungeKuttaWork;
+
+/* Runge-Kutta-Fehlberg 4(5) tableau, as in GSL rkf45.c */
+static const REAL8 rkf45_ah[] = { 1.0 / 4.0, 3.0 / 8.0, 12.0 / 13.0, 1.0, 1.0 / 2.0 };
+static const REAL8 rkf45_b3[] = { 3.0 / 32.0, 9.0 / 32.0 };
+static const REAL8 rkf45_b4[] = { 1932.0 / 2197.0, -7200.0 / 2197.0, 7296.0 / 2197.0 };
+static const REAL8 rkf45_b5[] = { 8341.0 / 4104.0, -32832.0 / 4104.0, 29440.0 / 4104.0, -845.0 / 4104.0 };
+static const REAL8 rkf45_b6[] = { -6080.0 / 20520.0, 41040.0 / 20520.0, -28352.0 / 20520.0, 9295.0 / 20520.0, -5643.0 / 20520.0 };
+static const REAL8 rkf45_c1 = 902880.0 / 7618050.0;
+static const REAL8 rkf45_c3 = 3953664.0 / 7618050.0;
+static const REAL8 rkf45_c4 = 3855735.0 / 7618050.0;
+static const REAL8 rkf45_c5 = -1371249.0 / 7618050.0;
+static const REAL8 rkf45_c6 = 277020.0 / 7618050.0;
+static const REAL8 rkf45_ec[] = { 0.0, 1.0 / 360.0, 0.0, -128.0 / 4275.0, -2197.0 / 75240.0, 1.0 / 50.0, 2.0 / 55.0 };
+
+/* Dormand-Prince 5(4) tableau and dense output coefficients, from
+ * E. Hairer, S. P. Norsett & G. Wanner, Solving Ordinary Differential Equations I, 2nd ed., Springer, 1993 */
+static const REAL8 dopri5_c[] = { 0.0, 1.0 / 5.0, 3.0 / 10.0, 4.0 / 5.0, 8.0 / 9.0, 1.0, 1.0 };
+static const REAL8 dopri5_a2[] = { 1.0 / 5.0 };
+static const REAL8 dopri5_a3[] = { 3.0 / 40.0, 9.0 / 40.0 };
+static const REAL8 dopri5_a4[] = { 44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0 };
+static const REAL8 dopri5_a5[] = { 19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0 };
+static const REAL8 dopri5_a6[] = { 9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0, -5103.0 / 18656.0 };
+static const REAL8 dopri5_b[] = { 35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0 };
+static const REAL8 dopri5_e[] = { 71.0 / 57600.0, 0.0, -71.0 / 16695.0, 71.0 / 1920.0, -17253.0 / 339200.0, 22.0 / 525.0, -1.0 / 40.0 };
+static const REAL8 dopri5_d[] = { -12715105075.0 / 11282082432.0, 0.0, 87487479700.0 / 32700410799.0, -10690763975.0 / 1880347072.0,
+    701980252875.0 / 199316789632.0, -1453857185.0 / 822651844.0, 69997945.0 / 29380423.0 };
+
+/* Local function taking one Runge-Kutta-Fehlberg step; same arithmetic as
+ * gsl_odeiv_step_apply() with gsl_odeiv_step_rkf45 */
+static int rkf45_apply(const LALAdaptiveRungeKuttaIntegrator * integrator, REAL8 t, REAL8 h, REAL8 * restrict y,
+    REAL8 * restrict yerr, const REAL8 * restrict dydt_in, REAL8 * restrict dydt_out)
+{
+    LALAdaptiveRungeKuttaWork *w = integrator->work;
+    const size_t dim = integrator->sys->dimension;
+    void *params = integrator->sys->params;
+    REAL8 *k1 = w->k[0], *k2 = w->k[1], *k3 = w->k[2], *k4 = w->k[3], *k5 = w->k[4], *k6 = w->k[5];
+    REAL8 *y0 = w->y0, *ytmp = w->ytmp;
+    size_t i;
+    int status;
+
+    memcpy(y0, y, dim * sizeof(REAL8));
+    memcpy(k1, dydt_in, dim * sizeof(REAL8));
+
+    for (i = 0; i < dim; i++)
+        ytmp[i] = y[i] + rkf45_ah[0] * h * k1[i];
+    if ((status = integrator->dydt(t + rkf45_ah[0] * h, ytmp, k2, params)) != GSL_SUCCESS)
+        return status;
+
+    for (i = 0; i < dim; i++)
+        ytmp[i] = y[i] + h * (rkf45_b3[0] * k1[i] + rkf45_b3[1] * k2[i]);
+    if ((status = integrator->dydt(t + rkf45_ah[1] * h, ytmp, k3, params)) != GSL_SUCCESS)
+        return status;
+
+    for (i = 0; i < dim; i++)
+        ytmp[i] = y[i] + h * (rkf45_b4[0] * k1[i] + rkf45_b4[1] * k2[i] + rkf45_b4[2] * k3[i]);
+    if ((status = integrator->dydt(t + rkf45_ah[2] * h, ytmp, k4, params)) != GSL_SUCCESS)
+        return status;
+
+    for (i = 0; i < dim; i++)
+        ytmp[i] = y[i] + h * (rkf45_b5[0] * k1[i] + rkf45_b5[1] * k2[i] + rkf45_b5[2] * k3[i] + rkf45_b5[3] * k4[i]);
+    if ((status = integrator->dydt(t + rkf45_ah[3] * h, ytmp, k5, params)) != GSL_SUCCESS)
+        return status;
+
+    for (i = 0; i < dim; i++)
+        ytmp[i] = y[i] + h * (rkf45_b6[0] * k1[i] + rkf45_b6[1] * k2[i] + rkf45_b6[2] * k3[i] + rkf45_b6[3] * k4[i] + rkf45_b6[4] * k5[i]);
+    if ((status = integrator->dydt(t + rkf45_ah[4] * h, ytmp, k6, params)) != GSL_SUCCESS)
+        return status;
+
+    for (i = 0; i < dim; i++)
+        y[i] += h * (rkf45_c1 * k1[i] + rkf45_c3 * k3[i] + rkf45_c4 * k4[i] + rkf45_c5 * k5[i] + rkf45_c6 * k6[i]);
+
+    if ((status = integrator->dydt(t + h, y, dydt_out, params)) != GSL_SUCCESS) {
+        memcpy(y, y0, dim * sizeof(REAL8));
+        return status;
+    }
+
+    for (i = 0; i < dim; i++)
+        yerr[i] = h * (rkf45_ec[1] * k1[i] + rkf45_ec[3] * k3[i] + rkf45_ec[4] * k4[i] + rkf45_ec[5] * k5[i] + rkf45_ec[6] * k6[i]);
+
+    return GSL_SUCCESS;
+}
+
+/* Local function taking one Dormand-Prince step; the derivatives at the end
+ * of the step are its seventh stage */
+static int dopri5_apply(const LALAdaptiveRungeKuttaIntegrator * integrator, REAL8 t, REAL8 h, REAL8 * restrict y,
+    REAL8 * restrict yerr, const REAL8 * restrict dydt_in, REAL8 * restrict dydt_out)
+{
+    LALAdaptiveRungeKuttaWork *w = integrator->work;
+    const size_t dim = integrator->sys->dimension;
+    void *params = integrator->sys->params;
+    REAL8 *k1 = w->k[0], *k2 = w->k[1], *k3 = w->k[2], *k4 = w->k[3], *k5 = w->k[4], *k6 = w->k[5], *k7 = w->k[6];
+    REAL8 *y0 = w->y0, *ytmp = w->ytmp;
+    size_t i;
+    int status;
+
+    memcpy(y0, y, dim * sizeof(REAL8));
+    memcpy(k1, dydt_in, dim * sizeof(REAL8));
+
+    for (i = 0; i < dim; i++)
+        ytmp[i] = y[i] + h * (dopri5_a2[0] * k1[i]);
+    if ((status = integrator->dydt(t + dopri5_c[1] * h, ytmp, k2, params)) != GSL_SUCCESS)
+        return status;
+
+    for (i = 0; i < dim; i++)
+        ytmp[i] = y[i] + h * (dopri5_a3[0] * k1[i] + dopri5_a3[1] * k2[i]);
+    if ((status = integrator->dydt(t + dopri5_c[2] * h, ytmp, k3, params)) != GSL_SUCCESS)
+        return status;
+
+    for (i = 0; i < dim; i++)
+        ytmp[i] = y[i] + h * (dopri5_a4[0] * k1[i] + dopri5_a4[1] * k2[i] + dopri5_a4[2] * k3[i]);
+    if ((status = integrator->dydt(t + dopri5_c[3] * h, ytmp, k4, params)) != GSL_SUCCESS)
+        return status;
+
+    for (i = 0; i < dim; i++)
+        ytmp[i] = y[i] + h * (dopri5_a5[0] * k1[i] + dopri5_a5[1] * k2[i] + dopri5_a5[2] * k3[i] + dopri5_a5[3] * k4[i]);
+    if ((status = integrator->dydt(t + dopri5_c[4] * h, ytmp, k5, params)) != GSL_SUCCESS)
+        return status;
+
+    for (i = 0; i < dim; i++)
+        ytmp[i] = y[i] + h * (dopri5_a6[0] * k1[i] + dopri5_a6[1] * k2[i] + dopri5_a6[2] * k3[i] + dopri5_a6[3] * k4[i] + dopri5_a6[4] * k5[i]);
+    if ((status = integrator->dydt(t + dopri5_c[5] * h, ytmp, k6, params)) != GSL_SUCCESS)
+        return status;
+
+    for (i = 0; i < dim; i++)
+        y[i] += h * (dopri5_b[0] * k1[i] + dopri5_b[2] * k3[i] + dopri5_b[3] * k4[i] + dopri5_b[4] * k5[i] + dopri5_b[5] * k6[i]);
+
+    if ((status = integrator->dydt(t + h, y, k7, params)) != GSL_SUCCESS) {
+        memcpy(y, y0, dim * sizeof(REAL8));
+        return status;
+    }
+    memcpy(dydt_out, k7, dim * sizeof(REAL8));
+
+    for (i = 0; i < dim; i++)
+        yerr[i] = h * (dopri5_e[0] * k1[i] + dopri5_e[2] * k3[i] + dopri5_e[3] * k4[i] + dopri5_e[4] * k5[i] + dopri5_e[5] * k6[i] + dopri5_e[6] * k7[i]);
+
+    return GSL_SUCCESS;
+}
+
+/* Local function taking one step with the engine of the integrator; same
+ * conventions as gsl_odeiv_step_apply(), except that dydt_in and dydt_out
+ * must both be given */
+static int rk_step_apply(LALAdaptiveRungeKuttaIntegrator * integrator, REAL8 t, REAL8 h, REAL8 * y, REAL8 * yerr,
+    const REAL8 * dydt_in, REAL8 * dydt_out)
+{
+    switch (integrator->stepper) {
+    case LAL_ADAPTIVE_RK_STEPPER_RKF45:
+        return rkf45_apply(integrator, t, h, y, yerr, dydt_in, dydt_out);
+    case LAL_ADAPTIVE_RK_STEPPER_DOPRI5:
+        return dopri5_apply(integrator, t, h, y, yerr, dydt_in, dydt_out);
+    default:
+        return gsl_odeiv_step_apply(integrator->step, t, h, y, yerr, dydt_in, dydt_out, integrator->sys);
+    }
+}
+
+/* Local function adjusting the step size after a step; the inlined
+ * engines use the rule of gsl_odeiv_control_y_new() for a stepper of
+ * order 5, the GSL engine calls gsl_odeiv_control_hadjust() */
+static int rk_control_hadjust(LALAdaptiveRungeKuttaIntegrator * integrator, const REAL8 * y, const REAL8 * yerr,
+    const REAL8 * dydt_out, REAL8 * h)
+{
+    const size_t dim = integrator->sys->dimension;
+    const REAL8 S = 0.9;
+    const REAL8 ord = 5.0;
+    const REAL8 h_old = *h;
+    REAL8 rmax = DBL_MIN;
+    size_t i;
+
+    if (integrator->stepper == LAL_ADAPTIVE_RK_STEPPER_GSL)
+        return gsl_odeiv_control_hadjust(integrator->control, integrator->step, y, yerr, dydt_out, h);
+
+    for (i = 0; i < dim; i++) {
+        const REAL8 D0 = integrator->eps_rel * fabs(y[i]) + integrator->eps_abs;
+        const REAL8 r = fabs(yerr[i]) / fabs(D0);
+        if (r > rmax)
+            rmax = r;
+    }
+
+    if (rmax > 1.1) {
+        /* decrease the step, by no more than a factor of 5 */
+        REAL8 r = S / pow(rmax, 1.0 / ord);
+        if (r < 0.2)
+            r = 0.2;
+        *h = r * h_old;
+        return GSL_ODEIV_HADJ_DEC;
+    } else if (rmax < 0.5) {
+        /* increase the step, by no more than a factor of 5 */
+        REAL8 r = S / pow(rmax, 1.0 / (ord + 1.0));
+        if (r > 5.0)
+            r = 5.0;
+        if (r < 1.0)
+            r = 1.0;
+        *h = r * h_old;
+        return GSL_ODEIV_HADJ_INC;
+    }
+
+    return GSL_ODEIV_HADJ_NIL;
+}
+
+/* Local function resetting the integrator at the start of an integration */
+static void rk_reset(LALAdaptiveRungeKuttaIntegrator * integrator)
+{
+    if (integrator->stepper == LAL_ADAPTIVE_RK_STEPPER_GSL) {
+        gsl_odeiv_step_reset(integrator->step);
+        gsl_odeiv_evolve_reset(integrator->evolve);
+    } else {
+        ((LALAdaptiveRungeKuttaWork *) integrator->work)->have_dydt_in = 0;
+    }
+}
+
+/* Local function advancing the solution by one accepted step, with the
+ * conventions of gsl_odeiv_evolve_apply(). The inlined engines evaluate the
+ * derivatives at the current state only once per integration, and then
+ * reuse those at the end of the previous step. */
+static int rk_evolve_apply(LALAdaptiveRungeKuttaIntegrator * integrator, REAL8 * t, REAL8 t1, REAL8 * h, REAL8 * y)
+{
+    LALAdaptiveRungeKuttaWork *w = integrator->work;
+    const size_t dim = integrator->sys->dimension;
+    const REAL8 t0 = *t;
+    const REAL8 dt = t1 - t0;
+    REAL8 h0 = *h;
+    int final_step, status;
+
+    if (integrator->stepper == LAL_ADAPTIVE_RK_STEPPER_GSL)
+        return gsl_odeiv_evolve_apply(integrator->evolve, integrator->control, integrator->step, integrator->sys, t, t1, h, y);
+
+    if ((dt < 0.0 && h0 > 0.0) || (dt > 0.0 && h0 < 0.0))
+        return GSL_EINVAL;
+
+    if (!w->have_dydt_in) {
+        if ((status = integrator->dydt(t0, y, w->dydt_in, integrator->sys->params)) != GSL_SUCCESS)
+            return status;
+        w->have_dydt_in = 1;
+    }
+
+  try_step:
+    final_step = ((dt >= 0.0 && h0 > dt) || (dt < 0.0 && h0 < dt));
+    if (final_step)
+        h0 = dt;
+
+    if ((status = rk_step_apply(integrator, t0, h0, y, w->yerr, w->dydt_in, w->dydt_out)) != GSL_SUCCESS) {
+        *h = h0;
+        *t = t0;
+        return status;
+    }
+
+    *t = final_step ? t1 : t0 + h0;
+
+    {
+        const REAL8 h_old = h0;
+        if (rk_control_hadjust(integrator, y, w->yerr, w->dydt_out, &h0) == GSL_ODEIV_HADJ_DEC) {
+            /* undo the step and try again, if the step size actually decreased by enough to change the time */
+            if (fabs(h0) < fabs(h_old) && *t + h0 != *t) {
+                memcpy(y, w->y0, dim * sizeof(REAL8));
+                goto try_step;
+            }
+            h0 = h_old;
+        }
+    }
+
+    *h = h0;
+    memcpy(w->dydt_in, w->dydt_out, dim * sizeof(REAL8));
+    return GSL_SUCCESS;
+}
+
+/* Local function returning the derivatives at the end of the last step taken by rk_evolve_apply() */
+static REAL8 *rk_evolve_dydt_out(LALAdaptiveRungeKuttaIntegrator * integrator)
+{
+    if (integrator->stepper == LAL_ADAPTIVE_RK_STEPPER_GSL)
+        return integrator->evolve->dydt_out;
+    return ((LALAdaptiveRungeKuttaWork *) integrator->work)->dydt_out;
+}
+
+/* Copied from GSL rkf45.c */
+typedef struct {
+    double *k1;
+    double *k2;
+    double *k3;
+    double *k4;
+    double *k5;
+    double *k6;
+    double *y0;
+    double *ytmp;
+} rkf45_state_t;
+
+/* Local function evaluating the solution at t0 + theta h inside the last
+ * step, of size h, that ended at state y1. The Runge-Kutta-Fehlberg
+ * interpolation is derived in the Mathematica notebook
+ * "RKF_with_interpolation.nb" (see XLALAdaptiveRungeKutta4Hermite()); the
+ * GSL engine must use gsl_odeiv_step_rkf45. */
+static void rk_dense_output(const LALAdaptiveRungeKuttaIntegrator * integrator, REAL8 h, REAL8 theta, const REAL8 * y1, REAL8 * y)
+{
+    const size_t dim = integrator->sys->dimension;
+    const LALAdaptiveRungeKuttaWork *w = integrator->work;
+    size_t i;
+
+    if (integrator->stepper == LAL_ADAPTIVE_RK_STEPPER_DOPRI5) {
+        const REAL8 theta1 = 1.0 - theta;
+        for (i = 0; i < dim; i++) {
+            const REAL8 ydiff = y1[i] - w->y0[i];
+            const REAL8 bspl = h * w->k[0][i] - ydiff;
+            const REAL8 d = h * (dopri5_d[0] * w->k[0][i] + dopri5_d[2] * w->k[2][i] + dopri5_d[3] * w->k[3][i]
+                + dopri5_d[4] * w->k[4][i] + dopri5_d[5] * w->k[5][i] + dopri5_d[6] * w->k[6][i]);
+            y[i] = w->y0[i] + theta * (ydiff + theta1 * (bspl + theta * ((ydiff - h * w->k[6][i] - bspl) + theta1 * d)));
+        }
+    } else {
+        /* These are the interpolating coefficients for y(t + h*theta) =
+         * ynew + i1*h*k1 + i5*h*k5 + i6*h*k6 + O(h^4). */
+        const REAL8 i0 = 1.0 + theta * theta * (3.0 - 4.0 * theta);
+        const REAL8 i1 = -theta * (theta - 1.0);
+        const REAL8 i6 = -4.0 * theta * theta * (theta - 1.0);
+        const REAL8 iend = theta * theta * (4.0 * theta - 3.0);
+        const REAL8 *k1, *k6, *y0;
+
+        if (integrator->stepper == LAL_ADAPTIVE_RK_STEPPER_GSL) {
+            /* Grab the k's from the integrator state. */
+            const rkf45_state_t *rkfState = integrator->step->state;
+            k1 = rkfState->k1;
+            k6 = rkfState->k6;
+            y0 = rkfState->y0;
+        } else {
+            k1 = w->k[0];
+            k6 = w->k[5];
+            y0 = w->y0;
+        }
+
+        for (i = 0; i < dim; i++)
+            y[i] = i0 * y0[i] + iend * y1[i] + h * i1 * k1[i] + h * i6 * k6[i];
+    }
+}
+
+/* Local function doubling the length of the rows of a 2-dimensional
+ * output array, keeping the first used samples of each row. The data are
+ * reallocated rather than copied to a new array; since the rows keep their
+ * old offsets in the reallocated block, they are then moved to the new row
+ * length, last row first so that no row is overwritten before it moves. */
+static int growOutput(REAL8Array * out, size_t * outputlen, size_t used)
+{
+    const size_t rows = out->dimLength->data[0];
+    const size_t len = *outputlen;
+    size_t i;
+
+    if (!XLALResizeREAL8ArrayL(out, 2, rows, 2 * len))
+        return XLAL_ENOMEM;
+
+    for (i = rows - 1; i > 0; i--)
+        memmove(&out->data[2 * i * len], &out->data[i * len], used * sizeof(REAL8));
+
+    *outputlen = 2 * len;
+    return GSL_SUCCESS;
+}
+
 LALAdaptiveRungeKuttaIntegrator *XLALAdaptiveRungeKutta4Init(int dim, int (*dydt) (double t, const double y[], double dydt[], void *params),   /* These are XLAL functions! */
     int (*stop) (double t, const double y[], double dydt[], void *params), double eps_abs, double eps_rel)
 {
@@ -47,8 +420,13 @@ LALAdaptiveRungeKuttaIntegrator *XLALAdaptiveRungeKutta4Init(int dim, int (*dydt
     /* allocate the GSL system (functions, etc.) */
     integrator->sys = (gsl_odeiv_system *) LALCalloc(1, sizeof(gsl_odeiv_system));
 
+    /* allocate the stages of the inlined steppers, if the system is small enough for them */
+    if (dim <= LAL_ADAPTIVE_RK_MAX_DIM)
+        integrator->work = LALCalloc(1, sizeof(LALAdaptiveRungeKuttaWork));
+
     /* if something failed to be allocated, bail out */
-    if (!(integrator->step) || !(integrator->control) || !(integrator->evolve) || !(integrator->sys)) {
+    if (!(integrator->step) || !(integrator->control) || !(integrator->evolve) || !(integrator->sys)
+        || (dim <= LAL_ADAPTIVE_RK_MAX_DIM && !(integrator->work))) {
         XLALAdaptiveRungeKuttaFree(integrator);
         XLAL_ERROR_NULL(XLAL_ENOMEM);
     }
@@ -64,6 +442,10 @@ LALAdaptiveRungeKuttaIntegrator *XLALAdaptiveRungeKutta4Init(int dim, int (*dydt
     integrator->retries = 6;
     integrator->stopontestonly = 0;
 
+    integrator->stepper = integrator->work ? lalAdaptiveRungeKuttaDefaultStepper : LAL_ADAPTIVE_RK_STEPPER_GSL;
+    integrator->eps_abs = eps_abs;
+    integrator->eps_rel = eps_rel;
+
     return integrator;
 }
 
@@ -85,8 +467,13 @@ LALAdaptiveRungeKuttaIntegrator *XLALAdaptiveRungeKutta4InitEighthOrderInstead(i
     /* allocate the GSL system (functions, etc.) */
     integrator->sys = (gsl_odeiv_system *) LALCalloc(1, sizeof(gsl_odeiv_system));
 
+    /* allocate the stages of the inlined steppers, if the system is small enough for them */
+    if (dim <= LAL_ADAPTIVE_RK_MAX_DIM)
+        integrator->work = LALCalloc(1, sizeof(LALAdaptiveRungeKuttaWork));
+
     /* if something failed to be allocated, bail out */
-    if (!(integrator->step) || !(integrator->control) || !(integrator->evolve) || !(integrator->sys)) {
+    if (!(integrator->step) || !(integrator->control) || !(integrator->evolve) || !(integrator->sys)
+        || (dim <= LAL_ADAPTIVE_RK_MAX_DIM && !(integrator->work))) {
         XLALAdaptiveRungeKuttaFree(integrator);
         XLAL_ERROR_NULL(XLAL_ENOMEM);
     }
@@ -102,6 +489,10 @@ LALAdaptiveRungeKuttaIntegrator *XLALAdaptiveRungeKutta4InitEighthOrderInstead(i
     integrator->retries = 6;
     integrator->stopontestonly = 0;
 
+    integrator->stepper = LAL_ADAPTIVE_RK_STEPPER_GSL;
+    integrator->eps_abs = eps_abs;
+    integrator->eps_rel = eps_rel;
+
     return integrator;
 }
 
@@ -118,11 +509,49 @@ void XLALAdaptiveRungeKuttaFree(LALAdaptiveRungeKuttaIntegrator * integrator)
         XLAL_CALLGSL(gsl_odeiv_step_free(integrator->step));
 
     LALFree(integrator->sys);
+    LALFree(integrator->work);
     LALFree(integrator);
 
     return;
 }
 
+/**
+ * Sets the stepping engine of an integrator. The inlined engines require a
+ * system of at most \c LAL_ADAPTIVE_RK_MAX_DIM variables.
+ */
+int XLALAdaptiveRungeKuttaSetStepper(LALAdaptiveRungeKuttaIntegrator * integrator, LALAdaptiveRungeKuttaStepper stepper)
+{
+    XLAL_CHECK(integrator != NULL, XLAL_EFAULT);
+    XLAL_CHECK(stepper == LAL_ADAPTIVE_RK_STEPPER_GSL || stepper == LAL_ADAPTIVE_RK_STEPPER_RKF45
+        || stepper == LAL_ADAPTIVE_RK_STEPPER_DOPRI5, XLAL_EINVAL, "Unknown stepper %d", (int)stepper);
+    XLAL_CHECK(stepper == LAL_ADAPTIVE_RK_STEPPER_GSL || integrator->work != NULL, XLAL_EINVAL,
+        "Inlined steppers handle at most %d variables, got %zu", LAL_ADAPTIVE_RK_MAX_DIM, integrator->sys->dimension);
+    integrator->stepper = stepper;
+    return XLAL_SUCCESS;
+}
+
+/**
+ * Sets the stepping engine given to integrators created afterwards by
+ * XLALAdaptiveRungeKutta4Init(). The setting is global and should be
+ * changed before, not while, integrators are created.
+ */
+int XLALAdaptiveRungeKuttaSetDefaultStepper(LALAdaptiveRungeKuttaStepper stepper)
+{
+    XLAL_CHECK(stepper == LAL_ADAPTIVE_RK_STEPPER_GSL || stepper == LAL_ADAPTIVE_RK_STEPPER_RKF45
+        || stepper == LAL_ADAPTIVE_RK_STEPPER_DOPRI5, XLAL_EINVAL, "Unknown stepper %d", (int)stepper);
+    lalAdaptiveRungeKuttaDefaultStepper = stepper;
+    return XLAL_SUCCESS;
+}
+
+/**
+ * Returns the stepping engine given to integrators created by
+ * XLALAdaptiveRungeKutta4Init().
+ */
+LALAdaptiveRungeKuttaStepper XLALAdaptiveRungeKuttaGetDefaultStepper(void)
+{
+    return lalAdaptiveRungeKuttaDefaultStepper;
+}
+
 /* Local function to store interpolated step in output array */
 static int storeStateInOutput(REAL8Array ** output, REAL8 t, REAL8 * y, size_t dim, int *outputlen, int count)
 {
@@ -131,20 +560,14 @@ static int storeStateInOutput(REAL8Array ** output, REAL8 t, REAL8 * y, size_t d
     size_t i;
 
     if (count > len) {
-        /* Resize array! Have to make a new array, and copy over. */
-        REAL8Array *new = XLALCreateREAL8ArrayL(2, dim + 1, 2 * len);
+        /* Resize array! */
+        size_t newlen = len;
 
-        if (!new) {
+        if (growOutput(out, &newlen, len) != GSL_SUCCESS) {
             return XLAL_ENOMEM;
         }
 
-        for (i = 0; i < dim + 1; i++) {
-            memcpy(&(new->data[2 * i * len]), &(out->data[i * len]), len * sizeof(REAL8));
-        }
-
-        XLALDestroyREAL8Array(out);
-        out = new;
-        len *= 2;
+        len = newlen;
     }
 
     /* Store the current step. */
@@ -158,43 +581,29 @@ static int storeStateInOutput(REAL8Array ** output, REAL8 t, REAL8 * y, size_t d
     return GSL_SUCCESS;
 }
 
-/* Local function to shrink output array to proper size before it's returned */
+/* Local function to shrink output array to proper size before it's returned;
+ * the rows are moved down to the new row length, first row first, and the
+ * data are then reallocated */
 static int shrinkOutput(REAL8Array ** output, int *outputlen, int count, size_t dim)
 {
     REAL8Array *out = *output;
     int len = *outputlen;
 
-    REAL8Array *new = XLALCreateREAL8ArrayL(2, dim + 1, count);
-
-    if (!new) {
-        return XLAL_ENOMEM;
+    size_t i;
+    for (i = 1; i < dim + 1; i++) {
+        memmove(&(out->data[i * count]), &(out->data[i * len]), count * sizeof(REAL8));
     }
 
-    size_t i;
-    for (i = 0; i < dim + 1; i++) {
-        memcpy(&(new->data[i * count]), &(out->data[i * len]), count * sizeof(REAL8));
+    if (!XLALResizeREAL8ArrayL(out, 2, dim + 1, count)) {
+        return XLAL_ENOMEM;
     }
 
-    *output = new;
+    *output = out;
     *outputlen = count;
 
-    XLALDestroyREAL8Array(out);
-
     return GSL_SUCCESS;
 }
 
-/* Copied from GSL rkf45.c */
-typedef struct {
-    double *k1;
-    double *k2;
-    double *k3;
-    double *k4;
-    double *k5;
-    double *k6;
-    double *y0;
-    double *ytmp;
-} rkf45_state_t;
-
 /**
  * Fourth-order Runge-Kutta ODE integrator using Runge-Kutta-Fehlberg (RKF45)
  * steps with adaptive step size control.  Intended for use in various
@@ -215,6 +624,10 @@ typedef struct {
  *
  * This method is functionally equivalent to XLALAdaptiveRungeKutta4,
  * but is nearly always faster due to the improved interpolation.
+ *
+ * With the inlined Dormand-Prince stepper the interpolation uses the
+ * dense output of that stepper instead. The GSL engine must use the
+ * RKF45 stepper.
  */
 int XLALAdaptiveRungeKutta4Hermite(LALAdaptiveRungeKuttaIntegrator * integrator,       /**< struct holding dydt, stopping test, stepper, etc. */
     void *params,                                                       /**< params struct used to compute dydt and stopping test */
@@ -291,18 +704,15 @@ int XLALAdaptiveRungeKutta4Hermite(LALAdaptiveRungeKuttaIntegrator * integrator,
     count = 1;
 
     /* We are starting a fresh integration; clear GSL step and evolve
-     * objects. */
-    gsl_odeiv_step_reset(integrator->step);
-    gsl_odeiv_evolve_reset(integrator->evolve);
+     * objects, or the stages of the inlined stepper. */
+    rk_reset(integrator);
 
     /* Enter evolution loop.  NOTE: we *always* take at least one
      * step. */
     while (1) {
         REAL8 told = t;
 
-        status =
-            gsl_odeiv_evolve_apply(integrator->evolve, integrator->control, integrator->step, integrator->sys, &t, tend, &h,
-            yinit);
+        status = rk_evolve_apply(integrator, &t, tend, &h, yinit);
 
         /* Check for failure, retry if haven't retried too many times
          * already. */
@@ -333,22 +743,7 @@ int XLALAdaptiveRungeKutta4Hermite(LALAdaptiveRungeKuttaIntegrator * integrator,
             REAL8 hUsed = t - told;
             REAL8 theta = (tintp - told) / hUsed;
 
-            /* These are the interpolating coefficients for y(t + h*theta) =
-             * ynew + i1*h*k1 + i5*h*k5 + i6*h*k6 + O(h^4). */
-            REAL8 i0 = 1.0 + theta * theta * (3.0 - 4.0 * theta);
-            REAL8 i1 = -theta * (theta - 1.0);
-            REAL8 i6 = -4.0 * theta * theta * (theta - 1.0);
-            REAL8 iend = theta * theta * (4.0 * theta - 3.0);
-
-            /* Grab the k's from the integrator state. */
-            rkf45_state_t *rkfState = integrator->step->state;
-            REAL8 *k1 = rkfState->k1;
-            REAL8 *k6 = rkfState->k6;
-            REAL8 *y0 = rkfState->y0;
-
-            for (i = 0; i < dim; i++) {
-                ytemp[i] = i0 * y0[i] + iend * yinit[i] + hUsed * i1 * k1[i] + hUsed * i6 * k6[i];
-            }
+            rk_dense_output(integrator, hUsed, theta, yinit, ytemp);
 
             /* Store the interpolated value in the output array. */
             count++;
@@ -366,7 +761,7 @@ int XLALAdaptiveRungeKutta4Hermite(LALAdaptiveRungeKuttaIntegrator * integrator,
         /* If there is a stopping function in integrator, call it with the
          * last value of y and dydt from the integrator. */
         if (integrator->stop) {
-            if ((status = integrator->stop(t, yinit, integrator->evolve->dydt_out, params)) != GSL_SUCCESS) {
+            if ((status = integrator->stop(t, yinit, rk_evolve_dydt_out(integrator), params)) != GSL_SUCCESS) {
                 integrator->returncode = status;
                 break;
             }
@@ -375,7 +770,10 @@ int XLALAdaptiveRungeKutta4Hermite(LALAdaptiveRungeKuttaIntegrator * integrator,
 
     /* Now that the interpolation is done, shrink the output array down
      * to exactly count samples. */
-    shrinkOutput(&output, &outputlen, count, dim);
+    if (shrinkOutput(&output, &outputlen, count, dim) == XLAL_ENOMEM) {
+        errnum = XLAL_ENOMEM;
+        goto bail_out;
+    }
 
     /* Store the final *interpolated* sample in yinit. */
     for (i = 0; i < dim; i++) {
@@ -498,8 +896,8 @@ int XLALAdaptiveRungeKutta4NoInterpolate(LALAdaptiveRungeKuttaIntegrator * integ
         memcpy(y0, y, dim * sizeof(REAL8));     /* save y to y0, dydt_in to dydt_in0 */
         memcpy(dydt_in0, dydt_in, dim * sizeof(REAL8));
 
-        /* call the GSL stepper function */
-        status = gsl_odeiv_step_apply(integrator->step, t, h0, y, yerr, dydt_in, dydt_out, integrator->sys);
+        /* call the stepper function */
+        status = rk_step_apply(integrator, t, h0, y, yerr, dydt_in, dydt_out);
         /* note: If the user-supplied functions defined in the system dydt return a status other than GSL_SUCCESS,
          * the step will be aborted. In this case, the elements of y will be restored to their pre-step values,
          * and the error code from the user-supplied function will be returned. */
@@ -519,8 +917,8 @@ int XLALAdaptiveRungeKutta4NoInterpolate(LALAdaptiveRungeKuttaIntegrator * integ
 
         tnew = t + h0;
 
-        /* call the GSL error-checking function */
-        status = gsl_odeiv_control_hadjust(integrator->control, integrator->step, y, yerr, dydt_out, &h0);
+        /* call the error-checking function */
+        status = rk_control_hadjust(integrator, y, yerr, dydt_out, &h0);
 
         /* did the error-checker reduce the stepsize?
          * note: other possible return codes are GSL_ODEIV_HADJ_INC if it was increased,
@@ -538,19 +936,9 @@ int XLALAdaptiveRungeKutta4NoInterpolate(LALAdaptiveRungeKuttaIntegrator * integ
 
         /* check if interpolation buffers need to be extended */
         if (outputlength >= bufferlength) {
-            REAL8Array *rebuffers;
-
-            /* sadly, we cannot use ResizeREAL8Array, because it would only work if we extended the first array dimension,
-             * so we need to copy everything over and switch the buffers. Oh well. */
-            if (!(rebuffers = XLALCreateREAL8ArrayL(2, dimn, 2 * bufferlength))) {
+            if (growOutput(buffers, &bufferlength, outputlength) != GSL_SUCCESS) {
                 errnum = XLAL_ENOMEM;   /* ouch, that hurt */
                 goto bail_out;
-            } else {
-	      for (unsigned int i = 0; i <= loop /* dim */; i++)
-                    memcpy(&rebuffers->data[i * 2 * bufferlength], &buffers->data[i * bufferlength], outputlength * sizeof(REAL8));
-                XLALDestroyREAL8Array(buffers);
-                buffers = rebuffers;
-                bufferlength *= 2;
             }
         }
 
@@ -705,8 +1093,8 @@ int XLALAdaptiveRungeKuttaDenseandSparseOutput(LALAdaptiveRungeKuttaIntegrator *
         memcpy(y0, y, dim * sizeof(REAL8));
         memcpy(dydt_in0, dydt_in, dim * sizeof(REAL8));
 
-        /* Call the GSL stepper function. */
-        status = gsl_odeiv_step_apply(integrator->step, t, h0, y, yerr, dydt_in, dydt_out, integrator->sys);
+        /* Call the stepper function. */
+        status = rk_step_apply(integrator, t, h0, y, yerr, dydt_in, dydt_out);
         /* Note: If the user-supplied functions defined in the system dydt return a status other than GSL_SUCCESS,
          * the step will be aborted. In this case, the elements of y will be restored to their pre-step values,
          * and the error code from the user-supplied function will be returned. */
@@ -729,8 +1117,8 @@ int XLALAdaptiveRungeKuttaDenseandSparseOutput(LALAdaptiveRungeKuttaIntegrator *
 
         tnew = t + h0;
 
-        /* Call the GSL error-checking function. */
-        status = gsl_odeiv_control_hadjust(integrator->control, integrator->step, y, yerr, dydt_out, &h0);
+        /* Call the error-checking function. */
+        status = rk_control_hadjust(integrator, y, yerr, dydt_out, &h0);
 
         /* Did the error-checker reduce the stepsize?
          * Note: other possible return codes are GSL_ODEIV_HADJ_INC if it was increased;
@@ -743,19 +1131,9 @@ int XLALAdaptiveRungeKuttaDenseandSparseOutput(LALAdaptiveRungeKuttaIntegrator *
         }
 
 	if (2*dense_outputlength >= dense_bufferlength) {
-          REAL8Array *rebuffers;
-
-          /* Sadly, we cannot use ResizeREAL8Array because it would only work if we extended the first array dimension;
-           * thus we copy everything and switch the buffers. */
-          if (!(rebuffers = XLALCreateREAL8ArrayL(2, dimn, 2 * dense_bufferlength))) {
+          if (growOutput(dense_buffers, &dense_bufferlength, dense_outputlength) != GSL_SUCCESS) {
             errnum = XLAL_ENOMEM;
             goto bail_out;
-          } else {
-	    for (UINT4 k = 0; k <= dim; k++)
-              memcpy(&rebuffers->data[k * 2 * dense_bufferlength], &dense_buffers->data[k * dense_bufferlength], dense_outputlength * sizeof(REAL8));
-            XLALDestroyREAL8Array(dense_buffers);
-            dense_buffers = rebuffers;
-            dense_bufferlength *= 2;
           }
 	}
 
@@ -803,19 +1181,9 @@ int XLALAdaptiveRungeKuttaDenseandSparseOutput(LALAdaptiveRungeKuttaIntegrator *
 
         /* Check if interpolation buffers need to be extended. */
         if (sparse_outputlength >= sparse_bufferlength) {
-	  REAL8Array *rebuffers;
-
-	  /* Sadly, we cannot use ResizeREAL8Array because it would only work if we extended the first array dimension;
-	   * thus we copy everything and switch the buffers. */
-	  if (!(rebuffers = XLALCreateREAL8ArrayL(2, dimn, 2 * sparse_bufferlength))) {
+	  if (growOutput(sparse_buffers, &sparse_bufferlength, sparse_outputlength) != GSL_SUCCESS) {
 	    errnum = XLAL_ENOMEM;
 	    goto bail_out;
-	  } else {
-	    for (UINT4 i = 0; i <= dim; i++)
-	      memcpy(&rebuffers->data[i * 2 * sparse_bufferlength], &sparse_buffers->data[i * sparse_bufferlength], sparse_outputlength * sizeof(REAL8));
-	    XLALDestroyREAL8Array(sparse_buffers);
-	    sparse_buffers = rebuffers;
-	    sparse_bufferlength *= 2;
 	  }
         }
 
@@ -891,9 +1259,16 @@ int XLALAdaptiveRungeKutta4(LALAdaptiveRungeKuttaIntegrator * integrator,
 
     /* needed for the integration */
     size_t dim, bufferlength, cnt, retries;
-    REAL8 t, tnew, h0;
+    REAL8 t, told, tnew, h0;
     REAL8Array *buffers = NULL;
-    REAL8 *temp = NULL, *y, *y0, *dydt_in, *dydt_in0, *dydt_out, *yerr; /* aliases */
+    REAL8 *temp = NULL, *y, *y0, *dydt_in, *dydt_in0, *dydt_out, *yerr, *ydense; /* aliases */
+
+    /* with an inlined stepper, which is only used when selected with
+     * XLALAdaptiveRungeKuttaSetStepper() or XLALAdaptiveRungeKuttaSetDefaultStepper(),
+     * the buffers hold the evenly sampled output itself, filled in from the
+     * dense output of each step as it is taken */
+    const int onthefly = (integrator->stepper != LAL_ADAPTIVE_RK_STEPPER_GSL);
+    size_t nout = 1;
 
     /* needed for the final interpolation */
     gsl_spline *interp = NULL;
@@ -911,7 +1286,7 @@ int XLALAdaptiveRungeKutta4(LALAdaptiveRungeKuttaIntegrator * integrator,
     dim = integrator->sys->dimension;
     bufferlength = (int)((tend - tinit) / deltat) + 2;  /* allow for the initial value and possibly a final semi-step */
     buffers = XLALCreateREAL8ArrayL(2, dim + 1, bufferlength);  /* 2-dimensional array, (dim+1) x bufferlength */
-    temp = LALCalloc(6 * dim, sizeof(REAL8));
+    temp = LALCalloc(7 * dim, sizeof(REAL8));
 
     if (!buffers || !temp) {
         errnum = XLAL_ENOMEM;
@@ -923,7 +1298,8 @@ int XLALAdaptiveRungeKutta4(LALAdaptiveRungeKuttaIntegrator * integrator,
     dydt_in = temp + 2 * dim;
     dydt_in0 = temp + 3 * dim;
     dydt_out = temp + 4 * dim;
-    yerr = temp + 5 * dim;      /* aliases */
+    yerr = temp + 5 * dim;
+    ydense = temp + 6 * dim;    /* aliases */
 
     /* set up to get started */
     integrator->sys->params = params;
@@ -972,8 +1348,8 @@ int XLALAdaptiveRungeKutta4(LALAdaptiveRungeKuttaIntegrator * integrator,
         memcpy(y0, y, dim * sizeof(REAL8));     /* save y to y0, dydt_in to dydt_in0 */
         memcpy(dydt_in0, dydt_in, dim * sizeof(REAL8));
 
-        /* call the GSL stepper function */
-        status = gsl_odeiv_step_apply(integrator->step, t, h0, y, yerr, dydt_in, dydt_out, integrator->sys);
+        /* call the stepper function */
+        status = rk_step_apply(integrator, t, h0, y, yerr, dydt_in, dydt_out);
         /* note: If the user-supplied functions defined in the system dydt return a status other than GSL_SUCCESS,
          * the step will be aborted. In this case, the elements of y will be restored to their pre-step values,
          * and the error code from the user-supplied function will be returned. */
@@ -993,8 +1369,8 @@ int XLALAdaptiveRungeKutta4(LALAdaptiveRungeKuttaIntegrator * integrator,
 
         tnew = t + h0;
 
-        /* call the GSL error-checking function */
-        status = gsl_odeiv_control_hadjust(integrator->control, integrator->step, y, yerr, dydt_out, &h0);
+        /* call the error-checking function */
+        status = rk_control_hadjust(integrator, y, yerr, dydt_out, &h0);
 
         /* did the error-checker reduce the stepsize?
          * note: other possible return codes are GSL_ODEIV_HADJ_INC if it was increased,
@@ -1006,25 +1382,35 @@ int XLALAdaptiveRungeKutta4(LALAdaptiveRungeKuttaIntegrator * integrator,
         }
 
         /* update the current time and input derivatives */
+        told = t;
         t = tnew;
         memcpy(dydt_in, dydt_out, dim * sizeof(REAL8));
         cnt++;
 
+        if (onthefly) {
+            /* fill in the output samples tinit + n deltat covered by the step */
+            while ((REAL8) nout <= (t - tinit) / deltat) {
+                const REAL8 tout = tinit + deltat * nout;
+
+                if (nout >= bufferlength && growOutput(buffers, &bufferlength, nout) != GSL_SUCCESS) {
+                    errnum = XLAL_ENOMEM;
+                    goto bail_out;
+                }
+
+                rk_dense_output(integrator, t - told, (tout - told) / (t - told), y, ydense);
+                buffers->data[nout] = tout;
+                for (unsigned int i = 1; i <= dim; i++)
+                    buffers->data[i * bufferlength + nout] = ydense[i - 1];
+                nout++;
+            }
+            continue;
+        }
+
         /* check if interpolation buffers need to be extended */
         if (cnt >= bufferlength) {
-            REAL8Array *rebuffers;
-
-            /* sadly, we cannot use ResizeREAL8Array, because it would only work if we extended the first array dimension,
-             * so we need to copy everything over and switch the buffers. Oh well. */
-            if (!(rebuffers = XLALCreateREAL8ArrayL(2, dim + 1, 2 * bufferlength))) {
+            if (growOutput(buffers, &bufferlength, cnt) != GSL_SUCCESS) {
                 errnum = XLAL_ENOMEM;   /* ouch, that hurt */
                 goto bail_out;
-            } else {
-                for (unsigned int i = 0; i <= dim; i++)
-                    memcpy(&rebuffers->data[i * 2 * bufferlength], &buffers->data[i * bufferlength], cnt * sizeof(REAL8));
-                XLALDestroyREAL8Array(buffers);
-                buffers = rebuffers;
-                bufferlength *= 2;
             }
         }
 
@@ -1042,6 +1428,20 @@ int XLALAdaptiveRungeKutta4(LALAdaptiveRungeKuttaIntegrator * integrator,
     if (cnt == 0)
         goto bail_out;
 
+    /* the output has already been filled in; shrink it to the samples taken */
+    if (onthefly) {
+        int len = bufferlength;
+
+        if (shrinkOutput(&buffers, &len, nout, dim) != GSL_SUCCESS) {
+            errnum = XLAL_ENOMEM;
+            goto bail_out;
+        }
+        output = buffers;
+        outputlen = nout;
+        buffers = NULL;
+        goto bail_out;
+    }
+
     interp = gsl_spline_alloc(gsl_interp_cspline, cnt + 1);
     accel = gsl_interp_accel_alloc();
 
@@ -1223,8 +1623,8 @@ int XLALAdaptiveRungeKutta4IrregularIntervals(LALAdaptiveRungeKuttaIntegrator *
         memcpy(y0, y, dim * sizeof(REAL8));     /* save y to y0, dydt_in to dydt_in0 */
         memcpy(dydt_in0, dydt_in, dim * sizeof(REAL8));
 
-        /* call the GSL stepper function */
-        status = gsl_odeiv_step_apply(integrator->step, t, h0, y, yerr, dydt_in, dydt_out, integrator->sys);
+        /* call the stepper function */
+        status = rk_step_apply(integrator, t, h0, y, yerr, dydt_in, dydt_out);
         /* note: If the user-supplied functions defined in the system dydt return a status other than GSL_SUCCESS,
          * the step will be aborted. In this case, the elements of y will be restored to their pre-step values,
          * and the error code from the user-supplied function will be returned. */
@@ -1244,8 +1644,8 @@ int XLALAdaptiveRungeKutta4IrregularIntervals(LALAdaptiveRungeKuttaIntegrator *
 
         tnew = t + h0;
 
-        /* call the GSL error-checking function */
-        status = gsl_odeiv_control_hadjust(integrator->control, integrator->step, y, yerr, dydt_out, &h0);
+        /* call the error-checking function */
+        status = rk_control_hadjust(integrator, y, yerr, dydt_out, &h0);
 
         /* did the error-checker reduce the stepsize?
          * note: other possible return codes are GSL_ODEIV_HADJ_INC if it was increased, GSL_ODEIV_HADJ_NIL if it was unchanged */
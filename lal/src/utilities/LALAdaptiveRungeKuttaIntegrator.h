@@ -35,7 +35,20 @@ extern "C" {
  *
  * ### Algorithm ###
  *
- * TBF.
+ * Each integrator steps with one of the engines of ::LALAdaptiveRungeKuttaStepper. The GSL engine calls
+ * <tt>gsl_odeiv_step_apply()</tt> and <tt>gsl_odeiv_control_hadjust()</tt> with the stepper chosen at initialisation.
+ * The inlined engines evaluate a Runge-Kutta-Fehlberg 4(5) or Dormand-Prince 5(4) step directly on stage arrays of
+ * fixed size \c LAL_ADAPTIVE_RK_MAX_DIM, reuse the derivatives at the end of a step as the first stage of the next one,
+ * and apply the step-size rule of <tt>gsl_odeiv_control_y_new()</tt> in place. They also keep the stages of the last
+ * step, so that <tt>XLALAdaptiveRungeKutta4()</tt> fills in the evenly sampled output from the dense output of each
+ * step as the integration proceeds, as <tt>XLALAdaptiveRungeKutta4Hermite()</tt> does, instead of fitting a cubic
+ * spline through all the steps once the integration has finished.
+ *
+ * <tt>XLALAdaptiveRungeKutta4Init()</tt> uses the engine returned by <tt>XLALAdaptiveRungeKuttaGetDefaultStepper()</tt>,
+ * for systems of at most \c LAL_ADAPTIVE_RK_MAX_DIM variables. The default is the GSL engine; the inlined engines are
+ * opt-in, and are selected for all new integrators with <tt>XLALAdaptiveRungeKuttaSetDefaultStepper()</tt>.
+ * <tt>XLALAdaptiveRungeKutta4InitEighthOrderInstead()</tt> always steps through GSL. The engine of an existing
+ * integrator is changed with <tt>XLALAdaptiveRungeKuttaSetStepper()</tt>.
  *
  * ### Uses ###
  *
@@ -48,6 +61,16 @@ extern "C" {
  */
 /*@{*/
 
+/** Maximum number of variables handled by the inlined steppers */
+#define LAL_ADAPTIVE_RK_MAX_DIM 32
+
+/** Stepping engines of ::LALAdaptiveRungeKuttaIntegrator */
+typedef enum tagLALAdaptiveRungeKuttaStepper {
+  LAL_ADAPTIVE_RK_STEPPER_GSL,		/**< GSL stepper and step-size control chosen at initialisation */
+  LAL_ADAPTIVE_RK_STEPPER_RKF45,	/**< inlined Runge-Kutta-Fehlberg 4(5), with the tableau and step-size control of the GSL rkf45 stepper */
+  LAL_ADAPTIVE_RK_STEPPER_DOPRI5	/**< inlined Dormand-Prince 5(4), with first-same-as-last stages and fourth-order dense output */
+} LALAdaptiveRungeKuttaStepper;
+
 typedef struct tagLALAdaptiveRungeKuttaIntegrator
 {
   gsl_odeiv_step    *step;
@@ -63,6 +86,10 @@ typedef struct tagLALAdaptiveRungeKuttaIntegrator
   int stopontestonly;	/* stop only on test, use tend to size buffers only */
 
   int returncode;
+
+  LALAdaptiveRungeKuttaStepper stepper;	/* stepping engine */
+  double eps_abs, eps_rel;	/* tolerances of the inlined step-size control */
+  void *work;		/* stages of the inlined steppers */
 } LALAdaptiveRungeKuttaIntegrator;
 
 LALAdaptiveRungeKuttaIntegrator *XLALAdaptiveRungeKutta4Init( int dim,
@@ -87,6 +114,10 @@ LALAdaptiveRungeKuttaIntegrator *XLALAdaptiveRungeKutta4InitEighthOrderInstead(
 
 void XLALAdaptiveRungeKuttaFree( LALAdaptiveRungeKuttaIntegrator *integrator );
 
+int XLALAdaptiveRungeKuttaSetStepper( LALAdaptiveRungeKuttaIntegrator *integrator, LALAdaptiveRungeKuttaStepper stepper );
+int XLALAdaptiveRungeKuttaSetDefaultStepper( LALAdaptiveRungeKuttaStepper stepper );
+LALAdaptiveRungeKuttaStepper XLALAdaptiveRungeKuttaGetDefaultStepper( void );
+
 int XLALAdaptiveRungeKutta4( LALAdaptiveRungeKuttaIntegrator *integrator,
                          void *params,
                          REAL8 *yinit,
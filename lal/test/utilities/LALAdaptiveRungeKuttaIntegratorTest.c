@@ -0,0 +1,195 @@
+/*
+ *  Copyright (C) 2018 The LALSuite developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with with program; see the file COPYING. If not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ *  MA  02111-1307  USA
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <lal/LALStdio.h>
+#include <lal/LALAdaptiveRungeKuttaIntegrator.h>
+
+#ifdef __GNUC__
+#define UNUSED __attribute__ ((unused))
+#else
+#define UNUSED
+#endif
+
+/* harmonic oscillator and exponential decay: y = (cos t, -sin t, exp(-t/10)) */
+static int dydt( UNUSED double t, const double y[], double f[], UNUSED void *params )
+{
+  f[0] = y[1];
+  f[1] = -y[0];
+  f[2] = -0.1 * y[2];
+  return GSL_SUCCESS;
+}
+
+/* stop once |t| exceeds the time passed in params */
+static int stop( double t, UNUSED const double y[], UNUSED double f[], void *params )
+{
+  return fabs( t ) > *( ( const double * ) params ) ? 1 : GSL_SUCCESS;
+}
+
+/* maximum difference between an evenly sampled output and the exact solution */
+static double max_error( const REAL8Array *yout, int len )
+{
+  double err = 0;
+  for ( int j = 0; j < len; ++j ) {
+    const double t = yout->data[j];
+    const double exact[3] = { cos( t ), -sin( t ), exp( -0.1 * t ) };
+    for ( int i = 0; i < 3; ++i ) {
+      err = fmax( err, fabs( yout->data[( i + 1 ) * len + j] - exact[i] ) );
+    }
+  }
+  return err;
+}
+
+/* check that an evenly sampled output starts at t = 0, has steps deltat, and reaches tmax */
+static int check_sampling( const REAL8Array *yout, int len, double deltat, double tmax )
+{
+  XLAL_CHECK( yout != NULL && len > 1, XLAL_EFAILED );
+  XLAL_CHECK( yout->dimLength->data[0] == 4 && ( int ) yout->dimLength->data[1] == len, XLAL_EFAILED );
+  for ( int j = 0; j < len; ++j ) {
+    XLAL_CHECK( fabs( yout->data[j] - j * deltat ) < 1e-9 * fabs( tmax ), XLAL_EFAILED, "t[%i] = %g", j, yout->data[j] );
+  }
+  XLAL_CHECK( fabs( yout->data[len - 1] ) >= fabs( tmax ) - fabs( deltat ), XLAL_EFAILED );
+  return XLAL_SUCCESS;
+}
+
+int main( void )
+{
+
+  /* Turn off buffering to sync standard output and error printing */
+  setvbuf( stdout, NULL, _IONBF, 0 );
+  setvbuf( stderr, NULL, _IONBF, 0 );
+
+  const LALAdaptiveRungeKuttaStepper steppers[] = { LAL_ADAPTIVE_RK_STEPPER_GSL, LAL_ADAPTIVE_RK_STEPPER_RKF45, LAL_ADAPTIVE_RK_STEPPER_DOPRI5 };
+  const char *const names[] = { "GSL", "RKF45", "DOPRI5" };
+  const double tmax = 100, deltat = 0.01;
+  REAL8Array *hermite[3] = { NULL, NULL, NULL };
+  int hermitelen[3] = { 0, 0, 0 };
+
+  /* Integrators created by XLALAdaptiveRungeKutta4Init() use the default stepper, GSL unless changed */
+  XLAL_CHECK_MAIN( XLALAdaptiveRungeKuttaGetDefaultStepper() == LAL_ADAPTIVE_RK_STEPPER_GSL, XLAL_EFAILED );
+  {
+    LALAdaptiveRungeKuttaIntegrator *integrator = XLALAdaptiveRungeKutta4Init( 3, dydt, stop, 1e-10, 1e-10 );
+    XLAL_CHECK_MAIN( integrator != NULL, XLAL_EFUNC );
+    XLAL_CHECK_MAIN( integrator->stepper == LAL_ADAPTIVE_RK_STEPPER_GSL, XLAL_EFAILED );
+    XLALAdaptiveRungeKuttaFree( integrator );
+  }
+  XLAL_CHECK_MAIN( XLALAdaptiveRungeKuttaSetDefaultStepper( LAL_ADAPTIVE_RK_STEPPER_DOPRI5 ) == XLAL_SUCCESS, XLAL_EFUNC );
+  {
+    LALAdaptiveRungeKuttaIntegrator *integrator = XLALAdaptiveRungeKutta4Init( 3, dydt, stop, 1e-10, 1e-10 );
+    XLAL_CHECK_MAIN( integrator != NULL, XLAL_EFUNC );
+    XLAL_CHECK_MAIN( integrator->stepper == LAL_ADAPTIVE_RK_STEPPER_DOPRI5, XLAL_EFAILED );
+    XLALAdaptiveRungeKuttaFree( integrator );
+  }
+
+  /* Large systems and eighth-order integrators step through GSL */
+  {
+    LALAdaptiveRungeKuttaIntegrator *integrator = XLALAdaptiveRungeKutta4Init( LAL_ADAPTIVE_RK_MAX_DIM + 1, dydt, stop, 1e-10, 1e-10 );
+    XLAL_CHECK_MAIN( integrator != NULL, XLAL_EFUNC );
+    XLAL_CHECK_MAIN( integrator->stepper == LAL_ADAPTIVE_RK_STEPPER_GSL, XLAL_EFAILED );
+    int errnum;
+    XLAL_TRY( XLALAdaptiveRungeKuttaSetStepper( integrator, LAL_ADAPTIVE_RK_STEPPER_DOPRI5 ), errnum );
+    XLAL_CHECK_MAIN( errnum == XLAL_EINVAL, XLAL_EFAILED );
+    XLALAdaptiveRungeKuttaFree( integrator );
+    integrator = XLALAdaptiveRungeKutta4InitEighthOrderInstead( 3, dydt, stop, 1e-10, 1e-10 );
+    XLAL_CHECK_MAIN( integrator != NULL, XLAL_EFUNC );
+    XLAL_CHECK_MAIN( integrator->stepper == LAL_ADAPTIVE_RK_STEPPER_GSL, XLAL_EFAILED );
+    XLALAdaptiveRungeKuttaFree( integrator );
+  }
+  XLAL_CHECK_MAIN( XLALAdaptiveRungeKuttaSetDefaultStepper( LAL_ADAPTIVE_RK_STEPPER_GSL ) == XLAL_SUCCESS, XLAL_EFUNC );
+
+  for ( size_t s = 0; s < XLAL_NUM_ELEM( steppers ); ++s ) {
+    printf( "----- %s stepper -----\n", names[s] );
+
+    LALAdaptiveRungeKuttaIntegrator *integrator = XLALAdaptiveRungeKutta4Init( 3, dydt, stop, 1e-10, 1e-10 );
+    XLAL_CHECK_MAIN( integrator != NULL, XLAL_EFUNC );
+    XLAL_CHECK_MAIN( XLALAdaptiveRungeKuttaSetStepper( integrator, steppers[s] ) == XLAL_SUCCESS, XLAL_EFUNC );
+
+    /* Integrate up to tmax; the output buffers start at a fraction of their final length */
+    {
+      double y[3] = { 1, 0, 1 };
+      integrator->stopontestonly = 0;
+      hermitelen[s] = XLALAdaptiveRungeKutta4Hermite( integrator, ( void * ) &tmax, y, 0, tmax, deltat, &hermite[s] );
+      XLAL_CHECK_MAIN( check_sampling( hermite[s], hermitelen[s], deltat, tmax ) == XLAL_SUCCESS, XLAL_EFUNC );
+      const double err = max_error( hermite[s], hermitelen[s] );
+      printf( "XLALAdaptiveRungeKutta4Hermite(): %i samples, maximum error %.3e\n", hermitelen[s], err );
+      XLAL_CHECK_MAIN( err < 1e-6, XLAL_EFAILED );
+    }
+
+    /* Integrate backwards until the stopping test fires */
+    {
+      double y[3] = { 1, 0, 1 };
+      REAL8Array *yout = NULL;
+      integrator->stopontestonly = 1;
+      const int len = XLALAdaptiveRungeKutta4Hermite( integrator, ( void * ) &tmax, y, 0, -1, -deltat, &yout );
+      XLAL_CHECK_MAIN( check_sampling( yout, len, -deltat, tmax ) == XLAL_SUCCESS, XLAL_EFUNC );
+      const double err = max_error( yout, len );
+      printf( "XLALAdaptiveRungeKutta4Hermite() backwards: %i samples, maximum error %.3e\n", len, err );
+      XLAL_CHECK_MAIN( err < 1e-6, XLAL_EFAILED );
+      XLALDestroyREAL8Array( yout );
+    }
+
+    /* Evenly sampled output from XLALAdaptiveRungeKutta4() */
+    {
+      double y[3] = { 1, 0, 1 };
+      REAL8Array *yout = NULL;
+      integrator->stopontestonly = 1;
+      const int len = XLALAdaptiveRungeKutta4( integrator, ( void * ) &tmax, y, 0, 1, deltat, &yout );
+      XLAL_CHECK_MAIN( check_sampling( yout, len, deltat, tmax ) == XLAL_SUCCESS, XLAL_EFUNC );
+      const double err = max_error( yout, len );
+      printf( "XLALAdaptiveRungeKutta4(): %i samples, maximum error %.3e\n", len, err );
+      /* the GSL stepper interpolates its steps with a cubic spline, the inlined ones use dense output */
+      XLAL_CHECK_MAIN( err < ( steppers[s] == LAL_ADAPTIVE_RK_STEPPER_GSL ? 1e-3 : 1e-6 ), XLAL_EFAILED );
+      XLALDestroyREAL8Array( yout );
+    }
+
+    /* Dense and sparse output */
+    {
+      double y[3] = { 1, 0, 1 };
+      REAL8Array *sparse = NULL, *dense = NULL;
+      integrator->stopontestonly = 1;
+      const int len = XLALAdaptiveRungeKuttaDenseandSparseOutput( integrator, ( void * ) &tmax, y, 0, 1, deltat, &sparse, &dense );
+      XLAL_CHECK_MAIN( len > 1 && sparse != NULL && dense != NULL, XLAL_EFUNC );
+      const double err = fmax( max_error( sparse, len ), max_error( dense, dense->dimLength->data[1] ) );
+      printf( "XLALAdaptiveRungeKuttaDenseandSparseOutput(): %i steps, maximum error %.3e\n", len, err );
+      XLAL_CHECK_MAIN( err < 1e-6, XLAL_EFAILED );
+      XLALDestroyREAL8Array( sparse );
+      XLALDestroyREAL8Array( dense );
+    }
+
+    XLALAdaptiveRungeKuttaFree( integrator );
+  }
+
+  /* The inlined RKF45 stepper takes the same steps as the GSL one */
+  XLAL_CHECK_MAIN( hermitelen[0] == hermitelen[1], XLAL_EFAILED );
+  for ( int j = 0; j < 4 * hermitelen[0]; ++j ) {
+    XLAL_CHECK_MAIN( fabs( hermite[0]->data[j] - hermite[1]->data[j] ) < 1e-12, XLAL_EFAILED, "GSL and inlined RKF45 outputs differ at %i", j );
+  }
+
+  /* Cleanup */
+  for ( size_t s = 0; s < XLAL_NUM_ELEM( steppers ); ++s ) {
+    XLALDestroyREAL8Array( hermite[s] );
+  }
+
+  /* Check for memory leaks */
+  LALCheckMemoryLeaks();
+
+  return EXIT_SUCCESS;
+
+}
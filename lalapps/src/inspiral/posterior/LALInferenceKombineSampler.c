@@ -25,6 +25,7 @@
 #include "LALInferenceKombineSampler.h"
 #include <lal/LALInferenceProposal.h>
 #include <lal/LALInferenceClusteredKDE.h>
+#include <lal/LALInferenceLikelihood.h>
 
 #include <LALAppsVCSInfo.h>
 
@@ -48,7 +49,9 @@ void ensemble_sampler(struct tagLALInferenceRunState *run_state) {
     INT4 *acceptance_buffer;
     REAL8 *acceptance_rates;
     REAL8 acceptance_rate, min_acceptance_rate, max_acceptance_rate;
-    REAL8 *prop_priors, *prop_likelihoods, *prop_densities;
+    REAL8 *prop_priors, *prop_likelihoods, *prop_densities, *proposal_ratios;
+    LALInferenceVariables **proposed_params;
+    LALInferenceModel **models;
     INT4 update = 0;
     FILE *output = NULL;
     LALInferenceThreadState *thread;
@@ -87,6 +90,11 @@ void ensemble_sampler(struct tagLALInferenceRunState *run_state) {
     prop_priors = XLALCalloc(nwalkers_per_thread, sizeof(REAL8));
     prop_likelihoods = XLALCalloc(nwalkers_per_thread, sizeof(REAL8));
     prop_densities = XLALCalloc(nwalkers_per_thread, sizeof(REAL8));
+    proposal_ratios = XLALCalloc(nwalkers_per_thread, sizeof(REAL8));
+
+    /* Proposed walker positions and their models, gathered for batched likelihood evaluation */
+    proposed_params = XLALCalloc(nwalkers_per_thread, sizeof(LALInferenceVariables *));
+    models = XLALCalloc(nwalkers_per_thread, sizeof(LALInferenceModel *));
 
     /* Open output and print header */
     output = init_ensemble_output(run_state, verbose, mpi_rank);
@@ -109,13 +117,31 @@ void ensemble_sampler(struct tagLALInferenceRunState *run_state) {
             max_acceptance_rate = 0.0;
         }
 
-        /* Update all walkers on this MPI-thread */
+        /* Propose a jump for all walkers on this MPI-thread */
         #pragma omp parallel for private(thread)
         for (walker=0; walker<nwalkers_per_thread; walker++) {
             thread = run_state->threads[walker];
 
-            walker_step(run_state, thread, &(prop_priors[walker]),
-                        &(prop_likelihoods[walker]), &(prop_densities[walker]));
+            proposal_ratios[walker] = walker_propose(run_state, thread, &(prop_priors[walker]),
+                                                     &(prop_densities[walker]));
+            proposed_params[walker] = thread->proposedParams;
+            models[walker] = thread->model;
+        }
+
+        /* Evaluate the likelihoods of the proposals as a single batch */
+        if (LALInferenceBatchedLogLikelihood(run_state->likelihood, proposed_params, run_state->data,
+                                             models, prop_priors, prop_likelihoods,
+                                             nwalkers_per_thread) != XLAL_SUCCESS) {
+            fprintf(stderr, "Error evaluating likelihoods of proposed walkers.\n");
+            exit(1);
+        }
+
+        /* Accept or reject the proposals */
+        for (walker=0; walker<nwalkers_per_thread; walker++) {
+            thread = run_state->threads[walker];
+
+            walker_accept(thread, prop_priors[walker], prop_likelihoods[walker],
+                          prop_densities[walker], proposal_ratios[walker]);
 
             /* Track acceptance rates */
             acceptance_buffer[walker + (*step % tracking_interval)] = thread->accepted;
@@ -155,18 +181,17 @@ void ensemble_sampler(struct tagLALInferenceRunState *run_state) {
     for (walker=0; walker<nwalkers_per_thread; walker++)
         run_state->threads[walker]->currentPropDensity = -INFINITY;
 
+    XLALFree(proposed_params);
+    XLALFree(models);
+    XLALFree(proposal_ratios);
+
     fclose(output);
     return;
 }
 
-void walker_step(LALInferenceRunState *run_state, LALInferenceThreadState *thread,
-                 REAL8 *proposed_prior, REAL8 *proposed_likelihood, REAL8 *proposed_prop_density) {
-    REAL8 proposal_ratio, acceptance_probability;
-
-    thread->accepted = 0;
-
-    *proposed_prior = -INFINITY;
-    *proposed_likelihood = -INFINITY;
+REAL8 walker_propose(LALInferenceRunState *run_state, LALInferenceThreadState *thread,
+                     REAL8 *proposed_prior, REAL8 *proposed_prop_density) {
+    REAL8 proposal_ratio;
 
     /* Get the probability of proposing the reverse jump */
     *proposed_prop_density = thread->currentPropDensity;
@@ -175,14 +200,21 @@ void walker_step(LALInferenceRunState *run_state, LALInferenceThreadState *threa
                                                             thread->proposedParams,
                                                             proposed_prop_density);
 
-    /* Only bother calculating likelihood if within prior boundaries */
+    /* The likelihood is only calculated if within prior boundaries */
     *proposed_prior = run_state->prior(run_state, thread->proposedParams, thread->model);
-    if (isfinite(*proposed_prior))
-        *proposed_likelihood = run_state->likelihood(thread->proposedParams,
-                                                     run_state->data, thread->model);
+
+    return proposal_ratio;
+}
+
+void walker_accept(LALInferenceThreadState *thread, REAL8 proposed_prior,
+                   REAL8 proposed_likelihood, REAL8 proposed_prop_density,
+                   REAL8 proposal_ratio) {
+    REAL8 acceptance_probability;
+
+    thread->accepted = 0;
 
     /* Find jump acceptance probability */
-    acceptance_probability = (*proposed_prior + *proposed_likelihood)
+    acceptance_probability = (proposed_prior + proposed_likelihood)
                             - (thread->currentPrior + thread->currentLikelihood)
                             + proposal_ratio;
 
@@ -190,9 +222,9 @@ void walker_step(LALInferenceRunState *run_state, LALInferenceThreadState *threa
     if (acceptance_probability > 0
             || (log(gsl_rng_uniform(thread->GSLrandom)) < acceptance_probability)) {
         LALInferenceCopyVariables(thread->proposedParams, thread->currentParams);
-        thread->currentPrior = *proposed_prior;
-        thread->currentLikelihood = *proposed_likelihood;
-        thread->currentPropDensity = *proposed_prop_density;
+        thread->currentPrior = proposed_prior;
+        thread->currentLikelihood = proposed_likelihood;
+        thread->currentPropDensity = proposed_prop_density;
 
         thread->accepted = 1;
     }
@@ -37,9 +37,14 @@
 void ensemble_sampler(LALInferenceRunState *run_state);
 
 
-/** Evolve a walker a single step */
-void walker_step(LALInferenceRunState *run_state, LALInferenceThreadState *thread,
-                 REAL8 *proposed_prior, REAL8 *proposed_likelihood, REAL8 *proposed_prop_density);
+/** Propose a jump for a walker and compute its prior, returning the log proposal ratio */
+REAL8 walker_propose(LALInferenceRunState *run_state, LALInferenceThreadState *thread,
+                     REAL8 *proposed_prior, REAL8 *proposed_prop_density);
+
+/** Accept or reject a walker's proposed jump, given its prior and likelihood */
+void walker_accept(LALInferenceThreadState *thread, REAL8 proposed_prior,
+                   REAL8 proposed_likelihood, REAL8 proposed_prop_density,
+                   REAL8 proposal_ratio);
 
 /** Update the ensemble proposal from the ensemble's current state */
 REAL8 get_acceptance_rate(LALInferenceRunState *run_state, REAL8 *local_acceptance_rates);
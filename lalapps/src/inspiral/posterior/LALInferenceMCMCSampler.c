@@ -64,65 +64,37 @@ const char *const clusteredKDEProposalName = "ClusteredKDEProposal";
 
 static void
 thinDifferentialEvolutionPoints(LALInferenceThreadState *thread) {
-    size_t i;
-    size_t newSize;
-
-    /* Delete all the even-index points. */
-    for (i = 0; i < thread->differentialPointsLength; i += 2) {
-        LALInferenceClearVariables(thread->differentialPoints[i]);
-        XLALFree(thread->differentialPoints[i]);
-        thread->differentialPoints[i] = NULL;
-    }
-
-    /* Copy the odd points into the first part of the array. */
-    for (i = 1; i < thread->differentialPointsLength; i += 2) {
-        thread->differentialPoints[i/2] = thread->differentialPoints[i];
-        thread->differentialPoints[i] = NULL;
-    }
+    /* Keep the odd-index points, in place */
+    LALInferenceDEBufferThin(thread->differentialBuffer);
 
-    newSize = thread->differentialPointsLength / 2;
-
-    /* Now shrink the buffer down. */
-    thread->differentialPoints = XLALRealloc(thread->differentialPoints, 2*newSize*sizeof(LALInferenceVariables *));
-    thread->differentialPointsSize = 2*newSize;
-    thread->differentialPointsLength = newSize;
+    thread->differentialPointsLength = thread->differentialBuffer->length;
     thread->differentialPointsSkip *= 2;
 }
 
 static void
 accumulateDifferentialEvolutionSample(LALInferenceThreadState *thread, size_t buffer_limit) {
-    if (thread->differentialPointsSize == thread->differentialPointsLength) {
-        size_t newSize = thread->differentialPointsSize*2;
+    if (thread->differentialBuffer == NULL)
+        thread->differentialBuffer = LALInferenceCreateDEBuffer(thread->currentParams, thread->differentialPointsSize);
 
-        if (buffer_limit < newSize) {
-            /* Then thin, and record sample. */
-            thinDifferentialEvolutionPoints(thread);
-            return accumulateDifferentialEvolutionSample(thread, buffer_limit);
-        } else {
-            thread->differentialPoints = XLALRealloc(thread->differentialPoints, newSize*sizeof(LALInferenceVariables *));
-            thread->differentialPointsSize = newSize;
-        }
+    LALInferenceDEBuffer *buffer = thread->differentialBuffer;
+    if (buffer->size == buffer->length && buffer_limit < 2*buffer->size) {
+        /* Then thin, and record sample. */
+        thinDifferentialEvolutionPoints(thread);
     }
 
-    thread->differentialPoints[thread->differentialPointsLength] = XLALCalloc(1, sizeof(LALInferenceVariables));
-    LALInferenceCopyVariables(thread->currentParams, thread->differentialPoints[thread->differentialPointsLength]);
+    if (LALInferenceDEBufferAppend(buffer, thread->currentParams) != XLAL_SUCCESS)
+        XLAL_ERROR_VOID(XLAL_EFUNC);
 
-    thread->differentialPointsLength += 1;
+    thread->differentialPointsLength = buffer->length;
+    thread->differentialPointsSize = buffer->size;
 }
 
 static void
 resetDifferentialEvolutionBuffer(LALInferenceThreadState *thread) {
-    size_t i;
+    if (thread->differentialBuffer)
+        LALInferenceDEBufferReset(thread->differentialBuffer);
 
-    for (i = 0; i < thread->differentialPointsLength; i++) {
-        LALInferenceClearVariables(thread->differentialPoints[i]);
-        XLALFree(thread->differentialPoints[i]);
-        thread->differentialPoints[i] = NULL;
-    }
-
-    thread->differentialPoints = XLALRealloc(thread->differentialPoints, sizeof(LALInferenceVariables *));
     thread->differentialPointsLength = 0;
-    thread->differentialPointsSize = 1;
     thread->differentialPointsSkip = LALInferenceGetINT4Variable(thread->proposalArgs, "de_skip");
 }
 
@@ -1220,7 +1192,8 @@ void LALInferenceCheckpointMCMC(LALInferenceRunState *runState) {
         */
 
         /* Create run identifier group */
-        LALInferenceH5VariablesArrayToDataset(chain_group, thread->differentialPoints, thread->differentialPointsLength, "differential_points");
+        if (thread->differentialBuffer)
+            LALInferenceH5DEBufferToDataset(chain_group, thread->differentialBuffer, "differential_points");
         LALInferenceH5VariablesArrayToDataset(chain_group, &(thread->proposalArgs), 1, "proposal_arguments");
         LALInferenceH5VariablesArrayToDataset(chain_group, &(thread->currentParams), 1, "current_parameters");
         XLALH5FileAddScalarAttribute(chain_group, "temperature", &(thread->temperature), LAL_D_TYPE_CODE);
@@ -1283,9 +1256,14 @@ void LALInferenceReadMCMCCheckpoint(LALInferenceRunState *runState) {
         */
 
         /* Restore differential evolution buffer */
-        LALH5Dataset *de_group = XLALH5DatasetRead(chain_group, "differential_points");
-        LALInferenceH5DatasetToVariablesArray(de_group, &(thread->differentialPoints), (UINT4 *)&(thread->differentialPointsLength));
-        thread->differentialPointsSize = thread->differentialPointsLength;
+        LALH5Dataset *de_group = NULL;
+        if (XLALH5FileCheckDatasetExists(chain_group, "differential_points")) {
+            de_group = XLALH5DatasetRead(chain_group, "differential_points");
+            LALInferenceDestroyDEBuffer(thread->differentialBuffer);
+            thread->differentialBuffer = LALInferenceH5DatasetToDEBuffer(de_group);
+            thread->differentialPointsLength = thread->differentialBuffer->length;
+            thread->differentialPointsSize = thread->differentialBuffer->size;
+        }
 
         /* Restore proposal arguments, most importantly adaptation settings */
         LALInferenceVariables **propArgs;
@@ -1848,14 +1826,29 @@ void LALInferenceDataDump(LALInferenceIFOData *data, LALInferenceModel *model) {
     }
     fclose(out);
 
+    /* sky position, polarisation and arrival time of the template */
+    REAL8 ra = LALInferenceGetREAL8Variable(model->params, "rightascension");
+    REAL8 dec = LALInferenceGetREAL8Variable(model->params, "declination");
+    REAL8 psi = LALInferenceGetREAL8Variable(model->params, "polarisation");
+    REAL8 GPSdouble = LALInferenceGetREAL8Variable(model->params, "time");
+    LIGOTimeGPS GPSlal;
+    XLALGPSSetREAL8(&GPSlal, GPSdouble);
+    REAL8 gmst = XLALGreenwichMeanSiderealTime(&GPSlal);
+
     while (data != NULL) {
+        REAL8 fPlus, fCross, timedelay, timeshift;
+        XLALComputeDetAMResponse(&fPlus, &fCross, (const REAL4(*)[3])data->detector->response, ra, dec, psi, gmst);
+        timedelay = XLALTimeDelayFromEarthCenter(data->detector->location, ra, dec, &GPSlal);
+        /* time shift of the template relative to the start of the data, as in InjectFD() */
+        timeshift = (GPSdouble - XLALGPSGetREAL8(&(data->timeData->epoch))) + timedelay;
+
         snprintf(filename, sizeof(filename), "%s-freqTemplateStrain.dat", data->name);
         out = fopen(filename, "w");
         for (ui = 0; ui < model->freqhCross->data->length; ui++) {
             REAL8 f = model->freqhCross->deltaF * ui;
             COMPLEX16 d;
-            d = data->fPlus * model->freqhPlus->data->data[ui] +
-            data->fCross * model->freqhCross->data->data[ui];
+            d = fPlus * model->freqhPlus->data->data[ui] +
+            fCross * model->freqhCross->data->data[ui];
 
             fprintf(out, "%g %g %g\n", f, creal(d), cimag(d) );
         }
@@ -1865,9 +1858,9 @@ void LALInferenceDataDump(LALInferenceIFOData *data, LALInferenceModel *model) {
         out = fopen(filename, "w");
         for (ui = 0; ui < model->timehCross->data->length; ui++) {
             REAL8 tt = XLALGPSGetREAL8(&(model->timehCross->epoch)) +
-            data->timeshift + ui*model->timehCross->deltaT;
-            REAL8 d = data->fPlus*model->timehPlus->data->data[ui] +
-            data->fCross*model->timehCross->data->data[ui];
+            timeshift + ui*model->timehCross->deltaT;
+            REAL8 d = fPlus*model->timehPlus->data->data[ui] +
+            fCross*model->timehCross->data->data[ui];
 
             fprintf(out, "%.6f %g\n", tt, d);
         }
@@ -31,8 +31,15 @@
 #include <lal/NormalizeSFTRngMed.h>
 #include <lal/LALString.h>
 #include <lal/PulsarCrossCorr_v2.h>
+#include <lal/SinCosLUT.h>
 #include "CrossCorrToplist.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp ignore
+#endif
+
 /**
  * \author B.Krishnan, S.Larson, J.T.Whelan, Y.Zhang
  * \date 2013, 2014, 2015
@@ -105,6 +112,17 @@ typedef struct{
 #define FALSE (1==0)
 #define MAXFILENAMELENGTH 512
 #define MAXLINELENGTH 1024
+#define TEMPLATE_BATCH_SIZE 1024 /* number of templates whose statistic is computed in one parallel batch */
+
+/* per-thread buffers used to compute the statistic of one template */
+typedef struct{
+  MultiSSBtimes *multiBinaryTimes;     /**< SSB times including binary orbit for the orbit below */
+  PulsarDopplerParams orbit;           /**< binary orbital parameters of multiBinaryTimes */
+  REAL8Vector *shiftedFreqs;
+  UINT4Vector *lowestBins;
+  COMPLEX8Vector *expSignalPhases;
+  REAL8VectorSequence *sincList;
+} CrossCorrWorkspace;
 
 /* local function prototypes */
 int XLALInitUserVars ( UserInput_t *uvar );
@@ -130,15 +148,10 @@ int main(int argc, char *argv[]){
   MultiAMCoeffs *multiCoeffs = NULL;
   SFTIndexList *sftIndices = NULL;
   SFTPairIndexList *sftPairs = NULL;
-  REAL8Vector *shiftedFreqs = NULL;
-  UINT4Vector *lowestBins = NULL;
-  COMPLEX8Vector *expSignalPhases = NULL;
-  REAL8VectorSequence *sincList = NULL;
   PulsarDopplerParams XLAL_INIT_DECL(dopplerpos);
   PulsarDopplerParams thisBinaryTemplate, binaryTemplateSpacings;
   PulsarDopplerParams minBinaryTemplate, maxBinaryTemplate;
   SkyPosition XLAL_INIT_DECL(skyPos);
-  MultiSSBtimes *multiBinaryTimes = NULL;
 
   INT4  k;
   UINT4 j;
@@ -643,8 +656,6 @@ int main(int argc, char *argv[]){
   REAL8 old_diagaa = 0;
   REAL8 old_diagTT = 0;
   REAL8 old_diagpp = 0;
-  REAL8 ccStat = 0;
-  REAL8 evSquared = 0;
   REAL8 estSens = 0; /*estimated sensitivity(4.13)*/
   REAL8 weightedMuTAve = 0;
 
@@ -683,29 +694,52 @@ int main(int argc, char *argv[]){
     XLAL_ERROR( XLAL_EFUNC );
   }
 
-  /* Allocate structure for binary doppler-shifting information */
-  if ((multiBinaryTimes = XLALDuplicateMultiSSBtimes ( multiSSBTimes )) == NULL){
-    LogPrintf ( LOG_CRITICAL, "%s: XLALDuplicateMultiSSBtimes() failed with errno=%d\n", __func__, xlalErrno );
-    XLAL_ERROR( XLAL_EFUNC );
-  }
-
+  /* Allocate binary doppler-shifting information and frequency buffers for each thread */
   UINT8 numSFTs = sftIndices->length;
-  if ((shiftedFreqs = XLALCreateREAL8Vector ( numSFTs ) ) == NULL){
-    LogPrintf ( LOG_CRITICAL, "%s: XLALCreateREAL8Vector() failed with errno=%d\n", __func__, xlalErrno );
-    XLAL_ERROR( XLAL_EFUNC );
+  UINT4 numThreads = 1;
+#ifdef _OPENMP
+  numThreads = omp_get_max_threads();
+#endif
+  CrossCorrWorkspace *workspaces = NULL;
+  if ((workspaces = XLALCalloc ( numThreads, sizeof(*workspaces) )) == NULL){
+    LogPrintf ( LOG_CRITICAL, "%s: XLALCalloc() failed with errno=%d\n", __func__, xlalErrno );
+    XLAL_ERROR( XLAL_ENOMEM );
   }
-  if ((lowestBins = XLALCreateUINT4Vector ( numSFTs ) ) == NULL){
-    LogPrintf ( LOG_CRITICAL, "%s: XLALCreateUINT4Vector() failed with errno=%d\n", __func__, xlalErrno );
-    XLAL_ERROR( XLAL_EFUNC );
+  for (UINT4 t = 0; t < numThreads; t++){
+    CrossCorrWorkspace *ws = &workspaces[t];
+    if ((ws->multiBinaryTimes = XLALDuplicateMultiSSBtimes ( multiSSBTimes )) == NULL){
+      LogPrintf ( LOG_CRITICAL, "%s: XLALDuplicateMultiSSBtimes() failed with errno=%d\n", __func__, xlalErrno );
+      XLAL_ERROR( XLAL_EFUNC );
+    }
+    ws->orbit.asini = -1; /* no orbit applied yet */
+    if ((ws->shiftedFreqs = XLALCreateREAL8Vector ( numSFTs ) ) == NULL){
+      LogPrintf ( LOG_CRITICAL, "%s: XLALCreateREAL8Vector() failed with errno=%d\n", __func__, xlalErrno );
+      XLAL_ERROR( XLAL_EFUNC );
+    }
+    if ((ws->lowestBins = XLALCreateUINT4Vector ( numSFTs ) ) == NULL){
+      LogPrintf ( LOG_CRITICAL, "%s: XLALCreateUINT4Vector() failed with errno=%d\n", __func__, xlalErrno );
+      XLAL_ERROR( XLAL_EFUNC );
+    }
+    if ((ws->expSignalPhases = XLALCreateCOMPLEX8Vector ( numSFTs ) ) == NULL){
+      LogPrintf ( LOG_CRITICAL, "%s: XLALCreateCOMPLEX8Vector() failed with errno=%d\n", __func__, xlalErrno );
+      XLAL_ERROR( XLAL_EFUNC );
+    }
+    if ((ws->sincList = XLALCreateREAL8VectorSequence ( numSFTs, uvar.numBins ) ) == NULL){
+      LogPrintf ( LOG_CRITICAL, "%s: XLALCreateREAL8VectorSequence() failed with errno=%d\n", __func__, xlalErrno );
+      XLAL_ERROR( XLAL_EFUNC );
+    }
   }
 
-  if ((expSignalPhases = XLALCreateCOMPLEX8Vector ( numSFTs ) ) == NULL){
-    LogPrintf ( LOG_CRITICAL, "%s: XLALCreateREAL8Vector() failed with errno=%d\n", __func__, xlalErrno );
-    XLAL_ERROR( XLAL_EFUNC );
-  }
-  if ((sincList = XLALCreateREAL8VectorSequence ( numSFTs, uvar.numBins ) ) == NULL){
-    LogPrintf ( LOG_CRITICAL, "%s: XLALCreateREAL8VectorSequence() failed with errno=%d\n", __func__, xlalErrno );
-    XLAL_ERROR( XLAL_EFUNC );
+  /* Templates are collected serially into batches, whose statistics are then computed in parallel */
+  PulsarDopplerParams *batchTemplates = NULL;
+  REAL8 *batchRho = NULL, *batchEvSquared = NULL;
+  int *batchStatus = NULL;
+  if ((batchTemplates = XLALCalloc ( TEMPLATE_BATCH_SIZE, sizeof(*batchTemplates) )) == NULL
+      || (batchRho = XLALCalloc ( TEMPLATE_BATCH_SIZE, sizeof(*batchRho) )) == NULL
+      || (batchEvSquared = XLALCalloc ( TEMPLATE_BATCH_SIZE, sizeof(*batchEvSquared) )) == NULL
+      || (batchStatus = XLALCalloc ( TEMPLATE_BATCH_SIZE, sizeof(*batchStatus) )) == NULL){
+    LogPrintf ( LOG_CRITICAL, "%s: XLALCalloc() failed with errno=%d\n", __func__, xlalErrno );
+    XLAL_ERROR( XLAL_ENOMEM );
   }
 
    /* "New" general metric computation */
@@ -798,49 +832,84 @@ int main(int argc, char *argv[]){
 
   /* args should be : spacings, min and max doppler params */
   BOOLEAN firstPoint = TRUE; /* a boolean to help to search at the beginning point in parameter space, after the search it is set to be FALSE to end the loop*/
-  if ( (XLALAddMultiBinaryTimes( &multiBinaryTimes, multiSSBTimes, &dopplerpos )  != XLAL_SUCCESS ) ) {
-    LogPrintf ( LOG_CRITICAL, "%s: XLALAddMultiBinaryTimes() failed with errno=%d\n", __func__, xlalErrno );
-    XLAL_ERROR( XLAL_EFUNC );
-  } /*Need to apply additional doppler shifting before the loop, or the first point in parameter space will be lost and return a wrong SNR when fBand!=0*/
+  /* The binary doppler shifting is applied per template inside the batch loop below, so the first point in parameter space */
+  /* gets its own orbit; dopplerShiftFlag is therefore not needed, each thread instead checks whether the orbit has changed */
 
-  while ( GetNextCrossCorrTemplate(&dopplerShiftFlag, &firstPoint, &dopplerpos, &binaryTemplateSpacings, &minBinaryTemplate, &maxBinaryTemplate, &fCount, &aCount, &tCount, &pCount, fSpacingNum, aSpacingNum, tSpacingNum, pSpacingNum) == 0)
-    {
-      /* do useful stuff here*/
+  /* initialise the sin/cos lookup table before it is used by several threads */
+  XLALSinCosLUTInit();
 
-      /* Apply additional Doppler shifting using current binary orbital parameters */
-      /* Might want to be clever about checking whether we've changed the orbital parameters or only the frequency */
-      if (dopplerShiftFlag == TRUE)
+  BOOLEAN moreTemplates = TRUE;
+  while ( moreTemplates )
+    {
+      /* collect the next batch of templates */
+      UINT4 numInBatch = 0;
+      while ( numInBatch < TEMPLATE_BATCH_SIZE )
 	{
-	  if ( (XLALAddMultiBinaryTimes( &multiBinaryTimes, multiSSBTimes, &dopplerpos )  != XLAL_SUCCESS ) ) {
-	    LogPrintf ( LOG_CRITICAL, "%s: XLALAddMultiBinaryTimes() failed with errno=%d\n", __func__, xlalErrno );
-	    XLAL_ERROR( XLAL_EFUNC );
-	  }
+	  if ( GetNextCrossCorrTemplate(&dopplerShiftFlag, &firstPoint, &dopplerpos, &binaryTemplateSpacings, &minBinaryTemplate, &maxBinaryTemplate, &fCount, &aCount, &tCount, &pCount, fSpacingNum, aSpacingNum, tSpacingNum, pSpacingNum) != 0 )
+	    {
+	      moreTemplates = FALSE;
+	      break;
+	    }
+	  batchTemplates[numInBatch++] = dopplerpos;
 	}
 
-      if ( (XLALGetDopplerShiftedFrequencyInfo( shiftedFreqs, lowestBins, expSignalPhases, sincList, uvar.numBins, &dopplerpos, sftIndices, inputSFTs, multiBinaryTimes, badBins, Tsft )  != XLAL_SUCCESS ) ) {
-	LogPrintf ( LOG_CRITICAL, "%s: XLALGetDopplerShiftedFrequencyInfo() failed with errno=%d\n", __func__, xlalErrno );
-	XLAL_ERROR( XLAL_EFUNC );
-      }
+      /* compute the statistic for all templates in the batch; templates in a static chunk mostly share their orbit, */
+      /* so each thread only recomputes the binary SSB times when the orbital parameters change */
+#pragma omp parallel for schedule(static)
+      for (UINT4 n = 0; n < numInBatch; n++)
+	{
+	  int threadNum = 0;
+#ifdef _OPENMP
+	  threadNum = omp_get_thread_num();
+#endif
+	  CrossCorrWorkspace *ws = &workspaces[threadNum];
+	  PulsarDopplerParams *thisTemplate = &batchTemplates[n];
+	  batchStatus[n] = XLAL_SUCCESS;
+
+	  if ( ws->orbit.asini != thisTemplate->asini || ws->orbit.period != thisTemplate->period || ws->orbit.ecc != thisTemplate->ecc
+	       || ws->orbit.argp != thisTemplate->argp || XLALGPSCmp( &ws->orbit.tp, &thisTemplate->tp ) != 0 )
+	    {
+	      if ( (XLALAddMultiBinaryTimes( &ws->multiBinaryTimes, multiSSBTimes, thisTemplate )  != XLAL_SUCCESS ) ) {
+		batchStatus[n] = XLAL_EFUNC;
+		ws->orbit.asini = -1;
+		continue;
+	      }
+	      ws->orbit = *thisTemplate;
+	    }
 
-      if ( (XLALCalculatePulsarCrossCorrStatistic( &ccStat, &evSquared, GammaAve, expSignalPhases, lowestBins, sincList, sftPairs, sftIndices, inputSFTs, multiWeights, uvar.numBins)  != XLAL_SUCCESS ) ) {
-	LogPrintf ( LOG_CRITICAL, "%s: XLALCalculatePulsarCrossCorrStatistic() failed with errno=%d\n", __func__, xlalErrno );
-	XLAL_ERROR( XLAL_EFUNC );
-      }
+	  if ( (XLALGetDopplerShiftedFrequencyInfo( ws->shiftedFreqs, ws->lowestBins, ws->expSignalPhases, ws->sincList, uvar.numBins, thisTemplate, sftIndices, inputSFTs, ws->multiBinaryTimes, badBins, Tsft )  != XLAL_SUCCESS ) ) {
+	    batchStatus[n] = XLAL_EFUNC;
+	    continue;
+	  }
 
-      /* fill candidate struct and insert into toplist if necessary */
-      thisCandidate.freq = dopplerpos.fkdot[0];
-      thisCandidate.tp = XLALGPSGetREAL8( &dopplerpos.tp );
-      thisCandidate.argp = dopplerpos.argp;
-      thisCandidate.asini = dopplerpos.asini;
-      thisCandidate.ecc = dopplerpos.ecc;
-      thisCandidate.period = dopplerpos.period;
-      thisCandidate.rho = ccStat;
-      thisCandidate.evSquared = evSquared;
-      thisCandidate.estSens = estSens;
+	  if ( (XLALCalculatePulsarCrossCorrStatisticBlocked( &batchRho[n], &batchEvSquared[n], GammaAve, ws->expSignalPhases, ws->lowestBins, ws->sincList, sftPairs, sftIndices, inputSFTs, multiWeights, uvar.numBins)  != XLAL_SUCCESS ) ) {
+	    batchStatus[n] = XLAL_EFUNC;
+	    continue;
+	  }
+	} /* end parallel loop over batch */
 
-      insert_into_crossCorrBinary_toplist(ccToplist, thisCandidate);
+      /* fill candidate structs and insert into toplist if necessary, in template order */
+      for (UINT4 n = 0; n < numInBatch; n++)
+	{
+	  if ( batchStatus[n] != XLAL_SUCCESS ) {
+	    LogPrintf ( LOG_CRITICAL, "%s: computing the statistic of template %u of the batch failed\n", __func__, n );
+	    XLAL_ERROR( XLAL_EFUNC );
+	  }
+	  const PulsarDopplerParams *thisTemplate = &batchTemplates[n];
+	  thisCandidate.freq = thisTemplate->fkdot[0];
+	  thisCandidate.tp = XLALGPSGetREAL8( &thisTemplate->tp );
+	  thisCandidate.argp = thisTemplate->argp;
+	  thisCandidate.asini = thisTemplate->asini;
+	  thisCandidate.ecc = thisTemplate->ecc;
+	  thisCandidate.period = thisTemplate->period;
+	  thisCandidate.rho = batchRho[n];
+	  thisCandidate.evSquared = batchEvSquared[n];
+	  thisCandidate.estSens = estSens;
+
+	  insert_into_crossCorrBinary_toplist(ccToplist, thisCandidate);
+	}
 
-    } /* end while loop over templates */
+    } /* end while loop over template batches */
 
   /* write candidates to file */
   sort_crossCorrBinary_toplist( ccToplist );
@@ -915,11 +984,18 @@ int main(int argc, char *argv[]){
   /* FIXME: Need to destroy badBins */
 
   XLALFree(VCSInfoString);
-  XLALDestroyCOMPLEX8Vector ( expSignalPhases );
-  XLALDestroyUINT4Vector ( lowestBins );
-  XLALDestroyREAL8Vector ( shiftedFreqs );
-  XLALDestroyREAL8VectorSequence ( sincList );
-  XLALDestroyMultiSSBtimes ( multiBinaryTimes );
+  for (UINT4 t = 0; t < numThreads; t++){
+    XLALDestroyCOMPLEX8Vector ( workspaces[t].expSignalPhases );
+    XLALDestroyUINT4Vector ( workspaces[t].lowestBins );
+    XLALDestroyREAL8Vector ( workspaces[t].shiftedFreqs );
+    XLALDestroyREAL8VectorSequence ( workspaces[t].sincList );
+    XLALDestroyMultiSSBtimes ( workspaces[t].multiBinaryTimes );
+  }
+  XLALFree ( workspaces );
+  XLALFree ( batchTemplates );
+  XLALFree ( batchRho );
+  XLALFree ( batchEvSquared );
+  XLALFree ( batchStatus );
   XLALDestroyMultiSSBtimes ( multiSSBTimes );
   XLALDestroyREAL8Vector ( GammaAve );
   XLALDestroySFTPairIndexList( sftPairs );
@@ -713,7 +713,7 @@ int main(int argc,char *argv[])
 
           /* compute Fstat map F_mn over {t0, tau} */
           tic = GETTIME();
-          XLAL_CHECK_MAIN ( (transientCand.FstatMap = XLALComputeTransientFstatMap ( thisFAtoms, GV.transientWindowRange, uvar.transient_useFReg)) != NULL, XLAL_EFUNC );
+          XLAL_CHECK_MAIN ( (transientCand.FstatMap = XLALComputeTransientFstatMapIncremental ( thisFAtoms, GV.transientWindowRange, uvar.transient_useFReg)) != NULL, XLAL_EFUNC );
           toc = GETTIME();
           timing.tauTransFstatMap += (toc - tic); // time to compute transient Fstat-map
 
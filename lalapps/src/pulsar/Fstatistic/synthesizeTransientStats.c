@@ -261,8 +261,8 @@ int main(int argc,char *argv[])
       if ( fpTransientStats || uvar.outputFstatMap || uvar.outputPosteriors )
         {
           /* compute Fstat map F_mn over {t0, tau} */
-          if ( (cand.FstatMap = XLALComputeTransientFstatMap ( multiAtoms, cand.windowRange, uvar.useFReg)) == NULL ) {
-            XLALPrintError ("%s: XLALComputeTransientFstatMap() failed with xlalErrno = %d.\n", __func__, xlalErrno );
+          if ( (cand.FstatMap = XLALComputeTransientFstatMapIncremental ( multiAtoms, cand.windowRange, uvar.useFReg)) == NULL ) {
+            XLALPrintError ("%s: XLALComputeTransientFstatMapIncremental() failed with xlalErrno = %d.\n", __func__, xlalErrno );
             XLAL_ERROR ( XLAL_EFUNC );
           }
         } /* if we'll need the Fstat-map F_mn */
@@ -321,8 +321,8 @@ int main(int argc,char *argv[])
           winRangeAll.type = TRANSIENT_NONE;
 
           BOOLEAN useFReg = false;
-          if ( (FtotalMap = XLALComputeTransientFstatMap ( multiAtoms, winRangeAll, useFReg)) == NULL ) {
-            XLALPrintError ("%s: XLALComputeTransientFstatMap() failed with xlalErrno = %d.\n", __func__, xlalErrno );
+          if ( (FtotalMap = XLALComputeTransientFstatMapIncremental ( multiAtoms, winRangeAll, useFReg)) == NULL ) {
+            XLALPrintError ("%s: XLALComputeTransientFstatMapIncremental() failed with xlalErrno = %d.\n", __func__, xlalErrno );
             XLAL_ERROR ( XLAL_EFUNC );
           }
 
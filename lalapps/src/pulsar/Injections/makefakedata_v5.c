@@ -114,6 +114,7 @@ typedef struct
   REAL8 fmin;		/**< Lowest frequency in output SFT (= heterodyning frequency) */
   REAL8 Band;		/**< bandwidth of output SFT in Hz (= 1/2 sampling frequency) */
   REAL8 sourceDeltaT;   /**< source-frame sampling period. '0' implies previous internal defaults */
+  BOOLEAN bandLimited;	/**< generate SFTs per contiguous stretch of timestamps at the minimal sampling rate (no timeseries output) */
 
   /* SFT params */
   REAL8 Tsft;		        /**< SFT time baseline Tsft */
@@ -197,6 +198,7 @@ main(int argc, char *argv[])
   DataParams.SFTWindowType      = uvar.SFTWindowType;
   DataParams.SFTWindowBeta      = uvar.SFTWindowBeta;
   DataParams.sourceDeltaT       = uvar.sourceDeltaT;
+  DataParams.bandLimited        = uvar.bandLimited;
   if ( GV.inputMultiTS == NULL )
     {
       DataParams.fMin               = GV.fminOut;
@@ -210,7 +212,7 @@ main(int argc, char *argv[])
       DataParams.inputMultiTS       = GV.inputMultiTS;
     }
 
-  XLAL_CHECK ( XLALCWMakeFakeMultiData ( &mSFTs, &mTseries, injectionSources, &DataParams, GV.edat ) == XLAL_SUCCESS, XLAL_EFUNC );
+  XLAL_CHECK ( XLALCWMakeFakeMultiData ( &mSFTs, uvar.bandLimited ? NULL : &mTseries, injectionSources, &DataParams, GV.edat ) == XLAL_SUCCESS, XLAL_EFUNC );
 
   XLALDestroyPulsarParamsVector ( injectionSources );
   injectionSources = NULL;
@@ -592,6 +594,10 @@ XLALInitMakefakedata ( ConfigVars_t *cfg, UserVariables_t *uvar )
   }
 #endif
 
+  // band-limited generation only produces SFTs
+  XLAL_CHECK ( !uvar->bandLimited || ( (uvar->TDDfile == NULL) && (cfg->outFrameDir == NULL) && (cfg->inputMultiTS == NULL) ), XLAL_EINVAL,
+               "--bandLimited can only produce SFTs, and is incompatible with --TDDfile, --outFrameDir and --inFrames\n");
+
   return XLAL_SUCCESS;
 
 } /* XLALInitMakefakedata() */
@@ -670,6 +676,7 @@ XLALInitUserVars ( UserVariables_t *uvar, int argc, char *argv[] )
   // ----- 'expert-user/developer' options ----- (only shown in help at lalDebugLevel >= warning)
   XLALRegisterUvarMember(   randSeed,             INT4, 0, DEVELOPER, "Specify random-number seed for reproducible noise (0 means use /dev/urandom for seeding).");
   XLALRegisterUvarMember(  sourceDeltaT,        REAL8,  0, DEVELOPER, "Source-frame sampling period. '0' implies previous internal defaults" );
+  XLALRegisterUvarMember(  bandLimited,        BOOLEAN, 0, DEVELOPER, "Generate SFTs (only) per contiguous stretch of timestamps at the minimal sampling rate 2*Band, with injection sources in parallel" );
 
   // ----- deprecated but still supported options [throw warning if used] (only shown in help at lalDebugLevel >= info) ----------
 #ifdef HAVE_LIBLALFRAME
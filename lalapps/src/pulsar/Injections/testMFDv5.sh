@@ -254,6 +254,21 @@ if ! eval $cmdline2; then
     exit 1
 fi
 
+echo
+echo "----- Method 3: signals only, generated in the default and band-limited modes"
+outIFOs="--IFOs=${IFO1},${IFO2} --timestampsFiles=${timestamps1},${timestamps2}"
+cmdline1="$mfdv5_CL ${outIFOs} ${sig13} --outLabel='mfdv5_sigonly'"
+echo $cmdline1;
+if ! eval $cmdline1; then
+    echo "Error.. something failed when running '$mfdv5_CODE' ..."
+    exit 1
+fi
+cmdline2="$mfdv5_CL ${outIFOs} ${sig13} --bandLimited --outLabel='mfdv5_bandlim'"
+echo $cmdline2;
+if ! eval $cmdline2; then
+    echo "Error.. something failed when running '$mfdv5_CODE' ..."
+    exit 1
+fi
 
 echo
 echo "--------------------------------------------------"
@@ -299,6 +314,19 @@ else
     echo "OK."
 fi
 
+echo
+echo "---------- compare mfdv5 Method 3 SFTs ----------"
+for IFO in H L; do
+    cmdline="$cmp_CODE -e ${tol} -1 '${testDIR}/${IFO}-*_mfdv5_sigonly-*.sft' -2 '${testDIR}/${IFO}-*_mfdv5_bandlim-*.sft'"
+    echo ${cmdline}
+    if ! eval $cmdline; then
+        echo "Failed. SFTs produced by default and band-limited generation differ by more than ${tol}!"
+        exit 2
+    else
+        echo "OK."
+    fi
+done
+
 
 ## clean up files [allow turning off via 'NOCLEANUP' environment variable
 if [ -z "$NOCLEANUP" ]; then
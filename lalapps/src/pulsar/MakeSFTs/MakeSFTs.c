@@ -57,6 +57,7 @@
 /* 06/26/07 gam; Use finite to check that data does not contains a non-FINITE (+/- Inf, NaN) values, based on sftlib/SFTvalidate.c */
 /* 10/05/12 gam; Add to version 2 normalization one over the root mean square of the window function (defined here as winFncRMS) as per RedMine LALSuite CW Bug #560*/
 /* 24/07/14 eag; Change default SFT output to version 2 per RedMine LALSuite CW patch #1518 */
+/* Add --num-threads, --queue-depth and --merged-sfts options: pipelined mode where frame reading, filtering/windowing/FFTs and writing of SFTs overlap */
 
 #include <config.h>
 #if !defined HAVE_LIBGSL || !defined HAVE_LIBLALFRAME
@@ -102,6 +103,11 @@ int main(void) {fputs("disabled, no gsl or no lal frame library support.\n", std
 #include <lal/LALVCSInfo.h>
 #include <LALAppsVCSInfo.h>
 
+#include <lal/LALConfig.h>
+#ifdef LAL_PTHREAD_LOCK
+#include <pthread.h>
+#endif
+
 #ifdef PSS_ENABLED
 #include <XLALPSSInterface.h>
 #endif
@@ -146,8 +152,26 @@ struct CommandLineArgsTag {
   REAL8 overlapFraction;   /* 12/28/05 gam; overlap fraction (for use with windows; e.g., use -P 0.5 with -w 3 Hann windows; default is 1.0). */
   BOOLEAN useSingle;       /* 11/19/05 gam; use single rather than double precision */
   char *frameStructType;   /* 01/10/07 gam */
+  INT4 numThreads;         /* number of filtering/windowing/FFT worker threads in pipelined mode; 0 = process SFTs one at a time */
+  INT4 queueDepth;         /* maximum number of SFTs held in memory in pipelined mode; 0 = choose from numThreads */
+  BOOLEAN mergedSFTs;      /* write all SFTs into a single merged version 2 SFT file */
 } CommandLineArgs;
 
+/* one SFT travelling through the pipeline from the reader, through a worker, to the writer */
+typedef struct tagSFTPipelineSlot {
+  REAL8Vector *data;       /* time series data of the SFT */
+  COMPLEX16Vector *fft;    /* its FFT */
+  LIGOTimeGPS epoch;       /* start time of the SFT */
+  REAL8 deltaT;            /* sampling interval of the time series */
+  REAL8 winFncRMS;         /* RMS of the window function applied to this SFT */
+  INT4 state;              /* one of the SFT_SLOT_... values below */
+} SFTPipelineSlot;
+
+#define SFT_SLOT_FREE      0 /* slot may be filled by the reader */
+#define SFT_SLOT_READ      1 /* data has been read, waiting for a worker */
+#define SFT_SLOT_BUSY      2 /* a worker is filtering, windowing and FFTing the data */
+#define SFT_SLOT_PROCESSED 3 /* FFT is done, waiting for the writer */
+
 struct headertag {
   REAL8 endian;
   INT4  gps_sec;
@@ -224,6 +248,14 @@ int CreateSFT(struct CommandLineArgsTag CLA);
 int WriteSFT(struct CommandLineArgsTag CLA);
 int WriteVersion2SFT(struct CommandLineArgsTag CLA);
 
+/* pipelined mode: overlap reading, processing and writing of SFTs */
+int RunSFTPipeline(struct CommandLineArgsTag CLA);
+
+/* windows for double precision data, also used in pipelined mode */
+int WindowTukeyREAL8Vector(REAL8Vector *data, REAL8 r, REAL8 *rms);
+int WindowTukey2REAL8Vector(REAL8Vector *data, REAL8 *rms);
+int WindowHannREAL8Vector(REAL8Vector *data, REAL8 *rms);
+
 /* Frees the memory */
 int FreeMem(struct CommandLineArgsTag CLA);
 
@@ -233,6 +265,7 @@ void getSFTDescField(CHAR *sftDescField, CHAR *numSFTs, CHAR *ifo, CHAR *stringT
 void mkSFTDir(CHAR *sftPath, CHAR *site, CHAR *numSFTs, CHAR *ifo, CHAR *stringT, CHAR *typeMisc,CHAR *gpstime, INT4 numGPSdigits);
 void mkSFTFilename(CHAR *sftFilename, CHAR *site, CHAR *numSFTs, CHAR *ifo, CHAR *stringT, CHAR *typeMisc,CHAR *gpstime);
 void mvFilenames(CHAR *filename1, CHAR *filename2);
+void mkVersion2SFTPath(CHAR *sftname, CHAR *sftnameFinal, CHAR *ifo, struct CommandLineArgsTag CLA, LIGOTimeGPS epoch);
 
 
 /* -------------------- function definitions -------------------- */
@@ -307,6 +340,49 @@ void mvFilenames(CHAR *filename1, CHAR *filename2) {
      if ( system(mvFilenamesCommand) ) XLALPrintError ("system() returned non-zero status\n");
 }
 
+/* set up the (temporary and final) version 2 SFT file name for an SFT starting at epoch, and the ifo string (at least 3 characters) */
+void mkVersion2SFTPath(CHAR *sftname, CHAR *sftnameFinal, CHAR *ifo, struct CommandLineArgsTag CLA, LIGOTimeGPS epoch) {
+  char sftFilename[256];
+  char numSFTs[2]; /* 12/27/05 gam */
+  char site[2];    /* 12/27/05 gam */
+  char gpstime[11]; /* 12/27/05 gam; allow for 10 digit GPS times and null termination */
+
+  /* 12/27/05 gam; set up the number of SFTs, site, and ifo as null terminated strings */
+  numSFTs[0] = '1';
+  numSFTs[1] = '\0'; /* null terminate */
+  strncpy( site, CLA.ChannelName, 1 );
+  site[1] = '\0'; /* null terminate */
+  if (CLA.IFO != NULL) {
+    strncpy( ifo, CLA.IFO, 2 );
+  } else {  
+    strncpy( ifo, CLA.ChannelName, 2 );
+  }
+  ifo[2] = '\0'; /* null terminate */
+  sprintf(gpstime,"%09d",epoch.gpsSeconds);
+
+  strcpy( sftname, CLA.SFTpath );
+  /* 12/27/05 gam; add option to make directories based on gps time */
+  if (CLA.makeGPSDirs > 0) {
+     /* 12/27/05 gam; concat to the sftname the directory name based on GPS time; make this directory if it does not already exist */
+     mkSFTDir(sftname, site, numSFTs, ifo, CLA.stringT, CLA.miscDesc, gpstime, CLA.makeGPSDirs);
+  }
+
+  strcat(sftname,"/");
+  mkSFTFilename(sftFilename, site, numSFTs, ifo, CLA.stringT, CLA.miscDesc, gpstime);
+  /* 01/09/06 gam; sftname will be temporary; will move to sftnameFinal. */
+  if(CLA.makeTmpFile) {
+    /* set up sftnameFinal with usual SFT name */
+    strcpy(sftnameFinal,sftname);
+    strcat(sftnameFinal,sftFilename);
+    /* sftname begins with . and ends in .tmp */
+    strcat(sftname,".");
+    strcat(sftname,sftFilename);
+    strcat(sftname,".tmp");
+  } else {
+    strcat(sftname,sftFilename);
+  }  
+}
+
 #if TRACKMEMUSE
 void printmemuse() {
    pid_t mypid=getpid();
@@ -511,6 +587,13 @@ int main(int argc,char *argv[])
   /* Allocates space for data */
   if (AllocateData(CommandLineArgs)) return 2;
 
+  /* pipelined mode: reading, processing and writing of SFTs overlap */
+  if (CommandLineArgs.numThreads > 0 || CommandLineArgs.mergedSFTs) {
+    if (RunSFTPipeline(CommandLineArgs)) return 10;
+    if (FreeMem(CommandLineArgs)) return 8;
+    return 0;
+  }
+
   /* for(j=0; j < SegmentDuration/CommandLineArgs.T; j++) */ /* 12/28/05 gam */
   while(gpsepoch.gpsSeconds + CommandLineArgs.T <= CommandLineArgs.GPSEnd)
     {
@@ -598,6 +681,9 @@ int ReadCommandLine(int argc,char *argv[],struct CommandLineArgsTag *CLA)
     {"window-radius",        required_argument, NULL,          'r'},
     {"overlap-fraction",     required_argument, NULL,          'P'},
     {"td-cleaning",          no_argument,       NULL,          'a'},
+    {"num-threads",          required_argument, NULL,          518},
+    {"queue-depth",          required_argument, NULL,          519},
+    {"merged-sfts",          no_argument,       NULL,          520},
 #ifdef PSS_ENABLED
     {"pss-freq",             required_argument, NULL,          'b'},
     {"pss-abs",              required_argument, NULL,          512},
@@ -639,6 +725,9 @@ int ReadCommandLine(int argc,char *argv[],struct CommandLineArgsTag *CLA)
   CLA->PSSCleaning = 0;	     /* 1=YES and 0=NO*/
   CLA->PSSCleanHPf = 100.0;  /* Cut frequency for the bilateral highpass filter. It has to be used only if PSSCleaning is YES. defaults to 100Hz */
   CLA->PSSCleanExt = 1;      /* by default, extend the timeseries */
+  CLA->numThreads = 0;       /* by default, process SFTs one at a time */
+  CLA->queueDepth = 0;
+  CLA->mergedSFTs = 0;
 
   strcat(allargs, "\nMakeSFTs ");
   strcat(allargs, lalVCSIdentInfo.vcsId);
@@ -775,6 +864,15 @@ int ReadCommandLine(int argc,char *argv[],struct CommandLineArgsTag *CLA)
     case 'b':
       CLA->PSSCleanHPf = atof(LALoptarg);
       break;
+    case 518:
+      CLA->numThreads = atoi(LALoptarg);
+      break;
+    case 519:
+      CLA->queueDepth = atoi(LALoptarg);
+      break;
+    case 520:
+      CLA->mergedSFTs = 1;
+      break;
 #ifdef PSS_ENABLED
     case 512:
       XLALPSSParams.abs  = atof(LALoptarg);
@@ -825,6 +923,9 @@ int ReadCommandLine(int argc,char *argv[],struct CommandLineArgsTag *CLA)
       fprintf(stdout,"\tuse-single (-S)\t\tFLAG\t (optional) Use single precision for window, plan, and fft; double precision filtering is always done.\n");
       fprintf(stdout,"\tframe-struct-type (-u)\tSTRING\t (optional) String specifying the input frame structure and data type. Must begin with ADC_ or PROC_ followed by REAL4, REAL8, INT2, INT4, or INT8; default: ADC_REAL4; -H is the same as PROC_REAL8.\n");
       fprintf(stdout,"\ttd-cleaning (-a)\tFLAG\t Use time-domain cleaning with PSS routines\n");
+      fprintf(stdout,"\tnum-threads       \tINT\t (optional) Number of threads filtering, windowing and FFTing SFTs while others are read and written; default is 0 = make one SFT at a time.\n");
+      fprintf(stdout,"\tqueue-depth       \tINT\t (optional) Maximum number of SFTs held in memory with num-threads > 0; default is 0 = 2*num-threads+2.\n");
+      fprintf(stdout,"\tmerged-sfts       \tFLAG\t (optional) Write all SFTs into a single merged version 2 SFT file.\n");
 #ifdef PSS_ENABLED
       fprintf(stdout,"\tpss-freq (-b)      \tFLOAT\t Cut frequency for the bilateral highpass filter for time-domain cleaning\n");
       fprintf(stdout,"\tpss-abs            \tFLOAT\t (optional) Set PSS parameter 'abs' for time-domain cleaning\n");
@@ -915,6 +1016,24 @@ int ReadCommandLine(int argc,char *argv[],struct CommandLineArgsTag *CLA)
       fprintf(stderr,"Try %s -h \n", argv[0]);
       return 1;
     }
+  if( (CLA->numThreads < 0) || (CLA->queueDepth < 0) )
+    {
+      fprintf(stderr,"Illegal num-threads or queue-depth given.\n");
+      fprintf(stderr,"Try %s -h \n", argv[0]);
+      return 1;
+    }
+  if( (CLA->numThreads > 0 || CLA->mergedSFTs) && (CLA->sftVersion != 2 || CLA->useSingle || CLA->PSSCleaning) )
+    {
+      fprintf(stderr,"The num-threads and merged-sfts options require version 2 SFTs in double precision without time-domain cleaning.\n");
+      fprintf(stderr,"Try %s -h \n", argv[0]);
+      return 1;
+    }
+  if( CLA->mergedSFTs && CLA->makeGPSDirs > 0 )
+    {
+      fprintf(stderr,"The merged-sfts option cannot be combined with make-gps-dirs.\n");
+      fprintf(stderr,"Try %s -h \n", argv[0]);
+      return 1;
+    }
   if(CLA->FrCacheFile == NULL)
     {
       fprintf(stderr,"No frame cache file specified.\n");
@@ -1537,26 +1656,11 @@ int WindowData(struct CommandLineArgsTag CLA)
         printf("\nExample dataSingle values after windowing data in WindowData:\n"); printExampleDataSingle();
     #endif
   } else {
-    N=dataDouble.data->length;
-    kl=r/2*(N-1)+1;
-    kh=N-r/2*(N-1)+1;
-    for(k = 1; k < kl; k++) 
-    {
-      /* dataDouble.data->data[k-1]=dataDouble.data->data[k-1]*0.5*( 1.0 + cos(LAL_TWOPI/r*(k-1)/(N-1) - LAL_PI) ); */
-      win = 0.5*( 1.0 + cos(LAL_TWOPI/r*(k-1)/(N-1) - LAL_PI) );
-      dataDouble.data->data[k-1] *= win;
-      winFncRMS += win*win;
-    }
-    for(k = kh; k <= N; k++) 
-    {
-      /* dataDouble.data->data[k-1]=dataDouble.data->data[k-1]*0.5*( 1.0 + cos(LAL_TWOPI/r - LAL_TWOPI/r*(k-1)/(N-1) - LAL_PI) ); */
-      win = 0.5*( 1.0 + cos(LAL_TWOPI/r - LAL_TWOPI/r*(k-1)/(N-1) - LAL_PI) );
-      dataDouble.data->data[k-1] *= win;
-      winFncRMS += win*win;
-    }
+    if (WindowTukeyREAL8Vector(dataDouble.data, r, &winFncRMS)) return 5;
     #if PRINTEXAMPLEDATA
         printf("\nExample dataDouble values after windowing data in WindowData:\n"); printExampleDataDouble();
     #endif    
+    return 0;
   }
 
   /* Add to sum of squares of the window function the parts of window which are equal to 1, and then find RMS value*/
@@ -1567,6 +1671,37 @@ int WindowData(struct CommandLineArgsTag CLA)
 }
 /*******************************************************************************/
 
+/*******************************************************************************/
+/* Matlab style Tukey window of double precision data; the RMS of the window function is returned in rms */
+int WindowTukeyREAL8Vector(REAL8Vector *data, REAL8 r, REAL8 *rms)
+{
+  INT4 k, N, kl, kh;
+  REAL8 win, sumsq = 0.0;
+
+  N=data->length;
+  kl=r/2*(N-1)+1;
+  kh=N-r/2*(N-1)+1;
+  for(k = 1; k < kl; k++) 
+  {
+    win = 0.5*( 1.0 + cos(LAL_TWOPI/r*(k-1)/(N-1) - LAL_PI) );
+    data->data[k-1] *= win;
+    sumsq += win*win;
+  }
+  for(k = kh; k <= N; k++) 
+  {
+    win = 0.5*( 1.0 + cos(LAL_TWOPI/r - LAL_TWOPI/r*(k-1)/(N-1) - LAL_PI) );
+    data->data[k-1] *= win;
+    sumsq += win*win;
+  }
+
+  /* Add to sum of squares of the window function the parts of window which are equal to 1, and then find RMS value*/
+  sumsq += (REAL8) (kh - kl);
+  *rms = sqrt( ( sumsq/((REAL8) N) ) );
+
+  return 0;
+}
+/*******************************************************************************/
+
 /*******************************************************************************/
 /* Same as window function given in lalapps/src/pulsar/make_sfts.c */
 int WindowDataTukey2(struct CommandLineArgsTag CLA)
@@ -1601,22 +1736,11 @@ int WindowDataTukey2(struct CommandLineArgsTag CLA)
            printf("\nExample dataSingle values after windowing data in WindowDataTukey2:\n"); printExampleDataSingle();
         #endif
   } else {
-        N=dataDouble.data->length;
-        /* window data.  Off portion */
-        for (i=0; i<WINSTART; i++) {
-          dataDouble.data->data[i] = 0.0;
-          dataDouble.data->data[dataDouble.data->length - 1 - i] = 0.0;
-        }
-        /* window data, smooth turn-on portion */
-        for (i=WINSTART; i<WINEND; i++) {
-          win=((sin((i - WINSTART)*LAL_PI/(WINLEN)-LAL_PI_2)+1.0)/2.0);
-          dataDouble.data->data[i] *= win;
-          dataDouble.data->data[dataDouble.data->length - 1 - i]  *= win;
-          winFncRMS += 2.0*win*win;
-        }
+        if (WindowTukey2REAL8Vector(dataDouble.data, &winFncRMS)) return 5;
         #if PRINTEXAMPLEDATA
             printf("\nExample dataDouble values after windowing data in WindowDataTukey2:\n"); printExampleDataDouble();
         #endif  
+        return 0;
   }
 
   /* Add to sum of squares of the window function the parts of window which are equal to 1, and then find RMS value*/
@@ -1627,6 +1751,38 @@ int WindowDataTukey2(struct CommandLineArgsTag CLA)
 }
 /*******************************************************************************/
 
+/*******************************************************************************/
+/* make_sfts.c Tukey window of double precision data; the RMS of the window function is returned in rms */
+int WindowTukey2REAL8Vector(REAL8Vector *data, REAL8 *rms)
+{
+  INT4 WINSTART = 4096;
+  INT4 WINEND = 8192;
+  INT4 WINLEN = (WINEND-WINSTART);
+  INT4 i, N;
+  REAL8 win, sumsq = 0.0;
+
+  N=data->length;
+  /* window data.  Off portion */
+  for (i=0; i<WINSTART; i++) {
+    data->data[i] = 0.0;
+    data->data[data->length - 1 - i] = 0.0;
+  }
+  /* window data, smooth turn-on portion */
+  for (i=WINSTART; i<WINEND; i++) {
+    win=((sin((i - WINSTART)*LAL_PI/(WINLEN)-LAL_PI_2)+1.0)/2.0);
+    data->data[i] *= win;
+    data->data[data->length - 1 - i]  *= win;
+    sumsq += 2.0*win*win;
+  }
+
+  /* Add to sum of squares of the window function the parts of window which are equal to 1, and then find RMS value*/
+  sumsq += (REAL8) (N - 2*WINEND);
+  *rms = sqrt( ( sumsq/((REAL8) N) ) );
+
+  return 0;
+}
+/*******************************************************************************/
+
 /*******************************************************************************/
 /* Hann window based on Matlab, but with C indexing: w[k] = 0.5*( 1 - cos(2*pi*k/(N-1)) ) k = 0, 1, 2,...N-1 */
 int WindowDataHann(struct CommandLineArgsTag CLA)
@@ -1650,16 +1806,11 @@ int WindowDataHann(struct CommandLineArgsTag CLA)
            printf("\nExample dataSingle values after windowing data in WindowDataHann:\n"); printExampleDataSingle();
         #endif
   } else {
-        N = ((REAL8)dataDouble.data->length);
-        Nm1 = N - 1;
-        for (k=0; k<N; k++) {
-          win=0.5*( 1.0 - cos(real8TwoPi*((REAL8)(k))/Nm1) );
-          dataDouble.data->data[k] *= win;
-          winFncRMS += win*win;
-        }  
+        if (WindowHannREAL8Vector(dataDouble.data, &winFncRMS)) return 5;
         #if PRINTEXAMPLEDATA
             printf("\nExample dataDouble values after windowing data in WindowDataHann:\n"); printExampleDataDouble();
         #endif  
+        return 0;
   }
 
   /* Find RMS value; note that N is REAL8 in this function */
@@ -1669,6 +1820,29 @@ int WindowDataHann(struct CommandLineArgsTag CLA)
 }
 /*******************************************************************************/
 
+/*******************************************************************************/
+/* Hann window of double precision data; the RMS of the window function is returned in rms */
+int WindowHannREAL8Vector(REAL8Vector *data, REAL8 *rms)
+{
+  INT4 k;
+  REAL8 win,N,Nm1,sumsq = 0.0;
+  REAL8 real8TwoPi = 2.0*((REAL8)(LAL_PI));
+
+  N = ((REAL8)data->length);
+  Nm1 = N - 1;
+  for (k=0; k<N; k++) {
+    win=0.5*( 1.0 - cos(real8TwoPi*((REAL8)(k))/Nm1) );
+    data->data[k] *= win;
+    sumsq += win*win;
+  }
+
+  /* Find RMS value; note that N is REAL8 in this function */
+  *rms = sqrt( (sumsq/N) );
+
+  return 0;
+}
+/*******************************************************************************/
+
 /*******************************************************************************/
 int CreateSFT(struct CommandLineArgsTag CLA)
 {
@@ -2038,52 +2212,15 @@ int WriteSFT(struct CommandLineArgsTag CLA)
 int WriteVersion2SFT(struct CommandLineArgsTag CLA) 
 {
   char sftname[256];
-  char sftFilename[256];
   char sftnameFinal[256]; /* 01/09/06 gam */
-  char numSFTs[2]; /* 12/27/05 gam */
-  char site[2];    /* 12/27/05 gam */
   char ifo[3];     /* 12/27/05 gam; allow 3rd charactor for null termination */
   int firstbin=(INT4)(FMIN*CLA.T+0.5), k;
-  char gpstime[11]; /* 12/27/05 gam; allow for 10 digit GPS times and null termination */
   SFTtype *oneSFT = NULL;
   INT4 nBins = (INT4)(DF*CLA.T+0.5);
   REAL4 singleDeltaT = 0.0; /* 01/05/06 gam */
   REAL8 doubleDeltaT = 0.0; /* 01/05/06 gam */
 
-  /* 12/27/05 gam; set up the number of SFTs, site, and ifo as null terminated strings */
-  numSFTs[0] = '1';
-  numSFTs[1] = '\0'; /* null terminate */
-  strncpy( site, CLA.ChannelName, 1 );
-  site[1] = '\0'; /* null terminate */
-  if (CLA.IFO != NULL) {
-    strncpy( ifo, CLA.IFO, 2 );
-  } else {  
-    strncpy( ifo, CLA.ChannelName, 2 );
-  }
-  ifo[2] = '\0'; /* null terminate */
-  sprintf(gpstime,"%09d",gpsepoch.gpsSeconds);
-
-  strcpy( sftname, CLA.SFTpath );
-  /* 12/27/05 gam; add option to make directories based on gps time */
-  if (CLA.makeGPSDirs > 0) {
-     /* 12/27/05 gam; concat to the sftname the directory name based on GPS time; make this directory if it does not already exist */
-     mkSFTDir(sftname, site, numSFTs, ifo, CLA.stringT, CLA.miscDesc, gpstime, CLA.makeGPSDirs);
-  }
-
-  strcat(sftname,"/");
-  mkSFTFilename(sftFilename, site, numSFTs, ifo, CLA.stringT, CLA.miscDesc, gpstime);
-  /* 01/09/06 gam; sftname will be temporary; will move to sftnameFinal. */
-  if(CLA.makeTmpFile) {
-    /* set up sftnameFinal with usual SFT name */
-    strcpy(sftnameFinal,sftname);
-    strcat(sftnameFinal,sftFilename);
-    /* sftname begins with . and ends in .tmp */
-    strcat(sftname,".");
-    strcat(sftname,sftFilename);
-    strcat(sftname,".tmp");
-  } else {
-    strcat(sftname,sftFilename);
-  }  
+  mkVersion2SFTPath(sftname, sftnameFinal, ifo, CLA, gpsepoch);
 
   /* make container to store the SFT data */
   XLAL_CHECK( ( oneSFT = XLALCreateSFT ( ((UINT4)nBins)) ) != NULL, XLAL_EFUNC );
@@ -2162,6 +2299,359 @@ int WriteVersion2SFT(struct CommandLineArgsTag CLA)
 }
 /*******************************************************************************/
 
+/*******************************************************************************/
+/* Pipelined mode: the main thread reads SFT data from the frames into a ring of */
+/* queueDepth slots, numThreads workers high-pass filter, window and FFT the data */
+/* of different SFTs at the same time using the shared FFT plan, and a writer    */
+/* thread writes the SFTs out in order.  Each SFT is filtered separately, exactly */
+/* as when making one SFT at a time, so the output SFTs are the same.            */
+
+/* read the data of the SFT starting at epoch into a pipeline slot */
+static int ReadSFTPipelineSlot(SFTPipelineSlot *slot, struct CommandLineArgsTag CLA, LIGOTimeGPS epoch)
+{
+  REAL8Vector *tmp;
+
+  gpsepoch = epoch;
+  if (ReadData(CLA)) return 3;
+
+  /* swap the data just read with the (same length) vector of the slot instead of copying it */
+  tmp = slot->data;
+  slot->data = dataDouble.data;
+  dataDouble.data = tmp;
+  slot->epoch = epoch;
+  slot->deltaT = dataDouble.deltaT;
+
+  return 0;
+}
+
+/* high-pass filter, window and FFT the data of a pipeline slot; this is called by several threads at once */
+static int ProcessSFTPipelineSlot(SFTPipelineSlot *slot, struct CommandLineArgsTag CLA)
+{
+  REAL8TimeSeries series;
+  PassBandParamStruc filterpar;
+  char tmpname[] = "Butterworth High Pass";
+
+  memset(&series, 0, sizeof(series));
+  series.epoch = slot->epoch;
+  series.deltaT = slot->deltaT;
+  series.data = slot->data;
+
+  if (CLA.HPf > 0.0) {
+    filterpar.name  = tmpname;
+    filterpar.nMax  = 10;
+    filterpar.f2    = CLA.HPf;
+    filterpar.a2    = 0.5;
+    filterpar.f1    = -1.0;
+    filterpar.a1    = -1.0;
+    if (XLALButterworthREAL8TimeSeries(&series, &filterpar) != XLAL_SUCCESS) return 4;
+  }
+
+  slot->winFncRMS = 1.0;
+  if (CLA.windowOption==1) {
+    if (WindowTukeyREAL8Vector(slot->data, CLA.windowR, &slot->winFncRMS)) return 5;
+  } else if (CLA.windowOption==2) {
+    if (WindowTukey2REAL8Vector(slot->data, &slot->winFncRMS)) return 5;
+  } else if (CLA.windowOption==3) {
+    if (WindowHannREAL8Vector(slot->data, &slot->winFncRMS)) return 5;
+  }
+
+  /* the plan is shared by all threads; executing an FFTW plan on new arrays is thread safe */
+  if (XLALREAL8ForwardFFT(slot->fft, slot->data, fftPlanDouble) != XLAL_SUCCESS) return 6;
+
+  return 0;
+}
+
+/* write the SFT of a pipeline slot to its own file, or append it to the merged SFT file mergedfp */
+static int WriteSFTPipelineSlot(SFTPipelineSlot *slot, struct CommandLineArgsTag CLA, FILE *mergedfp)
+{
+  char sftname[256];
+  char sftnameFinal[256];
+  char ifo[3];
+  int firstbin=(INT4)(FMIN*CLA.T+0.5), k;
+  SFTtype *oneSFT = NULL;
+  INT4 nBins = (INT4)(DF*CLA.T+0.5);
+  REAL8 doubleDeltaT = (REAL8)(slot->deltaT/slot->winFncRMS); /* include 1 over window function RMS */
+
+  mkVersion2SFTPath(sftname, sftnameFinal, ifo, CLA, slot->epoch);
+
+  if ((oneSFT = XLALCreateSFT(((UINT4)nBins))) == NULL) return 7;
+  strcpy(oneSFT->name,ifo);
+  oneSFT->epoch = slot->epoch;
+  oneSFT->f0 = FMIN;
+  oneSFT->deltaF = 1.0/((REAL8)CLA.T);
+  for (k=0; k<nBins; k++)
+  {
+    oneSFT->data->data[k] = crectf( doubleDeltaT*creal(slot->fft->data[k+firstbin]), doubleDeltaT*cimag(slot->fft->data[k+firstbin]) );
+    #if CHECKFORINFINITEANDNANS
+      if (!isfinite(crealf(oneSFT->data->data[k])) || !isfinite(cimagf(oneSFT->data->data[k]))) {
+        fprintf(stderr, "Infinite or NaN data at freq bin %d of SFT at GPS time %d.\n", k, slot->epoch.gpsSeconds);
+        XLALDestroySFT(oneSFT);
+        return 7;
+      }
+    #endif
+  }
+
+  if (mergedfp != NULL) {
+    if (XLALWriteSFT2fp(oneSFT, mergedfp, CLA.commentField) != XLAL_SUCCESS) {
+      XLALDestroySFT(oneSFT);
+      return 7;
+    }
+  } else {
+    if (XLALWriteSFT2file(oneSFT, sftname, CLA.commentField) != XLAL_SUCCESS) {
+      XLALDestroySFT(oneSFT);
+      return 7;
+    }
+    if(CLA.makeTmpFile) {
+      mvFilenames(sftname,sftnameFinal);
+    }
+  }
+
+  XLALDestroySFT(oneSFT);
+  return 0;
+}
+
+#ifdef LAL_PTHREAD_LOCK
+/* state shared by the reader, worker and writer threads */
+typedef struct tagSFTPipeline {
+  struct CommandLineArgsTag CLA;
+  SFTPipelineSlot *slots;
+  UINT4 numSlots;
+  LIGOTimeGPS *epochs;     /* start times of all SFTs */
+  UINT4 numSFTs;
+  UINT4 nextToProcess;     /* index of the next SFT to be claimed by a worker */
+  FILE *mergedfp;
+  int errcode;             /* first error; non-zero stops all threads */
+  pthread_mutex_t lock;
+  pthread_cond_t changed;  /* signalled whenever the state of a slot or errcode changes */
+} SFTPipeline;
+
+/* set the state of a slot (or an error) and wake up all waiting threads */
+static void SFTPipelineUpdate(SFTPipeline *pl, SFTPipelineSlot *slot, INT4 state, int errcode)
+{
+  pthread_mutex_lock(&pl->lock);
+  if (errcode) {
+    if (!pl->errcode) pl->errcode = errcode;
+  } else if (slot != NULL) {
+    slot->state = state;
+  }
+  pthread_cond_broadcast(&pl->changed);
+  pthread_mutex_unlock(&pl->lock);
+}
+
+static void *SFTPipelineWorker(void *arg)
+{
+  SFTPipeline *pl = (SFTPipeline *)arg;
+  while (1) {
+    SFTPipelineSlot *slot;
+    pthread_mutex_lock(&pl->lock);
+    /* SFTs are claimed in order, so the next one is always in slot nextToProcess % numSlots */
+    while (!pl->errcode && pl->nextToProcess < pl->numSFTs
+           && pl->slots[pl->nextToProcess % pl->numSlots].state != SFT_SLOT_READ) {
+      pthread_cond_wait(&pl->changed, &pl->lock);
+    }
+    if (pl->errcode || pl->nextToProcess >= pl->numSFTs) {
+      pthread_mutex_unlock(&pl->lock);
+      return NULL;
+    }
+    slot = &pl->slots[pl->nextToProcess % pl->numSlots];
+    slot->state = SFT_SLOT_BUSY;
+    pl->nextToProcess++;
+    pthread_mutex_unlock(&pl->lock);
+
+    int errcode = ProcessSFTPipelineSlot(slot, pl->CLA);
+    SFTPipelineUpdate(pl, slot, SFT_SLOT_PROCESSED, errcode);
+  }
+}
+
+static void *SFTPipelineWriter(void *arg)
+{
+  SFTPipeline *pl = (SFTPipeline *)arg;
+  for (UINT4 i = 0; i < pl->numSFTs; i++) {
+    SFTPipelineSlot *slot = &pl->slots[i % pl->numSlots];
+    pthread_mutex_lock(&pl->lock);
+    while (!pl->errcode && slot->state != SFT_SLOT_PROCESSED) {
+      pthread_cond_wait(&pl->changed, &pl->lock);
+    }
+    int stop = pl->errcode;
+    pthread_mutex_unlock(&pl->lock);
+    if (stop) return NULL;
+
+    int errcode = WriteSFTPipelineSlot(slot, pl->CLA, pl->mergedfp);
+    SFTPipelineUpdate(pl, slot, SFT_SLOT_FREE, errcode);
+  }
+  return NULL;
+}
+
+/* run the reader in this thread and the workers and writer in their own threads */
+static int RunSFTPipelineThreads(SFTPipeline *pl, UINT4 numThreads)
+{
+  pthread_t writer;
+  pthread_t *workers;
+  UINT4 numWorkers = 0;
+
+  if ((workers = XLALCalloc(numThreads, sizeof(*workers))) == NULL) return 2;
+  if (pthread_create(&writer, NULL, SFTPipelineWriter, pl)) {
+    XLALFree(workers);
+    return 2;
+  }
+  for (numWorkers = 0; numWorkers < numThreads; numWorkers++) {
+    if (pthread_create(&workers[numWorkers], NULL, SFTPipelineWorker, pl)) {
+      SFTPipelineUpdate(pl, NULL, SFT_SLOT_FREE, 2);
+      break;
+    }
+  }
+
+  /* reader: fill slots in order as soon as the writer has freed them */
+  for (UINT4 i = 0; i < pl->numSFTs; i++) {
+    SFTPipelineSlot *slot = &pl->slots[i % pl->numSlots];
+    pthread_mutex_lock(&pl->lock);
+    while (!pl->errcode && slot->state != SFT_SLOT_FREE) {
+      pthread_cond_wait(&pl->changed, &pl->lock);
+    }
+    int stop = pl->errcode;
+    pthread_mutex_unlock(&pl->lock);
+    if (stop) break;
+
+    int errcode = ReadSFTPipelineSlot(slot, pl->CLA, pl->epochs[i]);
+    SFTPipelineUpdate(pl, slot, SFT_SLOT_READ, errcode);
+  }
+
+  pthread_join(writer, NULL);
+  /* wake up workers still waiting for data if the pipeline stopped early */
+  SFTPipelineUpdate(pl, NULL, SFT_SLOT_FREE, pl->errcode);
+  for (UINT4 t = 0; t < numWorkers; t++) {
+    pthread_join(workers[t], NULL);
+  }
+  XLALFree(workers);
+
+  return pl->errcode;
+}
+#endif /* LAL_PTHREAD_LOCK */
+
+int RunSFTPipeline(struct CommandLineArgsTag CLA)
+{
+  LIGOTimeGPS *epochs = NULL;
+  SFTPipelineSlot *slots = NULL;
+  UINT4 numSFTs = 0, numSlots, numThreads = CLA.numThreads, i;
+  FILE *mergedfp = NULL;
+  char mergedname[512];
+  char site[2] = "";
+  char ifo[3] = "";
+  int errcode = 0;
+
+  /* start times of all SFTs, as in the sequential loop in main() */
+  LIGOTimeGPS epoch = gpsepoch;
+  while (epoch.gpsSeconds + CLA.T <= CLA.GPSEnd) {
+    numSFTs++;
+    epoch.gpsSeconds = epoch.gpsSeconds + (INT4)((1.0 - CLA.overlapFraction)*((REAL8)CLA.T));
+  }
+  if (numSFTs == 0) return 0;
+  if ((epochs = XLALCalloc(numSFTs, sizeof(*epochs))) == NULL) return 2;
+  epochs[0] = gpsepoch;
+  for (i = 1; i < numSFTs; i++) {
+    epochs[i].gpsSeconds = epochs[i-1].gpsSeconds + (INT4)((1.0 - CLA.overlapFraction)*((REAL8)CLA.T));
+    epochs[i].gpsNanoSeconds = 0;
+  }
+
+#ifndef LAL_PTHREAD_LOCK
+  if (numThreads > 0) {
+    fprintf(stderr,"LAL was built without pthread support; making one SFT at a time.\n");
+    numThreads = 0;
+  }
+#endif
+
+  /* memory use is bounded by the number of slots */
+  if (numThreads == 0) {
+    numSlots = 1;
+  } else if (CLA.queueDepth > 0) {
+    numSlots = CLA.queueDepth;
+  } else {
+    numSlots = 2*numThreads + 2;
+  }
+  if (numSlots > numSFTs) numSlots = numSFTs;
+  if ((slots = XLALCalloc(numSlots, sizeof(*slots))) == NULL) {
+    XLALFree(epochs);
+    return 2;
+  }
+  for (i = 0; i < numSlots; i++) {
+    slots[i].state = SFT_SLOT_FREE;
+    if ((slots[i].data = XLALCreateREAL8Vector(dataDouble.data->length)) == NULL
+        || (slots[i].fft = XLALCreateCOMPLEX16Vector(dataDouble.data->length / 2 + 1)) == NULL) {
+      errcode = 2;
+      break;
+    }
+  }
+
+  /* a merged SFT file is written under a temporary name, since its final name contains the number of SFTs */
+  if (!errcode && CLA.mergedSFTs) {
+    strncpy( site, CLA.ChannelName, 1 );
+    site[1] = '\0';
+    if (CLA.IFO != NULL) {
+      strncpy( ifo, CLA.IFO, 2 );
+    } else {
+      strncpy( ifo, CLA.ChannelName, 2 );
+    }
+    ifo[2] = '\0';
+    snprintf(mergedname, sizeof(mergedname), "%s/.%s-%s-%09d.merged.sft.tmp", CLA.SFTpath, site, ifo, epochs[0].gpsSeconds);
+    mergedfp = tryopen(mergedname, "wb");
+  }
+
+  if (!errcode) {
+#ifdef LAL_PTHREAD_LOCK
+    if (numThreads > 0) {
+      SFTPipeline pl;
+      memset(&pl, 0, sizeof(pl));
+      pl.CLA = CLA;
+      pl.slots = slots;
+      pl.numSlots = numSlots;
+      pl.epochs = epochs;
+      pl.numSFTs = numSFTs;
+      pl.mergedfp = mergedfp;
+      pthread_mutex_init(&pl.lock, NULL);
+      pthread_cond_init(&pl.changed, NULL);
+      errcode = RunSFTPipelineThreads(&pl, numThreads);
+      pthread_cond_destroy(&pl.changed);
+      pthread_mutex_destroy(&pl.lock);
+    } else
+#endif
+    {
+      for (i = 0; i < numSFTs && !errcode; i++) {
+        if ((errcode = ReadSFTPipelineSlot(&slots[0], CLA, epochs[i]))) break;
+        if ((errcode = ProcessSFTPipelineSlot(&slots[0], CLA))) break;
+        errcode = WriteSFTPipelineSlot(&slots[0], CLA, mergedfp);
+      }
+    }
+  }
+
+  /* move the merged SFT file to its final name, with the number of SFTs and the time span they cover */
+  if (mergedfp != NULL) {
+    fclose(mergedfp);
+    if (!errcode) {
+      char mergedFinal[512];
+      char numSFTs_str[16];
+      char sftDescField[256];
+      snprintf(numSFTs_str, sizeof(numSFTs_str), "%d", numSFTs);
+      getSFTDescField(sftDescField, numSFTs_str, ifo, CLA.stringT, CLA.miscDesc);
+      snprintf(mergedFinal, sizeof(mergedFinal), "%s/%s-%s-%09d-%d.sft", CLA.SFTpath, site, sftDescField,
+               epochs[0].gpsSeconds, epochs[numSFTs-1].gpsSeconds + CLA.T - epochs[0].gpsSeconds);
+      mvFilenames(mergedname, mergedFinal);
+    } else {
+      remove(mergedname);
+    }
+  }
+
+  for (i = 0; i < numSlots; i++) {
+    XLALDestroyREAL8Vector(slots[i].data);
+    XLALDestroyCOMPLEX16Vector(slots[i].fft);
+  }
+  XLALFree(slots);
+  XLALFree(epochs);
+
+  if (errcode) fprintf(stderr,"Making SFTs in pipelined mode failed with code %d.\n", errcode);
+  return errcode;
+}
+/*******************************************************************************/
+
 /*******************************************************************************/
 int FreeMem(struct CommandLineArgsTag CLA)
 {
@@ -0,0 +1,605 @@
+/*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with with program; see the file COPYING. If not, write to the
+*  Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+*  MA  02111-1307  USA
+*/
+
+//Time making a bank of templates with the original code, one at a time and as a batch, and check that the results agree
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+#include <lal/LALStdlib.h>
+#include <lal/AVFactories.h>
+#include <lal/LogPrintf.h>
+#include <lal/Window.h>
+#include <lal/VectorOps.h>
+#include <lal/VectorMath.h>
+#include <lal/SinCosLUT.h>
+
+#include "../templates.h"
+#include "../vectormath.h"
+#include "../statistics.h"
+#include "../TwoSpectSpecFunc.h"
+
+static INT4 makeTemplateGaussians2_reference(TwoSpectTemplate *output, const REAL8 offset, const REAL8 P, const REAL8 deltaf, const REAL8 Tsft, const REAL8 SFToverlap, const REAL8 Tobs, const UINT4 minTemplateLength, const UINT4 vectormathflag);
+static INT4 makeTemplate2_reference(TwoSpectTemplate *output, const REAL8 offset, const REAL8 P, const REAL8 deltaf, const REAL8 Tsft, const REAL8 SFToverlap, const REAL8 Tobs, const UINT4 minTemplateLength, const UINT4 vectormathflag, const REAL4FFTPlan *plan);
+static REAL8 templateDifference(const TwoSpectTemplate *reference, const TwoSpectTemplate *test);
+
+int main(void)
+{
+
+   const REAL8 Tsft = 1800.0, SFToverlap = 900.0, Tobs = 40.0*86400.0;
+   const REAL8 Pmin = 7200.0, Pmax = 8.0*86400.0, dfmin = 0.5/Tsft, dfmax = 4.0/Tsft;
+   const UINT4 numtemplates = 200, minTemplateLength = 50, maxTemplateLength = 500, vectormathflag = 0;
+
+   //Template parameters, spread over the ranges of period and modulation depth
+   REAL8Vector *offsets = NULL, *periods = NULL, *moddepths = NULL;
+   XLAL_CHECK( (offsets = XLALCreateREAL8Vector(numtemplates)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (periods = XLALCreateREAL8Vector(numtemplates)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (moddepths = XLALCreateREAL8Vector(numtemplates)) != NULL, XLAL_EFUNC );
+   for (UINT4 ii=0; ii<numtemplates; ii++) {
+      offsets->data[ii] = 0.5*(ii%2);
+      periods->data[ii] = Pmin + (Pmax-Pmin)*(ii/2)/(numtemplates/2);
+      moddepths->data[ii] = dfmin + (dfmax-dfmin)*((ii*7)%numtemplates)/numtemplates;
+      if (periods->data[ii] < 2.0*moddepths->data[ii]*Tsft*Tsft) periods->data[ii] = 2.0*moddepths->data[ii]*Tsft*Tsft;
+   }
+
+   UINT4 numffts = (UINT4)floor(Tobs/(Tsft-SFToverlap)-1);
+   REAL4FFTPlan *plan = NULL;
+   XLAL_CHECK( (plan = XLALCreateForwardREAL4FFTPlan(numffts, 1)) != NULL, XLAL_EFUNC );
+
+   //The original code computes the weights with lookup-table sines and without reducing the argument, so it may
+   //differ slightly from the current code; this is the largest difference allowed, relative to the largest weight
+   const REAL8 tolerance = 1.0e-3;
+
+   INT4 errors = 0;
+   for (BOOLEAN exactflag=0; exactflag<=1; exactflag++) {
+      TwoSpectTemplateVector *reference = NULL, *serial = NULL, *batch = NULL;
+      XLAL_CHECK( (reference = createTwoSpectTemplateVector(numtemplates, maxTemplateLength)) != NULL, XLAL_EFUNC );
+      XLAL_CHECK( (serial = createTwoSpectTemplateVector(numtemplates, maxTemplateLength)) != NULL, XLAL_EFUNC );
+      XLAL_CHECK( (batch = createTwoSpectTemplateVector(numtemplates, maxTemplateLength)) != NULL, XLAL_EFUNC );
+      batch->Tsft = Tsft;
+      batch->SFToverlap = SFToverlap;
+      batch->Tobs = Tobs;
+
+      REAL8 tic = XLALGetTimeOfDay();
+      for (UINT4 ii=0; ii<numtemplates; ii++) {
+         if (!exactflag) XLAL_CHECK( makeTemplateGaussians2_reference(reference->data[ii], offsets->data[ii], periods->data[ii], moddepths->data[ii], Tsft, SFToverlap, Tobs, minTemplateLength, vectormathflag) == XLAL_SUCCESS, XLAL_EFUNC );
+         else XLAL_CHECK( makeTemplate2_reference(reference->data[ii], offsets->data[ii], periods->data[ii], moddepths->data[ii], Tsft, SFToverlap, Tobs, minTemplateLength, vectormathflag, plan) == XLAL_SUCCESS, XLAL_EFUNC );
+      }
+      REAL8 referencetime = XLALGetTimeOfDay() - tic;
+
+      tic = XLALGetTimeOfDay();
+      for (UINT4 ii=0; ii<numtemplates; ii++) {
+         if (!exactflag) XLAL_CHECK( makeTemplateGaussians2(serial->data[ii], offsets->data[ii], periods->data[ii], moddepths->data[ii], Tsft, SFToverlap, Tobs, minTemplateLength, vectormathflag) == XLAL_SUCCESS, XLAL_EFUNC );
+         else XLAL_CHECK( makeTemplate2(serial->data[ii], offsets->data[ii], periods->data[ii], moddepths->data[ii], Tsft, SFToverlap, Tobs, minTemplateLength, vectormathflag, plan) == XLAL_SUCCESS, XLAL_EFUNC );
+      }
+      REAL8 serialtime = XLALGetTimeOfDay() - tic;
+
+      tic = XLALGetTimeOfDay();
+      XLAL_CHECK( makeTemplateBatch2(batch, offsets, periods, moddepths, minTemplateLength, vectormathflag, exactflag, plan) == XLAL_SUCCESS, XLAL_EFUNC );
+      REAL8 batchtime = XLALGetTimeOfDay() - tic;
+
+      REAL8 maxdiff = 0.0;
+      for (UINT4 ii=0; ii<numtemplates; ii++) {
+         //Compare the current code with the original code
+         REAL8 diff = templateDifference(reference->data[ii], serial->data[ii]);
+         if (diff > maxdiff) maxdiff = diff;
+         if (diff > tolerance) {
+            fprintf(stderr, "Template %d differs from the original code by %g (P = %g s, df = %g Hz)\n", ii, diff, periods->data[ii], moddepths->data[ii]);
+            errors++;
+         }
+
+         //Batched templates are computed by the same per-template code, so they should be bitwise identical
+         if (memcmp(serial->data[ii]->templatedata->data, batch->data[ii]->templatedata->data, sizeof(REAL4)*maxTemplateLength)!=0 || memcmp(serial->data[ii]->pixellocations->data, batch->data[ii]->pixellocations->data, sizeof(INT4)*maxTemplateLength)!=0) {
+            fprintf(stderr, "Batched template %d differs (P = %g s, df = %g Hz)\n", ii, periods->data[ii], moddepths->data[ii]);
+            errors++;
+         }
+      }
+
+      fprintf(stdout, "%s templates: %d in %.3f s with the original code, %.3f s one at a time, %.3f s as a batch; largest difference from the original code %g\n", exactflag ? "Exact" : "Gaussian", numtemplates, referencetime, serialtime, batchtime, maxdiff);
+
+      destroyTwoSpectTemplateVector(reference);
+      destroyTwoSpectTemplateVector(serial);
+      destroyTwoSpectTemplateVector(batch);
+   }
+
+   XLALDestroyREAL4FFTPlan(plan);
+   XLALDestroyREAL8Vector(offsets);
+   XLALDestroyREAL8Vector(periods);
+   XLALDestroyREAL8Vector(moddepths);
+
+   if (errors>0) {
+      fprintf(stderr, "%d comparisons failed\n", errors);
+      return 1;
+   }
+
+   return 0;
+
+}
+
+
+/**
+ * Largest difference between the pixel weights of two templates, relative to the largest weight of the reference.
+ * Pixels present in only one of the templates count as having zero weight in the other one.
+ * \param [in] reference Pointer to the reference TwoSpectTemplate
+ * \param [in] test      Pointer to the TwoSpectTemplate to check
+ * \return Relative difference
+ */
+static REAL8 templateDifference(const TwoSpectTemplate *reference, const TwoSpectTemplate *test)
+{
+   REAL8 maxdiff = 0.0;
+
+   for (UINT4 ii=0; ii<reference->templatedata->length && reference->templatedata->data[ii]!=0.0; ii++) {
+      REAL8 testweight = 0.0;
+      for (UINT4 jj=0; jj<test->templatedata->length && test->templatedata->data[jj]!=0.0; jj++) {
+         if (test->pixellocations->data[jj]==reference->pixellocations->data[ii]) {
+            testweight = test->templatedata->data[jj];
+            break;
+         }
+      }
+      maxdiff = fmax(maxdiff, fabs(reference->templatedata->data[ii] - testweight));
+   }
+
+   for (UINT4 jj=0; jj<test->templatedata->length && test->templatedata->data[jj]!=0.0; jj++) {
+      BOOLEAN found = 0;
+      for (UINT4 ii=0; ii<reference->templatedata->length && reference->templatedata->data[ii]!=0.0; ii++) {
+         if (reference->pixellocations->data[ii]==test->pixellocations->data[jj]) {
+            found = 1;
+            break;
+         }
+      }
+      if (!found) maxdiff = fmax(maxdiff, test->templatedata->data[jj]);
+   }
+
+   if (reference->templatedata->data[0]==0.0) return maxdiff==0.0 ? 0.0 : INFINITY;
+   return maxdiff/reference->templatedata->data[0];
+
+} /* templateDifference() */
+
+
+//The functions below are copies of makeTemplateGaussians2() and makeTemplate2() as they were before template
+//generation was batched and vectorised, and are kept unchanged to check the current code against
+
+static INT4 makeTemplateGaussians2_reference(TwoSpectTemplate *output, const REAL8 offset, const REAL8 P, const REAL8 deltaf, const REAL8 Tsft, const REAL8 SFToverlap, const REAL8 Tobs, const UINT4 minTemplateLength, const UINT4 vectormathflag)
+{
+
+   XLAL_CHECK( output != NULL, XLAL_EINVAL );
+   XLAL_CHECK( offset <= 0.5 && offset >= -0.5 && P != 0.0 && deltaf != 0.0, XLAL_EINVAL, "Invalid input (%f, %f, %f)\n", offset, P, deltaf );
+
+   UINT4 numffts = (UINT4)floor(Tobs/(Tsft-SFToverlap)-1);
+   UINT4 numfprbins = (UINT4)floorf(0.5*numffts) + 1;
+   
+   //Set data for output template
+   output->f0 = offset;
+   output->period = P;
+   output->moddepth = deltaf;
+
+   //Reset the data values to zero, just in case
+   memset(output->templatedata->data, 0, sizeof(REAL4)*output->templatedata->length);
+
+   INT4 N = (INT4)floor(Tobs/P);     //Number of Gaussians = observation time / period
+   REAL8 periodf = 1.0/P;
+
+   //Create second FFT frequencies and other useful values
+   REAL4VectorAligned *fpr = NULL;
+   XLAL_CHECK( (fpr = XLALCreateREAL4VectorAligned(numfprbins, 32)) != NULL, XLAL_EFUNC );
+   for (UINT4 ii=0; ii<fpr->length; ii++) fpr->data[ii] = (REAL4)ii*(1.0/Tobs);
+
+   //For speed, we will precompute a number of useful vectors described by their names
+   //This part is the allocation
+   REAL4VectorAligned *omegapr = NULL, *omegapr_squared = NULL, *cos_ratio = NULL;
+   XLAL_CHECK( (omegapr = XLALCreateREAL4VectorAligned(fpr->length, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (omegapr_squared = XLALCreateREAL4VectorAligned(fpr->length, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (cos_ratio = XLALCreateREAL4VectorAligned(fpr->length, 32)) != NULL, XLAL_EFUNC );
+
+   //Doing the precomputation of the useful values
+   XLAL_CHECK( XLALVectorScaleREAL4(omegapr->data, (REAL4)LAL_TWOPI, fpr->data, fpr->length) == XLAL_SUCCESS, XLAL_EFUNC );
+   XLAL_CHECK( XLALVectorMultiplyREAL4(omegapr_squared->data, omegapr->data, omegapr->data, omegapr->length) == XLAL_SUCCESS, XLAL_EFUNC );
+   if (N*P*omegapr->data[omegapr->length-1]<2.147483647e9) {
+      for (UINT4 ii=0; ii<fpr->length; ii++) {
+         REAL4 tempSinValue = 0.0, cos_omegapr_times_period = 0.0, cos_N_times_omegapr_times_period = 0.0;
+         XLAL_CHECK( XLALSinCosLUT(&tempSinValue, &cos_omegapr_times_period, P*omegapr->data[ii]) == XLAL_SUCCESS, XLAL_EFUNC );
+         XLAL_CHECK( XLALSinCosLUT(&tempSinValue, &cos_N_times_omegapr_times_period, N*P*omegapr->data[ii]) == XLAL_SUCCESS, XLAL_EFUNC );
+         if (cos_N_times_omegapr_times_period>1.0) cos_N_times_omegapr_times_period = 1.0;
+         if (cos_omegapr_times_period>1.0) cos_omegapr_times_period = 1.0;
+         if (cos_N_times_omegapr_times_period<-1.0) cos_N_times_omegapr_times_period = -1.0;
+         if (cos_omegapr_times_period<-1.0) cos_omegapr_times_period = -1.0;
+         if (cos_N_times_omegapr_times_period<=(1.0-100.0*LAL_REAL4_EPS) && cos_omegapr_times_period<=(1.0-100.0*LAL_REAL4_EPS)) cos_ratio->data[ii] = (1.0 - cos_N_times_omegapr_times_period)/(1.0 - cos_omegapr_times_period);
+         else if (cos_N_times_omegapr_times_period<=(1.0-100.0*LAL_REAL4_EPS)) {
+            REAL8 fmodval = fmod(P*omegapr->data[ii], LAL_TWOPI);
+            cos_ratio->data[ii] = 2.0*(1.0 - cos_N_times_omegapr_times_period)/(fmodval*fmodval);
+         } else if (cos_omegapr_times_period<=(1.0-100.0*LAL_REAL4_EPS)) {
+            REAL8 fmodval = fmod(N*P*omegapr->data[ii], LAL_TWOPI);
+            cos_ratio->data[ii] = 0.5*fmodval*fmodval/(1.0 - cos_omegapr_times_period);
+         } else cos_ratio->data[ii] = (REAL4)(N*N);
+      }
+   } else if (P*omegapr->data[omegapr->length-1]<2.147483647e9) {
+      for (UINT4 ii=0; ii<fpr->length; ii++) {
+         REAL4 tempSinValue = 0.0, cos_omegapr_times_period = 0.0;
+         XLAL_CHECK( XLALSinCosLUT(&tempSinValue, &cos_omegapr_times_period, P*omegapr->data[ii]) == XLAL_SUCCESS, XLAL_EFUNC );
+         if (cos_omegapr_times_period>1.0) cos_omegapr_times_period = 1.0;
+         if (cos_omegapr_times_period<-1.0) cos_omegapr_times_period = -1.0;
+         REAL4 cos_N_times_omegapr_times_period = cosf((REAL4)(N*P*omegapr->data[ii]));
+         if (cos_N_times_omegapr_times_period<=(1.0-100.0*LAL_REAL4_EPS) && cos_omegapr_times_period<=(1.0-100.0*LAL_REAL4_EPS)) cos_ratio->data[ii] = (1.0 - cos_N_times_omegapr_times_period)/(1.0 - cos_omegapr_times_period);
+         else if (cos_N_times_omegapr_times_period<=(1.0-100.0*LAL_REAL4_EPS)) {
+            REAL8 fmodval = fmod(P*omegapr->data[ii], LAL_TWOPI);
+            cos_ratio->data[ii] = 2.0*(1.0 - cos_N_times_omegapr_times_period)/(fmodval*fmodval);
+         } else if (cos_omegapr_times_period<=(1.0-100.0*LAL_REAL4_EPS)) {
+            REAL8 fmodval = fmod(N*P*omegapr->data[ii], LAL_TWOPI);
+            cos_ratio->data[ii] = 0.5*fmodval*fmodval/(1.0 - cos_omegapr_times_period);
+         } else cos_ratio->data[ii] = (REAL4)(N*N);
+      }
+   } else {
+      for (UINT4 ii=0; ii<fpr->length; ii++) {
+         REAL4 cos_omegapr_times_period = cosf((REAL4)(P*omegapr->data[ii]));
+         REAL4 cos_N_times_omegapr_times_period = cosf((REAL4)(N*P*omegapr->data[ii]));
+         if (cos_N_times_omegapr_times_period<=(1.0-100.0*LAL_REAL4_EPS) && cos_omegapr_times_period<=(1.0-100.0*LAL_REAL4_EPS)) cos_ratio->data[ii] = (1.0 - cos_N_times_omegapr_times_period)/(1.0 - cos_omegapr_times_period);
+         else if (cos_N_times_omegapr_times_period<=(1.0-100.0*LAL_REAL4_EPS)) {
+            REAL8 fmodval = fmod(P*omegapr->data[ii], LAL_TWOPI);
+            cos_ratio->data[ii] = 2.0*(1.0 - cos_N_times_omegapr_times_period)/(fmodval*fmodval);
+         } else if (cos_omegapr_times_period<=(1.0-100.0*LAL_REAL4_EPS)) {
+            REAL8 fmodval = fmod(N*P*omegapr->data[ii], LAL_TWOPI);
+            cos_ratio->data[ii] = 0.5*fmodval*fmodval/(1.0 - cos_omegapr_times_period);
+         } else cos_ratio->data[ii] = (REAL4)(N*N);
+      }
+   }
+
+   //Determine span of the template
+   REAL8 binamplitude = deltaf*Tsft;
+   REAL8 binmin = -binamplitude + offset;
+   REAL8 binmax = binamplitude + offset;
+   INT4 templatemin = (INT4)round(binmin), templatemax = (INT4)round(binmax);
+   if (templatemin > binmin) templatemin--;
+   if (templatemin - binmin >= -0.5) templatemin--;
+   if (templatemax < binmax) templatemax++;
+   if (templatemax - binmax <= 0.5) templatemax++;
+   UINT4 templatespan = (UINT4)(templatemax - templatemin) + 1;
+   REAL8 disttominbin = binmin - templatemin, disttomaxbin = templatemax - binmax, disttomidbin = offset - templatemin;
+
+   //Determine the weighting scale for the leakage bins and the distance between Gaussians := phi_actual
+   REAL4VectorAligned *scale = NULL, *phi_actual = NULL;
+   XLAL_CHECK( (scale = XLALCreateREAL4VectorAligned(templatespan, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (phi_actual = XLALCreateREAL4VectorAligned(templatespan, 32)) != NULL, XLAL_EFUNC );
+   memset(scale->data, 0, templatespan*sizeof(REAL4));
+   memset(phi_actual->data, 0, templatespan*sizeof(REAL4));
+   for (UINT4 ii=0; ii<scale->length; ii++) {
+      if (ii!=0 && ii!=scale->length-1) {
+         scale->data[ii] = 1.0;
+      } else if (ii==0) {
+         scale->data[ii] = sqsincxoverxsqminusone(disttominbin);
+         XLAL_CHECK( xlalErrno==0, XLAL_EFUNC );
+      } else {
+         scale->data[ii] = sqsincxoverxsqminusone(disttomaxbin);
+         XLAL_CHECK( xlalErrno==0, XLAL_EFUNC );
+      }
+
+      if ( fabs(ii-disttomidbin)/(deltaf*Tsft) <= 1.0 ) phi_actual->data[ii] = 0.5*P - asin(fabs(ii-disttomidbin)/(deltaf*Tsft))*LAL_1_PI*P;
+   }
+
+   //Make sigmas for each frequency
+   //First, allocate vectors
+   REAL4VectorAligned *sigmas = NULL, *wvals = NULL, *binvals = NULL, *bindiffvals = NULL, *absbindiffvals = NULL;
+   REAL4VectorAlignedArray *allsigmas = NULL, *weightvals = NULL;
+   XLAL_CHECK( (sigmas = XLALCreateREAL4VectorAligned(templatespan, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (wvals = XLALCreateREAL4VectorAligned((UINT4)floor(30.0*P/Tsft), 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (allsigmas = createREAL4VectorAlignedArray(wvals->length, sigmas->length, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (weightvals = createREAL4VectorAlignedArray(wvals->length, sigmas->length, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (binvals = XLALCreateREAL4VectorAligned(sigmas->length, 32)) != NULL, XLAL_EFUNC );
+   for (UINT4 jj=0; jj<binvals->length; jj++) binvals->data[jj] = -((REAL4)jj + templatemin);
+   XLAL_CHECK( (bindiffvals = XLALCreateREAL4VectorAligned(binvals->length, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (absbindiffvals = XLALCreateREAL4VectorAligned(binvals->length, 32)) != NULL, XLAL_EFUNC );
+
+   //Here is where the sigmas are computed. It is a weighted average. t = (ii+1)*in->Tsft*0.5
+   REAL4 sin2pix = 0.0, cos2pix = 0.0;
+   for (UINT4 ii=0; ii<wvals->length; ii++) {
+      //calculate sin and cos of 2*pi*t/P and then the bin the signal is in and the signal velocity
+      XLAL_CHECK( XLALSinCos2PiLUT(&sin2pix, &cos2pix, periodf*((ii+1)*Tsft*0.5)) == XLAL_SUCCESS, XLAL_EFUNC );
+      if (cos2pix>1.0) cos2pix = 1.0;
+      else if (cos2pix<-1.0) cos2pix = -1.0;
+      REAL4 sigbin = (deltaf*cos2pix)*Tsft + offset;
+      REAL4 sigbinvelocity = fabs(-deltaf*sin2pix*Tsft*Tsft*LAL_PI*periodf);
+
+      //Compute bin diff values
+      XLAL_CHECK( XLALVectorShiftREAL4(bindiffvals->data, sigbin, binvals->data, bindiffvals->length) == XLAL_SUCCESS, XLAL_EFUNC );
+      XLAL_CHECK( VectorAbsREAL4(absbindiffvals, bindiffvals, vectormathflag) == XLAL_SUCCESS, XLAL_EFUNC );
+
+      //if the velocity approaches zero, the sigma calculation will diverge (which it should do) but this is bad numerically, so we cap it
+      if (sigbinvelocity<1.0e-4) sigbinvelocity = 1.0e-4;
+
+      //REAL4 sigma = 0.5*Tsft * (0.5346 * powf(sigbinvelocity, -1.0213f));   //Derived fit from simulation
+      REAL4 sigma = 0.5*Tsft * (0.5979 / (sigbinvelocity - 3.2895e-5));  //Could think about using this fit in the future
+
+      //set all weightvals in each vector to zero
+      memset(weightvals->data[ii]->data, 0, sizeof(REAL4)*weightvals->data[ii]->length);
+
+      REAL4 threshold = 1.75;
+      for (UINT4 jj=0; jj<sigmas->length; jj++) {
+         if (absbindiffvals->data[jj]<threshold) {
+            weightvals->data[ii]->data[jj] = sqsincxoverxsqminusone(bindiffvals->data[jj]);
+            XLAL_CHECK( xlalErrno==0, XLAL_EFUNC );
+         }
+      }
+      XLAL_CHECK( XLALVectorScaleREAL4(allsigmas->data[ii]->data, sigma, weightvals->data[ii]->data, sigmas->length) == XLAL_SUCCESS, XLAL_EFUNC );
+
+   } /* for ii < wvals->length */
+   for (UINT4 ii=0; ii<sigmas->length; ii++) {
+      REAL8 wavesigma = 0.0;
+      REAL8 totalw = 0.0;
+      for (UINT4 jj=0; jj<wvals->length; jj++) {
+         if (weightvals->data[jj]->data[ii] != 0.0) {
+            wavesigma += allsigmas->data[jj]->data[ii];
+            totalw += weightvals->data[jj]->data[ii];
+         }
+      }
+      sigmas->data[ii] = (REAL4)(wavesigma/totalw);
+   } /* for ii < sigmas->length */
+
+   //Allocate more useful data vectors. These get computed for each different first FFT frequency bin in the F-F plane
+   REAL4VectorAligned *exp_neg_sigma_sq_times_omega_pr_sq = NULL, *sin_phi_times_omega_pr = NULL, *cos_phi_times_omega_pr = NULL, *phi_times_fpr = NULL, *datavector = NULL;
+   XLAL_CHECK( (exp_neg_sigma_sq_times_omega_pr_sq = XLALCreateREAL4VectorAligned(omegapr_squared->length, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (sin_phi_times_omega_pr = XLALCreateREAL4VectorAligned(omegapr->length, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (cos_phi_times_omega_pr = XLALCreateREAL4VectorAligned(omegapr->length, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (phi_times_fpr = XLALCreateREAL4VectorAligned(fpr->length, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (datavector = XLALCreateREAL4VectorAligned(fpr->length, 32)) != NULL, XLAL_EFUNC );
+
+   //Create template. We are going to do exp(log(Eq. 18))
+   REAL8 sum = 0.0;
+   REAL4 log4pi = 2.53102424697f;
+   for (UINT4 ii=0; ii<sigmas->length; ii++) {
+      INT4 bins2middlebin = ii + templatemin;  //Number of frequency bins away from the "central frequency bin" of the template
+
+      memset(datavector->data, 0, sizeof(REAL4)*datavector->length);
+
+      //Scaling factor for leakage
+      REAL4 scale1 = sqrtf((REAL4)(1.0/(1.0+expf((REAL4)(-phi_actual->data[ii]*phi_actual->data[ii]*0.5/(sigmas->data[ii]*sigmas->data[ii]))))));
+
+      //pre-factor
+      //REAL8 prefact0 = scale1 * 2.0 * LAL_TWOPI * sigmas->data[ii] * sigmas->data[ii];
+      //REAL4 prefact0 = log(scale1 * 2.0 * LAL_TWOPI * sigmas->data[ii] * sigmas->data[ii]);     //We are going to do exp(log(Eq. 18))
+      REAL4 prefact0 = log4pi + 2.0*logf((REAL4)(scale1*sigmas->data[ii]));
+
+      if (vectormathflag==1 || vectormathflag==2) {
+         //Compute exp(log(4*pi*s*s*exp(-s*s*omegapr_squared))) = exp(log(4*pi*s*s)-s*s*omegapr_squared)
+         XLAL_CHECK( XLALVectorScaleREAL4(exp_neg_sigma_sq_times_omega_pr_sq->data, -sigmas->data[ii]*sigmas->data[ii], omegapr_squared->data, omegapr_squared->length) == XLAL_SUCCESS, XLAL_EFUNC );
+         XLAL_CHECK( XLALVectorShiftREAL4(exp_neg_sigma_sq_times_omega_pr_sq->data, prefact0, exp_neg_sigma_sq_times_omega_pr_sq->data, exp_neg_sigma_sq_times_omega_pr_sq->length) == XLAL_SUCCESS, XLAL_EFUNC );
+         UINT4 truncationLength = 1;
+         while (truncationLength<omegapr_squared->length && exp_neg_sigma_sq_times_omega_pr_sq->data[truncationLength]>-88.0) truncationLength++;
+         XLAL_CHECK( XLALVectorExpREAL4(exp_neg_sigma_sq_times_omega_pr_sq->data, exp_neg_sigma_sq_times_omega_pr_sq->data, truncationLength) == XLAL_SUCCESS, XLAL_EFUNC );
+
+         //Compute phi_actual*fpr
+         XLAL_CHECK( XLALVectorScaleREAL4(phi_times_fpr->data, phi_actual->data[ii], fpr->data, truncationLength) == XLAL_SUCCESS, XLAL_EFUNC );
+
+         //Start computing the datavector values
+         INT4 maxindex = max_index_in_range(phi_times_fpr, 0, truncationLength-1);
+         if (phi_times_fpr->data[maxindex]<=2.147483647e9) {
+            //Compute cos(2*pi*phi_actual*fpr) using LUT and SSE
+            XLAL_CHECK( XLALVectorSinCos2PiREAL4(sin_phi_times_omega_pr->data, cos_phi_times_omega_pr->data, phi_times_fpr->data, truncationLength) == XLAL_SUCCESS, XLAL_EFUNC );
+         } else {
+            //Compute cos(2*pi*phi_actual*fpr) without using LUT
+            for (UINT4 jj=0; jj<truncationLength; jj++) cos_phi_times_omega_pr->data[jj] = cosf((REAL4)LAL_TWOPI*phi_times_fpr->data[jj]);
+         }
+         //datavector = cos(phi_actual*omega_pr) + 1.0
+         XLAL_CHECK( XLALVectorShiftREAL4(datavector->data, 1.0, cos_phi_times_omega_pr->data, truncationLength) == XLAL_SUCCESS, XLAL_EFUNC );
+         //datavector = prefact0 * exp(-s*s*omega_pr*omega_pr) * [cos(phi_actual*omega_pr) + 1.0]
+         XLAL_CHECK( XLALVectorMultiplyREAL4(datavector->data, datavector->data, exp_neg_sigma_sq_times_omega_pr_sq->data, truncationLength) == XLAL_SUCCESS, XLAL_EFUNC );
+         //datavector = scale * exp(-s*s*omega_pr*omega_pr) * [cos(phi_actual*omega_pr) + 1.0]
+         XLAL_CHECK( XLALVectorScaleREAL4(datavector->data, scale->data[ii], datavector->data, truncationLength) == XLAL_SUCCESS, XLAL_EFUNC );
+         //datavector *= cos_ratio
+         XLAL_CHECK( XLALVectorMultiplyREAL4(datavector->data, datavector->data, cos_ratio->data, truncationLength) == XLAL_SUCCESS, XLAL_EFUNC );
+      } else {
+         for (UINT4 jj=0; jj<omegapr_squared->length; jj++) {
+            //Do all or nothing if the exponential is too negative
+            if ((prefact0-sigmas->data[ii]*sigmas->data[ii]*omegapr_squared->data[jj])>-88.0) {
+               exp_neg_sigma_sq_times_omega_pr_sq->data[jj] = expf((REAL4)(prefact0-sigmas->data[ii]*sigmas->data[ii]*omegapr_squared->data[jj]));
+               XLAL_CHECK( XLALSinCos2PiLUT(&sin2pix, &cos2pix, phi_actual->data[ii]*fpr->data[jj]) == XLAL_SUCCESS, XLAL_EFUNC );
+               if (cos2pix>1.0) cos2pix = 1.0;
+               else if (cos2pix<-1.0) cos2pix = -1.0;
+               cos_phi_times_omega_pr->data[jj] = (REAL4)cos2pix;
+               datavector->data[jj] = scale->data[ii]*exp_neg_sigma_sq_times_omega_pr_sq->data[jj]*(cos_phi_times_omega_pr->data[jj]+1.0)*cos_ratio->data[jj];
+            }
+            /* Don't need to compute the else because the datavector was set to zero in the outer for loop */
+         } /* for jj = 0 --> omegapr_squared->length */
+      } /* use SSE or not */
+
+      //Now loop through the second FFT frequencies, starting with index 4
+      for (UINT4 jj=4; jj<omegapr->length; jj++) {
+         //Sum up the weights in total
+         sum += (REAL8)(datavector->data[jj]);
+
+         //Compare with weakest top bins and if larger, launch a search to find insertion spot (insertion sort)
+         if (datavector->data[jj] > output->templatedata->data[output->templatedata->length-1]) {
+            insertionSort_template(output, datavector->data[jj], bins2middlebin*fpr->length+jj);
+         }
+      } /* for jj < omegapr->length */
+   } /* for ii < sigmas->length */
+
+   //Normalize
+   REAL4 invsum = (REAL4)(1.0/sum);
+   XLAL_CHECK( XLALVectorScaleREAL4(output->templatedata->data, invsum, output->templatedata->data, output->templatedata->length) == XLAL_SUCCESS, XLAL_EFUNC );
+
+   //Truncate weights when they don't add much to the total sum of weights
+   sum = 0.0;
+   for (UINT4 ii=0; ii<minTemplateLength; ii++) sum += (REAL8)output->templatedata->data[ii];
+   UINT4 counter = minTemplateLength;
+   while (counter<output->templatedata->length && output->templatedata->data[counter]>=epsval_float((REAL4)sum)) {
+      sum += (REAL8)output->templatedata->data[counter];
+      counter++;
+   }
+   for (/* last counter val */; counter<output->templatedata->length; counter++) output->templatedata->data[counter] = 0.0;
+
+   //Destroy variables
+   XLALDestroyREAL4VectorAligned(phi_actual);
+   XLALDestroyREAL4VectorAligned(scale);
+   XLALDestroyREAL4VectorAligned(sigmas);
+   XLALDestroyREAL4VectorAligned(binvals);
+   XLALDestroyREAL4VectorAligned(bindiffvals);
+   XLALDestroyREAL4VectorAligned(absbindiffvals);
+   destroyREAL4VectorAlignedArray(allsigmas);
+   destroyREAL4VectorAlignedArray(weightvals);
+   XLALDestroyREAL4VectorAligned(wvals);
+   XLALDestroyREAL4VectorAligned(fpr);
+   XLALDestroyREAL4VectorAligned(omegapr);
+   XLALDestroyREAL4VectorAligned(omegapr_squared);
+   XLALDestroyREAL4VectorAligned(cos_ratio);
+   XLALDestroyREAL4VectorAligned(exp_neg_sigma_sq_times_omega_pr_sq);
+   XLALDestroyREAL4VectorAligned(phi_times_fpr);
+   XLALDestroyREAL4VectorAligned(sin_phi_times_omega_pr);
+   XLALDestroyREAL4VectorAligned(cos_phi_times_omega_pr);
+   XLALDestroyREAL4VectorAligned(datavector);
+
+   return XLAL_SUCCESS;
+
+} /* makeTemplateGaussians2_reference() */
+
+
+static INT4 makeTemplate2_reference(TwoSpectTemplate *output, const REAL8 offset, const REAL8 P, const REAL8 deltaf, const REAL8 Tsft, const REAL8 SFToverlap, const REAL8 Tobs, const UINT4 minTemplateLength, const UINT4 vectormathflag, const REAL4FFTPlan *plan)
+{
+   XLAL_CHECK( output!=NULL && plan!=NULL, XLAL_EINVAL );
+
+   output->f0 = offset;
+   output->period = P;
+   output->moddepth = deltaf;
+
+   //Reset to zero, just in case
+   memset(output->templatedata->data, 0, sizeof(REAL4)*output->templatedata->length);
+
+   UINT4 numffts = (UINT4)floor(Tobs/(Tsft-SFToverlap)-1);
+   UINT4 numfprbins = (UINT4)floorf(0.5*numffts) + 1;
+
+   //Determine span of the template
+   REAL8 binamplitude = deltaf*Tsft;
+   REAL8 binmin = -binamplitude + offset;
+   REAL8 binmax = binamplitude + offset;
+   INT4 templatemin = (INT4)round(binmin), templatemax = (INT4)round(binmax);
+   if (templatemin > binmin) templatemin--;
+   if (templatemin - binmin >= -0.5) templatemin--;
+   if (templatemax < binmax) templatemax++;
+   if (templatemax - binmax <= 0.5) templatemax++;
+   UINT4 templatespan = (UINT4)(templatemax - templatemin) + 1;
+
+   REAL8 periodf = 1.0/P;
+
+   REAL4VectorAligned *psd1 = NULL;
+   alignedREAL8Vector *freqbins = NULL, *bindiffs = NULL;
+   XLAL_CHECK( (psd1 = XLALCreateREAL4VectorAligned(templatespan*numffts, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (freqbins = createAlignedREAL8Vector(templatespan, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (bindiffs = createAlignedREAL8Vector(templatespan, 32)) != NULL, XLAL_EFUNC );
+   memset(psd1->data, 0, sizeof(REAL4)*psd1->length);
+
+   //Bin numbers of the frequencies
+   for (UINT4 ii=0; ii<templatespan; ii++) freqbins->data[ii] = (REAL8)(templatemin + (INT4)ii);
+
+   //Determine the signal modulation in bins with time at center of coherence time and create
+   //Hann windowed PSDs
+   REAL8 PSDprefact = 2.0/3.0;
+   REAL4VectorAligned *t = NULL, *sigbin_sin2PiPeriodfT = NULL, *cos2PiPeriodfT = NULL;
+   XLAL_CHECK( (t = XLALCreateREAL4VectorAligned(numffts, 32)) != NULL, XLAL_EFUNC  );
+   XLAL_CHECK( (sigbin_sin2PiPeriodfT = XLALCreateREAL4VectorAligned(numffts, 32)) != NULL, XLAL_EFUNC  );
+   XLAL_CHECK( (cos2PiPeriodfT = XLALCreateREAL4VectorAligned(numffts, 32)) != NULL, XLAL_EFUNC  );
+   for (UINT4 ii=0; ii<numffts; ii++) t->data[ii] = 0.5*Tsft*(ii+1); //Assumed 50% overlapping SFTs
+   XLAL_CHECK( XLALVectorScaleREAL4(t->data, periodf, t->data, t->length) == XLAL_SUCCESS, XLAL_EFUNC );
+   XLAL_CHECK( XLALVectorSinCos2PiREAL4(sigbin_sin2PiPeriodfT->data, cos2PiPeriodfT->data, t->data, t->length) == XLAL_SUCCESS, XLAL_EFUNC );
+   XLAL_CHECK( XLALVectorScaleREAL4(sigbin_sin2PiPeriodfT->data, binamplitude, sigbin_sin2PiPeriodfT->data, sigbin_sin2PiPeriodfT->length) == XLAL_SUCCESS, XLAL_EFUNC );
+   XLAL_CHECK( XLALVectorShiftREAL4(sigbin_sin2PiPeriodfT->data, offset, sigbin_sin2PiPeriodfT->data, sigbin_sin2PiPeriodfT->length) == XLAL_SUCCESS, XLAL_EFUNC );
+   XLALDestroyREAL4VectorAligned(t);
+   XLALDestroyREAL4VectorAligned(cos2PiPeriodfT);
+   for (UINT4 ii=0; ii<numffts; ii++) {
+      REAL8 sigbin = sigbin_sin2PiPeriodfT->data[ii];
+      XLAL_CHECK( VectorShiftREAL8(bindiffs, freqbins, -sigbin, vectormathflag) == XLAL_SUCCESS, XLAL_EFUNC );
+      for (UINT4 jj=0; jj<templatespan; jj++) {
+         //Create PSD values organized by f0 => psd1->data[0...numffts-1], sft1 => psd1->data[numffts...2*numffts-1]
+         //Restricting to +/- 1.75 bins means >99.9% of the total power is included in the template calculation
+         if ( fabs(bindiffs->data[jj]) <= 1.75 ) {
+            psd1->data[ii + jj*numffts] = sqsincxoverxsqminusone(bindiffs->data[jj])*PSDprefact;
+            XLAL_CHECK( xlalErrno==0, XLAL_EFUNC );
+         }
+      } /* for jj < numfbins */
+   } /* for ii < numffts */
+   XLALDestroyREAL4VectorAligned(sigbin_sin2PiPeriodfT);
+
+   //Do the second FFT
+   REAL4VectorAligned *x = NULL, *psd = NULL, *windowdata = NULL;
+   REAL4Window *win = NULL;
+   XLAL_CHECK( (x = XLALCreateREAL4VectorAligned(numffts, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (psd = XLALCreateREAL4VectorAligned(numfprbins, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (windowdata = XLALCreateREAL4VectorAligned(x->length, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (win = XLALCreateHannREAL4Window(x->length)) != NULL, XLAL_EFUNC );
+   memcpy(windowdata->data, win->data->data, x->length*sizeof(REAL4));
+   REAL8 winFactor = 8.0/3.0, secPSDfactor = winFactor/x->length*0.5*Tsft, sum = 0.0;
+   BOOLEAN doSecondFFT;
+   //First loop over frequencies
+   for (UINT4 ii=0; ii<templatespan; ii++) {
+      //Set doSecondFFT check flag to 0. Value becomes 1 if we are to do the second FFT
+      doSecondFFT = 0;
+
+      INT4 bins2middlebin = ii + templatemin;  //Number of frequency bins away from the "central frequency bin" of the template
+
+      //Next, loop over times and check to see if we need to do second FFT
+      //Sum up the power in the row and see if it exceeds 5.0*(sinc(3.0)/(3.0^2-1))^2
+      REAL4 rowpowersum = 0.0;
+      for (UINT4 jj=0; jj<x->length; jj++) rowpowersum += psd1->data[ii*numffts+jj];
+      if (rowpowersum > 1.187167e-34) doSecondFFT = 1;
+
+      //If we are to do the second FFT then do it!
+      if (doSecondFFT) {
+         //Obtain and window the time series
+         memcpy(x->data, &(psd1->data[ii*numffts]), sizeof(REAL4)*x->length);
+         XLAL_CHECK( XLALVectorMultiplyREAL4(x->data, x->data, windowdata->data, x->length) == XLAL_SUCCESS, XLAL_EFUNC );
+
+         //Do the FFT
+         XLAL_CHECK( XLALREAL4PowerSpectrum((REAL4Vector*)psd, (REAL4Vector*)x, plan) == XLAL_SUCCESS, XLAL_EFUNC );
+
+         //Scale the data points by 1/N and window factor and (1/fs)
+         //Order of vector is by second frequency then first frequency
+         XLAL_CHECK( XLALVectorScaleREAL4(psd->data, secPSDfactor, psd->data, psd->length) == XLAL_SUCCESS, XLAL_EFUNC );
+
+         //Ignore the DC to 3rd frequency bins in sum
+         for (UINT4 jj=4; jj<psd->length; jj++) {
+            sum += (REAL8)psd->data[jj];     //sum up the total weight
+
+            //Sort the weights, insertion sort technique
+            if (psd->data[jj] > output->templatedata->data[output->templatedata->length-1]) insertionSort_template(output, psd->data[jj], bins2middlebin*psd->length+jj);
+         } /* for jj < psd->length */
+      } /* if doSecondFFT */
+   } /* if ii < numfbins */
+
+   //Normalize
+   REAL4 invsum = (REAL4)(1.0/sum);
+   XLAL_CHECK( XLALVectorScaleREAL4(output->templatedata->data, invsum, output->templatedata->data, output->templatedata->length) == XLAL_SUCCESS, XLAL_EFUNC );
+
+   //Truncate weights if they don't contribute much to the sum
+   sum = 0.0;
+   for (UINT4 ii=0; ii<minTemplateLength; ii++) sum += (REAL8)output->templatedata->data[ii];
+   UINT4 counter = minTemplateLength;
+   while (counter<output->templatedata->length && output->templatedata->data[counter]>=epsval_float((REAL4)sum)) {
+      sum += (REAL8)output->templatedata->data[counter];
+      counter++;
+   }
+   for (/* last counter val */; counter<output->templatedata->length; counter++) output->templatedata->data[counter] = 0.0;
+
+   //Destroy stuff
+   XLALDestroyREAL4VectorAligned(psd1);
+   destroyAlignedREAL8Vector(freqbins);
+   destroyAlignedREAL8Vector(bindiffs);
+   XLALDestroyREAL4Window(win);
+   XLALDestroyREAL4VectorAligned(x);
+   XLALDestroyREAL4VectorAligned(psd);
+   XLALDestroyREAL4VectorAligned(windowdata);
+
+   return XLAL_SUCCESS;
+
+} /* makeTemplate2_reference() */
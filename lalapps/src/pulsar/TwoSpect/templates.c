@@ -19,6 +19,7 @@
 
 #include <lal/Window.h>
 #include <lal/VectorOps.h>
+#include <lal/VectorMath.h>
 #include <lal/SinCosLUT.h>
 
 #include "templates.h"
@@ -26,6 +27,21 @@
 #include "statistics.h"
 #include "TwoSpectSpecFunc.h"
 
+#ifndef _OPENMP
+#define omp ignore
+#endif
+
+//Pixel weight and location, used to select the largest weights of a template
+typedef struct {
+   REAL4 weight;
+   INT4 pixelloc;
+} templatePixel;
+
+static int compareTemplatePixels(const templatePixel *a, const templatePixel *b);
+static int compareTemplatePixels_qsort(const void *a, const void *b);
+static void nthElement_templatePixels(templatePixel *pixels, const INT4 numpixels, const INT4 nth);
+static void selectTopWeights_template(TwoSpectTemplate *output, templatePixel *pixels, const INT4 numpixels);
+
 
 /**
  * Allocate a new TwoSpectTemplate
@@ -157,23 +173,25 @@ TwoSpectTemplateVector * generateTwoSpectTemplateVector(const REAL8 Pmin, const
    UINT4 numdfvals = (UINT4)(floor(2.0*Tsft*(dfmax-dfmin)))+1, numtemplatesgenerated = 0;
    REAL8 alpha0 = 45.0*(Tsft/1800.0)+30.0;
 
-   UINT4 numffts = (UINT4)floor(Tobs/(Tsft-SFToverlap)-1);
-   REAL4FFTPlan *plan = NULL;
-   XLAL_CHECK_NULL( (plan = XLALCreateForwardREAL4FFTPlan(numffts, 1)) != NULL, XLAL_EFUNC );
-
-   REAL8Vector *dfvals = NULL;
+   //First determine the template parameters, then make all the templates together
+   REAL8Vector *dfvals = NULL, *offsets = NULL, *periods = NULL, *moddepths = NULL;
    XLAL_CHECK_NULL( (dfvals = XLALCreateREAL8Vector(numdfvals)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK_NULL( (offsets = XLALCreateREAL8Vector(vector->length)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK_NULL( (periods = XLALCreateREAL8Vector(vector->length)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK_NULL( (moddepths = XLALCreateREAL8Vector(vector->length)) != NULL, XLAL_EFUNC );
    for (UINT4 ii=0; ii<numdfvals; ii++) dfvals->data[ii] = dfmin + 0.5*ii/Tsft;
    for (UINT4 ii=0; ii<numdfvals; ii++) {
       REAL8 P = Pmax;
       while (P>=Pmin && P>=2.0*dfvals->data[ii]*Tsft*Tsft && numtemplatesgenerated<vector->length) {
-         if (!exactflag) XLAL_CHECK_NULL( makeTemplateGaussians2(vector->data[numtemplatesgenerated], 0.0, P, dfvals->data[ii], Tsft, SFToverlap, Tobs, minTemplateLength, vectormathflag) == XLAL_SUCCESS, XLAL_EFUNC );
-         else XLAL_CHECK_NULL( makeTemplate2(vector->data[numtemplatesgenerated], 0.0, P, dfvals->data[ii], Tsft, SFToverlap, Tobs, minTemplateLength, vectormathflag, plan) == XLAL_SUCCESS, XLAL_EFUNC );
+         offsets->data[numtemplatesgenerated] = 0.0;
+         periods->data[numtemplatesgenerated] = P;
+         moddepths->data[numtemplatesgenerated] = dfvals->data[ii];
          numtemplatesgenerated++;
          if (numtemplatesgenerated == vector->length) break;
-         
-         if (!exactflag) XLAL_CHECK_NULL( makeTemplateGaussians2(vector->data[numtemplatesgenerated], 0.5, P, dfvals->data[ii], Tsft, SFToverlap, Tobs, minTemplateLength, vectormathflag) == XLAL_SUCCESS, XLAL_EFUNC );
-         else XLAL_CHECK_NULL( makeTemplate2(vector->data[numtemplatesgenerated], 0.5, P, dfvals->data[ii], Tsft, SFToverlap, Tobs, minTemplateLength, vectormathflag, plan) == XLAL_SUCCESS, XLAL_EFUNC );
+
+         offsets->data[numtemplatesgenerated] = 0.5;
+         periods->data[numtemplatesgenerated] = P;
+         moddepths->data[numtemplatesgenerated] = dfvals->data[ii];
          numtemplatesgenerated++;
          if (numtemplatesgenerated == vector->length) break;
 
@@ -182,15 +200,82 @@ TwoSpectTemplateVector * generateTwoSpectTemplateVector(const REAL8 Pmin, const
       }
       if (numtemplatesgenerated == vector->length) break;
    }
+   if (numtemplatesgenerated>0) {
+      XLAL_CHECK_NULL( (offsets = XLALResizeREAL8Vector(offsets, numtemplatesgenerated)) != NULL, XLAL_EFUNC );
+      XLAL_CHECK_NULL( (periods = XLALResizeREAL8Vector(periods, numtemplatesgenerated)) != NULL, XLAL_EFUNC );
+      XLAL_CHECK_NULL( (moddepths = XLALResizeREAL8Vector(moddepths, numtemplatesgenerated)) != NULL, XLAL_EFUNC );
+      XLAL_CHECK_NULL( makeTemplateBatch2(vector, offsets, periods, moddepths, minTemplateLength, vectormathflag, exactflag, NULL) == XLAL_SUCCESS, XLAL_EFUNC );
+   }
 
    XLALDestroyREAL8Vector(dfvals);
-   XLALDestroyREAL4FFTPlan(plan);
+   XLALDestroyREAL8Vector(offsets);
+   XLALDestroyREAL8Vector(periods);
+   XLALDestroyREAL8Vector(moddepths);
 
    fprintf(stderr, "Templates generated = %d\n", numtemplatesgenerated);
    return vector;
 }
 
 
+/**
+ * Make a batch of templates, filling the first elements of a TwoSpectTemplateVector
+ *
+ * The templates are computed in parallel when compiled with OpenMP. All threads share the same FFT plan, since the plan
+ * is only read when computing the power spectra
+ * \param [out] output            Pointer to the TwoSpectTemplateVector, with Tsft, SFToverlap, and Tobs set
+ * \param [in]  offsets           Pointer to REAL8Vector of frequency offsets of the templates (bins)
+ * \param [in]  periods           Pointer to REAL8Vector of orbital periods of the templates (s)
+ * \param [in]  moddepths         Pointer to REAL8Vector of modulation depths of the templates (Hz)
+ * \param [in]  minTemplateLength Minimum number of pixels in a template
+ * \param [in]  vectormathflag    Flag indicating to use vector math: 0 = none, 1 = SSE, 2 = AVX (must compile for vector math appropriately and CPU must have those instructions)
+ * \param [in]  exactflag         Flag specifying to use exact templates: 1 = enabled, 0 = disabled
+ * \param [in]  plan              Pointer to REAL4FFTPlan for exact templates, or NULL to create one internally if needed
+ * \return Status value
+ */
+INT4 makeTemplateBatch2(TwoSpectTemplateVector *output, const REAL8Vector *offsets, const REAL8Vector *periods, const REAL8Vector *moddepths, const UINT4 minTemplateLength, const UINT4 vectormathflag, const BOOLEAN exactflag, const REAL4FFTPlan *plan)
+{
+   XLAL_CHECK( output!=NULL && offsets!=NULL && periods!=NULL && moddepths!=NULL, XLAL_EINVAL );
+   XLAL_CHECK( offsets->length==periods->length && offsets->length==moddepths->length && offsets->length<=output->length, XLAL_EINVAL );
+
+   const UINT4 numtemplates = offsets->length;
+   if (numtemplates==0) return XLAL_SUCCESS;
+   const REAL8 Tsft = output->Tsft, SFToverlap = output->SFToverlap, Tobs = output->Tobs;
+
+   REAL4FFTPlan *ownplan = NULL;
+   if (exactflag && plan==NULL) {
+      UINT4 numffts = (UINT4)floor(Tobs/(Tsft-SFToverlap)-1);
+      XLAL_CHECK( (ownplan = XLALCreateForwardREAL4FFTPlan(numffts, 1)) != NULL, XLAL_EFUNC );
+      plan = ownplan;
+   }
+
+   //The sin/cos lookup table is initialized on first use, so do that before entering the parallel region
+   XLALSinCosLUTInit();
+
+   INT4Vector *status = NULL;
+   XLAL_CHECK( (status = XLALCreateINT4Vector(numtemplates)) != NULL, XLAL_EFUNC );
+
+   #pragma omp parallel for schedule(dynamic)
+   for (UINT4 ii=0; ii<numtemplates; ii++) {
+      if (!exactflag) status->data[ii] = makeTemplateGaussians2(output->data[ii], offsets->data[ii], periods->data[ii], moddepths->data[ii], Tsft, SFToverlap, Tobs, minTemplateLength, vectormathflag);
+      else status->data[ii] = makeTemplate2(output->data[ii], offsets->data[ii], periods->data[ii], moddepths->data[ii], Tsft, SFToverlap, Tobs, minTemplateLength, vectormathflag, plan);
+   }
+
+   INT4 retval = XLAL_SUCCESS;
+   for (UINT4 ii=0; ii<numtemplates; ii++) {
+      if (status->data[ii] != XLAL_SUCCESS) {
+         retval = status->data[ii];
+         break;
+      }
+   }
+   XLALDestroyINT4Vector(status);
+   if (ownplan!=NULL) XLALDestroyREAL4FFTPlan(ownplan);
+   XLAL_CHECK( retval == XLAL_SUCCESS, XLAL_EFUNC, "Failed to make template\n" );
+
+   return XLAL_SUCCESS;
+
+} /* makeTemplateBatch2() */
+
+
 /**
  * Write a TwoSpectTemplateVector to binary file
  * \param [in] vector   Pointer to the TwoSpectTemplateVector
@@ -464,21 +549,22 @@ INT4 makeTemplateGaussians2(TwoSpectTemplate *output, const REAL8 offset, const
    }
 
    //Make sigmas for each frequency
-   //First, allocate vectors
-   REAL4VectorAligned *sigmas = NULL, *wvals = NULL, *binvals = NULL, *bindiffvals = NULL, *absbindiffvals = NULL;
-   REAL4VectorAlignedArray *allsigmas = NULL, *weightvals = NULL;
+   //First, allocate vectors. Only bins within 1.75 of the signal bin get a weight, so at most 4 bins per time sample
+   //contribute. We store only those (bin, sigma) pairs and evaluate all the weights at once below
+   REAL4VectorAligned *sigmas = NULL, *binvals = NULL, *compactbindiffs = NULL, *compactweights = NULL, *compactsigmas = NULL;
+   INT4Vector *compactbins = NULL;
+   UINT4 numwvals = (UINT4)floor(30.0*P/Tsft), numcompact = 0;
    XLAL_CHECK( (sigmas = XLALCreateREAL4VectorAligned(templatespan, 32)) != NULL, XLAL_EFUNC );
-   XLAL_CHECK( (wvals = XLALCreateREAL4VectorAligned((UINT4)floor(30.0*P/Tsft), 32)) != NULL, XLAL_EFUNC );
-   XLAL_CHECK( (allsigmas = createREAL4VectorAlignedArray(wvals->length, sigmas->length, 32)) != NULL, XLAL_EFUNC );
-   XLAL_CHECK( (weightvals = createREAL4VectorAlignedArray(wvals->length, sigmas->length, 32)) != NULL, XLAL_EFUNC );
    XLAL_CHECK( (binvals = XLALCreateREAL4VectorAligned(sigmas->length, 32)) != NULL, XLAL_EFUNC );
    for (UINT4 jj=0; jj<binvals->length; jj++) binvals->data[jj] = -((REAL4)jj + templatemin);
-   XLAL_CHECK( (bindiffvals = XLALCreateREAL4VectorAligned(binvals->length, 32)) != NULL, XLAL_EFUNC );
-   XLAL_CHECK( (absbindiffvals = XLALCreateREAL4VectorAligned(binvals->length, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (compactbindiffs = XLALCreateREAL4VectorAligned(4*numwvals, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (compactweights = XLALCreateREAL4VectorAligned(4*numwvals, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (compactsigmas = XLALCreateREAL4VectorAligned(4*numwvals, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (compactbins = XLALCreateINT4Vector(4*numwvals)) != NULL, XLAL_EFUNC );
 
    //Here is where the sigmas are computed. It is a weighted average. t = (ii+1)*in->Tsft*0.5
    REAL4 sin2pix = 0.0, cos2pix = 0.0;
-   for (UINT4 ii=0; ii<wvals->length; ii++) {
+   for (UINT4 ii=0; ii<numwvals; ii++) {
       //calculate sin and cos of 2*pi*t/P and then the bin the signal is in and the signal velocity
       XLAL_CHECK( XLALSinCos2PiLUT(&sin2pix, &cos2pix, periodf*((ii+1)*Tsft*0.5)) == XLAL_SUCCESS, XLAL_EFUNC );
       if (cos2pix>1.0) cos2pix = 1.0;
@@ -486,40 +572,47 @@ INT4 makeTemplateGaussians2(TwoSpectTemplate *output, const REAL8 offset, const
       REAL4 sigbin = (deltaf*cos2pix)*Tsft + offset;
       REAL4 sigbinvelocity = fabs(-deltaf*sin2pix*Tsft*Tsft*LAL_PI*periodf);
 
-      //Compute bin diff values
-      XLAL_CHECK( XLALVectorShiftREAL4(bindiffvals->data, sigbin, binvals->data, bindiffvals->length) == XLAL_SUCCESS, XLAL_EFUNC );
-      XLAL_CHECK( VectorAbsREAL4(absbindiffvals, bindiffvals, vectormathflag) == XLAL_SUCCESS, XLAL_EFUNC );
-
       //if the velocity approaches zero, the sigma calculation will diverge (which it should do) but this is bad numerically, so we cap it
       if (sigbinvelocity<1.0e-4) sigbinvelocity = 1.0e-4;
 
       //REAL4 sigma = 0.5*Tsft * (0.5346 * powf(sigbinvelocity, -1.0213f));   //Derived fit from simulation
       REAL4 sigma = 0.5*Tsft * (0.5979 / (sigbinvelocity - 3.2895e-5));  //Could think about using this fit in the future
 
-      //set all weightvals in each vector to zero
-      memset(weightvals->data[ii]->data, 0, sizeof(REAL4)*weightvals->data[ii]->length);
-
+      //Bin diff values, restricted to the bins near the signal
       REAL4 threshold = 1.75;
-      for (UINT4 jj=0; jj<sigmas->length; jj++) {
-         if (absbindiffvals->data[jj]<threshold) {
-            weightvals->data[ii]->data[jj] = sqsincxoverxsqminusone(bindiffvals->data[jj]);
-            XLAL_CHECK( xlalErrno==0, XLAL_EFUNC );
+      INT4 jjmin = (INT4)floorf(sigbin - threshold) - templatemin, jjmax = (INT4)ceilf(sigbin + threshold) - templatemin;
+      if (jjmin < 0) jjmin = 0;
+      if (jjmax > (INT4)sigmas->length-1) jjmax = (INT4)sigmas->length-1;
+      for (INT4 jj=jjmin; jj<=jjmax; jj++) {
+         REAL4 bindiff = sigbin + binvals->data[jj];
+         if (fabsf(bindiff)<threshold && numcompact<compactbins->length) {
+            compactbindiffs->data[numcompact] = bindiff;
+            compactsigmas->data[numcompact] = sigma;
+            compactbins->data[numcompact] = jj;
+            numcompact++;
          }
       }
-      XLAL_CHECK( XLALVectorScaleREAL4(allsigmas->data[ii]->data, sigma, weightvals->data[ii]->data, sigmas->length) == XLAL_SUCCESS, XLAL_EFUNC );
 
-   } /* for ii < wvals->length */
-   for (UINT4 ii=0; ii<sigmas->length; ii++) {
-      REAL8 wavesigma = 0.0;
-      REAL8 totalw = 0.0;
-      for (UINT4 jj=0; jj<wvals->length; jj++) {
-         if (weightvals->data[jj]->data[ii] != 0.0) {
-            wavesigma += allsigmas->data[jj]->data[ii];
-            totalw += weightvals->data[jj]->data[ii];
-         }
+   } /* for ii < numwvals */
+
+   //Weights of each (time, bin) pair
+   XLAL_CHECK( sqsincxoverxsqminusoneVector(compactweights->data, compactbindiffs->data, numcompact) == XLAL_SUCCESS, XLAL_EFUNC );
+
+   //Weighted average of the sigmas for each bin, accumulated in time order
+   alignedREAL8Vector *wavesigmas = NULL, *totalws = NULL;
+   XLAL_CHECK( (wavesigmas = createAlignedREAL8Vector(sigmas->length, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (totalws = createAlignedREAL8Vector(sigmas->length, 32)) != NULL, XLAL_EFUNC );
+   memset(wavesigmas->data, 0, sizeof(REAL8)*wavesigmas->length);
+   memset(totalws->data, 0, sizeof(REAL8)*totalws->length);
+   for (UINT4 ii=0; ii<numcompact; ii++) {
+      if (compactweights->data[ii] != 0.0) {
+         wavesigmas->data[compactbins->data[ii]] += (REAL4)(compactsigmas->data[ii]*compactweights->data[ii]);
+         totalws->data[compactbins->data[ii]] += compactweights->data[ii];
       }
-      sigmas->data[ii] = (REAL4)(wavesigma/totalw);
-   } /* for ii < sigmas->length */
+   }
+   for (UINT4 ii=0; ii<sigmas->length; ii++) sigmas->data[ii] = (REAL4)(wavesigmas->data[ii]/totalws->data[ii]);
+   destroyAlignedREAL8Vector(wavesigmas);
+   destroyAlignedREAL8Vector(totalws);
 
    //Allocate more useful data vectors. These get computed for each different first FFT frequency bin in the F-F plane
    REAL4VectorAligned *exp_neg_sigma_sq_times_omega_pr_sq = NULL, *sin_phi_times_omega_pr = NULL, *cos_phi_times_omega_pr = NULL, *phi_times_fpr = NULL, *datavector = NULL;
@@ -529,6 +622,11 @@ INT4 makeTemplateGaussians2(TwoSpectTemplate *output, const REAL8 offset, const
    XLAL_CHECK( (phi_times_fpr = XLALCreateREAL4VectorAligned(fpr->length, 32)) != NULL, XLAL_EFUNC );
    XLAL_CHECK( (datavector = XLALCreateREAL4VectorAligned(fpr->length, 32)) != NULL, XLAL_EFUNC );
 
+   //Non-zero weights of all pixels, from which the largest are selected
+   templatePixel *pixels = NULL;
+   INT4 numpixels = 0;
+   XLAL_CHECK( (pixels = XLALMalloc(sizeof(*pixels)*sigmas->length*(fpr->length-4))) != NULL, XLAL_ENOMEM );
+
    //Create template. We are going to do exp(log(Eq. 18))
    REAL8 sum = 0.0;
    REAL4 log4pi = 2.53102424697f;
@@ -593,13 +691,19 @@ INT4 makeTemplateGaussians2(TwoSpectTemplate *output, const REAL8 offset, const
          //Sum up the weights in total
          sum += (REAL8)(datavector->data[jj]);
 
-         //Compare with weakest top bins and if larger, launch a search to find insertion spot (insertion sort)
-         if (datavector->data[jj] > output->templatedata->data[output->templatedata->length-1]) {
-            insertionSort_template(output, datavector->data[jj], bins2middlebin*fpr->length+jj);
+         //Keep non-zero weights for selecting the largest ones below
+         if (datavector->data[jj] > 0.0) {
+            pixels[numpixels].weight = datavector->data[jj];
+            pixels[numpixels].pixelloc = bins2middlebin*fpr->length+jj;
+            numpixels++;
          }
       } /* for jj < omegapr->length */
    } /* for ii < sigmas->length */
 
+   //Select the largest weights
+   selectTopWeights_template(output, pixels, numpixels);
+   XLALFree(pixels);
+
    //Normalize
    REAL4 invsum = (REAL4)(1.0/sum);
    XLAL_CHECK( XLALVectorScaleREAL4(output->templatedata->data, invsum, output->templatedata->data, output->templatedata->length) == XLAL_SUCCESS, XLAL_EFUNC );
@@ -619,11 +723,10 @@ INT4 makeTemplateGaussians2(TwoSpectTemplate *output, const REAL8 offset, const
    XLALDestroyREAL4VectorAligned(scale);
    XLALDestroyREAL4VectorAligned(sigmas);
    XLALDestroyREAL4VectorAligned(binvals);
-   XLALDestroyREAL4VectorAligned(bindiffvals);
-   XLALDestroyREAL4VectorAligned(absbindiffvals);
-   destroyREAL4VectorAlignedArray(allsigmas);
-   destroyREAL4VectorAlignedArray(weightvals);
-   XLALDestroyREAL4VectorAligned(wvals);
+   XLALDestroyREAL4VectorAligned(compactbindiffs);
+   XLALDestroyREAL4VectorAligned(compactweights);
+   XLALDestroyREAL4VectorAligned(compactsigmas);
+   XLALDestroyINT4Vector(compactbins);
    XLALDestroyREAL4VectorAligned(fpr);
    XLALDestroyREAL4VectorAligned(omegapr);
    XLALDestroyREAL4VectorAligned(omegapr_squared);
@@ -721,10 +824,9 @@ INT4 makeTemplate2(TwoSpectTemplate *output, const REAL8 offset, const REAL8 P,
    REAL8 periodf = 1.0/P;
 
    REAL4VectorAligned *psd1 = NULL;
-   alignedREAL8Vector *freqbins = NULL, *bindiffs = NULL;
+   alignedREAL8Vector *freqbins = NULL;
    XLAL_CHECK( (psd1 = XLALCreateREAL4VectorAligned(templatespan*numffts, 32)) != NULL, XLAL_EFUNC );
    XLAL_CHECK( (freqbins = createAlignedREAL8Vector(templatespan, 32)) != NULL, XLAL_EFUNC );
-   XLAL_CHECK( (bindiffs = createAlignedREAL8Vector(templatespan, 32)) != NULL, XLAL_EFUNC );
    memset(psd1->data, 0, sizeof(REAL4)*psd1->length);
 
    //Bin numbers of the frequencies
@@ -744,19 +846,36 @@ INT4 makeTemplate2(TwoSpectTemplate *output, const REAL8 offset, const REAL8 P,
    XLAL_CHECK( XLALVectorShiftREAL4(sigbin_sin2PiPeriodfT->data, offset, sigbin_sin2PiPeriodfT->data, sigbin_sin2PiPeriodfT->length) == XLAL_SUCCESS, XLAL_EFUNC );
    XLALDestroyREAL4VectorAligned(t);
    XLALDestroyREAL4VectorAligned(cos2PiPeriodfT);
+
+   //Restricting to +/- 1.75 bins means >99.9% of the total power is included in the template calculation, so at most
+   //4 frequency bins per time contribute. Collect those bin differences first, then evaluate the sinc function for all of them at once
+   REAL4VectorAligned *compactbindiffs = NULL, *compactpsd = NULL;
+   INT4Vector *compactlocs = NULL;
+   XLAL_CHECK( (compactbindiffs = XLALCreateREAL4VectorAligned(4*numffts, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (compactpsd = XLALCreateREAL4VectorAligned(4*numffts, 32)) != NULL, XLAL_EFUNC );
+   XLAL_CHECK( (compactlocs = XLALCreateINT4Vector(4*numffts)) != NULL, XLAL_EFUNC );
+   UINT4 numcompact = 0;
    for (UINT4 ii=0; ii<numffts; ii++) {
       REAL8 sigbin = sigbin_sin2PiPeriodfT->data[ii];
-      XLAL_CHECK( VectorShiftREAL8(bindiffs, freqbins, -sigbin, vectormathflag) == XLAL_SUCCESS, XLAL_EFUNC );
-      for (UINT4 jj=0; jj<templatespan; jj++) {
-         //Create PSD values organized by f0 => psd1->data[0...numffts-1], sft1 => psd1->data[numffts...2*numffts-1]
-         //Restricting to +/- 1.75 bins means >99.9% of the total power is included in the template calculation
-         if ( fabs(bindiffs->data[jj]) <= 1.75 ) {
-            psd1->data[ii + jj*numffts] = sqsincxoverxsqminusone(bindiffs->data[jj])*PSDprefact;
-            XLAL_CHECK( xlalErrno==0, XLAL_EFUNC );
+      INT4 jjmin = (INT4)floor(sigbin - 1.75) - templatemin, jjmax = (INT4)ceil(sigbin + 1.75) - templatemin;
+      if (jjmin < 0) jjmin = 0;
+      if (jjmax > (INT4)templatespan-1) jjmax = (INT4)templatespan-1;
+      for (INT4 jj=jjmin; jj<=jjmax; jj++) {
+         REAL8 bindiff = freqbins->data[jj] - sigbin;
+         if ( fabs(bindiff) <= 1.75 && numcompact<compactbindiffs->length ) {
+            compactbindiffs->data[numcompact] = (REAL4)bindiff;
+            //Create PSD values organized by f0 => psd1->data[0...numffts-1], sft1 => psd1->data[numffts...2*numffts-1]
+            compactlocs->data[numcompact] = ii + jj*numffts;
+            numcompact++;
          }
-      } /* for jj < numfbins */
+      } /* for jj in [jjmin, jjmax] */
    } /* for ii < numffts */
    XLALDestroyREAL4VectorAligned(sigbin_sin2PiPeriodfT);
+   XLAL_CHECK( sqsincxoverxsqminusoneVector(compactpsd->data, compactbindiffs->data, numcompact) == XLAL_SUCCESS, XLAL_EFUNC );
+   for (UINT4 ii=0; ii<numcompact; ii++) psd1->data[compactlocs->data[ii]] = compactpsd->data[ii]*PSDprefact;
+   XLALDestroyREAL4VectorAligned(compactbindiffs);
+   XLALDestroyREAL4VectorAligned(compactpsd);
+   XLALDestroyINT4Vector(compactlocs);
 
    //Do the second FFT
    REAL4VectorAligned *x = NULL, *psd = NULL, *windowdata = NULL;
@@ -767,6 +886,9 @@ INT4 makeTemplate2(TwoSpectTemplate *output, const REAL8 offset, const REAL8 P,
    XLAL_CHECK( (win = XLALCreateHannREAL4Window(x->length)) != NULL, XLAL_EFUNC );
    memcpy(windowdata->data, win->data->data, x->length*sizeof(REAL4));
    REAL8 winFactor = 8.0/3.0, secPSDfactor = winFactor/x->length*0.5*Tsft, sum = 0.0;
+   templatePixel *pixels = NULL;
+   INT4 numpixels = 0;
+   XLAL_CHECK( (pixels = XLALMalloc(sizeof(*pixels)*templatespan*(psd->length-4))) != NULL, XLAL_ENOMEM );
    BOOLEAN doSecondFFT;
    //First loop over frequencies
    for (UINT4 ii=0; ii<templatespan; ii++) {
@@ -798,12 +920,20 @@ INT4 makeTemplate2(TwoSpectTemplate *output, const REAL8 offset, const REAL8 P,
          for (UINT4 jj=4; jj<psd->length; jj++) {
             sum += (REAL8)psd->data[jj];     //sum up the total weight
 
-            //Sort the weights, insertion sort technique
-            if (psd->data[jj] > output->templatedata->data[output->templatedata->length-1]) insertionSort_template(output, psd->data[jj], bins2middlebin*psd->length+jj);
+            //Keep non-zero weights for selecting the largest ones below
+            if (psd->data[jj] > 0.0) {
+               pixels[numpixels].weight = psd->data[jj];
+               pixels[numpixels].pixelloc = bins2middlebin*psd->length+jj;
+               numpixels++;
+            }
          } /* for jj < psd->length */
       } /* if doSecondFFT */
    } /* if ii < numfbins */
 
+   //Select the largest weights
+   selectTopWeights_template(output, pixels, numpixels);
+   XLALFree(pixels);
+
    //Normalize
    REAL4 invsum = (REAL4)(1.0/sum);
    XLAL_CHECK( XLALVectorScaleREAL4(output->templatedata->data, invsum, output->templatedata->data, output->templatedata->length) == XLAL_SUCCESS, XLAL_EFUNC );
@@ -821,7 +951,6 @@ INT4 makeTemplate2(TwoSpectTemplate *output, const REAL8 offset, const REAL8 P,
    //Destroy stuff
    XLALDestroyREAL4VectorAligned(psd1);
    destroyAlignedREAL8Vector(freqbins);
-   destroyAlignedREAL8Vector(bindiffs);
    XLALDestroyREAL4Window(win);
    XLALDestroyREAL4VectorAligned(x);
    XLALDestroyREAL4VectorAligned(psd);
@@ -859,6 +988,83 @@ void insertionSort_template(TwoSpectTemplate *output, const REAL4 weight, const
 } /* insertionSort_template() */
 
 
+/**
+ * Order pixels by decreasing weight, and by increasing pixel location for equal weights
+ * \param [in] a Pointer to the first templatePixel
+ * \param [in] b Pointer to the second templatePixel
+ * \return -1, 0, or 1 if a is ranked before, equal to, or after b
+ */
+static int compareTemplatePixels(const templatePixel *a, const templatePixel *b)
+{
+   if (a->weight > b->weight) return -1;
+   if (a->weight < b->weight) return 1;
+   if (a->pixelloc < b->pixelloc) return -1;
+   if (a->pixelloc > b->pixelloc) return 1;
+   return 0;
+} /* compareTemplatePixels() */
+static int compareTemplatePixels_qsort(const void *a, const void *b)
+{
+   return compareTemplatePixels((const templatePixel*)a, (const templatePixel*)b);
+} /* compareTemplatePixels_qsort() */
+
+
+/**
+ * Partially order the pixels so that pixels[nth] is the pixel that would be there if the array were sorted, all pixels
+ * before it are ranked before it, and all pixels after it are ranked after it (quickselect)
+ * \param [in,out] pixels    Pointer to an array of templatePixel
+ * \param [in]     numpixels Number of pixels in the array
+ * \param [in]     nth       Index of the pixel to place
+ */
+static void nthElement_templatePixels(templatePixel *pixels, const INT4 numpixels, const INT4 nth)
+{
+   INT4 lo = 0, hi = numpixels-1;
+   templatePixel tmp;
+   while (hi > lo) {
+      //Median of three as the pivot, moved to pixels[hi]
+      INT4 mid = lo + (hi-lo)/2;
+      if (compareTemplatePixels(&pixels[mid], &pixels[lo])<0) { tmp = pixels[mid]; pixels[mid] = pixels[lo]; pixels[lo] = tmp; }
+      if (compareTemplatePixels(&pixels[hi], &pixels[lo])<0) { tmp = pixels[hi]; pixels[hi] = pixels[lo]; pixels[lo] = tmp; }
+      if (compareTemplatePixels(&pixels[mid], &pixels[hi])<0) { tmp = pixels[mid]; pixels[mid] = pixels[hi]; pixels[hi] = tmp; }
+
+      //Partition around the pivot
+      INT4 store = lo;
+      for (INT4 ii=lo; ii<hi; ii++) {
+         if (compareTemplatePixels(&pixels[ii], &pixels[hi])<0) {
+            tmp = pixels[ii]; pixels[ii] = pixels[store]; pixels[store] = tmp;
+            store++;
+         }
+      }
+      tmp = pixels[hi]; pixels[hi] = pixels[store]; pixels[store] = tmp;
+
+      if (store == nth) return;
+      else if (store < nth) lo = store + 1;
+      else hi = store - 1;
+   }
+} /* nthElement_templatePixels() */
+
+
+/**
+ * Fill the template with the largest weights, in decreasing order. This gives the same result as calling
+ * insertionSort_template() for each pixel in order of increasing pixel location, but only sorts the pixels that are kept
+ * \param [out]    output    Pointer to TwoSpectTemplate, with templatedata set to zero
+ * \param [in,out] pixels    Pointer to an array of templatePixel with weights > 0 (reordered on output)
+ * \param [in]     numpixels Number of pixels in the array
+ */
+static void selectTopWeights_template(TwoSpectTemplate *output, templatePixel *pixels, const INT4 numpixels)
+{
+   INT4 numkept = numpixels;
+   if (numkept > (INT4)output->templatedata->length) {
+      numkept = output->templatedata->length;
+      nthElement_templatePixels(pixels, numpixels, numkept-1);
+   }
+   qsort(pixels, numkept, sizeof(*pixels), compareTemplatePixels_qsort);
+   for (INT4 ii=0; ii<numkept; ii++) {
+      output->templatedata->data[ii] = pixels[ii].weight;
+      output->pixellocations->data[ii] = pixels[ii].pixelloc;
+   }
+} /* selectTopWeights_template() */
+
+
 /**
  * Calculate sin(pi*x)/(pi*x)/(x^2-1)
  * \param x Value from which to compute
@@ -889,3 +1095,44 @@ REAL8 sqsincxoverxsqminusone(const REAL8 x)
 } /* sqsincxoverxsqminusone() */
 
 
+/**
+ * Calculate [sin(pi*x)/(pi*x)/(x^2-1)]^2 for a vector of values
+ *
+ * The sine is computed with the vector math functions after reducing pi*x to [-pi/2, pi/2], which keeps the
+ * precision near the removable singularities at x = +/-1
+ * \param [out] output Pointer to output array
+ * \param [in]  x      Pointer to input array (may be the same as output)
+ * \param [in]  length Number of values
+ * \return Status value
+ */
+INT4 sqsincxoverxsqminusoneVector(REAL4 *output, const REAL4 *x, const UINT4 length)
+{
+   XLAL_CHECK( (output!=NULL && x!=NULL) || length==0, XLAL_EINVAL );
+   if (length==0) return XLAL_SUCCESS;
+
+   REAL4VectorAligned *sinpix = NULL;
+   XLAL_CHECK( (sinpix = XLALCreateREAL4VectorAligned(length, 32)) != NULL, XLAL_EFUNC );
+
+   //sin(pi*x) = (-1)^n sin(pi*(x-n)), with n the nearest integer to x
+   for (UINT4 ii=0; ii<length; ii++) sinpix->data[ii] = x[ii] - rintf(x[ii]);
+   XLAL_CHECK( XLALVectorScaleREAL4(sinpix->data, (REAL4)LAL_PI, sinpix->data, length) == XLAL_SUCCESS, XLAL_EFUNC );
+   XLAL_CHECK( XLALVectorSinREAL4(sinpix->data, sinpix->data, length) == XLAL_SUCCESS, XLAL_EFUNC );
+
+   for (UINT4 ii=0; ii<length; ii++) {
+      REAL8 xval = x[ii], val;
+      if (fabs(xval*xval-1.0)<1.0e-8) val = -0.5;
+      else if (fabs(xval)<1.0e-8) val = -1.0;
+      else {
+         REAL8 sinval = ((INT4)rintf(x[ii]) % 2 == 0) ? sinpix->data[ii] : -sinpix->data[ii];
+         val = sinval/(LAL_PI*xval*(xval*xval-1.0));
+      }
+      output[ii] = (REAL4)(val*val);
+   }
+
+   XLALDestroyREAL4VectorAligned(sinpix);
+
+   return XLAL_SUCCESS;
+
+} /* sqsincxoverxsqminusoneVector() */
+
+
@@ -37,10 +37,12 @@ INT4 makeTemplateGaussians(TwoSpectTemplate *output, const candidate input, cons
 INT4 makeTemplateGaussians2(TwoSpectTemplate *output, const REAL8 offset, const REAL8 P, const REAL8 deltaf, const REAL8 Tsft, const REAL8 SFToverlap, const REAL8 Tobs, const UINT4 minTemplateLength, const UINT4 vectormathflag);
 INT4 makeTemplate(TwoSpectTemplate *output, const candidate intput, const UserInput_t *params, const REAL4FFTPlan *plan);
 INT4 makeTemplate2(TwoSpectTemplate *output, const REAL8 offset, const REAL8 P, const REAL8 deltaf, const REAL8 Tsft, const REAL8 SFToverlap, const REAL8 Tobs, const UINT4 minTemplateLength, const UINT4 vectormathflag, const REAL4FFTPlan *plan);
+INT4 makeTemplateBatch2(TwoSpectTemplateVector *output, const REAL8Vector *offsets, const REAL8Vector *periods, const REAL8Vector *moddepths, const UINT4 minTemplateLength, const UINT4 vectormathflag, const BOOLEAN exactflag, const REAL4FFTPlan *plan);
 void insertionSort_template(TwoSpectTemplate *output, const REAL4 weight, const INT4 pixelloc);
 
 REAL8 sincxoverxsqminusone(const REAL8 x);
 REAL8 sqsincxoverxsqminusone(const REAL8 x);
+INT4 sqsincxoverxsqminusoneVector(REAL4 *output, const REAL4 *x, const UINT4 length);
 
 #endif
 
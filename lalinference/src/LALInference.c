@@ -34,6 +34,7 @@
 #include <lal/VectorOps.h>
 #include <lal/Date.h>
 #include <lal/XLALError.h>
+#include <lal/LogPrintf.h>
 #include <gsl/gsl_vector.h>
 #include <gsl/gsl_matrix.h>
 #include <gsl/gsl_eigen.h>
@@ -129,6 +130,7 @@ LALInferenceThreadState *LALInferenceInitThread(void) {
     thread->differentialPointsLength = 0;
     thread->differentialPointsSize = 1;
     thread->differentialPointsSkip = 1;
+    thread->differentialBuffer = NULL;
 
     return thread;
 }
@@ -145,6 +147,32 @@ LALInferenceThreadState **LALInferenceInitThreads(INT4 nthreads) {
     return threads;
 }
 
+/* Free the work buffers held by the threads, leaving the variables to their owners */
+void LALInferenceDestroyThreadBuffers(LALInferenceThreadState **threads, INT4 nthreads) {
+    INT4 t;
+
+    if (!threads) return;
+
+    for (t = 0; t < nthreads; t++) {
+        if (!threads[t]) continue;
+        LALInferenceDestroyVariablesLayout(threads[t]->paramLayout);
+        threads[t]->paramLayout = NULL;
+
+        /* The DE buffer may be shared with other threads, free it only once */
+        LALInferenceDEBuffer *buffer = threads[t]->differentialBuffer;
+        if (buffer) {
+            for (INT4 u = t; u < nthreads; u++)
+                if (threads[u] && threads[u]->differentialBuffer == buffer) {
+                    threads[u]->differentialBuffer = NULL;
+                    threads[u]->differentialPointsLength = 0;
+                }
+            LALInferenceDestroyDEBuffer(buffer);
+        }
+    }
+
+    return;
+}
+
 
 /* ============ Accessor functions for the Variable structure: ========== */
 
@@ -155,6 +183,7 @@ static INT4 checkREAL8FrequencySeries(REAL8FrequencySeries *series);
 static INT4 checkCOMPLEX16FrequencySeries(COMPLEX16FrequencySeries *series);
 static INT4 matrix_equal(gsl_matrix *a, gsl_matrix *b);
 static LALInferenceVariableItem *LALInferenceGetItemSlow(const LALInferenceVariables *vars,const char *name);
+static int LALInferenceCopyVariablesInPlace(LALInferenceVariables *origin, LALInferenceVariables *target);
 
 /* This replaces gsl_matrix_equal which is only available with gsl 1.15+ */
 /* Return 1 if matrices are equal, 0 otherwise */
@@ -571,18 +600,26 @@ void LALInferenceCopyVariables(LALInferenceVariables *origin, LALInferenceVariab
   /* Make sure the structure is initialised */
   if(!target) XLAL_ERROR_VOID(XLAL_EFAULT, "Unable to copy to uninitialised LALInferenceVariables structure.");
 
+  /* If the target already holds the same variables (e.g. the proposed
+     parameters of an MCMC step), just overwrite the values in place */
+  if(LALInferenceCopyVariablesInPlace(origin, target)) return;
+
   /* First clear the target */
   LALInferenceClearVariables(target);
 
   /* Now add the variables in reverse order, to preserve the
    * ordering */
   dims = LALInferenceGetVariableDimension( origin );
+  LALInferenceVariableItem **items = XLALCalloc(dims > 0 ? dims : 1, sizeof(*items));
+  if(!items) XLAL_ERROR_VOID(XLAL_ENOMEM, "Unable to allocate memory for item list.");
+  for ( i = 0, ptr = origin->head; i < dims && ptr; i++, ptr = ptr->next )
+    items[i] = ptr;
 
   /* then copy over elements of "origin" - due to how elements are added by
      LALInferenceAddVariable this has to be done in reverse order to preserve
      the ordering of "origin"  */
   for ( i = dims; i > 0; i-- ){
-    ptr = LALInferenceGetItemNr(origin, i);
+    ptr = items[i-1];
 
     if(!ptr)
     {
@@ -651,9 +688,93 @@ void LALInferenceCopyVariables(LALInferenceVariables *origin, LALInferenceVariab
     }
   }
 
+  XLALFree(items);
+
   return;
 }
 
+/* Copy the values of "origin" into "target" without re-allocating anything,
+   if both contain the same variables (names, types and sizes) in the same
+   order. Returns 1 if the values were copied, 0 if the structures differ
+   (in which case "target" is left untouched). */
+static int LALInferenceCopyVariablesInPlace(LALInferenceVariables *origin, LALInferenceVariables *target)
+{
+  LALInferenceVariableItem *ptr, *tptr;
+
+  if(origin->dimension != target->dimension) return 0;
+
+  /* First check that the structures agree */
+  for(ptr = origin->head, tptr = target->head; ptr && tptr; ptr = ptr->next, tptr = tptr->next)
+  {
+    if(ptr->type != tptr->type || strcmp(ptr->name, tptr->name)) return 0;
+    switch (ptr->type)
+    {
+      case LALINFERENCE_gslMatrix_t:
+      {
+        gsl_matrix *old=*(gsl_matrix **)ptr->value, *new=*(gsl_matrix **)tptr->value;
+        if(old->size1 != new->size1 || old->size2 != new->size2) return 0;
+        break;
+      }
+      case LALINFERENCE_INT4Vector_t:
+        if((*(INT4Vector **)ptr->value)->length != (*(INT4Vector **)tptr->value)->length) return 0;
+        break;
+      case LALINFERENCE_UINT4Vector_t:
+        if((*(UINT4Vector **)ptr->value)->length != (*(UINT4Vector **)tptr->value)->length) return 0;
+        break;
+      case LALINFERENCE_REAL8Vector_t:
+        if((*(REAL8Vector **)ptr->value)->length != (*(REAL8Vector **)tptr->value)->length) return 0;
+        break;
+      case LALINFERENCE_COMPLEX16Vector_t:
+        if((*(COMPLEX16Vector **)ptr->value)->length != (*(COMPLEX16Vector **)tptr->value)->length) return 0;
+        break;
+      default:
+        break;
+    }
+  }
+  if(ptr || tptr) return 0;
+
+  /* Then copy the values, deep-copying matrix and vector contents */
+  for(ptr = origin->head, tptr = target->head; ptr; ptr = ptr->next, tptr = tptr->next)
+  {
+    tptr->vary = ptr->vary;
+    switch (ptr->type)
+    {
+      case LALINFERENCE_gslMatrix_t:
+        gsl_matrix_memcpy(*(gsl_matrix **)tptr->value, *(gsl_matrix **)ptr->value);
+        break;
+      case LALINFERENCE_INT4Vector_t:
+      {
+        INT4Vector *old=*(INT4Vector **)ptr->value, *new=*(INT4Vector **)tptr->value;
+        memcpy(new->data, old->data, new->length*sizeof(new->data[0]));
+        break;
+      }
+      case LALINFERENCE_UINT4Vector_t:
+      {
+        UINT4Vector *old=*(UINT4Vector **)ptr->value, *new=*(UINT4Vector **)tptr->value;
+        memcpy(new->data, old->data, new->length*sizeof(new->data[0]));
+        break;
+      }
+      case LALINFERENCE_REAL8Vector_t:
+      {
+        REAL8Vector *old=*(REAL8Vector **)ptr->value, *new=*(REAL8Vector **)tptr->value;
+        memcpy(new->data, old->data, new->length*sizeof(new->data[0]));
+        break;
+      }
+      case LALINFERENCE_COMPLEX16Vector_t:
+      {
+        COMPLEX16Vector *old=*(COMPLEX16Vector **)ptr->value, *new=*(COMPLEX16Vector **)tptr->value;
+        memcpy(new->data, old->data, new->length*sizeof(new->data[0]));
+        break;
+      }
+      default:
+        memcpy(tptr->value, ptr->value, LALInferenceTypeSize[ptr->type]);
+        break;
+    }
+  }
+
+  return 1;
+}
+
 
 void LALInferenceCopyUnsetREAL8Variables(LALInferenceVariables *origin, LALInferenceVariables *target, ProcessParamsTable *commandLine) {
 /*  Copy REAL8s from "origin" to "target" if they weren't set on the command line */
@@ -1593,6 +1714,16 @@ INT4 LALInferenceThinnedBufferToArray(LALInferenceThreadState *thread, REAL8** D
     INT4 i=0, p=0;
 
     INT4 nPoints = thread->differentialPointsLength;
+
+    if (thread->differentialBuffer) {
+        const LALInferenceDEBuffer *buffer = thread->differentialBuffer;
+        const size_t ncol = buffer->layout->length;
+        nPoints = buffer->length;
+        for (i = 0; i < nPoints; i+=step)
+            memcpy(DEarray[i/step], buffer->data + i*ncol, ncol*sizeof(REAL8));
+        return nPoints/step;
+    }
+
     for (i = 0; i < nPoints; i+=step) {
         ptr=thread->differentialPoints[i]->head;
         p=0;
@@ -1755,6 +1886,220 @@ void LALInferenceCopyArrayToVariables(REAL8 *origin, LALInferenceVariables *targ
   return;
 }
 
+
+/* Varying REAL8 parameters are the ones that have a slot in a LALInferenceVariablesLayout */
+static int isLayoutItem(const LALInferenceVariableItem *item)
+{
+  return item->type==LALINFERENCE_REAL8_t && (item->vary==LALINFERENCE_PARAM_LINEAR || item->vary==LALINFERENCE_PARAM_CIRCULAR);
+}
+
+LALInferenceVariablesLayout *LALInferenceCreateVariablesLayout(const LALInferenceVariables *vars)
+{
+  LALInferenceVariableItem *ptr;
+  UINT4 n=0, k=0;
+
+  if(!vars) XLAL_ERROR_NULL(XLAL_EFAULT, "Unable to access vars pointer.");
+
+  for(ptr=vars->head; ptr; ptr=ptr->next)
+    if(isLayoutItem(ptr)) n++;
+
+  LALInferenceVariablesLayout *layout = XLALCalloc(1, sizeof(*layout));
+  if(!layout) XLAL_ERROR_NULL(XLAL_ENOMEM, "Unable to allocate memory for layout.");
+  layout->length = n;
+  layout->names = XLALCalloc(n > 0 ? n : 1, sizeof(char *));
+  layout->vary = XLALCalloc(n > 0 ? n : 1, sizeof(LALInferenceParamVaryType));
+  char *namebuf = XLALCalloc(n > 0 ? n : 1, VARNAME_MAX);
+  if(!layout->names || !layout->vary || !namebuf)
+  {
+    XLALFree(namebuf);
+    LALInferenceDestroyVariablesLayout(layout);
+    XLAL_ERROR_NULL(XLAL_ENOMEM, "Unable to allocate memory for layout.");
+  }
+
+  for(ptr=vars->head; ptr; ptr=ptr->next)
+  {
+    if(!isLayoutItem(ptr)) continue;
+    layout->names[k] = namebuf + k*VARNAME_MAX;
+    snprintf(layout->names[k], VARNAME_MAX, "%s", ptr->name);
+    layout->vary[k] = ptr->vary;
+    k++;
+  }
+  if(n==0) XLALFree(namebuf);
+
+  return layout;
+}
+
+void LALInferenceDestroyVariablesLayout(LALInferenceVariablesLayout *layout)
+{
+  if(!layout) return;
+  if(layout->names)
+  {
+    /* all names live in one block, starting at the first one */
+    if(layout->length > 0) XLALFree(layout->names[0]);
+    XLALFree(layout->names);
+  }
+  XLALFree(layout->vary);
+  XLALFree(layout);
+  return;
+}
+
+INT4 LALInferenceVariablesLayoutIndex(const LALInferenceVariablesLayout *layout, const char *name)
+{
+  UINT4 k;
+  if(!layout) XLAL_ERROR(XLAL_EFAULT, "Unable to access layout pointer.");
+  for(k=0; k<layout->length; k++)
+    if(!strcmp(layout->names[k], name)) return k;
+  return -1;
+}
+
+int LALInferenceVariablesLayoutMatches(const LALInferenceVariablesLayout *layout, const LALInferenceVariables *vars)
+{
+  LALInferenceVariableItem *ptr;
+  UINT4 k=0;
+  if(!layout || !vars) return 0;
+  for(ptr=vars->head; ptr; ptr=ptr->next)
+  {
+    if(!isLayoutItem(ptr)) continue;
+    if(k >= layout->length || strcmp(layout->names[k], ptr->name)) return 0;
+    k++;
+  }
+  return k==layout->length;
+}
+
+int LALInferenceCopyVariablesToLayoutArray(const LALInferenceVariablesLayout *layout, const LALInferenceVariables *origin, REAL8 *target)
+{
+  LALInferenceVariableItem *ptr;
+  UINT4 k=0;
+
+  if(!layout || !origin || !target) XLAL_ERROR(XLAL_EFAULT, "Unable to access layout, origin or target pointer.");
+
+  /* Fast path: the variables are stored in the order of the layout */
+  for(ptr=origin->head; ptr; ptr=ptr->next)
+  {
+    if(!isLayoutItem(ptr)) continue;
+    if(k >= layout->length || strcmp(layout->names[k], ptr->name)) break;
+    target[k++] = *(REAL8 *)ptr->value;
+  }
+  if(ptr==NULL && k==layout->length) return XLAL_SUCCESS;
+
+  /* Otherwise look up every parameter by name */
+  for(k=0; k<layout->length; k++)
+  {
+    ptr = LALInferenceGetItem(origin, layout->names[k]);
+    if(!ptr || ptr->type!=LALINFERENCE_REAL8_t) XLAL_ERROR(XLAL_EFAILED, "REAL8 entry \"%s\" not found.", layout->names[k]);
+    target[k] = *(REAL8 *)ptr->value;
+  }
+
+  return XLAL_SUCCESS;
+}
+
+int LALInferenceCopyLayoutArrayToVariables(const LALInferenceVariablesLayout *layout, const REAL8 *origin, LALInferenceVariables *target)
+{
+  LALInferenceVariableItem *ptr;
+  UINT4 k=0;
+
+  if(!layout || !origin || !target) XLAL_ERROR(XLAL_EFAULT, "Unable to access layout, origin or target pointer.");
+
+  /* Fast path: the variables are stored in the order of the layout */
+  if(LALInferenceVariablesLayoutMatches(layout, target))
+  {
+    for(ptr=target->head; ptr; ptr=ptr->next)
+      if(isLayoutItem(ptr)) *(REAL8 *)ptr->value = origin[k++];
+    return XLAL_SUCCESS;
+  }
+
+  /* Otherwise look up every parameter by name, respecting fixed parameters as LALInferenceSetVariable() does */
+  for(k=0; k<layout->length; k++)
+  {
+    ptr = LALInferenceGetItem(target, layout->names[k]);
+    if(!ptr || ptr->type!=LALINFERENCE_REAL8_t) XLAL_ERROR(XLAL_EFAILED, "REAL8 entry \"%s\" not found.", layout->names[k]);
+    if(ptr->vary==LALINFERENCE_PARAM_FIXED)
+    {
+      XLALPrintWarning("Warning! Attempting to set variable %s which is fixed\n",ptr->name);
+      continue;
+    }
+    *(REAL8 *)ptr->value = origin[k];
+  }
+
+  return XLAL_SUCCESS;
+}
+
+LALInferenceDEBuffer *LALInferenceCreateDEBuffer(const LALInferenceVariables *params, size_t size)
+{
+  if(!params) XLAL_ERROR_NULL(XLAL_EFAULT, "Unable to access params pointer.");
+  if(size < 1) size = 1;
+
+  LALInferenceDEBuffer *buffer = XLALCalloc(1, sizeof(*buffer));
+  if(!buffer) XLAL_ERROR_NULL(XLAL_ENOMEM, "Unable to allocate memory for DE buffer.");
+  buffer->layout = LALInferenceCreateVariablesLayout(params);
+  if(!buffer->layout)
+  {
+    XLALFree(buffer);
+    XLAL_ERROR_NULL(XLAL_EFUNC);
+  }
+  buffer->data = XLALCalloc(size*(buffer->layout->length > 0 ? buffer->layout->length : 1), sizeof(REAL8));
+  if(!buffer->data)
+  {
+    LALInferenceDestroyDEBuffer(buffer);
+    XLAL_ERROR_NULL(XLAL_ENOMEM, "Unable to allocate memory for %zu DE points.", size);
+  }
+  buffer->size = size;
+  buffer->length = 0;
+
+  return buffer;
+}
+
+void LALInferenceDestroyDEBuffer(LALInferenceDEBuffer *buffer)
+{
+  if(!buffer) return;
+  LALInferenceDestroyVariablesLayout(buffer->layout);
+  XLALFree(buffer->data);
+  XLALFree(buffer);
+  return;
+}
+
+int LALInferenceDEBufferAppend(LALInferenceDEBuffer *buffer, const LALInferenceVariables *params)
+{
+  if(!buffer || !params) XLAL_ERROR(XLAL_EFAULT, "Unable to access buffer or params pointer.");
+  const size_t ncol = buffer->layout->length;
+
+  if(buffer->length == buffer->size)
+  {
+    size_t newSize = 2*buffer->size;
+    REAL8 *data = XLALRealloc(buffer->data, newSize*(ncol > 0 ? ncol : 1)*sizeof(REAL8));
+    if(!data) XLAL_ERROR(XLAL_ENOMEM, "Unable to grow DE buffer to %zu points.", newSize);
+    buffer->data = data;
+    buffer->size = newSize;
+  }
+
+  if(LALInferenceCopyVariablesToLayoutArray(buffer->layout, params, buffer->data + buffer->length*ncol) != XLAL_SUCCESS)
+    XLAL_ERROR(XLAL_EFUNC);
+  buffer->length++;
+
+  return XLAL_SUCCESS;
+}
+
+int LALInferenceDEBufferThin(LALInferenceDEBuffer *buffer)
+{
+  size_t i;
+  if(!buffer) XLAL_ERROR(XLAL_EFAULT, "Unable to access buffer pointer.");
+  const size_t ncol = buffer->layout->length;
+
+  /* Row i/2 is never after row i, so the odd rows can be moved down in order */
+  for(i=1; i<buffer->length; i+=2)
+    memmove(buffer->data + (i/2)*ncol, buffer->data + i*ncol, ncol*sizeof(REAL8));
+  buffer->length /= 2;
+
+  return XLAL_SUCCESS;
+}
+
+void LALInferenceDEBufferReset(LALInferenceDEBuffer *buffer)
+{
+  if(!buffer) XLAL_ERROR_VOID(XLAL_EFAULT, "Unable to access buffer pointer.");
+  buffer->length = 0;
+  return;
+}
+
 /* ============ Command line parsing functions etc.: ========== */
 
 
@@ -2050,6 +2395,33 @@ void LALInferenceExecuteInvFT(LALInferenceModel *model)
   XLALREAL8FreqTimeFFT(model->timehCross, model->freqhCross, model->freqToTimeFFTPlan);
 }
 
+REAL8 LALInferenceStageTimerStart(const LALInferenceModel *model)
+{
+  if(!model || !model->stageTimer) return 0.0;
+  return XLALGetTimeOfDay();
+}
+
+void LALInferenceStageTimerStop(LALInferenceModel *model, LALInferenceStage stage, REAL8 start)
+{
+  if(!model || !model->stageTimer || stage>=LALINFERENCE_NUM_STAGES) return;
+  model->stageTimer->seconds[stage] += XLALGetTimeOfDay() - start;
+  model->stageTimer->calls[stage]++;
+}
+
+void LALInferenceStageTimerReset(LALInferenceStageTimer *timer)
+{
+  if(timer) memset(timer, 0, sizeof(*timer));
+}
+
+const char *LALInferenceStageName(LALInferenceStage stage)
+{
+  static const char *names[LALINFERENCE_NUM_STAGES] = {
+    "waveform", "fft", "calibration", "projection", "timeshift", "inner_product", "marginalisation", "prior"
+  };
+  if(stage>=LALINFERENCE_NUM_STAGES) return "unknown";
+  return names[stage];
+}
+
 void LALInferenceProcessParamLine(FILE *inp, char **headers, LALInferenceVariables *vars) {
   size_t i;
 
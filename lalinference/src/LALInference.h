@@ -176,6 +176,38 @@ tagLALInferenceVariables
   LALHashTbl        *hash_table;
 } LALInferenceVariables;
 
+/**
+ * A compiled layout of the varying REAL8 parameters of a LALInferenceVariables
+ * structure, mapping each parameter name to a fixed slot of a contiguous REAL8 array.
+ * It is built once (e.g. from the current parameters of a chain) with
+ * LALInferenceCreateVariablesLayout(); the index returned by
+ * LALInferenceVariablesLayoutIndex() can then be used as an O(1) handle to
+ * the parameter in arrays filled by LALInferenceCopyVariablesToLayoutArray().
+ */
+typedef struct
+tagLALInferenceVariablesLayout
+{
+  UINT4                       length; /** Number of slots */
+  char                        **names; /** Name of the parameter in each slot */
+  LALInferenceParamVaryType   *vary; /** Vary type of the parameter in each slot */
+} LALInferenceVariablesLayout;
+
+/**
+ * Differential evolution history, held as a contiguous points x parameters matrix.
+ * Row \c i holds the varying REAL8 parameters of the \c i th stored point in the order
+ * given by \c layout, so that drawing points and taking differences between them are
+ * plain array operations. Jump proposals only read the buffer, so one buffer may be
+ * shared between several threads.
+ */
+typedef struct
+tagLALInferenceDEBuffer
+{
+  LALInferenceVariablesLayout *layout; /** Parameter stored in each column */
+  REAL8                       *data; /** Row-major array of size rows of layout->length values */
+  size_t                      length; /** Number of points stored */
+  size_t                      size; /** Number of rows allocated (must be >= length) */
+} LALInferenceDEBuffer;
+
 /**
  * Phase of MCMC run (depending on burn-in status, different actions
  * are performed during the run, and this tag controls the activity).
@@ -435,6 +467,33 @@ tagLALInferenceIFOModel
   struct tagLALInferenceIFOModel *next; /** A pointer to the next set of parameters for linked list */
 } LALInferenceIFOModel;
 
+/**
+ * Named stages of a template and likelihood evaluation, for profiling with
+ * a LALInferenceStageTimer.
+ */
+typedef enum {
+  LALINFERENCE_STAGE_WAVEFORM,      /** Call to the template function */
+  LALINFERENCE_STAGE_FFT,           /** Fourier transform of a time-domain template */
+  LALINFERENCE_STAGE_CALIBRATION,   /** Calibration error model */
+  LALINFERENCE_STAGE_PROJECTION,    /** Antenna response and time delay of each detector */
+  LALINFERENCE_STAGE_TIMESHIFT,     /** Frequency-domain time-shift phase factors */
+  LALINFERENCE_STAGE_INNER_PRODUCT, /** Sum over frequency bins (or ROQ/multiband nodes) */
+  LALINFERENCE_STAGE_MARGINALISATION, /** Time, phase and distance marginalisation and SNR output */
+  LALINFERENCE_STAGE_PRIOR,         /** Prior function */
+  LALINFERENCE_NUM_STAGES
+} LALInferenceStage;
+
+/**
+ * Accumulated wall-clock time and number of calls of each LALInferenceStage.
+ * Attach one to LALInferenceModel::stageTimer to enable profiling; with no timer
+ * attached the instrumented code does not read the clock.
+ */
+typedef struct tagLALInferenceStageTimer
+{
+  REAL8 seconds[LALINFERENCE_NUM_STAGES]; /** Total time spent in each stage */
+  UINT8 calls[LALINFERENCE_NUM_STAGES];   /** Number of times each stage was run */
+} LALInferenceStageTimer;
+
 /**
  * Structure to constain a model and its parameters.
  */
@@ -468,7 +527,11 @@ typedef struct tagLALInferenceModel
   REAL8                        padding; /** The padding of the above window */
   struct tagLALInferenceROQModel *roq; /** ROQ data */
   int roq_flag;               /** Is ROQ enabled */
+  struct tagLALInferenceMultibandModel *multiband; /** Multibanded likelihood frequency nodes and template */
+  int multiband_flag;         /** Is the multibanded likelihood enabled */
   LALSimNeutronStarFamily     *eos_fam; /** Neutron Star equation of state family */
+  struct tagLALInferenceExtrinsicCache *extrinsicCache; /** Detector responses and phase ramps memoised by the likelihood */
+  LALInferenceStageTimer      *stageTimer; /** Per-stage timing of template and likelihood calls, or NULL */
 
 } LALInferenceModel;
 
@@ -585,6 +648,10 @@ tagLALInferenceThreadState
     INT4 *temp_swap_accepts;
     INT4 temp_swap_window;
     INT4 temp_swap_counter;
+    LALInferenceVariablesLayout *paramLayout; /** Layout of the varying REAL8 parameters, used by vectorised proposals */
+    LALInferenceDEBuffer *differentialBuffer; /** Differential evolution points as a matrix.  If set, this is
+                                                  used in place of differentialPoints, and
+                                                  differentialPointsLength is kept equal to its length */
 } LALInferenceThreadState;
 
 
@@ -639,8 +706,8 @@ tagLALInferenceIFOData
      that value is copied into acceptedloglikelihood, which is the
      quantity that is actually output in the output files. */
   REAL8                      nullloglikelihood;
-  REAL8                      fPlus, fCross; /** Detector responses */
-  REAL8                      timeshift;     /** What is this? */
+  REAL8                      fPlus, fCross; /** Detector responses (deprecated: only set when injecting, not by the likelihood functions) */
+  REAL8                      timeshift;     /** Time shift of the injection (deprecated: only set when injecting, not by the likelihood functions) */
   COMPLEX16FrequencySeries  *freqData,      /** Buffer for frequency domain data */
                             *whiteFreqData; /* Over-white. */
   COMPLEX16TimeSeries       *compTimeData;  /** Complex time series data buffers */
@@ -661,6 +728,8 @@ tagLALInferenceIFOData
   UINT4                     likeli_counter; /** counts how many time the likelihood has been calculated */
   UINT4                     templa_counter; /** counts how many time the template has been calculated */
   struct tagLALInferenceROQData *roq; /** ROQ data */
+  struct tagLALInferenceMultibandData *multiband; /** Multibanded likelihood weights */
+  REAL8FrequencySeries      *noiseWeights; /** Per-bin noise weights 2/(N deltaT S(f)) over fLow..fHigh, only set while LALInferenceBatchedLogLikelihood() runs */
 
   struct tagLALInferenceIFOData      *next;     /** A pointer to the next set of data for linked list */
 } LALInferenceIFOData;
@@ -736,6 +805,30 @@ tagLALInferenceROQModel
 
 } LALInferenceROQModel;
 
+/**
+ * Structure to contain the data-dependent weights of the multibanded likelihood
+ * at the frequency nodes of the corresponding LALInferenceMultibandModel
+ */
+typedef struct
+tagLALInferenceMultibandData
+{
+  UINT4 nnodes;               /** Number of frequency nodes */
+  COMPLEX16 *weightsLinear;   /** weights for <d|h> */
+  REAL8 *weightsQuadratic;    /** weights for <h|h> */
+} LALInferenceMultibandData;
+
+/**
+ * Structure to contain the model-related quantities of the multibanded likelihood
+ */
+typedef struct
+tagLALInferenceMultibandModel
+{
+  REAL8Sequence *frequencies;         /** frequency nodes at which the template is evaluated */
+  COMPLEX16FrequencySeries *hptilde;  /** plus polarisation at the frequency nodes */
+  COMPLEX16FrequencySeries *hctilde;  /** cross polarisation at the frequency nodes */
+  COMPLEX16Sequence *calFactor;       /** calibration factors at the frequency nodes */
+} LALInferenceMultibandModel;
+
 /**
  * Structure to contain data-related Reduced Order Quadrature quantities
  */
@@ -745,6 +838,13 @@ LALInferenceThreadState *LALInferenceInitThread(void);
 /* Initialize a bunch of threads using LALInferenceInitThread */
 LALInferenceThreadState **LALInferenceInitThreads(INT4 nthreads);
 
+/**
+ * Free the work buffers held by \c nthreads threads (e.g. the parameter layout used by
+ * vectorised proposals, and the differential evolution buffer, which may be shared between
+ * threads). The variables and the model of each thread are not touched.
+ */
+void LALInferenceDestroyThreadBuffers(LALInferenceThreadState **threads, INT4 nthreads);
+
 /** Returns the element of the process params table with "name" */
 ProcessParamsTable *LALInferenceGetProcParamVal(ProcessParamsTable *procparams,const char *name);
 
@@ -775,6 +875,15 @@ void LALInferenceExecuteFT(LALInferenceModel *model);
 /** Execute Inverse FFT for data in \c IFOdata */
 void LALInferenceExecuteInvFT(LALInferenceModel *model);
 
+/** Return the start time of a profiled stage, or 0 if \c model has no stage timer */
+REAL8 LALInferenceStageTimerStart(const LALInferenceModel *model);
+/** Add the time since \c start to \c stage of the stage timer of \c model, if it has one */
+void LALInferenceStageTimerStop(LALInferenceModel *model, LALInferenceStage stage, REAL8 start);
+/** Zero all the counters of a stage timer */
+void LALInferenceStageTimerReset(LALInferenceStageTimer *timer);
+/** Return a short lower-case name for \c stage */
+const char *LALInferenceStageName(LALInferenceStage stage);
+
 /** Return the list node for "name" - do not rely on this */
 LALInferenceVariableItem *LALInferenceGetItem(const LALInferenceVariables *vars,const char *name);
 
@@ -849,6 +958,52 @@ void LALInferenceCopyVariablesToArray(LALInferenceVariables *origin, REAL8 *targ
 
 void LALInferenceCopyArrayToVariables(REAL8 *origin, LALInferenceVariables *target);
 
+/**
+ * Create the layout of the varying (LINEAR or CIRCULAR) REAL8 parameters in \c vars,
+ * in the order in which they are stored in \c vars
+ */
+LALInferenceVariablesLayout *LALInferenceCreateVariablesLayout(const LALInferenceVariables *vars);
+
+/** Free a layout created with LALInferenceCreateVariablesLayout() */
+void LALInferenceDestroyVariablesLayout(LALInferenceVariablesLayout *layout);
+
+/** Return the slot of parameter \c name in \c layout, or -1 if it is not part of the layout */
+INT4 LALInferenceVariablesLayoutIndex(const LALInferenceVariablesLayout *layout, const char *name);
+
+/**
+ * Check whether \c layout describes exactly the varying REAL8 parameters of \c vars,
+ * in the same order. Returns 1(==true) or 0
+ */
+int LALInferenceVariablesLayoutMatches(const LALInferenceVariablesLayout *layout, const LALInferenceVariables *vars);
+
+/**
+ * Copy the parameters in \c layout from \c origin into the array \c target of length layout->length.
+ * This is a single walk over \c origin if it matches the layout, otherwise every
+ * parameter is looked up by name. Returns XLAL_SUCCESS, or XLAL_FAILURE if a parameter is missing.
+ */
+int LALInferenceCopyVariablesToLayoutArray(const LALInferenceVariablesLayout *layout, const LALInferenceVariables *origin, REAL8 *target);
+
+/** Copy the array \c origin back into the parameters of \c target, as for LALInferenceCopyVariablesToLayoutArray() */
+int LALInferenceCopyLayoutArrayToVariables(const LALInferenceVariablesLayout *layout, const REAL8 *origin, LALInferenceVariables *target);
+
+/** Create an empty differential evolution buffer for the varying REAL8 parameters of \c params, with room for \c size points */
+LALInferenceDEBuffer *LALInferenceCreateDEBuffer(const LALInferenceVariables *params, size_t size);
+
+/** Free a buffer created with LALInferenceCreateDEBuffer() */
+void LALInferenceDestroyDEBuffer(LALInferenceDEBuffer *buffer);
+
+/** Append the point \c params to \c buffer, doubling its size if it is full */
+int LALInferenceDEBufferAppend(LALInferenceDEBuffer *buffer, const LALInferenceVariables *params);
+
+/**
+ * Discard every other point of \c buffer (those with even index), keeping the rest in order.
+ * The points are moved within the existing memory block, which is not reallocated.
+ */
+int LALInferenceDEBufferThin(LALInferenceDEBuffer *buffer);
+
+/** Remove all the points from \c buffer, keeping its memory */
+void LALInferenceDEBufferReset(LALInferenceDEBuffer *buffer);
+
 /**
  * Append the sample to a file. file pointer is stored in state->algorithmParams as a
  * LALInferenceVariable called "outfile", as a void ptr.
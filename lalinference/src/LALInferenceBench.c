@@ -21,12 +21,17 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <lal/LALInference.h>
 #include <lal/LALInferenceInit.h>
 #include <lal/LALInferenceReadData.h>
+#include <lal/LALInferenceReadBurstData.h>
 #include <lal/LALInferenceCalibrationErrors.h>
 #include <lal/LALInferenceLikelihood.h>
+#include <lal/LALInferencePrior.h>
 #include <lal/LALInferenceTemplate.h>
+#include <lal/LALInferenceBurstRoutines.h>
+#include <lal/LogPrintf.h>
 #include <sys/resource.h>
 
 #ifdef __GNUC__
@@ -36,27 +41,165 @@
 #endif
 
 const char HELPSTR[]=\
-"lalinference_bench: Benchmark template and likelihood functions.\n\
+"lalinference_bench: Benchmark template, likelihood and prior functions.\n\
  Options:\n\
     --Niter            : Number of calls to time (delfault 1000) \n\
     --bench-template   : Only benchmark template function\n\
     --bench-likelihood : Only benchmark likelihood function\n\
-                         (defaults to benchmarking both)\n\
+    --bench-prior      : Only benchmark prior function\n\
+                         (defaults to benchmarking all three)\n\
+    --bench-approximants [A,B,...] : Repeat the benchmarks for each of these CBC approximants\n\
+                         (defaults to the approximant given by --approx)\n\
+    --bench-likelihoods [L1,L2,...] : Likelihood variants to benchmark, from\n\
+                         default (the likelihood chosen by the command line, e.g. with --margdist\n\
+                         or ROQ), gaussian, margphi, margtime, margtimephi (defaults to default)\n\
+    --bench-fixed-template : Time the likelihood with the template held fixed,\n\
+                         excluding waveform generation (not with ROQ or multibanding)\n\
+    --bench-json FILE  : Write the results to FILE in JSON format\n\
+    --bench-label LABEL : Label recorded in the JSON results, e.g. to identify a build\n\
+    --burst            : Benchmark a burst model (the approximant is given by --approx)\n\
+ Each benchmark reports the total user, system and wall-clock time, and the\n\
+ wall-clock time spent in each stage of the template and likelihood evaluation.\n\
  Example (for 1.0-1.0 binary with seglen 8, srate 4096): \n\
- $ ./lalinference_bench --psdlength 1000 --psdstart 1 --seglen 8 --srate 4096 --trigtime 0 --ifo H1 --H1-channel LALSimAdLIGO --H1-cache LALSimAdLIGO --dataseed 1324 --Niter 10000 --fix-chirpmass 1.218 --fix-q 1.0\n\n\n\
+ $ ./lalinference_bench --psdlength 1000 --psdstart 1 --seglen 8 --srate 4096 --trigtime 0 --ifo H1 --H1-channel LALSimAdLIGO --H1-cache LALSimAdLIGO --dataseed 1324 --Niter 10000 --fix-chirpmass 1.218 --fix-q 1.0 --bench-approximants [TaylorF2,IMRPhenomPv2,SEOBNRv4_ROM] --bench-likelihoods [default,margphi,margtime] --bench-json bench.json\n\n\n\
 ";
 
-void fprintf_bench(FILE *fp, struct rusage start, struct rusage end, UINT4 Niter);
-void fprintf_bench(FILE *fp, struct rusage start, struct rusage end, UINT4 Niter)
+/* Timing of one benchmark: resource usage and wall-clock time over Niter calls */
+typedef struct tagBenchTiming
 {
-  REAL8 utime = (end.ru_utime.tv_sec - start.ru_utime.tv_sec) + 1e-6 * (end.ru_utime.tv_usec - start.ru_utime.tv_usec);
-  REAL8 stime = (end.ru_stime.tv_sec - start.ru_stime.tv_sec) + 1e-6 * (end.ru_stime.tv_usec - start.ru_stime.tv_usec);
+  struct rusage start, end;
+  REAL8 wallStart, wallEnd;
+  UINT4 Niter;
+} BenchTiming;
+
+/* Where the results are written, and the configuration they are recorded with */
+typedef struct tagBenchOutput
+{
+  FILE *json;
+  UINT4 nresults;
+  const char *approximant;
+  const char *domain;
+} BenchOutput;
+
+static void bench_start(BenchTiming *timing, UINT4 Niter, LALInferenceModel *model, LALInferenceStageTimer *timer);
+static void bench_start(BenchTiming *timing, UINT4 Niter, LALInferenceModel *model, LALInferenceStageTimer *timer)
+{
+  LALInferenceStageTimerReset(timer);
+  model->stageTimer = timer;
+  timing->Niter = Niter;
+  getrusage(RUSAGE_SELF, &(timing->start));
+  timing->wallStart = XLALGetTimeOfDay();
+}
+
+static void bench_stop(BenchTiming *timing, LALInferenceModel *model);
+static void bench_stop(BenchTiming *timing, LALInferenceModel *model)
+{
+  timing->wallEnd = XLALGetTimeOfDay();
+  getrusage(RUSAGE_SELF, &(timing->end));
+  model->stageTimer = NULL;
+}
+
+static REAL8 rusage_diff(struct timeval start, struct timeval end);
+static REAL8 rusage_diff(struct timeval start, struct timeval end)
+{
+  return (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
+}
+
+void fprintf_bench(FILE *fp, const BenchTiming *timing);
+void fprintf_bench(FILE *fp, const BenchTiming *timing)
+{
+  REAL8 utime = rusage_diff(timing->start.ru_utime, timing->end.ru_utime);
+  REAL8 stime = rusage_diff(timing->start.ru_stime, timing->end.ru_stime);
+  REAL8 wtime = timing->wallEnd - timing->wallStart;
   
   fprintf(fp,"USER Total: %lf s\n",utime);
-  fprintf(fp,"USER Per iteration: %e s\n",utime / (double) Niter);
+  fprintf(fp,"USER Per iteration: %e s\n",utime / (double) timing->Niter);
   
   fprintf(fp,"SYS Total: %lf s\n",stime);
-  fprintf(fp,"SYS Per iteration: %e s\n",stime / (double) Niter);
+  fprintf(fp,"SYS Per iteration: %e s\n",stime / (double) timing->Niter);
+
+  fprintf(fp,"WALL Total: %lf s\n",wtime);
+  fprintf(fp,"WALL Per iteration: %e s\n",wtime / (double) timing->Niter);
+}
+
+void fprintf_stages(FILE *fp, const LALInferenceStageTimer *timer, const BenchTiming *timing);
+void fprintf_stages(FILE *fp, const LALInferenceStageTimer *timer, const BenchTiming *timing)
+{
+  REAL8 wtime = timing->wallEnd - timing->wallStart;
+  fprintf(fp,"%-16s %12s %14s %14s %8s\n","Stage","Calls","Total (s)","Per iter (s)","Frac");
+  for(UINT4 i=0;i<LALINFERENCE_NUM_STAGES;i++)
+  {
+    if(!timer->calls[i]) continue;
+    fprintf(fp,"%-16s %12llu %14.6f %14.6e %7.1f%%\n",LALInferenceStageName(i),(unsigned long long)timer->calls[i],
+            timer->seconds[i],timer->seconds[i]/(double)timing->Niter,wtime>0?100.0*timer->seconds[i]/wtime:0.0);
+  }
+}
+
+void fprintf_extrinsic_cache(FILE *fp, LALInferenceExtrinsicCache *cache);
+void fprintf_extrinsic_cache(FILE *fp, LALInferenceExtrinsicCache *cache)
+{
+  if(!cache) return;
+  if(cache->responseCalls)
+    fprintf(fp,"Detector response cache: %llu/%llu hits (%.1f%%)\n",(unsigned long long)cache->responseHits,
+            (unsigned long long)cache->responseCalls,100.0*cache->responseHits/(double)cache->responseCalls);
+  if(cache->rampCalls)
+    fprintf(fp,"Phase ramp cache: %llu/%llu hits (%.1f%%)\n",(unsigned long long)cache->rampHits,
+            (unsigned long long)cache->rampCalls,100.0*cache->rampHits/(double)cache->rampCalls);
+}
+
+/* Write s as a JSON string, escaping quotes, backslashes and control characters */
+static void json_string(FILE *fp, const char *s);
+static void json_string(FILE *fp, const char *s)
+{
+  fputc('"',fp);
+  for(;*s;s++)
+  {
+    unsigned char c=(unsigned char)*s;
+    if(c=='"' || c=='\\') fprintf(fp,"\\%c",c);
+    else if(c=='\n') fputs("\\n",fp);
+    else if(c=='\t') fputs("\\t",fp);
+    else if(c<0x20) fprintf(fp,"\\u%04x",c);
+    else fputc(c,fp);
+  }
+  fputc('"',fp);
+}
+
+/* Append one benchmark to the "results" array of the JSON output */
+void json_result(BenchOutput *out, const char *benchmark, const char *variant,
+                 const BenchTiming *timing, const LALInferenceStageTimer *timer);
+void json_result(BenchOutput *out, const char *benchmark, const char *variant,
+                 const BenchTiming *timing, const LALInferenceStageTimer *timer)
+{
+  FILE *fp = out->json;
+  if(!fp) return;
+  REAL8 utime = rusage_diff(timing->start.ru_utime, timing->end.ru_utime);
+  REAL8 stime = rusage_diff(timing->start.ru_stime, timing->end.ru_stime);
+  REAL8 wtime = timing->wallEnd - timing->wallStart;
+  UINT4 first = 1;
+
+  fprintf(fp,"%s\n    {\"benchmark\": \"%s\", \"approximant\": ",out->nresults ? "," : "",benchmark);
+  json_string(fp,out->approximant);
+  fprintf(fp,", \"domain\": \"%s\", ",out->domain);
+  if(variant)
+  {
+    fprintf(fp,"\"likelihood\": ");
+    json_string(fp,variant);
+    fprintf(fp,", ");
+  }
+  fprintf(fp,"\"niter\": %u,\n",timing->Niter);
+  fprintf(fp,"     \"user\": %.9e, \"sys\": %.9e, \"wall\": %.9e, \"wall_per_iter\": %.9e,\n",
+          utime, stime, wtime, wtime/(double)timing->Niter);
+  fprintf(fp,"     \"stages\": {");
+  for(UINT4 i=0;i<LALINFERENCE_NUM_STAGES;i++)
+  {
+    if(!timer->calls[i]) continue;
+    fprintf(fp,"%s\n       \"%s\": {\"calls\": %llu, \"seconds\": %.9e, \"per_iter\": %.9e}",first?"":",",
+            LALInferenceStageName(i),(unsigned long long)timer->calls[i],timer->seconds[i],
+            timer->seconds[i]/(double)timing->Niter);
+    first = 0;
+  }
+  fprintf(fp,"%s}}",first?"":"\n     ");
+  out->nresults++;
 }
 
 void LALInferenceTemplateNoop(UNUSED LALInferenceModel *model);
@@ -65,43 +208,171 @@ void LALInferenceTemplateNoop(UNUSED LALInferenceModel *model)
   return;
 }
 
-void bench_likelihood(LALInferenceRunState *runState,UINT4 Niter);
-void bench_likelihood(LALInferenceRunState *runState,UINT4 Niter)
+void bench_likelihood(LALInferenceRunState *runState, LALInferenceLikelihoodFunction likelihood, const char *variant,
+                      UINT4 Niter, UINT4 fixedTemplate, BenchOutput *out);
+void bench_likelihood(LALInferenceRunState *runState, LALInferenceLikelihoodFunction likelihood, const char *variant,
+                      UINT4 Niter, UINT4 fixedTemplate, BenchOutput *out)
 {
   UINT4 i=0;
-  struct rusage r_usage_start,r_usage_end;
-  
-  /* Clear the template */
-  LALInferenceTemplateNullFreqdomain(runState->threads[0]->model);
+  BenchTiming timing;
+  LALInferenceStageTimer timer;
+  LALInferenceModel *model=runState->threads[0]->model;
+  LALInferenceTemplateFunction old_templt=model->templt;
   
-  LALInferenceTemplateFunction old_templt=runState->threads[0]->model->templt;
-  runState->threads[0]->model->templt=LALInferenceTemplateNoop;
+  if(fixedTemplate)
+  {
+    /* Fill the template buffers once and reuse them */
+    runState->likelihood(runState->threads[0]->currentParams,runState->data,model);
+    model->templt=LALInferenceTemplateNoop;
+  }
   
-  fprintf(stdout,"Benchmarking likelihood:\n");
-  getrusage(RUSAGE_SELF, &r_usage_start);
+  /* Start the cache statistics afresh */
+  if(model->extrinsicCache)
+  {
+    LALInferenceExtrinsicCache *cache=model->extrinsicCache;
+    cache->responseHits=cache->responseCalls=cache->rampHits=cache->rampCalls=0;
+  }
+
+  fprintf(stdout,"Benchmarking %s likelihood%s:\n",variant,fixedTemplate?" (fixed template)":"");
+  bench_start(&timing, Niter, model, &timer);
   for(i=0;i<Niter;i++)
   {
-    runState->likelihood(runState->threads[0]->model->params,runState->data, runState->threads[0]->model);
+    likelihood(runState->threads[0]->currentParams,runState->data,model);
   }
-  getrusage(RUSAGE_SELF, &r_usage_end);
-  fprintf_bench(stdout, r_usage_start, r_usage_end, Niter);
-  runState->threads[0]->model->templt=old_templt;
+  bench_stop(&timing, model);
+  fprintf_bench(stdout, &timing);
+  fprintf_stages(stdout, &timer, &timing);
+  fprintf_extrinsic_cache(stdout, model->extrinsicCache);
+  json_result(out, fixedTemplate ? "likelihood_fixed_template" : "likelihood", variant, &timing, &timer);
+  model->templt=old_templt;
   
 }
 
-void bench_template(LALInferenceRunState *runState, UINT4 Niter);
-void bench_template(LALInferenceRunState *runState, UINT4 Niter)
+void bench_template(LALInferenceRunState *runState, UINT4 Niter, BenchOutput *out);
+void bench_template(LALInferenceRunState *runState, UINT4 Niter, BenchOutput *out)
 {
   UINT4 i=0;
-  struct rusage r_usage_start,r_usage_end;
+  BenchTiming timing;
+  LALInferenceStageTimer timer;
+  LALInferenceModel *model=runState->threads[0]->model;
+  REAL8 stageStart;
+
+  LALInferenceCopyVariables(runState->threads[0]->currentParams, model->params);
+
   fprintf(stdout,"Benchmarking template:\n");
-  getrusage(RUSAGE_SELF, &r_usage_start);
+  bench_start(&timing, Niter, model, &timer);
   for(i=0;i<Niter;i++)
   {
-    runState->threads[0]->model->templt(runState->threads[0]->model);
+    stageStart=LALInferenceStageTimerStart(model);
+    model->templt(model);
+    LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_WAVEFORM, stageStart);
+    if(model->domain==LAL_SIM_DOMAIN_TIME)
+    {
+      stageStart=LALInferenceStageTimerStart(model);
+      LALInferenceExecuteFT(model);
+      LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_FFT, stageStart);
+    }
+  }
+  bench_stop(&timing, model);
+  fprintf_bench(stdout, &timing);
+  fprintf_stages(stdout, &timer, &timing);
+  json_result(out, "template", NULL, &timing, &timer);
+}
+
+void bench_prior(LALInferenceRunState *runState, UINT4 Niter, BenchOutput *out);
+void bench_prior(LALInferenceRunState *runState, UINT4 Niter, BenchOutput *out)
+{
+  UINT4 i=0;
+  BenchTiming timing;
+  LALInferenceStageTimer timer;
+  LALInferenceModel *model=runState->threads[0]->model;
+  REAL8 stageStart;
+
+  fprintf(stdout,"Benchmarking prior:\n");
+  bench_start(&timing, Niter, model, &timer);
+  for(i=0;i<Niter;i++)
+  {
+    stageStart=LALInferenceStageTimerStart(model);
+    runState->prior(runState, runState->threads[0]->currentParams, model);
+    LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_PRIOR, stageStart);
+  }
+  bench_stop(&timing, model);
+  fprintf_bench(stdout, &timing);
+  json_result(out, "prior", NULL, &timing, &timer);
+}
+
+/* Return the likelihood function of a named variant, or NULL if unknown */
+LALInferenceLikelihoodFunction likelihood_variant(LALInferenceRunState *runState, const char *name);
+LALInferenceLikelihoodFunction likelihood_variant(LALInferenceRunState *runState, const char *name)
+{
+  if(!strcmp(name,"default")) return runState->likelihood;
+  if(!strcmp(name,"gaussian")) return &LALInferenceUndecomposedFreqDomainLogLikelihood;
+  if(!strcmp(name,"margphi")) return &LALInferenceMarginalisedPhaseLogLikelihood;
+  if(!strcmp(name,"margtime")) return &LALInferenceMarginalisedTimeLogLikelihood;
+  if(!strcmp(name,"margtimephi")) return &LALInferenceMarginalisedTimePhaseLogLikelihood;
+  return NULL;
+}
+
+/* Switch the CBC model to a different approximant, in the domain it is implemented in */
+int set_cbc_approximant(LALInferenceRunState *runState, const char *name);
+int set_cbc_approximant(LALInferenceRunState *runState, const char *name)
+{
+  LALInferenceModel *model=runState->threads[0]->model;
+  INT4 approx=XLALGetApproximantFromString(name);
+  if(approx==XLAL_FAILURE)
+    XLAL_ERROR(XLAL_EINVAL,"Unknown approximant %s",name);
+  if(XLALSimInspiralImplementedFDApproximants(approx))
+    model->domain=LAL_SIM_DOMAIN_FREQUENCY;
+  else if(XLALSimInspiralImplementedTDApproximants(approx))
+    model->domain=LAL_SIM_DOMAIN_TIME;
+  else
+    XLAL_ERROR(XLAL_EINVAL,"Approximant %s is not implemented in either domain",name);
+  if((model->roq_flag || model->multiband_flag) && model->domain!=LAL_SIM_DOMAIN_FREQUENCY)
+    XLAL_ERROR(XLAL_EINVAL,"ROQ and multibanded likelihoods need a frequency-domain approximant, not %s",name);
+
+  UINT4 uapprox=(UINT4)approx;
+  LALInferenceSetVariable(model->params,"LAL_APPROXIMANT",&uapprox);
+  if(LALInferenceCheckVariable(runState->threads[0]->currentParams,"LAL_APPROXIMANT"))
+    LALInferenceSetVariable(runState->threads[0]->currentParams,"LAL_APPROXIMANT",&uapprox);
+  return XLAL_SUCCESS;
+}
+
+/* Run all the requested benchmarks with the current model */
+void run_benchmarks(LALInferenceRunState *runState, UINT4 Niter, UINT4 bench_T, UINT4 bench_L, UINT4 bench_P,
+                    char **variants, UINT4 nvariants, UINT4 fixedTemplate, BenchOutput *out);
+void run_benchmarks(LALInferenceRunState *runState, UINT4 Niter, UINT4 bench_T, UINT4 bench_L, UINT4 bench_P,
+                    char **variants, UINT4 nvariants, UINT4 fixedTemplate, BenchOutput *out)
+{
+  out->domain = runState->threads[0]->model->domain==LAL_SIM_DOMAIN_TIME ? "time" : "frequency";
+  fprintf(stdout,"=== Approximant %s (%s domain) ===\n\n",out->approximant,out->domain);
+  if(bench_T)
+  {
+    printf("Template test will run with parameters:\n");
+    LALInferencePrintVariables(runState->threads[0]->currentParams);
+    printf("\n");
+
+    bench_template(runState,Niter,out);
+    printf("\n");
+  }
+  if(bench_L)
+  {
+    for(UINT4 i=0;i<nvariants;i++)
+    {
+      LALInferenceLikelihoodFunction likelihood=likelihood_variant(runState,variants[i]);
+      if(!likelihood)
+      {
+        fprintf(stderr,"Unknown likelihood variant %s, skipping\n",variants[i]);
+        continue;
+      }
+      bench_likelihood(runState,likelihood,variants[i],Niter,fixedTemplate,out);
+      printf("\n");
+    }
+  }
+  if(bench_P && runState->prior)
+  {
+    bench_prior(runState,Niter,out);
+    printf("\n");
   }
-  getrusage(RUSAGE_SELF, &r_usage_end);
-  fprintf_bench(stdout, r_usage_start, r_usage_end, Niter);
 }
 
 int main(int argc, char *argv[]){
@@ -110,56 +381,152 @@ int main(int argc, char *argv[]){
   UINT4 Niter=1000;
   UINT4 bench_L=1;
   UINT4 bench_T=1;
+  UINT4 bench_P=1;
+  UINT4 burst=0;
+  UINT4 fixedTemplate=0;
+  char **approximants=NULL, **variants=NULL;
+  UINT4 napproximants=0, nvariants=0;
+  char *defaultVariant="default";
+  const char *label="";
+  BenchOutput out;
+  memset(&out,0,sizeof(out));
   
   procParams=LALInferenceParseCommandLine(argc,argv);
 
   if(LALInferenceGetProcParamVal(procParams,"--help"))
   {
     fprintf(stdout,"%s",HELPSTR);
-    bench_T=bench_L=0;
+    bench_T=bench_L=bench_P=0;
   }
   if((ppt=LALInferenceGetProcParamVal(procParams,"--Niter")))
      Niter=atoi(ppt->value);
   if(LALInferenceGetProcParamVal(procParams,"--bench-template"))
   {
-    bench_T=1; bench_L=0;
+    bench_T=1; bench_L=0; bench_P=0;
   }
   if(LALInferenceGetProcParamVal(procParams,"--bench-likelihood"))
   {
-    bench_T=0; bench_L=1;
+    bench_T=0; bench_L=1; bench_P=0;
+  }
+  if(LALInferenceGetProcParamVal(procParams,"--bench-prior"))
+  {
+    bench_T=0; bench_L=0; bench_P=1;
+  }
+  if(LALInferenceGetProcParamVal(procParams,"--bench-fixed-template"))
+    fixedTemplate=1;
+  if(LALInferenceGetProcParamVal(procParams,"--burst"))
+    burst=1;
+  if((ppt=LALInferenceGetProcParamVal(procParams,"--bench-approximants")))
+    LALInferenceParseCharacterOptionString(ppt->value,&approximants,&napproximants);
+  if((ppt=LALInferenceGetProcParamVal(procParams,"--bench-likelihoods")))
+    LALInferenceParseCharacterOptionString(ppt->value,&variants,&nvariants);
+  if((ppt=LALInferenceGetProcParamVal(procParams,"--bench-label")))
+    label=ppt->value;
+  if((ppt=LALInferenceGetProcParamVal(procParams,"--bench-json")))
+  {
+    out.json=fopen(ppt->value,"w");
+    if(!out.json)
+    {
+      fprintf(stderr,"Unable to open %s for writing\n",ppt->value);
+      exit(1);
+    }
+  }
+  if(burst && napproximants)
+  {
+    fprintf(stderr,"--bench-approximants is only supported for CBC models\n");
+    exit(1);
   }
 
   
   runState = LALInferenceInitRunState(procParams);
 
   if(runState) {
-    LALInferenceInjectInspiralSignal(runState->data,runState->commandLine);
+    if(burst)
+      LALInferenceInjectBurstSignal(runState->data,runState->commandLine);
+    else
+      LALInferenceInjectInspiralSignal(runState->data,runState->commandLine);
 
     /* Simulate calibration errors */
     LALInferenceApplyCalibrationErrors(runState->data,runState->commandLine);
   }
   
-  /* Set up the template and likelihood functions */
-  LALInferenceInitCBCThreads(runState,1);
+  /* Set up the template, prior and likelihood functions */
+  if(burst && runState)
+  {
+    LALInferenceInitBurstThreads(runState,1);
+    LALInferenceInitLIBPrior(runState);
+  }
+  else
+  {
+    LALInferenceInitCBCThreads(runState,1);
+    LALInferenceInitCBCPrior(runState);
+  }
   LALInferenceInitLikelihood(runState);
 
+  /* Only help was requested */
+  if(!runState || !(bench_T || bench_L || bench_P))
+    return(0);
+
+  LALInferenceModel *model=runState->threads[0]->model;
+  if(fixedTemplate && (model->roq_flag || model->multiband_flag))
+  {
+    fprintf(stderr,"--bench-fixed-template cannot be used with ROQ or multibanded likelihoods\n");
+    exit(1);
+  }
+
   /* Disable waveform caching */
-  runState->threads[0]->model->waveformCache=NULL;
-  
-  if(bench_T)
+  model->waveformCache=NULL;
+  model->burstWaveformCache=NULL;
+
+  if(!nvariants)
   {
-    printf("Template test will run with parameters:\n");
-    LALInferencePrintVariables(runState->threads[0]->model->params);
-    printf("\n");
+    variants=&defaultVariant;
+    nvariants=1;
+  }
 
-    bench_template(runState,Niter);
-    printf("\n");
+  if(out.json)
+  {
+    LALInferenceIFOData *ifo;
+    fprintf(out.json,"{\n  \"label\": ");
+    json_string(out.json,label);
+    fprintf(out.json,",\n");
+    fprintf(out.json,"  \"model\": \"%s\", \"roq\": %i, \"multiband\": %i,\n",burst?"burst":"cbc",model->roq_flag,model->multiband_flag);
+    fprintf(out.json,"  \"seglen\": %g, \"srate\": %g,\n",
+            runState->data->timeData->data->length*runState->data->timeData->deltaT,1.0/runState->data->timeData->deltaT);
+    fprintf(out.json,"  \"ifos\": [");
+    for(ifo=runState->data;ifo;ifo=ifo->next)
+      fprintf(out.json,"\"%s\"%s",ifo->name,ifo->next?", ":"");
+    fprintf(out.json,"],\n  \"results\": [");
   }
-  if(bench_L)
+
+  if(napproximants)
   {
-    bench_likelihood(runState,Niter);
-    printf("\n");
+    for(UINT4 i=0;i<napproximants;i++)
+    {
+      if(set_cbc_approximant(runState,approximants[i])!=XLAL_SUCCESS)
+      {
+        fprintf(stderr,"Skipping approximant %s\n",approximants[i]);
+        continue;
+      }
+      out.approximant=approximants[i];
+      run_benchmarks(runState,Niter,bench_T,bench_L,bench_P,variants,nvariants,fixedTemplate,&out);
+    }
   }
-  
+  else
+  {
+    UINT4 approx=LALInferenceGetUINT4Variable(model->params,"LAL_APPROXIMANT");
+    out.approximant = burst ? XLALGetStringFromBurstApproximant(approx) : XLALSimInspiralGetStringFromApproximant(approx);
+    run_benchmarks(runState,Niter,bench_T,bench_L,bench_P,variants,nvariants,fixedTemplate,&out);
+  }
+
+  if(out.json)
+  {
+    fprintf(out.json,"\n  ]\n}\n");
+    fclose(out.json);
+  }
+
+  LALInferenceDestroyExtrinsicCache(model->extrinsicCache);
+  model->extrinsicCache=NULL;
+
   return(0);
 }
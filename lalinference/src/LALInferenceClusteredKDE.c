@@ -46,6 +46,11 @@
 #define omp ignore
 #endif
 
+/* Number of mini-batches used to move the centroids when updating a clustering */
+#define KMEANS_MINIBATCH_ITERATIONS 10
+
+static void kmeans_reset_bounds(LALInferenceKmeans *kmeans);
+
 
 
 /**
@@ -620,6 +625,8 @@ void LALInferenceKmeansSeededInitialize(LALInferenceKmeans *kmeans) {
     REAL8 dist, norm, randomDraw;
     gsl_vector_view c, x;
 
+    kmeans_reset_bounds(kmeans);
+
     gsl_vector *dists = gsl_vector_alloc(kmeans->npts);
     gsl_permutation *p = gsl_permutation_alloc(kmeans->npts);
 
@@ -673,6 +680,8 @@ void LALInferenceKmeansSeededInitialize(LALInferenceKmeans *kmeans) {
 void LALInferenceKmeansForgyInitialize(LALInferenceKmeans *kmeans) {
     INT4 i, j, u;
 
+    kmeans_reset_bounds(kmeans);
+
     gsl_permutation *p = gsl_permutation_alloc(kmeans->npts);
 
     gsl_permutation_init(p);
@@ -698,6 +707,8 @@ void LALInferenceKmeansRandomPartitionInitialize(LALInferenceKmeans *kmeans) {
     INT4 i;
     INT4 cluster_id;
 
+    kmeans_reset_bounds(kmeans);
+
     for (i = 0; i < kmeans->npts; i++) {
         cluster_id = gsl_rng_uniform_int(kmeans->rng, kmeans->k);
         kmeans->assignments[i] = cluster_id;
@@ -712,20 +723,65 @@ void LALInferenceKmeansRandomPartitionInitialize(LALInferenceKmeans *kmeans) {
  *
  * Assign all data to the closest centroid and calculate the error, defined
  * as the cumulative sum of the distance between all points and their closest
- * centroid.
+ * centroid.  When using the Euclidean distance, a lower bound on the distance
+ * from each point to every other centroid is kept between iterations
+ * (Hamerly's algorithm), and the search over centroids is skipped for points
+ * that are provably still closest to their current centroid.  Points are
+ * assigned in parallel when OpenMP is available.
  * @param kmeans The kmeans to perform the assignment step on.
  */
 void LALInferenceKmeansAssignment(LALInferenceKmeans *kmeans) {
     INT4 i, j;
+    INT4 use_bounds = (kmeans->dist == &euclidean_dist_squared);
+    INT4 have_bounds = use_bounds && kmeans->lower_dists != NULL;
+    INT4 changed = 0;
+    REAL8 error = 0.;
+    REAL8 *half_sep = NULL;
+
+    if (use_bounds) {
+        if (!kmeans->lower_dists)
+            kmeans->lower_dists = XLALMalloc(kmeans->npts * sizeof(REAL8));
+
+        /* Half the distance from each centroid to its nearest neighbour.  A point
+         * closer than this to its centroid can't be closer to any other. */
+        half_sep = XLALMalloc(kmeans->k * sizeof(REAL8));
+        for (j = 0; j < kmeans->k; j++) {
+            gsl_vector_view c = gsl_matrix_row(kmeans->centroids, j);
+            half_sep[j] = INFINITY;
+            for (INT4 l = 0; l < kmeans->k; l++) {
+                if (l == j)
+                    continue;
+                gsl_vector_view d = gsl_matrix_row(kmeans->centroids, l);
+                REAL8 sep = sqrt(kmeans->dist(&c.vector, &d.vector)) / 2.;
+                if (sep < half_sep[j])
+                    half_sep[j] = sep;
+            }
+        }
+    }
 
-    kmeans->error = 0.;
-
+    #pragma omp parallel for private(j) reduction(+:error,changed) schedule(static)
     for (i = 0; i < kmeans->npts; i++) {
         gsl_vector_view x = gsl_matrix_row(kmeans->data, i);
         gsl_vector_view c;
+        INT4 current_cluster = kmeans->assignments[i];
+
+        if (have_bounds) {
+            /* The distance to the current centroid is always needed for the error */
+            c = gsl_matrix_row(kmeans->centroids, current_cluster);
+            REAL8 current_dist = kmeans->dist(&x.vector, &c.vector);
+            REAL8 bound = kmeans->lower_dists[i];
+            if (half_sep[current_cluster] > bound)
+                bound = half_sep[current_cluster];
+
+            if (sqrt(current_dist) <= bound) {
+                error += current_dist;
+                continue;
+            }
+        }
 
         INT4 best_cluster = 0;
         REAL8 best_dist = INFINITY;
+        REAL8 second_dist = INFINITY;
         REAL8 dist;
 
         /* Find the closest centroid */
@@ -734,26 +790,37 @@ void LALInferenceKmeansAssignment(LALInferenceKmeans *kmeans) {
             dist = kmeans->dist(&x.vector, &c.vector);
 
             if (dist < best_dist) {
+                second_dist = best_dist;
                 best_cluster = j;
                 best_dist = dist;
+            } else if (dist < second_dist) {
+                second_dist = dist;
             }
         }
 
+        if (use_bounds)
+            kmeans->lower_dists[i] = sqrt(second_dist);
+
         /* Check if the point's assignment has changed */
-        INT4 current_cluster = kmeans->assignments[i];
         if (best_cluster != current_cluster) {
-            kmeans->has_changed = 1;
+            changed++;
             kmeans->assignments[i] = best_cluster;
         }
-        kmeans->error += best_dist;
+        error += best_dist;
     }
 
+    kmeans->error = error;
+    if (changed)
+        kmeans->has_changed = 1;
+
     /* Recalculate cluster sizes */
     for (i = 0; i < kmeans->k; i++)
         kmeans->sizes[i] = 0;
 
     for (i = 0; i < kmeans->npts; i++)
         kmeans->sizes[kmeans->assignments[i]]++;
+
+    XLALFree(half_sep);
 }
 
 
@@ -761,17 +828,199 @@ void LALInferenceKmeansAssignment(LALInferenceKmeans *kmeans) {
  * The update step of the kmeans algorithm.
  *
  * Based on the current assignments, calculate the new centroid of each cluster.
+ * If the assignment step is keeping distance bounds, they are loosened by the
+ * largest distance moved by any centroid.
  * @param kmeans The kmeans to perform the update step on.
  */
 void LALInferenceKmeansUpdate(LALInferenceKmeans *kmeans) {
     INT4 i;
+    REAL8 max_shift = 0.;
+    gsl_vector *old_centroid = NULL;
+
+    if (kmeans->lower_dists)
+        old_centroid = gsl_vector_alloc(kmeans->dim);
+
+    /* Euclidean centroids of all clusters can be summed in a single pass */
+    gsl_matrix *sums = NULL;
+    INT4 *counts = NULL;
+    if (kmeans->centroid == &euclidean_centroid) {
+        sums = gsl_matrix_calloc(kmeans->k, kmeans->dim);
+        counts = XLALCalloc(kmeans->k, sizeof(INT4));
+        for (i = 0; i < kmeans->npts; i++) {
+            gsl_vector_view x = gsl_matrix_row(kmeans->data, i);
+            gsl_vector_view sum = gsl_matrix_row(sums, kmeans->assignments[i]);
+            gsl_vector_add(&sum.vector, &x.vector);
+            counts[kmeans->assignments[i]]++;
+        }
+    }
 
     for (i = 0; i < kmeans->k; i ++) {
-        LALInferenceKmeansConstructMask(kmeans, kmeans->mask, i);
-
         gsl_vector_view c = gsl_matrix_row(kmeans->centroids, i);
-        kmeans->centroid(&c.vector, kmeans->data, kmeans->mask);
+        if (old_centroid)
+            gsl_vector_memcpy(old_centroid, &c.vector);
+
+        if (sums) {
+            gsl_vector_view sum = gsl_matrix_row(sums, i);
+            gsl_vector_memcpy(&c.vector, &sum.vector);
+            gsl_vector_scale(&c.vector, 1./counts[i]);
+        } else {
+            LALInferenceKmeansConstructMask(kmeans, kmeans->mask, i);
+            kmeans->centroid(&c.vector, kmeans->data, kmeans->mask);
+        }
+
+        if (old_centroid) {
+            REAL8 shift = sqrt(kmeans->dist(old_centroid, &c.vector));
+            if (!(shift <= max_shift))
+                max_shift = shift;
+        }
     }
+
+    if (old_centroid) {
+        for (i = 0; i < kmeans->npts; i++)
+            kmeans->lower_dists[i] -= max_shift;
+        gsl_vector_free(old_centroid);
+    }
+
+    if (sums) {
+        gsl_matrix_free(sums);
+        XLALFree(counts);
+    }
+}
+
+
+/**
+ * Move the centroids of a kmeans towards random mini-batches of its data.
+ *
+ * Performs \a niter steps of mini-batch kmeans (Sculley 2010).  Each step
+ *  draws \a batch_size points, and moves the centroid closest to each point
+ *  towards it with a step size inversely proportional to the number of points
+ *  the centroid has absorbed.  The current cluster sizes are taken as the
+ *  initial counts, so that a converged clustering is only nudged by new data.
+ *  The assignments are left untouched; follow with LALInferenceKmeansRun() to
+ *  make the clustering self-consistent.
+ * @param kmeans     The kmeans to update the centroids of.
+ * @param batch_size The number of points in each mini-batch.
+ * @param niter      The number of mini-batches.
+ */
+void LALInferenceKmeansMiniBatch(LALInferenceKmeans *kmeans, INT4 batch_size, INT4 niter) {
+    INT4 i, j, n;
+
+    REAL8 *counts = XLALMalloc(kmeans->k * sizeof(REAL8));
+    INT4 *batch = XLALMalloc(batch_size * sizeof(INT4));
+    INT4 *nearest = XLALMalloc(batch_size * sizeof(INT4));
+
+    for (j = 0; j < kmeans->k; j++)
+        counts[j] = (REAL8)kmeans->sizes[j];
+
+    for (n = 0; n < niter; n++) {
+        for (i = 0; i < batch_size; i++)
+            batch[i] = gsl_rng_uniform_int(kmeans->rng, kmeans->npts);
+
+        /* Find the nearest centroids before moving any of them */
+        for (i = 0; i < batch_size; i++) {
+            gsl_vector_view x = gsl_matrix_row(kmeans->data, batch[i]);
+            REAL8 best_dist = INFINITY;
+            nearest[i] = 0;
+            for (j = 0; j < kmeans->k; j++) {
+                gsl_vector_view c = gsl_matrix_row(kmeans->centroids, j);
+                REAL8 dist = kmeans->dist(&x.vector, &c.vector);
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    nearest[i] = j;
+                }
+            }
+        }
+
+        for (i = 0; i < batch_size; i++) {
+            gsl_vector_view x = gsl_matrix_row(kmeans->data, batch[i]);
+            gsl_vector_view c = gsl_matrix_row(kmeans->centroids, nearest[i]);
+            counts[nearest[i]] += 1.;
+            REAL8 eta = 1. / counts[nearest[i]];
+
+            gsl_vector_scale(&c.vector, 1. - eta);
+            gsl_blas_daxpy(eta, &x.vector, &c.vector);
+        }
+    }
+
+    /* Centroids have moved, so the assignments need revisiting */
+    kmeans_reset_bounds(kmeans);
+    kmeans->has_changed = 1;
+
+    XLALFree(counts);
+    XLALFree(batch);
+    XLALFree(nearest);
+}
+
+
+/**
+ * Update an existing clustering to a new set of samples.
+ *
+ * Rather than searching for the number of clusters again, the \a previous
+ *  clustering is used as the starting point for clustering \a data with the same
+ *  number of clusters.  The previous centroids are transformed to the whitening
+ *  of \a data, optionally moved by mini-batch steps, then the kmeans is run to
+ *  convergence.  This is much cheaper than a fresh clustering when \a data
+ *  differs only moderately from the samples of \a previous, e.g. when a
+ *  proposal is refreshed from a growing buffer.  As with a fresh clustering, the
+ *  KDEs of the returned clusters are built, so it can be drawn from directly.
+ * @param[in] previous   The existing clustering.  It is not modified, and remains
+ *                        owned by the caller.
+ * @param[in] data       The unwhitened data to be clustered.
+ * @param[in] batch_size Size of the mini-batches used to move the centroids
+ *                        before running kmeans, or 0 to skip them.
+ * @param[in] rng        A GSL random number generator.
+ * @return The updated clustering, or NULL if a cluster was left empty, in which
+ *          case the data should be clustered from scratch.
+ */
+LALInferenceKmeans *LALInferenceKmeansUpdateFromSamples(LALInferenceKmeans *previous,
+                                                        gsl_matrix *data,
+                                                        INT4 batch_size,
+                                                        gsl_rng *rng) {
+    INT4 j, p;
+
+    if (!previous || !data || (INT4)data->size2 != previous->dim)
+        return NULL;
+
+    LALInferenceKmeans *kmeans = LALInferenceCreateKmeans(previous->k, data, rng);
+    if (!kmeans)
+        return NULL;
+
+    /* Move the previous centroids to the new whitened coordinates */
+    for (j = 0; j < kmeans->k; j++) {
+        for (p = 0; p < kmeans->dim; p++) {
+            REAL8 x = gsl_matrix_get(previous->centroids, j, p) *
+                        gsl_vector_get(previous->std, p) +
+                        gsl_vector_get(previous->mean, p);
+            gsl_matrix_set(kmeans->centroids, j, p,
+                            (x - gsl_vector_get(kmeans->mean, p)) /
+                            gsl_vector_get(kmeans->std, p));
+        }
+        kmeans->sizes[j] = (INT4)(previous->weights[j] * kmeans->npts);
+    }
+
+    if (batch_size > 0)
+        LALInferenceKmeansMiniBatch(kmeans, batch_size, KMEANS_MINIBATCH_ITERATIONS);
+
+    LALInferenceKmeansRun(kmeans);
+
+    for (j = 0; j < kmeans->k; j++) {
+        if (kmeans->sizes[j] == 0) {
+            LALInferenceKmeansDestroy(kmeans);
+            return NULL;
+        }
+    }
+
+    LALInferenceKmeansBuildKDE(kmeans);
+
+    return kmeans;
+}
+
+
+/* Forget the distance bounds of the assignment step, e.g. after the centroids
+ * have been set by other means */
+static void kmeans_reset_bounds(LALInferenceKmeans *kmeans) {
+    XLALFree(kmeans->lower_dists);
+    kmeans->lower_dists = NULL;
 }
 
 
@@ -1175,10 +1424,12 @@ gsl_matrix * LALInferenceWhitenSamples(gsl_matrix *samples) {
  */
 REAL8 euclidean_dist_squared(gsl_vector *x, gsl_vector *y) {
     size_t i;
+    const REAL8 *xd = x->data, *yd = y->data;
+    size_t xs = x->stride, ys = y->stride;
 
     REAL8 dist = 0.;
     for (i = 0; i < x->size; i++) {
-        REAL8 diff = gsl_vector_get(x, i) - gsl_vector_get(y, i);
+        REAL8 diff = xd[i*xs] - yd[i*ys];
         dist += diff * diff;
     }
 
@@ -1347,6 +1598,7 @@ void LALInferenceKmeansDestroy(LALInferenceKmeans *kmeans) {
         XLALFree(kmeans->mask);
         XLALFree(kmeans->weights);
         XLALFree(kmeans->sizes);
+        XLALFree(kmeans->lower_dists);
 
         /* If KDEs are defined, free all of them */
         if (kmeans->KDEs != NULL) {
@@ -57,6 +57,9 @@ tagkmeans
     gsl_rng *rng;                        /**< Random number generator */
 
     REAL8 error;                         /**< Error of current clustering */
+    REAL8 *lower_dists;                  /**< Lower bounds on the distance from each point to any
+                                              centroid other than its own, used to skip the
+                                              nearest-centroid search in the assignment step */
 
     LALInferenceKDE **KDEs;              /**< Array of KDEs, one for each cluster */
 } LALInferenceKmeans;
@@ -97,6 +100,12 @@ void LALInferenceKmeansRandomPartitionInitialize(LALInferenceKmeans *kmeans);
 /* The assignment step of the kmeans algorithm. */
 void LALInferenceKmeansAssignment(LALInferenceKmeans *kmeans);
 
+/* Move the centroids of a kmeans towards random mini-batches of its data. */
+void LALInferenceKmeansMiniBatch(LALInferenceKmeans *kmeans, INT4 batch_size, INT4 niter);
+
+/* Update an existing clustering to a new set of samples, starting from its centroids. */
+LALInferenceKmeans *LALInferenceKmeansUpdateFromSamples(LALInferenceKmeans *previous, gsl_matrix *data, INT4 batch_size, gsl_rng *rng);
+
 /* The update step of the kmeans algorithm. */
 void LALInferenceKmeansUpdate(LALInferenceKmeans *kmeans);
 
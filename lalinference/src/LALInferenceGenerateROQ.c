@@ -19,7 +19,9 @@
  *  MA  02111-1307  USA
  */
 
+#include <stdio.h>
 #include <lal/LALInferenceGenerateROQ.h>
+#include <lal/H5FileIO.h>
 
 #ifndef _OPENMP
 #define omp ignore
@@ -87,6 +89,9 @@ COMPLEX16Array *complex_B_matrix(gsl_matrix_complex *V, gsl_matrix_complex *RB);
 /* find the index of the absolute maximum value for a complex vector */
 int complex_vector_maxabs_index( gsl_vector_complex *c );
 
+/* weighted dot product of two raw complex arrays, without allocating memory */
+static COMPLEX16 complex_weighted_dot_product_array(const REAL8Vector *weight, const COMPLEX16 *a, const COMPLEX16 *b, size_t n);
+
 
 /** \brief Function to project the training set onto a given basis vector
  *
@@ -249,6 +254,41 @@ gsl_complex complex_weighted_dot_product(const gsl_vector *weight, gsl_vector_co
 }
 
 
+/** \brief The weighted dot product of two raw complex arrays
+ *
+ * As \c complex_weighted_dot_product, but working directly on arrays so that it allocates no
+ * memory and can be called concurrently from many threads.
+ *
+ * @param[in] weight A real scaling factor, or vector of factors, for the dot product
+ * @param[in] a The first complex array (which is conjugated)
+ * @param[in] b The second complex array
+ * @param[in] n The length of the arrays
+ *
+ * @return The complex dot product of the two arrays
+ */
+static COMPLEX16 complex_weighted_dot_product_array(const REAL8Vector *weight, const COMPLEX16 *a, const COMPLEX16 *b, size_t n){
+  REAL8 dpre = 0., dpim = 0.;
+  size_t i = 0;
+
+  if ( weight->length == 1 ){
+    for ( i=0; i<n; i++ ){
+      dpre += creal(a[i])*creal(b[i]) + cimag(a[i])*cimag(b[i]);
+      dpim += creal(a[i])*cimag(b[i]) - cimag(a[i])*creal(b[i]);
+    }
+    dpre *= weight->data[0];
+    dpim *= weight->data[0];
+  }
+  else{
+    for ( i=0; i<n; i++ ){
+      dpre += weight->data[i]*(creal(a[i])*creal(b[i]) + cimag(a[i])*cimag(b[i]));
+      dpim += weight->data[i]*(creal(a[i])*cimag(b[i]) - cimag(a[i])*creal(b[i]));
+    }
+  }
+
+  return crect(dpre, dpim);
+}
+
+
 /** \brief Normalise a real vector with a given weighting
  *
  * @param[in] weight The weighting(s) in the normalisation (e.g. time of frequency step(s) between points)
@@ -988,7 +1028,7 @@ REAL8 LALInferenceGenerateCOMPLEX16OrthonormalBasis(COMPLEX16Array **RBin,
   UINT4 worst_app = 0;      /* worst error stored */
   gsl_complex tmpc;         /* worst error temp */
 
-  gsl_vector_complex *ts_el, *last_rb, *ortho_basis, *ru;
+  gsl_vector_complex *ts_el, *ortho_basis, *ru;
   gsl_matrix_complex *R_matrix;
   REAL8 A_row_norms2[rows];              // || A(i,:) ||^2
   REAL8 projection_norms2[rows];
@@ -1000,12 +1040,10 @@ REAL8 LALInferenceGenerateCOMPLEX16OrthonormalBasis(COMPLEX16Array **RBin,
   
   /* this memory should be freed here */
   ts_el         = gsl_vector_complex_alloc(cols);
-  last_rb       = gsl_vector_complex_alloc(cols);
   ortho_basis   = gsl_vector_complex_alloc(cols);
   ru            = gsl_vector_complex_alloc(max_RB);
 
   //project_coeff = gsl_matrix_complex_alloc(max_RB,rows);
-  gsl_complex projection_coeff;
   R_matrix = gsl_matrix_complex_alloc(max_RB, max_RB);
 
   /* initialise projection norms with zeros */
@@ -1041,13 +1079,12 @@ REAL8 LALInferenceGenerateCOMPLEX16OrthonormalBasis(COMPLEX16Array **RBin,
 
   /* loop to find reduced basis */
   while( 1 ){
-    gsl_matrix_complex_get_row(last_rb, &RBview.matrix, dim_RB-1); /* previous basis */
-
-    /* Compute overlaps of pieces of training set with rb_new */
+    /* Compute overlaps of pieces of training set with rb_new (rows are independent, so share them between threads) */
+    const COMPLEX16 *last_rb_data = &(RB->data[(dim_RB-1)*cols]);
+    #pragma omp parallel for schedule(static)
     for(size_t i = 0; i < rows; i++){
-      gsl_matrix_complex_get_row(ts_el, &TSview.matrix, i);
-      projection_coeff = complex_weighted_dot_product(&deltaview.vector, last_rb, ts_el);
-      projection_norms2[i] += (projection_coeff.dat[0]*projection_coeff.dat[0] + projection_coeff.dat[1]*projection_coeff.dat[1]);
+      COMPLEX16 projection_coeff = complex_weighted_dot_product_array(delta, last_rb_data, &(ts->data[i*cols]), cols);
+      projection_norms2[i] += (creal(projection_coeff)*creal(projection_coeff) + cimag(projection_coeff)*cimag(projection_coeff));
       errors[i] = A_row_norms2[i] - projection_norms2[i];
     }
 
@@ -1123,7 +1160,6 @@ REAL8 LALInferenceGenerateCOMPLEX16OrthonormalBasis(COMPLEX16Array **RBin,
 
   XLALDestroyUINT4Vector(dims);
   gsl_vector_complex_free(ts_el);
-  gsl_vector_complex_free(last_rb);
   gsl_vector_complex_free(ortho_basis);
   gsl_vector_complex_free(ru);
   gsl_matrix_complex_free(R_matrix);
@@ -1132,6 +1168,269 @@ REAL8 LALInferenceGenerateCOMPLEX16OrthonormalBasis(COMPLEX16Array **RBin,
 }
 
 
+/* write the state of an out-of-core basis generation to a checkpoint file (via a temporary file
+ * that is renamed on completion, so an interrupted write does not corrupt an earlier checkpoint) */
+static int complex_basis_write_checkpoint(const CHAR *checkpoint, COMPLEX16Array *RB, UINT4Vector *gpts,
+                                          UINT4 dim_RB, REAL8Vector *projection_norms2, REAL8 worst_err);
+static int complex_basis_write_checkpoint(const CHAR *checkpoint, COMPLEX16Array *RB, UINT4Vector *gpts,
+                                          UINT4 dim_RB, REAL8Vector *projection_norms2, REAL8 worst_err){
+  CHAR tmpfile[FILENAME_MAX];
+  LALH5File *cpfile = NULL;
+  UINT4Vector gview;
+  UINT4 rows = projection_norms2->length;
+
+  XLAL_CHECK( snprintf(tmpfile, sizeof(tmpfile), "%s.tmp", checkpoint) < (int)sizeof(tmpfile), XLAL_EINVAL, "Checkpoint file name too long" );
+
+  gview.length = dim_RB;
+  gview.data = gpts->data;
+
+  XLAL_CHECK( (cpfile = XLALH5FileOpen(tmpfile, "w")) != NULL, XLAL_EIO, "Could not open checkpoint file '%s'", tmpfile );
+  XLAL_CHECK( XLALH5FileAddScalarAttribute(cpfile, "num_training", &rows, LAL_U4_TYPE_CODE) == XLAL_SUCCESS, XLAL_EFUNC );
+  XLAL_CHECK( XLALH5FileAddScalarAttribute(cpfile, "worst_error", &worst_err, LAL_D_TYPE_CODE) == XLAL_SUCCESS, XLAL_EFUNC );
+  XLAL_CHECK( XLALH5FileWriteCOMPLEX16Array(cpfile, "reduced_basis", RB) == XLAL_SUCCESS, XLAL_EFUNC );
+  XLAL_CHECK( XLALH5FileWriteUINT4Vector(cpfile, "greedy_points", &gview) == XLAL_SUCCESS, XLAL_EFUNC );
+  XLAL_CHECK( XLALH5FileWriteREAL8Vector(cpfile, "projection_norms2", projection_norms2) == XLAL_SUCCESS, XLAL_EFUNC );
+  XLALH5FileClose(cpfile);
+
+  XLAL_CHECK( rename(tmpfile, checkpoint) == 0, XLAL_EIO, "Could not move '%s' to '%s'", tmpfile, checkpoint );
+
+  return XLAL_SUCCESS;
+}
+
+
+/**
+ * \brief Create a orthonormal basis set from a training set of complex waveforms stored in a file
+ *
+ * This performs the same greedy algorithm as \c LALInferenceGenerateCOMPLEX16OrthonormalBasis, but
+ * without ever holding the whole training set in memory, so can be used for training sets that are
+ * larger than the available memory. The training set is streamed from the HDF5 file \c tsfile, which
+ * should contain one or more two-dimensional \c COMPLEX16 datasets (as written by
+ * \c XLALH5FileWriteCOMPLEX16Array), each holding a block of training waveforms as rows. All blocks
+ * must have the same number of columns, and only one block is read into memory at a time. The rows of
+ * each block are projected onto the basis in parallel. Each greedy iteration needs one pass through
+ * the file, so the block size should be chosen to be as large as comfortably fits in memory. The
+ * training set is normalised as it is read and the file itself is not modified.
+ *
+ * If \c checkpoint is not \c NULL, the state of the algorithm is written to that HDF5 file after
+ * every new basis vector. If the file already exists when this function is called, the basis
+ * generation resumes from the state that it contains (the training set must be the same as that used
+ * to create it).
+ *
+ * @param[out] RBin A \c COMPLEX16Array to return the reduced basis.
+ * @param[in] delta The time/frequency step(s) in the training set used to normalise the models.
+ * This can be a vector containing just one value.
+ * @param[in] tolerance The tolerance used as a stopping criteria for the basis generation.
+ * @param[in] tsfile The name of the HDF5 file containing the training set.
+ * @param[in] checkpoint The name of a HDF5 checkpoint file, or \c NULL for no checkpointing.
+ * @param[out] greedypoints A \c UINT4Vector to return the indices of the training set rows (counting
+ * through the datasets in the order that they are stored in the file) that have been used to form
+ * the reduced basis.
+ *
+ * @return A \c REAL8 with the maximum projection error for the final reduced basis.
+ *
+ * \sa LALInferenceGenerateCOMPLEX16OrthonormalBasis
+ */
+REAL8 LALInferenceGenerateCOMPLEX16OrthonormalBasisFromFile(COMPLEX16Array **RBin,
+                                                            const REAL8Vector *delta,
+                                                            REAL8 tolerance,
+                                                            const CHAR *tsfile,
+                                                            const CHAR *checkpoint,
+                                                            UINT4Vector **greedypoints){
+  XLAL_CHECK_REAL8( RBin != NULL && delta != NULL && tsfile != NULL && greedypoints != NULL, XLAL_EFAULT );
+
+  LALH5File *file = NULL;
+  XLAL_CHECK_REAL8( (file = XLALH5FileOpen(tsfile, "r")) != NULL, XLAL_EIO, "Could not open training set file '%s'", tsfile );
+
+  /* get the names and sizes of the training set blocks */
+  size_t nblocks = XLALH5FileQueryNDatasets(file);
+  XLAL_CHECK_REAL8( nblocks > 0, XLAL_EINVAL, "No training set datasets in '%s'", tsfile );
+
+  CHAR **names = XLALCalloc(nblocks, sizeof(CHAR *));
+  UINT4 *blockrows = XLALCalloc(nblocks, sizeof(UINT4));
+  size_t rows = 0, cols = 0;
+
+  for ( size_t b=0; b<nblocks; b++ ){
+    int namelen = XLALH5FileQueryDatasetName(NULL, 0, file, (int)b);
+    XLAL_CHECK_REAL8( namelen > 0, XLAL_EFUNC );
+    names[b] = XLALMalloc(namelen + 1);
+    XLAL_CHECK_REAL8( XLALH5FileQueryDatasetName(names[b], namelen + 1, file, (int)b) == namelen, XLAL_EFUNC );
+
+    LALH5Dataset *dset = NULL;
+    XLAL_CHECK_REAL8( (dset = XLALH5DatasetRead(file, names[b])) != NULL, XLAL_EFUNC );
+    XLAL_CHECK_REAL8( XLALH5DatasetQueryType(dset) == LAL_Z_TYPE_CODE, XLAL_ETYPE, "Dataset '%s' is not COMPLEX16", names[b] );
+    UINT4Vector *dims = XLALH5DatasetQueryDims(dset);
+    XLAL_CHECK_REAL8( dims != NULL && dims->length == 2, XLAL_EDIMS, "Dataset '%s' is not two-dimensional", names[b] );
+    if ( b == 0 ){ cols = dims->data[1]; }
+    XLAL_CHECK_REAL8( dims->data[1] == cols, XLAL_EDIMS, "Dataset '%s' has %u columns rather than %zu", names[b], dims->data[1], cols );
+    blockrows[b] = dims->data[0];
+    rows += dims->data[0];
+    XLALDestroyUINT4Vector(dims);
+    XLALH5DatasetFree(dset);
+  }
+
+  XLAL_CHECK_REAL8( delta->length == 1 || delta->length == cols, XLAL_EINVAL, "Vector of weights must either contain a single value, or be the same length as the training waveforms" );
+
+  size_t max_RB = rows;
+
+  REAL8Vector *projection_norms2 = XLALCreateREAL8Vector(rows);
+  REAL8Vector *invnorms = XLALCreateREAL8Vector(rows); /* inverse norms of the training set rows */
+  COMPLEX16Vector *worst_row = XLALCreateCOMPLEX16Vector(cols);
+  XLAL_CHECK_REAL8( projection_norms2 != NULL && invnorms != NULL && worst_row != NULL, XLAL_ENOMEM );
+
+  UINT4Vector *gpts = NULL;
+  COMPLEX16Array *RB = NULL;
+  UINT4Vector *dims = XLALCreateUINT4Vector( 2 );
+  UINT4 dim_RB = 0;
+  REAL8 worst_err = INFINITY; /* worst projection error in the latest greedy sweep */
+  UINT4 worst_app = 0;
+
+  /* resume from a checkpoint if one exists */
+  FILE *cpexists = NULL;
+  if ( checkpoint != NULL && (cpexists = fopen(checkpoint, "r")) != NULL ){
+    fclose(cpexists);
+
+    LALH5File *cpfile = NULL;
+    UINT4 cprows = 0;
+    XLAL_CHECK_REAL8( (cpfile = XLALH5FileOpen(checkpoint, "r")) != NULL, XLAL_EIO, "Could not open checkpoint file '%s'", checkpoint );
+    XLAL_CHECK_REAL8( XLALH5FileQueryScalarAttributeValue(&cprows, cpfile, "num_training") == XLAL_SUCCESS, XLAL_EFUNC );
+    XLAL_CHECK_REAL8( XLALH5FileQueryScalarAttributeValue(&worst_err, cpfile, "worst_error") == XLAL_SUCCESS, XLAL_EFUNC );
+    XLAL_CHECK_REAL8( cprows == rows, XLAL_EINVAL, "Checkpoint '%s' was made with %u training waveforms, not %zu", checkpoint, cprows, rows );
+
+    UINT4Vector *cpgpts = NULL;
+    REAL8Vector *cpnorms = NULL;
+    XLAL_CHECK_REAL8( (RB = XLALH5FileReadCOMPLEX16Array(cpfile, "reduced_basis")) != NULL, XLAL_EFUNC );
+    XLAL_CHECK_REAL8( (cpgpts = XLALH5FileReadUINT4Vector(cpfile, "greedy_points")) != NULL, XLAL_EFUNC );
+    XLAL_CHECK_REAL8( (cpnorms = XLALH5FileReadREAL8Vector(cpfile, "projection_norms2")) != NULL, XLAL_EFUNC );
+    XLALH5FileClose(cpfile);
+
+    dim_RB = RB->dimLength->data[0];
+    XLAL_CHECK_REAL8( RB->dimLength->data[1] == cols && cpgpts->length == dim_RB && cpnorms->length == rows, XLAL_EDIMS, "Checkpoint '%s' is inconsistent with the training set", checkpoint );
+
+    gpts = XLALCreateUINT4Vector(max_RB);
+    memcpy(gpts->data, cpgpts->data, dim_RB*sizeof(UINT4));
+    memcpy(projection_norms2->data, cpnorms->data, rows*sizeof(REAL8));
+    XLALDestroyUINT4Vector(cpgpts);
+    XLALDestroyREAL8Vector(cpnorms);
+
+    XLALPrintInfo("%s: resuming from checkpoint '%s' with %u bases\n", __func__, checkpoint, dim_RB);
+  }
+  else{
+    gpts = XLALCreateUINT4Vector(max_RB);
+    memset(projection_norms2->data, 0, rows*sizeof(REAL8));
+  }
+
+  /* get the norms of all the training set rows, and initialise the basis with the first if not resuming */
+  for ( size_t b=0, offset=0; b<nblocks; offset += blockrows[b], b++ ){
+    COMPLEX16Array *block = XLALH5FileReadCOMPLEX16Array(file, names[b]);
+    XLAL_CHECK_REAL8( block != NULL, XLAL_EFUNC );
+
+    #pragma omp parallel for schedule(static)
+    for ( size_t i=0; i<blockrows[b]; i++ ){
+      const COMPLEX16 *row = &(block->data[i*cols]);
+      invnorms->data[offset+i] = 1./sqrt(cabs(complex_weighted_dot_product_array(delta, row, row, cols)));
+    }
+
+    if ( b == 0 && dim_RB == 0 ){
+      dims->data[0] = 1;
+      dims->data[1] = cols;
+      RB = XLALCreateCOMPLEX16Array( dims );
+      for ( size_t j=0; j<cols; j++ ){ RB->data[j] = block->data[j]*invnorms->data[0]; }
+      gpts->data[0] = 0;
+      dim_RB = 1;
+      if ( checkpoint != NULL ){
+        XLAL_CHECK_REAL8( complex_basis_write_checkpoint(checkpoint, RB, gpts, dim_RB, projection_norms2, worst_err) == XLAL_SUCCESS, XLAL_EFUNC );
+      }
+    }
+
+    XLALDestroyCOMPLEX16Array(block);
+  }
+
+  *RBin = RB;
+
+  gsl_vector_view deltaview;
+  XLAL_CALLGSL( deltaview = gsl_vector_view_array(delta->data, delta->length) );
+
+  /* loop to find reduced basis (which may already be complete if resuming) */
+  while ( dim_RB < max_RB && !(worst_err < tolerance) ){
+    const COMPLEX16 *last_rb = &(RB->data[(dim_RB-1)*cols]);
+
+    /* stream the training set through, projecting each block onto the newest basis in parallel */
+    worst_err = 0.;
+    for ( size_t b=0, offset=0; b<nblocks; offset += blockrows[b], b++ ){
+      COMPLEX16Array *block = XLALH5FileReadCOMPLEX16Array(file, names[b]);
+      XLAL_CHECK_REAL8( block != NULL, XLAL_EFUNC );
+
+      #pragma omp parallel for schedule(static)
+      for ( size_t i=0; i<blockrows[b]; i++ ){
+        COMPLEX16 projection_coeff = complex_weighted_dot_product_array(delta, last_rb, &(block->data[i*cols]), cols)*invnorms->data[offset+i];
+        projection_norms2->data[offset+i] += (creal(projection_coeff)*creal(projection_coeff) + cimag(projection_coeff)*cimag(projection_coeff));
+      }
+
+      /* keep a copy of the worst represented training set element seen so far */
+      size_t blockworst = blockrows[b];
+      for ( size_t i=0; i<blockrows[b]; i++ ){
+        REAL8 err = 1. - projection_norms2->data[offset+i];
+        if ( worst_err < err ){
+          worst_err = err;
+          blockworst = i;
+        }
+      }
+      if ( blockworst < blockrows[b] ){
+        worst_app = offset + blockworst;
+        for ( size_t j=0; j<cols; j++ ){ worst_row->data[j] = block->data[blockworst*cols + j]*invnorms->data[worst_app]; }
+      }
+
+      XLALDestroyCOMPLEX16Array(block);
+    }
+
+    /* the training set is already exactly represented */
+    if ( !(worst_err > 0.) ){ break; }
+
+    gpts->data[dim_RB] = worst_app;
+
+    /* add worst approximated solution to basis set */
+    gsl_vector_complex_view ortho_basis;
+    gsl_matrix_complex_view RBview;
+    gsl_vector_complex *ru;
+    XLAL_CALLGSL( ortho_basis = gsl_vector_complex_view_array((double *)worst_row->data, cols) );
+    XLAL_CALLGSL( RBview = gsl_matrix_complex_view_array((double *)RB->data, dim_RB, cols) );
+    XLAL_CALLGSL( ru = gsl_vector_complex_alloc(dim_RB+1) );
+    iterated_modified_gm_complex(ru, &ortho_basis.vector, &RBview.matrix, &deltaview.vector, dim_RB); /* use IMGS */
+
+    /* check normalisation of generated orthogonal basis is not NaN (cause by a new orthogonal basis
+      having zero residual with the current basis) - if this is the case do not add the new basis. */
+    UINT4 isnan_norm = gsl_isnan(GSL_REAL(gsl_vector_complex_get(ru, dim_RB)));
+    gsl_vector_complex_free(ru);
+    if ( isnan_norm ){ break; }
+
+    /* add on next basis */
+    dims->data[0] = dim_RB+1;
+    dims->data[1] = cols;
+    RB = XLALResizeCOMPLEX16Array( RB, dims );
+    memcpy(&(RB->data[dim_RB*cols]), worst_row->data, cols*sizeof(COMPLEX16));
+    ++dim_RB;
+
+    if ( checkpoint != NULL ){
+      XLAL_CHECK_REAL8( complex_basis_write_checkpoint(checkpoint, RB, gpts, dim_RB, projection_norms2, worst_err) == XLAL_SUCCESS, XLAL_EFUNC );
+    }
+  }
+
+  *RBin = RB;
+  *greedypoints = XLALResizeUINT4Vector( gpts, dim_RB );
+
+  for ( size_t b=0; b<nblocks; b++ ){ XLALFree(names[b]); }
+  XLALFree(names);
+  XLALFree(blockrows);
+  XLALDestroyUINT4Vector(dims);
+  XLALDestroyREAL8Vector(projection_norms2);
+  XLALDestroyREAL8Vector(invnorms);
+  XLALDestroyCOMPLEX16Vector(worst_row);
+  XLALH5FileClose(file);
+
+  return worst_err;
+}
+
+
 /**
  * \brief Validate the real reduced basis against another set of waveforms
  *
@@ -1772,11 +2071,11 @@ LALInferenceCOMPLEXROQInterpolant *LALInferenceGenerateCOMPLEXROQInterpolant(COM
   size_t RBsize = RB->dimLength->data[0]; /* reduced basis size (no. of reduced bases) */
   size_t dlength = RB->dimLength->data[1]; /* length of each base */
   size_t i=1, j=0, k=0;
-  REAL8 *V = XLALMalloc(sizeof(COMPLEX16));
+  REAL8 *V = XLALMalloc(RBsize*RBsize*sizeof(COMPLEX16));
   gsl_matrix_complex_view Vview;
 
   LALInferenceCOMPLEXROQInterpolant *interp = XLALMalloc(sizeof(LALInferenceCOMPLEXROQInterpolant));
-  int idmax = 0, newidx = 0;
+  int idmax = 0;
 
   /* get index of maximum absolute value of first basis */
   gsl_matrix_complex_view RBview;
@@ -1787,9 +2086,16 @@ LALInferenceCOMPLEXROQInterpolant *LALInferenceGenerateCOMPLEXROQInterpolant(COM
   interp->nodes = XLALMalloc(RBsize*sizeof(UINT4));
   interp->nodes[0] = idmax;
 
+  gsl_vector_complex *coeffs, *subbasis;
+  gsl_permutation *perm;
+  XLAL_CALLGSL( coeffs = gsl_vector_complex_alloc(RBsize) );
+  XLAL_CALLGSL( subbasis = gsl_vector_complex_alloc(RBsize) );
+  XLAL_CALLGSL( perm = gsl_permutation_alloc(RBsize) );
+
   for ( i=1; i<RBsize; i++ ){
-    gsl_vector_complex *interpolant, *subbasis;
-    gsl_vector_complex_view subview;
+    gsl_vector_complex_view subview, coeffview, subbasisview;
+    gsl_permutation permview;
+    int signum;
 
     Vview = gsl_matrix_complex_view_array(V, i, i);
 
@@ -1799,37 +2105,57 @@ LALInferenceCOMPLEXROQInterpolant *LALInferenceGenerateCOMPLEXROQInterpolant(COM
       }
     }
 
-    /* get B matrix */
-    COMPLEX16Array *B = complex_B_matrix(&Vview.matrix, &RBview.matrix);
-    gsl_matrix_complex_view Bview;
-    Bview = gsl_matrix_complex_view_array((double *)B->data, B->dimLength->data[0], B->dimLength->data[1]);
-
-    /* make empirical interpolant of basis */
-    XLAL_CALLGSL( interpolant = gsl_vector_complex_calloc(dlength) );
-    XLAL_CALLGSL( subbasis = gsl_vector_complex_calloc(i) );
     XLAL_CALLGSL( subview = gsl_matrix_complex_row(&RBview.matrix, i) );
-
+    XLAL_CALLGSL( subbasisview = gsl_vector_complex_subvector(subbasis, 0, i) );
+    XLAL_CALLGSL( coeffview = gsl_vector_complex_subvector(coeffs, 0, i) );
     for ( k=0; k<i; k++ ){
-      XLAL_CALLGSL( gsl_vector_complex_set(subbasis, k, gsl_vector_complex_get(&subview.vector, interp->nodes[k])) );
+      XLAL_CALLGSL( gsl_vector_complex_set(&subbasisview.vector, k, gsl_vector_complex_get(&subview.vector, interp->nodes[k])) );
     }
 
-    XLAL_CALLGSL( gsl_blas_zgemv(CblasTrans, GSL_COMPLEX_ONE, &Bview.matrix, subbasis, GSL_COMPLEX_ZERO, interpolant) );
-
-    /* get residuals of interpolant */
-    XLAL_CALLGSL( gsl_vector_complex_sub(interpolant, &subview.vector) );
-
-    newidx = complex_vector_maxabs_index(interpolant);
+    /* the empirical interpolant of the new basis is sum_m c_m RB_m, with coefficients c from
+       solving V c = (new basis at the current nodes); this avoids forming the full interpolant
+       matrix at every iteration */
+    permview.size = i;
+    permview.data = perm->data;
+    XLAL_CALLGSL( gsl_linalg_complex_LU_decomp(&Vview.matrix, &permview, &signum) );
+    XLAL_CALLGSL( gsl_linalg_complex_LU_solve(&Vview.matrix, &permview, &subbasisview.vector, &coeffview.vector) );
+
+    /* find the largest residual of the interpolant, splitting the points between threads */
+    const COMPLEX16 *c = (const COMPLEX16 *)coeffs->data;
+    const COMPLEX16 *rbdata = RB->data;
+    REAL8 maxres = -INFINITY;
+    size_t newidx = 0;
+    #pragma omp parallel
+    {
+      REAL8 tmaxres = -INFINITY;
+      size_t tnewidx = 0;
+      #pragma omp for schedule(static)
+      for ( size_t x=0; x<dlength; x++ ){
+        COMPLEX16 res = -rbdata[i*dlength + x];
+        for ( size_t m=0; m<i; m++ ){ res += c[m]*rbdata[m*dlength + x]; }
+        REAL8 absres = cabs(res);
+        if ( absres > tmaxres ){
+          tmaxres = absres;
+          tnewidx = x;
+        }
+      }
+      /* keep the first of any equal maxima, as complex_vector_maxabs_index does */
+      #pragma omp critical
+      {
+        if ( tmaxres > maxres || (tmaxres == maxres && tnewidx < newidx) ){
+          maxres = tmaxres;
+          newidx = tnewidx;
+        }
+      }
+    }
 
     interp->nodes[i] = newidx;
-
-    XLAL_CALLGSL( gsl_vector_complex_free(subbasis) );
-    XLALDestroyCOMPLEX16Array( B );
-    XLAL_CALLGSL( gsl_vector_complex_free(interpolant) );
-
-    /* reallocate memory for V */
-    V = XLALRealloc(V, (i+1)*(i+1)*sizeof(COMPLEX16));
   }
 
+  XLAL_CALLGSL( gsl_vector_complex_free(coeffs) );
+  XLAL_CALLGSL( gsl_vector_complex_free(subbasis) );
+  XLAL_CALLGSL( gsl_permutation_free(perm) );
+
   /* get final B vector with all the indices */
   Vview = gsl_matrix_complex_view_array((double*)V, RBsize, RBsize);
   for( j=0; j<RBsize; j++ ){
@@ -65,6 +65,14 @@ REAL8 LALInferenceGenerateCOMPLEX16OrthonormalBasis(COMPLEX16Array **RB,
                                                     COMPLEX16Array **TS,
                                                     UINT4Vector **greedypoints);
 
+/* function to create a complex orthonormal basis set from a training set streamed from a HDF5 file */
+REAL8 LALInferenceGenerateCOMPLEX16OrthonormalBasisFromFile(COMPLEX16Array **RB,
+                                                            const REAL8Vector *delta,
+                                                            REAL8 tolerance,
+                                                            const CHAR *tsfile,
+                                                            const CHAR *checkpoint,
+                                                            UINT4Vector **greedypoints);
+
 /* functions to test the basis */
 void LALInferenceValidateREAL8OrthonormalBasis(REAL8Vector **projerr,
                                                const REAL8Vector *delta,
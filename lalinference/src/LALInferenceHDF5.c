@@ -303,6 +303,132 @@ int LALInferenceH5VariablesArrayToDataset(
 }
 
 
+int LALInferenceH5DEBufferToDataset(
+    LALH5File *h5file, const LALInferenceDEBuffer *buffer,
+    const char *TableName)
+{
+    /* Sanity check input */
+    if (!buffer)
+        XLAL_ERROR(XLAL_EFAULT, "Received null buffer pointer");
+    if (!h5file)
+        XLAL_ERROR(XLAL_EFAULT, "Received null h5file pointer");
+    if (buffer->length == 0 || buffer->layout->length == 0)
+        return 0;
+
+    /* One REAL8 column per parameter; the rows of the buffer are the rows of the table */
+    const UINT4 Ncol = buffer->layout->length;
+    const size_t type_size = Ncol * sizeof(REAL8);
+    const char *column_names[Ncol];
+    size_t column_offsets[Ncol];
+    size_t column_sizes[Ncol];
+    LALTYPECODE column_types[Ncol];
+    for (UINT4 j = 0; j < Ncol; j++)
+    {
+        column_names[j] = buffer->layout->names[j];
+        column_offsets[j] = j * sizeof(REAL8);
+        column_sizes[j] = sizeof(REAL8);
+        column_types[j] = LAL_D_TYPE_CODE;
+    }
+
+    LALH5Dataset *dataset = XLALH5TableAlloc(h5file, TableName, Ncol,
+        column_names, column_types, column_offsets, type_size);
+    XLAL_CHECK(dataset, XLAL_EFUNC);
+    int ret = XLALH5TableAppend(dataset, column_offsets, column_sizes,
+        buffer->length, type_size, buffer->data);
+    if (ret != 0)
+    {
+        XLALH5DatasetFree(dataset);
+        XLAL_ERROR(XLAL_EFUNC);
+    }
+
+    LALH5Generic gdataset = {.dset = dataset};
+    for (UINT4 i = 0; i < Ncol; i ++)
+    {
+        INT4 value = buffer->layout->vary[i];
+        char pname[] = "FIELD_NNN_VARY";
+        snprintf(pname, sizeof(pname), "FIELD_%d_VARY", i);
+        ret = XLALH5AttributeAddScalar(
+            gdataset, pname, &value, LAL_I4_TYPE_CODE);
+        assert(ret == 0);
+    }
+
+    XLALH5DatasetFree(dataset);
+    return XLAL_SUCCESS;
+}
+
+
+LALInferenceDEBuffer *LALInferenceH5DatasetToDEBuffer(LALH5Dataset *dataset)
+{
+    if (!dataset)
+        XLAL_ERROR_NULL(XLAL_EFAULT, "Received null dataset pointer");
+
+    size_t type_size = XLALH5TableQueryRowSize(dataset);
+    size_t Ncol = XLALH5TableQueryNColumns(dataset);
+    size_t Nsamples = XLALH5DatasetQueryNPoints(dataset);
+    LALH5Generic gdataset = {.dset = dataset};
+    int ret;
+
+    /* Describe the REAL8 columns as variables, to build the layout of the buffer */
+    LALInferenceVariables columns;
+    XLAL_INIT_MEM(columns);
+    char *column_names[Ncol > 0 ? Ncol : 1];
+    size_t column_offsets[Ncol > 0 ? Ncol : 1];
+    for (size_t i = 0; i < Ncol; i ++)
+    {
+        column_names[i] = NULL;
+        if (XLALH5TableQueryColumnType(dataset, i) != LAL_D_TYPE_CODE)
+            continue;
+        size_t column_name_len = XLALH5TableQueryColumnName(
+            NULL, 0, dataset, i);
+        column_names[i] = XLALMalloc(column_name_len + 1);
+        XLALH5TableQueryColumnName(
+            column_names[i], column_name_len + 1, dataset, i);
+        column_offsets[i] = XLALH5TableQueryColumnOffset(dataset, i);
+
+        char pname[] = "FIELD_NNN_VARY";
+        snprintf(pname, sizeof(pname), "FIELD_%zu_VARY", i);
+        INT4 vary;
+        ret = XLALH5AttributeQueryScalarValue(&vary, gdataset, pname);
+        assert(ret == 0);
+        REAL8 zero = 0;
+        LALInferenceAddVariable(&columns, column_names[i], &zero,
+            LALINFERENCE_REAL8_t, vary);
+    }
+
+    LALInferenceDEBuffer *buffer = LALInferenceCreateDEBuffer(&columns, Nsamples);
+    LALInferenceClearVariables(&columns);
+    if (!buffer)
+    {
+        for (size_t i = 0; i < Ncol; i++)
+            XLALFree(column_names[i]);
+        XLAL_ERROR_NULL(XLAL_EFUNC);
+    }
+
+    /* Offset in a table row of each column of the buffer */
+    const UINT4 Nbuf = buffer->layout->length;
+    size_t buffer_offsets[Nbuf > 0 ? Nbuf : 1];
+    for (UINT4 k = 0; k < Nbuf; k++)
+        for (size_t i = 0; i < Ncol; i++)
+            if (column_names[i] && !strcmp(column_names[i], buffer->layout->names[k]))
+                buffer_offsets[k] = column_offsets[i];
+    for (size_t i = 0; i < Ncol; i++)
+        XLALFree(column_names[i]);
+
+    char *data = XLALMalloc(XLALH5DatasetQueryNBytes(dataset));
+    assert(data);
+    ret = XLALH5DatasetQueryData(data, dataset);
+    assert(ret == 0);
+    for (size_t i = 0; i < Nsamples; i++)
+        for (UINT4 k = 0; k < Nbuf; k++)
+            memcpy(buffer->data + i * Nbuf + k,
+                data + type_size * i + buffer_offsets[k], sizeof(REAL8));
+    buffer->length = Nsamples;
+    XLALFree(data);
+
+    return buffer;
+}
+
+
 static void LALInferenceH5VariableToAttribute(
     LALH5Generic gdataset, LALInferenceVariables *vars, char *name)
 {
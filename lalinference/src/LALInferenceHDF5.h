@@ -30,6 +30,21 @@ int LALInferenceH5VariablesArrayToDataset(
 int LALInferenceH5DatasetToVariablesArray(
     LALH5Dataset *dataset, LALInferenceVariables ***varsArray, UINT4 *N);
 
+/**
+ * Write the points of a differential evolution buffer as one table,
+ * with a REAL8 column for each parameter
+ */
+int LALInferenceH5DEBufferToDataset(
+    LALH5File *h5file, const LALInferenceDEBuffer *buffer,
+    const char *TableName);
+
+/**
+ * Read a differential evolution buffer from a table written by
+ * LALInferenceH5DEBufferToDataset() or LALInferenceH5VariablesArrayToDataset().
+ * Only the varying REAL8 columns are kept.
+ */
+LALInferenceDEBuffer *LALInferenceH5DatasetToDEBuffer(LALH5Dataset *dataset);
+
 /**
  * Create a HDF5 heirarchy in the given LALH5File reference
  * /codename/runID/
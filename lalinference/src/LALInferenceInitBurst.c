@@ -240,6 +240,10 @@ LALInferenceModel * LALInferenceInitBurstModel(LALInferenceRunState *state)
   LALInferenceModel *model = XLALMalloc(sizeof(LALInferenceModel));
   model->params = XLALCalloc(1, sizeof(LALInferenceVariables));
   memset(model->params, 0, sizeof(LALInferenceVariables));
+  model->extrinsicCache = NULL;
+  model->stageTimer = NULL;
+  model->multiband = NULL;
+  model->multiband_flag = 0;
   LALInferenceVariables *currentParams=model->params;
 
   UINT4 signal_flag=1;
@@ -38,6 +38,7 @@
 #include <lal/LALInferenceReadData.h>
 #include <lal/LALInferenceInit.h>
 #include <lal/LALInferenceCalibrationErrors.h>
+#include <lal/LALInferenceMultibanding.h>
 #include <lal/LALSimNeutronStar.h>
 
 static int checkParamInList(const char *list, const char *param);
@@ -245,6 +246,34 @@ void LALInferenceInitCBCThreads(LALInferenceRunState *run_state, INT4 nthreads)
       thread->model->roq_flag=0;
     }
 
+    /* Setup multibanded likelihood */
+    thread->model->multiband_flag = 0;
+    if (LALInferenceGetProcParamVal(commandLine, "--multiband-likelihood")) {
+        REAL8 mc_min = 1.0/pow(2,0.2), mc_max, tc_min, tc_max; /* For min 1.0-1.0 waveform */
+        if (LALInferenceGetProcParamVal(commandLine, "--roqtime_steps")) {
+            fprintf(stderr, "ERROR: cannot use ROQ and multibanded likelihoods together.\n");
+            exit(1);
+        }
+        if (thread->model->templt != &LALInferenceTemplateXLALSimInspiralChooseWaveformPhaseInterpolated) {
+            fprintf(stderr, "ERROR: --multiband-likelihood requires --template multiband.\n");
+            exit(1);
+        }
+        if (LALInferenceCheckMinMaxPrior(run_state->priorArgs, "chirpmass"))
+            LALInferenceGetMinMaxPrior(run_state->priorArgs, "chirpmass", &mc_min, &mc_max);
+        if (LALInferenceCheckMinMaxPrior(run_state->priorArgs, "time"))
+            LALInferenceGetMinMaxPrior(run_state->priorArgs, "time", &tc_min, &tc_max);
+        else if (LALInferenceCheckMinMaxPrior(run_state->priorArgs, "t0"))
+            LALInferenceGetMinMaxPrior(run_state->priorArgs, "t0", &tc_min, &tc_max);
+        else {
+            fprintf(stderr, "ERROR: --multiband-likelihood needs a prior on the coalescence time.\n");
+            exit(1);
+        }
+        if (LALInferenceSetupMultibandLikelihood(thread->model, run_state->data, mc_min, tc_min) != XLAL_SUCCESS) {
+            fprintf(stderr, "ERROR: failed to set up the multibanded likelihood.\n");
+            exit(1);
+        }
+    }
+
     LALInferenceCopyVariables(thread->model->params, thread->currentParams);
     LALInferenceCopyVariables(run_state->proposalArgs, thread->proposalArgs);
 
@@ -299,6 +328,10 @@ LALInferenceTemplateFunction LALInferenceInitCBCTemplate(LALInferenceRunState *r
                     --template LALGenerateInspiral (for time-domain templates)\n\
                     --template LAL (for frequency-domain templates)\n");
   }
+  else if(LALInferenceGetProcParamVal(commandLine,"--multiband-likelihood")){
+    templt=&LALInferenceTemplateXLALSimInspiralChooseWaveformPhaseInterpolated;
+    fprintf(stdout,"Template function called is \"LALInferenceTemplateXLALSimInspiralChooseWaveformPhaseInterpolated\"\n");
+  }
   else if(LALInferenceGetProcParamVal(commandLine,"--roqtime_steps")){
   templt=&LALInferenceROQWrapperForXLALSimInspiralChooseFDWaveformSequence;
         fprintf(stderr, "template is \"LALInferenceROQWrapperForXLALSimInspiralChooseFDWaveformSequence\"\n");
@@ -755,6 +788,8 @@ LALInferenceModel *LALInferenceInitCBCModel(LALInferenceRunState *state) {
     (--no-detector-frame)              model will NOT use detector-centred coordinates and instead RA,dec\n\
     (--grtest-parameters dchi0,..,dxi1,..,dalpha1,..) template will assume deformations in the corresponding phase coefficients.\n\
     (--ppe-parameters aPPE1,....     template will assume the presence of an arbitrary number of PPE parameters. They must be paired correctly.\n\
+    (--waveform-cache-size N)       Maximum number of waveforms kept by the waveform cache of each thread (default 16; 1 keeps only the last one).\n\
+    (--waveform-cache-mem MiB)      Maximum memory held by the waveform cache of each thread, in MiB (default 256).\n\
 \n\
     ----------------------------------------------\n\
     --- Starting Parameters ----------------------\n\
@@ -900,6 +935,10 @@ LALInferenceModel *LALInferenceInitCBCModel(LALInferenceRunState *state) {
   model->params = XLALCalloc(1, sizeof(LALInferenceVariables));
   memset(model->params, 0, sizeof(LALInferenceVariables));
   model->eos_fam = NULL;
+  model->extrinsicCache = NULL;
+  model->stageTimer = NULL;
+  model->multiband = NULL;
+  model->multiband_flag = 0;
 
   UINT4 signal_flag=1;
   ppt = LALInferenceGetProcParamVal(commandLine, "--noiseonly");
@@ -1499,6 +1538,25 @@ LALInferenceModel *LALInferenceInitCBCModel(LALInferenceRunState *state) {
 
   /* Initialize waveform cache */
   model->waveformCache = XLALCreateSimInspiralWaveformCache();
+  UINT4 cacheSize = LAL_SIM_INSPIRAL_WAVEFORM_CACHE_DEFAULT_ENTRIES;
+  size_t cacheBytes = LAL_SIM_INSPIRAL_WAVEFORM_CACHE_DEFAULT_BYTES;
+  ppt=LALInferenceGetProcParamVal(commandLine, "--waveform-cache-size");
+  if (ppt) {
+    if (atoi(ppt->value) < 1) {
+      fprintf(stderr, "--waveform-cache-size must be at least 1, got %s\n", ppt->value);
+      exit(1);
+    }
+    cacheSize = atoi(ppt->value);
+  }
+  ppt=LALInferenceGetProcParamVal(commandLine, "--waveform-cache-mem");
+  if (ppt) {
+    if (!(atof(ppt->value) > 0)) {
+      fprintf(stderr, "--waveform-cache-mem must be positive, got %s\n", ppt->value);
+      exit(1);
+    }
+    cacheBytes = (size_t) (atof(ppt->value) * 1024 * 1024);
+  }
+  XLALSimInspiralWaveformCacheSetBudget(model->waveformCache, cacheSize, cacheBytes);
 
   return(model);
 }
@@ -22,6 +22,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include <gsl/gsl_randist.h>
@@ -41,6 +42,43 @@
 #define omp ignore
 #endif
 
+/* Maximum number of points in a leaf of the KDE ball tree */
+#define KDE_TREE_LEAF_SIZE 32
+
+/* Nodes of the ball tree whose kernels together cannot contribute more than
+ * exp(-KDE_TREE_LOG_TOL) of the density accumulated so far are skipped */
+#define KDE_TREE_LOG_TOL 40.0
+
+/* Node of the KDE ball tree, covering a contiguous range of the reordered points */
+typedef struct
+tagLALInferenceKDETreeNode
+{
+    INT4 start;         /* First point of the node */
+    INT4 end;           /* One past the last point of the node */
+    INT4 left;          /* Index of the left child, or -1 for a leaf */
+    INT4 right;         /* Index of the right child, or -1 for a leaf */
+    REAL8 radius;       /* Radius about the centroid enclosing every point of the node */
+} LALInferenceKDETreeNode;
+
+/* Ball tree over the whitened points of a KDE */
+struct
+tagLALInferenceKDETree
+{
+    INT4 dim;                       /* Dimension of the points */
+    INT4 npts;                      /* Number of points */
+    INT4 nnodes;                    /* Number of nodes in use */
+    REAL8 *points;                  /* npts x dim whitened points, ordered so nodes are contiguous */
+    REAL8 *centroids;               /* nnodes x dim node centroids */
+    LALInferenceKDETreeNode *nodes; /* Tree nodes, the root first */
+};
+
+static void KDEDestroyTree(struct tagLALInferenceKDETree *tree);
+static INT4 KDETreeBuildNode(struct tagLALInferenceKDETree *tree, INT4 start, INT4 end);
+static REAL8 KDETreeNodeBound(const struct tagLALInferenceKDETree *tree, INT4 n, const REAL8 *q);
+static void KDETreeAccumulate(const struct tagLALInferenceKDETree *tree, INT4 n, const REAL8 *q, REAL8 *lmax, REAL8 *sum);
+static void KDEWhitenPoint(LALInferenceKDE *kde, const REAL8 *point, REAL8 *white);
+static gsl_matrix *KDEBoundaryImages(LALInferenceKDE *kde, REAL8 *point);
+
 
 
 /**
@@ -200,6 +238,8 @@ void LALInferenceDestroyKDE(LALInferenceKDE *kde) {
         XLALFree(kde->lower_bounds);
         XLALFree(kde->upper_bounds);
 
+        KDEDestroyTree(kde->tree);
+
         XLALFree(kde);
     }
 }
@@ -284,30 +324,388 @@ void LALInferenceSetKDEBandwidth(LALInferenceKDE *kde) {
     kde->log_norm_factor =
         log(kde->npts * sqrt(pow(2*LAL_PI, kde->dim) * det_cov));
 
+    /* Whiten the data and index it for evaluation */
+    LALInferenceKDEBuildTree(kde);
+
     return;
 }
 
 
+/**
+ * Build the whitened ball tree used to evaluate a KDE.
+ *
+ * The points of the KDE are transformed by the inverse of the lower Cholesky
+ *  factor of the kernel covariance, so that every kernel becomes a unit
+ *  Gaussian, and stored contiguously in a ball tree.  Nodes far enough from an
+ *  evaluation point to make a negligible contribution can then be skipped
+ *  without visiting their points.  Called by LALInferenceSetKDEBandwidth(),
+ *  and must be called again if \a data is modified afterwards.
+ * @param[in] kde The kernel density estimate to index.
+ */
+void LALInferenceKDEBuildTree(LALInferenceKDE *kde) {
+    INT4 i;
+    INT4 dim = kde->dim;
+    INT4 npts = kde->npts;
+
+    KDEDestroyTree(kde->tree);
+    kde->tree = NULL;
+
+    if (npts == 0 || isinf(kde->log_norm_factor))
+        return;
+
+    struct tagLALInferenceKDETree *tree = XLALCalloc(1, sizeof(*tree));
+    tree->dim = dim;
+    tree->npts = npts;
+    tree->points = XLALMalloc(npts * dim * sizeof(REAL8));
+    tree->centroids = XLALMalloc(2 * npts * dim * sizeof(REAL8));
+    tree->nodes = XLALMalloc(2 * npts * sizeof(LALInferenceKDETreeNode));
+
+    for (i = 0; i < npts; i++) {
+        gsl_vector_view d = gsl_matrix_row(kde->data, i);
+        gsl_vector_view w = gsl_vector_view_array(tree->points + i*dim, dim);
+        gsl_vector_memcpy(&w.vector, &d.vector);
+        gsl_blas_dtrsv(CblasLower, CblasNoTrans, CblasNonUnit,
+                        kde->cholesky_decomp_cov_lower, &w.vector);
+    }
+
+    KDETreeBuildNode(tree, 0, npts);
+    kde->tree = tree;
+}
+
+
+/* Free a KDE ball tree */
+static void KDEDestroyTree(struct tagLALInferenceKDETree *tree) {
+    if (tree) {
+        XLALFree(tree->points);
+        XLALFree(tree->centroids);
+        XLALFree(tree->nodes);
+        XLALFree(tree);
+    }
+}
+
+
+/* Recursively build the node covering points [start, end), splitting along the
+ * widest dimension at its midrange.  Returns the index of the node. */
+static INT4 KDETreeBuildNode(struct tagLALInferenceKDETree *tree, INT4 start, INT4 end) {
+    INT4 i, p;
+    INT4 dim = tree->dim;
+    REAL8 *x = tree->points;
+    INT4 n = tree->nnodes++;
+    REAL8 *c = tree->centroids + n*dim;
+
+    tree->nodes[n].start = start;
+    tree->nodes[n].end = end;
+    tree->nodes[n].left = -1;
+    tree->nodes[n].right = -1;
+
+    /* Centroid and enclosing radius */
+    for (p = 0; p < dim; p++)
+        c[p] = 0.;
+    for (i = start; i < end; i++) {
+        for (p = 0; p < dim; p++)
+            c[p] += x[i*dim + p];
+    }
+    for (p = 0; p < dim; p++)
+        c[p] /= (REAL8)(end - start);
+
+    REAL8 r2max = 0.;
+    for (i = start; i < end; i++) {
+        REAL8 r2 = 0.;
+        for (p = 0; p < dim; p++)
+            r2 += (x[i*dim + p] - c[p]) * (x[i*dim + p] - c[p]);
+        if (r2 > r2max)
+            r2max = r2;
+    }
+    tree->nodes[n].radius = sqrt(r2max);
+
+    if (end - start <= KDE_TREE_LEAF_SIZE)
+        return n;
+
+    /* Find the widest dimension */
+    INT4 split_dim = 0;
+    REAL8 split_min = 0., split_max = 0.;
+    for (p = 0; p < dim; p++) {
+        REAL8 min = x[start*dim + p], max = min;
+        for (i = start + 1; i < end; i++) {
+            if (x[i*dim + p] < min) min = x[i*dim + p];
+            if (x[i*dim + p] > max) max = x[i*dim + p];
+        }
+        if (p == 0 || max - min > split_max - split_min) {
+            split_dim = p;
+            split_min = min;
+            split_max = max;
+        }
+    }
+
+    /* Identical points can't be split */
+    REAL8 split = (split_min + split_max) / 2.;
+    if (!(split_min < split && split < split_max))
+        return n;
+
+    /* Partition the points about the midrange */
+    INT4 lo = start, hi = end - 1;
+    while (lo <= hi) {
+        if (x[lo*dim + split_dim] < split) {
+            lo++;
+        } else {
+            for (p = 0; p < dim; p++) {
+                REAL8 tmp = x[lo*dim + p];
+                x[lo*dim + p] = x[hi*dim + p];
+                x[hi*dim + p] = tmp;
+            }
+            hi--;
+        }
+    }
+
+    INT4 left = KDETreeBuildNode(tree, start, lo);
+    INT4 right = KDETreeBuildNode(tree, lo, end);
+    tree->nodes[n].left = left;
+    tree->nodes[n].right = right;
+
+    return n;
+}
+
+
+/* Upper bound on the log of the summed (unnormalised) kernels of node n at the
+ * whitened point q */
+static REAL8 KDETreeNodeBound(const struct tagLALInferenceKDETree *tree, INT4 n, const REAL8 *q) {
+    INT4 p;
+    INT4 dim = tree->dim;
+    const REAL8 *c = tree->centroids + n*dim;
+
+    REAL8 r2 = 0.;
+    for (p = 0; p < dim; p++)
+        r2 += (q[p] - c[p]) * (q[p] - c[p]);
+
+    REAL8 dmin = sqrt(r2) - tree->nodes[n].radius;
+    if (dmin < 0.)
+        dmin = 0.;
+
+    return log((REAL8)(tree->nodes[n].end - tree->nodes[n].start)) - dmin*dmin/2.;
+}
+
+
+/* Add the kernels of node n at the whitened point q to the running sum, held as
+ * lmax + log(sum).  The nearer child is visited first, so that distant nodes can
+ * be skipped once their bound falls below the tolerance. */
+static void KDETreeAccumulate(const struct tagLALInferenceKDETree *tree, INT4 n, const REAL8 *q, REAL8 *lmax, REAL8 *sum) {
+    INT4 i, p;
+    INT4 dim = tree->dim;
+    const LALInferenceKDETreeNode *node = &tree->nodes[n];
+
+    if (node->left < 0) {
+        REAL8 energies[KDE_TREE_LEAF_SIZE];
+
+        for (INT4 first = node->start; first < node->end; first += KDE_TREE_LEAF_SIZE) {
+            INT4 count = node->end - first;
+            if (count > KDE_TREE_LEAF_SIZE)
+                count = KDE_TREE_LEAF_SIZE;
+            const REAL8 *x = tree->points + first*dim;
+
+            /* Contiguous loops over the leaf, which the compiler can vectorise */
+            for (i = 0; i < count; i++) {
+                REAL8 r2 = 0.;
+                for (p = 0; p < dim; p++) {
+                    REAL8 d = x[i*dim + p] - q[p];
+                    r2 += d*d;
+                }
+                energies[i] = -r2/2.;
+            }
+
+            REAL8 m = *lmax;
+            for (i = 0; i < count; i++) {
+                if (energies[i] > m)
+                    m = energies[i];
+            }
+            if (m > *lmax) {
+                *sum *= exp(*lmax - m);
+                *lmax = m;
+            }
+
+            REAL8 s = 0.;
+            for (i = 0; i < count; i++)
+                s += exp(energies[i] - m);
+            *sum += s;
+        }
+        return;
+    }
+
+    REAL8 left_bound = KDETreeNodeBound(tree, node->left, q);
+    REAL8 right_bound = KDETreeNodeBound(tree, node->right, q);
+    INT4 first = node->left, second = node->right;
+    REAL8 first_bound = left_bound, second_bound = right_bound;
+    if (right_bound > left_bound) {
+        first = node->right;
+        second = node->left;
+        first_bound = right_bound;
+        second_bound = left_bound;
+    }
+
+    if (first_bound >= *lmax + log(*sum) - KDE_TREE_LOG_TOL)
+        KDETreeAccumulate(tree, first, q, lmax, sum);
+    if (second_bound >= *lmax + log(*sum) - KDE_TREE_LOG_TOL)
+        KDETreeAccumulate(tree, second, q, lmax, sum);
+}
+
+
+/* Transform a point by the inverse lower Cholesky factor of the kernel covariance */
+static void KDEWhitenPoint(LALInferenceKDE *kde, const REAL8 *point, REAL8 *white) {
+    memcpy(white, point, kde->dim * sizeof(REAL8));
+    gsl_vector_view w = gsl_vector_view_array(white, kde->dim);
+    gsl_blas_dtrsv(CblasLower, CblasNoTrans, CblasNonUnit,
+                    kde->cholesky_decomp_cov_lower, &w.vector);
+}
+
+
 /**
  * Evaluate the (log) PDF from a KDE at a single point.
  *
  * Calculate the (log) value of the probability density function estimate from
- * a kernel density estimate at a single point.
+ * a kernel density estimate at a single point.  The kernels are summed over the
+ * whitened ball tree built by LALInferenceKDEBuildTree(), skipping nodes whose
+ * combined contribution is below exp(-40) of the total found so far.
  * @param[in] kde   The kernel density estimate to evaluate.
  * @param[in] point An array containing the point to evaluate the PDF at.
  * @return The value of the estimated probability density function at \a point.
+ * \sa LALInferenceKDEEvaluatePointDirect()
  */
 REAL8 LALInferenceKDEEvaluatePoint(LALInferenceKDE *kde, REAL8 *point) {
+    INT4 dim = kde->dim;
+    INT4 i;
+
+    /* If the normalization is infinite, don't bother calculating anything */
+    if (isinf(kde->log_norm_factor))
+        return -INFINITY;
+
+    if (kde->tree == NULL)
+        return LALInferenceKDEEvaluatePointDirect(kde, point);
+
+    /* Repeat point across any imposed cyclic or reflective boundaries */
+    gsl_matrix *points = KDEBoundaryImages(kde, point);
+    if (points == NULL)
+        return -INFINITY;
+    INT4 n_evals = points->size1;
+
+    REAL8 white[dim];
+    REAL8 eval_results[n_evals];
+
+    for (i = 0; i < n_evals; i++) {
+        REAL8 lmax = -INFINITY, sum = 0.;
+        KDEWhitenPoint(kde, gsl_matrix_const_ptr(points, i, 0), white);
+        KDETreeAccumulate(kde->tree, 0, white, &lmax, &sum);
+        eval_results[i] = lmax + log(sum) - kde->log_norm_factor;
+    }
+
+    /* Accumulate probability after accounting for all boundaries */
+    REAL8 result = log_add_exps(eval_results, n_evals);
+
+    gsl_matrix_free(points);
+
+    return result;
+}
+
+
+/**
+ * Evaluate the (log) PDF from a KDE at an array of points.
+ *
+ * Evaluate LALInferenceKDEEvaluatePoint() at each of \a npoints points, in
+ * parallel when OpenMP is available.
+ * @param[in]  kde     The kernel density estimate to evaluate.
+ * @param[in]  points  Array of \a npoints points, each of dimension kde->dim.
+ * @param[in]  npoints The number of points in \a points.
+ * @param[out] results Array of length \a npoints to store the (log) PDF in.
+ */
+void LALInferenceKDEEvaluatePoints(LALInferenceKDE *kde, REAL8 *points, INT4 npoints, REAL8 *results) {
+    INT4 i;
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (i = 0; i < npoints; i++)
+        results[i] = LALInferenceKDEEvaluatePoint(kde, points + i*kde->dim);
+}
+
+
+/**
+ * Evaluate the (log) PDF from a KDE at a single point, summing every kernel directly.
+ *
+ * Reference implementation of LALInferenceKDEEvaluatePoint(), which evaluates
+ * every kernel in the dataset using the Cholesky decomposition of the covariance.
+ * @param[in] kde   The kernel density estimate to evaluate.
+ * @param[in] point An array containing the point to evaluate the PDF at.
+ * @return The value of the estimated probability density function at \a point.
+ */
+REAL8 LALInferenceKDEEvaluatePointDirect(LALInferenceKDE *kde, REAL8 *point) {
     INT4 dim = kde->dim;
     INT4 npts = kde->npts;
-    INT4 i, j, p;
-    INT4 n_evals = 1;  // Number of evaluations to be done
-    REAL8 min, max, width, val;
+    INT4 i, j;
 
     /* If the normalization is infinite, don't bother calculating anything */
     if (isinf(kde->log_norm_factor))
         return -INFINITY;
 
+    /* Repeat point across any imposed cyclic or reflective boundaries */
+    gsl_matrix *points = KDEBoundaryImages(kde, point);
+    if (points == NULL)
+        return -INFINITY;
+    INT4 n_evals = points->size1;
+
+    /* Loop over list of reflected and cycled points */
+    REAL8* results = XLALMalloc(npts * sizeof(REAL8));
+    REAL8* eval_results = XLALMalloc(n_evals * sizeof(REAL8));
+
+    /* Loop over reflected and cycled set of points */
+    for (i = 0; i < n_evals; i++) {
+        gsl_vector_view pt = gsl_matrix_row(points, i);
+
+        /* Loop over points in KDE dataset, using the Cholesky decomposition
+         * of the covariance to avoid ever inverting the covariance matrix */
+        #pragma omp parallel
+        {
+            /* Vectors that will hold the difference and transformed distance */
+            gsl_vector *diff = gsl_vector_alloc(dim);
+            gsl_vector *tdiff = gsl_vector_alloc(dim);
+
+            #pragma omp for schedule(static)
+            for (j = 0; j < npts; j++) {
+                gsl_vector_view d = gsl_matrix_row(kde->data, j);
+                gsl_vector_memcpy(diff, &d.vector);
+
+                gsl_vector_sub(diff, &pt.vector);
+                gsl_linalg_cholesky_solve(kde->cholesky_decomp_cov, diff, tdiff);
+                gsl_vector_mul(diff, tdiff);
+
+                REAL8 energy = 0.;
+                for (INT4 k=0; k<dim; k++)
+                    energy += gsl_vector_get(diff, k);
+                results[j] = -energy/2.;
+            }
+
+            gsl_vector_free(diff);
+            gsl_vector_free(tdiff);
+        }
+
+        /* Normalize the result */
+        eval_results[i] = log_add_exps(results, npts) - kde->log_norm_factor;
+    }
+
+    /* Accumulate probability after accounting for all boundaries */
+    REAL8 result = log_add_exps(eval_results, n_evals);
+
+    gsl_matrix_free(points);
+    XLALFree(results);
+    XLALFree(eval_results);
+
+    return result;
+}
+
+
+/* Copies of a point reflected or cycled across the imposed boundaries of a KDE,
+ * the point itself first.  Returns NULL if the point is outside a fixed boundary. */
+static gsl_matrix *KDEBoundaryImages(LALInferenceKDE *kde, REAL8 *point) {
+    INT4 dim = kde->dim;
+    INT4 i, p;
+    INT4 n_evals = 1;  // Number of evaluations to be done
+    REAL8 min, max, width, val;
+
     gsl_vector_view x = gsl_vector_view_array(point, dim);
 
     /* If the point is outside the bounding box, return */
@@ -320,7 +718,7 @@ REAL8 LALInferenceKDEEvaluatePoint(LALInferenceKDE *kde, REAL8 *point) {
                     val < min) ||
             (kde->upper_bound_types[p] == LALINFERENCE_PARAM_FIXED &&
                     val > max))
-            return -INFINITY;
+            return NULL;
     }
 
     /* Repeat point across any imposed cyclic or reflective boundaries */
@@ -368,53 +766,7 @@ REAL8 LALInferenceKDEEvaluatePoint(LALInferenceKDE *kde, REAL8 *point) {
         }
     }
 
-    /* Loop over list of reflected and cycled points */
-    REAL8* results = XLALMalloc(npts * sizeof(REAL8));
-    REAL8* eval_results = XLALMalloc(n_evals * sizeof(REAL8));
-
-    /* Loop over reflected and cycled set of points */
-    for (i = 0; i < n_evals; i++) {
-        gsl_vector_view pt = gsl_matrix_row(points, i);
-
-        /* Loop over points in KDE dataset, using the Cholesky decomposition
-         * of the covariance to avoid ever inverting the covariance matrix */
-        #pragma omp parallel
-        {
-            /* Vectors that will hold the difference and transformed distance */
-            gsl_vector *diff = gsl_vector_alloc(dim);
-            gsl_vector *tdiff = gsl_vector_alloc(dim);
-
-            #pragma omp for schedule(static)
-            for (j = 0; j < npts; j++) {
-                gsl_vector_view d = gsl_matrix_row(kde->data, j);
-                gsl_vector_memcpy(diff, &d.vector);
-
-                gsl_vector_sub(diff, &pt.vector);
-                gsl_linalg_cholesky_solve(kde->cholesky_decomp_cov, diff, tdiff);
-                gsl_vector_mul(diff, tdiff);
-
-                REAL8 energy = 0.;
-                for (INT4 k=0; k<dim; k++)
-                    energy += gsl_vector_get(diff, k);
-                results[j] = -energy/2.;
-            }
-
-            gsl_vector_free(diff);
-            gsl_vector_free(tdiff);
-        }
-
-        /* Normalize the result */
-        eval_results[i] = log_add_exps(results, npts) - kde->log_norm_factor;
-    }
-
-    /* Accumulate probability after accounting for all boundaries */
-    REAL8 result = log_add_exps(eval_results, n_evals);
-
-    gsl_matrix_free(points);
-    XLALFree(results);
-    XLALFree(eval_results);
-
-    return result;
+    return points;
 }
 
 
@@ -40,6 +40,7 @@
 #include <gsl/gsl_sf_erf.h>
 #include <gsl/gsl_complex_math.h>
 #include <lal/LALInferenceTemplate.h>
+#include <lal/LALInferenceMultibanding.h>
 
 #include "logaddexp.h"
 
@@ -117,6 +118,7 @@ void LALInferenceInitLikelihood(LALInferenceRunState *runState)
     (--margtimephi)                  Using marginalised in time and phase likelihood\n\
     (--margdist)                     Using marginalisation in distance with d^2 prior (compatible with --margphi and --margtimephi)\n\
     (--margdist-comoving)            Using marginalisation in distance with uniform-in-comoving-volume prior (compatible with --margphi and --margtimephi)\n\
+    (--multiband-likelihood)         Evaluate CBC templates on a multibanded frequency grid and use precomputed weights (not compatible with time marginalisation)\n\
     \n";
 
     /* Print command line arguments if help requested */
@@ -274,6 +276,147 @@ static int checkItemAndAdd(void *item, void **array)
   return 0;
 }
 
+/* Number of phase ramp elements rotated from each directly computed base phase */
+#define PHASE_RAMP_BLOCK 64
+
+/* Fill ramp[k] = exp(-i theta (lower+k)) for k=0..n-1. Each block of    */
+/* PHASE_RAMP_BLOCK elements is a directly computed base phase times a    */
+/* shared table of in-block rotations, so every element is one            */
+/* independent complex multiply (which vectorises) and, unlike a          */
+/* recurrence, rounding errors do not accumulate along the ramp.          */
+static void ComputePhaseRamp(COMPLEX16 *ramp, INT4 n, REAL8 theta, INT4 lower);
+static void ComputePhaseRamp(COMPLEX16 *ramp, INT4 n, REAL8 theta, INT4 lower)
+{
+  REAL8 wre[PHASE_RAMP_BLOCK], wim[PHASE_RAMP_BLOCK];
+  INT4 b, j, m;
+  INT4 nw = n < PHASE_RAMP_BLOCK ? n : PHASE_RAMP_BLOCK;
+
+  for(j=0;j<nw;j++)
+  {
+    wre[j] = cos(theta*j);
+    wim[j] = -sin(theta*j);
+  }
+
+  for(b=0;b<n;b+=PHASE_RAMP_BLOCK)
+  {
+    REAL8 phi = theta*(lower+b);
+    REAL8 bre = cos(phi);
+    REAL8 bim = -sin(phi);
+    COMPLEX16 *out = ramp + b;
+    m = n-b < PHASE_RAMP_BLOCK ? n-b : PHASE_RAMP_BLOCK;
+    for(j=0;j<m;j++)
+      out[j] = crect(bre*wre[j] - bim*wim[j], bre*wim[j] + bim*wre[j]);
+  }
+}
+
+void LALInferenceDestroyExtrinsicCache(LALInferenceExtrinsicCache *cache)
+{
+  INT4 i;
+  if(!cache) return;
+  if(cache->ifo)
+  {
+    for(i=0;i<cache->nifo;i++)
+      if(cache->ifo[i].phaseRamp) XLALDestroyCOMPLEX16Vector(cache->ifo[i].phaseRamp);
+    XLALFree(cache->ifo);
+  }
+  XLALFree(cache);
+}
+
+/* Return the model's extrinsic cache, (re)creating it for nifo IFOs if needed */
+static LALInferenceExtrinsicCache *GetExtrinsicCache(LALInferenceModel *model, INT4 nifo);
+static LALInferenceExtrinsicCache *GetExtrinsicCache(LALInferenceModel *model, INT4 nifo)
+{
+  if(model->extrinsicCache && model->extrinsicCache->nifo==nifo)
+    return model->extrinsicCache;
+
+  LALInferenceDestroyExtrinsicCache(model->extrinsicCache);
+  model->extrinsicCache = XLALCalloc(1, sizeof(LALInferenceExtrinsicCache));
+  if(!model->extrinsicCache) XLAL_ERROR_NULL(XLAL_ENOMEM);
+  model->extrinsicCache->nifo = nifo;
+  model->extrinsicCache->ifo = XLALCalloc(nifo, sizeof(LALInferenceIFOExtrinsicCache));
+  if(!model->extrinsicCache->ifo)
+  {
+    LALInferenceDestroyExtrinsicCache(model->extrinsicCache);
+    model->extrinsicCache = NULL;
+    XLAL_ERROR_NULL(XLAL_ENOMEM);
+  }
+  return model->extrinsicCache;
+}
+
+/* Antenna response and geocentre time delay of an IFO, reusing the stored */
+/* values if the sky location, polarisation and time are unchanged          */
+static void ExtrinsicCacheResponse(LALInferenceExtrinsicCache *cache, INT4 ifo, LALInferenceIFOData *dataPtr,
+                                   REAL8 ra, REAL8 dec, REAL8 psi, REAL8 gmst, const LIGOTimeGPS *gps,
+                                   REAL8 *fPlus, REAL8 *fCross, REAL8 *timedelay);
+static void ExtrinsicCacheResponse(LALInferenceExtrinsicCache *cache, INT4 ifo, LALInferenceIFOData *dataPtr,
+                                   REAL8 ra, REAL8 dec, REAL8 psi, REAL8 gmst, const LIGOTimeGPS *gps,
+                                   REAL8 *fPlus, REAL8 *fCross, REAL8 *timedelay)
+{
+  LALInferenceIFOExtrinsicCache *entry = &(cache->ifo[ifo]);
+  REAL8 gpsdouble = XLALGPSGetREAL8(gps);
+
+  cache->responseCalls++;
+  if(entry->responseValid && entry->ra==ra && entry->dec==dec && entry->psi==psi
+     && entry->gmst==gmst && entry->gps==gpsdouble)
+  {
+    cache->responseHits++;
+  }
+  else
+  {
+    XLALComputeDetAMResponse(&(entry->fPlus), &(entry->fCross), (const REAL4(*)[3])dataPtr->detector->response, ra, dec, psi, gmst);
+    entry->timedelay = XLALTimeDelayFromEarthCenter(dataPtr->detector->location, ra, dec, gps);
+    entry->ra = ra;
+    entry->dec = dec;
+    entry->psi = psi;
+    entry->gmst = gmst;
+    entry->gps = gpsdouble;
+    entry->responseValid = 1;
+  }
+
+  *fPlus = entry->fPlus;
+  *fCross = entry->fCross;
+  *timedelay = entry->timedelay;
+}
+
+/* Phase factors exp(-i twopit f) for frequency bins lower..upper of an IFO, */
+/* reusing the stored ramp if the time shift and binning are unchanged       */
+static const COMPLEX16 *ExtrinsicCachePhaseRamp(LALInferenceExtrinsicCache *cache, INT4 ifo,
+                                                REAL8 twopit, REAL8 deltaF, INT4 lower, INT4 upper);
+static const COMPLEX16 *ExtrinsicCachePhaseRamp(LALInferenceExtrinsicCache *cache, INT4 ifo,
+                                                REAL8 twopit, REAL8 deltaF, INT4 lower, INT4 upper)
+{
+  LALInferenceIFOExtrinsicCache *entry = &(cache->ifo[ifo]);
+  INT4 n = upper - lower + 1;
+
+  if(n<=0) return NULL;
+
+  cache->rampCalls++;
+  if(entry->phaseRamp && (INT4)entry->phaseRamp->length==n && entry->lower==lower
+     && entry->twopit==twopit && entry->deltaF==deltaF)
+  {
+    cache->rampHits++;
+    return entry->phaseRamp->data;
+  }
+
+  if(entry->phaseRamp && (INT4)entry->phaseRamp->length!=n)
+  {
+    XLALDestroyCOMPLEX16Vector(entry->phaseRamp);
+    entry->phaseRamp = NULL;
+  }
+  if(!entry->phaseRamp)
+  {
+    entry->phaseRamp = XLALCreateCOMPLEX16Vector(n);
+    if(!entry->phaseRamp) XLAL_ERROR_NULL(XLAL_ENOMEM);
+  }
+
+  ComputePhaseRamp(entry->phaseRamp->data, n, twopit*deltaF, lower);
+  entry->twopit = twopit;
+  entry->deltaF = deltaF;
+  entry->lower = lower;
+
+  return entry->phaseRamp->data;
+}
+
 /* ============ Likelihood computations: ========== */
 
 /**
@@ -321,6 +464,94 @@ REAL8 LALInferenceUndecomposedFreqDomainLogLikelihood(LALInferenceVariables *cur
                                                   GAUSSIAN);
 }
 
+static void DestroyNoiseWeights(LALInferenceIFOData *data);
+static void DestroyNoiseWeights(LALInferenceIFOData *data)
+{
+  LALInferenceIFOData *dataPtr;
+  for(dataPtr=data; dataPtr; dataPtr=dataPtr->next)
+  {
+    if(dataPtr->noiseWeights) XLALDestroyREAL8FrequencySeries(dataPtr->noiseWeights);
+    dataPtr->noiseWeights = NULL;
+  }
+}
+
+/* Fill dataPtr->noiseWeights with the per-bin noise weighting of the */
+/* likelihood sums, which depends only on the PSD and frequency grid   */
+static int PrepareNoiseWeights(LALInferenceIFOData *data);
+static int PrepareNoiseWeights(LALInferenceIFOData *data)
+{
+  LALInferenceIFOData *dataPtr;
+  INT4 i, lower, upper;
+  REAL8 deltaT, deltaF, TwoDeltaToverN;
+
+  DestroyNoiseWeights(data);
+  for(dataPtr=data; dataPtr; dataPtr=dataPtr->next)
+  {
+    if(!dataPtr->timeData || !dataPtr->oneSidedNoisePowerSpectrum) continue;
+    deltaT = dataPtr->timeData->deltaT;
+    deltaF = 1.0 / (((double)dataPtr->timeData->data->length) * deltaT);
+    lower = (UINT4)ceil(dataPtr->fLow / deltaF);
+    upper = (UINT4)floor(dataPtr->fHigh / deltaF);
+    TwoDeltaToverN = 2.0 * deltaT / ((double) dataPtr->timeData->data->length);
+    if(upper<lower) continue;
+
+    dataPtr->noiseWeights = XLALCreateREAL8FrequencySeries("noise weights", &(dataPtr->oneSidedNoisePowerSpectrum->epoch),
+                                                           lower*deltaF, deltaF, &lalDimensionlessUnit, upper-lower+1);
+    if(!dataPtr->noiseWeights) XLAL_ERROR(XLAL_EFUNC);
+    for(i=lower;i<=upper;i++)
+      dataPtr->noiseWeights->data->data[i-lower] = TwoDeltaToverN / (dataPtr->oneSidedNoisePowerSpectrum->data->data[i]*deltaT*deltaT);
+  }
+  return XLAL_SUCCESS;
+}
+
+INT4 LALInferenceBatchedLogLikelihood(LALInferenceLikelihoodFunction likelihood,
+                                      LALInferenceVariables **params,
+                                      LALInferenceIFOData *data,
+                                      LALInferenceModel **models,
+                                      const REAL8 *logPriors,
+                                      REAL8 *logLikelihoods,
+                                      INT4 nbatch)
+/***************************************************************/
+/* Evaluate `likelihood' for a batch of parameter sets.        */
+/* Entry i is computed with its own model buffers models[i];   */
+/* the data and PSDs are only read, so entries are spread over */
+/* OpenMP threads. Entries whose log-prior is not finite are   */
+/* skipped and given -INFINITY.                                */
+/***************************************************************/
+{
+  INT4 i, j;
+
+  XLAL_CHECK(likelihood != NULL, XLAL_EFAULT);
+  XLAL_CHECK(params != NULL && models != NULL && logLikelihoods != NULL, XLAL_EFAULT);
+  XLAL_CHECK(nbatch >= 0, XLAL_EINVAL);
+
+  /* Template buffers are written during evaluation, so they cannot be shared */
+  for (i = 0; i < nbatch; i++) {
+    XLAL_CHECK(params[i] != NULL && models[i] != NULL, XLAL_EFAULT);
+    for (j = 0; j < i; j++)
+      XLAL_CHECK(models[i] != models[j], XLAL_EINVAL, "Batch entries %i and %i share a model", j, i);
+  }
+
+  /* The PSD weighting is the same for every entry, so compute it once */
+  if (PrepareNoiseWeights(data) != XLAL_SUCCESS) {
+    DestroyNoiseWeights(data);
+    XLAL_ERROR(XLAL_EFUNC);
+  }
+
+  /* Template generation times vary across parameter space, so hand out entries dynamically */
+  #pragma omp parallel for schedule(dynamic)
+  for (i = 0; i < nbatch; i++) {
+    if (logPriors && !isfinite(logPriors[i]))
+      logLikelihoods[i] = -INFINITY;
+    else
+      logLikelihoods[i] = likelihood(params[i], data, models[i]);
+  }
+
+  DestroyNoiseWeights(data);
+
+  return XLAL_SUCCESS;
+}
+
 
 static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *currentParams,
                                                         LALInferenceIFOData *data,
@@ -345,13 +576,14 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
   //REAL8 templateReal=0.0, templateImag=0.0;
   int i, j, lower, upper, ifo;
   LALInferenceIFOData *dataPtr;
+  REAL8 stageStart=0.0;
   double ra=0.0, dec=0.0, psi=0.0, gmst=0.0;
   double GPSdouble=0.0, t0=0.0;
   LIGOTimeGPS GPSlal;
   double chisquared;
   double timedelay;  /* time delay b/w iterferometer & geocenter w.r.t. sky location */
   double timeshift=0;  /* time shift (not necessarily same as above)                   */
-  double deltaT, TwoDeltaToverN, deltaF, twopit=0.0, re, im, dre, dim, newRe, newIm;
+  double deltaT, TwoDeltaToverN, deltaF, twopit=0.0;
   double timeTmp;
   double mc;
   /* Burst templates are generated at hrss=1, thus need to rescale amplitude */
@@ -402,6 +634,10 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
     fprintf(stderr,"ERROR: cannot use ROQ likelihood and constant calibration error marginalization together. Exiting...\n");
     exit(1);
   }
+  if (model->multiband_flag && constantcal_active){
+    fprintf(stderr,"ERROR: cannot use multibanded likelihood and constant calibration error marginalization together. Exiting...\n");
+    exit(1);
+  }
 
   REAL8 degreesOfFreedom=2.0;
   REAL8 chisq=0.0;
@@ -418,6 +654,8 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
     margtime=1;
 
   if(model->roq_flag && margtime) XLAL_ERROR_REAL8(XLAL_EINVAL,"ROQ does not support time marginalisation");
+  if(model->multiband_flag && (margtime || marginalisationflags==STUDENTT))
+    XLAL_ERROR_REAL8(XLAL_EINVAL,"Multibanded likelihood does not support time marginalisation or the Student-t likelihood");
 
   
   LALStatus status;
@@ -428,6 +666,8 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
   int Nifos=0;
   for(dataPtr=data;dataPtr;dataPtr=dataPtr->next) Nifos++;
   void *generatedFreqModels[1+Nifos];
+  LALInferenceExtrinsicCache *extrinsicCache = GetExtrinsicCache(model, Nifos);
+  if(!extrinsicCache) XLAL_ERROR_REAL8(XLAL_EFUNC);
   for(i=0;i<=Nifos;i++) generatedFreqModels[i]=NULL;
 
   //noise model meta parameters
@@ -476,6 +716,9 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
   if(LALInferenceCheckVariable(currentParams, "signalModelFlag"))
     signalFlag = *((INT4 *)LALInferenceGetVariable(currentParams, "signalModelFlag"));
 
+  if(model->multiband_flag && (psdFlag || glitchFlag))
+    XLAL_ERROR_REAL8(XLAL_EINVAL,"Multibanded likelihood does not support PSD or glitch fitting");
+
   int freq_length=0,time_length=0;
   COMPLEX16Vector * dh_S_tilde=NULL;
   COMPLEX16Vector * dh_S_phase_tilde = NULL;
@@ -641,7 +884,9 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
         if(LALInferenceCheckVariable(model->params,"time")) LALInferenceRemoveVariable(model->params,"time");
         LALInferenceAddVariable(model->params, "time", &timeTmp, LALINFERENCE_REAL8_t,LALINFERENCE_PARAM_LINEAR);
 
+        stageStart=LALInferenceStageTimerStart(model);
         XLAL_TRY(model->templt(model),errnum);
+        LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_WAVEFORM, stageStart);
         errnum&=~XLAL_EFUNC;
         if(errnum!=XLAL_SUCCESS)
         {
@@ -673,7 +918,9 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
 
         if (model->domain == LAL_SIM_DOMAIN_TIME) {
           /* TD --> FD. */
+          stageStart=LALInferenceStageTimerStart(model);
           LALInferenceExecuteFT(model);
+          LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_FFT, stageStart);
         }
       }
 
@@ -682,6 +929,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
         /* Calibration stuff if necessary */
         /*spline*/
         if (spcal_active) {
+          stageStart=LALInferenceStageTimerStart(model);
           logfreqs = NULL;
           amps = NULL;
           phases = NULL;
@@ -696,6 +944,15 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
 						&(model->roq->calFactorQuadratic));
 	  }
 
+	  else if (model->multiband_flag) {
+
+             LALInferenceSplineCalibrationFactorROQ(logfreqs, amps, phases,
+						model->multiband->frequencies,
+						&(model->multiband->calFactor),
+						model->multiband->frequencies,
+						&(model->multiband->calFactor));
+	  }
+
 	  else{
 	    if (calFactor == NULL) {
 	      calFactor = XLALCreateCOMPLEX16FrequencySeries("calibration factors",
@@ -709,7 +966,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
 	if(logfreqs) XLALDestroyREAL8Vector(logfreqs);
 	if(amps) XLALDestroyREAL8Vector(amps);
 	if(phases) XLALDestroyREAL8Vector(phases);
-
+          LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_CALIBRATION, stageStart);
         }
         /*constant*/
         if (constantcal_active){
@@ -728,11 +985,12 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
           cos_calpha=cos(calpha);
           sin_calpha=-sin(calpha);
         }
-        /* determine beam pattern response (F_plus and F_cross) for given Ifo: */
-        XLALComputeDetAMResponse(&Fplus, &Fcross, (const REAL4(*)[3])dataPtr->detector->response, ra, dec, psi, gmst);
-
-        /* signal arrival time (relative to geocenter); */
-        timedelay = XLALTimeDelayFromEarthCenter(dataPtr->detector->location, ra, dec, &GPSlal);
+        /* determine beam pattern response (F_plus and F_cross) and signal */
+        /* arrival time (relative to geocenter) for given Ifo:            */
+        stageStart=LALInferenceStageTimerStart(model);
+        ExtrinsicCacheResponse(extrinsicCache, ifo, dataPtr, ra, dec, psi, gmst, &GPSlal,
+                               &Fplus, &Fcross, &timedelay);
+        LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_PROJECTION, stageStart);
         /* (negative timedelay means signal arrives earlier at Ifo than at geocenter, etc.) */
         /* amount by which to time-shift template (not necessarily same as above "timedelay"): */
         if (margtime)
@@ -747,10 +1005,6 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
         /* For burst, add the right hrss in the amplitude. */
         Fplus*=amp_prefactor;
         Fcross*=amp_prefactor;
-
-        dataPtr->fPlus = Fplus;
-        dataPtr->fCross = Fcross;
-        dataPtr->timeshift = timeshift;
     }//end signalFlag condition
 
     /* determine frequency range & loop over frequency bins: */
@@ -760,25 +1014,6 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
     upper = (UINT4)floor(dataPtr->fHigh / deltaF);
     TwoDeltaToverN = 2.0 * deltaT / ((double) dataPtr->timeData->data->length);
 
-    /* Employ a trick here for avoiding cos(...) and sin(...) in time
-       shifting.  We need to multiply each template frequency bin by
-       exp(-J*twopit*deltaF*i) = exp(-J*twopit*deltaF*(i-1)) +
-       exp(-J*twopit*deltaF*(i-1))*(exp(-J*twopit*deltaF) - 1) .  This
-       recurrance relation has the advantage that the error growth is
-       O(sqrt(N)) for N repetitions. */
-
-    /* See, for example,
-
-       Press, Teukolsky, Vetteling & Flannery, 2007.  Numerical
-       Recipes, Third Edition, Chapter 5.4.
-
-       Singleton, 1967. On computing the fast Fourier
-       transform. Comm. ACM, vol. 10, 647–654. */
-
-    /* Incremental values, using cos(theta) - 1 = -2*sin(theta/2)^2 */
-    dim = -sin(twopit*deltaF);
-    dre = -2.0*sin(0.5*twopit*deltaF)*sin(0.5*twopit*deltaF);
-
     //Set up noise PSD meta parameters
     for(i=0; i<Nblock; i++)
     {
@@ -797,15 +1032,24 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
       }
     }
 
-    if (model->roq_flag) {
+    stageStart=LALInferenceStageTimerStart(model);
+    if (model->roq_flag || model->multiband_flag) {
 
 	double complex weight_iii;
 
-	if (spcal_active){
+	if (model->multiband_flag){
+
+	    if (signalFlag)
+		LALInferenceMultibandInnerProducts(model->multiband, dataPtr->multiband, Fplus, Fcross, timeshift,
+						   spcal_active ? model->multiband->calFactor : NULL,
+						   &this_ifo_d_inner_h, &this_ifo_s);
+	}
+
+	else if (spcal_active){
 
 	    for(unsigned int iii=0; iii < model->roq->frequencyNodesLinear->length; iii++){
 
-			complex double template_EI = model->roq->calFactorLinear->data[iii] * (dataPtr->fPlus*model->roq->hptildeLinear->data->data[iii] + dataPtr->fCross*model->roq->hctildeLinear->data->data[iii] );
+			complex double template_EI = model->roq->calFactorLinear->data[iii] * (Fplus*model->roq->hptildeLinear->data->data[iii] + Fcross*model->roq->hctildeLinear->data->data[iii] );
 
 			weight_iii = gsl_spline_eval (dataPtr->roq->weights_linear[iii].spline_real_weight_linear, timeshift, dataPtr->roq->weights_linear[iii].acc_real_weight_linear) + I*gsl_spline_eval (dataPtr->roq->weights_linear[iii].spline_imag_weight_linear, timeshift, dataPtr->roq->weights_linear[iii].acc_imag_weight_linear);
 
@@ -814,7 +1058,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
 
 		for(unsigned int jjj=0; jjj < model->roq->frequencyNodesQuadratic->length; jjj++){
 
-			this_ifo_s += dataPtr->roq->weightsQuadratic[jjj] * creal( conj( model->roq->calFactorQuadratic->data[jjj] * (model->roq->hptildeQuadratic->data->data[jjj]*dataPtr->fPlus + model->roq->hctildeQuadratic->data->data[jjj]*dataPtr->fCross) ) * ( model->roq->calFactorQuadratic->data[jjj] * (model->roq->hptildeQuadratic->data->data[jjj]*dataPtr->fPlus + model->roq->hctildeQuadratic->data->data[jjj]*dataPtr->fCross) ) );
+			this_ifo_s += dataPtr->roq->weightsQuadratic[jjj] * creal( conj( model->roq->calFactorQuadratic->data[jjj] * (model->roq->hptildeQuadratic->data->data[jjj]*Fplus + model->roq->hctildeQuadratic->data->data[jjj]*Fcross) ) * ( model->roq->calFactorQuadratic->data[jjj] * (model->roq->hptildeQuadratic->data->data[jjj]*Fplus + model->roq->hctildeQuadratic->data->data[jjj]*Fcross) ) );
 		}
 	}
 
@@ -822,7 +1066,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
 
 		for(unsigned int iii=0; iii < model->roq->frequencyNodesLinear->length; iii++){
 
-			complex double template_EI = dataPtr->fPlus*model->roq->hptildeLinear->data->data[iii] + dataPtr->fCross*model->roq->hctildeLinear->data->data[iii];
+			complex double template_EI = Fplus*model->roq->hptildeLinear->data->data[iii] + Fcross*model->roq->hctildeLinear->data->data[iii];
 
 			weight_iii = gsl_spline_eval (dataPtr->roq->weights_linear[iii].spline_real_weight_linear, timeshift, dataPtr->roq->weights_linear[iii].acc_real_weight_linear) + I*gsl_spline_eval (dataPtr->roq->weights_linear[iii].spline_imag_weight_linear, timeshift, dataPtr->roq->weights_linear[iii].acc_imag_weight_linear);
 
@@ -836,6 +1080,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
 			this_ifo_s += dataPtr->roq->weightsQuadratic[jjj] * creal( conj(template_EI) * (template_EI) );
 					}
 	}
+    LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_INNER_PRODUCT, stageStart);
 
     d_inner_h += creal(this_ifo_d_inner_h);
     // D gets the factor of 2 inside nullloglikelihood
@@ -898,18 +1143,31 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
     REAL8 this_ifo_S=0.0;
     COMPLEX16 this_ifo_Rcplx=0.0;
 
-    for (i=lower,chisq=0.0,re = cos(twopit*deltaF*i),im = -sin(twopit*deltaF*i);
+    /* Use the noise weights precomputed for a batch if they match this grid */
+    const REAL8 *noiseWeight = NULL;
+    if(dataPtr->noiseWeights && (INT4)dataPtr->noiseWeights->data->length==upper-lower+1
+       && dataPtr->noiseWeights->f0==lower*deltaF && dataPtr->noiseWeights->deltaF==deltaF)
+      noiseWeight = dataPtr->noiseWeights->data->data;
+
+    /* Time-shift phase factors exp(-2 pi i f timeshift) for bins lower..upper */
+    const COMPLEX16 *phaseRamp = NULL;
+    if(signalFlag && upper>=lower)
+    {
+      phaseRamp = ExtrinsicCachePhaseRamp(extrinsicCache, ifo, twopit, deltaF, lower, upper);
+      if(!phaseRamp) XLAL_ERROR_REAL8(XLAL_EFUNC);
+      LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_TIMESHIFT, stageStart);
+      stageStart=LALInferenceStageTimerStart(model);
+    }
+
+    for (i=lower,chisq=0.0;
          i<=upper;
-         i++, psd++, hptilde++, hctilde++, dtilde++,
-         newRe = re + re*dre - im*dim,
-         newIm = im + re*dim + im*dre,
-         re = newRe, im = newIm)
+         i++, psd++, hptilde++, hctilde++, dtilde++)
     {
 
       COMPLEX16 d=*dtilde;
       /* Normalise PSD to our funny standard (see twoDeltaTOverN
-	 below). */
-      REAL8 sigmasq=(*psd)*deltaT*deltaT;
+	 above), weight = TwoDeltaToverN/sigmasq. */
+      REAL8 weight = noiseWeight ? noiseWeight[i-lower] : TwoDeltaToverN/((*psd)*deltaT*deltaT);
 
       if (constantcal_active) {
         REAL8 dre_tmp= creal(d)*cos_calpha - cimag(d)*sin_calpha;
@@ -918,7 +1176,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
         dim_tmp/=(1.0+calamp);
 
         d=crect(dre_tmp,dim_tmp);
-        sigmasq/=((1.0+calamp)*(1.0+calamp));
+        weight*=((1.0+calamp)*(1.0+calamp));
       }
 
       REAL8 singleFreqBinTerm;
@@ -931,7 +1189,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
         {
           if (i >= psdBandsMin_array[j] && i <= psdBandsMax_array[j])
           {
-            sigmasq  *= alpha[j];
+            weight   /= alpha[j];
             loglikelihood -= lnalpha[j];
           }
         }
@@ -945,7 +1203,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
       COMPLEX16 plainTemplate = Fplus*(*hptilde)+Fcross*(*hctilde);
 
       /* Do time shifting */
-      template = plainTemplate * (re + I*im);
+      template = plainTemplate * phaseRamp[i-lower];
 
       if (spcal_active) {
           calF = calFactor->data->data[i];
@@ -969,9 +1227,9 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
 
       templatesq=creal(template)*creal(template) + cimag(template)*cimag(template);
       REAL8 datasq = creal(d)*creal(d)+cimag(d)*cimag(d);
-      D+=TwoDeltaToverN*datasq/sigmasq;
-      this_ifo_S+=TwoDeltaToverN*templatesq/sigmasq;
-      COMPLEX16 dhstar = TwoDeltaToverN*d*conj(template)/sigmasq;
+      D+=weight*datasq;
+      this_ifo_S+=weight*templatesq;
+      COMPLEX16 dhstar = weight*d*conj(template);
       this_ifo_Rcplx+=dhstar;
       Rcplx+=dhstar;
 
@@ -980,7 +1238,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
         case GAUSSIAN:
         {
           REAL8 diffsq = creal(diff)*creal(diff)+cimag(diff)*cimag(diff);
-          chisq = TwoDeltaToverN*diffsq/sigmasq;
+          chisq = weight*diffsq;
           singleFreqBinTerm = chisq;
           chisquared  += singleFreqBinTerm;
           model->ifo_loglikelihoods[ifo] -= singleFreqBinTerm;
@@ -989,7 +1247,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
         case STUDENTT:
         {
           REAL8 diffsq = creal(diff)*creal(diff)+cimag(diff)*cimag(diff);
-          chisq = TwoDeltaToverN*diffsq/sigmasq;
+          chisq = weight*diffsq;
           singleFreqBinTerm = ((degreesOfFreedom+2.0)/2.0) * log(1.0 + chisq/degreesOfFreedom) ;
           chisquared  += singleFreqBinTerm;
           model->ifo_loglikelihoods[ifo] -= singleFreqBinTerm;
@@ -998,17 +1256,17 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
         case MARGTIME:
         case MARGTIMEPHI:
         {
-          loglikelihood+=-TwoDeltaToverN*(templatesq+datasq)/sigmasq;
+          loglikelihood+=-weight*(templatesq+datasq);
 
           /* Note: No Factor of 2 here, since we are using the 2-sided
 	     COMPLEX16FFT.  Also, we use d*conj(h) because we are
 	     using a complex->real *inverse* FFT to compute the
 	     time-series of likelihoods. */
-          dh_S_tilde->data[i] += TwoDeltaToverN * d * conj(template) / sigmasq;
+          dh_S_tilde->data[i] += weight * d * conj(template);
 
           if (margphi) {
             /* This is the other phase quadrature */
-            dh_S_phase_tilde->data[i] += TwoDeltaToverN * d * conj(I*template) / sigmasq;
+            dh_S_phase_tilde->data[i] += weight * d * conj(I*template);
           }
 
           break;
@@ -1024,6 +1282,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
 
 
     } /* End loop over freq bins */
+    LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_INNER_PRODUCT, stageStart);
     switch(marginalisationflags)
     {
     case GAUSSIAN:
@@ -1091,6 +1350,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
   } /* end loop over detectors */
 
   }
+  stageStart=LALInferenceStageTimerStart(model);
   if (model->roq_flag){
 
 
@@ -1317,6 +1577,7 @@ static REAL8 LALInferenceFusedFreqDomainLogLikelihood(LALInferenceVariables *cur
 
   //loglikelihood = -1.0 * chisquared; // note (again): the log-likelihood is unnormalised!
 
+  LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_MARGINALISATION, stageStart);
   return(loglikelihood);
 }
 
@@ -1685,7 +1946,9 @@ REAL8 LALInferenceFastSineGaussianLogLikelihood(LALInferenceVariables *currentPa
       LALInferenceAddVariable(model->params, "time", &timeTmp, LALINFERENCE_REAL8_t,LALINFERENCE_PARAM_LINEAR);
 
       INT4 errnum=0;
+      REAL8 templtStart=LALInferenceStageTimerStart(model);
       XLAL_TRY(model->templt(model),errnum);
+      LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_WAVEFORM, templtStart);
       errnum&=~XLAL_EFUNC;
       if(errnum!=XLAL_SUCCESS)
       {
@@ -1707,9 +1970,11 @@ REAL8 LALInferenceFastSineGaussianLogLikelihood(LALInferenceVariables *currentPa
         /* Template is now in model->timeFreqhPlus and hCross */
 
       /* determine beam pattern response (F_plus and F_cross) for given Ifo: */
+      REAL8 stageStart=LALInferenceStageTimerStart(model);
       XLALComputeDetAMResponse(&Fplus, &Fcross, (const REAL4(*)[3])dataPtr->detector->response, ra, dec, psi, gmst);
       /* signal arrival time (relative to geocenter); */
       timedelay = XLALTimeDelayFromEarthCenter(dataPtr->detector->location, ra, dec, &GPSlal);
+      LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_PROJECTION, stageStart);
       /* (negative timedelay means signal arrives earlier at Ifo than at geocenter, etc.) */
       /* amount by which to time-shift template (not necessarily same as above "timedelay"): */
       timeshift =  (GPSdouble - (*(REAL8*) LALInferenceGetVariable(model->params, "time"))) + timedelay;
@@ -1719,10 +1984,6 @@ REAL8 LALInferenceFastSineGaussianLogLikelihood(LALInferenceVariables *currentPa
       Fplus*=amp_prefactor;
       Fcross*=amp_prefactor;
 
-      dataPtr->fPlus = Fplus;
-      dataPtr->fCross = Fcross;
-      dataPtr->timeshift = timeshift;
-
 
       /* determine frequency range & loop over frequency bins: */
       deltaF = 1.0 / (((double)dataPtr->timeData->data->length) * deltaT);
@@ -1748,6 +2009,7 @@ REAL8 LALInferenceFastSineGaussianLogLikelihood(LALInferenceVariables *currentPa
     COMPLEX16 diff=0.0;
     COMPLEX16 template=0.0;
     INT4 upppone=upper+1;
+    stageStart=LALInferenceStageTimerStart(model);
     for (i=lower,chisq=0.0,re = cos(twopit*deltaF*i),im = -sin(twopit*deltaF*i);
          i<upppone;
          i++, psd++, hptilde++, hctilde++, dtilde++,
@@ -1772,6 +2034,7 @@ REAL8 LALInferenceFastSineGaussianLogLikelihood(LALInferenceVariables *currentPa
       chisquared  += chisq;
       model->ifo_loglikelihoods[ifo] -= chisq;
     } /* End loop over freq bins */
+    LALInferenceStageTimerStop(model, LALINFERENCE_STAGE_INNER_PRODUCT, stageStart);
 
     loglikelihood += model->ifo_loglikelihoods[ifo];
 
@@ -1946,9 +2209,6 @@ void LALInferenceNetworkSNR(LALInferenceVariables *currentParams,
     /* determine beam pattern response (F_plus and F_cross) for given Ifo: */
     XLALComputeDetAMResponse(&Fplus, &Fcross, (const REAL4(*)[3])dataPtr->detector->response, ra, dec, psi, gmst);
 
-    dataPtr->fPlus = Fplus;
-    dataPtr->fCross = Fcross;
-
     /* determine frequency range & loop over frequency bins: */
     deltaT = dataPtr->timeData->deltaT;
     deltaF = 1.0 / (((double)dataPtr->timeData->data->length) * deltaT);
@@ -86,6 +86,37 @@ extern const REAL8 CM[15][15];
  */
 /*@{*/
 
+/**
+ * Extrinsic quantities for one IFO, memoised by the likelihood between calls.
+ */
+typedef struct tagLALInferenceIFOExtrinsicCache
+{
+  REAL8 ra, dec, psi, gmst, gps; /** Sky location, polarisation and time at which the response was computed */
+  INT4 responseValid; /** Whether fPlus, fCross and timedelay are set */
+  REAL8 fPlus, fCross; /** Antenna response */
+  REAL8 timedelay; /** Arrival time relative to geocentre */
+  REAL8 twopit, deltaF; /** 2 pi times the time shift, and the bin spacing, of the phase ramp */
+  INT4 lower; /** Frequency bin of the first element of the phase ramp */
+  COMPLEX16Vector *phaseRamp; /** exp(-i twopit f) for bins lower..lower+length-1 */
+} LALInferenceIFOExtrinsicCache;
+
+/**
+ * Per-model cache of the detector responses and time-shift phase ramps used by
+ * the frequency-domain likelihood. Each thread owns its own model, so the
+ * cache needs no locking. Steps that only change intrinsic parameters reuse
+ * the stored responses and ramps instead of recomputing them per bin.
+ */
+typedef struct tagLALInferenceExtrinsicCache
+{
+  INT4 nifo; /** Number of IFOs */
+  LALInferenceIFOExtrinsicCache *ifo; /** Per-IFO entries */
+  UINT8 responseHits, responseCalls; /** Antenna response/time delay lookups */
+  UINT8 rampHits, rampCalls; /** Phase ramp lookups */
+} LALInferenceExtrinsicCache;
+
+/** Free an extrinsic cache and its phase ramps */
+void LALInferenceDestroyExtrinsicCache(LALInferenceExtrinsicCache *cache);
+
 /***********************************************************//**
  * (log-) likelihood function.                                 
  * Returns the non-normalised logarithmic likelihood.          
@@ -99,6 +130,21 @@ extern const REAL8 CM[15][15];
  ***************************************************************/
 REAL8 LALInferenceUndecomposedFreqDomainLogLikelihood(LALInferenceVariables *currentParams, LALInferenceIFOData *data, LALInferenceModel *model);
 
+/**
+ * Evaluate \c likelihood for a batch of \c nbatch parameter sets, storing the
+ * results in \c logLikelihoods. Entry \c i is evaluated with \c models[i], so
+ * every entry needs its own model (e.g. one per LALInferenceThreadState); the
+ * data and noise PSDs are shared across the batch. If
+ * \c logPriors is not NULL, entries with a non-finite prior are not evaluated
+ * and get a log-likelihood of -INFINITY.
+ *
+ * The batch is distributed over OpenMP threads internally, so callers should
+ * not call this from inside their own parallel region. The per-IFO noise
+ * weighting is computed once for the batch and held in the \c noiseWeights
+ * fields of \c data until the call returns.
+ */
+INT4 LALInferenceBatchedLogLikelihood(LALInferenceLikelihoodFunction likelihood, LALInferenceVariables **params, LALInferenceIFOData *data, LALInferenceModel **models, const REAL8 *logPriors, REAL8 *logLikelihoods, INT4 nbatch);
+
 /**
  * For testing purposes (for instance sampling the prior),
  * likelihood that returns 0.0 = log(1) every
@@ -7,7 +7,11 @@
 //
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <lal/Date.h>
+#include <lal/ComplexFFT.h>
 #include <lal/GenerateInspiral.h>
 #include <lal/LALInference.h>
 #include <lal/FrequencySeries.h>
@@ -137,3 +141,307 @@ REAL8Sequence *LALInferenceMultibandFrequencies(int NBands, double f_min, double
     return(Frequencies);
     
 }
+
+/* Time (s) a band must allow beyond the signal duration, for the ringdown,
+ * the light travel time to the detectors and the spread due to the tapers */
+#define MB_SAFETY_TIME 0.25
+/* Width of the taper between neighbouring bands, as a fraction of the
+ * frequency at which it starts */
+#define MB_TAPER_FRACTION 0.1
+#define MB_MAX_BANDS 32
+
+/** A band of the multibanded likelihood: nodes are spaced by M frequency bins
+ and the band's window rises across [rise_lo, rise_hi] and falls across [fall_lo, fall_hi] */
+typedef struct
+{
+    UINT4 M;
+    REAL8 rise_lo, rise_hi;
+    REAL8 fall_lo, fall_hi;
+} MultibandBand;
+
+static REAL8 MultibandWindow(const MultibandBand *band, REAL8 f);
+static REAL8 MultibandWindow(const MultibandBand *band, REAL8 f)
+{
+    if (f <= band->rise_lo || f >= band->fall_hi) return 0.0;
+    if (f < band->rise_hi) {
+        REAL8 s = sin(LAL_PI_2*(f - band->rise_lo)/(band->rise_hi - band->rise_lo));
+        return s*s;
+    }
+    if (f > band->fall_lo) {
+        REAL8 c = cos(LAL_PI_2*(f - band->fall_lo)/(band->fall_hi - band->fall_lo));
+        return c*c;
+    }
+    return 1.0;
+}
+
+/** Split [f_lo, f_hi] into bands. A band with node spacing M bins is only used above the
+ frequency at which the signal, coalescing t_post before the end of the segment, fits into
+ the last 1/(M deltaF) of the segment. Neighbouring windows sum to one across their tapers. */
+static UINT4 MultibandBands(MultibandBand *bands, REAL8 f_lo, REAL8 f_hi, REAL8 deltaF, UINT4 N, REAL8 mc_sec, REAL8 t_post);
+static UINT4 MultibandBands(MultibandBand *bands, REAL8 f_lo, REAL8 f_hi, REAL8 deltaF, UINT4 N, REAL8 mc_sec, REAL8 t_post)
+{
+    const REAL8 T = 1.0/deltaF;
+    const REAL8 t_extra = t_post + MB_SAFETY_TIME;
+    UINT4 nbands = 0;
+    UINT4 n = 0;
+
+    REAL8 f_start = f_lo*(1.0 - MB_TAPER_FRACTION);
+    REAL8 duration = -LALInferenceTimeFrequencyRelation(mc_sec, f_start, 0);
+    while (N % (2u<<n) == 0 && T/(2u<<n) >= duration + t_extra) n++;
+
+    bands[0].M = 1u<<n;
+    bands[0].rise_lo = f_start;
+    bands[0].rise_hi = f_lo;
+    for (;;) {
+        MultibandBand *band = &bands[nbands++];
+        /* The next band doubles the spacing where the remaining signal fits in half the time */
+        REAL8 t_next = T/(2u<<n) - t_extra;
+        REAL8 f_next = f_hi;
+        if (nbands < MB_MAX_BANDS && N % (2u<<n) == 0 && t_next > 0.0)
+            f_next = 1.1*LALInferenceTimeFrequencyRelation(mc_sec, -t_next, 1);
+        if (f_next < band->rise_hi) f_next = band->rise_hi;
+        if (f_next >= f_hi) {
+            band->fall_lo = f_hi;
+            band->fall_hi = f_hi*(1.0 + MB_TAPER_FRACTION);
+            break;
+        }
+        band->fall_lo = f_next;
+        band->fall_hi = f_next*(1.0 + MB_TAPER_FRACTION);
+        n++;
+        bands[nbands].M = 1u<<n;
+        bands[nbands].rise_lo = band->fall_lo;
+        bands[nbands].rise_hi = band->fall_hi;
+    }
+    return nbands;
+}
+
+static int compare_UINT4(const void *a, const void *b);
+static int compare_UINT4(const void *a, const void *b)
+{
+    UINT4 x = *(const UINT4 *)a, y = *(const UINT4 *)b;
+    return (x > y) - (x < y);
+}
+
+/** Frequency bins of the nodes: every multiple of a band's spacing inside its window */
+static UINT4 *MultibandNodes(const MultibandBand *bands, UINT4 nbands, REAL8 deltaF, UINT4 *nnodes);
+static UINT4 *MultibandNodes(const MultibandBand *bands, UINT4 nbands, REAL8 deltaF, UINT4 *nnodes)
+{
+    UINT4 maxnodes = 0, n = 0;
+    for (UINT4 b = 0; b < nbands; b++)
+        maxnodes += (UINT4)floor(bands[b].fall_hi/(bands[b].M*deltaF)) - (UINT4)ceil(bands[b].rise_lo/(bands[b].M*deltaF)) + 1;
+
+    UINT4 *nodes = XLALMalloc(maxnodes*sizeof(*nodes));
+    if (!nodes) XLAL_ERROR_NULL(XLAL_ENOMEM);
+    for (UINT4 b = 0; b < nbands; b++) {
+        UINT4 kmin = (UINT4)ceil(bands[b].rise_lo/(bands[b].M*deltaF));
+        UINT4 kmax = (UINT4)floor(bands[b].fall_hi/(bands[b].M*deltaF));
+        for (UINT4 k = kmin; k <= kmax; k++) nodes[n++] = k*bands[b].M;
+    }
+    qsort(nodes, n, sizeof(*nodes), compare_UINT4);
+
+    *nnodes = 0;
+    for (UINT4 i = 0; i < n; i++)
+        if (*nnodes == 0 || nodes[i] != nodes[*nnodes - 1]) nodes[(*nnodes)++] = nodes[i];
+    return nodes;
+}
+
+/** Weights of one detector at the nodes.
+ <h|h> interpolates |h|^2 linearly between nodes.
+ For <d|h>, the template times a band's window is taken to occupy only the last
+ 1/(M deltaF) of the segment, so on the full grid it is fixed by its values every M bins
+ through a Dirichlet kernel. Summing that kernel against x = 4 deltaF d/S gives the
+ band's weights, which are the length N/M DFT of the end of the inverse DFT of x. */
+static LALInferenceMultibandData *MultibandWeights(const LALInferenceIFOData *ifo, const MultibandBand *bands, UINT4 nbands, const UINT4 *nodes, UINT4 nnodes);
+static LALInferenceMultibandData *MultibandWeights(const LALInferenceIFOData *ifo, const MultibandBand *bands, UINT4 nbands, const UINT4 *nodes, UINT4 nnodes)
+{
+    const UINT4 N = ifo->timeData->data->length;
+    const REAL8 deltaF = 1.0/(N*ifo->timeData->deltaT);
+    const UINT4 lower = (UINT4)ceil(ifo->fLow/deltaF);
+    const UINT4 upper = (UINT4)floor(ifo->fHigh/deltaF);
+    const REAL8 *psd = ifo->oneSidedNoisePowerSpectrum->data->data;
+    const COMPLEX16 *d = ifo->freqData->data->data;
+
+    if (lower > upper || upper >= ifo->freqData->data->length)
+        XLAL_ERROR_NULL(XLAL_EINVAL, "Invalid frequency range [%g, %g] Hz for %s", ifo->fLow, ifo->fHigh, ifo->name);
+
+    LALInferenceMultibandData *mbdata = XLALCalloc(1, sizeof(*mbdata));
+    if (!mbdata) XLAL_ERROR_NULL(XLAL_ENOMEM);
+    mbdata->nnodes = nnodes;
+    mbdata->weightsLinear = XLALCalloc(nnodes, sizeof(*mbdata->weightsLinear));
+    mbdata->weightsQuadratic = XLALCalloc(nnodes, sizeof(*mbdata->weightsQuadratic));
+    if (!mbdata->weightsLinear || !mbdata->weightsQuadratic) {
+        LALInferenceDestroyMultibandData(mbdata);
+        XLAL_ERROR_NULL(XLAL_ENOMEM);
+    }
+
+    /* <h|h> */
+    UINT4 i = 0;
+    for (UINT4 j = lower; j <= upper; j++) {
+        REAL8 w = 4.0*deltaF/psd[j];
+        while (i + 1 < nnodes && nodes[i+1] <= j) i++;
+        if (j <= nodes[0])
+            mbdata->weightsQuadratic[0] += w;
+        else if (i + 1 == nnodes)
+            mbdata->weightsQuadratic[nnodes-1] += w;
+        else {
+            REAL8 t = (REAL8)(j - nodes[i])/(REAL8)(nodes[i+1] - nodes[i]);
+            mbdata->weightsQuadratic[i] += (1.0 - t)*w;
+            mbdata->weightsQuadratic[i+1] += t*w;
+        }
+    }
+
+    /* <d|h> */
+    COMPLEX16Vector *x = XLALCreateCOMPLEX16Vector(N);
+    COMPLEX16Vector *X = XLALCreateCOMPLEX16Vector(N);
+    COMPLEX16FFTPlan *plan = XLALCreateReverseCOMPLEX16FFTPlan(N, 0);
+    if (!x || !X || !plan) {
+        XLALDestroyCOMPLEX16Vector(x);
+        XLALDestroyCOMPLEX16Vector(X);
+        if (plan) XLALDestroyCOMPLEX16FFTPlan(plan);
+        LALInferenceDestroyMultibandData(mbdata);
+        XLAL_ERROR_NULL(XLAL_EFUNC);
+    }
+    memset(x->data, 0, N*sizeof(*x->data));
+    for (UINT4 j = lower; j <= upper; j++)
+        x->data[j] = 4.0*deltaF*d[j]/psd[j];
+    XLALCOMPLEX16VectorFFT(X, x, plan);
+    XLALDestroyCOMPLEX16FFTPlan(plan);
+    XLALDestroyCOMPLEX16Vector(x);
+
+    for (UINT4 b = 0; b < nbands; b++) {
+        const UINT4 M = bands[b].M;
+        const UINT4 Lb = N/M;
+        COMPLEX16Vector *v = XLALCreateCOMPLEX16Vector(Lb);
+        COMPLEX16Vector *V = XLALCreateCOMPLEX16Vector(Lb);
+        COMPLEX16FFTPlan *bplan = XLALCreateForwardCOMPLEX16FFTPlan(Lb, 0);
+        if (!v || !V || !bplan) {
+            XLALDestroyCOMPLEX16Vector(v);
+            XLALDestroyCOMPLEX16Vector(V);
+            if (bplan) XLALDestroyCOMPLEX16FFTPlan(bplan);
+            XLALDestroyCOMPLEX16Vector(X);
+            LALInferenceDestroyMultibandData(mbdata);
+            XLAL_ERROR_NULL(XLAL_EFUNC);
+        }
+        memcpy(v->data, X->data + (N - Lb), Lb*sizeof(*v->data));
+        XLALCOMPLEX16VectorFFT(V, v, bplan);
+        for (i = 0; i < nnodes; i++) {
+            if (nodes[i] % M) continue;
+            REAL8 win = MultibandWindow(&bands[b], nodes[i]*deltaF);
+            if (win > 0.0)
+                mbdata->weightsLinear[i] += win*V->data[(nodes[i]/M) % Lb]/Lb;
+        }
+        XLALDestroyCOMPLEX16FFTPlan(bplan);
+        XLALDestroyCOMPLEX16Vector(v);
+        XLALDestroyCOMPLEX16Vector(V);
+    }
+    XLALDestroyCOMPLEX16Vector(X);
+
+    return mbdata;
+}
+
+int LALInferenceSetupMultibandLikelihood(LALInferenceModel *model, LALInferenceIFOData *data, REAL8 mc_min, REAL8 tc_min)
+{
+    LALInferenceIFOData *ifo;
+    MultibandBand bands[MB_MAX_BANDS];
+
+    XLAL_CHECK(model && data, XLAL_EFAULT);
+    XLAL_CHECK(mc_min > 0.0, XLAL_EDOM, "Minimum chirp mass must be positive");
+
+    const UINT4 N = data->timeData->data->length;
+    const REAL8 deltaT = data->timeData->deltaT;
+    REAL8 f_lo = data->fLow, f_hi = data->fHigh;
+    for (ifo = data->next; ifo; ifo = ifo->next) {
+        XLAL_CHECK(ifo->timeData->data->length == N && ifo->timeData->deltaT == deltaT, XLAL_EINVAL,
+                   "Multibanded likelihood needs all data to share segment length and sampling rate");
+        if (ifo->fLow < f_lo) f_lo = ifo->fLow;
+        if (ifo->fHigh > f_hi) f_hi = ifo->fHigh;
+    }
+    if (f_hi > 0.5/deltaT) f_hi = 0.5/deltaT;
+    XLAL_CHECK(f_lo > 0.0 && f_lo < f_hi, XLAL_EINVAL, "Invalid frequency range [%g, %g] Hz", f_lo, f_hi);
+
+    const REAL8 deltaF = 1.0/(N*deltaT);
+    REAL8 t_post = XLALGPSGetREAL8(&(data->freqData->epoch)) + N*deltaT - tc_min;
+    XLAL_CHECK(t_post > 0.0 && t_post < N*deltaT, XLAL_EDOM, "Earliest coalescence time %f outside the data segment", tc_min);
+
+    UINT4 nbands = MultibandBands(bands, f_lo, f_hi, deltaF, N, mc_min*LAL_MTSUN_SI, t_post);
+    UINT4 nnodes = 0;
+    UINT4 *nodes = MultibandNodes(bands, nbands, deltaF, &nnodes);
+    XLAL_CHECK(nodes, XLAL_EFUNC);
+
+    LALInferenceMultibandModel *mbmodel = XLALCalloc(1, sizeof(*mbmodel));
+    XLAL_CHECK(mbmodel, XLAL_ENOMEM);
+    mbmodel->frequencies = XLALCreateREAL8Sequence(nnodes);
+    mbmodel->calFactor = XLALCreateCOMPLEX16Sequence(nnodes);
+    if (!mbmodel->frequencies || !mbmodel->calFactor) {
+        XLALFree(nodes);
+        LALInferenceDestroyMultibandModel(mbmodel);
+        XLAL_ERROR(XLAL_EFUNC);
+    }
+    for (UINT4 i = 0; i < nnodes; i++)
+        mbmodel->frequencies->data[i] = nodes[i]*deltaF;
+
+    for (ifo = data; ifo; ifo = ifo->next) {
+        if (ifo->multiband) {
+            XLAL_CHECK(ifo->multiband->nnodes == nnodes, XLAL_EINVAL, "Existing multiband weights for %s do not match the nodes", ifo->name);
+            continue;
+        }
+        ifo->multiband = MultibandWeights(ifo, bands, nbands, nodes, nnodes);
+        if (!ifo->multiband) {
+            XLALFree(nodes);
+            LALInferenceDestroyMultibandModel(mbmodel);
+            XLAL_ERROR(XLAL_EFUNC);
+        }
+    }
+    XLALFree(nodes);
+
+    if (model->multiband) LALInferenceDestroyMultibandModel(model->multiband);
+    model->multiband = mbmodel;
+    model->multiband_flag = 1;
+
+    fprintf(stdout, "Multibanded likelihood: %u bands, %u frequency nodes in place of %u\n",
+            nbands, nnodes, (UINT4)floor(f_hi/deltaF) - (UINT4)ceil(f_lo/deltaF) + 1);
+
+    return XLAL_SUCCESS;
+}
+
+void LALInferenceMultibandInnerProducts(const LALInferenceMultibandModel *mbmodel,
+                                        const LALInferenceMultibandData *mbdata,
+                                        REAL8 Fplus, REAL8 Fcross, REAL8 timeshift,
+                                        const COMPLEX16Sequence *calFactor,
+                                        COMPLEX16 *d_inner_h, REAL8 *h_inner_h)
+{
+    const REAL8 *f = mbmodel->frequencies->data;
+    const COMPLEX16 *hp = mbmodel->hptilde->data->data;
+    const COMPLEX16 *hc = mbmodel->hctilde->data->data;
+    const REAL8 twopit = LAL_TWOPI*timeshift;
+    COMPLEX16 dh = 0.0;
+    REAL8 hh = 0.0;
+
+    for (UINT4 i = 0; i < mbdata->nnodes; i++) {
+        COMPLEX16 h = Fplus*hp[i] + Fcross*hc[i];
+        if (calFactor) h *= calFactor->data[i];
+        hh += mbdata->weightsQuadratic[i]*(creal(h)*creal(h) + cimag(h)*cimag(h));
+        dh += mbdata->weightsLinear[i]*conj(h*cexp(-I*twopit*f[i]));
+    }
+
+    *d_inner_h = dh;
+    *h_inner_h = hh;
+}
+
+void LALInferenceDestroyMultibandModel(LALInferenceMultibandModel *mbmodel)
+{
+    if (!mbmodel) return;
+    XLALDestroyREAL8Sequence(mbmodel->frequencies);
+    XLALDestroyCOMPLEX16Sequence(mbmodel->calFactor);
+    if (mbmodel->hptilde) XLALDestroyCOMPLEX16FrequencySeries(mbmodel->hptilde);
+    if (mbmodel->hctilde) XLALDestroyCOMPLEX16FrequencySeries(mbmodel->hctilde);
+    XLALFree(mbmodel);
+}
+
+void LALInferenceDestroyMultibandData(LALInferenceMultibandData *mbdata)
+{
+    if (!mbdata) return;
+    XLALFree(mbdata->weightsLinear);
+    XLALFree(mbdata->weightsQuadratic);
+    XLALFree(mbdata);
+}
@@ -1,6 +1,6 @@
 //
 //  LALInferenceFVectorMultiBanding.h
-//  
+//
 //
 //  Created by John Veitch and Serena Vinciguerra on 24/02/2015.
 //
@@ -9,8 +9,40 @@
 #ifndef _LALInferenceFVectorMultiBanding_Flat_h
 #define _LALInferenceFVectorMultiBanding_Flat_h
 
+#include <lal/LALInference.h>
+
 /** Create a list of frequencies to use in multiband template generation, between f_min and f_max
  mc is minimum allowable chirp mass (sets freq evolution assumption ) */
 REAL8Sequence *LALInferenceMultibandFrequencies(int NBands, double f_min, double f_max, double deltaF0, double mc);
 
+/**
+ * Set up the multibanded likelihood.
+ * The band between the lowest fLow and highest fHigh of the network is split into bands whose
+ * frequency resolution is the coarsest that still resolves a signal of chirp mass \c mc_min
+ * coalescing no earlier than \c tc_min (GPS seconds). The template is then only evaluated at the
+ * frequency nodes stored in \c model->multiband, and each entry of \c data that does not already
+ * have them gets the data-dependent weights for <d|h> and <h|h> at those nodes.
+ * All data must share the same segment length and sampling rate.
+ */
+int LALInferenceSetupMultibandLikelihood(LALInferenceModel *model, LALInferenceIFOData *data, REAL8 mc_min, REAL8 tc_min);
+
+/**
+ * Compute <d|h> and <h|h> for one detector from the template at the multiband frequency nodes,
+ * with detector response \c Fplus, \c Fcross and time shift \c timeshift (seconds) applied.
+ * If \c calFactor is not NULL the template is multiplied by it at each node.
+ * <d|h> is returned complex, following the convention of the ROQ likelihood (data times conjugate
+ * template); its real part is the usual inner product.
+ */
+void LALInferenceMultibandInnerProducts(const LALInferenceMultibandModel *mbmodel,
+                                        const LALInferenceMultibandData *mbdata,
+                                        REAL8 Fplus, REAL8 Fcross, REAL8 timeshift,
+                                        const COMPLEX16Sequence *calFactor,
+                                        COMPLEX16 *d_inner_h, REAL8 *h_inner_h);
+
+/** Free the frequency nodes and template buffers of a multibanded model */
+void LALInferenceDestroyMultibandModel(LALInferenceMultibandModel *mbmodel);
+
+/** Free the multibanded likelihood weights of one detector */
+void LALInferenceDestroyMultibandData(LALInferenceMultibandData *mbdata);
+
 #endif
@@ -124,8 +124,19 @@ int main(int argc, char *argv[]){
 
      }
 
-  /* Set up the threads */
-  LALInferenceInitCBCThreads(state,1);
+  /* Set up the threads, one for each live point replaced per iteration */
+  INT4 nthreads=1;
+  if (state){
+    ProcessParamsTable *ppt=LALInferenceGetProcParamVal(state->commandLine,"--Nparallel");
+    if(!ppt) ppt=LALInferenceGetProcParamVal(state->commandLine,"--nparallel");
+    if(ppt) nthreads=atoi(ppt->value);
+    if(nthreads<1)
+    {
+      fprintf(stderr,"Error, --Nparallel must be at least 1\n");
+      exit(1);
+    }
+  }
+  LALInferenceInitCBCThreads(state,nthreads);
 
   /* Init the prior */
   LALInferenceInitCBCPrior(state);
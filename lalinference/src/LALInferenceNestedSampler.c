@@ -27,6 +27,10 @@
 
 #include "logaddexp.h"
 
+#ifndef _OPENMP
+#define omp ignore
+#endif
+
 #define PROGRAM_NAME "LALInferenceNestedSampler.c"
 #define CVS_ID_STRING "$Id$"
 #define CVS_REVISION "$Revision$"
@@ -378,6 +382,9 @@ static void install_resume_handler(void)
 static UINT4 UpdateNMCMC(LALInferenceRunState *runState);
 /* Prototypes for private "helper" functions. */
 
+static UINT4 MCMCSamplePriorThread(LALInferenceRunState *runState, LALInferenceThreadState *threadState, gsl_rng *rng);
+static INT4 NestedSamplingSloppySampleThread(LALInferenceRunState *runState, LALInferenceThreadState *threadState, gsl_rng *rng, REAL8 logLmin, UINT4 Nmcmc, REAL8 *sloppyfraction, REAL8 *accept_rate, REAL8 *sub_accept_rate);
+
 static REAL8 LALInferenceNSSample_logt(int Nlive,gsl_rng *RNG);
 
 //static void SamplePriorDiscardAcceptance(LALInferenceRunState *runState);
@@ -526,9 +533,9 @@ static UINT4 UpdateNMCMC(LALInferenceRunState *runState){
         }
         LALInferenceSetVariable(runState->algorithmParams,"Nmcmc",&max);
     }
-    /* Single threaded here */
     if (LALInferenceGetProcParamVal(runState->commandLine,"--proposal-kde"))
-        LALInferenceSetupClusteredKDEProposalFromDEBuffer(runState->threads[0]);
+        for(INT4 t=0;t<runState->nthreads;t++)
+            LALInferenceSetupClusteredKDEProposalFromDEBuffer(runState->threads[t]);
     return(max);
 }
 
@@ -677,6 +684,8 @@ void LALInferenceNestedSamplingAlgorithmInit(LALInferenceRunState *runState)
     (--sloppyratio S)                Number of sub-samples of the prior for every sample from the\n\
                                      limited prior\n\
     (--Nruns R)                      Number of parallel samples from logt to use(1)\n\
+    (--Nparallel K)                  Replace the K lowest live points at each iteration, evolving\n\
+                                     the replacements in parallel with OpenMP (1)\n\
     (--tolerance dZ)                 Tolerance of nested sampling algorithm (0.1)\n\
     (--randomseed seed)              Random seed of sampling distribution\n\
     (--prior )                       Set the prior to use (InspiralNormalised,SkyLoc,malmquist)\n\
@@ -729,15 +738,13 @@ void LALInferenceNestedSamplingAlgorithmInit(LALInferenceRunState *runState)
   INT4 tmpi=0;
   REAL8 tmp=0;
 
-  /* Single thread only */
-  LALInferenceThreadState *threadState = runState->threads[0];
-
   /* Set up the appropriate functions for the nested sampling algorithm */
   runState->algorithm=&LALInferenceNestedSamplingAlgorithm;
   runState->evolve=&LALInferenceNestedSamplingOneStep;
 
   /* use the ptmcmc proposal to sample prior */
-  threadState->proposal=&LALInferenceCyclicProposal;
+  for(INT4 t=0;t<runState->nthreads;t++)
+    runState->threads[t]->proposal=&LALInferenceCyclicProposal;
   REAL8 temp=1.0;
   LALInferenceAddVariable(runState->proposalArgs,"temperature",&temp,LALINFERENCE_REAL8_t,LALINFERENCE_PARAM_FIXED);
 
@@ -753,6 +760,11 @@ void LALInferenceNestedSamplingAlgorithmInit(LALInferenceRunState *runState)
     exit(1);
   }
   LALInferenceAddVariable(runState->algorithmParams,"Nlive",&tmpi, LALINFERENCE_INT4_t,LALINFERENCE_PARAM_FIXED);
+  if(runState->nthreads>=tmpi)
+  {
+    fprintf(stderr,"Error, number of parallel replacements (%i) must be less than the number of live points (%i)\n",runState->nthreads,tmpi);
+    exit(1);
+  }
 
   /* Number of points in MCMC chain */
   ppt=LALInferenceGetProcParamVal(commandLine,"--Nmcmc");
@@ -812,11 +824,109 @@ void LALInferenceNestedSamplingAlgorithmInit(LALInferenceRunState *runState)
 	points.
  */
 
+/* Replace the nrep lowest likelihood live points in one step, evolving each replacement
+ * on its own thread. The removed points are passed to the integrator in ascending order of
+ * likelihood, the r-th of them with Nlive-r points remaining, as for the final live points.
+ * With nrep=1 this is the usual one-point update. Returns the new logZ, and sets the
+ * likelihood bound used in *logLmin_out */
+static REAL8 ReplaceLivePointsParallel(LALInferenceRunState *runState, NSintegralState *s, REAL8 *logLikelihoods, UINT4 Nlive, UINT4 nrep, UINT4 samplePrior, REAL8 *logLmin_out, REAL8 *logLmax);
+static REAL8 ReplaceLivePointsParallel(LALInferenceRunState *runState, NSintegralState *s, REAL8 *logLikelihoods, UINT4 Nlive, UINT4 nrep, UINT4 samplePrior, REAL8 *logLmin_out, REAL8 *logLmax)
+{
+  UINT4 i,r;
+  REAL8 logZ=-INFINITY;
+  UINT4 *minpos=XLALCalloc(nrep,sizeof(UINT4));
+  UINT4 *start=XLALCalloc(nrep,sizeof(UINT4));
+  UINT4 *removed=XLALCalloc(Nlive,sizeof(UINT4));
+  REAL8 *sloppy=XLALCalloc(nrep,sizeof(REAL8));
+  REAL8 *accept=XLALCalloc(nrep,sizeof(REAL8));
+  REAL8 *sub_accept=XLALCalloc(nrep,sizeof(REAL8));
+  UINT4 Nmcmc=*(UINT4 *)LALInferenceGetVariable(runState->algorithmParams,"Nmcmc");
+  REAL8 sloppyfraction=*(REAL8 *)LALInferenceGetVariable(runState->algorithmParams,"sloppyfraction");
+
+  /* Find the nrep lowest likelihood points, in ascending order */
+  for(r=0;r<nrep;r++)
+  {
+    UINT4 pos=Nlive;
+    for(i=0;i<Nlive;i++)
+      if(!removed[i] && (pos==Nlive || logLikelihoods[i]<logLikelihoods[pos])) pos=i;
+    minpos[r]=pos;
+    removed[pos]=1;
+    logZ=incrementEvidenceSamples(runState->GSLrandom, Nlive-r, logLikelihoods[pos], s);
+    if(runState->logsample) runState->logsample(runState->algorithmParams,runState->livePoints[pos]);
+  }
+  REAL8 logLmin=logLikelihoods[minpos[nrep-1]];
+  if(samplePrior) logLmin=-INFINITY;
+  LALInferenceSetVariable(runState->algorithmParams,"logLmin",(void *)&logLmin);
+
+  /* Starting points are drawn from the surviving live points */
+  for(r=0;r<nrep;r++)
+  {
+    while(removed[(start[r]=gsl_rng_uniform_int(runState->GSLrandom,Nlive))]){};
+    sloppy[r]=sloppyfraction;
+  }
+
+  /* Evolve the replacements. Each thread only reads the live points and the run state,
+     and runState->data is read-only during likelihood evaluation: every thread has its
+     own model, detector responses are kept in locals and the ROQ spline accelerators
+     are NULL, so all threads can share the same data */
+  #pragma omp parallel for schedule(dynamic)
+  for(r=0;r<nrep;r++)
+  {
+    LALInferenceThreadState *thread=runState->threads[r];
+    UINT4 j=start[r];
+    do{
+      LALInferenceCopyVariables(runState->livePoints[j],thread->currentParams);
+      thread->currentLikelihood=logLikelihoods[j];
+      NestedSamplingSloppySampleThread(runState,thread,thread->GSLrandom,logLmin,Nmcmc,&sloppy[r],&accept[r],&sub_accept[r]);
+      /* Try a different starting point if this one failed */
+      while(removed[(j=gsl_rng_uniform_int(thread->GSLrandom,Nlive))]){};
+    }while(thread->currentLikelihood<=logLmin || accept[r]==0.0);
+  }
+
+  /* Put the new points in place of the removed ones */
+  REAL8 logw=mean(s->logwarray->data,s->size);
+  for(r=0;r<nrep;r++)
+  {
+    LALInferenceThreadState *thread=runState->threads[r];
+    UINT4 pos=minpos[r];
+    LALInferenceCopyVariables(thread->currentParams,runState->livePoints[pos]);
+    logLikelihoods[pos]=thread->currentLikelihood;
+    if(thread->differentialBuffer)
+    {
+      LALInferenceDEBuffer *deBuffer=thread->differentialBuffer;
+      LALInferenceCopyVariablesToLayoutArray(deBuffer->layout,runState->livePoints[pos],deBuffer->data+pos*deBuffer->layout->length);
+    }
+    if(thread->currentLikelihood>*logLmax) *logLmax=thread->currentLikelihood;
+    LALInferenceAddVariable(runState->livePoints[pos],"logw",&logw,LALINFERENCE_REAL8_t,LALINFERENCE_PARAM_OUTPUT);
+  }
+
+  REAL8 accept_rate=mean(accept,nrep);
+  REAL8 sub_accept_rate=mean(sub_accept,nrep);
+  LALInferenceSetVariable(runState->algorithmParams,"accept_rate",&accept_rate);
+  LALInferenceSetVariable(runState->algorithmParams,"sub_accept_rate",&sub_accept_rate);
+  if(isfinite(logLmin))
+  {
+    sloppyfraction=mean(sloppy,nrep);
+    LALInferenceSetVariable(runState->algorithmParams,"sloppyfraction",&sloppyfraction);
+  }
+  *logLmin_out=logLmin;
+
+  XLALFree(minpos);
+  XLALFree(start);
+  XLALFree(removed);
+  XLALFree(sloppy);
+  XLALFree(accept);
+  XLALFree(sub_accept);
+  return(logZ);
+}
+
 void LALInferenceNestedSamplingAlgorithm(LALInferenceRunState *runState)
 {
   UINT4 iter=0,i,j,minpos;
-  /* Single thread here */
+  /* Thread 0 drives the serial parts of the algorithm */
   LALInferenceThreadState *threadState = runState->threads[0];
+  UINT4 Nparallel=runState->nthreads;
+  UINT4 itercounter=0;
   UINT4 HDFOUTPUT=1;
   UINT4 Nlive=*(UINT4 *)LALInferenceGetVariable(runState->algorithmParams,"Nlive");
   UINT4 Nruns=100;
@@ -1031,6 +1141,14 @@ void LALInferenceNestedSamplingAlgorithm(LALInferenceRunState *runState)
   }
   /* Iterate until termination condition is met */
   do {
+    if(Nparallel>1)
+    {
+      logZ=ReplaceLivePointsParallel(runState,s,logLikelihoods,Nlive,Nparallel,samplePrior,&logLmin,&logLmax);
+      H=mean(Harray,Nruns);
+      itercounter=1;
+    }
+    else
+    {
     /* Find minimum likelihood sample to replace */
     minpos=0;
     for(i=1;i<Nlive;i++){
@@ -1045,7 +1163,7 @@ void LALInferenceNestedSamplingAlgorithm(LALInferenceRunState *runState)
     H=mean(Harray,Nruns);
     logZ=logZnew;
     if(runState->logsample) runState->logsample(runState->algorithmParams,runState->livePoints[minpos]);
-    UINT4 itercounter=0;
+    itercounter=0;
 
     /* Generate a new live point */
     do{ /* This loop is here in case it is necessary to find a different sample */
@@ -1060,12 +1178,19 @@ void LALInferenceNestedSamplingAlgorithm(LALInferenceRunState *runState)
 
     LALInferenceCopyVariables(threadState->currentParams,runState->livePoints[minpos]);
     logLikelihoods[minpos]=threadState->currentLikelihood;
+    /* Keep the DE buffer in step with the live points */
+    if(threadState->differentialBuffer)
+    {
+      LALInferenceDEBuffer *deBuffer=threadState->differentialBuffer;
+      LALInferenceCopyVariablesToLayoutArray(deBuffer->layout,runState->livePoints[minpos],deBuffer->data+minpos*deBuffer->layout->length);
+    }
 
   if (threadState->currentLikelihood>logLmax)
     logLmax=threadState->currentLikelihood;
 
   logw=mean(logwarray,Nruns);
   LALInferenceAddVariable(runState->livePoints[minpos],"logw",&logw,LALINFERENCE_REAL8_t,LALINFERENCE_PARAM_OUTPUT);
+    }
   dZ=logaddexp(logZ,logLmax-((double) iter)/((double)Nlive))-logZ;
   sloppyfrac=*(REAL8 *)LALInferenceGetVariable(runState->algorithmParams,"sloppyfraction");
   if(displayprogress) fprintf(stderr,"%i: accpt: %1.3f Nmcmc: %i sub_accpt: %1.3f slpy: %2.1f%% H: %3.2lf nats logL:%.3lf ->%.3lf logZ: %.3lf deltalogLmax: %.2lf dZ: %.3lf Zratio: %.3lf \n",\
@@ -1082,7 +1207,7 @@ void LALInferenceNestedSamplingAlgorithm(LALInferenceRunState *runState)
     dZ,\
     ( logZ - LALInferenceGetREAL8Variable(runState->algorithmParams,"logZnoise"))\
   );
-  iter++;
+  iter+=Nparallel;
 
   /* Save progress */
   if(__ns_saveStateFlag!=0)
@@ -1102,8 +1227,8 @@ void LALInferenceNestedSamplingAlgorithm(LALInferenceRunState *runState)
     exit(0);
   }
 
-  /* Update the proposal */
-  if(!(iter%(Nlive/10))) {
+  /* Update the proposal each time iter passes a multiple of Nlive/10 */
+  if(iter/(Nlive/10)!=(iter-Nparallel)/(Nlive/10)) {
     /* Update the covariance matrix */
     //WriteNSCheckPointH5(resumefilename, runState, s);
     if ( LALInferenceCheckVariable( threadState->proposalArgs,"covarianceMatrix" ) ){
@@ -1242,6 +1367,14 @@ void LALInferenceNestedSamplingAlgorithm(LALInferenceRunState *runState)
 
   /* Free memory */
   XLALFree(logtarray); XLALFree(logwarray); XLALFree(logZarray);
+  LALInferenceDestroyThreadBuffers(runState->threads, runState->nthreads);
+  for(i=0;i<Nparallel;i++)
+  {
+    LALInferenceModel *model=runState->threads[i]->model;
+    if(!model) continue;
+    LALInferenceDestroyExtrinsicCache(model->extrinsicCache);
+    model->extrinsicCache=NULL;
+  }
 }
 
 /* Calculate the autocorrelation function of the sampler (runState->evolve) for each parameter
@@ -1430,7 +1563,13 @@ LALInferenceVariables *LALInferenceComputeAutoCorrelation(LALInferenceRunState *
 UINT4 LALInferenceMCMCSamplePrior(LALInferenceRunState *runState)
 {
     /* Single threaded here */
-    LALInferenceThreadState * threadState=runState->threads[0];
+    return(MCMCSamplePriorThread(runState,runState->threads[0],runState->GSLrandom));
+}
+
+/* Perform one MCMC iteration on threadState->currentParams, drawing the acceptance from rng.
+ * Only reads runState, so may be called for several threads at once */
+static UINT4 MCMCSamplePriorThread(LALInferenceRunState *runState, LALInferenceThreadState *threadState, gsl_rng *rng)
+{
     UINT4 outOfBounds=0;
     UINT4 adaptProp=0;
     //LALInferenceVariables tempParams;
@@ -1452,7 +1591,7 @@ UINT4 LALInferenceMCMCSamplePrior(LALInferenceRunState *runState)
 
     logProposalRatio = threadState->proposal(threadState,threadState->currentParams,&proposedParams);
     REAL8 logPriorNew=runState->prior(runState, &proposedParams, threadState->model);
-    if(isinf(logPriorNew) || isnan(logPriorNew) || log(gsl_rng_uniform(runState->GSLrandom)) > (logPriorNew-logPriorOld) + logProposalRatio)
+    if(isinf(logPriorNew) || isnan(logPriorNew) || log(gsl_rng_uniform(rng)) > (logPriorNew-logPriorOld) + logProposalRatio)
     {
 	/* Reject - don't need to copy new params back to currentParams */
         /*LALInferenceCopyVariables(oldParams,runState->currentParams); */
@@ -1576,9 +1715,32 @@ INT4 LALInferenceNestedSamplingCachedSampler(LALInferenceRunState *runState)
 
 INT4 LALInferenceNestedSamplingSloppySample(LALInferenceRunState *runState)
 {
-    LALInferenceVariables oldParams;
     /* Single thread here */
     LALInferenceThreadState *threadState = runState->threads[0];
+    REAL8 logLmin=*(REAL8 *)LALInferenceGetVariable(runState->algorithmParams,"logLmin");
+    UINT4 Nmcmc=*(UINT4 *)LALInferenceGetVariable(runState->algorithmParams,"Nmcmc");
+    REAL8 sloppyfraction=(((REAL8)Nmcmc-1)/(REAL8)Nmcmc)/2.0;
+    if (LALInferenceCheckVariable(runState->algorithmParams,"sloppyfraction"))
+      sloppyfraction=*(REAL8 *)LALInferenceGetVariable(runState->algorithmParams,"sloppyfraction");
+    REAL8 accept_rate=0,sub_accept_rate=0;
+
+    INT4 Naccepted=NestedSamplingSloppySampleThread(runState,threadState,runState->GSLrandom,logLmin,Nmcmc,&sloppyfraction,&accept_rate,&sub_accept_rate);
+
+    LALInferenceSetVariable(runState->algorithmParams,"accept_rate",&accept_rate);
+    LALInferenceSetVariable(runState->algorithmParams,"sub_accept_rate",&sub_accept_rate);
+    if(isfinite(logLmin))
+      LALInferenceSetVariable(runState->algorithmParams,"sloppyfraction",&sloppyfraction);
+
+    return Naccepted;
+}
+
+/* Sloppy sampling of threadState->currentParams above logLmin, with chain length Nmcmc.
+ * The sloppy fraction is read from and adapted in *sloppyfraction, and the acceptance
+ * rates are returned in *accept_rate and *sub_accept_rate. Only reads runState, so
+ * may be called for several threads at once */
+static INT4 NestedSamplingSloppySampleThread(LALInferenceRunState *runState, LALInferenceThreadState *threadState, gsl_rng *rng, REAL8 logLmin, UINT4 Nmcmc, REAL8 *sloppyfraction_inout, REAL8 *accept_rate_out, REAL8 *sub_accept_rate_out)
+{
+    LALInferenceVariables oldParams;
     LALInferenceIFOData *data=runState->data;
     REAL8 tmp;
     REAL8 Target=0.3;
@@ -1586,14 +1748,10 @@ INT4 LALInferenceNestedSamplingSloppySample(LALInferenceRunState *runState)
     REAL8 logLold=*(REAL8 *)LALInferenceGetVariable(threadState->currentParams,"logL");
     memset(&oldParams,0,sizeof(oldParams));
     LALInferenceCopyVariables(threadState->currentParams,&oldParams);
-    REAL8 logLmin=*(REAL8 *)LALInferenceGetVariable(runState->algorithmParams,"logLmin");
-    UINT4 Nmcmc=*(UINT4 *)LALInferenceGetVariable(runState->algorithmParams,"Nmcmc");
     REAL8 maxsloppyfraction=((REAL8)Nmcmc-1)/(REAL8)Nmcmc ;
-    REAL8 sloppyfraction=maxsloppyfraction/2.0;
+    REAL8 sloppyfraction=*sloppyfraction_inout;
     REAL8 minsloppyfraction=0.;
     if(Nmcmc==1) maxsloppyfraction=minsloppyfraction=0.0;
-    if (LALInferenceCheckVariable(runState->algorithmParams,"sloppyfraction"))
-      sloppyfraction=*(REAL8 *)LALInferenceGetVariable(runState->algorithmParams,"sloppyfraction");
     UINT4 mcmc_iter=0,Naccepted=0,sub_accepted=0;
     UINT4 sloppynumber=(UINT4) (sloppyfraction*(REAL8)Nmcmc);
     UINT4 testnumber=Nmcmc-sloppynumber;
@@ -1619,7 +1777,7 @@ INT4 LALInferenceNestedSamplingSloppySample(LALInferenceRunState *runState)
         /* Draw an independent sample from the prior */
         do{
 
-            sub_accepted+=LALInferenceMCMCSamplePrior(runState);
+            sub_accepted+=MCMCSamplePriorThread(runState,threadState,rng);
             subchain_length++;
             counter+=(1.-sloppyfraction);
         }while(counter<1);
@@ -1691,8 +1849,8 @@ INT4 LALInferenceNestedSamplingSloppySample(LALInferenceRunState *runState)
     /* Compute some statistics for information */
     REAL8 sub_accept_rate=(REAL8)sub_accepted/(REAL8)sub_iter;
     REAL8 accept_rate=(REAL8)Naccepted/(REAL8)testnumber;
-    LALInferenceSetVariable(runState->algorithmParams,"accept_rate",&accept_rate);
-    LALInferenceSetVariable(runState->algorithmParams,"sub_accept_rate",&sub_accept_rate);
+    *accept_rate_out=accept_rate;
+    *sub_accept_rate_out=sub_accept_rate;
     /* Adapt the sloppy fraction toward target acceptance of outer chain */
     if(isfinite(logLmin)){
         if((REAL8)accept_rate>Target) { sloppyfraction+=5.0/(REAL8)Nmcmc;}
@@ -1700,7 +1858,7 @@ INT4 LALInferenceNestedSamplingSloppySample(LALInferenceRunState *runState)
         if(sloppyfraction>maxsloppyfraction) sloppyfraction=maxsloppyfraction;
 	if(sloppyfraction<minsloppyfraction) sloppyfraction=minsloppyfraction;
 
-	LALInferenceSetVariable(runState->algorithmParams,"sloppyfraction",&sloppyfraction);
+	*sloppyfraction_inout=sloppyfraction;
     }
     /* Cleanup */
     LALInferenceClearVariables(&oldParams);
@@ -1823,6 +1981,24 @@ static void SetupEigenProposals(LALInferenceRunState *runState)
     LALInferenceAddVariable(threadState->proposalArgs, "covarianceEigenvalues", &eigenValues, LALINFERENCE_REAL8Vector_t, LALINFERENCE_PARAM_FIXED);
   LALInferenceAddVariable(threadState->proposalArgs,"covarianceMatrix",cvm,LALINFERENCE_gslMatrix_t,LALINFERENCE_PARAM_OUTPUT);
 
+  /* Give the other threads their own copies of the proposal */
+  for(INT4 t=1;t<runState->nthreads;t++)
+  {
+    LALInferenceVariables *args=runState->threads[t]->proposalArgs;
+    gsl_matrix *eVectorsCopy=gsl_matrix_alloc(N,N);
+    gsl_matrix *cvmCopy=gsl_matrix_alloc(N,N);
+    REAL8Vector *eigenValuesCopy=XLALCreateREAL8Vector(N);
+    gsl_matrix_memcpy(eVectorsCopy,eVectors);
+    gsl_matrix_memcpy(cvmCopy,*cvm);
+    memcpy(eigenValuesCopy->data,eigenValues->data,N*sizeof(REAL8));
+    if(LALInferenceCheckVariable(args,"covarianceEigenvectors")) LALInferenceRemoveVariable(args,"covarianceEigenvectors");
+    if(LALInferenceCheckVariable(args,"covarianceEigenvalues")) LALInferenceRemoveVariable(args,"covarianceEigenvalues");
+    if(LALInferenceCheckVariable(args,"covarianceMatrix")) LALInferenceRemoveVariable(args,"covarianceMatrix");
+    LALInferenceAddVariable(args, "covarianceEigenvectors", &eVectorsCopy, LALINFERENCE_gslMatrix_t, LALINFERENCE_PARAM_FIXED);
+    LALInferenceAddVariable(args, "covarianceEigenvalues", &eigenValuesCopy, LALINFERENCE_REAL8Vector_t, LALINFERENCE_PARAM_FIXED);
+    LALInferenceAddVariable(args, "covarianceMatrix", &cvmCopy, LALINFERENCE_gslMatrix_t, LALINFERENCE_PARAM_OUTPUT);
+  }
+
   gsl_matrix_free(covCopy);
   gsl_vector_free(eValues);
   gsl_eigen_symmv_free(ws);
@@ -1833,13 +2009,27 @@ static void SetupEigenProposals(LALInferenceRunState *runState)
 static int syncLivePointsDifferentialPoints(LALInferenceRunState *state, LALInferenceThreadState *thread)
 {
     INT4 N = LALInferenceGetINT4Variable(state->algorithmParams,"Nlive");
-    if(!thread->differentialPoints) thread->differentialPoints=XLALCalloc(N,sizeof(LALInferenceVariables *));
 
-    for(INT4 i=0;i<N;i++)
+    /* Pack the varying parameters of the live points into the rows of the DE buffer */
+    if(!thread->differentialBuffer || thread->differentialBuffer->size < (size_t)N || !LALInferenceVariablesLayoutMatches(thread->differentialBuffer->layout,state->livePoints[0]))
     {
-        if(!thread->differentialPoints[i]) thread->differentialPoints[i]=XLALCalloc(1,sizeof(LALInferenceVariables));
-        LALInferenceCopyVariables(state->livePoints[i],thread->differentialPoints[i]);
+        LALInferenceDestroyDEBuffer(thread->differentialBuffer);
+        thread->differentialBuffer=LALInferenceCreateDEBuffer(state->livePoints[0],N);
+        if(!thread->differentialBuffer) XLAL_ERROR(XLAL_EFUNC);
     }
+    LALInferenceDEBufferReset(thread->differentialBuffer);
+    for(INT4 i=0;i<N;i++)
+        if(LALInferenceDEBufferAppend(thread->differentialBuffer,state->livePoints[i])!=XLAL_SUCCESS)
+            XLAL_ERROR(XLAL_EFUNC);
     thread->differentialPointsLength=N;
+
+    /* The other threads only read the buffer, so they share it */
+    for(INT4 t=0;t<state->nthreads;t++)
+    {
+        if(state->threads[t]==thread) continue;
+        state->threads[t]->differentialBuffer=thread->differentialBuffer;
+        state->threads[t]->differentialPointsLength=N;
+        state->threads[t]->differentialPointsSkip=thread->differentialPointsSkip;
+    }
     return(XLAL_SUCCESS);
 }
@@ -101,6 +101,42 @@ static const char *intrinsicNames[] = {"chirpmass", "q", "eta", "mass1", "mass2"
 static const char *extrinsicNames[] = {"rightascension", "declination", "cosalpha", "azimuth", "polarisation", "distance",
   "logdistance", "time", "costheta_jn", "t0", "theta","hrss", "loghrss", NULL};
 
+/* Return the thread's layout of the varying REAL8 parameters, (re)building it if it does not match params */
+static LALInferenceVariablesLayout *thread_param_layout(LALInferenceThreadState *thread, LALInferenceVariables *params) {
+    if (!LALInferenceVariablesLayoutMatches(thread->paramLayout, params)) {
+        LALInferenceDestroyVariablesLayout(thread->paramLayout);
+        thread->paramLayout = LALInferenceCreateVariablesLayout(params);
+    }
+    return thread->paramLayout;
+}
+
+/*
+ * Find the column of the thread's DE buffer holding each slot of layout.  Slots that
+ * are not in the buffer, or whose parameter is not one of names (if names!=NULL),
+ * get column -1.
+ */
+static void de_buffer_columns(const LALInferenceDEBuffer *buffer, const LALInferenceVariablesLayout *layout, const char **names, INT4 *cols) {
+    UINT4 k;
+
+    for (k = 0; k < layout->length; k++) {
+        if (k < buffer->layout->length && !strcmp(buffer->layout->names[k], layout->names[k]))
+            cols[k] = k;
+        else
+            cols[k] = LALInferenceVariablesLayoutIndex(buffer->layout, layout->names[k]);
+    }
+
+    if (names != NULL) {
+        for (k = 0; k < layout->length; k++) {
+            size_t i;
+            for (i = 0; names[i] != NULL; i++)
+                if (!strcmp(names[i], layout->names[k]))
+                    break;
+            if (names[i] == NULL)
+                cols[k] = -1;
+        }
+    }
+}
+
 static INT4 same_detector_location(LALDetector *d1, LALDetector *d2) {
     INT4 i;
 
@@ -400,6 +436,12 @@ LALInferenceVariables *LALInferenceParseProposalArgs(LALInferenceRunState *runSt
         cyclic_reflective_kde = 1;
     LALInferenceAddINT4Variable(propArgs, "cyclic_reflective_kde", cyclic_reflective_kde, LALINFERENCE_PARAM_FIXED);
 
+    /* Refresh the clustered-KDE proposal from its previous clustering rather than from scratch */
+    INT4 incremental_kde = 0;
+    if (LALInferenceGetProcParamVal(runState->commandLine, "--incremental-kde"))
+        incremental_kde = 1;
+    LALInferenceAddINT4Variable(propArgs, "incremental_kde", incremental_kde, LALINFERENCE_PARAM_FIXED);
+
     if (LALInferenceGetProcParamVal(command_line, "--noiseonly"))
         noise_only = 1;
     LALInferenceAddINT4Variable(propArgs, "noiseonly", noise_only, LALINFERENCE_PARAM_FIXED);
@@ -756,10 +798,10 @@ REAL8 LALInferenceSingleProposal(LALInferenceThreadState *thread,
 REAL8 LALInferenceCovarianceEigenvectorJump(LALInferenceThreadState *thread,
                                             LALInferenceVariables *currentParams,
                                             LALInferenceVariables *proposedParams) {
-    LALInferenceVariableItem *proposeIterator;
+    LALInferenceVariablesLayout *layout;
     REAL8Vector *eigenvalues;
     gsl_matrix *eigenvectors;
-    REAL8 jumpSize, tmp, inc;
+    REAL8 jumpSize;
     REAL8 logPropRatio = 0.0;
     INT4 N, i, j;
 
@@ -776,27 +818,20 @@ REAL8 LALInferenceCovarianceEigenvectorJump(LALInferenceThreadState *thread,
     i = gsl_rng_uniform_int(rng, N);
     jumpSize = sqrt(thread->temperature * eigenvalues->data[i]) * gsl_ran_ugaussian(rng);
 
-    j = 0;
-    proposeIterator = proposedParams->head;
-    if (proposeIterator == NULL) {
+    if (proposedParams->head == NULL) {
         fprintf(stderr, "Bad proposed params in %s, line %d\n",
                 __FILE__, __LINE__);
         exit(1);
     }
 
-    do {
-        if (LALInferenceCheckVariableNonFixed(proposedParams, proposeIterator->name) &&
-            proposeIterator->type==LALINFERENCE_REAL8_t) {
-            tmp = LALInferenceGetREAL8Variable(proposedParams, proposeIterator->name);
-            inc = jumpSize * gsl_matrix_get(eigenvectors, j, i);
-
-            tmp += inc;
-
-            LALInferenceSetVariable(proposedParams, proposeIterator->name, &tmp);
-
-            j++;
-        }
-    } while ((proposeIterator = proposeIterator->next) != NULL && j < N);
+    /* Jump along the eigenvector in the flat array of varying REAL8 parameters */
+    layout = thread_param_layout(thread, proposedParams);
+    INT4 Ndim = layout->length;
+    REAL8 x[Ndim > 0 ? Ndim : 1];
+    LALInferenceCopyVariablesToLayoutArray(layout, proposedParams, x);
+    for (j = 0; j < Ndim && j < N; j++)
+        x[j] += jumpSize * gsl_matrix_get(eigenvectors, j, i);
+    LALInferenceCopyLayoutArrayToVariables(layout, x, proposedParams);
 
     return logPropRatio;
 }
@@ -870,7 +905,7 @@ REAL8 LALInferenceEnsembleStretchNames(LALInferenceThreadState *thread,
                                        LALInferenceVariables *currentParams,
                                        LALInferenceVariables *proposedParams,
                                        const char **names) {
-    size_t i, N, Ndim, nPts;
+    size_t i, j, N, Ndim, nPts;
     REAL8 logPropRatio;
     REAL8 maxScale, Y, logmax, X, scale;
     REAL8 cur, other, x;
@@ -911,18 +946,47 @@ REAL8 LALInferenceEnsembleStretchNames(LALInferenceThreadState *thread,
 
     dePts = thread->differentialPoints;
     nPts = thread->differentialPointsLength;
+    if (thread->differentialBuffer)
+        nPts = thread->differentialBuffer->length;
+    else if (dePts == NULL)
+        nPts = 0;
 
-    if (dePts == NULL || nPts <= 1) {
+    if (nPts <= 1) {
         logPropRatio = 0.0;
         return logPropRatio; /* Quit now, since we don't have any points to use. */
     }
 
+    /* With a DE buffer, work on rows of the buffer in the layout of currentParams */
+    const LALInferenceDEBuffer *buffer = thread->differentialBuffer;
+    LALInferenceVariablesLayout *layout = NULL;
+    size_t nSlot = 1;
+    if (buffer) {
+        layout = thread_param_layout(thread, currentParams);
+        if (layout->length > 0)
+            nSlot = layout->length;
+    }
+    INT4 cols[nSlot];
+    REAL8 xCur[nSlot];
+    const REAL8 *xI = NULL;
+
     /* Choose a different sample */
-    do {
-        i = gsl_rng_uniform_int(thread->GSLrandom, nPts);
-    } while (!LALInferenceCompareVariables(currentParams, dePts[i]));
+    if (buffer) {
+        de_buffer_columns(buffer, layout, names == local_names ? NULL : names, cols);
+        LALInferenceCopyVariablesToLayoutArray(layout, currentParams, xCur);
+        do {
+            i = gsl_rng_uniform_int(thread->GSLrandom, nPts);
+            xI = buffer->data + i*buffer->layout->length;
+            for (j = 0; j < layout->length; j++)
+                if (cols[j] >= 0 && xI[cols[j]] != xCur[j])
+                    break;
+        } while (j == layout->length);
+    } else {
+        do {
+            i = gsl_rng_uniform_int(thread->GSLrandom, nPts);
+        } while (!LALInferenceCompareVariables(currentParams, dePts[i]));
 
-    ptI = dePts[i];
+        ptI = dePts[i];
+    }
 
     /* Scale z is chosen according to be symmetric under z -> 1/z */
     /* so p(x) \propto 1/z between 1/a and a */
@@ -936,15 +1000,25 @@ REAL8 LALInferenceEnsembleStretchNames(LALInferenceThreadState *thread,
     X = 2.0*logmax*Y - logmax;
     scale = exp(X);
 
-    for (i = 0; names[i] != NULL; i++) {
-        /* Ignore variable if it's not in each of the params. */
-        if (LALInferenceCheckVariableNonFixed(proposedParams, names[i]) &&
-            LALInferenceCheckVariableNonFixed(ptI, names[i])) {
-                cur = LALInferenceGetREAL8Variable(proposedParams, names[i]);
-                other= LALInferenceGetREAL8Variable(ptI, names[i]);
-                x = other + scale*(cur-other);
-
-                LALInferenceSetVariable(proposedParams, names[i], &x);
+    if (buffer) {
+        for (j = 0; j < layout->length; j++) {
+            if (cols[j] >= 0) {
+                other = xI[cols[j]];
+                xCur[j] = other + scale*(xCur[j]-other);
+            }
+        }
+        LALInferenceCopyLayoutArrayToVariables(layout, xCur, proposedParams);
+    } else {
+        for (i = 0; names[i] != NULL; i++) {
+            /* Ignore variable if it's not in each of the params. */
+            if (LALInferenceCheckVariableNonFixed(proposedParams, names[i]) &&
+                LALInferenceCheckVariableNonFixed(ptI, names[i])) {
+                    cur = LALInferenceGetREAL8Variable(proposedParams, names[i]);
+                    other= LALInferenceGetREAL8Variable(ptI, names[i]);
+                    x = other + scale*(cur-other);
+
+                    LALInferenceSetVariable(proposedParams, names[i], &x);
+            }
         }
     }
 
@@ -1018,8 +1092,12 @@ REAL8 LALInferenceEnsembleWalkNames(LALInferenceThreadState *thread,
 
   LALInferenceVariables **dePts = thread->differentialPoints;
   size_t nPts = thread->differentialPointsLength;
+  if (thread->differentialBuffer)
+    nPts = thread->differentialBuffer->length;
+  else if (dePts == NULL)
+    nPts = 0;
 
-  if (dePts == NULL || nPts <= 1) {
+  if (nPts <= 1) {
     logPropRatio = 0.0;
     return logPropRatio; /* Quit now, since we don't have any points to use. */
   }
@@ -1036,6 +1114,34 @@ REAL8 LALInferenceEnsembleWalkNames(LALInferenceThreadState *thread,
   double univariate_normals[sample_size];
   for(i=0;i<sample_size;i++) univariate_normals[i] = gsl_ran_ugaussian(thread->GSLrandom);
 
+  if (thread->differentialBuffer) {
+    /* Work on rows of the DE buffer */
+    const LALInferenceDEBuffer *buffer = thread->differentialBuffer;
+    LALInferenceVariablesLayout *layout = thread_param_layout(thread, proposedParams);
+    const size_t nSlot = layout->length > 0 ? layout->length : 1;
+    INT4 cols[nSlot];
+    REAL8 x[nSlot];
+    const REAL8 *rows[sample_size];
+
+    de_buffer_columns(buffer, layout, names == local_names ? NULL : names, cols);
+    LALInferenceCopyVariablesToLayoutArray(layout, proposedParams, x);
+    for(i=0;i<sample_size;i++) rows[i] = buffer->data + indices[i]*buffer->layout->length;
+
+    for(k=0;k<layout->length;k++)
+    {
+      if(cols[k]<0) continue;
+      REAL8 centre_of_mass=0.0;
+      for(i=0;i<sample_size;i++)
+        centre_of_mass+=rows[i][cols[k]]/((REAL8)sample_size);
+      for(i=0,w=0.0;i<sample_size;i++)
+        w+= univariate_normals[i] * (rows[i][cols[k]] - centre_of_mass);
+      x[k] += w;
+    }
+    LALInferenceCopyLayoutArrayToVariables(layout, x, proposedParams);
+
+    return logPropRatio;
+  }
+
   /* Note: Simplified this loop on master 2015-08-12, take this version when rebasing */
   for(k=0;names[k]!=NULL;k++)
   {
@@ -1064,8 +1170,8 @@ REAL8 LALInferenceDifferentialEvolutionNames(LALInferenceThreadState *thread,
                                     LALInferenceVariables *currentParams,
                                     LALInferenceVariables *proposedParams,
                                     const char **names) {
-    size_t i, j, N, Ndim, nPts;
-    LALInferenceVariableItem *item;
+    size_t i, j, Ndim, nPts;
+    LALInferenceVariablesLayout *layout = NULL;
     LALInferenceVariables **dePts;
     LALInferenceVariables *ptI, *ptJ;
     REAL8 logPropRatio = 0.0;
@@ -1075,35 +1181,24 @@ REAL8 LALInferenceDifferentialEvolutionNames(LALInferenceThreadState *thread,
     gsl_rng *rng = thread->GSLrandom;
 
     if (names == NULL) {
-        N = LALInferenceGetVariableDimension(currentParams) + 1; /* More names than we need. */
-        names = alloca(N * sizeof(char *)); /* Hope we have alloca---saves
-                                               having to deallocate after
-                                               proposal. */
-
-        item = currentParams->head;
-        i = 0;
-        while (item != NULL) {
-            if (LALInferenceCheckVariableNonFixed(currentParams, item->name) && item->type==LALINFERENCE_REAL8_t ) {
-                names[i] = item->name;
-                i++;
-            }
-
-            item = item->next;
+        /* All varying REAL8 parameters, as given by the layout of currentParams */
+        layout = thread_param_layout(thread, currentParams);
+        Ndim = layout->length;
+    } else {
+        for (Ndim=0, i=0; names[i] != NULL; i++ ) {
+            if (LALInferenceCheckVariableNonFixed(currentParams, names[i]))
+                Ndim++;
         }
-        names[i]=NULL; /* Terminate */
-    }
-
-
-    Ndim = 0;
-    for (Ndim=0, i=0; names[i] != NULL; i++ ) {
-        if (LALInferenceCheckVariableNonFixed(currentParams, names[i]))
-            Ndim++;
     }
 
     dePts = thread->differentialPoints;
     nPts = thread->differentialPointsLength;
+    if (thread->differentialBuffer)
+        nPts = thread->differentialBuffer->length;
+    else if (dePts == NULL)
+        nPts = 0;
 
-    if (dePts == NULL || nPts <= 1)
+    if (nPts <= 1)
         return logPropRatio; /* Quit now, since we don't have any points to use. */
 
     LALInferenceCopyVariables(currentParams, proposedParams);
@@ -1114,9 +1209,6 @@ REAL8 LALInferenceDifferentialEvolutionNames(LALInferenceThreadState *thread,
         j = gsl_rng_uniform_int(rng, nPts);
     } while (j == i);
 
-    ptI = dePts[i];
-    ptJ = dePts[j];
-
     const REAL8 modeHoppingFrac = 0.5;
     /* Some fraction of the time, we do a "mode hopping" jump,
        where we jump exactly along the difference vector. */
@@ -1128,6 +1220,56 @@ REAL8 LALInferenceDifferentialEvolutionNames(LALInferenceThreadState *thread,
         scale = 2.38/sqrt(Ndim) * exp(log(0.1) + log(100.0) * gsl_rng_uniform(rng));
     }
 
+    if (thread->differentialBuffer) {
+        /* Jump along the difference of two rows of the DE buffer */
+        const LALInferenceDEBuffer *buffer = thread->differentialBuffer;
+        if (layout == NULL)
+            layout = thread_param_layout(thread, currentParams);
+        const size_t nSlot = layout->length > 0 ? layout->length : 1;
+        INT4 cols[nSlot];
+        REAL8 xCur[nSlot];
+        const REAL8 *xI = buffer->data + i*buffer->layout->length;
+        const REAL8 *xJ = buffer->data + j*buffer->layout->length;
+
+        de_buffer_columns(buffer, layout, names, cols);
+        LALInferenceCopyVariablesToLayoutArray(layout, currentParams, xCur);
+        for (i = 0; i < layout->length; i++) {
+            if (cols[i] >= 0) {
+                xCur[i] += scale * xJ[cols[i]];
+                xCur[i] -= scale * xI[cols[i]];
+            }
+        }
+        LALInferenceCopyLayoutArrayToVariables(layout, xCur, proposedParams);
+
+        return logPropRatio;
+    }
+
+    ptI = dePts[i];
+    ptJ = dePts[j];
+
+    if (layout != NULL) {
+        /* Vectorised jump, if the points hold the same parameters as currentParams */
+        if (LALInferenceVariablesLayoutMatches(layout, ptI) && LALInferenceVariablesLayoutMatches(layout, ptJ)) {
+            REAL8 xCur[Ndim > 0 ? Ndim : 1], xI[Ndim > 0 ? Ndim : 1], xJ[Ndim > 0 ? Ndim : 1];
+            LALInferenceCopyVariablesToLayoutArray(layout, currentParams, xCur);
+            LALInferenceCopyVariablesToLayoutArray(layout, ptI, xI);
+            LALInferenceCopyVariablesToLayoutArray(layout, ptJ, xJ);
+            for (i = 0; i < Ndim; i++) {
+                xCur[i] += scale * xJ[i];
+                xCur[i] -= scale * xI[i];
+            }
+            LALInferenceCopyLayoutArrayToVariables(layout, xCur, proposedParams);
+
+            return logPropRatio;
+        }
+
+        /* Otherwise fall back to looking up each parameter by name */
+        names = alloca((Ndim + 1) * sizeof(char *));
+        for (i = 0; i < Ndim; i++)
+            names[i] = layout->names[i];
+        names[Ndim] = NULL; /* Terminate */
+    }
+
     for (i = 0; names[i] != NULL; i++) {
         if (!LALInferenceCheckVariableNonFixed(currentParams, names[i]) ||
             !LALInferenceCheckVariable(ptJ, names[i]) ||
@@ -3213,7 +3355,8 @@ void LALInferenceDumpClusteredKDEDraws(LALInferenceClusteredKDE *kde, char *outp
  * Add a KDE proposal to the KDE proposal set.
  *
  * If other KDE proposals already exist, the provided KDE is appended to the list, otherwise it is added
- * as the first of such proposals.
+ * as the first of such proposals.  An existing proposal with the same name is replaced, and is destroyed
+ * and freed along with its clustering.
  * @param     propArgs The proposal arguments to be added to.
  * @param[in] kde      The proposal to be added to \a thread->cycle.
  */
@@ -3249,6 +3392,7 @@ void LALInferenceAddClusteredKDEProposalToSet(LALInferenceVariables *propArgs, L
         }
 
         LALInferenceDestroyClusteredKDEProposal(old_kde);
+        XLALFree(old_kde);
     }
 
     return;
@@ -3344,6 +3488,23 @@ void LALInferenceSetupClusteredKDEProposalFromRun(LALInferenceThreadState *threa
 
     /* Build the proposal */
     LALInferenceClusteredKDE *proposal = XLALCalloc(1, sizeof(LALInferenceClusteredKDE));
+
+    /* If requested, update the previous clustering instead of searching for the number of clusters again */
+    if (LALInferenceCheckVariable(thread->proposalArgs, "incremental_kde") &&
+        LALInferenceGetINT4Variable(thread->proposalArgs, "incremental_kde") &&
+        LALInferenceCheckVariable(thread->proposalArgs, clusteredKDEProposalName)) {
+        LALInferenceClusteredKDE *existing_kde = *((LALInferenceClusteredKDE **)LALInferenceGetVariable(thread->proposalArgs, clusteredKDEProposalName));
+        while (existing_kde && strcmp(existing_kde->name, clusteredKDEProposalName))
+            existing_kde = existing_kde->next;
+
+        INT4 dim = LALInferenceGetVariableDimensionNonFixed(clusterParams);
+        if (existing_kde && existing_kde->kmeans && existing_kde->kmeans->dim == dim) {
+            gsl_matrix_view mview = gsl_matrix_view_array(samples, size, dim);
+            INT4 batch_size = 100;
+            proposal->kmeans = LALInferenceKmeansUpdateFromSamples(existing_kde->kmeans, &mview.matrix, batch_size, thread->GSLrandom);
+        }
+    }
+
     LALInferenceInitClusteredKDEProposal(thread, proposal, samples, size, clusterParams, clusteredKDEProposalName, weight, LALInferenceOptimizedKmeans, cyclic_reflective, ntrials);
 
     /* Only add the kmeans was successfully setup */
@@ -1419,13 +1419,16 @@ void LALInferenceTemplateXLALSimInspiralChooseWaveformPhaseInterpolated(LALInfer
 
     /* ==== Call the waveform generator ==== */
     if(model->domain == LAL_SIM_DOMAIN_FREQUENCY) {
-        if(!frequencies) frequencies = LALInferenceMultibandFrequencies(Nbands,f_start,0.5/deltaT, model->deltaF, mc_min);
+        /* The multibanded likelihood uses its own nodes and the template there directly */
+        REAL8Sequence *nodes = frequencies;
+        if(model->multiband_flag) nodes = model->multiband->frequencies;
+        else if(!frequencies) nodes = frequencies = LALInferenceMultibandFrequencies(Nbands,f_start,0.5/deltaT, model->deltaF, mc_min);
 
 
         XLAL_TRY(ret=XLALSimInspiralChooseFDWaveformFromCache(&hptilde, &hctilde, phi0,
                                                               0.0, m1*LAL_MSUN_SI, m2*LAL_MSUN_SI, spin1x, spin1y, spin1z,
                                                               spin2x, spin2y, spin2z, f_start, f_max, f_ref, distance, inclination, model->LALpars,
-                                                              approximant,model->waveformCache, frequencies), errnum);
+                                                              approximant,model->waveformCache, nodes), errnum);
 
         /* if the waveform failed to generate, fill the buffer with zeros
          * so that the previous waveform is not left there
@@ -1433,6 +1436,11 @@ void LALInferenceTemplateXLALSimInspiralChooseWaveformPhaseInterpolated(LALInfer
         if(ret!=XLAL_SUCCESS){
             memset(model->freqhPlus->data->data,0,sizeof(model->freqhPlus->data->data[0])*model->freqhPlus->data->length);
             memset(model->freqhCross->data->data,0,sizeof(model->freqhCross->data->data[0])*model->freqhCross->data->length);
+            if(model->multiband_flag) {
+                if ( model->multiband->hptilde ) XLALDestroyCOMPLEX16FrequencySeries(model->multiband->hptilde);
+                if ( model->multiband->hctilde ) XLALDestroyCOMPLEX16FrequencySeries(model->multiband->hctilde);
+                model->multiband->hptilde = model->multiband->hctilde = NULL;
+            }
             if ( hptilde ) XLALDestroyCOMPLEX16FrequencySeries(hptilde);
             if ( hctilde ) XLALDestroyCOMPLEX16FrequencySeries(hctilde);
             errnum&=~XLAL_EFUNC; /* Mask out the internal function failure bit */
@@ -1463,8 +1471,17 @@ model->LALpars,%d,model->waveformCache)\n",__func__,
         }
 
 
-        InterpolateWaveform(frequencies, hptilde, model->freqhPlus);
-        InterpolateWaveform(frequencies, hctilde, model->freqhCross);
+        if(model->multiband_flag) {
+            if ( model->multiband->hptilde ) XLALDestroyCOMPLEX16FrequencySeries(model->multiband->hptilde);
+            if ( model->multiband->hctilde ) XLALDestroyCOMPLEX16FrequencySeries(model->multiband->hctilde);
+            model->multiband->hptilde = hptilde;
+            model->multiband->hctilde = hctilde;
+            hptilde = hctilde = NULL;
+        }
+        else {
+            InterpolateWaveform(frequencies, hptilde, model->freqhPlus);
+            InterpolateWaveform(frequencies, hctilde, model->freqhCross);
+        }
 
         REAL8 instant = model->freqhPlus->epoch.gpsSeconds + 1e-9*model->freqhPlus->epoch.gpsNanoSeconds;
         LALInferenceSetVariable(model->params, "time", &instant);
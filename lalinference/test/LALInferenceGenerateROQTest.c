@@ -1,9 +1,12 @@
 #include <lal/LALInferenceGenerateROQ.h>
 #include <lal/LALConstants.h>
+#include <lal/H5FileIO.h>
 #include <gsl/gsl_randist.h>
 
 #include <time.h>
 #include <math.h>
+#include <stdio.h>
+#include <string.h>
 
 /* check whether to include omp.h for use of multiple cores */
 #ifdef HAVE_OPENMP
@@ -127,6 +130,44 @@ int main(void) {
   maxprojerr = LALInferenceGenerateCOMPLEX16OrthonormalBasis(&cRBlinear, fweights, tolerance, &cTS, &gdpts);
   XLALDestroyUINT4Vector( gdpts );
   fprintf(stderr, "No. linear nodes (complex) = %d, %d x %d; Maximum projection err. = %le\n", cRBlinear->dimLength->data[0], cRBlinear->dimLength->data[0], cRBlinear->dimLength->data[1], maxprojerr);
+
+  /* generate the complex basis again, streaming the training set from a file in two blocks */
+  {
+    const char *tsfile = "LALInferenceGenerateROQTest_TS.h5", *cpfile = "LALInferenceGenerateROQTest_checkpoint.h5";
+    COMPLEX16Array *cRBfile = NULL, *cRBresume = NULL;
+    UINT4Vector *blockdims = XLALCreateUINT4Vector( 2 );
+    LALH5File *h5file = XLALH5FileOpen(tsfile, "w");
+    for ( k=0; k<2; k++ ){
+      char blockname[16];
+      snprintf(blockname, sizeof(blockname), "block%zu", k);
+      blockdims->data[0] = TSsize/2;
+      blockdims->data[1] = wl;
+      COMPLEX16Array *block = XLALCreateCOMPLEX16Array( blockdims );
+      memcpy(block->data, &(cTS->data[k*(TSsize/2)*wl]), (TSsize/2)*wl*sizeof(COMPLEX16));
+      XLALH5FileWriteCOMPLEX16Array(h5file, blockname, block);
+      XLALDestroyCOMPLEX16Array( block );
+    }
+    XLALH5FileClose(h5file);
+    XLALDestroyUINT4Vector( blockdims );
+
+    remove(cpfile);
+    maxprojerr = LALInferenceGenerateCOMPLEX16OrthonormalBasisFromFile(&cRBfile, fweights, tolerance, tsfile, cpfile, &gdpts);
+    XLALDestroyUINT4Vector( gdpts );
+    fprintf(stderr, "No. linear nodes (complex, from file) = %d, %d x %d; Maximum projection err. = %le\n", cRBfile->dimLength->data[0], cRBfile->dimLength->data[0], cRBfile->dimLength->data[1], maxprojerr);
+
+    /* the streamed basis must represent the whole training set */
+    if ( LALInferenceTestCOMPLEX16OrthonormalBasis(fweights, 1e3*tolerance, cRBfile, &cTS) != XLAL_SUCCESS ){ return 1; }
+
+    /* resuming from the final checkpoint must give back the same basis */
+    LALInferenceGenerateCOMPLEX16OrthonormalBasisFromFile(&cRBresume, fweights, tolerance, tsfile, cpfile, &gdpts);
+    XLALDestroyUINT4Vector( gdpts );
+    if ( cRBresume->dimLength->data[0] != cRBfile->dimLength->data[0] || memcmp(cRBresume->data, cRBfile->data, cRBfile->dimLength->data[0]*wl*sizeof(COMPLEX16)) != 0 ){ return 1; }
+
+    XLALDestroyCOMPLEX16Array( cRBfile );
+    XLALDestroyCOMPLEX16Array( cRBresume );
+    remove(tsfile);
+    remove(cpfile);
+  }
   maxprojerr = LALInferenceGenerateREAL8OrthonormalBasis(&RBquad, fweights, tolerance, &TSquad, &gdpts);
   XLALDestroyUINT4Vector( gdpts );
   fprintf(stderr, "No. quadratic nodes (real)  = %d, %d x %d; Maximum projection err. = %le\n", RBquad->dimLength->data[0], RBquad->dimLength->data[0], RBquad->dimLength->data[1], maxprojerr);
@@ -0,0 +1,266 @@
+/*
+ *  LALInferenceKDETest.c:  Unit tests and timing for LALInferenceKDE.c
+ *                          and LALInferenceClusteredKDE.c
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with with program; see the file COPYING. If not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ *  MA  02111-1307  USA
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+#include <lal/LALStdlib.h>
+#include <lal/XLALError.h>
+#include <lal/LogPrintf.h>
+#include <lal/LALInferenceKDE.h>
+#include <lal/LALInferenceClusteredKDE.h>
+#include <lal/LALInferencePrior.h>
+#include <lal/LALInferenceProposal.h>
+#include "LALInferenceTest.h"
+
+#define KDE_TEST_NPTS 10000
+#define KDE_TEST_DIM 6
+#define KDE_TEST_NEVAL 500
+#define KMEANS_TEST_NPTS 3000
+
+/* Correlated samples from three separated Gaussian blobs */
+static REAL8 *drawSamples(gsl_rng *rng, INT4 npts, INT4 dim);
+static REAL8 *drawSamples(gsl_rng *rng, INT4 npts, INT4 dim)
+{
+	REAL8 *pts = XLALMalloc(npts * dim * sizeof(REAL8));
+	for (INT4 i = 0; i < npts; i++)
+	{
+		REAL8 common = gsl_ran_ugaussian(rng);
+		for (INT4 p = 0; p < dim; p++)
+			pts[i*dim + p] = 10.0 * (i % 3) + (p + 1) * (common + 0.5 * gsl_ran_ugaussian(rng));
+	}
+	return pts;
+}
+
+int LALInferenceKDEEvaluatePoint_TEST(void);
+int LALInferenceKDEEvaluatePoint_TEST(void)
+{
+	TEST_HEADER();
+
+	gsl_rng *rng = gsl_rng_alloc(gsl_rng_mt19937);
+	gsl_rng_set(rng, 1234);
+
+	REAL8 *pts = drawSamples(rng, KDE_TEST_NPTS, KDE_TEST_DIM);
+	LALInferenceKDE *kde = LALInferenceNewKDE(pts, KDE_TEST_NPTS, KDE_TEST_DIM, NULL);
+
+	/* Impose a reflective and a cyclic boundary to exercise the images */
+	kde->lower_bound_types[0] = LALINFERENCE_PARAM_LINEAR;
+	kde->lower_bounds[0] = -5.0;
+	kde->upper_bounds[0] = 30.0;
+	kde->lower_bound_types[1] = kde->upper_bound_types[1] = LALINFERENCE_PARAM_CIRCULAR;
+	kde->lower_bounds[1] = -10.0;
+	kde->upper_bounds[1] = 40.0;
+
+	/* Evaluate near the samples, plus some offset into the tails */
+	REAL8 *evals = XLALMalloc(KDE_TEST_NEVAL * KDE_TEST_DIM * sizeof(REAL8));
+	for (INT4 i = 0; i < KDE_TEST_NEVAL; i++)
+		for (INT4 p = 0; p < KDE_TEST_DIM; p++)
+			evals[i*KDE_TEST_DIM + p] = pts[(7*i % KDE_TEST_NPTS)*KDE_TEST_DIM + p] + gsl_ran_gaussian(rng, 2.0);
+
+	REAL8 *direct = XLALMalloc(KDE_TEST_NEVAL * sizeof(REAL8));
+	REAL8 *tree = XLALMalloc(KDE_TEST_NEVAL * sizeof(REAL8));
+	REAL8 *batch = XLALMalloc(KDE_TEST_NEVAL * sizeof(REAL8));
+
+	REAL8 tic = XLALGetTimeOfDay();
+	for (INT4 i = 0; i < KDE_TEST_NEVAL; i++)
+		direct[i] = LALInferenceKDEEvaluatePointDirect(kde, evals + i*KDE_TEST_DIM);
+	REAL8 direct_time = XLALGetTimeOfDay() - tic;
+
+	tic = XLALGetTimeOfDay();
+	for (INT4 i = 0; i < KDE_TEST_NEVAL; i++)
+		tree[i] = LALInferenceKDEEvaluatePoint(kde, evals + i*KDE_TEST_DIM);
+	REAL8 tree_time = XLALGetTimeOfDay() - tic;
+
+	tic = XLALGetTimeOfDay();
+	LALInferenceKDEEvaluatePoints(kde, evals, KDE_TEST_NEVAL, batch);
+	REAL8 batch_time = XLALGetTimeOfDay() - tic;
+
+	for (INT4 i = 0; i < KDE_TEST_NEVAL; i++)
+	{
+		if (!compareFloats(tree[i], direct[i], 1e-8 * (1.0 + fabs(direct[i]))))
+			TEST_FAIL("Point %i: tree log PDF %.12g differs from direct %.12g", i, tree[i], direct[i]);
+		if (batch[i] != tree[i])
+			TEST_FAIL("Point %i: batched log PDF %.12g differs from single-point %.12g", i, batch[i], tree[i]);
+	}
+
+	/* Points outside a fixed boundary have zero density */
+	kde->lower_bound_types[2] = LALINFERENCE_PARAM_FIXED;
+	kde->lower_bounds[2] = 1e6;
+	if (!isinf(LALInferenceKDEEvaluatePoint(kde, evals)))
+		TEST_FAIL("Point outside a fixed boundary has finite density");
+
+	printf("%i points in %i dimensions, %i evaluations: %.3f s direct, %.3f s tree, %.3f s batched\n",
+		KDE_TEST_NPTS, KDE_TEST_DIM, KDE_TEST_NEVAL, direct_time, tree_time, batch_time);
+
+	XLALFree(direct);
+	XLALFree(tree);
+	XLALFree(batch);
+	XLALFree(evals);
+	LALInferenceDestroyKDE(kde);
+	XLALFree(pts);
+	gsl_rng_free(rng);
+
+	TEST_FOOTER();
+}
+
+/* Check every point of a kmeans is assigned to its nearest centroid */
+static INT4 countMisassigned(LALInferenceKmeans *kmeans);
+static INT4 countMisassigned(LALInferenceKmeans *kmeans)
+{
+	INT4 misassigned = 0;
+	for (INT4 i = 0; i < kmeans->npts; i++)
+	{
+		gsl_vector_view x = gsl_matrix_row(kmeans->data, i);
+		gsl_vector_view a = gsl_matrix_row(kmeans->centroids, kmeans->assignments[i]);
+		REAL8 assigned_dist = euclidean_dist_squared(&x.vector, &a.vector);
+		for (INT4 j = 0; j < kmeans->k; j++)
+		{
+			gsl_vector_view c = gsl_matrix_row(kmeans->centroids, j);
+			if (euclidean_dist_squared(&x.vector, &c.vector) < assigned_dist)
+			{
+				misassigned++;
+				break;
+			}
+		}
+	}
+	return misassigned;
+}
+
+/* A thread with one non-fixed, bounded parameter per dimension of the samples */
+static LALInferenceThreadState *createThread(gsl_rng *rng, INT4 dim);
+static LALInferenceThreadState *createThread(gsl_rng *rng, INT4 dim)
+{
+	LALInferenceThreadState *thread = XLALCalloc(1, sizeof(LALInferenceThreadState));
+	thread->currentParams = XLALCalloc(1, sizeof(LALInferenceVariables));
+	thread->priorArgs = XLALCalloc(1, sizeof(LALInferenceVariables));
+	thread->proposalArgs = XLALCalloc(1, sizeof(LALInferenceVariables));
+	thread->GSLrandom = rng;
+
+	for (INT4 p = 0; p < dim; p++)
+	{
+		char name[VARNAME_MAX];
+		REAL8 min = -50.0, max = 100.0;
+		snprintf(name, sizeof(name), "x%i", p);
+		LALInferenceAddREAL8Variable(thread->currentParams, name, 0.0, LALINFERENCE_PARAM_LINEAR);
+		LALInferenceAddMinMaxPrior(thread->priorArgs, name, &min, &max, LALINFERENCE_REAL8_t);
+	}
+	LALInferenceAddINT4Variable(thread->proposalArgs, "verbose", 0, LALINFERENCE_PARAM_FIXED);
+	LALInferenceAddINT4Variable(thread->proposalArgs, "incremental_kde", 1, LALINFERENCE_PARAM_FIXED);
+	return thread;
+}
+
+static void destroyThread(LALInferenceThreadState *thread);
+static void destroyThread(LALInferenceThreadState *thread)
+{
+	if (LALInferenceCheckVariable(thread->proposalArgs, clusteredKDEProposalName))
+	{
+		LALInferenceClusteredKDE *kde = *((LALInferenceClusteredKDE **)LALInferenceGetVariable(thread->proposalArgs, clusteredKDEProposalName));
+		LALInferenceDestroyClusteredKDEProposal(kde);
+		XLALFree(kde);
+	}
+	LALInferenceClearVariables(thread->currentParams);
+	LALInferenceClearVariables(thread->priorArgs);
+	LALInferenceClearVariables(thread->proposalArgs);
+	XLALFree(thread->currentParams);
+	XLALFree(thread->priorArgs);
+	XLALFree(thread->proposalArgs);
+	XLALFree(thread);
+}
+
+int LALInferenceIncrementalClusteredKDEProposal_TEST(void);
+int LALInferenceIncrementalClusteredKDEProposal_TEST(void)
+{
+	TEST_HEADER();
+
+	gsl_rng *rng = gsl_rng_alloc(gsl_rng_mt19937);
+	gsl_rng_set(rng, 4321);
+	LALInferenceThreadState *thread = createThread(rng, KDE_TEST_DIM);
+
+	/* The first proposal is clustered from scratch */
+	REAL8 *pts = drawSamples(rng, KMEANS_TEST_NPTS, KDE_TEST_DIM);
+	REAL8 tic = XLALGetTimeOfDay();
+	LALInferenceSetupClusteredKDEProposalFromRun(thread, pts, KMEANS_TEST_NPTS, 1, 5);
+	REAL8 fresh_time = XLALGetTimeOfDay() - tic;
+	if (!LALInferenceCheckVariable(thread->proposalArgs, clusteredKDEProposalName))
+		TEST_FAIL("Failed to set up the clustered-KDE proposal");
+	LALInferenceClusteredKDE *kde = *((LALInferenceClusteredKDE **)LALInferenceGetVariable(thread->proposalArgs, clusteredKDEProposalName));
+	INT4 k = kde->kmeans->k;
+
+	/* The second updates that clustering with a fresh, larger set of samples */
+	REAL8 *new_pts = drawSamples(rng, 2*KMEANS_TEST_NPTS, KDE_TEST_DIM);
+	tic = XLALGetTimeOfDay();
+	LALInferenceSetupClusteredKDEProposalFromRun(thread, new_pts, 2*KMEANS_TEST_NPTS, 1, 5);
+	REAL8 update_time = XLALGetTimeOfDay() - tic;
+	kde = *((LALInferenceClusteredKDE **)LALInferenceGetVariable(thread->proposalArgs, clusteredKDEProposalName));
+	if (kde->next)
+		TEST_FAIL("Updated proposal was appended instead of replacing the previous one");
+	if (kde->kmeans->k != k || kde->kmeans->npts != 2*KMEANS_TEST_NPTS)
+		TEST_FAIL("Updated clustering has k=%i, npts=%i, expected k=%i, npts=%i", kde->kmeans->k, kde->kmeans->npts, k, 2*KMEANS_TEST_NPTS);
+	INT4 misassigned = countMisassigned(kde->kmeans);
+	if (misassigned)
+		TEST_FAIL("%i points not assigned to their nearest centroid after update", misassigned);
+
+	/* Draw from the updated proposal, starting from one of the samples */
+	LALInferenceVariables proposed;
+	memset(&proposed, 0, sizeof(proposed));
+	INT4 p = 0;
+	for (LALInferenceVariableItem *item = thread->currentParams->head; item; item = item->next)
+		LALInferenceSetREAL8Variable(thread->currentParams, item->name, new_pts[p++]);
+	for (INT4 i = 0; i < 100; i++)
+	{
+		REAL8 logPropRatio = LALInferenceClusteredKDEProposal(thread, thread->currentParams, &proposed);
+		if (!isfinite(logPropRatio))
+			TEST_FAIL("Draw %i: log proposal ratio %g is not finite", i, logPropRatio);
+		for (LALInferenceVariableItem *item = proposed.head; item; item = item->next)
+		{
+			REAL8 x = *(REAL8 *)item->value;
+			if (!isfinite(x) || x < -50.0 || x > 100.0)
+				TEST_FAIL("Draw %i: %s = %g is outside the prior", i, item->name, x);
+		}
+		LALInferenceCopyVariables(&proposed, thread->currentParams);
+	}
+	LALInferenceClearVariables(&proposed);
+
+	printf("Proposal from %i points: %.3f s updated, %i points from scratch: %.3f s\n",
+		2*KMEANS_TEST_NPTS, update_time, KMEANS_TEST_NPTS, fresh_time);
+
+	destroyThread(thread);
+	XLALFree(pts);
+	XLALFree(new_pts);
+	gsl_rng_free(rng);
+
+	TEST_FOOTER();
+}
+
+int main(void)
+{
+	int failureCount = 0;
+
+	XLALSetErrorHandler(XLALExitErrorHandler);
+
+	TEST_RUN(LALInferenceKDEEvaluatePoint_TEST, failureCount);
+	TEST_RUN(LALInferenceIncrementalClusteredKDEProposal_TEST, failureCount);
+
+	LALCheckMemoryLeaks();
+
+	return failureCount;
+}
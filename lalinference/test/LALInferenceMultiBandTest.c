@@ -27,6 +27,8 @@
 #include <lal/LALInferenceCalibrationErrors.h>
 #include <lal/LALInferenceTemplate.h>
 #include <lal/LALInferenceLikelihood.h>
+#include <lal/LALInferenceMultibanding.h>
+#include <lal/LogPrintf.h>
 #include <sys/resource.h>
 
 #ifdef __GNUC__
@@ -38,7 +40,8 @@
 const char HELPSTR[]=\
 "LALInferenceMultiBandTest: Unit test for consistency between multiband and regular template functions.\n\
  Example (for 1.4-1.4 binary with seglen 32, srate 4096): \n\
- $ ./LALInferenceMultiBandTest --psdlength 1000 --psdstart 1 --seglen 32 --srate 4096 --trigtime 0 --ifo H1 --H1-channel LALSimAdLIGO --H1-cache LALSimAdLIGO --dataseed 1324 --fix-chirpmass 1.218 --fix-q 1.0 --margphi\n\n\n\
+ $ ./LALInferenceMultiBandTest --psdlength 1000 --psdstart 1 --seglen 32 --srate 4096 --trigtime 0 --ifo H1 --H1-channel LALSimAdLIGO --H1-cache LALSimAdLIGO --dataseed 1324 --fix-chirpmass 1.218 --fix-q 1.0 --margphi\n\
+ With --multiband-likelihood, compares the multibanded likelihood against the full-resolution likelihood instead.\n\n\n\
 ";
 
 COMPLEX16 compute_mismatch(LALInferenceIFOData *data, COMPLEX16FrequencySeries *a, COMPLEX16FrequencySeries *b);
@@ -130,6 +133,41 @@ int compare_template(LALInferenceRunState *runState)
   return(result);
 }
 
+int compare_likelihood(LALInferenceRunState *runState);
+int compare_likelihood(LALInferenceRunState *runState)
+{
+  const int nevals = 20;
+  REAL8 tolerance = 0.1; /* Error in log likelihood */
+  LALInferenceModel *model = runState->threads[0]->model;
+  LALInferenceTemplateFunction mbtemplate = model->templt;
+  REAL8 logLmb = 0.0, logLfull = 0.0;
+
+  REAL8 tic = XLALGetTimeOfDay();
+  for (int i = 0; i < nevals; i++)
+    logLmb = runState->likelihood(model->params, runState->data, model);
+  REAL8 mbtime = (XLALGetTimeOfDay() - tic)/nevals;
+
+  model->multiband_flag = 0;
+  model->templt = &LALInferenceTemplateXLALSimInspiralChooseWaveform;
+  tic = XLALGetTimeOfDay();
+  for (int i = 0; i < nevals; i++)
+    logLfull = runState->likelihood(model->params, runState->data, model);
+  REAL8 fulltime = (XLALGetTimeOfDay() - tic)/nevals;
+  model->multiband_flag = 1;
+  model->templt = mbtemplate;
+
+  int result = fabs(logLmb - logLfull) < tolerance;
+
+  fprintf(stdout,"Parameter values:\n");
+  LALInferencePrintVariables(model->params);
+  fprintf(stdout,"\n\n");
+  fprintf(stdout,"log(L) full = %lf, multiband = %lf, difference = %le\n",logLfull,logLmb,logLmb-logLfull);
+  fprintf(stdout,"Time per likelihood: full = %le s, multiband = %le s, speed-up = %lf\n",fulltime,mbtime,fulltime/mbtime);
+  fprintf(stdout,"Tolerance = %le\n",tolerance);
+  fprintf(stdout,"Test result: %s\n",result?"passed":"failed");
+  return(result);
+}
+
 /* Computes <a-b|a-b> */
 COMPLEX16 compute_mismatch(LALInferenceIFOData *data, COMPLEX16FrequencySeries *a, COMPLEX16FrequencySeries *b)
 {
@@ -169,7 +207,11 @@ int main(int argc, char *argv[]){
   /* Disable waveform caching */
   runState->threads[0]->model->waveformCache=NULL;
   
-  int result = compare_template(runState);
+  int result;
+  if(LALInferenceGetProcParamVal(procParams,"--multiband-likelihood"))
+    result = compare_likelihood(runState);
+  else
+    result = compare_template(runState);
   
-  return(result);
+  return(result ? 0 : 1);
 }
@@ -73,6 +73,10 @@ int LALInferenceProcessParamLine_TEST_CHARFILE(void);
 /*  LALInferenceExecuteFT tests */
 int LALInferenceExecuteFTTEST_NULLPLAN(void);
 
+/*  LALInferenceVariablesLayout and LALInferenceCopyVariables tests */
+int LALInferenceVariablesLayout_TEST(void);
+int LALInferenceDEBuffer_TEST(void);
+
 int main(void){
     
 	int failureCount = 0;
@@ -91,6 +95,10 @@ int main(void){
 	printf("\n");
 	failureCount += LALInferenceExecuteFTTEST_NULLPLAN();
 	printf("\n");
+	failureCount += LALInferenceVariablesLayout_TEST();
+	printf("\n");
+	failureCount += LALInferenceDEBuffer_TEST();
+	printf("\n");
 	printf("Test results: %i failure(s).\n", failureCount);
 
 	return failureCount;
@@ -371,6 +379,154 @@ int LALInferenceExecuteFTTEST_NULLPLAN(void){
 }
 
 
+/*****************     TEST CODE for LALInferenceVariablesLayout     *****************/
+/* Test that the layout holds the varying REAL8 parameters in order, that arrays
+   copied through it agree with the variables, and that LALInferenceCopyVariables
+   gives the same result whether or not it can copy in place. */
+
+int LALInferenceVariablesLayout_TEST(void){
+
+    TEST_HEADER();
+
+    LALInferenceVariables vars, copy;
+    memset(&vars, 0, sizeof(vars));
+    memset(&copy, 0, sizeof(copy));
+    REAL8 a = 1.5, b = -2.0, c = 3.25, x[2];
+    INT4 n = 7;
+    REAL8Vector *v = XLALCreateREAL8Vector(3);
+    v->data[0] = 0.1; v->data[1] = 0.2; v->data[2] = 0.3;
+
+    LALInferenceAddVariable(&vars, "c", &c, LALINFERENCE_REAL8_t, LALINFERENCE_PARAM_LINEAR);
+    LALInferenceAddVariable(&vars, "fixed", &b, LALINFERENCE_REAL8_t, LALINFERENCE_PARAM_FIXED);
+    LALInferenceAddVariable(&vars, "n", &n, LALINFERENCE_INT4_t, LALINFERENCE_PARAM_LINEAR);
+    LALInferenceAddVariable(&vars, "v", &v, LALINFERENCE_REAL8Vector_t, LALINFERENCE_PARAM_LINEAR);
+    LALInferenceAddVariable(&vars, "a", &a, LALINFERENCE_REAL8_t, LALINFERENCE_PARAM_CIRCULAR);
+
+    LALInferenceVariablesLayout *layout = LALInferenceCreateVariablesLayout(&vars);
+    if (layout == NULL || layout->length != 2) {
+        TEST_FAIL("Layout should hold the 2 varying REAL8 parameters.");
+        TEST_FOOTER();
+    }
+    /* items are prepended, so "a" comes first */
+    if (LALInferenceVariablesLayoutIndex(layout, "a") != 0 || LALInferenceVariablesLayoutIndex(layout, "c") != 1 ||
+        LALInferenceVariablesLayoutIndex(layout, "fixed") != -1 || LALInferenceVariablesLayoutIndex(layout, "n") != -1) {
+        TEST_FAIL("Wrong layout slots.");
+    }
+    if (!LALInferenceVariablesLayoutMatches(layout, &vars)) {
+        TEST_FAIL("Layout should match the variables it was created from.");
+    }
+
+    if (LALInferenceCopyVariablesToLayoutArray(layout, &vars, x) != XLAL_SUCCESS || x[0] != a || x[1] != c) {
+        TEST_FAIL("Array copied through layout does not agree with variables.");
+    }
+    x[0] = 0.5; x[1] = 4.0;
+    if (LALInferenceCopyLayoutArrayToVariables(layout, x, &vars) != XLAL_SUCCESS ||
+        LALInferenceGetREAL8Variable(&vars, "a") != 0.5 || LALInferenceGetREAL8Variable(&vars, "c") != 4.0) {
+        TEST_FAIL("Variables copied through layout do not agree with array.");
+    }
+
+    /* first copy allocates the target, the second one copies in place */
+    LALInferenceCopyVariables(&vars, &copy);
+    if (!LALInferenceVariablesLayoutMatches(layout, &copy) || LALInferenceCompareVariables(&vars, &copy)) {
+        TEST_FAIL("Copied variables differ from original.");
+    }
+    REAL8Vector *vcopy = *(REAL8Vector **)LALInferenceGetVariable(&copy, "v");
+    x[0] = -1.0;
+    LALInferenceCopyLayoutArrayToVariables(layout, x, &vars);
+    (*(REAL8Vector **)LALInferenceGetVariable(&vars, "v"))->data[1] = 5.0;
+    LALInferenceCopyVariables(&vars, &copy);
+    if (LALInferenceCompareVariables(&vars, &copy) || vcopy != *(REAL8Vector **)LALInferenceGetVariable(&copy, "v")) {
+        TEST_FAIL("In-place copy of variables differs from original.");
+    }
+
+    /* a vector of different length can not be copied in place */
+    REAL8Vector *w = XLALCreateREAL8Vector(4);
+    memset(w->data, 0, w->length * sizeof(w->data[0]));
+    LALInferenceSetVariable(&vars, "v", &w);
+    LALInferenceCopyVariables(&vars, &copy);
+    if (LALInferenceCompareVariables(&vars, &copy) || (*(REAL8Vector **)LALInferenceGetVariable(&copy, "v"))->length != 4) {
+        TEST_FAIL("Copy of variables with resized vector differs from original.");
+    }
+
+    /* a layout lookup by name also works for variables stored in a different order */
+    LALInferenceRemoveVariable(&copy, "a");
+    LALInferenceAddVariable(&copy, "a", &a, LALINFERENCE_REAL8_t, LALINFERENCE_PARAM_CIRCULAR);
+    LALInferenceRemoveVariable(&copy, "c");
+    LALInferenceAddVariable(&copy, "c", &c, LALINFERENCE_REAL8_t, LALINFERENCE_PARAM_LINEAR);
+    if (LALInferenceVariablesLayoutMatches(layout, &copy)) {
+        TEST_FAIL("Layout should not match reordered variables.");
+    }
+    if (LALInferenceCopyVariablesToLayoutArray(layout, &copy, x) != XLAL_SUCCESS || x[0] != a || x[1] != c) {
+        TEST_FAIL("Array copied through layout does not agree with reordered variables.");
+    }
+
+    LALInferenceDestroyVariablesLayout(layout);
+    LALInferenceClearVariables(&vars);
+    LALInferenceClearVariables(&copy);
+
+    TEST_FOOTER();
+
+}
+
+/* Tests the growth, thinning and resetting of a differential evolution buffer */
+int LALInferenceDEBuffer_TEST(void){
+
+    TEST_HEADER();
+
+    LALInferenceVariables vars;
+    memset(&vars, 0, sizeof(vars));
+    REAL8 a = 0, b = 0, fixed = 9.0;
+    UINT4 i;
+
+    LALInferenceAddVariable(&vars, "b", &b, LALINFERENCE_REAL8_t, LALINFERENCE_PARAM_LINEAR);
+    LALInferenceAddVariable(&vars, "fixed", &fixed, LALINFERENCE_REAL8_t, LALINFERENCE_PARAM_FIXED);
+    LALInferenceAddVariable(&vars, "a", &a, LALINFERENCE_REAL8_t, LALINFERENCE_PARAM_LINEAR);
+
+    LALInferenceDEBuffer *buffer = LALInferenceCreateDEBuffer(&vars, 1);
+    if (buffer == NULL || buffer->layout->length != 2 || buffer->length != 0) {
+        TEST_FAIL("Buffer should be empty, with a column for each of the 2 varying parameters.");
+        TEST_FOOTER();
+    }
+
+    /* append 5 points, so that the buffer has to grow to 8 rows */
+    for (i = 0; i < 5; i++) {
+        a = i; b = -1.0*i;
+        LALInferenceSetVariable(&vars, "a", &a);
+        LALInferenceSetVariable(&vars, "b", &b);
+        if (LALInferenceDEBufferAppend(buffer, &vars) != XLAL_SUCCESS) {
+            TEST_FAIL("Could not append point %u.", i);
+        }
+    }
+    if (buffer->length != 5 || buffer->size != 8) {
+        TEST_FAIL("Buffer should hold 5 points in 8 rows, not %zu points in %zu rows.", buffer->length, buffer->size);
+    }
+    for (i = 0; i < buffer->length; i++) {
+        if (buffer->data[2*i] != i || buffer->data[2*i+1] != -1.0*i) {
+            TEST_FAIL("Row %u of the buffer does not hold point %u.", i, i);
+        }
+    }
+
+    /* thinning keeps the points with odd index, without reallocating */
+    REAL8 *data = buffer->data;
+    LALInferenceDEBufferThin(buffer);
+    if (buffer->length != 2 || buffer->size != 8 || buffer->data != data ||
+        buffer->data[0] != 1 || buffer->data[2] != 3 || buffer->data[3] != -3) {
+        TEST_FAIL("Thinned buffer does not hold points 1 and 3.");
+    }
+
+    LALInferenceDEBufferReset(buffer);
+    if (buffer->length != 0 || buffer->size != 8) {
+        TEST_FAIL("Reset buffer should be empty, keeping its 8 rows.");
+    }
+
+    LALInferenceDestroyDEBuffer(buffer);
+    LALInferenceClearVariables(&vars);
+
+    TEST_FOOTER();
+
+}
+
+
 /******************************************
  * 
  * Old tests
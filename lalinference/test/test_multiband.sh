@@ -1,9 +1,10 @@
 #!/usr/bin/env bash
 
-# Exit with failure as soon as a test fails
-#set -e
-
-# TF2 test disabled because reference phase is inconsistent between std and frequency series version of approximant in LALSim
+# The template comparisons below are informational: the TF2 reference phase
+# is inconsistent between the std and frequency series version of the
+# approximant in LALSim, so they are not required to pass. The multibanded
+# likelihood must agree with the full-resolution one.
+status=0
 
 echo "Testing BNS: TaylorF2"
 ./LALInferenceMultiBandTest --psdlength 1000 --psdstart 1 --seglen 64 --srate 4096 --trigtime 0 --ifo H1 --H1-channel LALSimAdLIGO --H1-cache LALSimAdLIGO --dataseed 1324 --fix-chirpmass 1.218 --fix-q 1.0 --disable-spin --approximant TaylorF2 --0noise --amporder 0 --H1-flow 30
@@ -16,4 +17,8 @@ echo "-------------------------------------------"
 echo "Testing BBH: IMRPhenomP"
 ./LALInferenceMultiBandTest --psdlength 1000 --psdstart 1 --seglen 64 --srate 4096 --trigtime 0 --ifo H1 --H1-channel LALSimAdLIGO --H1-cache LALSimAdLIGO --dataseed 1324 --fix-chirpmass 10.0 --fix-q 0.7  --approximant IMRPhenomPv2 --0noise --amporder 0 --H1-flow 30
 
+echo "-------------------------------------------"
+echo "Testing multibanded likelihood, BNS: IMRPhenomD"
+./LALInferenceMultiBandTest --psdlength 1000 --psdstart 1 --seglen 64 --srate 4096 --trigtime 0 --ifo H1 --H1-channel LALSimAdLIGO --H1-cache LALSimAdLIGO --dataseed 1324 --fix-chirpmass 1.218 --fix-q 1.0 --disable-spin --approximant IMRPhenomD --amporder 0 --H1-flow 30 --template multiband --multiband-likelihood || status=1
 
+exit $status
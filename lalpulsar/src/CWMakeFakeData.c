@@ -29,6 +29,10 @@
 // ---------- includes
 #include <math.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // GSL includes
 
 // LAL includes
@@ -50,6 +54,7 @@
 
 // ---------- local macro definitions
 #define SQ(x) ( (x) * (x) )
+#define MYMIN(x,y) ( (x) < (y) ? (x) : (y) )
 // ---------- local type definitions
 
 // ---------- Global variables
@@ -57,6 +62,8 @@ const REAL8 eps = 10 * LAL_REAL8_EPS;
 
 // ---------- local prototypes
 static UINT4 gcd (UINT4 numer, UINT4 denom);
+static void ClipSignalTimespan ( LIGOTimeGPS *signalStartGPS, LIGOTimeGPS *signalEndGPS, UINT4 t0, UINT4 t1, const LIGOTimeGPS *firstGPS, const LIGOTimeGPS *lastGPS );
+static int XLALCWMakeFakeBandLimitedSFTs ( SFTVector **SFTvect, const PulsarParamsVector *injectionSources, const CWMFDataParams *dataParams, UINT4 detectorIndex, const EphemerisData *edat );
 int XLALcorrect_phase ( SFTtype *sft, LIGOTimeGPS tHeterodyne );
 int XLALCheckConfigFileWasFullyParsed ( const char *fname, const LALParsedDataFile *cfgdata );
 
@@ -166,6 +173,15 @@ XLALCWMakeFakeData ( SFTVector **SFTvect,
   XLAL_CHECK ( (dataParams->inputMultiTS == NULL) || (detectorIndex < dataParams->inputMultiTS->length), XLAL_EINVAL );
   XLAL_CHECK ( (dataParams->inputMultiTS == NULL) || (dataParams->fMin == 0 && dataParams->Band == 0), XLAL_EINVAL, "If given time-series, must have fMin=Band=0\n");
 
+  // band-limited generation has its own code-path, which only produces SFTs
+  if ( dataParams->bandLimited )
+    {
+      XLAL_CHECK ( (SFTvect != NULL) && (Tseries == NULL), XLAL_EINVAL, "Band-limited generation can only produce SFTs, not timeseries\n");
+      XLAL_CHECK ( dataParams->inputMultiTS == NULL, XLAL_EINVAL, "Band-limited generation cannot add signals to an input timeseries\n");
+      XLAL_CHECK ( XLALCWMakeFakeBandLimitedSFTs ( SFTvect, injectionSources, dataParams, detectorIndex, edat ) == XLAL_SUCCESS, XLAL_EFUNC );
+      return XLAL_SUCCESS;
+    }
+
   // initial default values fMin, sampling rate from caller input or timeseries
   REAL8 fMin  = dataParams->fMin;
   REAL8 fBand = dataParams->Band;
@@ -246,8 +262,6 @@ XLALCWMakeFakeData ( SFTVector **SFTvect,
       XLALGPSAdd( &lastGPS, Tsft );
       duration = XLALGPSDiff ( &lastGPS, &firstGPS );
     }
-  REAL8 firstGPS_REAL8 = XLALGPSGetREAL8 ( &firstGPS );
-  REAL8 lastGPS_REAL8  = XLALGPSGetREAL8 ( &lastGPS );
 
   // start with an empty output time-series
   REAL4TimeSeries *Tseries_sum;
@@ -272,27 +286,8 @@ XLALCWMakeFakeData ( SFTVector **SFTvect,
       const PulsarParams *pulsarParams = &( injectionSources->data[iInj] );
       UINT4 t0, t1;
       XLAL_CHECK ( XLALGetTransientWindowTimespan ( &t0, &t1, pulsarParams->Transient ) == XLAL_SUCCESS, XLAL_EFUNC );
-
-      // use latest possible start-time: max(t0,firstGPS), but not later than than lastGPS
-      LIGOTimeGPS XLAL_INIT_DECL(signalStartGPS);
-      if ( t0 <= firstGPS_REAL8 ) {
-        signalStartGPS = firstGPS;
-      } else if ( t0 >= lastGPS_REAL8 ) {
-        signalStartGPS = lastGPS;
-      }
-      else {
-        signalStartGPS.gpsSeconds = t0;
-      }
-
-      // use earliest possible end-time: min(t1,lastGPS), but not earlier than firstGPS
-      LIGOTimeGPS XLAL_INIT_DECL(signalEndGPS);
-      if ( t1 >= lastGPS_REAL8 ) {
-        signalEndGPS = lastGPS;
-      } else if ( t1 <= firstGPS_REAL8 ) {
-        signalEndGPS = firstGPS;
-      } else {
-        signalEndGPS.gpsSeconds = t1;
-      }
+      LIGOTimeGPS signalStartGPS, signalEndGPS;
+      ClipSignalTimespan ( &signalStartGPS, &signalEndGPS, t0, t1, &firstGPS, &lastGPS );
 
       REAL8 fCoverMin, fCoverMax;
       const PulsarSpins *fkdot = &(pulsarParams->Doppler.fkdot);
@@ -366,6 +361,249 @@ XLALCWMakeFakeData ( SFTVector **SFTvect,
 
 } // XLALCWMakeFakeData()
 
+/**
+ * Clip the support [t0, t1] of a (possibly transient) CW signal to the data interval [firstGPS, lastGPS]:
+ * use the latest possible start-time max(t0,firstGPS), but not later than lastGPS, and the earliest
+ * possible end-time min(t1,lastGPS), but not earlier than firstGPS.
+ */
+static void
+ClipSignalTimespan ( LIGOTimeGPS *signalStartGPS,	///< [out] start-time of signal within data interval
+                     LIGOTimeGPS *signalEndGPS,		///< [out] end-time of signal within data interval
+                     UINT4 t0,				///< [in] start-time of signal support
+                     UINT4 t1,				///< [in] end-time of signal support
+                     const LIGOTimeGPS *firstGPS,	///< [in] start-time of data interval
+                     const LIGOTimeGPS *lastGPS		///< [in] end-time of data interval
+                     )
+{
+  REAL8 firstGPS_REAL8 = XLALGPSGetREAL8 ( firstGPS );
+  REAL8 lastGPS_REAL8  = XLALGPSGetREAL8 ( lastGPS );
+
+  XLAL_INIT_MEM ( (*signalStartGPS) );
+  if ( t0 <= firstGPS_REAL8 ) {
+    (*signalStartGPS) = (*firstGPS);
+  } else if ( t0 >= lastGPS_REAL8 ) {
+    (*signalStartGPS) = (*lastGPS);
+  } else {
+    signalStartGPS->gpsSeconds = t0;
+  }
+
+  XLAL_INIT_MEM ( (*signalEndGPS) );
+  if ( t1 >= lastGPS_REAL8 ) {
+    (*signalEndGPS) = (*lastGPS);
+  } else if ( t1 <= firstGPS_REAL8 ) {
+    (*signalEndGPS) = (*firstGPS);
+  } else {
+    signalEndGPS->gpsSeconds = t1;
+  }
+
+  return;
+
+} // ClipSignalTimespan()
+
+
+/**
+ * Band-limited variant of XLALCWMakeFakeData(), producing SFTs only: instead of generating one timeseries
+ * spanning all timestamps (including gaps), at a sampling rate that may have to be increased for the gaps to fall
+ * onto exact timesteps [see XLALFindSmallestValidSamplingRate()], the heterodyned timeseries is generated separately
+ * for each contiguous (or overlapping) stretch of SFTs, always at the minimal sampling rate fSamp = 2*Band.
+ *
+ * The injection sources are generated in parallel using OpenMP, but are summed in source order, such that
+ * the output does not depend on the number of threads. For timestamps without gaps this reproduces the
+ * output of the default code-path.
+ *
+ * NOTE: Gaussian noise is generated separately for each stretch, using the random seed
+ * (randSeed + detectorIndex + iStretch * numDetectors) if randSeed != 0.
+ */
+static int
+XLALCWMakeFakeBandLimitedSFTs ( SFTVector **SFTvect,				///< [out] SFTs for this detector
+                                const PulsarParamsVector *injectionSources,	///< [in] CW sources to inject (can be NULL)
+                                const CWMFDataParams *dataParams,		///< [in] data parameters
+                                UINT4 detectorIndex,				///< [in] index for current detector in dataParams
+                                const EphemerisData *edat			///< [in] ephemeris data
+                                )
+{
+  XLAL_CHECK ( (SFTvect != NULL) && ((*SFTvect) == NULL), XLAL_EINVAL );
+
+  const LIGOTimeGPSVector *timestamps = dataParams->multiTimestamps.data[detectorIndex];
+  XLAL_CHECK ( (timestamps != NULL) && (timestamps->length > 0), XLAL_EINVAL );
+  const LALDetector *site = &dataParams->multiIFO.sites[detectorIndex];
+  const REAL8 Tsft = timestamps->deltaT;
+  const UINT4 numSFTs = timestamps->length;
+
+  // need *effective* fMin and Band consistent with SFT bins
+  REAL8 fMin  = dataParams->fMin;
+  REAL8 fBand = dataParams->Band;
+  {
+    UINT4 firstBinEff, numBinsEff;
+    XLAL_CHECK ( XLALFindCoveringSFTBins ( &firstBinEff, &numBinsEff, fMin, fBand, Tsft ) == XLAL_SUCCESS, XLAL_EFUNC );
+    REAL8 fBand_eff = (numBinsEff - 1.0) / Tsft;
+    REAL8 fMin_eff  = firstBinEff / Tsft;
+    if ( (fMin_eff != fMin) || (fBand_eff != fBand ) ) {
+      XLALPrintWarning("Caller asked for Band [%.16g, %.16g] Hz, effective SFT-Band produced is [%.16g, %.16g] Hz\n",
+                       fMin, fMin + fBand, fMin_eff, fMin_eff + fBand_eff );
+      fMin = fMin_eff;
+      fBand = fBand_eff;
+    }
+  }
+  const REAL8 fSamp = 2.0 * fBand;
+  const REAL8 fHeterodyne = fMin;	// heterodyne signals at lower end of frequency-band
+  const UINT4 numDet = dataParams->multiIFO.length;
+
+  // start- and end-time of all data, used to check the frequency coverage of each source
+  LIGOTimeGPS firstGPS = timestamps->data[0];
+  LIGOTimeGPS lastGPS = timestamps->data [ numSFTs - 1 ];
+  XLALGPSAdd( &lastGPS, Tsft );
+
+  // check that all injection sources fit into the band, and get the support of each (transient) signal
+  UINT4 numPulsars = injectionSources ? injectionSources->length : 0;
+  UINT4 *signal_t0 = NULL, *signal_t1 = NULL;
+  if ( numPulsars > 0 )
+    {
+      XLAL_CHECK ( (signal_t0 = XLALCalloc ( numPulsars, sizeof(*signal_t0) )) != NULL, XLAL_ENOMEM );
+      XLAL_CHECK ( (signal_t1 = XLALCalloc ( numPulsars, sizeof(*signal_t1) )) != NULL, XLAL_ENOMEM );
+    }
+  for ( UINT4 iInj = 0; iInj < numPulsars; iInj ++ )
+    {
+      const PulsarParams *pulsarParams = &( injectionSources->data[iInj] );
+      XLAL_CHECK ( XLALGetTransientWindowTimespan ( &signal_t0[iInj], &signal_t1[iInj], pulsarParams->Transient ) == XLAL_SUCCESS, XLAL_EFUNC );
+      LIGOTimeGPS signalStartGPS, signalEndGPS;
+      ClipSignalTimespan ( &signalStartGPS, &signalEndGPS, signal_t0[iInj], signal_t1[iInj], &firstGPS, &lastGPS );
+
+      REAL8 fCoverMin, fCoverMax;
+      PulsarSpinRange XLAL_INIT_DECL ( spinRange );
+      spinRange.refTime = pulsarParams->Doppler.refTime;
+      memcpy ( spinRange.fkdot, pulsarParams->Doppler.fkdot, sizeof(spinRange.fkdot) );
+      XLAL_CHECK ( XLALCWSignalCoveringBand ( &fCoverMin, &fCoverMax, &signalStartGPS, &signalEndGPS, &spinRange, pulsarParams->Doppler.asini, pulsarParams->Doppler.period, pulsarParams->Doppler.ecc ) == XLAL_SUCCESS, XLAL_EFUNC );
+      XLAL_CHECK ( (fCoverMin >= fMin) && (fCoverMax < fMin + fBand), XLAL_EINVAL, "Error: injection signal %d:'%s' needs frequency band [%f,%f]Hz, injecting into [%f,%f]Hz\n",
+                   iInj, pulsarParams->name, fCoverMin, fCoverMax, fMin, fMin + fBand );
+    } // for iInj < numPulsars
+
+  // per-batch buffers for the parallel generation of the injection sources
+#ifdef _OPENMP
+  const UINT4 batchSize = omp_get_max_threads();
+#else
+  const UINT4 batchSize = 1;
+#endif
+  REAL4TimeSeries **Tseries_batch;
+  int *status_batch;
+  XLAL_CHECK ( (Tseries_batch = XLALCalloc ( batchSize, sizeof(*Tseries_batch) )) != NULL, XLAL_ENOMEM );
+  XLAL_CHECK ( (status_batch = XLALCalloc ( batchSize, sizeof(*status_batch) )) != NULL, XLAL_ENOMEM );
+
+  // prepare output SFT-vector, which takes over the SFT data of each stretch
+  SFTVector *outSFTs;
+  XLAL_CHECK ( (outSFTs = XLALCreateSFTVector ( numSFTs, 0 )) != NULL, XLAL_EFUNC );
+
+  CHAR *detPrefix;
+  XLAL_CHECK ( (detPrefix = XLALGetChannelPrefix ( site->frDetector.name )) != NULL, XLAL_EFUNC );
+
+  // ----- loop over stretches of contiguous or overlapping SFTs, with start-times on exact timesteps
+  UINT4 iStretch = 0;
+  for ( UINT4 iStart = 0, iEnd; iStart < numSFTs; iStart = iEnd, iStretch ++ )
+    {
+      for ( iEnd = iStart + 1; iEnd < numSFTs; iEnd ++ )
+        {
+          REAL8 gap = XLALGPSDiff ( &(timestamps->data[iEnd]), &(timestamps->data[iEnd-1]) );
+          XLAL_CHECK ( gap > 0, XLAL_EDOM, "Timestamps must be sorted in increasing order, found gap %g s between i=%d and i-1\n", gap, iEnd );
+          REAL8 gapSteps = gap * fSamp;
+          if ( (gap > Tsft) || (fabs ( gapSteps - round ( gapSteps ) ) > eps * gapSteps) ) {
+            break;
+          }
+        } // for iEnd < numSFTs
+
+      LIGOTimeGPSVector stretchTimestamps = { .length = iEnd - iStart, .data = &(timestamps->data[iStart]), .deltaT = Tsft };
+      LIGOTimeGPS stretchStartGPS = timestamps->data[iStart];
+      LIGOTimeGPS stretchEndGPS = timestamps->data[iEnd-1];
+      XLALGPSAdd( &stretchEndGPS, Tsft );
+      REAL8 duration = XLALGPSDiff ( &stretchEndGPS, &stretchStartGPS );
+
+      // start with an empty timeseries for this stretch
+      REAL4TimeSeries *Tseries_sum;
+      REAL8 numSteps = ceil ( fSamp * duration );
+      XLAL_CHECK ( numSteps < (REAL8)LAL_UINT4_MAX, XLAL_EDOM, "Sorry, time-series of %g samples too long to fit into REAL4TimeSeries (maxLen = %g)\n", numSteps, (REAL8)LAL_UINT4_MAX );
+      XLAL_CHECK ( (Tseries_sum = XLALCreateREAL4TimeSeries ( detPrefix, &stretchStartGPS, fHeterodyne, 1.0 / fSamp, &lalStrainUnit, (UINT4)numSteps )) != NULL, XLAL_EFUNC );
+      memset ( Tseries_sum->data->data, 0, Tseries_sum->data->length * sizeof(Tseries_sum->data->data[0]) );
+
+      // add CW signals, generating one batch of sources in parallel, then summing them in source order
+      for ( UINT4 iBatch = 0; iBatch < numPulsars; iBatch += batchSize )
+        {
+          const UINT4 numBatch = MYMIN ( batchSize, numPulsars - iBatch );
+
+#pragma omp parallel for schedule(dynamic)
+          for ( UINT4 j = 0; j < numBatch; j ++ )
+            {
+              const UINT4 iInj = iBatch + j;
+              const PulsarParams *pulsarParams = &( injectionSources->data[iInj] );
+              LIGOTimeGPS signalStartGPS, signalEndGPS;
+              ClipSignalTimespan ( &signalStartGPS, &signalEndGPS, signal_t0[iInj], signal_t1[iInj], &stretchStartGPS, &stretchEndGPS );
+              REAL8 signalDuration = XLALGPSDiff ( &signalEndGPS, &signalStartGPS );
+              Tseries_batch[j] = NULL;
+              status_batch[j] = XLAL_SUCCESS;
+              if ( signalDuration > 0 )	// only need to do sth if transient-window had finite overlap with this stretch
+                {
+                  Tseries_batch[j] = XLALGenerateCWSignalTS ( pulsarParams, site, signalStartGPS, signalDuration, fSamp, fHeterodyne, edat, dataParams->sourceDeltaT );
+                  if ( Tseries_batch[j] == NULL ) {
+                    status_batch[j] = XLAL_FAILURE;
+                  }
+                }
+            } // for j < numBatch
+
+          for ( UINT4 j = 0; j < numBatch; j ++ )
+            {
+              XLAL_CHECK ( status_batch[j] == XLAL_SUCCESS, XLAL_EFUNC, "XLALGenerateCWSignalTS() failed for injection signal %d:'%s'\n", iBatch + j, injectionSources->data[iBatch + j].name );
+              if ( Tseries_batch[j] != NULL )
+                {
+                  XLAL_CHECK ( (Tseries_sum = XLALAddREAL4TimeSeries ( Tseries_sum, Tseries_batch[j] )) != NULL, XLAL_EFUNC );
+                  XLALDestroyREAL4TimeSeries ( Tseries_batch[j] );
+                  Tseries_batch[j] = NULL;
+                }
+            } // for j < numBatch
+
+        } // for iBatch < numPulsars
+
+      /* add Gaussian noise if requested */
+      REAL8 sqrtSn = dataParams->multiNoiseFloor.sqrtSn[detectorIndex];
+      if ( sqrtSn > 0)
+        {
+          REAL8 noiseSigma = sqrtSn * sqrt ( 0.5 * fSamp );
+          INT4 randSeed = (dataParams->randSeed == 0) ? 0 : (dataParams->randSeed + detectorIndex + iStretch * numDet);	// seed=0 means to use /dev/urandom, so don't touch it
+          XLAL_CHECK ( XLALAddGaussianNoise ( Tseries_sum, noiseSigma, randSeed ) == XLAL_SUCCESS, XLAL_EFUNC );
+        }
+
+      // convert final signal+Gaussian-noise timeseries into REAL8 precision, and turn it into SFTs
+      REAL8TimeSeries *outTS;
+      XLAL_CHECK ( (outTS = XLALConvertREAL4TimeSeriesToREAL8 ( Tseries_sum )) != NULL, XLAL_EFUNC );
+      XLALDestroyREAL4TimeSeries ( Tseries_sum );
+
+      SFTVector *stretchSFTs;
+      XLAL_CHECK ( (stretchSFTs = XLALMakeSFTsFromREAL8TimeSeries ( outTS, &stretchTimestamps, dataParams->SFTWindowType, dataParams->SFTWindowBeta )) != NULL, XLAL_EFUNC );
+      XLALDestroyREAL8TimeSeries ( outTS );
+
+      // move SFTs of this stretch into the output SFT-vector
+      for ( UINT4 i = 0; i < stretchSFTs->length; i ++ )
+        {
+          outSFTs->data[iStart + i] = stretchSFTs->data[i];
+          stretchSFTs->data[i].data = NULL;
+        }
+      XLALDestroySFTVector ( stretchSFTs );
+
+    } // for iStart < numSFTs
+
+  XLALPrintInfo ( "%s: generated %d SFTs in %d stretches at fSamp = %g Hz\n", __func__, numSFTs, iStretch, fSamp );
+
+  // free memory
+  XLALFree ( detPrefix );
+  XLALFree ( Tseries_batch );
+  XLALFree ( status_batch );
+  XLALFree ( signal_t0 );
+  XLALFree ( signal_t1 );
+
+  (*SFTvect) = outSFTs;
+
+  return XLAL_SUCCESS;
+
+} // XLALCWMakeFakeBandLimitedSFTs()
+
+
 
 /**
  * Generate a (heterodyned) REAL4 timeseries of a CW signal for given pulsarParams,
@@ -80,6 +80,7 @@ typedef struct tagCWMFDataParams
   UINT4 randSeed;				//!< seed value for random-number generator
   MultiREAL8TimeSeries *inputMultiTS;		//!< [optional] input time-series for signals+noise to be added to
   REAL8 sourceDeltaT;                           //!< [optional] source-frame sampling period. '0' means to use the previous internal defaults
+  BOOLEAN bandLimited;				//!< [optional] generate SFTs (only) per contiguous stretch of timestamps at the minimal sampling rate 2*Band, with sources in parallel
 } CWMFDataParams;
 
 // ---------- Global variables ----------
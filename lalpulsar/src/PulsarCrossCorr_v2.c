@@ -420,6 +420,137 @@ int XLALCalculatePulsarCrossCorrStatistic
   return XLAL_SUCCESS;
 }
 
+/** Calculate multi-bin cross-correlation statistic, sharing the work between pairs */
+/* This gives the same result as XLALCalculatePulsarCrossCorrStatistic(), but */
+/* the double sum over bins for each pair factors into a product of per-SFT */
+/* sums Y_K = (-1)^{k_K} e^{-i Phi_K} sum_k (-1)^k sinc_Kk x_Kk, so the */
+/* statistic is Re sum_alpha G_alpha Y_K^* Y_L.  The per-SFT sums are computed */
+/* once, and pairs sharing their first SFT are accumulated together.  The cost */
+/* is O(numSFTs*numBins + numPairs) rather than O(numPairs*numBins^2) */
+int XLALCalculatePulsarCrossCorrStatisticBlocked
+(
+ REAL8                         *ccStat, /* Output: cross-correlation statistic rho */
+ REAL8                      *evSquared, /* Output: (E[rho]/h0^2)^2 */
+ REAL8Vector                *curlyGAmp, /* Input: Amplitude of curly G for each pair */
+ COMPLEX8Vector       *expSignalPhases, /* Input: Phase of signal for each SFT */
+ UINT4Vector               *lowestBins, /* Input: Bin index to start with for each SFT */
+ REAL8VectorSequence         *sincList, /* Input: input the sinc factors*/
+ SFTPairIndexList            *sftPairs, /* Input: flat list of SFT pairs */
+ SFTIndexList              *sftIndices, /* Input: flat list of SFTs */
+ MultiSFTVector             *inputSFTs, /* Input: SFT data */
+ MultiNoiseWeights       *multiWeights, /* Input: nomalizeation factor S^-1 & weights for each SFT */
+ UINT4                         numBins  /* Input Number of frequency bins to be taken into calc */
+ )
+{
+
+  UINT4 numSFTs = sftIndices->length;
+  if ( expSignalPhases->length !=numSFTs
+       || lowestBins->length !=numSFTs
+       || sincList->length !=numSFTs) {
+    XLALPrintError("Lengths of SFT-indexed lists don't match!");
+    XLAL_ERROR(XLAL_EBADLEN );
+  }
+
+  UINT4 numPairs = sftPairs->length;
+  if ( curlyGAmp->length !=numPairs ) {
+    XLALPrintError("Lengths of pair-indexed lists don't match!");
+    XLAL_ERROR(XLAL_EBADLEN );
+  }
+
+  /* per-SFT sums; an SFT whose bins run off the end of its data is only an error if it is used in a pair */
+  COMPLEX16 *sftSum = NULL;
+  REAL8 *sincSqSum = NULL;
+  BOOLEAN *sftOK = NULL;
+  XLAL_CHECK ( ( sftSum = XLALCalloc ( numSFTs, sizeof ( *sftSum ) ) ) != NULL, XLAL_ENOMEM );
+  XLAL_CHECK ( ( sincSqSum = XLALCalloc ( numSFTs, sizeof ( *sincSqSum ) ) ) != NULL, XLAL_ENOMEM );
+  XLAL_CHECK ( ( sftOK = XLALCalloc ( numSFTs, sizeof ( *sftOK ) ) ) != NULL, XLAL_ENOMEM );
+
+  for (UINT4 sftNum = 0; sftNum < numSFTs; sftNum++) {
+    UINT4 detInd = sftIndices->data[sftNum].detInd;
+    if ( detInd >= inputSFTs->length ) {
+      continue;
+    }
+    UINT4 sftInd = sftIndices->data[sftNum].sftInd;
+    if ( sftInd >= inputSFTs->data[detInd]->length ) {
+      continue;
+    }
+    COMPLEX8 *dataArray = inputSFTs->data[detInd]->data[sftInd].data->data;
+    UINT4 lenDataArray = inputSFTs->data[detInd]->data[sftInd].data->length;
+    UINT4 lowestBin = lowestBins->data[sftNum];
+    if ( (lowestBin + numBins - 1) >= lenDataArray ) {
+      continue;
+    }
+    sftOK[sftNum] = 1;
+
+    /* alternating-sign, sinc-weighted sum over bins */
+    const REAL8 *sinc = sincList->data + sftNum * numBins;
+    const COMPLEX8 *data = dataArray + lowestBin;
+    REAL8 sumRe = 0, sumIm = 0, sumSincSq = 0;
+    for (UINT4 k = 0; k < numBins; k++) {
+      REAL8 w = ( k % 2 == 0 ) ? sinc[k] : -sinc[k];
+      sumRe += w * crealf(data[k]);
+      sumIm += w * cimagf(data[k]);
+      sumSincSq += SQUARE( sinc[k] );
+    }
+    COMPLEX16 phase = conj( expSignalPhases->data[sftNum] );
+    if ( lowestBin % 2 != 0 ) {
+      phase = -phase;
+    }
+    sftSum[sftNum] = phase * crect( sumRe, sumIm );
+    sincSqSum[sftNum] = sumSincSq;
+  }
+
+  REAL8 nume = 0;
+  REAL8 curlyGSqr = 0;
+  *ccStat = 0.0;
+  *evSquared = 0.0;
+  int errnum = XLAL_SUCCESS;
+  for (UINT4 alpha = 0; alpha < numPairs && errnum == XLAL_SUCCESS; ) {
+    /* accumulate the block of consecutive pairs which share their first SFT */
+    UINT4 sftNum1 = sftPairs->data[alpha].sftNum[0];
+    COMPLEX16 blockSum = 0;
+    REAL8 blockSqr = 0;
+    for ( ; alpha < numPairs && sftPairs->data[alpha].sftNum[0] == sftNum1; alpha++ ) {
+      UINT4 sftNum2 = sftPairs->data[alpha].sftNum[1];
+      if ( sftNum1 >= numSFTs || sftNum2 >= numSFTs ) {
+        XLALPrintError ( "SFT pair asked for SFT index off end of list:\n alpha=%"LAL_UINT4_FORMAT", sftNum1=%"LAL_UINT4_FORMAT", sftNum2=%"LAL_UINT4_FORMAT", numSFTs=%"LAL_UINT4_FORMAT"\n",
+                         alpha, sftNum1, sftNum2, numSFTs );
+        errnum = XLAL_EINVAL;
+        break;
+      }
+      if ( !sftOK[sftNum1] || !sftOK[sftNum2] ) {
+        XLALPrintError ( "SFT pair alpha=%"LAL_UINT4_FORMAT" asked for a detector, SFT, or bin index off end of list:\n sftNum1=%"LAL_UINT4_FORMAT", sftNum2=%"LAL_UINT4_FORMAT", numBins=%"LAL_UINT4_FORMAT"\n",
+                         alpha, sftNum1, sftNum2, numBins );
+        errnum = XLAL_EINVAL;
+        break;
+      }
+      blockSum += curlyGAmp->data[alpha] * sftSum[sftNum2];
+      blockSqr += SQUARE( curlyGAmp->data[alpha] ) * sincSqSum[sftNum2];
+    }
+    if ( errnum == XLAL_SUCCESS ) {
+      nume += creal( conj( sftSum[sftNum1] ) * blockSum );
+      curlyGSqr += sincSqSum[sftNum1] * blockSqr;
+    }
+  }
+
+  XLALFree ( sftSum );
+  XLALFree ( sincSqSum );
+  XLALFree ( sftOK );
+  XLAL_CHECK ( errnum == XLAL_SUCCESS, errnum );
+
+  if (curlyGSqr == 0.0)
+    {
+      *evSquared = 0.0;
+      *ccStat = 0.0;
+    }
+  else
+    {
+      *evSquared = 8 * SQUARE(multiWeights->Sinv_Tsft) * curlyGSqr;
+      *ccStat = 4 * multiWeights->Sinv_Tsft * nume / sqrt(*evSquared);
+    }
+  return XLAL_SUCCESS;
+}
+
 /** calculate signal phase derivatives wrt Doppler coords, for each SFT */
 /* allocates memory as well */
 int XLALCalculateCrossCorrPhaseDerivatives
@@ -173,6 +173,22 @@ int XLALCalculatePulsarCrossCorrStatistic
    )
   ;
 
+int XLALCalculatePulsarCrossCorrStatisticBlocked
+  (
+   REAL8                         *ccStat,
+   REAL8                      *evSquared,
+   REAL8Vector                *curlyGAmp,
+   COMPLEX8Vector       *expSignalPhases,
+   UINT4Vector               *lowestBins,
+   REAL8VectorSequence         *sincList,
+   SFTPairIndexList            *sftPairs,
+   SFTIndexList              *sftIndices,
+   MultiSFTVector             *inputSFTs,
+   MultiNoiseWeights       *multiWeights,
+   UINT4                         numBins
+   )
+  ;
+
 int XLALCalculateCrossCorrPhaseDerivatives
   (
    REAL8VectorSequence        **phaseDerivs,
@@ -31,6 +31,9 @@
 
 /* System includes */
 #include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 /* LAL-includes */
 #include <lal/XLALError.h>
@@ -45,6 +48,13 @@
 
 /* ----- MACRO definitions ---------- */
 
+/* ----- module-local types ---------- */
+/** Window-weighted sums over F-stat atoms, accumulated in double precision */
+typedef struct tagtransientAtomSums_t {
+  REAL8 Ad, Bd, Cd;		/**< antenna-pattern matrix sums */
+  COMPLEX16 Fa, Fb;		/**< Fa, Fb sums */
+} transientAtomSums_t;
+
 /* ----- module-local fast lookup-table handling of negative exponentials ----- */
 /**
  * Lookup-table for negative exponentials e^(-x)
@@ -56,6 +66,7 @@ static gsl_vector *expLUT = NULL; 	/**< module-global lookup-table for negative
 #define EXPLUT_DXINV  ((EXPLUT_LENGTH)/(EXPLUT_XMAX))	// 1/dx with dx = xmax/length
 
 static int XLALCreateExpLUT ( void );	/* only ever used internally, destructor is in exported API */
+static inline REAL8 store_transientFstat_from_sums ( gsl_matrix *F_mn, UINT4 m, UINT4 n, const transientAtomSums_t *sum, BOOLEAN useFReg );
 
 static const char *transientWindowNames[TRANSIENT_LAST] =
   {
@@ -853,6 +864,306 @@ XLALComputeTransientFstatMap ( const MultiFstatAtomVector *multiFstatAtoms, 	/**
 } /* XLALComputeTransientFstatMap() */
 
 
+/**
+ * Function to compute the same transient-window "F-statistic map" F_mn as XLALComputeTransientFstatMap(),
+ * but using an incremental algorithm that avoids re-summing the F-stat atoms for every window {t0, tau}.
+ *
+ * For rectangular windows we pre-compute cumulative sums over the binned atoms, so that any window
+ * sum over [i_t0, i_t1] costs O(1), and each t0-row of the map is computed in O(N_tau).
+ *
+ * For exponential windows the atoms lie on the regular binned grid t_i = t0_data + i * TAtom, hence
+ * the window weights of consecutive atoms differ by a constant factor r = e^(-TAtom/tau). For every
+ * timescale tau we therefore run a single backwards recursive exponential filter over all atoms,
+ * S_i = x_i + r * S_{i+1}, from which any truncated window sum over [i_lo, i_hi] is obtained as
+ * S_{i_lo} - r^(i_hi + 1 - i_lo) * S_{i_hi+1}. This costs O(N_atoms + N_t0) per tau-column.
+ *
+ * Rows (rectangular) or columns (exponential) are distributed over OpenMP threads if available.
+ *
+ * Note: the exponential window-values are computed exactly here, rather than through the lookup-table
+ * of XLALFastNegExp(), so results agree with XLALComputeTransientFstatMap() only within the LUT accuracy.
+ * All sums, and F computed from them, are in double precision.
+ */
+transientFstatMap_t *
+XLALComputeTransientFstatMapIncremental ( const MultiFstatAtomVector *multiFstatAtoms, 	/**< [in] multi-IFO F-statistic atoms */
+                                          transientWindowRange_t windowRange,		/**< [in] type and parameters specifying transient window range to search */
+                                          BOOLEAN useFReg				/**< [in] experimental switch: compute FReg = F - log(D) instead of F */
+                                          )
+{
+  /* check input consistency */
+  XLAL_CHECK_NULL ( multiFstatAtoms && multiFstatAtoms->data && multiFstatAtoms->data[0], XLAL_EINVAL, "Invalid NULL input.\n" );
+  XLAL_CHECK_NULL ( windowRange.type < TRANSIENT_LAST, XLAL_EINVAL, "Unknown window-type (%d) passes as input. Allowed are [0,%d].\n", windowRange.type, TRANSIENT_LAST-1 );
+
+  /* everything allocated below, freed at XLAL_FAIL on errors */
+  FstatAtomVector *atoms = NULL;
+  transientFstatMap_t *ret = NULL;
+  UINT4 *i_t0 = NULL, *i_t1 = NULL;
+  REAL8 *maxF_k = NULL;
+  UINT4 *argmax_k = NULL;
+
+  /* ----- first combine all multi-atoms into a single atoms-vector with *unique* timestamps */
+  UINT4 TAtom = multiFstatAtoms->data[0]->TAtom;
+  UINT4 TAtomHalf = TAtom/2;	/* integer division */
+
+  XLAL_CHECK_NULL ( (atoms = XLALmergeMultiFstatAtomsBinned ( multiFstatAtoms, TAtom )) != NULL, XLAL_EFUNC );
+  UINT4 numAtoms = atoms->length;
+  /* actual data spans [t0_data, t0_data + numAtoms * TAtom] in steps of TAtom */
+  UINT4 t0_data = atoms->data[0].timestamp;
+  UINT4 t1_data = atoms->data[numAtoms-1].timestamp + TAtom;
+
+  /* ----- special treatment of window_type = none ==> replace by rectangular window spanning all the data */
+  if ( windowRange.type == TRANSIENT_NONE )
+    {
+      windowRange.type = TRANSIENT_RECTANGULAR;
+      windowRange.t0 = t0_data;
+      windowRange.t0Band = 0;
+      windowRange.dt0 = TAtom;	/* irrelevant */
+      windowRange.tau = numAtoms * TAtom;
+      windowRange.tauBand = 0;
+      windowRange.dtau = TAtom;	/* irrelevant */
+    }
+
+  UINT4 N_t0Range  = (UINT4) floor ( windowRange.t0Band / windowRange.dt0 ) + 1;
+  UINT4 N_tauRange = (UINT4) floor ( windowRange.tauBand / windowRange.dtau ) + 1;
+
+  /* ----- pepare return container ----- */
+  XLAL_CHECK_FAIL ( (ret = XLALCalloc ( 1, sizeof(*ret) )) != NULL, XLAL_ENOMEM );
+  XLAL_CHECK_FAIL ( (ret->F_mn = gsl_matrix_calloc ( N_t0Range, N_tauRange )) != NULL, XLAL_ENOMEM, "Failed ret->F_mn = gsl_matrix_calloc ( %d, %d )\n", N_t0Range, N_tauRange );
+
+  /* ----- translate the window-grid {m,n} into atoms index-ranges [i_t0[m], i_t1[m,n]], using the same
+   * rounding as XLALComputeTransientFstatMap(), and check for degenerate single-atom windows
+   */
+  XLAL_CHECK_FAIL ( (i_t0 = XLALCalloc ( N_t0Range, sizeof(*i_t0) )) != NULL, XLAL_ENOMEM );
+  XLAL_CHECK_FAIL ( (i_t1 = XLALCalloc ( N_t0Range * N_tauRange, sizeof(*i_t1) )) != NULL, XLAL_ENOMEM );
+  transientWindow_t win_mn;
+  win_mn.type = windowRange.type;
+  for ( UINT4 m = 0; m < N_t0Range; m ++ )
+    {
+      win_mn.t0 = windowRange.t0 + m * windowRange.dt0;
+      INT4 i_tmp = ( win_mn.t0 - t0_data + TAtomHalf ) / TAtom;	// integer round: floor(x+0.5)
+      if ( i_tmp < 0 ) i_tmp = 0;
+      i_t0[m] = (UINT4)i_tmp;
+      if ( i_t0[m] >= numAtoms ) i_t0[m] = numAtoms - 1;
+
+      for ( UINT4 n = 0; n < N_tauRange; n ++ )
+        {
+          win_mn.tau = windowRange.tau + n * windowRange.dtau;
+          UINT4 t0, t1;
+          XLAL_CHECK_FAIL ( XLALGetTransientWindowTimespan ( &t0, &t1, win_mn ) == XLAL_SUCCESS, XLAL_EFUNC );
+          i_tmp = ( t1 - t0_data + TAtomHalf ) / TAtom  - 1;	// integer round: floor(x+0.5)
+          if ( i_tmp < 0 ) i_tmp = 0;
+          UINT4 i1 = (UINT4)i_tmp;
+          if ( i1 >= numAtoms ) i1 = numAtoms - 1;
+
+          /* protection against degenerate 1-atom case: (this implies D=0 and therefore F->inf) */
+          XLAL_CHECK_FAIL ( i1 != i_t0[m], XLAL_EDOM,
+                            "Encountered a single-atom Fstat-calculation at window-values m=%d (t0=%d=t0_data + %d), n=%d (tau=%d) ==> t1_data - t0 = %d.\n"
+                            "The most likely cause is that your t0-range covered all of your data: t0 must stay away *at least* 2*TAtom from the end of the data!\n",
+                            m, win_mn.t0, i_t0[m] * TAtom, n, win_mn.tau, t1_data - win_mn.t0 );
+          i_t1[m * N_tauRange + n] = i1;
+        } /* for n < N_tauRange */
+    } /* for m < N_t0Range */
+
+  /* per-row [rectangular] or per-column [exponential] loudest F-values, combined serially at the end */
+  UINT4 N_max = ( windowRange.type == TRANSIENT_RECTANGULAR ) ? N_t0Range : N_tauRange;
+  XLAL_CHECK_FAIL ( (maxF_k = XLALCalloc ( N_max, sizeof(*maxF_k) )) != NULL, XLAL_ENOMEM );
+  XLAL_CHECK_FAIL ( (argmax_k = XLALCalloc ( N_max, sizeof(*argmax_k) )) != NULL, XLAL_ENOMEM );
+
+  switch ( windowRange.type )
+    {
+    case TRANSIENT_RECTANGULAR:
+      {
+        /* cumulative sums cum[i] = sum_{j<i} atoms[j], so that sum_{j=i0}^{i1} = cum[i1+1] - cum[i0] */
+        transientAtomSums_t *cum;
+        XLAL_CHECK_FAIL ( (cum = XLALCalloc ( numAtoms + 1, sizeof(*cum) )) != NULL, XLAL_ENOMEM );
+        for ( UINT4 i = 0; i < numAtoms; i ++ )
+          {
+            const FstatAtom *thisAtom_i = &atoms->data[i];
+            cum[i+1].Ad = cum[i].Ad + thisAtom_i->a2_alpha;
+            cum[i+1].Bd = cum[i].Bd + thisAtom_i->b2_alpha;
+            cum[i+1].Cd = cum[i].Cd + thisAtom_i->ab_alpha;
+            cum[i+1].Fa = cum[i].Fa + thisAtom_i->Fa_alpha;
+            cum[i+1].Fb = cum[i].Fb + thisAtom_i->Fb_alpha;
+          }
+
+#pragma omp parallel for schedule(static)
+        for ( UINT4 m = 0; m < N_t0Range; m ++ )
+          {
+            const transientAtomSums_t *start = &cum[i_t0[m]];
+            maxF_k[m] = -1.0;
+            for ( UINT4 n = 0; n < N_tauRange; n ++ )
+              {
+                const transientAtomSums_t *end = &cum[i_t1[m * N_tauRange + n] + 1];
+                transientAtomSums_t sum;
+                sum.Ad = end->Ad - start->Ad;
+                sum.Bd = end->Bd - start->Bd;
+                sum.Cd = end->Cd - start->Cd;
+                sum.Fa = end->Fa - start->Fa;
+                sum.Fb = end->Fb - start->Fb;
+                REAL8 F = store_transientFstat_from_sums ( ret->F_mn, m, n, &sum, useFReg );
+                if ( F > maxF_k[m] ) {
+                  maxF_k[m] = F;
+                  argmax_k[m] = n;
+                }
+              } /* for n < N_tauRange */
+          } /* for m < N_t0Range */
+
+        XLALFree ( cum );
+      }
+      break;
+
+    case TRANSIENT_EXPONENTIAL:
+      {
+#ifdef _OPENMP
+        const int numThreads = omp_get_max_threads();
+#else
+        const int numThreads = 1;
+#endif
+        /* per-thread buffers for the backwards exponential filters S_i */
+        transientAtomSums_t *filt;
+        XLAL_CHECK_FAIL ( (filt = XLALCalloc ( numThreads * (numAtoms + 1), sizeof(*filt) )) != NULL, XLAL_ENOMEM );
+
+#pragma omp parallel for schedule(dynamic)
+        for ( UINT4 n = 0; n < N_tauRange; n ++ )
+          {
+#ifdef _OPENMP
+            transientAtomSums_t *S = &filt[omp_get_thread_num() * (numAtoms + 1)];
+#else
+            transientAtomSums_t *S = filt;
+#endif
+            const REAL8 tau = windowRange.tau + n * windowRange.dtau;
+            const REAL8 r  = exp ( - 1.0 * TAtom / tau );	/* window-ratio between consecutive atoms */
+            const REAL8 r2 = r * r;				/* same for squared window */
+
+            /* backwards filters: Fa,Fb are weighted by the window, A,B,C by the squared window */
+            memset ( &S[numAtoms], 0, sizeof(S[numAtoms]) );
+            for ( INT4 i = numAtoms - 1; i >= 0; i -- )
+              {
+                const FstatAtom *thisAtom_i = &atoms->data[i];
+                S[i].Ad = thisAtom_i->a2_alpha + r2 * S[i+1].Ad;
+                S[i].Bd = thisAtom_i->b2_alpha + r2 * S[i+1].Bd;
+                S[i].Cd = thisAtom_i->ab_alpha + r2 * S[i+1].Cd;
+                S[i].Fa = thisAtom_i->Fa_alpha + r  * S[i+1].Fa;
+                S[i].Fb = thisAtom_i->Fb_alpha + r  * S[i+1].Fb;
+              }
+
+            maxF_k[n] = -1.0;
+            for ( UINT4 m = 0; m < N_t0Range; m ++ )
+              {
+                const UINT4 t0 = windowRange.t0 + m * windowRange.dt0;
+                const UINT4 t1 = lround ( t0 + TRANSIENT_EXP_EFOLDING * tau );
+
+                /* restrict [i_t0, i_t1] to atoms within the window timespan [t0, t1], as in XLALGetExponentialTransientWindowValue() */
+                UINT4 i_lo = i_t0[m];
+                UINT4 i_hi = i_t1[m * N_tauRange + n];
+                if ( t0_data + i_lo * TAtom < t0 ) i_lo ++;
+                if ( ( i_hi > 0 ) && ( t0_data + i_hi * TAtom > t1 ) ) i_hi --;
+
+                transientAtomSums_t sum = { 0, 0, 0, 0, 0 };
+                if ( i_lo <= i_hi )
+                  {
+                    const REAL8 w_lo  = exp ( - 1.0 * ( t0_data + i_lo * TAtom - t0 ) / tau );	/* window-value of first atom */
+                    const REAL8 w2_lo = w_lo * w_lo;
+                    const REAL8 rL    = exp ( - 1.0 * ( i_hi + 1 - i_lo ) * TAtom / tau );		/* r^L, with L = number of atoms in window */
+                    const REAL8 r2L   = rL * rL;
+                    sum.Ad = w2_lo * ( S[i_lo].Ad - r2L * S[i_hi+1].Ad );
+                    sum.Bd = w2_lo * ( S[i_lo].Bd - r2L * S[i_hi+1].Bd );
+                    sum.Cd = w2_lo * ( S[i_lo].Cd - r2L * S[i_hi+1].Cd );
+                    sum.Fa = w_lo  * ( S[i_lo].Fa - rL  * S[i_hi+1].Fa );
+                    sum.Fb = w_lo  * ( S[i_lo].Fb - rL  * S[i_hi+1].Fb );
+                  }
+
+                REAL8 F = store_transientFstat_from_sums ( ret->F_mn, m, n, &sum, useFReg );
+                if ( F > maxF_k[n] ) {
+                  maxF_k[n] = F;
+                  argmax_k[n] = m;
+                }
+              } /* for m < N_t0Range */
+          } /* for n < N_tauRange */
+
+        XLALFree ( filt );
+      }
+      break;
+
+    default:
+      XLAL_ERROR_FAIL ( XLAL_EINVAL, "Invalid transient window type %d not in [%d, %d].\n", windowRange.type, TRANSIENT_NONE, TRANSIENT_LAST -1 );
+      break;
+
+    } /* switch window.type */
+
+  /* ----- find the loudest F-stat value over the m x n matrix, picking the first one in {m,n} order as XLALComputeTransientFstatMap() ----- */
+  ret->maxF = -1.0;
+  UINT4 m_ML = 0, n_ML = 0;
+  for ( UINT4 k = 0; k < N_max; k ++ )
+    {
+      UINT4 m = ( windowRange.type == TRANSIENT_RECTANGULAR ) ? k : argmax_k[k];
+      UINT4 n = ( windowRange.type == TRANSIENT_RECTANGULAR ) ? argmax_k[k] : k;
+      if ( ( maxF_k[k] > ret->maxF ) || ( ( maxF_k[k] == ret->maxF ) && ( m < m_ML ) ) )
+        {
+          ret->maxF = maxF_k[k];
+          m_ML = m;
+          n_ML = n;
+        }
+    }
+  ret->t0_ML  = windowRange.t0  + m_ML * windowRange.dt0;	/* start-time t0 corresponding to Fmax */
+  ret->tau_ML = windowRange.tau + n_ML * windowRange.dtau;	/* timescale tau corresponding to Fmax */
+
+  /* free internal mem */
+  XLALFree ( maxF_k );
+  XLALFree ( argmax_k );
+  XLALFree ( i_t0 );
+  XLALFree ( i_t1 );
+  XLALDestroyFstatAtomVector ( atoms );
+
+  /* return end product: F-stat map */
+  return ret;
+
+XLAL_FAIL:
+  XLALFree ( maxF_k );
+  XLALFree ( argmax_k );
+  XLALFree ( i_t0 );
+  XLALFree ( i_t1 );
+  XLALDestroyFstatAtomVector ( atoms );
+  XLALDestroyTransientFstatMap ( ret );
+  return NULL;
+
+} /* XLALComputeTransientFstatMapIncremental() */
+
+
+/**
+ * Compute F from window-weighted atoms sums as XLALComputeTransientFstatMap() does, but in double precision,
+ * store F (or FReg if requested) as element {m,n} of F_mn, and return F.
+ *
+ * An ill-conditioned antenna-pattern matrix is detected by XLALComputeAntennaPatternSqrtDeterminant(),
+ * whose fallback determinant (INFINITY or NAN) is then used as in compute_fstat_from_fa_fb().
+ */
+static inline REAL8
+store_transientFstat_from_sums ( gsl_matrix *F_mn, UINT4 m, UINT4 n, const transientAtomSums_t *sum, BOOLEAN useFReg )
+{
+  REAL8 Ad = sum->Ad, Bd = sum->Bd, Cd = sum->Cd;
+  REAL8 Dd = XLALComputeAntennaPatternSqrtDeterminant ( Ad, Bd, Cd, 0 );
+  if ( isfinite ( Dd ) ) {
+    Dd = Ad * Bd - Cd * Cd;
+  }
+  REAL8 DdInv = 1.0 / Dd;
+
+  REAL8 twoF = 4;	// default fallback = E[2F] in noise when DdInv == 0 due to ill-conditionness of M_munu
+  if ( DdInv > 0 )
+    {
+      twoF = 2.0 * DdInv * (  Bd * ( SQ(creal(sum->Fa)) + SQ(cimag(sum->Fa)) )
+                              + Ad * ( SQ(creal(sum->Fb)) + SQ(cimag(sum->Fb)) )
+                              - 2.0 * Cd * ( creal(sum->Fa) * creal(sum->Fb) + cimag(sum->Fa) * cimag(sum->Fb) )
+                              );
+    }
+  REAL8 F = 0.5 * twoF;
+
+  /* if requested: use 'regularized' F-stat: log ( 1/D * e^F ) = F + log(1/D) */
+  gsl_matrix_set ( F_mn, m, n, useFReg ? F + log( DdInv ) : F );
+
+  return F;
+
+} /* store_transientFstat_from_sums() */
+
+
 
 
 /**
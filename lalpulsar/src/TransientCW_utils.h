@@ -119,6 +119,10 @@ transientFstatMap_t *XLALComputeTransientFstatMap ( const MultiFstatAtomVector *
                                                     transientWindowRange_t windowRange,
                                                     BOOLEAN useFReg );
 
+transientFstatMap_t *XLALComputeTransientFstatMapIncremental ( const MultiFstatAtomVector *multiFstatAtoms,
+                                                               transientWindowRange_t windowRange,
+                                                               BOOLEAN useFReg );
+
 REAL8 XLALComputeTransientBstat ( transientWindowRange_t windowRange, const transientFstatMap_t *FstatMap );
 pdf1D_t *XLALComputeTransientPosterior_t0  ( transientWindowRange_t windowRange, const transientFstatMap_t *FstatMap );
 pdf1D_t *XLALComputeTransientPosterior_tau ( transientWindowRange_t windowRange, const transientFstatMap_t *FstatMap );
@@ -0,0 +1,152 @@
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with with program; see the file COPYING. If not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ *  MA  02111-1307  USA
+ */
+
+/*********************************************************************************/
+/**
+ * \file
+ * \brief
+ * Test that XLALCalculatePulsarCrossCorrStatisticBlocked() reproduces the cross-correlation
+ * statistic of XLALCalculatePulsarCrossCorrStatistic(), and compare their run times.
+ */
+
+/* ---------- Includes -------------------- */
+#include <math.h>
+#include <stdlib.h>
+
+#include <lal/LALStdlib.h>
+#include <lal/SFTutils.h>
+#include <lal/LogPrintf.h>
+#include <lal/PulsarCrossCorr_v2.h>
+
+/* ---------- Defines -------------------- */
+#define NUM_DETS 2
+#define NUM_SFTS_PER_DET 200
+#define SFT_BINS 64
+#define TSFT 1800
+#define MAX_LAG 36000
+
+/* ----- function definitions ---------- */
+int
+main ( void )
+{
+  /* ----- random-ish SFT data for two detectors ----- */
+  UINT4Vector *numSFTsPerDet;
+  XLAL_CHECK_MAIN ( ( numSFTsPerDet = XLALCreateUINT4Vector ( NUM_DETS ) ) != NULL, XLAL_EFUNC );
+  for ( UINT4 X = 0; X < NUM_DETS; X ++ ) {
+    numSFTsPerDet->data[X] = NUM_SFTS_PER_DET;
+  }
+  MultiSFTVector *inputSFTs;
+  XLAL_CHECK_MAIN ( ( inputSFTs = XLALCreateMultiSFTVector ( SFT_BINS, numSFTsPerDet ) ) != NULL, XLAL_EFUNC );
+  srand ( 1 );
+  for ( UINT4 X = 0; X < NUM_DETS; X ++ ) {
+    for ( UINT4 i = 0; i < NUM_SFTS_PER_DET; i ++ ) {
+      SFTtype *sft = &inputSFTs->data[X]->data[i];
+      sft->epoch.gpsSeconds = 800000000 + i * TSFT + X * TSFT / 2;
+      sft->f0 = 100.0;
+      sft->deltaF = 1.0 / TSFT;
+      for ( UINT4 k = 0; k < SFT_BINS; k ++ ) {
+        sft->data->data[k] = crectf ( 1.0 * rand() / RAND_MAX - 0.5, 1.0 * rand() / RAND_MAX - 0.5 );
+      }
+    }
+  }
+
+  SFTIndexList *sftIndices = NULL;
+  SFTPairIndexList *sftPairs = NULL;
+  XLAL_CHECK_MAIN ( XLALCreateSFTIndexListFromMultiSFTVect ( &sftIndices, inputSFTs ) == XLAL_SUCCESS, XLAL_EFUNC );
+  XLAL_CHECK_MAIN ( XLALCreateSFTPairIndexList ( &sftPairs, sftIndices, inputSFTs, MAX_LAG, 0 ) == XLAL_SUCCESS, XLAL_EFUNC );
+  const UINT4 numSFTs = sftIndices->length;
+  const UINT4 numPairs = sftPairs->length;
+
+  REAL8Vector *curlyGAmp;
+  XLAL_CHECK_MAIN ( ( curlyGAmp = XLALCreateREAL8Vector ( numPairs ) ) != NULL, XLAL_EFUNC );
+  for ( UINT4 alpha = 0; alpha < numPairs; alpha ++ ) {
+    curlyGAmp->data[alpha] = 0.1 * rand() / RAND_MAX;
+  }
+
+  MultiNoiseWeights XLAL_INIT_DECL(multiWeights);
+  multiWeights.Sinv_Tsft = 2.0;
+
+  COMPLEX8Vector *expSignalPhases;
+  UINT4Vector *lowestBins;
+  XLAL_CHECK_MAIN ( ( expSignalPhases = XLALCreateCOMPLEX8Vector ( numSFTs ) ) != NULL, XLAL_EFUNC );
+  XLAL_CHECK_MAIN ( ( lowestBins = XLALCreateUINT4Vector ( numSFTs ) ) != NULL, XLAL_EFUNC );
+
+  /* ----- compare both methods for several numbers of bins ----- */
+  const UINT4 numBinsList[] = { 1, 2, 3, 8 };
+  for ( UINT4 n = 0; n < XLAL_NUM_ELEM ( numBinsList ); n ++ ) {
+    const UINT4 numBins = numBinsList[n];
+    REAL8VectorSequence *sincList;
+    XLAL_CHECK_MAIN ( ( sincList = XLALCreateREAL8VectorSequence ( numSFTs, numBins ) ) != NULL, XLAL_EFUNC );
+    for ( UINT4 sftNum = 0; sftNum < numSFTs; sftNum ++ ) {
+      REAL8 phase = LAL_TWOPI * rand() / RAND_MAX;
+      expSignalPhases->data[sftNum] = crectf ( cos ( phase ), sin ( phase ) );
+      lowestBins->data[sftNum] = rand() % ( SFT_BINS - numBins );
+      REAL8 offset = 1.0 * rand() / RAND_MAX - 0.5;
+      for ( UINT4 k = 0; k < numBins; k ++ ) {
+        REAL8 x = offset + k - 0.5 * numBins;
+        sincList->data[sftNum * numBins + k] = ( fabs ( x ) > 1e-5 ) ? sin ( LAL_PI * x ) / ( LAL_PI * x ) : 1.0;
+      }
+    }
+
+    REAL8 ccStat = 0, evSquared = 0, ccStatBlocked = 0, evSquaredBlocked = 0;
+    REAL8 tic = XLALGetCPUTime();
+    XLAL_CHECK_MAIN ( XLALCalculatePulsarCrossCorrStatistic ( &ccStat, &evSquared, curlyGAmp, expSignalPhases, lowestBins, sincList, sftPairs, sftIndices, inputSFTs, &multiWeights, numBins ) == XLAL_SUCCESS, XLAL_EFUNC );
+    REAL8 time = XLALGetCPUTime() - tic;
+    tic = XLALGetCPUTime();
+    XLAL_CHECK_MAIN ( XLALCalculatePulsarCrossCorrStatisticBlocked ( &ccStatBlocked, &evSquaredBlocked, curlyGAmp, expSignalPhases, lowestBins, sincList, sftPairs, sftIndices, inputSFTs, &multiWeights, numBins ) == XLAL_SUCCESS, XLAL_EFUNC );
+    REAL8 timeBlocked = XLALGetCPUTime() - tic;
+
+    XLALPrintInfo ( "numBins=%u, numPairs=%u: rho = %.9g / %.9g, evSquared = %.9g / %.9g, time = %.3g s / %.3g s (per-pair / blocked)\n",
+                    numBins, numPairs, ccStat, ccStatBlocked, evSquared, evSquaredBlocked, time, timeBlocked );
+
+    /* the per-pair method accumulates single-precision products, hence the tolerances */
+    XLAL_CHECK_MAIN ( fabs ( evSquaredBlocked - evSquared ) <= 1e-10 * evSquared, XLAL_ETOL, "numBins=%u: evSquared differs: %.9g vs %.9g\n", numBins, evSquaredBlocked, evSquared );
+    XLAL_CHECK_MAIN ( fabs ( ccStatBlocked - ccStat ) <= 1e-4 * ( 1 + fabs ( ccStat ) ), XLAL_ETOL, "numBins=%u: rho differs: %.9g vs %.9g\n", numBins, ccStatBlocked, ccStat );
+
+    XLALDestroyREAL8VectorSequence ( sincList );
+  }
+
+  /* ----- an SFT whose bins run off the end of its data must be reported ----- */
+  {
+    const UINT4 numBins = 2;
+    REAL8VectorSequence *sincList;
+    XLAL_CHECK_MAIN ( ( sincList = XLALCreateREAL8VectorSequence ( numSFTs, numBins ) ) != NULL, XLAL_EFUNC );
+    for ( UINT4 i = 0; i < sincList->length * sincList->vectorLength; i ++ ) {
+      sincList->data[i] = 1.0;
+    }
+    lowestBins->data[sftPairs->data[0].sftNum[1]] = SFT_BINS - 1;
+    REAL8 ccStat = 0, evSquared = 0;
+    int errnum;
+    XLAL_TRY ( XLALCalculatePulsarCrossCorrStatisticBlocked ( &ccStat, &evSquared, curlyGAmp, expSignalPhases, lowestBins, sincList, sftPairs, sftIndices, inputSFTs, &multiWeights, numBins ), errnum );
+    XLAL_CHECK_MAIN ( errnum == XLAL_EINVAL, XLAL_EFAILED, "Out-of-range bins were not detected\n" );
+    XLALDestroyREAL8VectorSequence ( sincList );
+  }
+
+  /* ----- clean up ----- */
+  XLALDestroyCOMPLEX8Vector ( expSignalPhases );
+  XLALDestroyUINT4Vector ( lowestBins );
+  XLALDestroyREAL8Vector ( curlyGAmp );
+  XLALDestroySFTPairIndexList ( sftPairs );
+  XLALDestroySFTIndexList ( sftIndices );
+  XLALDestroyMultiSFTVector ( inputSFTs );
+  XLALDestroyUINT4Vector ( numSFTsPerDet );
+
+  LALCheckMemoryLeaks();
+
+  return XLAL_SUCCESS;
+
+} /* main() */
@@ -0,0 +1,228 @@
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with with program; see the file COPYING. If not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ *  MA  02111-1307  USA
+ */
+
+/*********************************************************************************/
+/**
+ * \file
+ * \brief
+ * Test that XLALComputeTransientFstatMapIncremental() reproduces the F-stat maps
+ * of the direct method XLALComputeTransientFstatMap() for rectangular windows, and of a
+ * direct summation with exact window-values for exponential windows.
+ */
+
+/* ---------- Includes -------------------- */
+#include <math.h>
+#include <stdlib.h>
+
+#include <lal/LALStdlib.h>
+#include <lal/TransientCW_utils.h>
+
+/* ---------- Defines -------------------- */
+#define TATOM 1800
+#define NUM_ATOMS 500
+
+/*---------- internal prototypes ----------*/
+static int compareFstatMaps ( const transientFstatMap_t *map1, const transientFstatMap_t *map2, REAL8 tolerance, const char *name );
+static transientFstatMap_t *computeExactFstatMap ( const MultiFstatAtomVector *multiFstatAtoms, transientWindowRange_t windowRange, BOOLEAN useFReg );
+
+/*---------- empty initializers ---------- */
+
+/* ----- function definitions ---------- */
+int
+main ( void )
+{
+  /* ----- generate some random-ish single-detector atoms on a regular grid ----- */
+  MultiFstatAtomVector *multiAtoms;
+  XLAL_CHECK_MAIN ( (multiAtoms = XLALCreateMultiFstatAtomVector ( 1 )) != NULL, XLAL_EFUNC );
+  XLAL_CHECK_MAIN ( (multiAtoms->data[0] = XLALCreateFstatAtomVector ( NUM_ATOMS )) != NULL, XLAL_EFUNC );
+  FstatAtomVector *atoms = multiAtoms->data[0];
+  atoms->TAtom = TATOM;
+
+  UINT4 startTime = 711595934;
+  srand ( 1 );
+  for ( UINT4 i = 0; i < NUM_ATOMS; i ++ )
+    {
+      REAL4 phase = LAL_TWOPI * i / 17.0;
+      FstatAtom *atom_i = &atoms->data[i];
+      atom_i->timestamp = startTime + i * TATOM;
+      atom_i->a2_alpha = 0.5 + 0.3 * cos ( phase );
+      atom_i->b2_alpha = 0.5 + 0.3 * sin ( phase );
+      atom_i->ab_alpha = 0.1 * sin ( 2 * phase );
+      atom_i->Fa_alpha = crectf ( 1.0 * rand() / RAND_MAX - 0.5, 1.0 * rand() / RAND_MAX - 0.5 );
+      atom_i->Fb_alpha = crectf ( 1.0 * rand() / RAND_MAX - 0.5, 1.0 * rand() / RAND_MAX - 0.5 );
+      /* add a transient 'signal' in the middle of the data */
+      if ( ( i > NUM_ATOMS / 3 ) && ( i < NUM_ATOMS / 2 ) ) {
+        atom_i->Fa_alpha += 2.0 * atom_i->a2_alpha;
+        atom_i->Fb_alpha += 2.0 * atom_i->ab_alpha;
+      }
+    } /* for i < NUM_ATOMS */
+
+  transientWindowRange_t XLAL_INIT_DECL(windowRange);
+  windowRange.t0      = startTime + 3 * TATOM / 2;
+  windowRange.t0Band  = NUM_ATOMS * TATOM / 2;
+  windowRange.dt0     = TATOM;
+  windowRange.tau     = 2 * TATOM;
+  windowRange.tauBand = NUM_ATOMS * TATOM / 4;
+  windowRange.dtau    = TATOM / 2;
+
+  /* ----- compare with a reference method for all window types ----- */
+  const struct {
+    transientWindowType_t type;
+    const char *name;
+    transientFstatMap_t *(*reference) ( const MultiFstatAtomVector *, transientWindowRange_t, BOOLEAN );
+    REAL8 tolerance;
+  } cases[] = {
+    { TRANSIENT_NONE,		"none",	XLALComputeTransientFstatMap,	1e-5 },		// limited by the single-precision sums of the direct method
+    { TRANSIENT_RECTANGULAR,	"rect",	XLALComputeTransientFstatMap,	1e-4 },
+    { TRANSIENT_EXPONENTIAL,	"exp",	computeExactFstatMap,		1e-10 },	// the direct method uses an e^(-x) lookup-table with resolution dx=0.01
+  };
+  for ( UINT4 k = 0; k < XLAL_NUM_ELEM(cases); k ++ )
+    {
+      windowRange.type = cases[k].type;
+      for ( int useFReg = 0; useFReg <= 1; useFReg ++ )
+        {
+          transientFstatMap_t *mapRef, *mapIncr;
+          XLAL_CHECK_MAIN ( (mapRef = cases[k].reference ( multiAtoms, windowRange, useFReg )) != NULL, XLAL_EFUNC );
+          XLAL_CHECK_MAIN ( (mapIncr = XLALComputeTransientFstatMapIncremental ( multiAtoms, windowRange, useFReg )) != NULL, XLAL_EFUNC );
+          XLAL_CHECK_MAIN ( compareFstatMaps ( mapRef, mapIncr, cases[k].tolerance, cases[k].name ) == XLAL_SUCCESS, XLAL_EFUNC );
+          XLALDestroyTransientFstatMap ( mapRef );
+          XLALDestroyTransientFstatMap ( mapIncr );
+        }
+    } /* for k < numCases */
+
+  /* ----- free memory ----- */
+  XLALDestroyMultiFstatAtomVector ( multiAtoms );
+  XLALDestroyExpLUT();
+
+  LALCheckMemoryLeaks();
+
+  return EXIT_SUCCESS;
+
+} /* main() */
+
+/**
+ * Compare two transient F-stat maps element-wise and their maximum-likelihood estimators
+ */
+static int
+compareFstatMaps ( const transientFstatMap_t *map1, const transientFstatMap_t *map2, REAL8 tolerance, const char *name )
+{
+  XLAL_CHECK ( map1->F_mn->size1 == map2->F_mn->size1 && map1->F_mn->size2 == map2->F_mn->size2, XLAL_EFAILED,
+               "%s: inconsistent F-stat map dimensions (%zux%zu) != (%zux%zu)\n", name, map1->F_mn->size1, map1->F_mn->size2, map2->F_mn->size1, map2->F_mn->size2 );
+
+  REAL8 maxRelErr = 0;
+  for ( size_t m = 0; m < map1->F_mn->size1; m ++ )
+    {
+      for ( size_t n = 0; n < map1->F_mn->size2; n ++ )
+        {
+          REAL8 F1 = gsl_matrix_get ( map1->F_mn, m, n );
+          REAL8 F2 = gsl_matrix_get ( map2->F_mn, m, n );
+          REAL8 relErr = fabs ( F1 - F2 ) / fmax ( 1.0, fabs ( F1 ) );
+          maxRelErr = fmax ( maxRelErr, relErr );
+        }
+    }
+  REAL8 relErrMax = fabs ( map1->maxF - map2->maxF ) / map1->maxF;
+  XLALPrintInfo ( "%s: %zux%zu map: max relative error = %g, maxF = %g vs %g\n", name, map1->F_mn->size1, map1->F_mn->size2, maxRelErr, map1->maxF, map2->maxF );
+
+  XLAL_CHECK ( maxRelErr <= tolerance, XLAL_ETOL, "%s: maximal relative F-stat map deviation %g exceeds tolerance %g\n", name, maxRelErr, tolerance );
+  XLAL_CHECK ( relErrMax <= tolerance, XLAL_ETOL, "%s: relative maxF deviation %g exceeds tolerance %g\n", name, relErrMax, tolerance );
+  XLAL_CHECK ( map1->t0_ML == map2->t0_ML && map1->tau_ML == map2->tau_ML, XLAL_ETOL, "%s: ML-estimators differ: {t0,tau} = {%d,%d} != {%d,%d}\n",
+               name, map1->t0_ML, map1->tau_ML, map2->t0_ML, map2->tau_ML );
+
+  return XLAL_SUCCESS;
+
+} /* compareFstatMaps() */
+
+/**
+ * Compute the F-stat map of a single-detector atoms-vector by direct summation over every window {t0, tau},
+ * like XLALComputeTransientFstatMap(), but with exact window-values and in double precision throughout
+ */
+static transientFstatMap_t *
+computeExactFstatMap ( const MultiFstatAtomVector *multiFstatAtoms, transientWindowRange_t windowRange, BOOLEAN useFReg )
+{
+  XLAL_CHECK_NULL ( multiFstatAtoms->length == 1, XLAL_EINVAL, "Only single-detector atoms are supported\n" );
+  const FstatAtomVector *atoms = multiFstatAtoms->data[0];
+  UINT4 numAtoms = atoms->length;
+  UINT4 TAtom = atoms->TAtom;
+  UINT4 t0_data = atoms->data[0].timestamp;
+
+  UINT4 N_t0Range  = (UINT4) floor ( windowRange.t0Band / windowRange.dt0 ) + 1;
+  UINT4 N_tauRange = (UINT4) floor ( windowRange.tauBand / windowRange.dtau ) + 1;
+
+  transientFstatMap_t *ret;
+  XLAL_CHECK_NULL ( (ret = XLALCalloc ( 1, sizeof(*ret) )) != NULL, XLAL_ENOMEM );
+  XLAL_CHECK_FAIL ( (ret->F_mn = gsl_matrix_calloc ( N_t0Range, N_tauRange )) != NULL, XLAL_ENOMEM );
+
+  transientWindow_t win_mn;
+  win_mn.type = windowRange.type;
+  ret->maxF = -1.0;
+  for ( UINT4 m = 0; m < N_t0Range; m ++ )
+    {
+      win_mn.t0 = windowRange.t0 + m * windowRange.dt0;
+      INT4 i_tmp = ( win_mn.t0 - t0_data + TAtom / 2 ) / TAtom;	// integer round: floor(x+0.5)
+      if ( i_tmp < 0 ) i_tmp = 0;
+      UINT4 i_t0 = (UINT4)i_tmp;
+      if ( i_t0 >= numAtoms ) i_t0 = numAtoms - 1;
+
+      for ( UINT4 n = 0; n < N_tauRange; n ++ )
+        {
+          win_mn.tau = windowRange.tau + n * windowRange.dtau;
+          UINT4 t0, t1;
+          XLAL_CHECK_FAIL ( XLALGetTransientWindowTimespan ( &t0, &t1, win_mn ) == XLAL_SUCCESS, XLAL_EFUNC );
+          i_tmp = ( t1 - t0_data + TAtom / 2 ) / TAtom - 1;	// integer round: floor(x+0.5)
+          if ( i_tmp < 0 ) i_tmp = 0;
+          UINT4 i_t1 = (UINT4)i_tmp;
+          if ( i_t1 >= numAtoms ) i_t1 = numAtoms - 1;
+
+          REAL8 Ad = 0, Bd = 0, Cd = 0;
+          COMPLEX16 Fa = 0, Fb = 0;
+          for ( UINT4 i = i_t0; i <= i_t1; i ++ )
+            {
+              const FstatAtom *thisAtom_i = &atoms->data[i];
+              UINT4 t_i = thisAtom_i->timestamp;
+              if ( t_i < t0 || t_i > t1 ) {
+                continue;
+              }
+              REAL8 win_i = exp ( - 1.0 * ( t_i - t0 ) / win_mn.tau );
+              REAL8 win2_i = win_i * win_i;
+              Ad += thisAtom_i->a2_alpha * win2_i;
+              Bd += thisAtom_i->b2_alpha * win2_i;
+              Cd += thisAtom_i->ab_alpha * win2_i;
+              Fa += thisAtom_i->Fa_alpha * win_i;
+              Fb += thisAtom_i->Fb_alpha * win_i;
+            }
+
+          REAL8 Dd = Ad * Bd - Cd * Cd;
+          REAL8 F = ( Bd * ( creal(Fa) * creal(Fa) + cimag(Fa) * cimag(Fa) )
+                      + Ad * ( creal(Fb) * creal(Fb) + cimag(Fb) * cimag(Fb) )
+                      - 2.0 * Cd * ( creal(Fa) * creal(Fb) + cimag(Fa) * cimag(Fb) ) ) / Dd;
+          gsl_matrix_set ( ret->F_mn, m, n, useFReg ? F - log ( Dd ) : F );
+
+          if ( F > ret->maxF ) {
+            ret->maxF = F;
+            ret->t0_ML  = win_mn.t0;
+            ret->tau_ML = win_mn.tau;
+          }
+        } /* for n < N_tauRange */
+    } /* for m < N_t0Range */
+
+  return ret;
+
+XLAL_FAIL:
+  XLALDestroyTransientFstatMap ( ret );
+  return NULL;
+
+} /* computeExactFstatMap() */
@@ -288,6 +288,29 @@ int XLALSimInspiralNRSur7dq2Polarizations(
         LALValue* ModeArray             /**< Container for the ell and m modes to generate. To generate all available modes pass NULL */
 );
 
+#ifndef SWIG /* exclude from SWIG interface */
+int XLALSimInspiralNRSur7dq2PolarizationsBatch(
+        REAL8TimeSeries **hplus,        /**< OUTPUT array of n h_+ vectors */
+        REAL8TimeSeries **hcross,       /**< OUTPUT array of n h_x vectors */
+        UINT4 n,                        /**< number of parameter points */
+        const REAL8 *phiRef,            /**< orbital phases at reference pt. */
+        const REAL8 *inclination,       /**< inclination angles */
+        REAL8 deltaT,                   /**< sampling interval (s) */
+        const REAL8 *m1,                /**< masses of companion 1 (kg) */
+        const REAL8 *m2,                /**< masses of companion 2 (kg) */
+        const REAL8 *distance,          /**< distances of source (m) */
+        REAL8 fMin,                     /**< start GW frequency (Hz) */
+        REAL8 fRef,                     /**< reference GW frequency (Hz) */
+        const REAL8 *s1x,               /**< reference values of S1x */
+        const REAL8 *s1y,               /**< reference values of S1y */
+        const REAL8 *s1z,               /**< reference values of S1z */
+        const REAL8 *s2x,               /**< reference values of S2x */
+        const REAL8 *s2y,               /**< reference values of S2y */
+        const REAL8 *s2z,               /**< reference values of S2z */
+        LALValue* ModeArray             /**< Container for the ell and m modes to generate. To generate all available modes pass NULL */
+);
+#endif
+
 SphHarmTimeSeries *XLALSimInspiralNRSur7dq2Modes(
         REAL8 phiRef,                   /**< orbital phase at reference pt. */
         REAL8 deltaT,                   /**< sampling interval (s) */
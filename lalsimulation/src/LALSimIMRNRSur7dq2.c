@@ -41,6 +41,7 @@
 #include <gsl/gsl_blas.h>
 #include <gsl/gsl_min.h>
 #include <gsl/gsl_spline.h>
+#include <gsl/gsl_poly.h>
 #include <gsl/gsl_complex_math.h>
 #include <lal/Units.h>
 #include <lal/SeqFactories.h>
@@ -66,11 +67,29 @@
 #include <pthread.h>
 #endif
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 #ifdef LAL_PTHREAD_LOCK
 static pthread_once_t NRSur7dq2_is_initialized = PTHREAD_ONCE_INIT;
 #endif
 
+/**
+ * Per-thread scratch space, created on first use by each thread and
+ * destroyed when the thread exits.
+ */
+#ifdef LAL_PTHREAD_LOCK
+static pthread_once_t NRSur7dq2_workspace_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t NRSur7dq2_workspace_key;
+static void NRSur7dq2_CreateWorkspaceKey(void) {
+    pthread_key_create(&NRSur7dq2_workspace_key, NRSur7dq2Workspace_Destroy);
+}
+#else
+static NRSur7dq2Workspace *NRSur7dq2_workspace = NULL;
+#endif
+
 
 /**
  * Global surrogate data.
@@ -144,7 +163,7 @@ static void NRSur7dq2_Init_LALDATA(void) {
     int ret = NRSur7dq2_Init(&__lalsim_NRSur7dq2_data, file);
 
     if (ret != XLAL_SUCCESS)
-        XLAL_ERROR_VOID(XLAL_FAILURE, "Failure loading data from %s\n", file_path);
+        XLAL_ERROR_VOID(XLAL_EFUNC, "Failure loading data from %s\n", file_path);
 
     XLALFree(path);
     XLALFree(file_path);
@@ -189,21 +208,20 @@ static int NRSur7dq2_Init(NRSur7dq2Data *data, LALH5File *file) {
     for (i=0; i < (t_ds->size); i++) ds_node_data[i] = NULL;
     for (i=0; i < 3; i++) ds_half_node_data[i] = NULL;
     LALH5File *sub;
-    char *sub_name = XLALMalloc(15); // Should be enough for j < 1000000
+    char sub_name[15]; // Should be enough for j < 1000000
     int j;
     for (i=0; i < (t_ds->size); i++) {
         if (i < 3) {j = 2*i;} else {j = i+3;}
         snprintf(sub_name, 15, "ds_node_%d", j);
         sub = XLALH5GroupOpen(file, sub_name);
-        NRSur7dq2_LoadDynamicsNode(ds_node_data, sub, i);
+        XLAL_CHECK(NRSur7dq2_LoadDynamicsNode(ds_node_data, sub, i) == XLAL_SUCCESS, XLAL_EFUNC);
 
         if (i < 3) {
             snprintf(sub_name, 15, "ds_node_%d", j+1);
             sub = XLALH5GroupOpen(file, sub_name);
-            NRSur7dq2_LoadDynamicsNode(ds_half_node_data, sub, i);
+            XLAL_CHECK(NRSur7dq2_LoadDynamicsNode(ds_half_node_data, sub, i) == XLAL_SUCCESS, XLAL_EFUNC);
         }
     }
-    XLALFree(sub_name);
     data->ds_node_data = ds_node_data;
     data->ds_half_node_data = ds_half_node_data;
 
@@ -215,10 +233,27 @@ static int NRSur7dq2_Init(NRSur7dq2Data *data, LALH5File *file) {
     // Load coorbital waveform surrogate data
     WaveformFixedEllModeData **coorbital_mode_data = XLALMalloc( (NRSUR7DQ2_LMAX - 1) * sizeof(*coorbital_mode_data) );
     for (int ell_idx=0; ell_idx < NRSUR7DQ2_LMAX-1; ell_idx++) {
-        NRSur7dq2_LoadCoorbitalEllModes(coorbital_mode_data, file, ell_idx);
+        XLAL_CHECK(NRSur7dq2_LoadCoorbitalEllModes(coorbital_mode_data, file, ell_idx) == XLAL_SUCCESS, XLAL_EFUNC);
     }
     data->coorbital_mode_data = coorbital_mode_data;
 
+    // Size the workspace used to evaluate the waveform data pieces
+    data->max_n_nodes = 0;
+    for (int ell_idx=0; ell_idx < NRSUR7DQ2_LMAX-1; ell_idx++) {
+        WaveformFixedEllModeData *mode_data = coorbital_mode_data[ell_idx];
+        WaveformDataPiece *pieces[2] = {mode_data->m0_real_data, mode_data->m0_imag_data};
+        for (int k=0; k<2; k++) {
+            if (pieces[k]->n_nodes > data->max_n_nodes) data->max_n_nodes = pieces[k]->n_nodes;
+        }
+        for (int m=1; m<=mode_data->ell; m++) {
+            WaveformDataPiece *X_pieces[4] = {mode_data->X_real_plus_data[m-1], mode_data->X_real_minus_data[m-1],
+                                              mode_data->X_imag_plus_data[m-1], mode_data->X_imag_minus_data[m-1]};
+            for (int k=0; k<4; k++) {
+                if (X_pieces[k]->n_nodes > data->max_n_nodes) data->max_n_nodes = X_pieces[k]->n_nodes;
+            }
+        }
+    }
+
     XLAL_PRINT_INFO("Successfully loaded NRSur7dq2 data!");
     data->LMax = NRSUR7DQ2_LMAX;
     data->setup = 1;
@@ -230,7 +265,7 @@ static int NRSur7dq2_Init(NRSur7dq2Data *data, LALH5File *file) {
  * Loads the data for a single dynamics node into a DynamicsNodeFitData struct.
  * This is only called during the initialization of the surrogate data through NRSur7dq2_Init.
  */
-static void NRSur7dq2_LoadDynamicsNode(
+static int NRSur7dq2_LoadDynamicsNode(
     DynamicsNodeFitData **ds_node_data, /**< Entry i should be NULL; Will malloc space and load data into it. */
     LALH5File *sub,                     /**< Subgroup containing data for dynamics node i. */
     int i                               /**< Dynamics node index. */
@@ -244,6 +279,9 @@ static void NRSur7dq2_LoadDynamicsNode(
     ReadHDF5RealVectorDataset(sub, "omega_coefs", &(omega_data->coefs));
     ReadHDF5LongMatrixDataset(sub, "omega_bfOrders", &(omega_data->basisFunctionOrders));
     omega_data->n_coefs = omega_data->coefs->size;
+    omega_data->x_power_index = XLALMalloc(7 * omega_data->n_coefs);
+    XLAL_CHECK(omega_data->x_power_index, XLAL_ENOMEM);
+    XLAL_CHECK(NRSur7dq2_FlattenFitOrders(omega_data->x_power_index, omega_data->basisFunctionOrders) == XLAL_SUCCESS, XLAL_EFUNC);
     ds_node_data[i]->omega_data = omega_data;
 
     // omega_copr
@@ -293,13 +331,18 @@ static void NRSur7dq2_LoadDynamicsNode(
     }
     chiB_dot_data->vec_dim = 3;
     ds_node_data[i]->chiB_dot_data = chiB_dot_data;
+
+    ds_node_data[i]->fused = NRSur7dq2_FuseDynamicsNode(ds_node_data[i]);
+    XLAL_CHECK(ds_node_data[i]->fused, XLAL_EFUNC, "Failed to pack the fits of dynamics node %d", i);
+
+    return XLAL_SUCCESS;
 }
 
 /**
  * Load the WaveformFixedEllModeData from file for a single value of ell.
  * This is only called during the initialization of the surrogate data through NRSur7dq2_Init.
  */
-static void NRSur7dq2_LoadCoorbitalEllModes(
+static int NRSur7dq2_LoadCoorbitalEllModes(
     WaveformFixedEllModeData **coorbital_mode_data, /**< Entry i should be NULL; will malloc space and load data into it.*/
     LALH5File *file, /**< The open NRSur7dq2.hdf5 file */
     int i /**< The index of coorbital_mode_data. Equivalently, ell-2. */
@@ -308,18 +351,18 @@ static void NRSur7dq2_LoadCoorbitalEllModes(
     mode_data->ell = i+2;
 
     LALH5File *sub;
-    int str_size = 30; // Enough for L with 15 digits...
-    char *sub_name = XLALMalloc(str_size);
+    char sub_name[30]; // Enough for L with 15 digits...
+    const int str_size = sizeof(sub_name);
 
     // Real part of m=0 mode
     snprintf(sub_name, str_size, "hCoorb_%d_0_real", i+2);
     sub = XLALH5GroupOpen(file, sub_name);
-    NRSur7dq2_LoadWaveformDataPiece(sub, &(mode_data->m0_real_data), false);
+    XLAL_CHECK(NRSur7dq2_LoadWaveformDataPiece(sub, &(mode_data->m0_real_data), false) == XLAL_SUCCESS, XLAL_EFUNC);
 
     // Imag part of m=0 mode
     snprintf(sub_name, str_size, "hCoorb_%d_0_imag", i+2);
     sub = XLALH5GroupOpen(file, sub_name);
-    NRSur7dq2_LoadWaveformDataPiece(sub, &(mode_data->m0_imag_data), false);
+    XLAL_CHECK(NRSur7dq2_LoadWaveformDataPiece(sub, &(mode_data->m0_imag_data), false) == XLAL_SUCCESS, XLAL_EFUNC);
 
     // NOTE:
     // In the paper https://arxiv.org/abs/1705.07089, Eq. 16 uses
@@ -342,26 +385,27 @@ static void NRSur7dq2_LoadCoorbitalEllModes(
     for (int m=1; m<=(i+2); m++) {
         snprintf(sub_name, str_size, "hCoorb_%d_%d_Re+", i+2, m);
         sub = XLALH5GroupOpen(file, sub_name);
-        NRSur7dq2_LoadWaveformDataPiece(sub, &(mode_data->X_real_plus_data[m-1]), false);
+        XLAL_CHECK(NRSur7dq2_LoadWaveformDataPiece(sub, &(mode_data->X_real_plus_data[m-1]), false) == XLAL_SUCCESS, XLAL_EFUNC);
         snprintf(sub_name, str_size, "hCoorb_%d_%d_Re-", i+2, m);
         sub = XLALH5GroupOpen(file, sub_name);
-        NRSur7dq2_LoadWaveformDataPiece(sub, &(mode_data->X_real_minus_data[m-1]), true);
+        XLAL_CHECK(NRSur7dq2_LoadWaveformDataPiece(sub, &(mode_data->X_real_minus_data[m-1]), true) == XLAL_SUCCESS, XLAL_EFUNC);
         snprintf(sub_name, str_size, "hCoorb_%d_%d_Im+", i+2, m);
         sub = XLALH5GroupOpen(file, sub_name);
-        NRSur7dq2_LoadWaveformDataPiece(sub, &(mode_data->X_imag_plus_data[m-1]), true);
+        XLAL_CHECK(NRSur7dq2_LoadWaveformDataPiece(sub, &(mode_data->X_imag_plus_data[m-1]), true) == XLAL_SUCCESS, XLAL_EFUNC);
         snprintf(sub_name, str_size, "hCoorb_%d_%d_Im-", i+2, m);
         sub = XLALH5GroupOpen(file, sub_name);
-        NRSur7dq2_LoadWaveformDataPiece(sub, &(mode_data->X_imag_minus_data[m-1]), false);
+        XLAL_CHECK(NRSur7dq2_LoadWaveformDataPiece(sub, &(mode_data->X_imag_minus_data[m-1]), false) == XLAL_SUCCESS, XLAL_EFUNC);
     }
-    XLALFree(sub_name);
     coorbital_mode_data[i] = mode_data;
+
+    return XLAL_SUCCESS;
 }
 
 /**
  * Loads a single NRSur7dq2 coorbital waveform data piece from file into a WaveformDataPiece.
  * This is only called during the initialization of the surrogate data through NRSur7dq2_Init.
  */
-static void NRSur7dq2_LoadWaveformDataPiece(
+static int NRSur7dq2_LoadWaveformDataPiece(
     LALH5File *sub,             /**< HDF5 group containing data for this waveform data piece */
     WaveformDataPiece **data,   /**< Output - *data should be NULL. Space will be allocated. */
     bool invert_sign            /**< If true, multiply the empirical interpolation matrix by -1. */
@@ -384,8 +428,8 @@ static void NRSur7dq2_LoadWaveformDataPiece(
     (*data)->fit_data = XLALMalloc( n_nodes * sizeof(FitData *) );
 
     LALH5File *nodeModelers = XLALH5GroupOpen(sub, "nodeModelers");
-    int str_size = 20; // Enough for L with 11 digits...
-    char *sub_name = XLALMalloc(str_size);
+    char sub_name[20]; // Enough for L with 11 digits...
+    const int str_size = sizeof(sub_name);
     for (int i=0; i<n_nodes; i++) {
         FitData *node_data = XLALMalloc(sizeof(FitData));
         node_data->coefs = NULL;
@@ -395,8 +439,13 @@ static void NRSur7dq2_LoadWaveformDataPiece(
         snprintf(sub_name, str_size, "bfOrders_%d", i);
         ReadHDF5LongMatrixDataset(nodeModelers, sub_name, &(node_data->basisFunctionOrders));
         node_data->n_coefs = node_data->coefs->size;
+        node_data->x_power_index = XLALMalloc(7 * node_data->n_coefs);
+        XLAL_CHECK(node_data->x_power_index, XLAL_ENOMEM);
+        XLAL_CHECK(NRSur7dq2_FlattenFitOrders(node_data->x_power_index, node_data->basisFunctionOrders) == XLAL_SUCCESS, XLAL_EFUNC);
         (*data)->fit_data[i] = node_data;
     }
+
+    return XLAL_SUCCESS;
 }
 
 /**
@@ -408,18 +457,199 @@ static bool NRSur7dq2_IsSetup(void) {
 }
 
 /**
- * Helper function for integer powers
+ * Allocates a workspace sized for the loaded surrogate data.
+ * It is allocated with the gsl and C allocators rather than XLALMalloc since
+ * it may outlive any LAL memory leak checks, like the surrogate data itself.
  */
-double ipow(double base, int exponent) {
-    if (exponent == 0) return 1.0;
-    double res = base;
-    while (exponent > 1) {
-        res = res*base;
-        exponent -= 1;
+static NRSur7dq2Workspace *NRSur7dq2Workspace_Create(void) {
+    NRSur7dq2Data *data = &__lalsim_NRSur7dq2_data;
+    NRSur7dq2Workspace *ws;
+    int j, failed = 0;
+
+    XLAL_CHECK_NULL(NRSur7dq2_IsSetup(), XLAL_EFAILED, "NRSur7dq2 data has not been loaded");
+    size_t n_ds = data->t_ds->size;
+    size_t n_coorb = data->t_coorb->size;
+
+    ws = calloc(1, sizeof(*ws));
+    XLAL_CHECK_NULL(ws, XLAL_ENOMEM);
+    ws->dynamics_data = malloc(n_ds * 11 * sizeof(double));
+    failed |= !ws->dynamics_data;
+    for (j=0; j<11; j++) {
+        ws->dynamics[j] = gsl_vector_alloc(n_ds);
+        failed |= !ws->dynamics[j];
     }
-    return res;
+    for (j=0; j<4; j++) {
+        ws->quat_coorb[j] = gsl_vector_alloc(n_coorb);
+        failed |= !ws->quat_coorb[j];
+    }
+    ws->phi_coorb = gsl_vector_alloc(n_coorb);
+    failed |= !ws->phi_coorb;
+    for (j=0; j<3; j++) {
+        ws->chiA_coorb[j] = gsl_vector_alloc(n_coorb);
+        ws->chiB_coorb[j] = gsl_vector_alloc(n_coorb);
+        failed |= !ws->chiA_coorb[j] || !ws->chiB_coorb[j];
+    }
+    ws->nodes = gsl_vector_alloc(data->max_n_nodes);
+    ws->data_piece_eval = gsl_vector_alloc(n_coorb);
+    ws->spline = gsl_spline_alloc(gsl_interp_cspline, n_ds);
+    ws->acc = gsl_interp_accel_alloc();
+    failed |= !ws->nodes || !ws->data_piece_eval || !ws->spline || !ws->acc;
+
+    if (failed) {
+        NRSur7dq2Workspace_Destroy(ws);
+        XLAL_ERROR_NULL(XLAL_ENOMEM, "Failed to allocate NRSur7dq2 workspace");
+    }
+    return ws;
+}
+
+/**
+ * Frees a workspace allocated by NRSur7dq2Workspace_Create.
+ * Takes a void pointer so that it can be used as a thread-specific data destructor.
+ */
+static void NRSur7dq2Workspace_Destroy(void *p) {
+    NRSur7dq2Workspace *ws = p;
+    int j;
+
+    if (!ws) return;
+    free(ws->dynamics_data);
+    for (j=0; j<11; j++) {
+        if (ws->dynamics[j]) gsl_vector_free(ws->dynamics[j]);
+    }
+    for (j=0; j<4; j++) {
+        if (ws->quat_coorb[j]) gsl_vector_free(ws->quat_coorb[j]);
+    }
+    if (ws->phi_coorb) gsl_vector_free(ws->phi_coorb);
+    for (j=0; j<3; j++) {
+        if (ws->chiA_coorb[j]) gsl_vector_free(ws->chiA_coorb[j]);
+        if (ws->chiB_coorb[j]) gsl_vector_free(ws->chiB_coorb[j]);
+    }
+    if (ws->nodes) gsl_vector_free(ws->nodes);
+    if (ws->data_piece_eval) gsl_vector_free(ws->data_piece_eval);
+    if (ws->spline) gsl_spline_free(ws->spline);
+    if (ws->acc) gsl_interp_accel_free(ws->acc);
+    free(ws);
 }
 
+/**
+ * Returns the workspace of the calling thread, creating it on first use.
+ * The surrogate data must already have been loaded.
+ */
+static NRSur7dq2Workspace *NRSur7dq2_GetWorkspace(void) {
+    NRSur7dq2Workspace *ws;
+#ifdef LAL_PTHREAD_LOCK
+    (void) pthread_once(&NRSur7dq2_workspace_key_once, NRSur7dq2_CreateWorkspaceKey);
+    ws = pthread_getspecific(NRSur7dq2_workspace_key);
+    if (!ws) {
+        ws = NRSur7dq2Workspace_Create();
+        XLAL_CHECK_NULL(ws, XLAL_EFUNC);
+        pthread_setspecific(NRSur7dq2_workspace_key, ws);
+    }
+#else
+    if (!NRSur7dq2_workspace) {
+        NRSur7dq2_workspace = NRSur7dq2Workspace_Create();
+        XLAL_CHECK_NULL(NRSur7dq2_workspace, XLAL_EFUNC);
+    }
+    ws = NRSur7dq2_workspace;
+#endif
+    return ws;
+}
+
+/**
+ * Converts the (n_coefs x 7) basis function orders of a fit into indices into the
+ * array of powers computed by NRSur7dq2_fit_x_powers, so that fit evaluation
+ * does not need to look up and scale the orders.
+ */
+static int NRSur7dq2_FlattenFitOrders(
+    unsigned char *x_power_index,           /**< Output: space for (n_coefs x 7) indices */
+    gsl_matrix_long *basisFunctionOrders    /**< (n_coefs x 7) basis function orders */
+) {
+    size_t i, j;
+    long order;
+
+    for (i=0; i < basisFunctionOrders->size1; i++) {
+        for (j=0; j<7; j++) {
+            order = gsl_matrix_long_get(basisFunctionOrders, i, j);
+            // The powers go up to cubic in the mass ratio and quadratic in the spins
+            if (order < 0 || 7*order + j >= 22) {
+                XLAL_ERROR(XLAL_EDOM, "Basis function order %ld of component %zu out of range", order, j);
+            }
+            x_power_index[7*i + j] = 7*order + j;
+        }
+    }
+    return XLAL_SUCCESS;
+}
+
+/**
+ * Packs the scalar and vector fits of a dynamics node into a single DynamicsNodeFusedFit.
+ */
+static DynamicsNodeFusedFit *NRSur7dq2_FuseDynamicsNode(
+    DynamicsNodeFitData *ds_node    /**< The loaded fits of the dynamics node */
+) {
+    VectorFitData *vector_fits[3] = {ds_node->omega_copr_data, ds_node->chiA_dot_data, ds_node->chiB_dot_data};
+    const int out_offset[3] = {1, 3, 6};
+    FitData *omega_data = ds_node->omega_data;
+    DynamicsNodeFusedFit *fit;
+    int i, k, n;
+    long comp;
+
+    n = omega_data->n_coefs;
+    for (k=0; k<3; k++) n += vector_fits[k]->n_coefs;
+
+    fit = XLALMalloc(sizeof(*fit));
+    XLAL_CHECK_NULL(fit, XLAL_ENOMEM);
+    fit->n_coefs = n;
+    fit->coefs = XLALMalloc(n * sizeof(*fit->coefs));
+    fit->out_index = XLALMalloc(n);
+    fit->x_power_index = XLALMalloc(7 * n);
+    XLAL_CHECK_NULL(fit->coefs && fit->out_index && fit->x_power_index, XLAL_ENOMEM);
+
+    // Keep the coefficients of each output in their original order, so that the
+    // fused evaluation sums them exactly as the individual fits would
+    n = 0;
+    for (i=0; i < omega_data->n_coefs; i++, n++) {
+        fit->coefs[n] = gsl_vector_get(omega_data->coefs, i);
+        fit->out_index[n] = 0;
+        memcpy(fit->x_power_index + 7*n, omega_data->x_power_index + 7*i, 7);
+    }
+    for (k=0; k<3; k++) {
+        VectorFitData *data = vector_fits[k];
+        if (data->n_coefs == 0) continue;
+        XLAL_CHECK_NULL(NRSur7dq2_FlattenFitOrders(fit->x_power_index + 7*n, data->basisFunctionOrders) == XLAL_SUCCESS, XLAL_EFUNC);
+        for (i=0; i < data->n_coefs; i++, n++) {
+            comp = gsl_vector_long_get(data->componentIndices, i);
+            XLAL_CHECK_NULL(comp >= 0 && comp < data->vec_dim, XLAL_EDOM, "Fit component index %ld out of range", comp);
+            fit->coefs[n] = gsl_vector_get(data->coefs, i);
+            fit->out_index[n] = out_offset[k] + comp;
+        }
+    }
+
+    return fit;
+}
+
+/**
+ * Computes the powers of the fit inputs used by the NRSur7dq2 fits.
+ * Entry 7*k + j is the k-th power of input j, where input 0 is an affine
+ * transformation of the mass ratio (up to k=3) and inputs 1-6 are the spin
+ * components (up to k=2).
+ */
+static void NRSur7dq2_fit_x_powers(
+    double *x_powers,   /**< Output: length 22 */
+    const double *x     /**< size 7, giving mass ratio q, and dimensionless spin components */
+) {
+    int j;
+
+    // The fits were constructed using this rather than using q directly
+    double q_fit = NRSUR7DQ2_Q_FIT_OFFSET + NRSUR7DQ2_Q_FIT_SLOPE*x[0];
+
+    for (j=0; j<7; j++) x_powers[j] = 1.0;
+    x_powers[7] = q_fit;
+    x_powers[14] = q_fit*q_fit;
+    x_powers[21] = q_fit*q_fit*q_fit;
+    for (j=1; j<7; j++) {
+        x_powers[7 + j] = x[j];
+        x_powers[14 + j] = x[j]*x[j];
+    }
+}
 
 /*
  * Evaluate a NRSur7dq2 scalar fit.
@@ -429,82 +659,44 @@ double ipow(double base, int exponent) {
  * space, and B_j is a basis function, taking an integer order k_{i, j} and
  * the parameter component x_j. For this surrogate, B_j are monomials in the spin
  * components, and monomials in an affine transformation of the mass ratio.
+ * The monomials are precomputed by NRSur7dq2_fit_x_powers.
  */
-double NRSur7dq2_eval_fit(
-    FitData *data,  /**< Data for fit */
-    double *x       /**< size 7, giving mass ratio q, and dimensionless spin components */
+static double NRSur7dq2_eval_fit(
+    FitData *data,          /**< Data for fit */
+    const double *x_powers  /**< Powers of the fit inputs, from NRSur7dq2_fit_x_powers */
 ) {
-    double x_powers[22]; // 3 per spin component, 4 for mass ratio
+    const double *coefs = data->coefs->data;
+    const unsigned char *k;
     double res = 0.0;
-    double prod;
-    int i, j;
-
-    // The fits were constructed using this rather than using q directly
-    double q_fit = NRSUR7DQ2_Q_FIT_OFFSET + NRSUR7DQ2_Q_FIT_SLOPE*x[0];
-
-    // Compute powers of components of x
-    for (i=0; i<22; i++) {
-        if (i%7==0) {
-            x_powers[i] = ipow(q_fit, i/7);
-        } else {
-            x_powers[i] = ipow(x[i%7], i/7);
-        }
-    }
+    int i;
 
-    // Sum up fit terms
     for (i=0; i < data->n_coefs; i++) {
-        // Initialize with q basis function:
-        prod = x_powers[7 * gsl_matrix_long_get(data->basisFunctionOrders, i, 0)];
-        // Multiply with spin basis functions:
-        for (j=1; j<7; j++) {
-            prod *= x_powers[7 * gsl_matrix_long_get(data->basisFunctionOrders, i, j) + j];
-        }
-        res += gsl_vector_get(data->coefs, i) * prod;
+        k = data->x_power_index + 7*i;
+        res += coefs[i] * (x_powers[k[0]] * x_powers[k[1]] * x_powers[k[2]] * x_powers[k[3]]
+                           * x_powers[k[4]] * x_powers[k[5]] * x_powers[k[6]]);
     }
 
     return res;
 }
 
 /*
- * This is very similar to NRSur7dq2_eval_fit except that the result is a
- * 2d or 3d vector instead of a scalar. Each fit coefficient now applies to
- * just a single component of the result.
+ * Evaluate all fits of a dynamics node at once. Each fit coefficient applies to
+ * a single one of the 9 outputs.
  */
-static void NRSur7dq2_eval_vector_fit(
-    double *res,            /**< Result */
-    VectorFitData *data,    /**< Data for fit */
-    double *x               /**< size 7, giving mass ratio q, and dimensionless spin components */
+static void NRSur7dq2_eval_dynamics_node(
+    double *res,                        /**< Result, length 9 */
+    const DynamicsNodeFusedFit *fit,    /**< Fused fits of the dynamics node */
+    const double *x_powers              /**< Powers of the fit inputs, from NRSur7dq2_fit_x_powers */
 ) {
-    double x_powers[22]; // 3 per spin component, 4 for mass ratio
-    double prod;
-    int i, j;
+    const unsigned char *k;
+    int i;
 
-    // Initialize the result
-    for (i=0; i < data->vec_dim; i++) {
-        res[i] = 0.0;
-    }
+    for (i=0; i<9; i++) res[i] = 0.0;
 
-    // The fits were constructed using this rather than using q directly
-    double q_fit = NRSUR7DQ2_Q_FIT_OFFSET + NRSUR7DQ2_Q_FIT_SLOPE*x[0];
-
-    // Compute powers of components of x
-    for (i=0; i<22; i++) {
-        if (i%7==0) {
-            x_powers[i] = ipow(q_fit, i/7);
-        } else {
-            x_powers[i] = ipow(x[i%7], i/7);
-        }
-    }
-
-    // Sum up fit terms
-    for (i=0; i < data->n_coefs; i++) {
-        // Initialize with q basis function:
-        prod = x_powers[7 * gsl_matrix_long_get(data->basisFunctionOrders, i, 0)];
-        // Multiply with spin basis functions:
-        for (j=1; j<7; j++) {
-            prod *= x_powers[7 * gsl_matrix_long_get(data->basisFunctionOrders, i, j) + j];
-        }
-        res[gsl_vector_long_get(data->componentIndices, i)] += gsl_vector_get(data->coefs, i) * prod;
+    for (i=0; i < fit->n_coefs; i++) {
+        k = fit->x_power_index + 7*i;
+        res[fit->out_index[i]] += fit->coefs[i] * (x_powers[k[0]] * x_powers[k[1]] * x_powers[k[2]] * x_powers[k[3]]
+                                                   * x_powers[k[4]] * x_powers[k[5]] * x_powers[k[6]]);
     }
 }
 
@@ -717,13 +909,10 @@ static double cubic_interp(
     double *x,      /**< The x values of the points to interpolate. Length 4, must be increasing. */
     double *y       /**< The y values of the points to interpolate. Length 4. */
 ) {
-    gsl_interp_accel *acc = gsl_interp_accel_alloc();
-    gsl_spline *interpolant = gsl_spline_alloc(gsl_interp_polynomial, 4);
-    gsl_spline_init(interpolant, x, y, 4);
-    double res = gsl_spline_eval(interpolant, xout, acc);
-    gsl_spline_free(interpolant);
-    gsl_interp_accel_free(acc);
-    return res;
+    // This is what a gsl_interp_polynomial does, without allocating one
+    double dd[4];
+    gsl_poly_dd_init(dd, x, y, 4);
+    return gsl_poly_dd_eval(dd, x, 4, xout);
 }
 
 /**
@@ -732,24 +921,22 @@ static double cubic_interp(
  * This difference leads to small differences between this implementation of NRSur7dq2 and the python
  * implementation, especially near the start and end of the waveform.
  */
-static gsl_vector *spline_array_interp(
-    gsl_vector *xout,   /**< The vector of points onto which we want to interpolate. */
-    gsl_vector *x,      /**< The x values of the data to interpolate. */
-    gsl_vector *y       /**< The y values of the data to interpolate. */
+static void spline_array_interp(
+    gsl_vector *res,        /**< Output: the interpolated values, same size as xout. */
+    gsl_spline *spline,     /**< Workspace: a gsl_interp_cspline of the same size as x. */
+    gsl_interp_accel *acc,  /**< Workspace: accelerator for spline. */
+    gsl_vector *xout,       /**< The vector of points onto which we want to interpolate. */
+    gsl_vector *x,          /**< The x values of the data to interpolate. */
+    gsl_vector *y           /**< The y values of the data to interpolate. */
 ) {
-    gsl_interp_accel *acc = gsl_interp_accel_alloc();
-    gsl_spline *spline = gsl_spline_alloc(gsl_interp_cspline, x->size);
     gsl_spline_init(spline, x->data, y->data, x->size);
+    gsl_interp_accel_reset(acc);
 
-    gsl_vector *res = gsl_vector_alloc(xout->size);
     double tmp;
     for (size_t i=0; i<xout->size; i++) {
         tmp = gsl_spline_eval(spline, gsl_vector_get(xout, i), acc);
         gsl_vector_set(res, i, tmp);
     }
-    gsl_spline_free(spline);
-    gsl_interp_accel_free(acc);
-    return res;
 }
 
 /**
@@ -761,10 +948,11 @@ static double NRSur7dq2_get_omega(
     double *y0          /**< The value of the ODE state y = [q0, qx, qy, qz, orbphase, chiAx, chiAy, chiAz,
                                                             chiBx, chiBy, chiBz] */
 ){
-    double x[7];
+    double x[7], x_powers[22];
     NRSur7dq2_ds_fit_x(x, q, y0);
+    NRSur7dq2_fit_x_powers(x_powers, x);
     FitData *data = (&__lalsim_NRSur7dq2_data)->ds_node_data[node_index]->omega_data;
-    double omega = NRSur7dq2_eval_fit(data, x);
+    double omega = NRSur7dq2_eval_fit(data, x_powers);
     return omega;
 }
 
@@ -822,6 +1010,21 @@ static double NRSur7dq2_get_t_ref(
     return t_ref;
 }
 
+/**
+ * Compute dydt at a given dynamics node from the powers of the fit inputs computed from y.
+ */
+static void NRSur7dq2_get_time_deriv_from_powers(
+    double *dydt,                   /**< Output: dy/dt at the dynamics node. Must have space for 11 entries. */
+    DynamicsNodeFitData *ds_node,   /**< Fit data of the dynamics node */
+    const double *x_powers,         /**< Powers of the fit inputs computed from y */
+    double *y                       /**< Current ODE state: [q0, qx, qy, qz, orbphase, chiAx, chiAy, chiAz, chiBx, chiBy, chiBz] */
+) {
+    // Evaluate fits: [omega, Omega_coorb_xy (2), chiA_dot (3), chiB_dot (3)]
+    double fits[9];
+    NRSur7dq2_eval_dynamics_node(fits, ds_node->fused, x_powers);
+    NRSur7dq2_assemble_dydt(dydt, y, fits + 1, fits[0], fits + 3, fits + 6);
+}
+
 /**
  * Compute dydt at a given dynamics node, where y is the numerical solution to the dynamics ODE.
  */
@@ -832,8 +1035,9 @@ static void NRSur7dq2_get_time_deriv_from_index(
     double *y       /**< Current ODE state: [q0, qx, qy, qz, orbphase, chiAx, chiAy, chiAz, chiBx, chiBy, chiBz] */
 ) {
     // Setup fit variables
-    double x[7];
+    double x[7], x_powers[22];
     NRSur7dq2_ds_fit_x(x, q, y);
+    NRSur7dq2_fit_x_powers(x_powers, x);
 
     // Get fit data
     DynamicsNodeFitData *ds_node;
@@ -843,13 +1047,7 @@ static void NRSur7dq2_get_time_deriv_from_index(
         ds_node = (&__lalsim_NRSur7dq2_data)->ds_half_node_data[-1*i0 - 1];
     }
 
-    // Evaluate fits
-    double omega, Omega_coorb_xy[2], chiA_dot[3], chiB_dot[3];
-    omega = NRSur7dq2_eval_fit(ds_node->omega_data, x);
-    NRSur7dq2_eval_vector_fit(Omega_coorb_xy, ds_node->omega_copr_data, x);
-    NRSur7dq2_eval_vector_fit(chiA_dot, ds_node->chiA_dot_data, x);
-    NRSur7dq2_eval_vector_fit(chiB_dot, ds_node->chiB_dot_data, x);
-    NRSur7dq2_assemble_dydt(dydt, y, Omega_coorb_xy, omega, chiA_dot, chiB_dot);
+    NRSur7dq2_get_time_deriv_from_powers(dydt, ds_node, x_powers, y);
 }
 
 /**
@@ -887,10 +1085,16 @@ static void NRSur7dq2_get_time_deriv(
     double times[4], derivs[4], dydt0[11], dydt1[11], dydt2[11], dydt3[11];
     int j;
     for (j=0; j<4; j++) times[j] = gsl_vector_get(t_ds, i0+j);
-    NRSur7dq2_get_time_deriv_from_index(dydt0, i0, q, y);
-    NRSur7dq2_get_time_deriv_from_index(dydt1, i0+1, q, y);
-    NRSur7dq2_get_time_deriv_from_index(dydt2, i0+2, q, y);
-    NRSur7dq2_get_time_deriv_from_index(dydt3, i0+3, q, y);
+
+    // The fit inputs are the same at all 4 nodes
+    double x[7], x_powers[22];
+    NRSur7dq2_ds_fit_x(x, q, y);
+    NRSur7dq2_fit_x_powers(x_powers, x);
+    DynamicsNodeFitData **ds_node_data = (&__lalsim_NRSur7dq2_data)->ds_node_data;
+    NRSur7dq2_get_time_deriv_from_powers(dydt0, ds_node_data[i0], x_powers, y);
+    NRSur7dq2_get_time_deriv_from_powers(dydt1, ds_node_data[i0+1], x_powers, y);
+    NRSur7dq2_get_time_deriv_from_powers(dydt2, ds_node_data[i0+2], x_powers, y);
+    NRSur7dq2_get_time_deriv_from_powers(dydt3, ds_node_data[i0+3], x_powers, y);
 
     for (j=0; j<11; j++) {
         derivs[0] = dydt0[j];
@@ -1313,13 +1517,15 @@ static void NRSur7dq2_integrate_AB4(
  */
 static void NRSur7dq2_eval_data_piece(
     gsl_vector *result, /**< Output: Should have already been assigned space */
+    gsl_vector *nodes_workspace, /**< Workspace: space for at least data->n_nodes entries */
     double q,           /**< Mass ratio */
     gsl_vector **chiA,  /**< 3 gsl_vector *s, one for each (coorbital) component */
     gsl_vector **chiB,  /**< similar to chiA */
     WaveformDataPiece *data /**< The data piece to evaluate */
 ) {
-    gsl_vector *nodes = gsl_vector_alloc(data->n_nodes);
-    double x[7];
+    gsl_vector_view nodes_view = gsl_vector_subvector(nodes_workspace, 0, data->n_nodes);
+    gsl_vector *nodes = &nodes_view.vector;
+    double x[7], x_powers[22];
     int i, j, node_index;
 
     // Evaluate the fits at the empirical nodes, using the spins at the empirical node times
@@ -1330,13 +1536,12 @@ static void NRSur7dq2_eval_data_piece(
             x[1+j] = gsl_vector_get(chiA[j], node_index);
             x[4+j] = gsl_vector_get(chiB[j], node_index);
         }
-        gsl_vector_set(nodes, i, NRSur7dq2_eval_fit(data->fit_data[i], x));
+        NRSur7dq2_fit_x_powers(x_powers, x);
+        gsl_vector_set(nodes, i, NRSur7dq2_eval_fit(data->fit_data[i], x_powers));
     }
 
     // Evaluate the empirical interpolant
     gsl_blas_dgemv(CblasTrans, 1.0, data->empirical_interpolant_basis, nodes, 0.0, result);
-
-    gsl_vector_free(nodes);
 }
 
 /************************ Main Waveform Generation Routines ***********/
@@ -1433,6 +1638,10 @@ static void NRSur7dq2_core(
         }
     }
 
+    // Scratch space for this thread
+    NRSur7dq2Workspace *ws = NRSur7dq2_GetWorkspace();
+    if (!ws) XLAL_ERROR_VOID(XLAL_EFUNC, "Failed to get NRSur7dq2 workspace");
+
     // time arrays
     gsl_vector *t_ds = (&__lalsim_NRSur7dq2_data)->t_ds;
     gsl_vector *t_coorb = (&__lalsim_NRSur7dq2_data)->t_coorb;
@@ -1440,41 +1649,33 @@ static void NRSur7dq2_core(
     int n_coorb = t_coorb->size;
 
     // Get dynamics
-    double *dynamics_data = XLALCalloc(n_ds * 11, sizeof(double));
+    double *dynamics_data = ws->dynamics_data;
+    memset(dynamics_data, 0, n_ds * 11 * sizeof(double));
 
     int ret = NRSur7dq2_IntegrateDynamics(dynamics_data, q, chiA0, chiB0, omega_ref, phi_ref, q_ref);
     if(ret != XLAL_SUCCESS) XLAL_ERROR_VOID(XLAL_FAILURE, "Failed to integrate dynamics");
 
     // Put output into appropriate vectors
     int i, j;
-    gsl_vector *dynamics[11];
-    for (j=0; j<11; j++) {
-        dynamics[j] = gsl_vector_alloc(n_ds);
-    }
+    gsl_vector **dynamics = ws->dynamics;
     for (i=0; i<n_ds; i++) {
         for (j=0; j<11; j++) {
             gsl_vector_set(dynamics[j], i, dynamics_data[11*i + j]);
         }
     }
 
-    XLALFree(dynamics_data);
-
     // Interpolate onto the coorbital time grid
-    gsl_vector *quat_coorb[4], *chiA_coorb[3], *chiB_coorb[3];
-    quat_coorb[0] = spline_array_interp(t_coorb, t_ds, dynamics[0]);
-    quat_coorb[1] = spline_array_interp(t_coorb, t_ds, dynamics[1]);
-    quat_coorb[2] = spline_array_interp(t_coorb, t_ds, dynamics[2]);
-    quat_coorb[3] = spline_array_interp(t_coorb, t_ds, dynamics[3]);
-    gsl_vector *phi_coorb = spline_array_interp(t_coorb, t_ds, dynamics[4]);
-    chiA_coorb[0] = spline_array_interp(t_coorb, t_ds, dynamics[5]);
-    chiA_coorb[1] = spline_array_interp(t_coorb, t_ds, dynamics[6]);
-    chiA_coorb[2] = spline_array_interp(t_coorb, t_ds, dynamics[7]);
-    chiB_coorb[0] = spline_array_interp(t_coorb, t_ds, dynamics[8]);
-    chiB_coorb[1] = spline_array_interp(t_coorb, t_ds, dynamics[9]);
-    chiB_coorb[2] = spline_array_interp(t_coorb, t_ds, dynamics[10]);
-
-    for (j=0; j<11; j++) {
-        gsl_vector_free(dynamics[j]);
+    gsl_vector **quat_coorb = ws->quat_coorb;
+    gsl_vector **chiA_coorb = ws->chiA_coorb;
+    gsl_vector **chiB_coorb = ws->chiB_coorb;
+    gsl_vector *phi_coorb = ws->phi_coorb;
+    for (j=0; j<4; j++) {
+        spline_array_interp(quat_coorb[j], ws->spline, ws->acc, t_coorb, t_ds, dynamics[j]);
+    }
+    spline_array_interp(phi_coorb, ws->spline, ws->acc, t_coorb, t_ds, dynamics[4]);
+    for (j=0; j<3; j++) {
+        spline_array_interp(chiA_coorb[j], ws->spline, ws->acc, t_coorb, t_ds, dynamics[5+j]);
+        spline_array_interp(chiB_coorb[j], ws->spline, ws->acc, t_coorb, t_ds, dynamics[8+j]);
     }
 
     // Normalize spins after interpolation
@@ -1488,7 +1689,7 @@ static void NRSur7dq2_core(
     // Evaluate the coorbital waveform surrogate
     MultiModalWaveform *h_coorb = NULL;
     MultiModalWaveform_Init(&h_coorb, NRSUR7DQ2_LMAX, n_coorb);
-    gsl_vector *data_piece_eval = gsl_vector_alloc(n_coorb);
+    gsl_vector *data_piece_eval = ws->data_piece_eval;
     WaveformDataPiece *data_piece_data;
     int i0; // for indexing the (ell, m=0) mode, such that the (ell, m) mode is index (i0 + m).
     WaveformFixedEllModeData *ell_data;
@@ -1503,11 +1704,11 @@ static void NRSur7dq2_core(
         else {
             XLAL_PRINT_INFO("Generating (%i, 0) co-orbital mode", ell);
             data_piece_data = ell_data->m0_real_data;
-            NRSur7dq2_eval_data_piece(data_piece_eval, q, chiA_coorb, chiB_coorb, data_piece_data);
+            NRSur7dq2_eval_data_piece(data_piece_eval, ws->nodes, q, chiA_coorb, chiB_coorb, data_piece_data);
             gsl_vector_add(h_coorb->modes_real_part[i0], data_piece_eval);
 
             data_piece_data = ell_data->m0_imag_data;
-            NRSur7dq2_eval_data_piece(data_piece_eval, q, chiA_coorb, chiB_coorb, data_piece_data);
+            NRSur7dq2_eval_data_piece(data_piece_eval, ws->nodes, q, chiA_coorb, chiB_coorb, data_piece_data);
             gsl_vector_add(h_coorb->modes_imag_part[i0], data_piece_eval);
         }
 
@@ -1525,25 +1726,25 @@ static void NRSur7dq2_core(
 
             // Re[X_plus] gets added to both Re[h^{ell, m}] and Re[h^{ell, -m}]
             data_piece_data = ell_data->X_real_plus_data[m-1];
-            NRSur7dq2_eval_data_piece(data_piece_eval, q, chiA_coorb, chiB_coorb, data_piece_data);
+            NRSur7dq2_eval_data_piece(data_piece_eval, ws->nodes, q, chiA_coorb, chiB_coorb, data_piece_data);
             gsl_vector_add(h_coorb->modes_real_part[i0+m], data_piece_eval);
             gsl_vector_add(h_coorb->modes_real_part[i0-m], data_piece_eval);
 
             // Re[X_minus] gets added to Re[h^{ell, m}] and subtracted from Re[h^{ell, -m}]
             data_piece_data = ell_data->X_real_minus_data[m-1];
-            NRSur7dq2_eval_data_piece(data_piece_eval, q, chiA_coorb, chiB_coorb, data_piece_data);
+            NRSur7dq2_eval_data_piece(data_piece_eval, ws->nodes, q, chiA_coorb, chiB_coorb, data_piece_data);
             gsl_vector_add(h_coorb->modes_real_part[i0+m], data_piece_eval);
             gsl_vector_sub(h_coorb->modes_real_part[i0-m], data_piece_eval);
 
             // Im[X_plus] gets added to Re[h^{ell, m}] and subtracted from Re[h^{ell, -m}]
             data_piece_data = ell_data->X_imag_plus_data[m-1];
-            NRSur7dq2_eval_data_piece(data_piece_eval, q, chiA_coorb, chiB_coorb, data_piece_data);
+            NRSur7dq2_eval_data_piece(data_piece_eval, ws->nodes, q, chiA_coorb, chiB_coorb, data_piece_data);
             gsl_vector_add(h_coorb->modes_imag_part[i0+m], data_piece_eval);
             gsl_vector_sub(h_coorb->modes_imag_part[i0-m], data_piece_eval);
 
             // Im[X_minus] gets added to both Re[h^{ell, m}] and Re[h^{ell, -m}]
             data_piece_data = ell_data->X_imag_minus_data[m-1];
-            NRSur7dq2_eval_data_piece(data_piece_eval, q, chiA_coorb, chiB_coorb, data_piece_data);
+            NRSur7dq2_eval_data_piece(data_piece_eval, ws->nodes, q, chiA_coorb, chiB_coorb, data_piece_data);
             gsl_vector_add(h_coorb->modes_imag_part[i0+m], data_piece_eval);
             gsl_vector_add(h_coorb->modes_imag_part[i0-m], data_piece_eval);
         }
@@ -1555,14 +1756,6 @@ static void NRSur7dq2_core(
 
     // Cleanup
     MultiModalWaveform_Destroy(h_coorb);
-    for (i=0; i<3; i++) {
-        gsl_vector_free(chiA_coorb[i]);
-        gsl_vector_free(chiB_coorb[i]);
-        gsl_vector_free(quat_coorb[i]);
-    }
-    gsl_vector_free(quat_coorb[3]);
-    gsl_vector_free(phi_coorb);
-    gsl_vector_free(data_piece_eval);
 }
 
 /**
@@ -1815,6 +2008,85 @@ int XLALSimInspiralNRSur7dq2Polarizations(
     return XLAL_SUCCESS;
 }
 
+/**
+ * Evaluates XLALSimInspiralNRSur7dq2Polarizations() for a batch of n parameter points,
+ * sharing deltaT, fMin, fRef and ModeArray. Entry i of each parameter array gives the
+ * parameters of point i, and hplus[i] and hcross[i] receive its polarizations.
+ * The points are distributed over OpenMP threads (see XLALSimInspiralSetOpenMPNumThreads()),
+ * each of which reuses its own workspace. On failure, the polarizations that were
+ * generated are destroyed and all outputs are set to NULL.
+ */
+int XLALSimInspiralNRSur7dq2PolarizationsBatch(
+        REAL8TimeSeries **hplus,        /**< OUTPUT array of n h_+ vectors */
+        REAL8TimeSeries **hcross,       /**< OUTPUT array of n h_x vectors */
+        UINT4 n,                        /**< number of parameter points */
+        const REAL8 *phiRef,            /**< orbital phases at reference pt. */
+        const REAL8 *inclination,       /**< inclination angles */
+        REAL8 deltaT,                   /**< sampling interval (s) */
+        const REAL8 *m1,                /**< masses of companion 1 (kg) */
+        const REAL8 *m2,                /**< masses of companion 2 (kg) */
+        const REAL8 *distance,          /**< distances of source (m) */
+        REAL8 fMin,                     /**< start GW frequency (Hz) */
+        REAL8 fRef,                     /**< reference GW frequency (Hz) */
+        const REAL8 *s1x,               /**< reference values of S1x */
+        const REAL8 *s1y,               /**< reference values of S1y */
+        const REAL8 *s1z,               /**< reference values of S1z */
+        const REAL8 *s2x,               /**< reference values of S2x */
+        const REAL8 *s2y,               /**< reference values of S2y */
+        const REAL8 *s2z,               /**< reference values of S2z */
+        LALValue* ModeArray             /**< Container for the ell and m co-orbital modes to generate. To generate all available modes pass NULL */
+) {
+    int status = XLAL_SUCCESS;
+    UINT4 i;
+
+    XLAL_CHECK(hplus && hcross, XLAL_EFAULT);
+    XLAL_CHECK(n == 0 || (phiRef && inclination && m1 && m2 && distance
+                          && s1x && s1y && s1z && s2x && s2y && s2z), XLAL_EFAULT);
+    for (i=0; i<n; i++) {
+        hplus[i] = NULL;
+        hcross[i] = NULL;
+    }
+
+    // Load the data before starting any threads
+#ifdef LAL_PTHREAD_LOCK
+    (void) pthread_once(&NRSur7dq2_is_initialized, NRSur7dq2_Init_LALDATA);
+#else
+    NRSur7dq2_Init_LALDATA();
+#endif
+    XLAL_CHECK(NRSur7dq2_IsSetup(), XLAL_EFAILED, "NRSur7dq2 data could not be loaded");
+
+    // Each waveform is far more work than a frequency bin, so ignore the threshold
+    // used for frequency-domain loops and only honour the number of threads.
+    // Without LAL_PTHREAD_LOCK the workspace is shared, so evaluate in series.
+#if defined(_OPENMP) && defined(LAL_PTHREAD_LOCK)
+    int nthreads = XLALSimInspiralGetOpenMPNumThreads();
+    if (nthreads <= 0) nthreads = omp_get_max_threads();
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+#endif
+    for (i=0; i<n; i++) {
+        int status_in_for = XLALSimInspiralNRSur7dq2Polarizations(&hplus[i], &hcross[i],
+                phiRef[i], inclination[i], deltaT, m1[i], m2[i], distance[i], fMin, fRef,
+                s1x[i], s1y[i], s1z[i], s2x[i], s2y[i], s2z[i], ModeArray);
+        if (XLAL_SUCCESS != status_in_for) {
+            XLALPrintError("XLALSimInspiralNRSur7dq2Polarizations failed for point %u, status_in_for=%d", i, status_in_for);
+            status = status_in_for;
+            #pragma omp flush(status)
+        }
+    }
+
+    if (status != XLAL_SUCCESS) {
+        for (i=0; i<n; i++) {
+            XLALDestroyREAL8TimeSeries(hplus[i]);
+            XLALDestroyREAL8TimeSeries(hcross[i]);
+            hplus[i] = NULL;
+            hcross[i] = NULL;
+        }
+        XLAL_ERROR(XLAL_EFUNC, "Failed to evaluate NRSur7dq2 for a batch of %u points", n);
+    }
+
+    return XLAL_SUCCESS;
+}
+
 /**
  * This function evaluates the NRSur7dq2 surrogate model and returns the inertial frame modes
  * in the form of a SphHarmTimeSeries. The system is initialized at a time where the orbital
@@ -55,6 +55,8 @@ typedef struct tagFitData {
                         giving the polynomial order in f(q), chiA components, and chiB components. */
     gsl_vector *coefs;                      /**< coefficient vector of length n_coefs */
     int n_coefs;                            /**< Number of coefficients in the fit */
+    unsigned char *x_power_index;           /**< (n_coefs x 7) indices into the powers of the fit inputs,
+                                                 see NRSur7dq2_fit_x_powers; built from basisFunctionOrders */
 } FitData;
 
 /**
@@ -70,6 +72,18 @@ typedef struct tagVectorFitData {
     int vec_dim;                            /**< Dimension of the vector */
 } VectorFitData;
 
+/**
+ * All fits of a single dynamics node packed together, so that they are evaluated in a
+ * single pass over the coefficients with one set of input powers.
+ * The 9 outputs are [omega, Omega_coorb_x, Omega_coorb_y, chiA_dot (3), chiB_dot (3)].
+ */
+typedef struct tagDynamicsNodeFusedFit {
+    int n_coefs;                    /**< Total number of coefficients of all fits */
+    double *coefs;                  /**< The coefficients of each fit in turn */
+    unsigned char *out_index;       /**< The output each coefficient contributes to */
+    unsigned char *x_power_index;   /**< (n_coefs x 7) indices into the powers of the fit inputs */
+} DynamicsNodeFusedFit;
+
 /**
  * NRSur7dq2 data for a single dynamics node
  */
@@ -81,6 +95,7 @@ typedef struct tagDynamicsNodeFitData {
                                          time derivative of chiA taken in the coprecessing frame */
     VectorFitData *chiB_dot_data;   /**< A 3d vector fit for the coorbital components of the
                                          time derivative of chiB taken in the coprecessing frame */
+    DynamicsNodeFusedFit *fused;    /**< All of the above, packed for evaluation */
 } DynamicsNodeFitData;
 
 /**
@@ -125,26 +140,55 @@ typedef struct tagNRSur7dq2Data {
     DynamicsNodeFitData **ds_node_data; /** A DynamicsNodeFitData for each time in t_ds.*/
     DynamicsNodeFitData **ds_half_node_data; /** A DynamicsNodeFitData for each time in t_ds_half_times. */
     WaveformFixedEllModeData **coorbital_mode_data; /** One for each 2 <= ell <= LMax */
+    int max_n_nodes; /**< Largest number of empirical nodes of any waveform data piece */
 } NRSur7dq2Data;
 
+/**
+ * Scratch space for a single evaluation of NRSur7dq2, sized from the surrogate data.
+ * Each thread keeps one and reuses it across calls, so that evaluating the model does
+ * not allocate anything besides its output.
+ */
+typedef struct tagNRSur7dq2Workspace {
+    double *dynamics_data;      /**< ODE solution at the dynamics nodes, (n_ds x 11) */
+    gsl_vector *dynamics[11];   /**< The ODE solution, one vector per component */
+    gsl_vector *quat_coorb[4];  /**< Coprecessing frame quaternion on t_coorb */
+    gsl_vector *phi_coorb;      /**< Orbital phase on t_coorb */
+    gsl_vector *chiA_coorb[3];  /**< Coorbital components of chiA on t_coorb */
+    gsl_vector *chiB_coorb[3];  /**< Coorbital components of chiB on t_coorb */
+    gsl_vector *nodes;          /**< Fit evaluations at the empirical nodes of a data piece */
+    gsl_vector *data_piece_eval;/**< A waveform data piece evaluated on t_coorb */
+    gsl_spline *spline;         /**< Cubic spline on t_ds */
+    gsl_interp_accel *acc;      /**< Accelerator for spline */
+} NRSur7dq2Workspace;
+
 
 /***********************************************************************************/
 /****************************** Function declarations*******************************/
 /***********************************************************************************/
 static void NRSur7dq2_Init_LALDATA(void);
 static int NRSur7dq2_Init(NRSur7dq2Data *data, LALH5File *file);
-static void NRSur7dq2_LoadDynamicsNode(DynamicsNodeFitData **ds_node_data, LALH5File *sub, int i);
-static void NRSur7dq2_LoadCoorbitalEllModes(WaveformFixedEllModeData **coorbital_mode_data, LALH5File *file, int i);
-static void NRSur7dq2_LoadWaveformDataPiece(LALH5File *sub, WaveformDataPiece **data, bool invert_sign);
+static int NRSur7dq2_LoadDynamicsNode(DynamicsNodeFitData **ds_node_data, LALH5File *sub, int i);
+static int NRSur7dq2_LoadCoorbitalEllModes(WaveformFixedEllModeData **coorbital_mode_data, LALH5File *file, int i);
+static int NRSur7dq2_LoadWaveformDataPiece(LALH5File *sub, WaveformDataPiece **data, bool invert_sign);
 static bool NRSur7dq2_IsSetup(void);
-static double ipow(double base, int exponent); // integer powers
+static int NRSur7dq2_FlattenFitOrders(unsigned char *x_power_index, gsl_matrix_long *basisFunctionOrders);
+static DynamicsNodeFusedFit *NRSur7dq2_FuseDynamicsNode(DynamicsNodeFitData *ds_node);
 
-static double NRSur7dq2_eval_fit(FitData *data, double *x);
+static NRSur7dq2Workspace *NRSur7dq2Workspace_Create(void);
+static void NRSur7dq2Workspace_Destroy(void *ws);
+static NRSur7dq2Workspace *NRSur7dq2_GetWorkspace(void);
 
-static void NRSur7dq2_eval_vector_fit(
-    double *res, // Result
-    VectorFitData *data, // Data for fit
-    double *x // size 7, giving mass ratio q, and dimensionless spin components
+static void NRSur7dq2_fit_x_powers(
+    double *x_powers, // Result, length 22
+    const double *x   // size 7, giving mass ratio q, and dimensionless spin components
+);
+
+static double NRSur7dq2_eval_fit(FitData *data, const double *x_powers);
+
+static void NRSur7dq2_eval_dynamics_node(
+    double *res,                        // Result, length 9
+    const DynamicsNodeFusedFit *fit,    // Fused fits of the dynamics node
+    const double *x_powers              // Powers of the fit inputs
 );
 
 static void NRSur7dq2_normalize_y(
@@ -180,11 +224,18 @@ static void NRSur7dq2_assemble_dydt(
 
 
 static double cubic_interp(double xout, double *x, double *y);
-static gsl_vector *spline_array_interp(gsl_vector *xout, gsl_vector *x, gsl_vector *y);
+static void spline_array_interp(gsl_vector *res, gsl_spline *spline, gsl_interp_accel *acc, gsl_vector *xout, gsl_vector *x, gsl_vector *y);
 
 static double NRSur7dq2_get_omega(size_t node_index, double q, double *y0);
 static double NRSur7dq2_get_t_ref(double omega_ref, double q, double *chiA0, double *chiB0, double *q_ref, double phi_ref);
 
+static void NRSur7dq2_get_time_deriv_from_powers(
+    double *dydt,               // Output: dy/dt at the dynamics node. Must have space for 11 entries.
+    DynamicsNodeFitData *ds_node, // Fit data of the dynamics node
+    const double *x_powers,     // Powers of the fit inputs computed from y
+    double *y                   // Current ODE state
+);
+
 static void NRSur7dq2_get_time_deriv_from_index(
     double *dydt,       // Output: dy/dt evaluated at the ODE time node with index i0. Must have space for 11 entries.
     int i0,             // Time node index. i0=-1, -2, and -3 are used for time nodes 1/2, 3/2, and 5/2 respectively.
@@ -262,6 +313,7 @@ static int NRSur7dq2_IntegrateDynamics(
 
 static void NRSur7dq2_eval_data_piece(
     gsl_vector *result, // Output: Should have already been assigned space
+    gsl_vector *nodes,  // Workspace: space for at least data->n_nodes entries
     double q,           // Mass ratio
     gsl_vector **chiA,  // 3 gsl_vector *s, one for each (coorbital) component
     gsl_vector **chiB,  // similar to chiA
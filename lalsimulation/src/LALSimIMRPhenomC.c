@@ -354,7 +354,7 @@ static int IMRPhenomCGenerateFD(
   REAL8 *phis = XLALMalloc(L*sizeof(REAL8));
 
   /* now generate the waveform */
-  #pragma omp parallel for
+  #pragma omp parallel for num_threads(XLALSimInspiralOpenMPThreadsForLength(ind_max - ind_min))
   for (size_t i = ind_min; i < ind_max; i++)
   {
 
@@ -385,26 +385,51 @@ static int IMRPhenomDGenerateFD(
   // factor of 2 b/c phi0 is orbital phase
   const REAL8 phi_precalc = 2.*phi0 + phifRef;
 
-  int status_in_for = XLAL_SUCCESS;
-  /* Now generate the waveform */
-  #pragma omp parallel for
-  for (UINT4 i=0; i<freqs->length; i++) { // loop over frequency points in sequence
-    double Mf = M_sec * freqs->data[i];
-    int j = i + offset; // shift index for frequency series if needed
+  /*
+    The waveform is generated in blocks of sorted frequencies, which are
+    evaluated by the vectorised IMRPhenDAmpPhaseBlock(). A uniform grid is
+    always sorted; an unsorted frequency sequence is evaluated one point at a
+    time.
+  */
+  size_t block_length = IMRPHENOMD_BLOCK_LENGTH;
+  for (size_t i=1; i<freqs->length; i++)
+    if (freqs->data[i] < freqs->data[i-1]) {
+      block_length = 1;
+      break;
+    }
+  const size_t nblocks = (freqs->length + block_length - 1) / block_length;
 
-    UsefulPowers powers_of_f;
-    status_in_for = init_useful_powers(&powers_of_f, Mf);
+  /*
+    We can't call XLAL_ERROR() directly with OpenMP on.
+    Keep track of the return code of each thread and flush it to the shared
+    status if something went wrong.
+  */
+  /* Now generate the waveform */
+  #pragma omp parallel for num_threads(XLALSimInspiralOpenMPThreadsForLength(freqs->length))
+  for (size_t b=0; b<nblocks; b++) { // loop over blocks of frequency points in sequence
+    const size_t iStart = b * block_length;
+    const size_t n = (freqs->length - iStart < block_length) ? freqs->length - iStart : block_length;
+    COMPLEX16 *h = (*htilde)->data->data + iStart + offset; // shift index for frequency series if needed
+    double Mf[IMRPHENOMD_BLOCK_LENGTH];
+    double amp[IMRPHENOMD_BLOCK_LENGTH];
+    double phi[IMRPHENOMD_BLOCK_LENGTH];
+
+    for (size_t i=0; i<n; i++)
+      Mf[i] = M_sec * freqs->data[iStart + i];
+
+    int status_in_for = IMRPhenDAmpPhaseBlock(amp, phi, Mf, n, pAmp, &amp_prefactors, pPhi, &phi_prefactors);
     if (XLAL_SUCCESS != status_in_for)
     {
-      XLALPrintError("init_useful_powers failed for Mf, status_in_for=%d", status_in_for);
+      XLALPrintError("IMRPhenDAmpPhaseBlock failed, status_in_for=%d", status_in_for);
       status = status_in_for;
+      #pragma omp flush(status)
     }
     else {
-      REAL8 amp = IMRPhenDAmplitude(Mf, pAmp, &powers_of_f, &amp_prefactors);
-      REAL8 phi = IMRPhenDPhase(Mf, pPhi, pn, &powers_of_f, &phi_prefactors);
-
-      phi -= t0*(Mf-MfRef) + phi_precalc;
-      ((*htilde)->data->data)[j] = amp0 * amp * cexp(-I * phi);
+      for (size_t i=0; i<n; i++) {
+        const REAL8 A = amp0 * amp[i];
+        const REAL8 phase = phi[i] - (t0*(Mf[i]-MfRef) + phi_precalc);
+        h[i] = crect(A * cos(phase), -A * sin(phase)); // amp0 * amp * cexp(-I * phi)
+      }
     }
   }
 
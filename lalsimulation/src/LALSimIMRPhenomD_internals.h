@@ -381,7 +381,7 @@ static void ComputeDeltasFromCollocation(IMRPhenomDAmplitudeCoefficients* p);
 ///////////////////////////// Amplitude: glueing function ////////////////////////////
 
 static IMRPhenomDAmplitudeCoefficients* ComputeIMRPhenomDAmplitudeCoefficients(double eta, double chi1, double chi2, double finspin);
-static double IMRPhenDAmplitude(double f, IMRPhenomDAmplitudeCoefficients *p, UsefulPowers *powers_of_f, AmpInsPrefactors * prefactors);
+UNUSED static double IMRPhenDAmplitude(double f, IMRPhenomDAmplitudeCoefficients *p, UsefulPowers *powers_of_f, AmpInsPrefactors * prefactors);
 
 /********************************* Phase functions *********************************/
 
@@ -417,6 +417,17 @@ static double DPhiInsAnsatzInt(double ff, IMRPhenomDPhaseCoefficients *p, PNPhas
 
 static IMRPhenomDPhaseCoefficients* ComputeIMRPhenomDPhaseCoefficients(double eta, double chi1, double chi2, double finspin, LALDict *extraParams);
 static void ComputeIMRPhenDPhaseConnectionCoefficients(IMRPhenomDPhaseCoefficients *p, PNPhasingSeries *pn, PhiInsPrefactors * prefactors);
-static double IMRPhenDPhase(double f, IMRPhenomDPhaseCoefficients *p, PNPhasingSeries *pn, UsefulPowers *powers_of_f, PhiInsPrefactors * prefactors);
+UNUSED static double IMRPhenDPhase(double f, IMRPhenomDPhaseCoefficients *p, PNPhasingSeries *pn, UsefulPowers *powers_of_f, PhiInsPrefactors * prefactors);
+
+////////////////////////// Block-wise amplitude and phase ///////////////////////////
+
+/**
+ * Maximum number of frequencies evaluated together by IMRPhenDAmpPhaseBlock();
+ * sized so that the scratch arrays stay in L1 cache.
+ */
+#define IMRPHENOMD_BLOCK_LENGTH 128
+
+static size_t StepFunc_index(const double *Mf, size_t n, const double fJoin);
+static int IMRPhenDAmpPhaseBlock(double *amp, double *phi, const double *Mf, const size_t n, const IMRPhenomDAmplitudeCoefficients *pAmp, const AmpInsPrefactors *amp_prefactors, const IMRPhenomDPhaseCoefficients *pPhi, const PhiInsPrefactors *phi_prefactors);
 
 #endif	// of #ifndef _LALSIM_IMR_PHENOMD_INTERNALS_H
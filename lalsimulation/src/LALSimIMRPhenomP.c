@@ -890,13 +890,19 @@ static int PhenomPCore(
     Keep track of return codes for each thread and in addition use flush to get out of
     the parallel for loop as soon as possible if something went wrong in any thread.
   */
-  #pragma omp parallel for
-  for (UINT4 i=0; i<L_fCut; i++) { // loop over frequency points in sequence
-    COMPLEX16 hp_val = 0.0;
-    COMPLEX16 hc_val = 0.0;
-    REAL8 phasing = 0;
-    double f = freqs->data[i];
-    int j = i + offset; // shift index for frequency series if needed
+  /*
+    The frequencies are strictly increasing, so for IMRPhenomPv2 the underlying
+    IMRPhenomD amplitude and phase are evaluated a block at a time by the
+    vectorised IMRPhenDAmpPhaseBlock() before twisting up each frequency.
+  */
+  const size_t nblocks = (L_fCut + IMRPHENOMD_BLOCK_LENGTH - 1) / IMRPHENOMD_BLOCK_LENGTH;
+  #pragma omp parallel for num_threads(XLALSimInspiralOpenMPThreadsForLength(L_fCut))
+  for (size_t b=0; b<nblocks; b++) { // loop over blocks of frequency points in sequence
+    const size_t iStart = b * IMRPHENOMD_BLOCK_LENGTH;
+    const size_t nb = (L_fCut - iStart < IMRPHENOMD_BLOCK_LENGTH) ? L_fCut - iStart : IMRPHENOMD_BLOCK_LENGTH;
+    double Mf[IMRPHENOMD_BLOCK_LENGTH];
+    double aPhenomD[IMRPHENOMD_BLOCK_LENGTH] = {0};
+    double phPhenomD[IMRPHENOMD_BLOCK_LENGTH] = {0};
 
     int per_thread_errcode;
 
@@ -904,21 +910,41 @@ static int PhenomPCore(
     if (errcode != XLAL_SUCCESS)
       goto skip;
 
-    /* Generate the waveform */
-    per_thread_errcode = PhenomPCoreOneFrequency(f, eta, chi1_l, chi2_l, chip, distance, M, phic,
-                              pAmp, pPhi, PCparams, pn, &angcoeffs, &Y2m,
-                              alphaNNLOoffset - alpha0, epsilonNNLOoffset,
-                              &hp_val, &hc_val, &phasing, IMRPhenomP_version, &amp_prefactors, &phi_prefactors);
-
-    if (per_thread_errcode != XLAL_SUCCESS) {
-      errcode = per_thread_errcode;
-      #pragma omp flush(errcode)
+    if (IMRPhenomP_version == IMRPhenomPv2_V) {
+      for (size_t k=0; k<nb; k++)
+        Mf[k] = freqs->data[iStart + k] * LAL_MTSUN_SI * M; /* as in PhenomPCoreOneFrequency() */
+      per_thread_errcode = IMRPhenDAmpPhaseBlock(aPhenomD, phPhenomD, Mf, nb, pAmp, &amp_prefactors, pPhi, &phi_prefactors);
+      if (per_thread_errcode != XLAL_SUCCESS) {
+        errcode = per_thread_errcode;
+        #pragma omp flush(errcode)
+        goto skip;
+      }
     }
 
-    ((*hptilde)->data->data)[j] = hp_val;
-    ((*hctilde)->data->data)[j] = hc_val;
+    for (size_t k=0; k<nb; k++) {
+      COMPLEX16 hp_val = 0.0;
+      COMPLEX16 hc_val = 0.0;
+      REAL8 phasing = 0;
+      size_t i = iStart + k;
+      double f = freqs->data[i];
+      size_t j = i + offset; // shift index for frequency series if needed
+
+      /* Generate the waveform */
+      per_thread_errcode = PhenomPCoreOneFrequency(f, eta, chi1_l, chi2_l, chip, distance, M, phic,
+                                aPhenomD[k], phPhenomD[k], PCparams, &angcoeffs, &Y2m,
+                                alphaNNLOoffset - alpha0, epsilonNNLOoffset,
+                                &hp_val, &hc_val, &phasing, IMRPhenomP_version);
+
+      if (per_thread_errcode != XLAL_SUCCESS) {
+        errcode = per_thread_errcode;
+        #pragma omp flush(errcode)
+      }
 
-    phis[i] = phasing;
+      ((*hptilde)->data->data)[j] = hp_val;
+      ((*hctilde)->data->data)[j] = hc_val;
+
+      phis[i] = phasing;
+    }
 
     skip: /* this statement intentionally left blank */;
   }
@@ -1060,10 +1086,9 @@ static int PhenomPCoreOneFrequency(
   const REAL8 distance,                       /**< Distance of source (m) */
   const REAL8 M,                              /**< Total mass (Solar masses) */
   const REAL8 phic,                           /**< Orbital phase at the peak of the underlying non precessing model (rad) */
-  IMRPhenomDAmplitudeCoefficients *pAmp,      /**< Internal IMRPhenomD amplitude coefficients */
-  IMRPhenomDPhaseCoefficients *pPhi,          /**< Internal IMRPhenomD phase coefficients */
+  const REAL8 aPhenomD,                       /**< IMRPhenomD amplitude at this frequency (IMRPhenomPv2 only), see IMRPhenDAmpPhaseBlock() */
+  const REAL8 phPhenomD,                      /**< IMRPhenomD phase at this frequency (IMRPhenomPv2 only), see IMRPhenDAmpPhaseBlock() */
   BBHPhenomCParams *PCparams,                 /**< Internal PhenomC parameters */
-  PNPhasingSeries *PNparams,                  /**< PN inspiral phase coefficients */
   NNLOanglecoeffs *angcoeffs,                 /**< Struct with PN coeffs for the NNLO angles */
   SpinWeightedSphericalHarmonic_l2 *Y2m,      /**< Struct of l=2 spherical harmonics of spin weight -2 */
   const REAL8 alphaoffset,                    /**< f_ref dependent offset for alpha angle (azimuthal precession angle) */
@@ -1071,9 +1096,7 @@ static int PhenomPCoreOneFrequency(
   COMPLEX16 *hp,                              /**< [out] plus polarization \f$\tilde h_+\f$ */
   COMPLEX16 *hc,                              /**< [out] cross polarization \f$\tilde h_x\f$ */
   REAL8 *phasing,                             /**< [out] overall phasing */
-  IMRPhenomP_version_type IMRPhenomP_version, /**< IMRPhenomP(v1) uses IMRPhenomC, IMRPhenomPv2 uses IMRPhenomD */
-  AmpInsPrefactors *amp_prefactors,           /**< pre-calculated (cached for saving runtime) coefficients for amplitude. See LALSimIMRPhenomD_internals.c*/
-  PhiInsPrefactors *phi_prefactors            /**< pre-calculated (cached for saving runtime) coefficients for phase. See LALSimIMRPhenomD_internals.*/)
+  IMRPhenomP_version_type IMRPhenomP_version /**< IMRPhenomP(v1) uses IMRPhenomC, IMRPhenomPv2 uses IMRPhenomD */)
 {
   XLAL_CHECK(angcoeffs != NULL, XLAL_EFAULT);
   XLAL_CHECK(hp != NULL, XLAL_EFAULT);
@@ -1086,7 +1109,6 @@ static int PhenomPCoreOneFrequency(
   REAL8 aPhenom = 0.0;
   REAL8 phPhenom = 0.0;
   int errcode = XLAL_SUCCESS;
-  UsefulPowers powers_of_f;
 
   const REAL8 q = (1.0 + sqrt(1.0 - 4.0*eta) - 2.0*eta)/(2.0*eta);
   const REAL8 m1 = 1.0/(1.0+q);       /* Mass of the smaller BH for unit total mass M=1. */
@@ -1104,15 +1126,8 @@ static int PhenomPCoreOneFrequency(
       SL = chi_eff*m2;        /* Dimensionfull aligned spin of the largest BH. SL = m2^2 chil = m2*M*chi_eff */
       break;
     case IMRPhenomPv2_V:
-      XLAL_CHECK(pAmp != NULL, XLAL_EFAULT);
-      XLAL_CHECK(pPhi != NULL, XLAL_EFAULT);
-      XLAL_CHECK(PNparams != NULL, XLAL_EFAULT);
-      XLAL_CHECK(amp_prefactors != NULL, XLAL_EFAULT);
-      XLAL_CHECK(phi_prefactors != NULL, XLAL_EFAULT);
-      errcode = init_useful_powers(&powers_of_f, f);
-      XLAL_CHECK(errcode == XLAL_SUCCESS, errcode, "init_useful_powers failed for f");
-      aPhenom = IMRPhenDAmplitude(f, pAmp, &powers_of_f, amp_prefactors);
-      phPhenom = IMRPhenDPhase(f, pPhi, PNparams, &powers_of_f, phi_prefactors);
+      aPhenom = aPhenomD;
+      phPhenom = phPhenomD;
       SL = chi1_l*m1*m1 + chi2_l*m2*m2;        /* Dimensionfull aligned spin. */
       break;
     default:
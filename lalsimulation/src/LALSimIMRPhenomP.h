@@ -111,10 +111,9 @@ static int PhenomPCoreOneFrequency(
   const REAL8 distance,                   /**< Distance of source (m) */
   const REAL8 M,                          /**< Total mass (Solar masses) */
   const REAL8 phic,                       /**< Orbital phase at the peak of the underlying non precessing model (rad) */
-  IMRPhenomDAmplitudeCoefficients *pAmp,  /**< Internal IMRPhenomD amplitude coefficients */
-  IMRPhenomDPhaseCoefficients *pPhi,      /**< Internal IMRPhenomD phase coefficients */
+  const REAL8 aPhenomD,                   /**< IMRPhenomD amplitude at this frequency (IMRPhenomPv2 only) */
+  const REAL8 phPhenomD,                  /**< IMRPhenomD phase at this frequency (IMRPhenomPv2 only) */
   BBHPhenomCParams *PCparams,             /**< Internal PhenomC parameters */
-  PNPhasingSeries *PNparams,              /**< PN inspiral phase coefficients */
   NNLOanglecoeffs *angcoeffs,             /**< Struct with PN coeffs for the NNLO angles */
   SpinWeightedSphericalHarmonic_l2 *Y2m,  /**< Struct of l=2 spherical harmonics of spin weight -2 */
   const REAL8 alphaoffset,                /**< f_ref dependent offset for alpha angle (azimuthal precession angle) */
@@ -122,9 +121,7 @@ static int PhenomPCoreOneFrequency(
   COMPLEX16 *hp,                          /**< Output: tilde h_+ */
   COMPLEX16 *hc,                          /**< Output: tilde h_+ */
   REAL8 *phasing,                         /**< Output: overall phasing */
-  const UINT4 IMRPhenomP_version,         /**< Version number: 1 uses IMRPhenomC, 2 uses IMRPhenomD */
-  AmpInsPrefactors *amp_prefactors,       /**< pre-calculated (cached for saving runtime) coefficients for amplitude. See LALSimIMRPhenomD_internals.c*/
-  PhiInsPrefactors *phi_prefactors        /**< pre-calculated (cached for saving runtime) coefficients for phase. See LALSimIMRPhenomD_internals.*/
+  const UINT4 IMRPhenomP_version          /**< Version number: 1 uses IMRPhenomC, 2 uses IMRPhenomD */
 );
 
 /* Simple 2PN version of L, without any spin terms expressed as a function of v */
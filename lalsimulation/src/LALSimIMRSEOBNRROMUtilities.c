@@ -30,7 +30,8 @@
  *
  * Here I collect common auxiliary functions pertaining to reading
  * data stored in gsl binary vectors and matrices, HDF5 files using the LAL interface,
- * parameter space interpolation with B-splines, fitting to a cubic,
+ * parameter space interpolation with B-splines (via gsl or the reentrant
+ * tensor product evaluator TPSpline3d_Evaluate()), fitting to a cubic,
  * a custom gsl error handler and adjustment of nearby parameter values.
  */
 
@@ -44,6 +45,8 @@
 #include <lal/H5FileIO.h>
 #endif
 
+#include "LALSimROMDataStore.h"
+
 UNUSED static int read_vector(const char dir[], const char fname[], gsl_vector *v);
 UNUSED static int read_matrix(const char dir[], const char fname[], gsl_matrix *m);
 
@@ -53,6 +56,8 @@ UNUSED static int ReadHDF5RealVectorDataset(LALH5File *file, const char *name, g
 UNUSED static int ReadHDF5RealMatrixDataset(LALH5File *file, const char *name, gsl_matrix **data);
 UNUSED static int ReadHDF5LongVectorDataset(LALH5File *file, const char *name, gsl_vector_long **data);
 UNUSED static int ReadHDF5LongMatrixDataset(LALH5File *file, const char *name, gsl_matrix_long **data);
+UNUSED static int ReadROMRealVectorDataset(const ROMDataStoreGroup *store, LALH5File *file, const char *name, gsl_vector **data);
+UNUSED static int ReadROMRealMatrixDataset(const ROMDataStoreGroup *store, LALH5File *file, const char *name, gsl_matrix **data);
 UNUSED static void PrintInfoStringAttribute(LALH5File *file, const char attribute[]);
 UNUSED static int ROM_check_version_number(LALH5File *file, 	INT4 version_major_in, INT4 version_minor_in, INT4 version_micro_in);
 #endif
@@ -79,6 +84,43 @@ UNUSED static REAL8 Interpolate_Coefficent_Matrix(
   gsl_bspline_workspace *bwy
 );
 
+// Nonzero basis functions of a cubic tensor product B-spline at one point
+typedef struct tagTPSpline3dPoint {
+  size_t offset[16];  // flattened index of coefficient (isx+i, isy+j, isz) at offset[4*i + j]
+  double w[64];       // Bx_i * By_j * Bz_k at w[(4*i + j)*4 + k]
+} TPSpline3dPoint;
+
+UNUSED static int CubicBSplineNonzeroBasis(
+  double B[4],
+  size_t *istart,
+  const double x,
+  const double *breakpts,
+  const size_t nbreak
+);
+
+UNUSED static int TPSpline3dPoint_Init(
+  TPSpline3dPoint *pt,
+  const REAL8 x,
+  const REAL8 y,
+  const REAL8 z,
+  const double *xvec,
+  const double *yvec,
+  const double *zvec,
+  const int ncx,
+  const int ncy,
+  const int ncz
+);
+
+UNUSED static void TPSpline3d_Evaluate(
+  double *out,
+  const size_t ldout,
+  const TPSpline3dPoint *pts,
+  const size_t npts,
+  const double *cvec,
+  const int nmodes,
+  const size_t N
+);
+
 UNUSED static gsl_vector *Fit_cubic(const gsl_vector *xi, const gsl_vector *yi);
 
 UNUSED static bool approximately_equal(REAL8 x, REAL8 y, REAL8 epsilon);
@@ -364,6 +406,20 @@ static int ReadHDF5LongMatrixDataset(LALH5File *file, const char *name, gsl_matr
 	return 0;
 }
 
+// Read a REAL8 vector from the shared ROM data store if store is non-NULL, otherwise from file
+static int ReadROMRealVectorDataset(const ROMDataStoreGroup *store, LALH5File *file, const char *name, gsl_vector **data) {
+  if (store)
+    return ROMDataStore_GetREAL8Vector(data, store, name);
+  return ReadHDF5RealVectorDataset(file, name, data);
+}
+
+// Read a REAL8 matrix from the shared ROM data store if store is non-NULL, otherwise from file
+static int ReadROMRealMatrixDataset(const ROMDataStoreGroup *store, LALH5File *file, const char *name, gsl_matrix **data) {
+  if (store)
+    return ROMDataStore_GetREAL8Matrix(data, store, name);
+  return ReadHDF5RealMatrixDataset(file, name, data);
+}
+
 static void PrintInfoStringAttribute(LALH5File *file, const char attribute[]) {
   LALH5Generic gfile = {.file = file};
   int len = XLALH5AttributeQueryStringValue(NULL, 0, gfile, attribute) + 1;
@@ -488,6 +544,122 @@ static REAL8 Interpolate_Coefficent_Matrix(
   return sum;
 }
 
+// Evaluate the four cubic B-spline basis functions which are nonzero at x,
+// for the knots that gsl_bspline_knots() sets up from nbreak breakpoints,
+// i.e. with the end breakpoints repeated four times. On return B[i] holds
+// basis function *istart + i.
+// Unlike gsl_bspline_eval_nonzero() this needs no workspace and is reentrant.
+static int CubicBSplineNonzeroBasis(
+  double B[4],
+  size_t *istart,
+  const double x,
+  const double *breakpts,
+  const size_t nbreak
+) {
+  XLAL_CHECK(nbreak >= 2, XLAL_EINVAL, "need at least two breakpoints, got %zu", nbreak);
+  XLAL_CHECK(x >= breakpts[0] && x <= breakpts[nbreak-1], XLAL_EDOM,
+    "x=%g outside of B-spline domain [%g, %g]", x, breakpts[0], breakpts[nbreak-1]);
+
+  // Find the breakpoint interval [b_l, b_{l+1}) containing x; the last
+  // interval is closed so that the upper boundary is included
+  size_t lo = 0, hi = nbreak - 1;
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (x < breakpts[mid])
+      hi = mid;
+    else
+      lo = mid;
+  }
+  const size_t l = lo;
+
+  // Knots t_{l+1-j} and t_{l+3+j} either side of the interval, j = 1..3,
+  // clamped to the end breakpoints
+  double left[4], right[4];
+  for (int j=1; j<=3; j++) {
+    left[j] = x - breakpts[l+1 >= (size_t) j ? l+1-j : 0];
+    right[j] = breakpts[l+j < nbreak ? l+j : nbreak-1] - x;
+  }
+
+  // Cox-de Boor recursion for the nonzero basis functions
+  B[0] = 1.0;
+  for (int j=1; j<=3; j++) {
+    double saved = 0.0;
+    for (int r=0; r<j; r++) {
+      const double temp = B[r] / (right[r+1] + left[j-r]);
+      B[r] = saved + right[r+1] * temp;
+      saved = left[j-r] * temp;
+    }
+    B[j] = saved;
+  }
+
+  *istart = l;
+  return XLAL_SUCCESS;
+}
+
+// Set up the weights for evaluating a cubic tensor product B-spline at the
+// point (x,y,z). This computes the nonzero basis functions once; the
+// resulting TPSpline3dPoint can then be contracted with any number of
+// coefficient tensors of the same shape by TPSpline3d_Evaluate().
+static int TPSpline3dPoint_Init(
+  TPSpline3dPoint *pt,
+  const REAL8 x,
+  const REAL8 y,
+  const REAL8 z,
+  const double *xvec,     // B-spline breakpoints in x
+  const double *yvec,     // B-spline breakpoints in y
+  const double *zvec,     // B-spline breakpoints in z
+  const int ncx,          // Number of points in x + 2
+  const int ncy,          // Number of points in y + 2
+  const int ncz           // Number of points in z + 2
+) {
+  XLAL_CHECK(pt != NULL, XLAL_EFAULT);
+  double Bx[4], By[4], Bz[4];
+  size_t isx, isy, isz;
+  XLAL_CHECK(CubicBSplineNonzeroBasis(Bx, &isx, x, xvec, ncx-2) == XLAL_SUCCESS, XLAL_EFUNC);
+  XLAL_CHECK(CubicBSplineNonzeroBasis(By, &isy, y, yvec, ncy-2) == XLAL_SUCCESS, XLAL_EFUNC);
+  XLAL_CHECK(CubicBSplineNonzeroBasis(Bz, &isz, z, zvec, ncz-2) == XLAL_SUCCESS, XLAL_EFUNC);
+
+  for (int i=0; i<4; i++)
+    for (int j=0; j<4; j++) {
+      pt->offset[4*i + j] = ((isx + i)*ncy + isy + j)*ncz + isz;
+      for (int k=0; k<4; k++)
+        pt->w[(4*i + j)*4 + k] = Bx[i] * By[j] * Bz[k];
+    }
+
+  return XLAL_SUCCESS;
+}
+
+// Evaluate the cubic tensor product B-splines of nmodes coefficient tensors
+// at npts points. Tensor k occupies cvec[k*N .. (k+1)*N-1] in the same layout
+// as for Interpolate_Coefficent_Tensor(), and its value at point p is stored
+// in out[p*ldout + k]. Each tensor is contracted with all points in turn so
+// that its coefficients are read while they are in cache; the innermost loop
+// runs over four coefficients which are contiguous in memory.
+static void TPSpline3d_Evaluate(
+  double *out,
+  const size_t ldout,
+  const TPSpline3dPoint *pts,
+  const size_t npts,
+  const double *cvec,
+  const int nmodes,
+  const size_t N
+) {
+  for (int k=0; k<nmodes; k++) {
+    const double *c = cvec + k*N;
+    for (size_t p=0; p<npts; p++) {
+      double acc[4] = {0, 0, 0, 0};
+      for (int ij=0; ij<16; ij++) {
+        const double *cij = c + pts[p].offset[ij];
+        const double *wij = pts[p].w + 4*ij;
+        #pragma omp simd
+        for (int l=0; l<4; l++)
+          acc[l] += cij[l] * wij[l];
+      }
+      out[p*ldout + k] = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    }
+  }
+}
+
 // Returns fitting coefficients for cubic y = c[0] + c[1]*x + c[2]*x**2 + c[3]*x**3
 static gsl_vector *Fit_cubic(const gsl_vector *xi, const gsl_vector *yi) {
   const int n = xi->size; // how many data points are we fitting
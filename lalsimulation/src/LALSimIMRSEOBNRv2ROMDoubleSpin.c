@@ -300,13 +300,6 @@ static SEOBNRROMdataDS __lalsim_SEOBNRv2ROMDS_data;
 
 typedef int (*load_dataPtr)(const char*, gsl_vector *, gsl_vector *, gsl_matrix *, gsl_matrix *, gsl_vector *);
 
-typedef struct tagSplineData
-{
-  gsl_bspline_workspace *bwx;
-  gsl_bspline_workspace *bwy;
-  gsl_bspline_workspace *bwz;
-} SplineData;
-
 /**************** Internal functions **********************/
 
 static void SEOBNRv2ROMDoubleSpin_Init_LALDATA(void);
@@ -387,16 +380,6 @@ static void SEOBNRROMdataDS_coeff_Init(SEOBNRROMdataDS_coeff **romdatacoeff, int
 static void SEOBNRROMdataDS_coeff_Cleanup(SEOBNRROMdataDS_coeff *romdatacoeff);
 
 static size_t NextPow2(const size_t n);
-static void SplineData_Destroy(SplineData *splinedata);
-static void SplineData_Init(
-  SplineData **splinedata,
-  int ncx,                // Number of points in eta  + 2
-  int ncy,                // Number of points in chi1 + 2
-  int ncz,                // Number of points in chi2 + 2
-  const double *etavec,   // B-spline knots in eta
-  const double *chi1vec,  // B-spline knots in chi1
-  const double *chi2vec   // B-spline knots in chi2
-);
 
 static int load_data_sub1(const char dir[], gsl_vector *cvec_amp, gsl_vector *cvec_phi, gsl_matrix *Bamp, gsl_matrix *Bphi, gsl_vector *cvec_amp_pre);
 static int load_data_sub2(const char dir[], gsl_vector *cvec_amp, gsl_vector *cvec_phi, gsl_matrix *Bamp, gsl_matrix *Bphi, gsl_vector *cvec_amp_pre);
@@ -496,65 +479,6 @@ static int load_data_sub3(const char dir[], gsl_vector *cvec_amp, gsl_vector *cv
   return(ret);
 }
 
-// Setup B-spline basis functions for given points
-static void SplineData_Init(
-  SplineData **splinedata,
-  int ncx,                // Number of points in eta  + 2
-  int ncy,                // Number of points in chi1 + 2
-  int ncz,                // Number of points in chi2 + 2
-  const double *etavec,   // B-spline knots in eta
-  const double *chi1vec,  // B-spline knots in chi1
-  const double *chi2vec   // B-spline knots in chi2
-)
-{
-  if(!splinedata) exit(1);
-  if(*splinedata) SplineData_Destroy(*splinedata);
-
-  (*splinedata)=XLALCalloc(1,sizeof(SplineData));
-
-  // Set up B-spline basis for desired knots
-  const size_t nbreak_x = ncx-2;  // must have nbreak = n-2 for cubic splines
-  const size_t nbreak_y = ncy-2;  // must have nbreak = n-2 for cubic splines
-  const size_t nbreak_z = ncz-2;  // must have nbreak = n-2 for cubic splines
-
-  // Allocate a cubic bspline workspace (k = 4)
-  gsl_bspline_workspace *bwx = gsl_bspline_alloc(4, nbreak_x);
-  gsl_bspline_workspace *bwy = gsl_bspline_alloc(4, nbreak_y);
-  gsl_bspline_workspace *bwz = gsl_bspline_alloc(4, nbreak_z);
-
-  // Set breakpoints (and thus knots by hand)
-  gsl_vector *breakpts_x = gsl_vector_alloc(nbreak_x);
-  gsl_vector *breakpts_y = gsl_vector_alloc(nbreak_y);
-  gsl_vector *breakpts_z = gsl_vector_alloc(nbreak_z);
-  for (UINT4 i=0; i<nbreak_x; i++)
-    gsl_vector_set(breakpts_x, i, etavec[i]);
-  for (UINT4 j=0; j<nbreak_y; j++)
-    gsl_vector_set(breakpts_y, j, chi1vec[j]);
-  for (UINT4 k=0; k<nbreak_z; k++)
-    gsl_vector_set(breakpts_z, k, chi2vec[k]);
-
-  gsl_bspline_knots(breakpts_x, bwx);
-  gsl_bspline_knots(breakpts_y, bwy);
-  gsl_bspline_knots(breakpts_z, bwz);
-
-  gsl_vector_free(breakpts_x);
-  gsl_vector_free(breakpts_y);
-  gsl_vector_free(breakpts_z);
-
-  (*splinedata)->bwx=bwx;
-  (*splinedata)->bwy=bwy;
-  (*splinedata)->bwz=bwz;
-}
-
-static void SplineData_Destroy(SplineData *splinedata)
-{
-  if(!splinedata) return;
-  if(splinedata->bwx) gsl_bspline_free(splinedata->bwx);
-  if(splinedata->bwy) gsl_bspline_free(splinedata->bwy);
-  if(splinedata->bwz) gsl_bspline_free(splinedata->bwz);
-  XLALFree(splinedata);
-}
-
 // Interpolate projection coefficients for amplitude and phase over the parameter space (q, chi).
 // The multi-dimensional interpolation is carried out via a tensor product decomposition.
 static int TP_Spline_interpolation_3d(
@@ -576,33 +500,20 @@ static int TP_Spline_interpolation_3d(
   gsl_vector *c_phi,        // Output: interpolated projection coefficients for phase
   REAL8 *amp_pre            // Output: interpolated amplitude prefactor
 ) {
-  SplineData *splinedata=NULL;
-  SplineData_Init(&splinedata, ncx, ncy, ncz, etavec, chi1vec, chi2vec);
-
-  gsl_bspline_workspace *bwx=splinedata->bwx;
-  gsl_bspline_workspace *bwy=splinedata->bwy;
-  gsl_bspline_workspace *bwz=splinedata->bwz;
+  TPSpline3dPoint pt;
+  int ret = TPSpline3dPoint_Init(&pt, eta, chi1, chi2, etavec, chi1vec, chi2vec, ncx, ncy, ncz);
+  if(ret != XLAL_SUCCESS) XLAL_ERROR(ret);
 
-  int N = ncx*ncy*ncz;  // Size of the data matrix for one SVD-mode
+  size_t N = ncx*ncy*ncz;  // Size of the data matrix for one SVD-mode
 
   // Evaluate the TP spline for all SVD modes - amplitude
-  for (int k=0; k<nk_amp; k++) { // For each SVD mode
-    gsl_vector v = gsl_vector_subvector(cvec_amp, k*N, N).vector; // Pick out the coefficient matrix corresponding to the k-th SVD mode.
-    REAL8 csum = Interpolate_Coefficent_Tensor(&v, eta, chi1, chi2, ncy, ncz, bwx, bwy, bwz);
-    gsl_vector_set(c_amp, k, csum);
-  }
+  TPSpline3d_Evaluate(gsl_vector_ptr(c_amp, 0), 0, &pt, 1, gsl_vector_const_ptr(cvec_amp, 0), nk_amp, N);
 
   // Evaluate the TP spline for all SVD modes - phase
-  for (int k=0; k<nk_phi; k++) {  // For each SVD mode
-    gsl_vector v = gsl_vector_subvector(cvec_phi, k*N, N).vector; // Pick out the coefficient matrix corresponding to the k-th SVD mode.
-    REAL8 csum = Interpolate_Coefficent_Tensor(&v, eta, chi1, chi2, ncy, ncz, bwx, bwy, bwz);
-    gsl_vector_set(c_phi, k, csum);
-  }
+  TPSpline3d_Evaluate(gsl_vector_ptr(c_phi, 0), 0, &pt, 1, gsl_vector_const_ptr(cvec_phi, 0), nk_phi, N);
 
   // Evaluate the TP spline for the amplitude prefactor
-  *amp_pre = Interpolate_Coefficent_Tensor(cvec_amp_pre, eta, chi1, chi2, ncy, ncz, bwx, bwy, bwz);
-
-  SplineData_Destroy(splinedata);
+  TPSpline3d_Evaluate(amp_pre, 0, &pt, 1, gsl_vector_const_ptr(cvec_amp_pre, 0), 1, N);
 
   return(0);
 }
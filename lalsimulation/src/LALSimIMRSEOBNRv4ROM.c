@@ -101,6 +101,7 @@ struct tagSEOBNRROMdataDS_submodel
   double eta_bounds[2];      // [eta_min, eta_max]
   double chi1_bounds[2];     // [chi1_min, chi1_max]
   double chi2_bounds[2];     // [chi2_min, chi2_max]
+  const ROMDataStoreGroup *store; // Shared data store the vectors above point into, or NULL
 };
 typedef struct tagSEOBNRROMdataDS_submodel SEOBNRROMdataDS_submodel;
 
@@ -117,13 +118,6 @@ static SEOBNRROMdataDS __lalsim_SEOBNRv4ROMDS_data;
 
 typedef int (*load_dataPtr)(const char*, gsl_vector *, gsl_vector *, gsl_matrix *, gsl_matrix *, gsl_vector *);
 
-typedef struct tagSplineData
-{
-  gsl_bspline_workspace *bwx;
-  gsl_bspline_workspace *bwy;
-  gsl_bspline_workspace *bwz;
-} SplineData;
-
 /**************** Internal functions **********************/
 
 UNUSED static void SEOBNRv4ROM_Init_LALDATA(void);
@@ -191,16 +185,6 @@ UNUSED static void SEOBNRROMdataDS_coeff_Init(SEOBNRROMdataDS_coeff **romdatacoe
 UNUSED static void SEOBNRROMdataDS_coeff_Cleanup(SEOBNRROMdataDS_coeff *romdatacoeff);
 
 static size_t NextPow2(const size_t n);
-UNUSED static void SplineData_Destroy(SplineData *splinedata);
-UNUSED static void SplineData_Init(
-  SplineData **splinedata,
-  int ncx,                // Number of points in eta  + 2
-  int ncy,                // Number of points in chi1 + 2
-  int ncz,                // Number of points in chi2 + 2
-  const double *etavec,   // B-spline knots in eta
-  const double *chi1vec,  // B-spline knots in chi1
-  const double *chi2vec   // B-spline knots in chi2
-);
 
 UNUSED static int SEOBNRv4ROMTimeFrequencySetup(
   gsl_spline **spline_phi,                      // phase spline
@@ -280,65 +264,6 @@ static bool SEOBNRv4ROM_IsSetup(void) {
     return false;
 }
 
-// Setup B-spline basis functions for given points
-static void SplineData_Init(
-  SplineData **splinedata,
-  int ncx,                // Number of points in eta  + 2
-  int ncy,                // Number of points in chi1 + 2
-  int ncz,                // Number of points in chi2 + 2
-  const double *etavec,   // B-spline knots in eta
-  const double *chi1vec,  // B-spline knots in chi1
-  const double *chi2vec   // B-spline knots in chi2
-)
-{
-  if(!splinedata) exit(1);
-  if(*splinedata) SplineData_Destroy(*splinedata);
-
-  (*splinedata)=XLALCalloc(1,sizeof(SplineData));
-
-  // Set up B-spline basis for desired knots
-  const size_t nbreak_x = ncx-2;  // must have nbreak = n-2 for cubic splines
-  const size_t nbreak_y = ncy-2;  // must have nbreak = n-2 for cubic splines
-  const size_t nbreak_z = ncz-2;  // must have nbreak = n-2 for cubic splines
-
-  // Allocate a cubic bspline workspace (k = 4)
-  gsl_bspline_workspace *bwx = gsl_bspline_alloc(4, nbreak_x);
-  gsl_bspline_workspace *bwy = gsl_bspline_alloc(4, nbreak_y);
-  gsl_bspline_workspace *bwz = gsl_bspline_alloc(4, nbreak_z);
-
-  // Set breakpoints (and thus knots by hand)
-  gsl_vector *breakpts_x = gsl_vector_alloc(nbreak_x);
-  gsl_vector *breakpts_y = gsl_vector_alloc(nbreak_y);
-  gsl_vector *breakpts_z = gsl_vector_alloc(nbreak_z);
-  for (UINT4 i=0; i<nbreak_x; i++)
-    gsl_vector_set(breakpts_x, i, etavec[i]);
-  for (UINT4 j=0; j<nbreak_y; j++)
-    gsl_vector_set(breakpts_y, j, chi1vec[j]);
-  for (UINT4 k=0; k<nbreak_z; k++)
-    gsl_vector_set(breakpts_z, k, chi2vec[k]);
-
-  gsl_bspline_knots(breakpts_x, bwx);
-  gsl_bspline_knots(breakpts_y, bwy);
-  gsl_bspline_knots(breakpts_z, bwz);
-
-  gsl_vector_free(breakpts_x);
-  gsl_vector_free(breakpts_y);
-  gsl_vector_free(breakpts_z);
-
-  (*splinedata)->bwx=bwx;
-  (*splinedata)->bwy=bwy;
-  (*splinedata)->bwz=bwz;
-}
-
-static void SplineData_Destroy(SplineData *splinedata)
-{
-  if(!splinedata) return;
-  if(splinedata->bwx) gsl_bspline_free(splinedata->bwx);
-  if(splinedata->bwy) gsl_bspline_free(splinedata->bwy);
-  if(splinedata->bwz) gsl_bspline_free(splinedata->bwz);
-  XLALFree(splinedata);
-}
-
 // Interpolate projection coefficients for amplitude and phase over the parameter space (q, chi).
 // The multi-dimensional interpolation is carried out via a tensor product decomposition.
 static int TP_Spline_interpolation_3d(
@@ -368,29 +293,17 @@ static int TP_Spline_interpolation_3d(
     }
   }
 
-  SplineData *splinedata=NULL;
-  SplineData_Init(&splinedata, ncx, ncy, ncz, etavec, chi1vec, chi2vec);
+  TPSpline3dPoint pt;
+  int ret = TPSpline3dPoint_Init(&pt, eta, chi1, chi2, etavec, chi1vec, chi2vec, ncx, ncy, ncz);
+  if(ret != XLAL_SUCCESS) XLAL_ERROR(ret);
 
-  gsl_bspline_workspace *bwx=splinedata->bwx;
-  gsl_bspline_workspace *bwy=splinedata->bwy;
-  gsl_bspline_workspace *bwz=splinedata->bwz;
+  size_t N = ncx*ncy*ncz;  // Size of the data matrix for one SVD-mode
 
-  int N = ncx*ncy*ncz;  // Size of the data matrix for one SVD-mode
   // Evaluate the TP spline for all SVD modes - amplitude
-  for (int k=0; k<nk_amp; k++) { // For each SVD mode
-    gsl_vector v = gsl_vector_subvector(cvec_amp, k*N, N).vector; // Pick out the coefficient matrix corresponding to the k-th SVD mode.
-    REAL8 csum = Interpolate_Coefficent_Tensor(&v, eta, chi1, chi2, ncy, ncz, bwx, bwy, bwz);
-    gsl_vector_set(c_amp, k, csum);
-  }
+  TPSpline3d_Evaluate(gsl_vector_ptr(c_amp, 0), 0, &pt, 1, gsl_vector_const_ptr(cvec_amp, 0), nk_amp, N);
 
   // Evaluate the TP spline for all SVD modes - phase
-  for (int k=0; k<nk_phi; k++) {  // For each SVD mode
-    gsl_vector v = gsl_vector_subvector(cvec_phi, k*N, N).vector; // Pick out the coefficient matrix corresponding to the k-th SVD mode.
-    REAL8 csum = Interpolate_Coefficent_Tensor(&v, eta, chi1, chi2, ncy, ncz, bwx, bwy, bwz);
-    gsl_vector_set(c_phi, k, csum);
-  }
-
-  SplineData_Destroy(splinedata);
+  TPSpline3d_Evaluate(gsl_vector_ptr(c_phi, 0), 0, &pt, 1, gsl_vector_const_ptr(cvec_phi, 0), nk_phi, N);
 
   return(0);
 }
@@ -415,25 +328,32 @@ UNUSED static int SEOBNRROMdataDS_Init_submodel(
   char *path = XLALMalloc(size);
   snprintf(path, size, "%s/%s", dir, ROMDataHDF5);
 
-  LALH5File *file = XLALH5FileOpen(path, "r");
-  LALH5File *sub = XLALH5GroupOpen(file, grp_name);
+  // Map the submodel from the shared data store, or read it directly if that is unavailable
+  const ROMDataStoreGroup *store = ROMDataStore_OpenGroup(path, grp_name);
+  LALH5File *file = NULL;
+  LALH5File *sub = NULL;
+  if (!store) {
+    file = XLALH5FileOpen(path, "r");
+    sub = XLALH5GroupOpen(file, grp_name);
+  }
+  (*submodel)->store = store;
 
   // Read ROM coefficients
-  ReadHDF5RealVectorDataset(sub, "Amp_ciall", & (*submodel)->cvec_amp);
-  ReadHDF5RealVectorDataset(sub, "Phase_ciall", & (*submodel)->cvec_phi);
+  ReadROMRealVectorDataset(store, sub, "Amp_ciall", & (*submodel)->cvec_amp);
+  ReadROMRealVectorDataset(store, sub, "Phase_ciall", & (*submodel)->cvec_phi);
 
   // Read ROM basis functions
-  ReadHDF5RealMatrixDataset(sub, "Bamp", & (*submodel)->Bamp);
-  ReadHDF5RealMatrixDataset(sub, "Bphase", & (*submodel)->Bphi);
+  ReadROMRealMatrixDataset(store, sub, "Bamp", & (*submodel)->Bamp);
+  ReadROMRealMatrixDataset(store, sub, "Bphase", & (*submodel)->Bphi);
 
   // Read sparse frequency points
-  ReadHDF5RealVectorDataset(sub, "Mf_grid_Amp", & (*submodel)->gA);
-  ReadHDF5RealVectorDataset(sub, "Mf_grid_Phi", & (*submodel)->gPhi);
+  ReadROMRealVectorDataset(store, sub, "Mf_grid_Amp", & (*submodel)->gA);
+  ReadROMRealVectorDataset(store, sub, "Mf_grid_Phi", & (*submodel)->gPhi);
 
   // Read parameter space nodes
-  ReadHDF5RealVectorDataset(sub, "etavec", & (*submodel)->etavec);
-  ReadHDF5RealVectorDataset(sub, "chi1vec", & (*submodel)->chi1vec);
-  ReadHDF5RealVectorDataset(sub, "chi2vec", & (*submodel)->chi2vec);
+  ReadROMRealVectorDataset(store, sub, "etavec", & (*submodel)->etavec);
+  ReadROMRealVectorDataset(store, sub, "chi1vec", & (*submodel)->chi1vec);
+  ReadROMRealVectorDataset(store, sub, "chi2vec", & (*submodel)->chi2vec);
 
   // Initialize other members
   (*submodel)->nk_amp = (*submodel)->gA->size;
@@ -451,7 +371,8 @@ UNUSED static int SEOBNRROMdataDS_Init_submodel(
   (*submodel)->chi2_bounds[1] = gsl_vector_get((*submodel)->chi2vec, (*submodel)->chi2vec->size - 1);
 
   XLALFree(path);
-  XLALH5FileClose(file);
+  if (file)
+    XLALH5FileClose(file);
   ret = XLAL_SUCCESS;
 #else
   XLAL_ERROR(XLAL_EFAILED, "HDF5 support not enabled");
@@ -471,6 +392,9 @@ static void SEOBNRROMdataDS_Cleanup_submodel(SEOBNRROMdataDS_submodel *submodel)
   if(submodel->etavec)  gsl_vector_free(submodel->etavec);
   if(submodel->chi1vec) gsl_vector_free(submodel->chi1vec);
   if(submodel->chi2vec) gsl_vector_free(submodel->chi2vec);
+  // Only unmap the shared data once the views into it have been freed
+  ROMDataStore_CloseGroup(submodel->store);
+  submodel->store = NULL;
 }
 
 /* Set up a new ROM model, using data contained in dir */
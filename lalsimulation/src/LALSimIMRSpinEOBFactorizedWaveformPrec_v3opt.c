@@ -1029,7 +1029,8 @@ XLALSimIMRSpinEOBGetPrecSpinFactorizedWaveform_exact(
  *
  * Fourth, the polar \f$(r,\phi,p_r=0,p_\phi)\f$ and the Cartesian spin vectors
  * are used to compute the derivative
- * \f$\partial Hreal/\partial p_\phi |p_r=0\f$.
+ * \f$\partial Hreal/\partial p_\phi |p_r=0\f$, from the exact derivatives of
+ * Hreal w.r.t. the Cartesian momentum.
  */
 
 static REAL8 XLALSimIMRSpinPrecEOBCalcOmega_exact(
@@ -1050,15 +1051,12 @@ static REAL8 XLALSimIMRSpinPrecEOBCalcOmega_exact(
   /* ********************************************************************* */
   /* ************ Memory Allocation ************************************** */
   /* ********************************************************************* */
-  static const REAL8 STEP_SIZE = 1.0e-4;
   REAL8 tmpvar = 0;
 
-  HcapDerivParams params;
-
   /* Cartesian values for calculating the Hamiltonian */
   REAL8 cartValues[14] = {0.}, dvalues[14] = {0.};
   REAL8 cartvalues[14] = {0.}, polarvalues[6] = {0.}; /* The rotated cartesian/polar values */
-  REAL8 polarRPcartSvalues[14] = {0.};
+  REAL8 hcartvalues[12] = {0.}; /* The rotated cartesian values at p_r = 0 */
   memcpy( cartValues, values, 14 * sizeof(REAL8) );
 
   INT4 i, j;
@@ -1084,14 +1082,8 @@ static REAL8 XLALSimIMRSpinPrecEOBCalcOmega_exact(
 
   REAL8 Xprime[3] = {0.,0,0}, Yprime[3] = {0.,0,0}, Zprime[3] = {0.,0,0};
 
-  gsl_function F;
-  INT4         gslStatus;
-
   REAL8 omega;
 
-  /* The error in a derivative as measured by GSL */
-  REAL8 absErr;
-
   /* ********************************************************************* */
   /* ************ Main Logic begins ************************************ */
   /* ********************************************************************* */
@@ -1242,27 +1234,70 @@ static REAL8 XLALSimIMRSpinPrecEOBCalcOmega_exact(
   /* Finally, Differentiate Hamiltonian w.r.t. p_\phi, keeping p_r = 0 */
   /* ********************************************************************* */
 
-  /* Populate the vector specifying the dynamical variables in mixed frames */
-  memcpy( polarRPcartSvalues, cartvalues, 12*sizeof(REAL8));
-  memcpy( polarRPcartSvalues, polarvalues, 6*sizeof(REAL8));
+  /* Convert back to Cartesian coordinates as GSLSpinPrecHamiltonianWrapperFordHdpphi
+   * does, and apply the chain rule to the exact derivatives of Hreal w.r.t. the
+   * Cartesian momentum: only the momentum depends on p_\phi. */
+  REAL8 rpolar[3] = {0.}, ppolar[3] = {0.}, dpcartdpphi[3] = {0.};
+  memcpy( rpolar, polarvalues,   3*sizeof(REAL8) );
+  memcpy( ppolar, polarvalues+3, 3*sizeof(REAL8) );
 
-  /* Set up pointers for GSL */
-  params.values  = polarRPcartSvalues;
-  params.params  = funcParams;
+  hcartvalues[0] = rpolar[0] * cos(rpolar[1]);
+  hcartvalues[1] =-rpolar[0] * sin(rpolar[1])*sin(rpolar[2]);
+  hcartvalues[2] = rpolar[0] * sin(rpolar[1])*cos(rpolar[2]);
 
-  F.function = &GSLSpinPrecHamiltonianWrapperFordHdpphi;
-  F.params   = &params;
+  if( rpolar[1]==0. || rpolar[1]==LAL_PI )
+  {
+    rpolar[1] = LAL_PI/2.;
+
+    if( rpolar[1]==0.)
+      rpolar[2] = 0.;
+    else
+      rpolar[2] = LAL_PI;
+
+    hcartvalues[3] = ppolar[0]*sin(rpolar[1])*cos(rpolar[2])
+					+ ppolar[1]/rpolar[0]*cos(rpolar[1])*cos(rpolar[2])
+					- ppolar[2]/rpolar[0]/sin(rpolar[1])*sin(rpolar[2]);
+    hcartvalues[4] = ppolar[0]*sin(rpolar[1])*sin(rpolar[2])
+					+ ppolar[1]/rpolar[0]*cos(rpolar[1])*sin(rpolar[2])
+					+ ppolar[2]/rpolar[0]/sin(rpolar[1])*cos(rpolar[2]);
+    hcartvalues[5] = ppolar[0]*cos(rpolar[1])- ppolar[1]/rpolar[0]*sin(rpolar[1]);
+
+    dpcartdpphi[0] = -sin(rpolar[2])/rpolar[0]/sin(rpolar[1]);
+    dpcartdpphi[1] =  cos(rpolar[2])/rpolar[0]/sin(rpolar[1]);
+  }
+  else
+  {
+    hcartvalues[3] = ppolar[0]*cos(rpolar[1]) -ppolar[1]/rpolar[0]*sin(rpolar[1]);
+    hcartvalues[4] =-ppolar[0]*sin(rpolar[1])*sin(rpolar[2])
+					-ppolar[1]/rpolar[0]*cos(rpolar[1])*sin(rpolar[2])
+					-ppolar[2]/rpolar[0]/sin(rpolar[1])*cos(rpolar[2]);
+    hcartvalues[5] = ppolar[0]*sin(rpolar[1])*cos(rpolar[2])
+					+ppolar[1]/rpolar[0]*cos(rpolar[1])*cos(rpolar[2])
+					-ppolar[2]/rpolar[0]/sin(rpolar[1])*sin(rpolar[2]);
+
+    dpcartdpphi[1] = -cos(rpolar[2])/rpolar[0]/sin(rpolar[1]);
+    dpcartdpphi[2] = -sin(rpolar[2])/rpolar[0]/sin(rpolar[1]);
+  }
 
-  /* Now calculate omega. In the chosen co-ordinate system, */
-  /* we need dH/dpphi to calculate this, i.e. varyParam = 5 */
-  params.varyParam = 5;
-  XLAL_CALLGSL( gslStatus = gsl_deriv_central( &F, polarvalues[5],
-                  STEP_SIZE, &omega, &absErr ) );
+  /* XLALSpinPrecHcapExactDerivWRTParam expects spins S_i, the rotated ones are S_i/M^2 */
+  const REAL8 mT2 = (funcParams->eobParams->m1 + funcParams->eobParams->m2)
+                  * (funcParams->eobParams->m1 + funcParams->eobParams->m2);
+  for( i = 6; i < 12; i++ )
+    hcartvalues[i] = cartvalues[i] * mT2;
 
-  if ( gslStatus != GSL_SUCCESS )
+  /* Now calculate omega. In the chosen co-ordinate system, */
+  /* we need dH/dpphi to calculate this */
+  omega = 0.;
+  for( i = 0; i < 3; i++ )
   {
-    XLALPrintError( "XLAL Error - %s: Failure in GSL function\n", __func__ );
-    XLAL_ERROR_REAL8( XLAL_EFUNC );
+    if( dpcartdpphi[i] == 0. )
+      continue;
+    REAL8 dHdpi = XLALSpinPrecHcapExactDerivWRTParam( i + 3, hcartvalues, funcParams );
+    if( XLAL_IS_REAL8_FAIL_NAN( dHdpi ) )
+    {
+      XLAL_ERROR_REAL8( XLAL_EFUNC );
+    }
+    omega += dHdpi * dpcartdpphi[i];
   }
 
   return omega;
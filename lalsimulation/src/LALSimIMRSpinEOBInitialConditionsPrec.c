@@ -53,6 +53,46 @@ CalculateCrossProductPrec(
 	return a[(i + 1) % 3] * b[(i + 2) % 3] - a[(i + 2) % 3] * b[(i + 1) % 3];
 }
 
+/**
+ * Time derivatives of the dynamical variables, computed from exact derivatives
+ * of the Hamiltonian if use_optimized is set and from finite differences otherwise.
+ * The finite-difference routine leaves params->tortoise set to 1 on exit; the
+ * exact branch does the same, so that both give the same initial conditions
+ * up to the accuracy of the derivatives.
+ */
+static int
+XLALSpinPrecHcapDerivativeForIC(
+                                const REAL8 values[],	/**<< Dynamical variables */
+                                REAL8 dvalues[],	/**<< Time derivatives of variables (returned) */
+                                SpinEOBParams * params,	/**<< Spin EOB parameters */
+                                INT4 use_optimized	/**<< use_optimized=1 -> use EXACT derivatives */
+)
+{
+	if (use_optimized) {
+		int status = XLALSpinPrecHcapExactDerivative(0, values, dvalues, params);
+		params->tortoise = 1;
+		return status;
+	}
+	return XLALSpinPrecHcapNumericalDerivative(0, values, dvalues, params);
+}
+
+/**
+ * Derivative of the Hamiltonian w.r.t. one of the dynamical variables, computed
+ * exactly if use_optimized is set and from finite differences otherwise.
+ */
+static REAL8
+XLALSpinPrecHcapDerivWRTParamForIC(
+                                   const INT4 paramIdx,	/**<< Index of the parameter */
+                                   const REAL8 values[],	/**<< Dynamical variables */
+                                   SpinEOBParams * params,	/**<< Spin EOB parameters */
+                                   INT4 use_optimized	/**<< use_optimized=1 -> use EXACT derivatives */
+)
+{
+	if (use_optimized)
+		return XLALSpinPrecHcapExactDerivWRTParam(paramIdx, values, params);
+	return XLALSpinPrecHcapNumDerivWRTParam(paramIdx, values, params);
+}
+
 
 /**
  * Normalizes the given vector
@@ -350,7 +390,7 @@ XLALFindSphericalOrbitPrec(
 	}
     UINT4 oldignoreflux = rootParams->params->ignoreflux;
     rootParams->params->ignoreflux = 1;
-    status = XLALSpinPrecHcapNumericalDerivative(0, rootParams->values, tmpDValues, rootParams->params);
+    status = XLALSpinPrecHcapDerivativeForIC(rootParams->values, tmpDValues, rootParams->params, rootParams->use_optimized);
     rootParams->params->ignoreflux = oldignoreflux;
 	for (int i = 0; i < 3; i++) {
 		rootParams->values[i + 6] *= mTotal * mTotal;
@@ -392,12 +432,12 @@ XLALFindSphericalOrbitPrec(
     //rootParams->values[9] = 0.;
     //rootParams->values[10]= 0.;
     //rootParams->values[11]= sqrt(CalculateDotProductPrec(chi2vec, chi2vec));
-    dHdx = XLALSpinPrecHcapNumDerivWRTParam(0,
-					    rootParams->values, rootParams->params);
-    dHdpy = XLALSpinPrecHcapNumDerivWRTParam(4,
-					     rootParams->values, rootParams->params);
-    dHdpz = XLALSpinPrecHcapNumDerivWRTParam(5,
-					     rootParams->values, rootParams->params);
+    dHdx = XLALSpinPrecHcapDerivWRTParamForIC(0,
+					    rootParams->values, rootParams->params, rootParams->use_optimized);
+    dHdpy = XLALSpinPrecHcapDerivWRTParamForIC(4,
+					     rootParams->values, rootParams->params, rootParams->use_optimized);
+    dHdpz = XLALSpinPrecHcapDerivWRTParamForIC(5,
+					     rootParams->values, rootParams->params, rootParams->use_optimized);
   }
 	if (XLAL_IS_REAL8_FAIL_NAN(dHdx)) { XLAL_ERROR(XLAL_EDOM); }
 	if (XLAL_IS_REAL8_FAIL_NAN(dHdpy)) { XLAL_ERROR(XLAL_EDOM); }
@@ -469,7 +509,7 @@ GSLSpinHamiltonianDerivWrapperPrec(double x,	/**<< Derivative at x */
 	}
     UINT4 oldignoreflux = dParams->params->ignoreflux;
     dParams->params->ignoreflux = 1;
-    status = XLALSpinPrecHcapNumericalDerivative(0, cartValues, tmpDValues, dParams->params);
+    status = XLALSpinPrecHcapDerivativeForIC(cartValues, tmpDValues, dParams->params, dParams->use_optimized);
     dParams->params->ignoreflux = oldignoreflux;
 	for (int i = 0; i < 3; i++) {
 		cartValues[i + 6] *= mTotal * mTotal;
@@ -527,9 +567,9 @@ GSLSpinHamiltonianDerivWrapperPrec(double x,	/**<< Derivative at x */
 		switch (dParams->varyParam2) {
 		case 0:
 			/* dHdr */
-		        dHdx = XLALSpinPrecHcapNumDerivWRTParam(0, cartValues, dParams->params);
-			dHdpy = XLALSpinPrecHcapNumDerivWRTParam(4, cartValues, dParams->params);
-			dHdpz = XLALSpinPrecHcapNumDerivWRTParam(5, cartValues, dParams->params);
+		        dHdx = XLALSpinPrecHcapDerivWRTParamForIC(0, cartValues, dParams->params, dParams->use_optimized);
+			dHdpy = XLALSpinPrecHcapDerivWRTParamForIC(4, cartValues, dParams->params, dParams->use_optimized);
+			dHdpz = XLALSpinPrecHcapDerivWRTParamForIC(5, cartValues, dParams->params, dParams->use_optimized);
 			dHdr = dHdx - dHdpy * pphi / (r * r) + dHdpz * ptheta / (r * r);
 			//XLAL_PRINT_INFO("dHdr = %.16e\n", dHdr);
 			return dHdr;
@@ -537,12 +577,12 @@ GSLSpinHamiltonianDerivWrapperPrec(double x,	/**<< Derivative at x */
 			break;
 		case 4:
 			/* dHdptheta */
-                        dHdpz = XLALSpinPrecHcapNumDerivWRTParam(5, cartValues, dParams->params);
+                        dHdpz = XLALSpinPrecHcapDerivWRTParamForIC(5, cartValues, dParams->params, dParams->use_optimized);
 			return -dHdpz / r;
 			break;
 		case 5:
 			/* dHdpphi */
-		        dHdpy = XLALSpinPrecHcapNumDerivWRTParam(4, cartValues, dParams->params);
+		        dHdpy = XLALSpinPrecHcapDerivWRTParamForIC(4, cartValues, dParams->params, dParams->use_optimized);
 			return dHdpy / r;
 			break;
 		default:
@@ -563,7 +603,7 @@ XLALCalculateSphHamiltonianDeriv2Prec(
 				  const int idx2,	/**<< Derivative w.r.t. index 2 */
 				  const REAL8 values[],	/**<< Dynamical variables in spherical coordinates */
 				  SpinEOBParams * params,	/**<< Spin EOB Parameters */
-                                  INT4 use_optimized    /**<< use_optimized=1 -> use EXACT instead of finite difference derivatives... UNSUPPORTED AT MOMENT. */
+                                  INT4 use_optimized    /**<< use_optimized=1 -> use EXACT instead of finite difference first derivatives */
 )
 {
 
@@ -1165,7 +1205,7 @@ XLALSimIMRSpinEOBInitialConditionsPrec(
 	}
     UINT4 oldignoreflux = params->ignoreflux;
     params->ignoreflux = 1;
-    status = XLALSpinPrecHcapNumericalDerivative(0, cartValues, tmpDValues, params);
+    status = XLALSpinPrecHcapDerivativeForIC(cartValues, tmpDValues, params, use_optimized);
     params->ignoreflux = oldignoreflux;
 	for (i = 0; i < 3; i++) {
 		cartValues[i + 6] *= mTotal * mTotal;
@@ -1273,7 +1313,7 @@ XLALSimIMRSpinEOBInitialConditionsPrec(
         oldignoreflux = params->ignoreflux;
         params->ignoreflux = 1;
         params->seobCoeffs->updateHCoeffs = 1;
-	status = XLALSpinPrecHcapNumericalDerivative(0, cartValues, tmpDValues, params);
+	status = XLALSpinPrecHcapDerivativeForIC(cartValues, tmpDValues, params, use_optimized);
         params->ignoreflux = oldignoreflux;
 		for (i = 0; i < 3; i++) {
 			cartValues[i + 6] *= mTotal * mTotal;
@@ -25,6 +25,11 @@ static INT4 XLALSEOBNRv3_opt_ComputeHamiltonianDerivatives(
             SpinEOBParams * params,
             REAL8 * HReal);
 
+UNUSED static REAL8 XLALSpinPrecHcapExactDerivWRTParam(
+            const INT4 paramIdx,
+            const REAL8 values[],
+            SpinEOBParams * params);
+
 /*------------------------------------------------------------------------------------------
  *
  *          Defintions of functions.
@@ -201,6 +206,195 @@ static INT4 XLALSEOBNRv3_opt_HDerivs_for_Omega(
   return 0;
 }
 
+/**
+ * Exact counterpart of XLALSpinPrecHcapNumDerivWRTParam(): the derivative of the
+ * Hamiltonian, divided by eta, w.r.t. one of the position or momentum components
+ * (paramIdx = 0..5), with the momentum interpreted according to params->tortoise.
+ * As for XLALSpinPrecHcapNumDerivWRTParam(), the spins in values[] are in units
+ * of the total mass squared.
+ */
+UNUSED static REAL8 XLALSpinPrecHcapExactDerivWRTParam(
+						 const INT4 paramIdx,	/**<< Index of the parameter */
+						 const REAL8 values[],	/**<< Dynamical variables */
+						 SpinEOBParams * params	/**<< EOB parameters */
+						 ){
+
+  if (paramIdx < 0 || paramIdx >= 6) {
+    XLALPrintError("XLAL Error - %s: derivative w.r.t. parameter %d is not available\n", __func__, paramIdx);
+    XLAL_ERROR_REAL8(XLAL_EINVAL);
+  }
+
+  const REAL8 mass1 = params->eobParams->m1;
+  const REAL8 mass2 = params->eobParams->m2;
+  const REAL8 eta = params->eobParams->eta;
+  const REAL8 mT2 = (mass1 + mass2) * (mass1 + mass2);
+  SpinEOBHCoeffs *coeffs = params->seobCoeffs;
+
+  REAL8 sigmaKerrData[3];
+  REAL8 sigmaStarData[3];
+  REAL8 s1VecData[3];
+  REAL8 s2VecData[3];
+
+  for(int i=0; i<3; i++){
+    s1VecData[i] = values[i+6]/mT2;
+    s2VecData[i] = values[i+9]/mT2;
+    sigmaKerrData[i] = s1VecData[i]+s2VecData[i];
+    sigmaStarData[i] = (mass2/mass1)*s1VecData[i]+(mass1/mass2)*s2VecData[i];
+  }
+
+  REAL8Vector dsigmaKerr;
+  REAL8Vector dsigmaStar;
+  REAL8Vector ds1Vec;
+  REAL8Vector ds2Vec;
+
+  dsigmaKerr.data = sigmaKerrData;
+  dsigmaStar.data = sigmaStarData;
+  ds1Vec.data = s1VecData;
+  ds2Vec.data = s2VecData;
+
+  REAL8Vector * sigmaKerr = &dsigmaKerr;
+  REAL8Vector * sigmaStar = &dsigmaStar;
+  REAL8Vector * s1Vec = &ds1Vec;
+  REAL8Vector * s2Vec = &ds2Vec;
+
+  SEOBHCoeffConstants * seobCoeffConsts = params->seobCoeffConsts;
+
+  /* The generated code below overwrites the spin-dependent coefficients, so work on a copy */
+  SpinEOBHCoeffs tmpCoeffs = *coeffs;
+  if(coeffs->updateHCoeffs){
+    REAL8 tmpa = sqrt(sigmaKerr->data[0]*sigmaKerr->data[0]
+                      + sigmaKerr->data[1]*sigmaKerr->data[1]
+                      + sigmaKerr->data[2]*sigmaKerr->data[2]);
+
+    if ( XLALSimIMRCalculateSpinPrecEOBHCoeffs( &tmpCoeffs, eta, tmpa, coeffs->SpinAlignedEOBversion ) == XLAL_FAILURE )
+      {
+	XLAL_ERROR_REAL8( XLAL_EFUNC );
+      }
+
+    tmpCoeffs.SpinAlignedEOBversion = coeffs->SpinAlignedEOBversion;
+    tmpCoeffs.updateHCoeffs = coeffs->updateHCoeffs;
+  }
+  coeffs = &tmpCoeffs;
+
+  REAL8 a2_prederiv = sigmaKerr->data[0] * sigmaKerr->data[0] + sigmaKerr->data[1] * sigmaKerr->data[1] +  sigmaKerr->data[2] * sigmaKerr->data[2];
+  REAL8 a_prederiv = sqrt(a2_prederiv);
+
+  INT4 divby0 = 0;
+
+  REAL8 e3_x, e3_y, e3_z;
+
+  if(a_prederiv !=0.)
+    {
+      const REAL8 inva = 1./a_prederiv;
+      e3_x = sigmaKerr->data[0] * inva;
+      e3_y = sigmaKerr->data[1] * inva;
+      e3_z = sigmaKerr->data[2] * inva;
+    }
+  else
+    {
+      /* SEOBNRv3_opt: Since spin=0, we are free to choose the "spin direction". */
+      e3_x = 1./sqrt(3.);
+      e3_y = 1./sqrt(3.);
+      e3_z = 1./sqrt(3.);
+
+      divby0=1;
+    }
+
+  REAL8Vector xVec, pVec;
+  xVec.length = pVec.length= 3;
+
+  REAL8 xData[3] = {0.}, pData[3] = {0.};
+  xVec.data = xData;
+  pVec.data = pData;
+
+  REAL8Vector * x;
+  REAL8Vector * p;
+  x=&xVec;
+  p=&pVec;
+
+  memcpy(xVec.data,values,3*sizeof(REAL8));
+  memcpy(pVec.data,values+3,3*sizeof(REAL8));
+
+  const REAL8 invr = 1./sqrt(xData[0]*xData[0]+xData[1]*xData[1]+xData[2]*xData[2]);
+
+  if (1. - fabs(e3_x*(xData[0]*invr) + e3_y*(xData[1]*invr) + e3_z*(xData[2]*invr)) <= 1.e-8) {
+    e3_x = e3_x+0.1;
+    e3_y = e3_y+0.1;
+    const REAL8 invnorm = 1./sqrt(e3_x*e3_x + e3_y*e3_y + e3_z*e3_z);
+    e3_x = e3_x*invnorm;
+    e3_y = e3_y*invnorm;
+    e3_z = e3_z*invnorm;
+    divby0 = 1;
+  }
+
+  if(divby0) {
+    /* s1 & s2Vec's cannot all be zero when taking spin derivatives, because naturally
+       some s1Vec's & s2Vec's appear in denominators of exact deriv expressions.
+    */
+    const double epsilon_spin=1e-14;
+    if(fabs(s1Vec->data[0] + s2Vec->data[0])<epsilon_spin &&
+       fabs(s1Vec->data[1] + s2Vec->data[1])<epsilon_spin &&
+       fabs(s1Vec->data[2] + s2Vec->data[2])<epsilon_spin) {
+      s1Vec->data[0] = epsilon_spin;
+      s1Vec->data[1] = epsilon_spin;
+      s1Vec->data[2] = epsilon_spin;
+      s2Vec->data[0] = epsilon_spin;
+      s2Vec->data[1] = epsilon_spin;
+      s2Vec->data[2] = epsilon_spin;
+    }
+  }
+  const REAL8 etainv = 1.0/eta;
+
+  /* SEOBNRv3_opt: Must define the seob coeffs constants for spin derivatives */
+  UNUSED REAL8 c0k2 = seobCoeffConsts->a0k2;
+  UNUSED REAL8 c1k2 = seobCoeffConsts->a1k2;
+  UNUSED REAL8 c0k3 = seobCoeffConsts->a0k3;
+  UNUSED REAL8 c1k3 = seobCoeffConsts->a1k3;
+  UNUSED REAL8 c0k4 = seobCoeffConsts->a0k4;
+  UNUSED REAL8 c1k4 = seobCoeffConsts->a1k4;
+  UNUSED REAL8 c2k4 = seobCoeffConsts->a2k4;
+  UNUSED REAL8 c0k5 = seobCoeffConsts->a0k5;
+  UNUSED REAL8 c1k5 = seobCoeffConsts->a1k5;
+  UNUSED REAL8 c2k5 = seobCoeffConsts->a2k5;
+
+  #include "seobnrv3_opt_exactderivs/exact_derivatives-HrealHeader.c"
+
+  /* The generated expressions handle any value of the tortoise flag */
+  INT4 tortoise = params->tortoise;
+  REAL8 result = 0.;
+  {
+    #include "seobnrv3_opt_exactderivs/exact_derivatives-Hreal.c"
+    switch (paramIdx) {
+    case 0: {
+      #include "seobnrv3_opt_exactderivs/exact_derivatives-x.c"
+      result=Hrealprm*etainv;} break;
+    case 1: {
+      #include "seobnrv3_opt_exactderivs/exact_derivatives-y.c"
+      result=Hrealprm*etainv;} break;
+    case 2: {
+      #include "seobnrv3_opt_exactderivs/exact_derivatives-z.c"
+      result=Hrealprm*etainv;} break;
+    case 3: {
+      #include "seobnrv3_opt_exactderivs/exact_derivatives-px.c"
+      result=Hrealprm*etainv;} break;
+    case 4: {
+      #include "seobnrv3_opt_exactderivs/exact_derivatives-py.c"
+      result=Hrealprm*etainv;} break;
+    default: {
+      #include "seobnrv3_opt_exactderivs/exact_derivatives-pz.c"
+      result=Hrealprm*etainv;} break;
+    }
+  }
+
+  if(isnan(result)){
+    XLALPrintError("XLALSpinPrecHcapExactDerivWRTParam failed!\n");
+    XLALPrintError("NAN in derivative w.r.t. parameter %d | divby0 = %d\n",paramIdx,divby0);
+    XLAL_ERROR_REAL8( XLAL_EFAILED );
+  }
+
+  return result;
+}
+
 UNUSED static INT4 XLALSEOBNRv3_opt_ComputeHamiltonianDerivatives(const REAL8 * valuestort1 , const REAL8 * valuestort2, SpinEOBHCoeffs * coeffs, REAL8 * derivs, SpinEOBParams * params,REAL8 * HReal){
 
   REAL8 mass1 = params->eobParams->m1;
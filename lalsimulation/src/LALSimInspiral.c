@@ -45,6 +45,10 @@
 #include "check_waveform_macros.h"
 #include "LALSimUniversalRelations.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef __GNUC__
 #define UNUSED __attribute__ ((unused))
 #else
@@ -7050,4 +7054,86 @@ int XLALSimInspiralChooseFDWaveformOLD(
 
 /** @} */
 
+/**
+ * @name OpenMP Parallelism Control Routines
+ *
+ * Frequency-domain approximants such as TaylorF2, IMRPhenomC, IMRPhenomD
+ * and IMRPhenomP evaluate each frequency bin independently, and do so in
+ * parallel when lalsimulation is built with OpenMP. These routines set how
+ * many bins a loop must have before it is run in parallel, so that short
+ * waveforms do not pay the cost of starting threads, and how many threads
+ * are used. The settings are global and should be changed before, not
+ * while, waveforms are generated.
+ * @{
+ */
+
+static UINT4 lalSimInspiralOpenMPThreshold = LAL_SIM_INSPIRAL_OPENMP_DEFAULT_THRESHOLD;
+static INT4 lalSimInspiralOpenMPNumThreads = 0;
+
+/**
+ * @brief Sets the minimum number of frequency bins for which the loop
+ * over bins of a frequency-domain waveform runs in parallel.
+ * @param[in] threshold Minimum number of bins; 0 always runs in parallel.
+ * @return XLAL_SUCCESS
+ */
+int XLALSimInspiralSetOpenMPThreshold(UINT4 threshold)
+{
+    lalSimInspiralOpenMPThreshold = threshold;
+    return XLAL_SUCCESS;
+}
+
+/**
+ * @brief Returns the minimum number of frequency bins for which the loop
+ * over bins of a frequency-domain waveform runs in parallel.
+ */
+UINT4 XLALSimInspiralGetOpenMPThreshold(void)
+{
+    return lalSimInspiralOpenMPThreshold;
+}
+
+/**
+ * @brief Sets the number of threads used by the loops over frequency bins
+ * of frequency-domain waveforms.
+ * @param[in] nthreads Number of threads; 0 uses the OpenMP default.
+ * @return XLAL_SUCCESS, or XLAL_FAILURE if nthreads is negative.
+ */
+int XLALSimInspiralSetOpenMPNumThreads(INT4 nthreads)
+{
+    XLAL_CHECK(nthreads >= 0, XLAL_EINVAL, "Number of threads must be non-negative, got %d", nthreads);
+    lalSimInspiralOpenMPNumThreads = nthreads;
+    return XLAL_SUCCESS;
+}
+
+/**
+ * @brief Returns the number of threads used by the loops over frequency
+ * bins of frequency-domain waveforms; 0 means the OpenMP default.
+ */
+INT4 XLALSimInspiralGetOpenMPNumThreads(void)
+{
+    return lalSimInspiralOpenMPNumThreads;
+}
+
+/**
+ * @brief Returns the number of threads with which to run a loop over
+ * frequency bins, for use in the num_threads() clause of the loop.
+ * @param[in] length Number of frequency bins in the loop.
+ * @return 1 if lalsimulation is built without OpenMP or the loop is
+ * shorter than the threshold, else the number of threads to use.
+ */
+int XLALSimInspiralOpenMPThreadsForLength(size_t length)
+{
+#ifdef _OPENMP
+    if (length < lalSimInspiralOpenMPThreshold)
+        return 1;
+    if (lalSimInspiralOpenMPNumThreads > 0)
+        return lalSimInspiralOpenMPNumThreads;
+    return omp_get_max_threads();
+#else
+    (void)length;
+    return 1;
+#endif
+}
+
+/** @} */
+
 /** @} */
@@ -537,6 +537,15 @@ REAL8 XLALSimInspiralTaylorLength(REAL8 deltaT, REAL8 m1, REAL8 m2, REAL8 f_min,
 int XLALSimInspiralTDConditionStage1(REAL8TimeSeries *hplus, REAL8TimeSeries *hcross, REAL8 textra, REAL8 f_min);
 int XLALSimInspiralTDConditionStage2(REAL8TimeSeries *hplus, REAL8TimeSeries *hcross, REAL8 f_min, REAL8 f_max);
 
+/* routines for controlling OpenMP parallelism in frequency-domain waveforms */
+/** Default minimum number of frequency bins for which a loop over bins runs in parallel */
+#define LAL_SIM_INSPIRAL_OPENMP_DEFAULT_THRESHOLD 4096
+int XLALSimInspiralSetOpenMPThreshold(UINT4 threshold);
+UINT4 XLALSimInspiralGetOpenMPThreshold(void);
+int XLALSimInspiralSetOpenMPNumThreads(INT4 nthreads);
+INT4 XLALSimInspiralGetOpenMPNumThreads(void);
+int XLALSimInspiralOpenMPThreadsForLength(size_t length);
+
 /* routines for transforming initial conditions of precessing waveforms */
 int XLALSimInspiralTransformPrecessingNewInitialConditions(REAL8 *incl, REAL8 *S1x, REAL8 *S1y, REAL8 *S1z, REAL8 *S2x, REAL8 *S2y, REAL8 *S2z, const REAL8 thetaJN, const REAL8 phiJL, const REAL8 theta1, const REAL8 theta2, const REAL8 phi12, const REAL8 chi1, const REAL8 chi2, const REAL8 m1, const REAL8 m2, const REAL8 fRef, REAL8 phiRef);
 int XLALSimInspiralTransformPrecessingObsoleteInitialConditions(REAL8 *incl, REAL8 *S1x, REAL8 *S1y, REAL8 *S1z, REAL8 *S2x, REAL8 *S2y, REAL8 *S2z, REAL8 thetaJN, REAL8 phiJL, REAL8 theta1, REAL8 theta2, REAL8 phi12, REAL8 chi1, REAL8 chi2, REAL8 m1, REAL8 m2, REAL8 fRef);
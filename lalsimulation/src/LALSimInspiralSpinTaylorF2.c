@@ -326,8 +326,7 @@ int XLALSimInspiralSpinTaylorF2(
     /* If f_ref = 0, use f_ref = f_low for everything except the phase offset */
     const REAL8 v_ref = f_ref > 0. ? cbrt(piM*f_ref) : cbrt(piM*fStart);
 
-    REAL8 alpha, alpha_ref;
-    COMPLEX16 prec_plus, prec_cross, phasing_fac;
+    REAL8 alpha_ref;
     bool enable_precession = true; /* Handle the non-spinning case separately */
     int mm;
 
@@ -342,7 +341,6 @@ int XLALSimInspiralSpinTaylorF2(
 
     COMPLEX16 SBplus[5]; /* complex sideband factors for plus pol, mm=2 is first entry */
     COMPLEX16 SBcross[5]; /* complex sideband factors for cross pol, mm=2 is first entry */
-    REAL8 emission[5]; /* emission factor for each sideband */
     if ( !XLALSimInspiralWaveformParamsSidebandIsDefault(moreParams))
     {
         for(mm = -2; mm <= 2; mm++)
@@ -503,7 +501,7 @@ int XLALSimInspiralSpinTaylorF2(
         ref_phasing = (pfaN + pfa1 * v_ref +pfa2 * v2ref + pfa3 * v3ref + pfa4 * v4ref) / v5ref + (pfa5 + pfl5 * logvref) + (pfa6 + pfl6 * logvref) * v_ref + pfa7 * v2ref + pfa8 * v3ref;
     } /* end of if (f_ref > 0.) */
 
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(XLALSimInspiralOpenMPThreadsForLength(n - iStart))
     for (i = iStart; i < n; i++) {
         const REAL8 f = i * deltaF;
         const REAL8 v = cbrt(piM*f);
@@ -515,7 +513,9 @@ int XLALSimInspiralSpinTaylorF2(
         REAL8 phasing = (pfaN + pfa1*v + pfa2 * v2 + pfa3 * v3 + pfa4 * v4) / v5 + (pfa5 + pfl5 * logv) + (pfa6 + pfl6 * logv) * v + pfa7 * v2 + pfa8 * v3;
         COMPLEX16 amp = amp0 / (v3 * sqrt(v));
 
-        alpha = enable_precession ? XLALSimInspiralSF2Alpha(v, coeffs) - alpha_ref : 0.;
+        REAL8 emission[5]; /* emission factor for each sideband */
+        COMPLEX16 prec_plus, prec_cross, phasing_fac;
+        const REAL8 alpha = enable_precession ? XLALSimInspiralSF2Alpha(v, coeffs) - alpha_ref : 0.;
 
         COMPLEX16 u = cos(alpha) + 1.0j*sin(alpha);
         XLALSimInspiralSF2Emission(emission, v, coeffs);
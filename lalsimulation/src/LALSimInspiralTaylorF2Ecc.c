@@ -284,7 +284,7 @@ int XLALSimInspiralTaylorF2CoreEcc(
         ref_phasing /= v5ref;
     } /* End of if(f_ref != 0) block */
 
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(XLALSimInspiralOpenMPThreadsForLength(freqs->length))
     for (i = 0; i < freqs->length; i++) {
         const REAL8 f = freqs->data[i];
         const REAL8 v = cbrt(piM*f);
@@ -470,7 +470,7 @@ int XLALSimInspiralTaylorF2Ecc(
     /* extrinsic parameters */
     shft = LAL_TWOPI * (tC.gpsSeconds + 1e-9 * tC.gpsNanoSeconds);
 
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(XLALSimInspiralOpenMPThreadsForLength(n - iStart))
     for (i = iStart; i < n; i++) {
         freqs->data[i-iStart] = i * deltaF;
     }
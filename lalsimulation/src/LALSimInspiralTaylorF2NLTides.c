@@ -469,7 +469,7 @@ int XLALSimInspiralTaylorF2CoreNLTides(
 
     XLALSimInspiralTaylorF2NLPhase( nonlinear_phasing, freqs, Anl1, n1, f1, m1_SI, Anl2, n2, f2, m2_SI );
 
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(XLALSimInspiralOpenMPThreadsForLength(freqs->length))
     for (i = 0; i < freqs->length; i++) {
         const REAL8 f = freqs->data[i];
         const REAL8 v = cbrt(piM*f);
@@ -651,7 +651,7 @@ int XLALSimInspiralTaylorF2NLTides(
     /* extrinsic parameters */
     shft = LAL_TWOPI * (tC.gpsSeconds + 1e-9 * tC.gpsNanoSeconds);
 
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(XLALSimInspiralOpenMPThreadsForLength(n - iStart))
     for (i = iStart; i < n; i++) {
         freqs->data[i-iStart] = i * deltaF;
     }
@@ -24,6 +24,8 @@
 #include <lal/FrequencySeries.h>
 #include <lal/Sequence.h>
 #include <lal/LALConstants.h>
+#include <lal/LALDict.h>
+#include <lal/LALValue.h>
 
 #include "check_waveform_macros.h"
 #include "LALSimInspiralPNCoefficients.c"
@@ -41,8 +43,15 @@ typedef enum {
     INCLINATION = 8
 } CacheVariableDiffersBitmask;
 
+/**
+ * Smallest |cos(i)| of a cached waveform from which a change of phiRef or
+ * inclination is obtained by transformation. Closer to edge-on the cross
+ * polarization carries too little information to be rescaled.
+ */
+#define CACHE_MIN_ABS_COS_INCLINATION 1e-3
+
 static CacheVariableDiffersBitmask CacheArgsDifferenceBitmask(
-        LALSimInspiralWaveformCache *cache,
+        LALSimInspiralWaveformCacheEntry *entry,
         REAL8 phiRef,
         REAL8 deltaTF,
         REAL8 m1,
@@ -60,6 +69,40 @@ static int FrequenciesAreDifferent(
         REAL8Sequence *newFrequencies,
         REAL8Sequence *cachedFrequencies);
 
+static int DictsAreDifferent(
+        LALDict *newPars,
+        LALDict *cachedPars);
+
+static int CacheEntryIsTransformable(
+        LALSimInspiralWaveformCacheEntry *entry,
+        CacheVariableDiffersBitmask changedParams);
+
+static LALSimInspiralWaveformCacheEntry *FindCacheEntry(
+        LALSimInspiralWaveformCache *cache,
+        int timeDomain,
+        CacheVariableDiffersBitmask *changedParams,
+        REAL8 phiRef,
+        REAL8 deltaTF,
+        REAL8 m1, REAL8 m2,
+        REAL8 S1x, REAL8 S1y, REAL8 S1z,
+        REAL8 S2x, REAL8 S2y, REAL8 S2z,
+        REAL8 f_min, REAL8 f_ref, REAL8 f_max,
+        REAL8 r,
+        REAL8 i,
+        LALDict *LALpars,
+        Approximant approximant,
+        REAL8Sequence *frequencies);
+
+static void CacheUnlinkEntry(LALSimInspiralWaveformCache *cache,
+        LALSimInspiralWaveformCacheEntry *entry);
+
+static void CachePushFront(LALSimInspiralWaveformCache *cache,
+        LALSimInspiralWaveformCacheEntry *entry);
+
+static void DestroyCacheEntry(LALSimInspiralWaveformCacheEntry *entry);
+
+static void CacheEvict(LALSimInspiralWaveformCache *cache);
+
 static int StoreTDHCache(LALSimInspiralWaveformCache *cache,
         REAL8TimeSeries *hplus,
         REAL8TimeSeries *hcross,
@@ -100,10 +143,16 @@ static int StoreFDHCache(LALSimInspiralWaveformCache *cache,
  * Returns the waveform in the time domain.
  * The parameters passed must be in SI units.
  *
- * This version allows caching of waveforms. The most recently generated
- * waveform and its parameters are stored. If the next call requests a waveform
- * that can be obtained by a simple transformation, then it is done.
+ * This version allows caching of waveforms. Recently generated waveforms
+ * and their parameters are stored, up to the budget of the cache. If the
+ * requested waveform is stored, or can be obtained from a stored one by a
+ * simple transformation, then it is done.
  * This bypasses the waveform generation and speeds up the code.
+ *
+ * A change of distance is applied to any approximant. Changes of phiRef
+ * and inclination are applied to non-precessing models containing only the
+ * (2,+-2) modes, i.e. TaylorT1-4 with amplitude order 0, EOBNRv2 and
+ * SEOBNRv1.
  */
 int XLALSimInspiralChooseTDWaveformFromCache(
         REAL8TimeSeries **hplus,                /**< +-polarization waveform */
@@ -129,9 +178,11 @@ int XLALSimInspiralChooseTDWaveformFromCache(
 {
     int status;
     size_t j;
-    REAL8 phasediff, dist_ratio, incl_ratio_plus, incl_ratio_cross;
-    REAL8 cosrot, sinrot;
+    REAL8 dist_ratio, plus_old, cross_old, plus_new, cross_new;
+    REAL8 phasediff, cosrot, sinrot;
+    REAL8 a_pp, a_pc, a_cp, a_cc;
     CacheVariableDiffersBitmask changedParams;
+    LALSimInspiralWaveformCacheEntry *entry;
 
     // If nonGRparams are not NULL, don't even try to cache.
     if ( !XLALSimInspiralWaveformParamsNonGRAreDefault(LALpars) || (!cache) )
@@ -140,30 +191,14 @@ int XLALSimInspiralChooseTDWaveformFromCache(
 					     r, i, phiRef, 0., 0., 0., deltaT, f_min, f_ref, LALpars,
 					     approximant);
 
-    // Check which parameters have changed
-    changedParams = CacheArgsDifferenceBitmask(cache, phiRef, deltaT,
+    // Look for a cached waveform which is identical or can be transformed
+    entry = FindCacheEntry(cache, 1, &changedParams, phiRef, deltaT,
             m1, m2, S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, 0., r, i,
             LALpars, approximant, NULL);
 
-    // No parameters have changed! Copy the cached polarizations
-    if( changedParams == NO_DIFFERENCE ) {
-        *hplus = XLALCutREAL8TimeSeries(cache->hplus, 0,
-                cache->hplus->data->length);
-        if (*hplus == NULL) return XLAL_ENOMEM;
-        *hcross = XLALCutREAL8TimeSeries(cache->hcross, 0,
-                cache->hcross->data->length);
-        if (*hcross == NULL) {
-            XLALDestroyREAL8TimeSeries(*hplus);
-            *hplus = NULL;
-            return XLAL_ENOMEM;
-        }
-
-        return XLAL_SUCCESS;
-    }
-
-    // Intrinsic parameters have changed. We must generate a new waveform
-    if( (changedParams & INTRINSIC) != 0 ) {
-
+    // Nothing usable is cached. We must generate a new waveform
+    if( entry == NULL ) {
+        cache->misses++;
         status = XLALSimInspiralChooseTDWaveform(hplus, hcross, m1, m2, S1x, S1y, S1z, S2x, S2y, S2z,
 						 r, i, phiRef, 0., 0., 0., deltaT, f_min, f_ref, LALpars,
 						 approximant);
@@ -174,240 +209,76 @@ int XLALSimInspiralChooseTDWaveformFromCache(
 			     S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, r, i, LALpars, approximant);
     }
 
-    INT4 ampO=XLALSimInspiralWaveformParamsLookupPNAmplitudeOrder(LALpars);
-    // case 1: Precessing waveforms
-    if( approximant == SpinTaylorT4 || approximant == SpinTaylorT2 ) {
-        // If polarizations are not cached we must generate a fresh waveform
-        // FIXME: Will need to check hlms and/or dynamical variables as well
-        if( cache->hplus == NULL || cache->hcross == NULL) {
-            status = XLALSimInspiralChooseTDWaveform(hplus, hcross, m1, m2,
-						     S1x, S1y, S1z, S2x, S2y, S2z, r, i,
-						     phiRef, 0., 0., 0., deltaT, f_min, f_ref, LALpars,
-						     approximant);
-            if (status == XLAL_FAILURE) return status;
-
-            // FIXME: Need to add hlms, dynamic variables, etc. in cache
-            return StoreTDHCache(cache, *hplus, *hcross, phiRef, deltaT, m1, m2,
-                    S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, r, i,
-		    LALpars, approximant);
-        }
-
-        if( changedParams & INCLINATION ) {
-            // FIXME: For now just treat as intrinsic parameter.
-            // Will come back and put in transformation
-            status = XLALSimInspiralChooseTDWaveform(hplus, hcross, m1, m2,
-						     S1x, S1y, S1z, S2x, S2y, S2z, r, i,
-						     phiRef, 0., 0., 0., deltaT, f_min, f_ref,
-						     LALpars, approximant);
-            if (status == XLAL_FAILURE) return status;
-
-            // FIXME: Need to add hlms, dynamic variables, etc. in cache
-            return StoreTDHCache(cache, *hplus, *hcross, phiRef, deltaT, m1, m2,
-                    S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, r, i,
-                    LALpars, approximant);
-        }
-        if( changedParams & PHI_REF ) {
-            // FIXME: For now just treat as intrinsic parameter.
-            // Will come back and put in transformation
-            status = XLALSimInspiralChooseTDWaveform(hplus, hcross, m1, m2,
-						     S1x, S1y, S1z, S2x, S2y, S2z, r, i,
-						     phiRef, 0., 0., 0., deltaT, f_min, f_ref,
-						     LALpars, approximant);
-            if (status == XLAL_FAILURE) return status;
-
-            // FIXME: Need to add hlms, dynamic variables, etc. in cache
-            return StoreTDHCache(cache, *hplus, *hcross, phiRef, deltaT, m1, m2,
-                    S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, r, i,
-		    LALpars, approximant);
-        }
-        if( (changedParams & DISTANCE) != 0 ) {
-            // Return rescaled copy of cached polarizations
-            dist_ratio = cache->r / r;
-            *hplus = XLALCreateREAL8TimeSeries(cache->hplus->name,
-                    &(cache->hplus->epoch), cache->hplus->f0,
-                    cache->hplus->deltaT, &(cache->hplus->sampleUnits),
-                    cache->hplus->data->length);
-            if (*hplus == NULL) return XLAL_ENOMEM;
-
-            *hcross = XLALCreateREAL8TimeSeries(cache->hcross->name,
-                    &(cache->hcross->epoch), cache->hcross->f0,
-                    cache->hcross->deltaT, &(cache->hcross->sampleUnits),
-                    cache->hcross->data->length);
-            if (*hcross == NULL) {
-                XLALDestroyREAL8TimeSeries(*hplus);
-                *hplus = NULL;
-                return XLAL_ENOMEM;
-            }
-
-            for (j = 0; j < cache->hplus->data->length; j++) {
-                (*hplus)->data->data[j] = cache->hplus->data->data[j]
-                        * dist_ratio;
-                (*hcross)->data->data[j] = cache->hcross->data->data[j]
-                        * dist_ratio;
-            }
-        }
-
-        return XLAL_SUCCESS;
-    }
-
-    // case 2: Non-precessing, ampO = 0
-    else if( ampO==0 && (approximant==TaylorT1 || approximant==TaylorT2
-                || approximant==TaylorT3 || approximant==TaylorT4
-                || approximant==EOBNRv2 || approximant==SEOBNRv1) ) {
-        // If polarizations are not cached we must generate a fresh waveform
-        if( cache->hplus == NULL || cache->hcross == NULL) {
-            status = XLALSimInspiralChooseTDWaveform(hplus, hcross, m1, m2,
-						     S1x, S1y, S1z, S2x, S2y, S2z, r, i,
-						     phiRef, 0., 0., 0., deltaT, f_min, f_ref, LALpars, approximant);
-            if (status == XLAL_FAILURE) return status;
-
-            // FIXME: Need to add hlms, dynamic variables, etc. in cache
-            return StoreTDHCache(cache, *hplus, *hcross, phiRef, deltaT, m1, m2,
-                    S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, r, i,
-                    LALpars, approximant);
-        }
-
-        // Set transformation coefficients for identity transformation.
-        // We'll adjust them depending on which extrinsic parameters changed.
-        dist_ratio = incl_ratio_plus = incl_ratio_cross = cosrot = 1.;
-        phasediff = sinrot = 0.;
-
-        if( changedParams & PHI_REF ) {
-            // Only 2nd harmonic present, so {h+,hx} rotates by 2*deltaphiRef
-            phasediff = 2.*(phiRef - cache->phiRef);
-            cosrot = cos(phasediff);
-            sinrot = sin(phasediff);
-        }
-        if( changedParams & INCLINATION) {
-            // Rescale h+, hx by ratio of new/old inclination dependence
-            incl_ratio_plus = (1.0 + cos(i)*cos(i))
-                    / (1.0 + cos(cache->i)*cos(cache->i));
-            incl_ratio_cross = cos(i) / cos(cache->i);
-        }
-        if( changedParams & DISTANCE ) {
-            // Rescale h+, hx by ratio of (1/new_dist)/(1/old_dist) = old/new
-            dist_ratio = cache->r / r;
-        }
-
-        // Create the output polarizations
-        *hplus = XLALCreateREAL8TimeSeries(cache->hplus->name,
-                &(cache->hplus->epoch), cache->hplus->f0,
-                cache->hplus->deltaT, &(cache->hplus->sampleUnits),
-                cache->hplus->data->length);
+    // No parameters have changed! Copy the cached polarizations
+    if( changedParams == NO_DIFFERENCE ) {
+        cache->hits++;
+        *hplus = XLALCutREAL8TimeSeries(entry->hplus, 0,
+                entry->hplus->data->length);
         if (*hplus == NULL) return XLAL_ENOMEM;
-        *hcross = XLALCreateREAL8TimeSeries(cache->hcross->name,
-                &(cache->hcross->epoch), cache->hcross->f0,
-                cache->hcross->deltaT, &(cache->hcross->sampleUnits),
-                cache->hcross->data->length);
+        *hcross = XLALCutREAL8TimeSeries(entry->hcross, 0,
+                entry->hcross->data->length);
         if (*hcross == NULL) {
             XLALDestroyREAL8TimeSeries(*hplus);
             *hplus = NULL;
             return XLAL_ENOMEM;
         }
 
-        // Get new polarizations by transforming the old
-        incl_ratio_plus *= dist_ratio;
-        incl_ratio_cross *= dist_ratio;
-        // FIXME: Do changing phiRef and inclination commute?!?!
-        for (j = 0; j < cache->hplus->data->length; j++) {
-            (*hplus)->data->data[j] = incl_ratio_plus
-                    * (cosrot*cache->hplus->data->data[j]
-                    - sinrot*cache->hcross->data->data[j]);
-            (*hcross)->data->data[j] = incl_ratio_cross
-                    * (sinrot*cache->hplus->data->data[j]
-                    + cosrot*cache->hcross->data->data[j]);
-        }
-
         return XLAL_SUCCESS;
     }
-    // case 3: Non-precessing, ampO > 0
-    // FIXME: EOBNRv2HM actually ignores ampO. If it's given with ampO==0,
-    // it will fall to the catch-all and not be cached.
-    else if( (ampO==-1 || ampO>0) && (approximant==TaylorT1
-                || approximant==TaylorT2 || approximant==TaylorT3
-                || approximant==TaylorT4 || approximant==EOBNRv2HM) ) {
-        // If polarizations are not cached we must generate a fresh waveform
-        // FIXME: Add in check that hlms non-NULL
-        if( cache->hplus == NULL || cache->hcross == NULL) {
-            // FIXME: This will change to a code-path: inputs->hlms->{h+,hx}
-            status = XLALSimInspiralChooseTDWaveform(hplus, hcross, m1, m2,
-						     S1x, S1y, S1z, S2x, S2y, S2z, r, i,
-						     phiRef, 0., 0., 0., deltaT, f_min, f_ref, LALpars, approximant);
-            if (status == XLAL_FAILURE) return status;
-
-            // FIXME: Need to add hlms, dynamic variables, etc. in cache
-            return StoreTDHCache(cache, *hplus, *hcross, phiRef, deltaT, m1, m2,
-                    S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, r, i,
-                    LALpars, approximant);
-        }
-
-        if( changedParams & INCLINATION) {
-            // FIXME: For now just treat as intrinsic parameter.
-            // Will come back and put in transformation
-            status = XLALSimInspiralChooseTDWaveform(hplus, hcross, m1, m2,
-						     S1x, S1y, S1z, S2x, S2y, S2z, r, i,
-						     phiRef, 0., 0., 0., deltaT, f_min, f_ref, LALpars, approximant);
-            if (status == XLAL_FAILURE) return status;
 
-            // FIXME: Need to add hlms, dynamic variables, etc. in cache
-            return StoreTDHCache(cache, *hplus, *hcross, phiRef, deltaT, m1, m2,
-                    S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, r, i,
-                    LALpars, approximant);
-
-        }
-        if( changedParams & PHI_REF ) {
-            // FIXME: For now just treat as intrinsic parameter.
-            // Will come back and put in transformation
-            status = XLALSimInspiralChooseTDWaveform(hplus, hcross, m1, m2,
-						     S1x, S1y, S1z, S2x, S2y, S2z, r, i,
-						     phiRef, 0., 0., 0., deltaT, f_min, f_ref, LALpars,
-						     approximant);
-            if (status == XLAL_FAILURE) return status;
-
-            // FIXME: Need to add hlms, dynamic variables, etc. in cache
-            return StoreTDHCache(cache, *hplus, *hcross, phiRef, deltaT, m1, m2,
-                    S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, r, i,
-                    LALpars, approximant);
-
-        }
-        if( changedParams & DISTANCE ) {
-            // Return rescaled copy of cached polarizations
-            dist_ratio = cache->r / r;
-            *hplus = XLALCreateREAL8TimeSeries(cache->hplus->name,
-                    &(cache->hplus->epoch), cache->hplus->f0,
-                    cache->hplus->deltaT, &(cache->hplus->sampleUnits),
-                    cache->hplus->data->length);
-            if (*hplus == NULL) return XLAL_ENOMEM;
-
-            *hcross = XLALCreateREAL8TimeSeries(cache->hcross->name,
-                    &(cache->hcross->epoch), cache->hcross->f0,
-                    cache->hcross->deltaT, &(cache->hcross->sampleUnits),
-                    cache->hcross->data->length);
-            if (*hcross == NULL) {
-                XLALDestroyREAL8TimeSeries(*hplus);
-                *hplus = NULL;
-                return XLAL_ENOMEM;
-            }
-
-            for (j = 0; j < cache->hplus->data->length; j++) {
-                (*hplus)->data->data[j] = cache->hplus->data->data[j]
-                        * dist_ratio;
-                (*hcross)->data->data[j] = cache->hcross->data->data[j]
-                        * dist_ratio;
-            }
-        }
+    cache->transforms++;
+
+    // Rescale h+, hx by ratio of (1/new_dist)/(1/old_dist) = old/new
+    dist_ratio = entry->r / r;
+
+    // Set transformation coefficients for a pure change of distance.
+    a_pp = a_cc = dist_ratio;
+    a_pc = a_cp = 0.;
+
+    if( changedParams & (PHI_REF | INCLINATION) ) {
+        // Only 2nd harmonic present, so h+ / (1 + cos^2 i) and
+        // hx / (2 cos i) rotate into each other by 2*deltaphiRef.
+        // Normalise the cached polarizations by the old inclination
+        // dependence, rotate, and apply the new inclination dependence.
+        plus_old = 1.0 + cos(entry->i)*cos(entry->i);
+        cross_old = 2.0 * cos(entry->i);
+        plus_new = 1.0 + cos(i)*cos(i);
+        cross_new = 2.0 * cos(i);
+        phasediff = 2.*(phiRef - entry->phiRef);
+        cosrot = cos(phasediff);
+        sinrot = sin(phasediff);
+
+        a_pp = dist_ratio * plus_new * cosrot / plus_old;
+        a_pc = - dist_ratio * plus_new * sinrot / cross_old;
+        a_cp = dist_ratio * cross_new * sinrot / plus_old;
+        a_cc = dist_ratio * cross_new * cosrot / cross_old;
+    }
 
-        return XLAL_SUCCESS;
+    // Create the output polarizations
+    *hplus = XLALCreateREAL8TimeSeries(entry->hplus->name,
+            &(entry->hplus->epoch), entry->hplus->f0,
+            entry->hplus->deltaT, &(entry->hplus->sampleUnits),
+            entry->hplus->data->length);
+    if (*hplus == NULL) return XLAL_ENOMEM;
+    *hcross = XLALCreateREAL8TimeSeries(entry->hcross->name,
+            &(entry->hcross->epoch), entry->hcross->f0,
+            entry->hcross->deltaT, &(entry->hcross->sampleUnits),
+            entry->hcross->data->length);
+    if (*hcross == NULL) {
+        XLALDestroyREAL8TimeSeries(*hplus);
+        *hplus = NULL;
+        return XLAL_ENOMEM;
     }
 
-    // Catch-all. Unsure what to do, don't try to cache.
-    // Basically, you requested a waveform type which is not setup for caching
-    // b/c of lack of interest or it's unclear what/how to cache for that model
-    else {
-        return XLALSimInspiralChooseTDWaveform(hplus, hcross, m1, m2,
-					       S1x, S1y, S1z, S2x, S2y, S2z, r, i,
-					       phiRef, 0., 0., 0., deltaT, f_min, f_ref, LALpars, approximant);
+    // Get new polarizations by transforming the old
+    for (j = 0; j < entry->hplus->data->length; j++) {
+        (*hplus)->data->data[j] = a_pp * entry->hplus->data->data[j]
+                + a_pc * entry->hcross->data->data[j];
+        (*hcross)->data->data[j] = a_cp * entry->hplus->data->data[j]
+                + a_cc * entry->hcross->data->data[j];
     }
+
+    return XLAL_SUCCESS;
 }
 
 /**
@@ -415,10 +286,17 @@ int XLALSimInspiralChooseTDWaveformFromCache(
  * Returns the waveform in the frequency domain.
  * The parameters passed must be in SI units.
  *
- * This version allows caching of waveforms. The most recently generated
- * waveform and its parameters are stored. If the next call requests a waveform
- * that can be obtained by a simple transformation, then it is done.
+ * This version allows caching of waveforms. Recently generated waveforms
+ * and their parameters are stored, up to the budget of the cache. If the
+ * requested waveform is stored, or can be obtained from a stored one by a
+ * simple transformation, then it is done.
  * This bypasses the waveform generation and speeds up the code.
+ *
+ * A change of distance is applied to any approximant. Changes of phiRef
+ * and inclination are applied to non-precessing models containing only the
+ * (2,+-2) modes, i.e. TaylorF2, TaylorF2RedSpin, TaylorF2RedSpinTidal,
+ * IMRPhenomA, IMRPhenomB, IMRPhenomC, IMRPhenomD and the SEOBNRv1, SEOBNRv2
+ * and SEOBNRv4 reduced order models.
  */
 int XLALSimInspiralChooseFDWaveformFromCache(
         COMPLEX16FrequencySeries **hptilde,     /**< +-polarization waveform */
@@ -446,9 +324,10 @@ int XLALSimInspiralChooseFDWaveformFromCache(
 {
     int status;
     size_t j;
-    REAL8 dist_ratio, incl_ratio_plus, incl_ratio_cross, phase_diff;
-    COMPLEX16 exp_dphi;
+    REAL8 dist_ratio, incl_ratio_plus, incl_ratio_cross;
+    COMPLEX16 exp_dphi, plus_factor, cross_factor;
     CacheVariableDiffersBitmask changedParams;
+    LALSimInspiralWaveformCacheEntry *entry;
 
 
     // If nonGRparams are not NULL, don't even try to cache.
@@ -466,29 +345,14 @@ int XLALSimInspiralChooseFDWaveformFromCache(
 				approximant);
     }
 
-    // Check which parameters have changed
-    changedParams = CacheArgsDifferenceBitmask(cache, phiRef, deltaF,
+    // Look for a cached waveform which is identical or can be transformed
+    entry = FindCacheEntry(cache, 0, &changedParams, phiRef, deltaF,
             m1, m2, S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, f_max, r, i,
 	    LALpars, approximant, frequencies);
 
-    // No parameters have changed! Copy the cached polarizations
-    if( changedParams == NO_DIFFERENCE ) {
-        *hptilde = XLALCutCOMPLEX16FrequencySeries(cache->hptilde, 0,
-                cache->hptilde->data->length);
-        if (*hptilde == NULL) return XLAL_ENOMEM;
-        *hctilde = XLALCutCOMPLEX16FrequencySeries(cache->hctilde, 0,
-                cache->hctilde->data->length);
-        if (*hctilde == NULL) {
-            XLALDestroyCOMPLEX16FrequencySeries(*hptilde);
-            *hptilde = NULL;
-            return XLAL_ENOMEM;
-        }
-
-        return XLAL_SUCCESS;
-    }
-
-    // Intrinsic parameters have changed. We must generate a new waveform
-    if( (changedParams & INTRINSIC) != 0 ) {
+    // Nothing usable is cached. We must generate a new waveform
+    if( entry == NULL ) {
+        cache->misses++;
         if ( frequencies != NULL ){
             status =  XLALSimInspiralChooseFDWaveformSequence(hptilde, hctilde, phiRef,
                 m1, m2, S1x, S1y, S1z, S2x, S2y, S2z, f_ref,
@@ -507,118 +371,89 @@ int XLALSimInspiralChooseFDWaveformFromCache(
 			     S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, f_max, r, i, LALpars, approximant, frequencies);
     }
 
-    // case 1: Non-precessing, 2nd harmonic only
-    if( approximant == TaylorF2 || approximant == TaylorF2RedSpin
-                || approximant == TaylorF2RedSpinTidal
-                || approximant == IMRPhenomA || approximant == IMRPhenomB
-                || approximant == IMRPhenomC ) {
-        // If polarizations are not cached we must generate a fresh waveform
-        // FIXME: Will need to check hlms and/or dynamical variables as well
-        if( cache->hptilde == NULL || cache->hctilde == NULL) {
-            if ( frequencies != NULL ){
-                status =  XLALSimInspiralChooseFDWaveformSequence(hptilde, hctilde, phiRef,
-                    m1, m2, S1x, S1y, S1z, S2x, S2y, S2z, f_ref,
-		    r, i, LALpars, approximant,frequencies);
-            }
-            else {
-	      status = XLALSimInspiralChooseFDWaveform(hptilde, hctilde, m1, m2,
-						       S1x, S1y, S1z, S2x, S2y, S2z, r, i, phiRef,
-						       0., 0., 0., deltaF, f_min, f_max, f_ref,
-						       LALpars, approximant);
-            }
-            if (status == XLAL_FAILURE) return status;
-
-            return StoreFDHCache(cache, *hptilde, *hctilde, phiRef, deltaF,
-                    m1, m2, S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, f_max, r, i,
-                    LALpars, approximant, frequencies);
-        }
-
-        // Set transformation coefficients for identity transformation.
-        // We'll adjust them depending on which extrinsic parameters changed.
-        dist_ratio = incl_ratio_plus = incl_ratio_cross = 1.;
-        phase_diff = 0.;
-        exp_dphi = 1.;
-
-        if( changedParams & PHI_REF ) {
-            // Only 2nd harmonic present, so {h+,hx} \propto e^(2 i phiRef)
-            phase_diff = 2.*(phiRef - cache->phiRef);
-            exp_dphi = cpolar(1., phase_diff);
-        }
-        if( changedParams & INCLINATION) {
-            // Rescale h+, hx by ratio of new/old inclination dependence
-            incl_ratio_plus = (1.0 + cos(i)*cos(i))
-                    / (1.0 + cos(cache->i)*cos(cache->i));
-            incl_ratio_cross = cos(i) / cos(cache->i);
-        }
-        if( changedParams & DISTANCE ) {
-            // Rescale h+, hx by ratio of (1/new_dist)/(1/old_dist) = old/new
-            dist_ratio = cache->r / r;
-        }
-
-        // Create the output polarizations
-        *hptilde = XLALCreateCOMPLEX16FrequencySeries(cache->hptilde->name,
-                &(cache->hptilde->epoch), cache->hptilde->f0,
-                cache->hptilde->deltaF, &(cache->hptilde->sampleUnits),
-                cache->hptilde->data->length);
+    // No parameters have changed! Copy the cached polarizations
+    if( changedParams == NO_DIFFERENCE ) {
+        cache->hits++;
+        *hptilde = XLALCutCOMPLEX16FrequencySeries(entry->hptilde, 0,
+                entry->hptilde->data->length);
         if (*hptilde == NULL) return XLAL_ENOMEM;
-
-        *hctilde = XLALCreateCOMPLEX16FrequencySeries(cache->hctilde->name,
-                &(cache->hctilde->epoch), cache->hctilde->f0,
-                cache->hctilde->deltaF, &(cache->hctilde->sampleUnits),
-                cache->hctilde->data->length);
+        *hctilde = XLALCutCOMPLEX16FrequencySeries(entry->hctilde, 0,
+                entry->hctilde->data->length);
         if (*hctilde == NULL) {
             XLALDestroyCOMPLEX16FrequencySeries(*hptilde);
             *hptilde = NULL;
             return XLAL_ENOMEM;
         }
 
-        // Get new polarizations by transforming the old
-        incl_ratio_plus *= dist_ratio;
-        incl_ratio_cross *= dist_ratio;
-        for (j = 0; j < cache->hptilde->data->length; j++) {
-            (*hptilde)->data->data[j] = exp_dphi * incl_ratio_plus
-                    * cache->hptilde->data->data[j];
-            (*hctilde)->data->data[j] = exp_dphi * incl_ratio_cross
-                    * cache->hctilde->data->data[j];
-        }
-
         return XLAL_SUCCESS;
     }
 
-    // case 2: Precessing
-    /*else if( approximant == SpinTaylorF2 ) {
+    cache->transforms++;
 
-    }*/
+    // Set transformation coefficients for identity transformation.
+    // We'll adjust them depending on which extrinsic parameters changed.
+    incl_ratio_plus = incl_ratio_cross = 1.;
+    exp_dphi = 1.;
 
-    // Catch-all. Unsure what to do, don't try to cache.
-    // Basically, you requested a waveform type which is not setup for caching
-    // b/c of lack of interest or it's unclear what/how to cache for that model
-    else {
-        if ( frequencies != NULL ){
-            return XLALSimInspiralChooseFDWaveformSequence(hptilde, hctilde, phiRef,
-                    m1, m2, S1x, S1y, S1z, S2x, S2y, S2z, f_ref,
-                    r, i, LALpars, approximant,frequencies);
-        }
-        else {
-	  return XLALSimInspiralChooseFDWaveform(hptilde, hctilde, m1, m2,
-						 S1x, S1y, S1z, S2x, S2y, S2z,
-						 r, i, phiRef, 0., 0., 0.,
-						 deltaF, f_min, f_max, f_ref,
-						 NULL, approximant);
-        }
+    if( changedParams & PHI_REF ) {
+        // Only 2nd harmonic present, so {h+,hx} \propto e^(2 i phiRef)
+        exp_dphi = cpolar(1., 2.*(phiRef - entry->phiRef));
+    }
+    if( changedParams & INCLINATION) {
+        // Rescale h+, hx by ratio of new/old inclination dependence
+        incl_ratio_plus = (1.0 + cos(i)*cos(i))
+                / (1.0 + cos(entry->i)*cos(entry->i));
+        incl_ratio_cross = cos(i) / cos(entry->i);
+    }
+    // Rescale h+, hx by ratio of (1/new_dist)/(1/old_dist) = old/new
+    dist_ratio = entry->r / r;
+
+    // Create the output polarizations
+    *hptilde = XLALCreateCOMPLEX16FrequencySeries(entry->hptilde->name,
+            &(entry->hptilde->epoch), entry->hptilde->f0,
+            entry->hptilde->deltaF, &(entry->hptilde->sampleUnits),
+            entry->hptilde->data->length);
+    if (*hptilde == NULL) return XLAL_ENOMEM;
+
+    *hctilde = XLALCreateCOMPLEX16FrequencySeries(entry->hctilde->name,
+            &(entry->hctilde->epoch), entry->hctilde->f0,
+            entry->hctilde->deltaF, &(entry->hctilde->sampleUnits),
+            entry->hctilde->data->length);
+    if (*hctilde == NULL) {
+        XLALDestroyCOMPLEX16FrequencySeries(*hptilde);
+        *hptilde = NULL;
+        return XLAL_ENOMEM;
+    }
+
+    // Get new polarizations by transforming the old
+    plus_factor = exp_dphi * incl_ratio_plus * dist_ratio;
+    cross_factor = exp_dphi * incl_ratio_cross * dist_ratio;
+    for (j = 0; j < entry->hptilde->data->length; j++) {
+        (*hptilde)->data->data[j] = plus_factor
+                * entry->hptilde->data->data[j];
+        (*hctilde)->data->data[j] = cross_factor
+                * entry->hctilde->data->data[j];
     }
 
+    return XLAL_SUCCESS;
 }
 
 /**
  * Construct and initialize a waveform cache.  Caches are used to
  * avoid re-computation of waveforms that differ only by simple
- * scaling relations in extrinsic parameters.
+ * scaling relations in extrinsic parameters. The cache holds at most
+ * #LAL_SIM_INSPIRAL_WAVEFORM_CACHE_DEFAULT_ENTRIES waveforms and
+ * #LAL_SIM_INSPIRAL_WAVEFORM_CACHE_DEFAULT_BYTES bytes; see
+ * XLALSimInspiralWaveformCacheSetBudget() to change this.
  */
 LALSimInspiralWaveformCache *XLALCreateSimInspiralWaveformCache()
 {
     LALSimInspiralWaveformCache *cache = XLALCalloc(1,
             sizeof(LALSimInspiralWaveformCache));
+    if (cache == NULL) XLAL_ERROR_NULL(XLAL_ENOMEM);
+
+    cache->maxEntries = LAL_SIM_INSPIRAL_WAVEFORM_CACHE_DEFAULT_ENTRIES;
+    cache->maxBytes = LAL_SIM_INSPIRAL_WAVEFORM_CACHE_DEFAULT_BYTES;
 
     return cache;
 }
@@ -629,23 +464,56 @@ LALSimInspiralWaveformCache *XLALCreateSimInspiralWaveformCache()
 void XLALDestroySimInspiralWaveformCache(LALSimInspiralWaveformCache *cache)
 {
     if (cache != NULL) {
-        XLALDestroyREAL8TimeSeries(cache->hplus);
-        XLALDestroyREAL8TimeSeries(cache->hcross);
-        XLALDestroyCOMPLEX16FrequencySeries(cache->hptilde);
-        XLALDestroyCOMPLEX16FrequencySeries(cache->hctilde);
-
+        XLALSimInspiralWaveformCacheClear(cache);
         XLALFree(cache);
     }
 }
 
+/**
+ * Set the maximum number of waveforms held by a cache, and the maximum
+ * memory in bytes they may occupy. The least recently used waveforms are
+ * discarded until the cache is within the new budget. A budget of one
+ * entry reproduces a cache of the most recently generated waveform only.
+ */
+int XLALSimInspiralWaveformCacheSetBudget(
+        LALSimInspiralWaveformCache *cache, /**< waveform cache structure */
+        UINT4 maxEntries,                   /**< maximum number of cached waveforms */
+        size_t maxBytes                     /**< maximum memory held by the cached waveforms (bytes) */
+        )
+{
+    XLAL_CHECK(cache != NULL, XLAL_EFAULT);
+
+    cache->maxEntries = maxEntries;
+    cache->maxBytes = maxBytes;
+    CacheEvict(cache);
+
+    return XLAL_SUCCESS;
+}
+
+/**
+ * Discard all waveforms held by a cache. The budget and the hit, transform
+ * and miss counters are left unchanged.
+ */
+void XLALSimInspiralWaveformCacheClear(LALSimInspiralWaveformCache *cache)
+{
+    LALSimInspiralWaveformCacheEntry *entry;
+
+    if (cache == NULL) return;
+
+    while ((entry = cache->head) != NULL) {
+        CacheUnlinkEntry(cache, entry);
+        DestroyCacheEntry(entry);
+    }
+}
+
 /** @} */
 
 /**
- * Function to compare the requested arguments to those stored in the cache,
- * returns a bitmask which determines if a cached waveform can be recycled.
+ * Function to compare the requested arguments to those stored in a cache
+ * entry, returns a bitmask which determines if a cached waveform can be recycled.
  */
 static CacheVariableDiffersBitmask CacheArgsDifferenceBitmask(
-        LALSimInspiralWaveformCache *cache,
+        LALSimInspiralWaveformCacheEntry *entry,
         REAL8 phiRef,
         REAL8 deltaTF,
         REAL8 m1,
@@ -661,35 +529,30 @@ static CacheVariableDiffersBitmask CacheArgsDifferenceBitmask(
         )
 {
     CacheVariableDiffersBitmask difference = NO_DIFFERENCE;
-    if (cache == NULL) return INTRINSIC;
-
-    if ( !XLALSimInspiralWaveformFlagsEqual(LALpars, cache->LALpars) )
-        return INTRINSIC;
-
-    if ( deltaTF != cache->deltaTF) return INTRINSIC;
-    if ( m1 != cache->m1) return INTRINSIC;
-    if ( m2 != cache->m2) return INTRINSIC;
-    if ( S1x != cache->S1x) return INTRINSIC;
-    if ( S1y != cache->S1y) return INTRINSIC;
-    if ( S1z != cache->S1z) return INTRINSIC;
-    if ( S2x != cache->S2x) return INTRINSIC;
-    if ( S2y != cache->S2y) return INTRINSIC;
-    if ( S2z != cache->S2z) return INTRINSIC;
-    if ( f_min != cache->f_min) return INTRINSIC;
-    if ( f_ref != cache->f_ref) return INTRINSIC;
-    if ( f_max != cache->f_max) return INTRINSIC;
-    if ( XLALSimInspiralWaveformParamsLookupTidalLambda1(LALpars) != XLALSimInspiralWaveformParamsLookupTidalLambda1(cache->LALpars)) return INTRINSIC;
-    if ( XLALSimInspiralWaveformParamsLookupTidalLambda2(LALpars) != XLALSimInspiralWaveformParamsLookupTidalLambda2(cache->LALpars)) return INTRINSIC;
-    if ( XLALSimInspiralWaveformParamsLookupPNAmplitudeOrder(LALpars) != XLALSimInspiralWaveformParamsLookupPNAmplitudeOrder(cache->LALpars)) return INTRINSIC;
-    if ( XLALSimInspiralWaveformParamsLookupPNAmplitudeOrder(LALpars) != XLALSimInspiralWaveformParamsLookupPNAmplitudeOrder(cache->LALpars)) return INTRINSIC;
-
-    if ( approximant != cache->approximant) return INTRINSIC;
-
-    if (r != cache->r) difference = difference | DISTANCE;
-    if (phiRef != cache->phiRef) difference = difference | PHI_REF;
-    if (i != cache->i) difference = difference | INCLINATION;
-
-    if (FrequenciesAreDifferent(frequencies,cache->frequencies)) return INTRINSIC;
+    if (entry == NULL) return INTRINSIC;
+
+    if ( approximant != entry->approximant) return INTRINSIC;
+    if ( deltaTF != entry->deltaTF) return INTRINSIC;
+    if ( m1 != entry->m1) return INTRINSIC;
+    if ( m2 != entry->m2) return INTRINSIC;
+    if ( S1x != entry->S1x) return INTRINSIC;
+    if ( S1y != entry->S1y) return INTRINSIC;
+    if ( S1z != entry->S1z) return INTRINSIC;
+    if ( S2x != entry->S2x) return INTRINSIC;
+    if ( S2y != entry->S2y) return INTRINSIC;
+    if ( S2z != entry->S2z) return INTRINSIC;
+    if ( f_min != entry->f_min) return INTRINSIC;
+    if ( f_ref != entry->f_ref) return INTRINSIC;
+    if ( f_max != entry->f_max) return INTRINSIC;
+
+    // Flags, tidal parameters, PN orders etc. all live in the LALDict
+    if ( DictsAreDifferent(LALpars, entry->LALpars) ) return INTRINSIC;
+
+    if (FrequenciesAreDifferent(frequencies,entry->frequencies)) return INTRINSIC;
+
+    if (r != entry->r) difference = difference | DISTANCE;
+    if (phiRef != entry->phiRef) difference = difference | PHI_REF;
+    if (i != entry->i) difference = difference | INCLINATION;
 
     return difference;
 }
@@ -714,6 +577,272 @@ static int FrequenciesAreDifferent(
     return 0;
 }
 
+/**
+ * Function to compare the contents of two LALDicts.
+ * Returns 1 if different, 0 if they hold the same keys and values.
+ * A NULL pointer is treated as an empty dictionary.
+ */
+static int DictsAreDifferent(
+        LALDict *newPars,
+        LALDict *cachedPars
+        )
+{
+    LALDictIter iter;
+    LALDictEntry *item, *cachedItem;
+    size_t newSize = newPars ? XLALDictSize(newPars) : 0;
+    size_t cachedSize = cachedPars ? XLALDictSize(cachedPars) : 0;
+
+    if ( newSize != cachedSize ) return 1;
+    if ( newSize == 0 ) return 0;
+
+    XLALDictIterInit(&iter, newPars);
+    while ( (item = XLALDictIterNext(&iter)) != NULL ) {
+        cachedItem = XLALDictLookup(cachedPars, XLALDictEntryGetKey(item));
+        if ( cachedItem == NULL ) return 1;
+        if ( !XLALValueEqual(XLALDictEntryGetValue(item),
+                    XLALDictEntryGetValue(cachedItem)) ) return 1;
+    }
+    return 0;
+}
+
+/**
+ * Function to determine whether the extrinsic parameters which differ
+ * between a request and a cached waveform can be applied by transforming
+ * the cached polarizations. Returns 1 if so, 0 otherwise.
+ */
+static int CacheEntryIsTransformable(
+        LALSimInspiralWaveformCacheEntry *entry,
+        CacheVariableDiffersBitmask changedParams
+        )
+{
+    Approximant approximant = entry->approximant;
+    INT4 ampO;
+
+    if ( changedParams & INTRINSIC ) return 0;
+
+    // h+, hx \propto 1/distance for every approximant
+    if ( (changedParams & (PHI_REF | INCLINATION)) == 0 ) return 1;
+
+    // Time domain: non-precessing, 2nd harmonic only.
+    // h+ and hx mix under a change of phiRef, so need cos(i) != 0
+    if ( entry->hplus != NULL ) {
+        if ( fabs(cos(entry->i)) < CACHE_MIN_ABS_COS_INCLINATION ) return 0;
+        // EOBNRv2 and SEOBNRv1 only generate the (2,2) mode whatever ampO is
+        if ( approximant == EOBNRv2 || approximant == SEOBNRv1 ) return 1;
+        ampO = XLALSimInspiralWaveformParamsLookupPNAmplitudeOrder(entry->LALpars);
+        return ampO == 0 && (approximant == TaylorT1 || approximant == TaylorT2
+                || approximant == TaylorT3 || approximant == TaylorT4);
+    }
+
+    // Frequency domain: non-precessing, 2nd harmonic only.
+    // hx is rescaled by cos(i) under a change of inclination
+    if ( (changedParams & INCLINATION)
+            && fabs(cos(entry->i)) < CACHE_MIN_ABS_COS_INCLINATION ) return 0;
+    switch ( approximant ) {
+        case TaylorF2:
+        case TaylorF2RedSpin:
+        case TaylorF2RedSpinTidal:
+        case IMRPhenomA:
+        case IMRPhenomB:
+        case IMRPhenomC:
+        case IMRPhenomD:
+        case SEOBNRv1_ROM_EffectiveSpin:
+        case SEOBNRv1_ROM_DoubleSpin:
+        case SEOBNRv2_ROM_EffectiveSpin:
+        case SEOBNRv2_ROM_DoubleSpin:
+        case SEOBNRv2_ROM_DoubleSpin_HI:
+        case SEOBNRv4_ROM:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Search a cache for an entry of the requested domain from which the
+ * requested waveform can be obtained. An identical entry is preferred,
+ * otherwise the most recently used transformable entry is returned. The
+ * returned entry is moved to the front of the cache and the differences
+ * to it are stored in changedParams. Returns NULL if no entry is usable.
+ */
+static LALSimInspiralWaveformCacheEntry *FindCacheEntry(
+        LALSimInspiralWaveformCache *cache,
+        int timeDomain,
+        CacheVariableDiffersBitmask *changedParams,
+        REAL8 phiRef,
+        REAL8 deltaTF,
+        REAL8 m1, REAL8 m2,
+        REAL8 S1x, REAL8 S1y, REAL8 S1z,
+        REAL8 S2x, REAL8 S2y, REAL8 S2z,
+        REAL8 f_min, REAL8 f_ref, REAL8 f_max,
+        REAL8 r,
+        REAL8 i,
+        LALDict *LALpars,
+        Approximant approximant,
+        REAL8Sequence *frequencies
+        )
+{
+    LALSimInspiralWaveformCacheEntry *entry, *found = NULL;
+    CacheVariableDiffersBitmask difference, foundDifference = INTRINSIC;
+
+    for (entry = cache->head; entry != NULL; entry = entry->next) {
+        if ( (entry->hplus != NULL) != (timeDomain != 0) ) continue;
+
+        difference = CacheArgsDifferenceBitmask(entry, phiRef, deltaTF,
+                m1, m2, S1x, S1y, S1z, S2x, S2y, S2z, f_min, f_ref, f_max,
+                r, i, LALpars, approximant, frequencies);
+
+        if ( difference == NO_DIFFERENCE ) {
+            found = entry;
+            foundDifference = difference;
+            break;
+        }
+        if ( found == NULL && CacheEntryIsTransformable(entry, difference) ) {
+            found = entry;
+            foundDifference = difference;
+        }
+    }
+
+    if ( found != NULL && found != cache->head ) {
+        CacheUnlinkEntry(cache, found);
+        CachePushFront(cache, found);
+    }
+
+    *changedParams = foundDifference;
+    return found;
+}
+
+/** Remove an entry from the list of a cache, without destroying it. */
+static void CacheUnlinkEntry(LALSimInspiralWaveformCache *cache,
+        LALSimInspiralWaveformCacheEntry *entry)
+{
+    if (entry->prev != NULL) entry->prev->next = entry->next;
+    else cache->head = entry->next;
+    if (entry->next != NULL) entry->next->prev = entry->prev;
+    else cache->tail = entry->prev;
+    entry->prev = entry->next = NULL;
+
+    cache->nEntries--;
+    cache->bytes -= entry->bytes;
+}
+
+/** Insert an entry at the front (most recently used end) of a cache. */
+static void CachePushFront(LALSimInspiralWaveformCache *cache,
+        LALSimInspiralWaveformCacheEntry *entry)
+{
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head != NULL) cache->head->prev = entry;
+    else cache->tail = entry;
+    cache->head = entry;
+
+    cache->nEntries++;
+    cache->bytes += entry->bytes;
+}
+
+/** Free a cache entry and everything it holds. */
+static void DestroyCacheEntry(LALSimInspiralWaveformCacheEntry *entry)
+{
+    if (entry == NULL) return;
+    XLALDestroyREAL8TimeSeries(entry->hplus);
+    XLALDestroyREAL8TimeSeries(entry->hcross);
+    XLALDestroyCOMPLEX16FrequencySeries(entry->hptilde);
+    XLALDestroyCOMPLEX16FrequencySeries(entry->hctilde);
+    XLALDestroyREAL8Sequence(entry->frequencies);
+    XLALDestroyDict(entry->LALpars);
+    XLALFree(entry);
+}
+
+/** Discard least recently used entries until a cache is within its budget. */
+static void CacheEvict(LALSimInspiralWaveformCache *cache)
+{
+    LALSimInspiralWaveformCacheEntry *entry;
+
+    while ( (entry = cache->tail) != NULL
+            && (cache->nEntries > cache->maxEntries || cache->bytes > cache->maxBytes) ) {
+        CacheUnlinkEntry(cache, entry);
+        DestroyCacheEntry(entry);
+    }
+}
+
+/**
+ * Allocate a cache entry holding the given parameters and a copy of the
+ * contents of LALpars. Returns NULL on failure.
+ */
+static LALSimInspiralWaveformCacheEntry *CreateCacheEntry(
+        REAL8 phiRef,
+        REAL8 deltaTF,
+        REAL8 m1, REAL8 m2,
+        REAL8 S1x, REAL8 S1y, REAL8 S1z,
+        REAL8 S2x, REAL8 S2y, REAL8 S2z,
+        REAL8 f_min, REAL8 f_ref, REAL8 f_max,
+        REAL8 r,
+        REAL8 i,
+        LALDict *LALpars,
+        Approximant approximant
+        )
+{
+    LALDictIter iter;
+    LALDictEntry *item;
+    LALSimInspiralWaveformCacheEntry *entry = XLALCalloc(1,
+            sizeof(LALSimInspiralWaveformCacheEntry));
+    if (entry == NULL) return NULL;
+
+    entry->phiRef = phiRef;
+    entry->deltaTF = deltaTF;
+    entry->m1 = m1;
+    entry->m2 = m2;
+    entry->S1x = S1x;
+    entry->S1y = S1y;
+    entry->S1z = S1z;
+    entry->S2x = S2x;
+    entry->S2y = S2y;
+    entry->S2z = S2z;
+    entry->f_min = f_min;
+    entry->f_ref = f_ref;
+    entry->f_max = f_max;
+    entry->r = r;
+    entry->i = i;
+    entry->approximant = approximant;
+    entry->bytes = sizeof(*entry);
+
+    // Copy the LALDict: the caller is free to modify its own afterwards
+    if (LALpars != NULL) {
+        entry->LALpars = XLALCreateDict();
+        if (entry->LALpars == NULL) {
+            XLALFree(entry);
+            return NULL;
+        }
+        XLALDictIterInit(&iter, LALpars);
+        while ( (item = XLALDictIterNext(&iter)) != NULL ) {
+            if (XLALDictInsertValue(entry->LALpars, XLALDictEntryGetKey(item),
+                        XLALDictEntryGetValue(item)) != XLAL_SUCCESS) {
+                DestroyCacheEntry(entry);
+                return NULL;
+            }
+        }
+    }
+
+    return entry;
+}
+
+/**
+ * Insert a newly-filled entry at the front of a cache and evict entries
+ * until the cache is within budget. An entry which alone exceeds the
+ * budget is not stored.
+ */
+static void CacheInsertEntry(LALSimInspiralWaveformCache *cache,
+        LALSimInspiralWaveformCacheEntry *entry)
+{
+    if (cache->maxEntries == 0 || entry->bytes > cache->maxBytes) {
+        DestroyCacheEntry(entry);
+        return;
+    }
+
+    CachePushFront(cache, entry);
+    CacheEvict(cache);
+}
+
 /** Store the output TD hplus and hcross in the cache. */
 static int StoreTDHCache(LALSimInspiralWaveformCache *cache,
         REAL8TimeSeries *hplus,
@@ -730,54 +859,32 @@ static int StoreTDHCache(LALSimInspiralWaveformCache *cache,
         Approximant approximant
         )
 {
-    /* Clear any frequency-domain data. */
-    if (cache->hptilde != NULL) {
-        XLALDestroyCOMPLEX16FrequencySeries(cache->hptilde);
-        cache->hptilde = NULL;
-    }
+    LALSimInspiralWaveformCacheEntry *entry;
 
-    if (cache->hctilde != NULL) {
-        XLALDestroyCOMPLEX16FrequencySeries(cache->hctilde);
-        cache->hctilde = NULL;
-    }
-
-    /* Store params in cache */
-    cache->phiRef = phiRef;
-    cache->deltaTF = deltaT;
-    cache->m1 = m1;
-    cache->m2 = m2;
-    cache->S1x = S1x;
-    cache->S1y = S1y;
-    cache->S1z = S1z;
-    cache->S2x = S2x;
-    cache->S2y = S2y;
-    cache->S2z = S2z;
-    cache->f_min = f_min;
-    cache->f_ref = f_ref;
-    cache->r = r;
-    cache->i = i;
-    cache->LALpars = LALpars;
-    cache->approximant = approximant;
-    cache->frequencies = NULL;
-
-    // Copy over the waveforms
-    // NB: XLALCut... creates a new Series object and copies data and metadata
-    XLALDestroyREAL8TimeSeries(cache->hplus);
-    XLALDestroyREAL8TimeSeries(cache->hcross);
     if (hplus == NULL || hcross == NULL || hplus->data == NULL || hcross->data == NULL){
         XLALPrintError("We have null pointers for h+, hx in StoreTDHCache \n");
         XLALPrintError("Houston-S, we've got a problem SOS, SOS, SOS, the waveform generator returns NULL!!!... m1 = %.18e, m2 = %.18e, fMin = %.18e, spin1 = {%.18e, %.18e, %.18e},   spin2 = {%.18e, %.18e, %.18e} \n",
                    m1, m2, (double)f_min, S1x, S1y, S1z, S2x, S2y, S2z);
         return XLAL_ENOMEM;
     }
-    cache->hplus = XLALCutREAL8TimeSeries(hplus, 0, hplus->data->length);
-    if (cache->hplus == NULL) return XLAL_ENOMEM;
-    cache->hcross = XLALCutREAL8TimeSeries(hcross, 0, hcross->data->length);
-    if (cache->hcross == NULL) {
-        XLALDestroyREAL8TimeSeries(cache->hplus);
-        cache->hplus = NULL;
+
+    /* Store params in a new cache entry */
+    entry = CreateCacheEntry(phiRef, deltaT, m1, m2, S1x, S1y, S1z,
+            S2x, S2y, S2z, f_min, f_ref, 0., r, i, LALpars, approximant);
+    if (entry == NULL) return XLAL_ENOMEM;
+
+    // Copy over the waveforms
+    // NB: XLALCut... creates a new Series object and copies data and metadata
+    entry->hplus = XLALCutREAL8TimeSeries(hplus, 0, hplus->data->length);
+    entry->hcross = XLALCutREAL8TimeSeries(hcross, 0, hcross->data->length);
+    if (entry->hplus == NULL || entry->hcross == NULL) {
+        DestroyCacheEntry(entry);
         return XLAL_ENOMEM;
     }
+    entry->bytes += (hplus->data->length + hcross->data->length)
+            * sizeof(REAL8);
+
+    CacheInsertEntry(cache, entry);
 
     return XLAL_SUCCESS;
 }
@@ -799,56 +906,36 @@ static int StoreFDHCache(LALSimInspiralWaveformCache *cache,
         REAL8Sequence *frequencies
         )
 {
-    /* Clear any time-domain data. */
-    if (cache->hplus != NULL) {
-        XLALDestroyREAL8TimeSeries(cache->hplus);
-        cache->hplus = NULL;
-    }
+    LALSimInspiralWaveformCacheEntry *entry;
 
-    if (cache->hcross != NULL) {
-        XLALDestroyREAL8TimeSeries(cache->hcross);
-        cache->hcross = NULL;
-    }
+    /* Store params in a new cache entry */
+    entry = CreateCacheEntry(phiRef, deltaT, m1, m2, S1x, S1y, S1z,
+            S2x, S2y, S2z, f_min, f_ref, f_max, r, i, LALpars, approximant);
+    if (entry == NULL) return XLAL_ENOMEM;
 
-    /* Store params in cache */
-    cache->phiRef = phiRef;
-    cache->deltaTF = deltaT;
-    cache->m1 = m1;
-    cache->m2 = m2;
-    cache->S1x = S1x;
-    cache->S1y = S1y;
-    cache->S1z = S1z;
-    cache->S2x = S2x;
-    cache->S2y = S2y;
-    cache->S2z = S2z;
-    cache->f_min = f_min;
-    cache->f_ref = f_ref;
-    cache->f_max = f_max;
-    cache->r = r;
-    cache->i = i;
-    cache->LALpars = LALpars;
-    cache->approximant = approximant;
-
-    XLALDestroyREAL8Sequence(cache->frequencies);
-    cache->frequencies = NULL;
     if (frequencies != NULL){
-        cache->frequencies = XLALCopyREAL8Sequence(frequencies);
+        entry->frequencies = XLALCopyREAL8Sequence(frequencies);
+        if (entry->frequencies == NULL) {
+            DestroyCacheEntry(entry);
+            return XLAL_ENOMEM;
+        }
+        entry->bytes += frequencies->length * sizeof(REAL8);
     }
 
     // Copy over the waveforms
     // NB: XLALCut... creates a new Series object and copies data and metadata
-    XLALDestroyCOMPLEX16FrequencySeries(cache->hptilde);
-    XLALDestroyCOMPLEX16FrequencySeries(cache->hctilde);
-    cache->hptilde = XLALCutCOMPLEX16FrequencySeries(hptilde, 0,
+    entry->hptilde = XLALCutCOMPLEX16FrequencySeries(hptilde, 0,
             hptilde->data->length);
-    if (cache->hptilde == NULL) return XLAL_ENOMEM;
-    cache->hctilde = XLALCutCOMPLEX16FrequencySeries(hctilde, 0,
+    entry->hctilde = XLALCutCOMPLEX16FrequencySeries(hctilde, 0,
             hctilde->data->length);
-    if (cache->hctilde == NULL) {
-        XLALDestroyCOMPLEX16FrequencySeries(cache->hptilde);
-        cache->hptilde = NULL;
+    if (entry->hptilde == NULL || entry->hctilde == NULL) {
+        DestroyCacheEntry(entry);
         return XLAL_ENOMEM;
     }
+    entry->bytes += (hptilde->data->length + hctilde->data->length)
+            * sizeof(COMPLEX16);
+
+    CacheInsertEntry(cache, entry);
 
     return XLAL_SUCCESS;
 }
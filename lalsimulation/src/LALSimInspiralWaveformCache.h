@@ -73,8 +73,13 @@ tagLALSimInspiralWaveformCacheOld {
     REAL8Sequence *frequencies;
 } LALSimInspiralWaveformCacheOld;
 
+/**
+ * One waveform held in a LALSimInspiralWaveformCache, with the parameters
+ * it was generated with. Exactly one of the time-domain or the
+ * frequency-domain pairs of polarizations is set.
+ */
 typedef struct
-tagLALSimInspiralWaveformCache {
+tagLALSimInspiralWaveformCacheEntry {
     REAL8TimeSeries *hplus;
     REAL8TimeSeries *hcross;
     COMPLEX16FrequencySeries *hptilde;
@@ -94,17 +99,50 @@ tagLALSimInspiralWaveformCache {
     REAL8 f_max;
     REAL8 r;
     REAL8 i;
-    LALDict *LALpars;
+    LALDict *LALpars; /**< copy of the LALDict the waveform was generated with */
     Approximant approximant;
     REAL8Sequence *frequencies;
+    size_t bytes; /**< memory held by this entry */
+    struct tagLALSimInspiralWaveformCacheEntry *prev; /**< more recently used entry */
+    struct tagLALSimInspiralWaveformCacheEntry *next; /**< less recently used entry */
+} LALSimInspiralWaveformCacheEntry;
+
+/**
+ * Bounded cache of previously-generated waveforms, with least-recently-used
+ * eviction once either the number of entries or the memory they hold
+ * exceeds its budget. A request is served from the cache if an entry has
+ * the same intrinsic parameters, approximant and LALDict contents, and
+ * differs at most in extrinsic parameters that can be applied by rescaling
+ * or rotating its polarizations.
+ */
+typedef struct
+tagLALSimInspiralWaveformCache {
+    LALSimInspiralWaveformCacheEntry *head; /**< most recently used entry */
+    LALSimInspiralWaveformCacheEntry *tail; /**< least recently used entry */
+    UINT4 nEntries;     /**< number of cached waveforms */
+    UINT4 maxEntries;   /**< maximum number of cached waveforms */
+    size_t bytes;       /**< memory held by the cached waveforms */
+    size_t maxBytes;    /**< maximum memory held by the cached waveforms */
+    UINT8 hits;         /**< requests served by copying a cached waveform */
+    UINT8 transforms;   /**< requests served by transforming a cached waveform */
+    UINT8 misses;       /**< requests for which a waveform was generated */
 } LALSimInspiralWaveformCache;
 
+/** Default maximum number of waveforms held by a cache */
+#define LAL_SIM_INSPIRAL_WAVEFORM_CACHE_DEFAULT_ENTRIES 16
+/** Default maximum memory held by a cache (bytes) */
+#define LAL_SIM_INSPIRAL_WAVEFORM_CACHE_DEFAULT_BYTES (256 * 1024 * 1024)
+
 /** @} */
 
 LALSimInspiralWaveformCache *XLALCreateSimInspiralWaveformCache(void);
 
 void XLALDestroySimInspiralWaveformCache(LALSimInspiralWaveformCache *cache);
 
+int XLALSimInspiralWaveformCacheSetBudget(LALSimInspiralWaveformCache *cache, UINT4 maxEntries, size_t maxBytes);
+
+void XLALSimInspiralWaveformCacheClear(LALSimInspiralWaveformCache *cache);
+
 int XLALSimInspiralChooseTDWaveformFromCache(REAL8TimeSeries **hplus, REAL8TimeSeries **hcross, REAL8 phiRef, REAL8 deltaT, REAL8 m1, REAL8 m2, REAL8 s1x, REAL8 s1y, REAL8 s1z, REAL8 s2x, REAL8 s2y, REAL8 s2z, REAL8 f_min, REAL8 f_ref, REAL8 r, REAL8 i, LALDict *LALpars, Approximant approximant, LALSimInspiralWaveformCache *cache);
 
 int XLALSimInspiralChooseFDWaveformFromCache(COMPLEX16FrequencySeries **hptilde, COMPLEX16FrequencySeries **hctilde, REAL8 phiRef, REAL8 deltaF, REAL8 m1, REAL8 m2, REAL8 S1x, REAL8 S1y, REAL8 S1z, REAL8 S2x, REAL8 S2y, REAL8 S2z, REAL8 f_min, REAL8 f_max, REAL8 f_ref, REAL8 r, REAL8 i, LALDict *LALpars, Approximant approximant, LALSimInspiralWaveformCache *cache, REAL8Sequence *frequencies);
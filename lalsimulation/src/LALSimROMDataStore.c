@@ -0,0 +1,552 @@
+/*
+ *  Copyright (C) 2018 The LALSuite developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with with program; see the file COPYING. If not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ *  MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ *
+ * \brief Internal (not SWIG'd) shared, memory-mapped store for ROM and surrogate data
+ *
+ * ROM and surrogate models load their data from HDF5 files into private heap
+ * arrays, so every process of a parallel analysis holds its own copy and pays
+ * the HDF5 decoding cost at start-up. The functions here convert one group of
+ * such a file, the first time it is requested, into a flat binary cache file
+ * in which each dataset is stored contiguously and 64-byte aligned. The cache
+ * is then mapped read-only and shared, so all processes on a node use the same
+ * physical pages, and only the pages that are actually touched are read from
+ * disk. Caching per group lets a model with several submodels load only those
+ * it evaluates.
+ *
+ * The store is opt-in: it is only used if \c $LAL_SIM_ROM_CACHE_DIR names
+ * the directory, created if necessary, in which to keep the cache. A cache
+ * file records the size and modification time of the file it was made from
+ * and is rebuilt when either changes. Cache files are written under a
+ * temporary name and renamed into place, so concurrent processes never see a
+ * partial file.
+ *
+ * ROMDataStore_OpenGroup() returns NULL whenever the store is disabled or
+ * cannot be used, and callers then fall back to reading the HDF5 file
+ * directly. Each successful call must be matched by ROMDataStore_CloseGroup()
+ * once the views obtained from the group have been released; the group is
+ * unmapped when its last user closes it. ROMDataStore_Cleanup() unmaps all
+ * groups at once.
+ *
+ * NOTE: The convention for naming functions in here is to use
+ * the prefix 'ROMDataStore_'.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <lal/LALConfig.h>
+#include <lal/LALStdlib.h>
+#include <lal/LALString.h>
+#include <lal/AVFactories.h>
+#include <lal/XLALError.h>
+
+#ifdef LAL_HDF5_ENABLED
+#include <lal/H5FileIO.h>
+#endif
+
+#ifdef LAL_PTHREAD_LOCK
+#include <pthread.h>
+#endif
+
+#include "LALSimROMDataStore.h"
+
+#define ROMDATASTORE_MAGIC "LALROMC1"
+#define ROMDATASTORE_VERSION 1
+#define ROMDATASTORE_BYTE_ORDER 0x01020304
+#define ROMDATASTORE_ALIGN 64
+#define ROMDATASTORE_NAME_LEN 64
+#define ROMDATASTORE_PATH_LEN 1024
+
+/* On-disk layout: a header, a table of ndatasets entries, then the data of
+ * each dataset at the ROMDATASTORE_ALIGN-aligned offset given by its entry */
+typedef struct tagROMDataStoreHeader {
+  char magic[8];
+  UINT4 version;
+  UINT4 byte_order;
+  UINT4 ndatasets;
+  UINT4 pad;
+  UINT8 file_size;
+  UINT8 src_size;
+  INT8 src_mtime;
+  char src[ROMDATASTORE_PATH_LEN];
+  char group[ROMDATASTORE_NAME_LEN];
+} ROMDataStoreHeader;
+
+typedef struct tagROMDataStoreEntry {
+  char name[ROMDATASTORE_NAME_LEN];
+  INT4 type;
+  UINT4 ndim;
+  UINT8 dims[2];
+  UINT8 offset;
+  UINT8 nbytes;
+} ROMDataStoreEntry;
+
+struct tagROMDataStoreGroup {
+  char *src;
+  char *group;
+  void *map;
+  size_t size;
+  const ROMDataStoreHeader *header;
+  const ROMDataStoreEntry *entries;
+  UINT4 refcount;
+  struct tagROMDataStoreGroup *next;
+};
+
+/* Groups mapped by this process; a returned group stays valid until it is
+ * closed by its last user or ROMDataStore_Cleanup() is called */
+static ROMDataStoreGroup *ROMDataStore_groups = NULL;
+
+#ifdef LAL_PTHREAD_LOCK
+static pthread_mutex_t ROMDataStore_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static size_t ROMDataStore_Align(size_t n) {
+  return (n + ROMDATASTORE_ALIGN - 1) / ROMDATASTORE_ALIGN * ROMDATASTORE_ALIGN;
+}
+
+/* 64-bit FNV-1a hash, used to give each (file, group) pair its own cache file name */
+static UINT8 ROMDataStore_Hash(UINT8 h, const char *s) {
+  if (h == 0)
+    h = 14695981039346656037ULL;
+  for (; *s; ++s) {
+    h ^= (unsigned char) *s;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+static int ROMDataStore_MakeDir(const char *dir) {
+  if (mkdir(dir, 0755) == 0 || errno == EEXIST)
+    return 0;
+  return -1;
+}
+
+/* Return the cache directory, creating it if needed, or NULL if the store is
+ * disabled or the directory is unusable */
+static char *ROMDataStore_CacheDir(void) {
+  const char *env = getenv(ROMDATASTORE_CACHE_DIR_ENV);
+  char *dir;
+
+  if (!env || *env == '\0')
+    return NULL;
+  dir = XLALStringDuplicate(env);
+  if (!dir)
+    return NULL;
+  if (ROMDataStore_MakeDir(dir) != 0 || access(dir, W_OK | X_OK) != 0) {
+    XLALPrintWarning("%s: cannot use %s=%s as a cache directory\n", __func__, ROMDATASTORE_CACHE_DIR_ENV, env);
+    XLALFree(dir);
+    return NULL;
+  }
+  return dir;
+}
+
+static void ROMDataStore_Free(ROMDataStoreGroup *g) {
+  munmap(g->map, g->size);
+  free(g->src);
+  XLALFree(g->group);
+  XLALFree(g);
+}
+
+/* Map a cache file and check that it is complete and was made from src as it is now */
+static ROMDataStoreGroup *ROMDataStore_Map(const char *cache, const char *src, const char *group, const struct stat *src_st) {
+  ROMDataStoreGroup *g;
+  const ROMDataStoreHeader *h;
+  struct stat st;
+  void *map;
+  int fd;
+
+  fd = open(cache, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(ROMDataStoreHeader)) {
+    close(fd);
+    return NULL;
+  }
+  map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return NULL;
+
+  h = map;
+  if (memcmp(h->magic, ROMDATASTORE_MAGIC, sizeof(h->magic)) != 0
+      || h->version != ROMDATASTORE_VERSION
+      || h->byte_order != ROMDATASTORE_BYTE_ORDER
+      || h->file_size != (UINT8) st.st_size
+      || h->src_size != (UINT8) src_st->st_size
+      || h->src_mtime != (INT8) src_st->st_mtime
+      || strncmp(h->src, src, sizeof(h->src)) != 0
+      || strncmp(h->group, group, sizeof(h->group)) != 0
+      || sizeof(ROMDataStoreHeader) + h->ndatasets * sizeof(ROMDataStoreEntry) > (size_t) st.st_size) {
+    munmap(map, st.st_size);
+    return NULL;
+  }
+
+  g = XLALCalloc(1, sizeof(*g));
+  if (!g) {
+    munmap(map, st.st_size);
+    return NULL;
+  }
+  g->map = map;
+  g->size = st.st_size;
+  g->header = h;
+  g->entries = (const ROMDataStoreEntry *) (h + 1);
+  return g;
+}
+
+#ifdef LAL_HDF5_ENABLED
+/* Write every dataset of group `group' of src to a new cache file at `cache' */
+static int ROMDataStore_Build(const char *cache, const char *src, const char *group, const struct stat *src_st) {
+  ROMDataStoreHeader header;
+  ROMDataStoreEntry *entries = NULL;
+  LALH5File *file = NULL;
+  LALH5File *grp = NULL;
+  char *tmp = NULL;
+  FILE *fp = NULL;
+  size_t n = 0, offset;
+  int fd = -1;
+  int ret = XLAL_FAILURE;
+
+  file = XLALH5FileOpen(src, "r");
+  if (!file)
+    goto done;
+  grp = (group && *group) ? XLALH5GroupOpen(file, group) : file;
+  if (!grp)
+    goto done;
+
+  n = XLALH5FileQueryNDatasets(grp);
+  entries = XLALCalloc(n ? n : 1, sizeof(*entries));
+  if (!entries)
+    goto done;
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, ROMDATASTORE_MAGIC, sizeof(header.magic));
+  header.version = ROMDATASTORE_VERSION;
+  header.byte_order = ROMDATASTORE_BYTE_ORDER;
+  header.ndatasets = n;
+  header.src_size = src_st->st_size;
+  header.src_mtime = src_st->st_mtime;
+  snprintf(header.src, sizeof(header.src), "%s", src);
+  snprintf(header.group, sizeof(header.group), "%s", group);
+
+  /* lay out the table */
+  offset = ROMDataStore_Align(sizeof(header) + n * sizeof(*entries));
+  for (size_t i = 0; i < n; ++i) {
+    LALH5Dataset *dset;
+    UINT4Vector *dims;
+    char path[ROMDATASTORE_PATH_LEN];
+    const char *name;
+    /* this returns the full path of the dataset, but it is looked up by its name in the group */
+    if (XLALH5FileQueryDatasetName(path, sizeof(path), grp, i) < 0)
+      goto done;
+    name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    if (strlen(name) >= sizeof(entries[i].name))
+      goto done;
+    strcpy(entries[i].name, name);
+    dset = XLALH5DatasetRead(grp, entries[i].name);
+    if (!dset)
+      goto done;
+    entries[i].type = XLALH5DatasetQueryType(dset);
+    entries[i].nbytes = XLALH5DatasetQueryNBytes(dset);
+    dims = XLALH5DatasetQueryDims(dset);
+    XLALH5DatasetFree(dset);
+    if (!dims)
+      goto done;
+    entries[i].ndim = dims->length;
+    for (UINT4 d = 0; d < dims->length && d < 2; ++d)
+      entries[i].dims[d] = dims->data[d];
+    XLALDestroyUINT4Vector(dims);
+    entries[i].offset = offset;
+    offset = ROMDataStore_Align(offset + entries[i].nbytes);
+  }
+  header.file_size = offset;
+
+  tmp = XLALStringAppendFmt(NULL, "%s.XXXXXX", cache);
+  if (!tmp || (fd = mkstemp(tmp)) < 0)
+    goto done;
+  fp = fdopen(fd, "wb");
+  if (!fp)
+    goto done;
+  fd = -1;
+  if (fwrite(&header, sizeof(header), 1, fp) != 1)
+    goto done;
+  if (n > 0 && fwrite(entries, sizeof(*entries), n, fp) != n)
+    goto done;
+
+  /* copy the data, one dataset at a time */
+  for (size_t i = 0; i < n; ++i) {
+    LALH5Dataset *dset;
+    void *data;
+    if (fseek(fp, entries[i].offset, SEEK_SET) != 0)
+      goto done;
+    dset = XLALH5DatasetRead(grp, entries[i].name);
+    if (!dset)
+      goto done;
+    data = XLALMalloc(entries[i].nbytes ? entries[i].nbytes : 1);
+    if (!data || XLALH5DatasetQueryData(data, dset) < 0
+        || fwrite(data, 1, entries[i].nbytes, fp) != entries[i].nbytes) {
+      XLALFree(data);
+      XLALH5DatasetFree(dset);
+      goto done;
+    }
+    XLALFree(data);
+    XLALH5DatasetFree(dset);
+  }
+
+  /* pad to the full size so that the last dataset ends inside the mapping */
+  if (fseek(fp, header.file_size - 1, SEEK_SET) != 0 || fputc(0, fp) == EOF)
+    goto done;
+  if (fclose(fp) != 0) {
+    fp = NULL;
+    goto done;
+  }
+  fp = NULL;
+  if (rename(tmp, cache) != 0)
+    goto done;
+  ret = XLAL_SUCCESS;
+
+done:
+  if (fp)
+    fclose(fp);
+  if (fd >= 0)
+    close(fd);
+  if (tmp && ret != XLAL_SUCCESS)
+    unlink(tmp);
+  XLALFree(tmp);
+  XLALFree(entries);
+  if (grp && grp != file)
+    XLALH5FileClose(grp);
+  if (file)
+    XLALH5FileClose(file);
+  return ret;
+}
+#endif
+
+/**
+ * Return a read-only view of all datasets in group `group' (the root group
+ * if NULL or empty) of the HDF5 file `path', building the shared cache for
+ * it on first use. Returns NULL, without raising an error, if the store is
+ * disabled or unusable; the caller should then read `path' directly.
+ * A non-NULL group must be released with ROMDataStore_CloseGroup().
+ */
+const ROMDataStoreGroup *ROMDataStore_OpenGroup(const char *path, const char *group) {
+  ROMDataStoreGroup *g = NULL;
+  char *src = NULL;
+  char *dir = NULL;
+  char *cache = NULL;
+  const char *base;
+  struct stat src_st;
+  int saveErrno = xlalErrno;
+
+  if (!path)
+    return NULL;
+  if (!group)
+    group = "";
+
+#ifdef LAL_PTHREAD_LOCK
+  pthread_mutex_lock(&ROMDataStore_mutex);
+#endif
+
+  src = realpath(path, NULL);
+  if (!src || stat(src, &src_st) != 0)
+    goto done;
+
+  for (g = ROMDataStore_groups; g; g = g->next)
+    if (strcmp(g->src, src) == 0 && strcmp(g->group, group) == 0) {
+      ++g->refcount;
+      goto done;
+    }
+
+  if (strlen(src) >= ROMDATASTORE_PATH_LEN || strlen(group) >= ROMDATASTORE_NAME_LEN)
+    goto done;
+  dir = ROMDataStore_CacheDir();
+  if (!dir)
+    goto done;
+  base = strrchr(src, '/');
+  base = base ? base + 1 : src;
+  cache = XLALStringAppendFmt(NULL, "%s/%s.%s.%016llx.romcache", dir, base, *group ? group : "root",
+                              (unsigned long long) ROMDataStore_Hash(ROMDataStore_Hash(0, src), group));
+  if (!cache)
+    goto done;
+
+  g = ROMDataStore_Map(cache, src, group, &src_st);
+#ifdef LAL_HDF5_ENABLED
+  if (!g) {
+    if (ROMDataStore_Build(cache, src, group, &src_st) == XLAL_SUCCESS)
+      g = ROMDataStore_Map(cache, src, group, &src_st);
+    if (!g)
+      XLALPrintWarning("%s: unable to cache group `%s' of %s in %s; reading it directly\n", __func__, group, src, dir);
+  }
+#endif
+  if (g) {
+    g->src = src;
+    g->group = XLALStringDuplicate(group);
+    g->refcount = 1;
+    g->next = ROMDataStore_groups;
+    ROMDataStore_groups = g;
+    src = NULL;
+  }
+
+done:
+#ifdef LAL_PTHREAD_LOCK
+  pthread_mutex_unlock(&ROMDataStore_mutex);
+#endif
+  free(src);
+  XLALFree(dir);
+  XLALFree(cache);
+  xlalErrno = saveErrno;
+  return g;
+}
+
+/**
+ * Return a pointer to the data of dataset `name' in `group', and optionally
+ * its type, rank and (up to two) dimensions. The data are aligned to 64 bytes
+ * and must not be written to.
+ */
+const void *ROMDataStore_GetData(const ROMDataStoreGroup *group, const char *name, LALTYPECODE *type, UINT4 *ndim, size_t dims[2]) {
+  XLAL_CHECK_NULL(group && name, XLAL_EFAULT);
+  for (UINT4 i = 0; i < group->header->ndatasets; ++i) {
+    const ROMDataStoreEntry *e = &group->entries[i];
+    if (strncmp(e->name, name, sizeof(e->name)) != 0)
+      continue;
+    XLAL_CHECK_NULL(e->offset + e->nbytes <= group->size, XLAL_EIO, "Dataset `%s' extends past the end of the cache", name);
+    if (type)
+      *type = e->type;
+    if (ndim)
+      *ndim = e->ndim;
+    if (dims) {
+      dims[0] = e->dims[0];
+      dims[1] = e->dims[1];
+    }
+    return (const char *) group->map + e->offset;
+  }
+  XLAL_ERROR_NULL(XLAL_ENAME, "No dataset `%s' in group `%s' of %s", name, group->group, group->src);
+}
+
+/**
+ * Point *data at the 1-dimensional REAL8 dataset `name' of `group'. The
+ * gsl_vector does not own its data, so it can be released with
+ * gsl_vector_free() as usual, but its elements must not be modified.
+ */
+int ROMDataStore_GetREAL8Vector(gsl_vector **data, const ROMDataStoreGroup *group, const char *name) {
+  LALTYPECODE type;
+  UINT4 ndim;
+  size_t dims[2];
+  const void *p;
+
+  XLAL_CHECK(data && *data == NULL, XLAL_EFAULT);
+  p = ROMDataStore_GetData(group, name, &type, &ndim, dims);
+  XLAL_CHECK(p, XLAL_EFUNC);
+  XLAL_CHECK(type == LAL_D_TYPE_CODE, XLAL_ETYPE, "Dataset `%s' is wrong type", name);
+  XLAL_CHECK(ndim == 1, XLAL_EDIMS, "Dataset `%s' must be 1-dimensional", name);
+
+  /* gsl_vector_free() releases the struct with free() */
+  *data = malloc(sizeof(**data));
+  XLAL_CHECK(*data, XLAL_ENOMEM);
+  (*data)->size = dims[0];
+  (*data)->stride = 1;
+  (*data)->data = (double *) p;
+  (*data)->block = NULL;
+  (*data)->owner = 0;
+  return XLAL_SUCCESS;
+}
+
+/**
+ * Point *data at the 2-dimensional REAL8 dataset `name' of `group'. The
+ * gsl_matrix does not own its data, so it can be released with
+ * gsl_matrix_free() as usual, but its elements must not be modified.
+ */
+int ROMDataStore_GetREAL8Matrix(gsl_matrix **data, const ROMDataStoreGroup *group, const char *name) {
+  LALTYPECODE type;
+  UINT4 ndim;
+  size_t dims[2];
+  const void *p;
+
+  XLAL_CHECK(data && *data == NULL, XLAL_EFAULT);
+  p = ROMDataStore_GetData(group, name, &type, &ndim, dims);
+  XLAL_CHECK(p, XLAL_EFUNC);
+  XLAL_CHECK(type == LAL_D_TYPE_CODE, XLAL_ETYPE, "Dataset `%s' is wrong type", name);
+  XLAL_CHECK(ndim == 2, XLAL_EDIMS, "Dataset `%s' must be 2-dimensional", name);
+
+  /* gsl_matrix_free() releases the struct with free() */
+  *data = malloc(sizeof(**data));
+  XLAL_CHECK(*data, XLAL_ENOMEM);
+  (*data)->size1 = dims[0];
+  (*data)->size2 = dims[1];
+  (*data)->tda = dims[1];
+  (*data)->data = (double *) p;
+  (*data)->block = NULL;
+  (*data)->owner = 0;
+  return XLAL_SUCCESS;
+}
+
+/**
+ * Release a group returned by ROMDataStore_OpenGroup(), unmapping it once
+ * no other user holds it. Views obtained from the group must already have
+ * been released. Does nothing if `group' is NULL.
+ */
+void ROMDataStore_CloseGroup(const ROMDataStoreGroup *group) {
+  if (!group)
+    return;
+#ifdef LAL_PTHREAD_LOCK
+  pthread_mutex_lock(&ROMDataStore_mutex);
+#endif
+  for (ROMDataStoreGroup **p = &ROMDataStore_groups; *p; p = &(*p)->next) {
+    ROMDataStoreGroup *g = *p;
+    if (g != group)
+      continue;
+    if (--g->refcount == 0) {
+      *p = g->next;
+      ROMDataStore_Free(g);
+    }
+    break;
+  }
+#ifdef LAL_PTHREAD_LOCK
+  pthread_mutex_unlock(&ROMDataStore_mutex);
+#endif
+}
+
+/**
+ * Unmap every cached group regardless of how many users it has. Any views
+ * previously returned become invalid, so this must only be called once the
+ * models using them have been cleaned up.
+ */
+void ROMDataStore_Cleanup(void) {
+#ifdef LAL_PTHREAD_LOCK
+  pthread_mutex_lock(&ROMDataStore_mutex);
+#endif
+  while (ROMDataStore_groups) {
+    ROMDataStoreGroup *g = ROMDataStore_groups;
+    ROMDataStore_groups = g->next;
+    ROMDataStore_Free(g);
+  }
+#ifdef LAL_PTHREAD_LOCK
+  pthread_mutex_unlock(&ROMDataStore_mutex);
+#endif
+}
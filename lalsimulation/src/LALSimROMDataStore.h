@@ -0,0 +1,35 @@
+#ifndef _LALSIM_ROMDATASTORE_H
+#define _LALSIM_ROMDATASTORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <lal/LALDatatypes.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+
+/** Environment variable naming the ROM data cache directory; the store is only used if it is set and non-empty */
+#define ROMDATASTORE_CACHE_DIR_ENV "LAL_SIM_ROM_CACHE_DIR"
+
+/** Read-only view of the datasets of one group of a ROM data file */
+typedef struct tagROMDataStoreGroup ROMDataStoreGroup;
+
+const ROMDataStoreGroup *ROMDataStore_OpenGroup(const char *path, const char *group);
+
+const void *ROMDataStore_GetData(const ROMDataStoreGroup *group, const char *name, LALTYPECODE *type, UINT4 *ndim, size_t dims[2]);
+
+int ROMDataStore_GetREAL8Vector(gsl_vector **data, const ROMDataStoreGroup *group, const char *name);
+
+int ROMDataStore_GetREAL8Matrix(gsl_matrix **data, const ROMDataStoreGroup *group, const char *name);
+
+void ROMDataStore_CloseGroup(const ROMDataStoreGroup *group);
+
+void ROMDataStore_Cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LALSIM_ROMDATASTORE_H */
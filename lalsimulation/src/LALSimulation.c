@@ -36,7 +36,6 @@
 #include <lal/TimeDelay.h>
 #include <lal/SkyCoordinates.h>
 #include <lal/TimeSeries.h>
-#include <lal/TimeSeriesInterp.h>
 #include <lal/FrequencySeries.h>
 #include <lal/TimeFreqFFT.h>
 #include <lal/Window.h>
@@ -198,6 +197,454 @@ static void highfreq_kernel(double *cached_kernel, int kernel_length, double res
 };
 
 
+/*
+ * The antenna response and the geometric delay vary on the time scale of
+ * the Earth's rotation.  They are computed exactly on a coarse grid of
+ * nodes and interpolated between the nodes with natural cubic splines.
+ */
+
+
+enum {
+	DET_RESP_FXPLUS,
+	DET_RESP_FXCROSS,
+	DET_RESP_FYPLUS,
+	DET_RESP_FYCROSS,
+	DET_RESP_XCOS,
+	DET_RESP_YCOS,
+	DET_RESP_DELAY,
+	DET_RESP_NUM
+};
+
+
+struct detector_projection {
+	REAL8TimeSeries *h;	/* output strain */
+	int kernel_length;	/* interpolation kernel length in samples */
+	double arm_length_samples;	/* mean arm length in samples */
+	int node0;	/* index of the first node */
+	int nnodes;	/* number of nodes */
+	double armlen;	/* arm length (light travel time) in samples */
+	double *y[DET_RESP_NUM];	/* response and delay at the nodes */
+	double *d2y[DET_RESP_NUM];	/* their spline second derivatives */
+	double *xsignal;	/* x-arm signal at the input sample times */
+	double *ysignal;	/* y-arm signal at the input sample times */
+	double *xkernel;	/* cached x-arm interpolation kernel */
+	double *ykernel;	/* cached y-arm interpolation kernel */
+};
+
+
+/*
+ * Second derivatives of the natural cubic spline through the n >= 2
+ * values y[] on a grid of unit spacing.  work must hold n doubles.
+ */
+
+
+static void det_resp_spline_init(double *d2y, const double *y, int n, double *work)
+{
+	int k;
+
+	/* tridiagonal system d2y[k-1] + 4 d2y[k] + d2y[k+1] = 6 (y[k+1] -
+	 * 2 y[k] + y[k-1]) with d2y[0] = d2y[n-1] = 0, solved by forward
+	 * elimination and back substitution */
+	d2y[0] = work[0] = 0.;
+	for(k = 1; k < n - 1; k++) {
+		double denom = 4. - work[k - 1];
+		work[k] = 1. / denom;
+		d2y[k] = (6. * (y[k + 1] - 2. * y[k] + y[k - 1]) - d2y[k - 1]) / denom;
+	}
+	d2y[n - 1] = 0.;
+	for(k = n - 2; k > 0; k--)
+		d2y[k] -= work[k] * d2y[k + 1];
+}
+
+
+/*
+ * Evaluate the spline at the fraction b of the interval between nodes k
+ * and k + 1.
+ */
+
+
+static inline double det_resp_spline_eval(const double *y, const double *d2y, int k, double b)
+{
+	double a = 1. - b;
+	return a * y[k] + b * y[k + 1] + ((a * a * a - a) * d2y[k] + (b * b * b - b) * d2y[k + 1]) / 6.;
+}
+
+
+/*
+ * Inner product of the x- and y-arm kernels with the x- and y-arm
+ * signals, starting at sample start of the signals.  The signals are
+ * assumed to be 0 outside of [0, length).
+ */
+
+
+static double det_resp_kernel_dot(const double *restrict xkernel, const double *restrict ykernel, const double *restrict xsignal, const double *restrict ysignal, int start, int length, int kernel_length)
+{
+	int first = start < 0 ? -start : 0;
+	int last = start + kernel_length > length ? length - start : kernel_length;
+	double val = 0.0;
+	int j;
+
+	xsignal += start;
+	ysignal += start;
+	#pragma omp simd reduction(+:val)
+	for(j = first; j < last; j++)
+		val += xkernel[j] * xsignal[j] + ykernel[j] * ysignal[j];
+
+	return val;
+}
+
+
+/**
+ * @brief Transforms the waveform polarizations into the strains of several
+ * detectors
+ * @details
+ * This routine is equivalent to calling
+ * XLALSimDetectorStrainREAL8TimeSeries() for each of the detectors, but
+ * evaluates the antenna responses for all detectors in a single pass over
+ * the plus and cross waveform polarizations.
+ *
+ * The input time series should have their epochs set to the start of
+ * those time series at the geocetre (for simplicity the epochs must be
+ * the same, and they must have the same length and sample rates)
+ *
+ * @param[out] h Array of num_detectors pointers that are set to the strain
+ * time series as seen in each detector, with their epochs set to the start
+ * of the time series at that detector.  The output time series units are
+ * the same as the two input time series.
+ * @param[in] hplus Pointer to a REAL8TimeSeries containing the plus polarization waveform
+ * @param[in] hcross Pointer to a REAL8TimeSeries containing the cross polarization waveform
+ * @param[in] right_ascension The right ascension of the source in radians
+ * @param[in] declination The declination of the source in radians
+ * @param[in] psi The polarization angle giving the orientation of the wave co-ordinate system in radians
+ * @param[in] detectors Array of num_detectors LALDetector structures for the detectors into which the injection is destined to be injected
+ * @param[in] num_detectors Number of detectors
+ *
+ * @retval 0 Success
+ * @retval <0 Failure; the elements of h are set to NULL
+ *
+ * @note
+ * The interpolation kernel, and the precision of the geometric delay and
+ * antenna response, are described in XLALSimDetectorStrainREAL8TimeSeries().
+ */
+int XLALSimMultiDetectorStrainREAL8TimeSeries(
+	REAL8TimeSeries **h,
+	const REAL8TimeSeries *hplus,
+	const REAL8TimeSeries *hcross,
+	REAL8 right_ascension,
+	REAL8 declination,
+	REAL8 psi,
+	const LALDetector *detectors,
+	UINT4 num_detectors
+)
+{
+	int det_resp_interval;
+	double node_interval;
+	int length;
+	struct detector_projection *proj = NULL;
+	double *work = NULL;
+	double *weights = NULL;
+	int node0 = 0, node_end = 0, nnodes;
+	unsigned d;
+	int i, k;
+
+	/* check input */
+
+	if(!h || !detectors || !num_detectors)
+		XLAL_ERROR(XLAL_EFAULT);
+	for(d = 0; d < num_detectors; d++)
+		h[d] = NULL;
+	LAL_CHECK_VALID_SERIES(hplus, XLAL_FAILURE);
+	LAL_CHECK_VALID_SERIES(hcross, XLAL_FAILURE);
+	LAL_CHECK_CONSISTENT_TIME_SERIES(hplus, hcross, XLAL_FAILURE);
+
+	/* 0.25 s or 1 sample whichever is larger */
+	det_resp_interval = round(0.25 / hplus->deltaT) < 1 ? 1 : round(0.25 / hplus->deltaT);
+	node_interval = det_resp_interval * hplus->deltaT;
+	length = hplus->data->length;
+
+	proj = XLALCalloc(num_detectors, sizeof(*proj));
+	if(!proj)
+		XLAL_ERROR(XLAL_EFUNC);
+
+	for(d = 0; d < num_detectors; d++) {
+		const LALDetector *detector = &detectors[d];
+
+		/* mean arm length in samples */
+		proj[d].arm_length_samples = (detector->frDetector.xArmMidpoint + detector->frDetector.yArmMidpoint) / (LAL_C_SI * hplus->deltaT);
+		/* kernel length in samples.  increase by 28 times the arm
+		 * length to accomodate the additional signal delay. */
+		proj[d].kernel_length = 67 + 48 * lround(2.0 * proj[d].arm_length_samples);
+
+		/* test that the input's length can be treated as a signed
+		 * valued without overflow, and that adding the kernel length
+		 * plus an Earth diameter's worth of samples won't overflow */
+		if(length < 0 || (int) (length + proj[d].kernel_length + 2.0 * LAL_REARTH_SI / LAL_C_SI / hplus->deltaT) < 0) {
+			XLALPrintError("%s(): error: input series too long\n", __func__);
+			XLALFree(proj);
+			XLAL_ERROR(XLAL_EBADLEN);
+		}
+	}
+
+	/* allocate output time series and find the nodes spanning the
+	 * times covered by the input and each output.  the nodes are at
+	 * integer multiples of node_interval from the start of the input,
+	 * with one extra node at each end, so there are at least 4.  they
+	 * are chosen per detector, so the result for a detector does not
+	 * depend on which other detectors are projected along with it */
+
+	for(d = 0; d < num_detectors; d++) {
+		const LALDetector *detector = &detectors[d];
+		LIGOTimeGPS t;
+		double dt;
+		double geometric_delay;
+		char *name;
+
+		/* generate name */
+
+		name = XLALMalloc(strlen(detector->frDetector.prefix) + 11);
+		if(!name)
+			goto error;
+		sprintf(name, "%s injection", detector->frDetector.prefix);
+
+		/* allocate output time series.  the time series' duration
+		 * is adjusted to account for Doppler-induced dilation of the
+		 * waveform, and is padded to accomodate ringing of the
+		 * interpolation kernel.  see
+		 * XLALSimDetectorStrainREAL8TimeSeries() for the sign of
+		 * dt. */
+
+		/* time (at geocentre) of end of waveform */
+		t = hplus->epoch;
+		if(!XLALGPSAdd(&t, length * hplus->deltaT)) {
+			XLALFree(name);
+			goto error;
+		}
+		/* change in geometric delay from start to end */
+		dt = XLALTimeDelayFromEarthCenter(detector->location, right_ascension, declination, &hplus->epoch) - XLALTimeDelayFromEarthCenter(detector->location, right_ascension, declination, &t);
+		/* allocate, lengthen sequence to incorporate time delay
+		 * caused by beyond-long-wavelength effect */
+		proj[d].h = XLALCreateREAL8TimeSeries(name, &hplus->epoch, hplus->f0, hplus->deltaT, &hplus->sampleUnits, length + proj[d].kernel_length - 1 + ceil(dt / hplus->deltaT) + lround(4.0 * proj[d].arm_length_samples));
+		XLALFree(name);
+		if(!proj[d].h)
+			goto error;
+
+		/* shift the epoch so that the start of the input time series
+		 * passes through this detector at the time of the sample at
+		 * offset (kernel_length-1)/2 */
+
+		geometric_delay = XLALTimeDelayFromEarthCenter(detector->location, right_ascension, declination, &proj[d].h->epoch);
+		if(XLAL_IS_REAL8_FAIL_NAN(geometric_delay))
+			goto error;
+		if(!XLALGPSAdd(&proj[d].h->epoch, geometric_delay - (proj[d].kernel_length - 1) / 2 * hplus->deltaT))
+			goto error;
+
+		/* round epoch to an integer sample boundary so that
+		 * XLALSimAddInjectionREAL8TimeSeries() can use no-op code
+		 * path. */
+
+		dt = XLALGPSModf(&dt, &proj[d].h->epoch);
+		XLALGPSAdd(&proj[d].h->epoch, round(dt / hplus->deltaT) * hplus->deltaT - dt);
+
+		dt = XLALGPSDiff(&proj[d].h->epoch, &hplus->epoch);
+		proj[d].node0 = floor((dt < 0. ? dt : 0.) / node_interval) - 1;
+		dt += proj[d].h->data->length * hplus->deltaT;
+		proj[d].nnodes = ceil((dt > length * hplus->deltaT ? dt : length * hplus->deltaT) / node_interval) + 2 - proj[d].node0;
+		if(d == 0 || proj[d].node0 < node0)
+			node0 = proj[d].node0;
+		if(d == 0 || proj[d].node0 + proj[d].nnodes > node_end)
+			node_end = proj[d].node0 + proj[d].nnodes;
+	}
+	nnodes = node_end - node0;
+
+	/* allocate the node tables, the x- and y-arm signals and the
+	 * kernels of all detectors */
+
+	work = XLALMalloc(nnodes * sizeof(*work));
+	if(!work)
+		goto error;
+	for(d = 0; d < num_detectors; d++) {
+		const int n = proj[d].nnodes;
+		double *mem = XLALMalloc((2 * DET_RESP_NUM * n + 2 * length + 2 * proj[d].kernel_length) * sizeof(*mem));
+		if(!mem)
+			goto error;
+		for(k = 0; k < DET_RESP_NUM; k++) {
+			proj[d].y[k] = mem + 2 * k * n;
+			proj[d].d2y[k] = mem + (2 * k + 1) * n;
+		}
+		proj[d].xsignal = mem + 2 * DET_RESP_NUM * n;
+		proj[d].ysignal = proj[d].xsignal + length;
+		proj[d].xkernel = proj[d].ysignal + length;
+		proj[d].ykernel = proj[d].xkernel + proj[d].kernel_length;
+	}
+
+	/* compute the detectors' responses and geometric delays at the
+	 * nodes.  the sidereal time is computed once for all detectors */
+
+	for(k = 0; k < nnodes; k++) {
+		LIGOTimeGPS t = hplus->epoch;
+		double gmst;
+		if(!XLALGPSAdd(&t, (node0 + k) * node_interval))
+			goto error;
+		gmst = XLALGreenwichMeanSiderealTime(&t);
+		if(XLAL_IS_REAL8_FAIL_NAN(gmst))
+			goto error;
+		for(d = 0; d < num_detectors; d++) {
+			double **y = proj[d].y;
+			const int kd = node0 + k - proj[d].node0;
+			double armlen = XLAL_REAL8_FAIL_NAN;
+			if(kd < 0 || kd >= proj[d].nnodes)
+				continue;
+			XLALComputeDetAMResponseParts(&armlen, &y[DET_RESP_XCOS][kd], &y[DET_RESP_YCOS][kd], &y[DET_RESP_FXPLUS][kd], &y[DET_RESP_FYPLUS][kd], &y[DET_RESP_FXCROSS][kd], &y[DET_RESP_FYCROSS][kd], &detectors[d], right_ascension, declination, psi, gmst);
+			proj[d].armlen = armlen / (LAL_C_SI * hplus->deltaT);
+			y[DET_RESP_DELAY][kd] = -XLALTimeDelayFromEarthCenter(detectors[d].location, right_ascension, declination, &t);
+			for(i = 0; i < DET_RESP_NUM; i++)
+				if(XLAL_IS_REAL8_FAIL_NAN(y[i][kd]))
+					goto error;
+			if(XLAL_IS_REAL8_FAIL_NAN(proj[d].armlen))
+				goto error;
+		}
+	}
+	for(d = 0; d < num_detectors; d++)
+		for(i = 0; i < DET_RESP_NUM; i++)
+			det_resp_spline_init(proj[d].d2y[i], proj[d].y[i], proj[d].nnodes, work);
+
+	/* compute the x- and y-arm signals of all detectors at the times of
+	 * the samples in hplus, one node interval at a time.  the geometric
+	 * delay from geocenter is neglected since it is small compared to
+	 * the rotational period of the Earth.  the samples are at the same
+	 * fractions of every node interval, so the spline weights are
+	 * tabulated once */
+
+	weights = XLALMalloc(4 * det_resp_interval * sizeof(*weights));
+	if(!weights)
+		goto error;
+	for(i = 0; i < det_resp_interval; i++) {
+		const double b = (double) i / det_resp_interval;
+		const double a = 1. - b;
+		weights[i] = a;
+		weights[det_resp_interval + i] = b;
+		weights[2 * det_resp_interval + i] = (a * a * a - a) / 6.;
+		weights[3 * det_resp_interval + i] = (b * b * b - b) / 6.;
+	}
+
+	for(i = 0; i < length; i += det_resp_interval) {
+		const double *hp = hplus->data->data + i;
+		const double *hc = hcross->data->data + i;
+		const int n = length - i < det_resp_interval ? length - i : det_resp_interval;
+		const double *restrict wa = weights;
+		const double *restrict wb = weights + det_resp_interval;
+		const double *restrict wc = weights + 2 * det_resp_interval;
+		const double *restrict wd = weights + 3 * det_resp_interval;
+		for(d = 0; d < num_detectors; d++) {
+			const int node = i / det_resp_interval - proj[d].node0;
+			double c[4][4];
+			double *restrict xs = proj[d].xsignal + i;
+			double *restrict ys = proj[d].ysignal + i;
+			int j;
+			/* node values and second derivatives bracketing this
+			 * interval for F+ and Fx of each arm */
+			for(j = 0; j < 4; j++) {
+				const double *y = proj[d].y[DET_RESP_FXPLUS + j] + node;
+				const double *d2y = proj[d].d2y[DET_RESP_FXPLUS + j] + node;
+				c[j][0] = y[0];
+				c[j][1] = y[1];
+				c[j][2] = d2y[0];
+				c[j][3] = d2y[1];
+			}
+			#pragma omp simd
+			for(j = 0; j < n; j++) {
+				const double fxplus = wa[j] * c[DET_RESP_FXPLUS][0] + wb[j] * c[DET_RESP_FXPLUS][1] + wc[j] * c[DET_RESP_FXPLUS][2] + wd[j] * c[DET_RESP_FXPLUS][3];
+				const double fxcross = wa[j] * c[DET_RESP_FXCROSS][0] + wb[j] * c[DET_RESP_FXCROSS][1] + wc[j] * c[DET_RESP_FXCROSS][2] + wd[j] * c[DET_RESP_FXCROSS][3];
+				const double fyplus = wa[j] * c[DET_RESP_FYPLUS][0] + wb[j] * c[DET_RESP_FYPLUS][1] + wc[j] * c[DET_RESP_FYPLUS][2] + wd[j] * c[DET_RESP_FYPLUS][3];
+				const double fycross = wa[j] * c[DET_RESP_FYCROSS][0] + wb[j] * c[DET_RESP_FYCROSS][1] + wc[j] * c[DET_RESP_FYCROSS][2] + wd[j] * c[DET_RESP_FYCROSS][3];
+				xs[j] = fxplus * hp[j] + fxcross * hc[j];
+				ys[j] = fyplus * hp[j] + fycross * hc[j];
+			}
+		}
+	}
+
+	/* compute output sample by sample.  the filtering interpolation
+	 * kernels are recomputed when the sub-sample residual or the arm
+	 * direction cosines have drifted too far from the values for which
+	 * they were computed.  see TimeSeriesInterp.c for the meaning of the
+	 * welch_factor and the no-op threshold */
+
+	for(d = 0; d < num_detectors; d++) {
+		REAL8TimeSeries *out = proj[d].h;
+		const int kernel_length = proj[d].kernel_length;
+		const double noop_threshold = 1. / (4 * kernel_length);
+		const double t0 = XLALGPSDiff(&out->epoch, &hplus->epoch);
+		struct highfreq_kernel_data xdata;
+		struct highfreq_kernel_data ydata;
+		/* >= 1 --> impossible.  forces kernel init on first sample */
+		double kernel_residual = 2.;
+		int node = -1;
+		double xcos = XLAL_REAL8_FAIL_NAN;
+		double ycos = XLAL_REAL8_FAIL_NAN;
+
+		xdata.welch_factor = ydata.welch_factor = 1.0 / ((kernel_length - 1.) / 2. + 1.);
+		xdata.T = ydata.T = proj[d].armlen;
+		xdata.armcos = ydata.armcos = 2.;
+
+		for(i = 0; i < (int) out->data->length; i++) {
+			/* time of sample in detector, in node intervals from
+			 * the first node */
+			const double t = t0 + i * out->deltaT;
+			const double u = t / node_interval - proj[d].node0;
+			const int k = floor(u);
+			const double b = u - k;
+			double x, residual;
+			int start;
+
+			if(k != node) {
+				node = k;
+				xcos = proj[d].y[DET_RESP_XCOS][k];
+				ycos = proj[d].y[DET_RESP_YCOS][k];
+			}
+
+			/* real-valued index of the sample at geocentre */
+			x = (t + det_resp_spline_eval(proj[d].y[DET_RESP_DELAY], proj[d].d2y[DET_RESP_DELAY], k, b)) / hplus->deltaT;
+			if(!isfinite(x))
+				goto error;
+			start = lround(x);
+			residual = start - x;
+
+			/* need new kernels? */
+			if(fabs(residual - kernel_residual) >= noop_threshold || fabs(xcos - xdata.armcos) >= noop_threshold || fabs(ycos - ydata.armcos) >= noop_threshold) {
+				xdata.armcos = xcos;
+				ydata.armcos = ycos;
+				highfreq_kernel(proj[d].xkernel, kernel_length, residual, &xdata);
+				highfreq_kernel(proj[d].ykernel, kernel_length, residual, &ydata);
+				kernel_residual = residual;
+			}
+
+			/* evaluate linear combination of interpolators */
+			out->data->data[i] = det_resp_kernel_dot(proj[d].xkernel, proj[d].ykernel, proj[d].xsignal, proj[d].ysignal, start - (kernel_length - 1) / 2, length, kernel_length);
+		}
+	}
+
+	/* done */
+	for(d = 0; d < num_detectors; d++) {
+		h[d] = proj[d].h;
+		XLALFree(proj[d].y[0]);
+	}
+	XLALFree(proj);
+	XLALFree(work);
+	XLALFree(weights);
+	return 0;
+
+error:
+	for(d = 0; d < num_detectors; d++) {
+		XLALDestroyREAL8TimeSeries(proj[d].h);
+		XLALFree(proj[d].y[0]);
+	}
+	XLALFree(proj);
+	XLALFree(work);
+	XLALFree(weights);
+	XLAL_ERROR(XLAL_EFUNC);
+}
+
+
 /**
  * @brief Transforms the waveform polarizations into a detector strain
  * @details
@@ -231,18 +678,17 @@ static void highfreq_kernel(double *cached_kernel, int kernel_length, double res
  * using this function with injections whose frequency content approaches
  * the Nyquist frequency.
  * @n@n
- * The geometric delay and antenna response are only recalculated every 250
- * ms --- the Earth's rotation is modelled as discontinuous jumps occurring
- * at a rate of 4 Hz.  The Earth rotates at 7e-5 rad/s, therefore given a
- * radius of 6e6 m and c=3e8 m/s, the maximum geometric speed for points on
- * the surface is about 1.5 us/s.  Updating the detector response and
- * geometric delay every 250 ms means the antenna response is accurate to
- * about +/- 20 urad and the geometric delay to about +/- 300 ns (about
- * 0.01 sample at 32 kHz).  Because we use UTC (instead of UT1) sidereal
- * time is only accurate to +/- 900 ms, so assuming the Earth's orientation
- * to be fixed for 250 ms at a time is not the dominant source of Earth
- * orientation error in these calculations, but one should be aware of the
- * periodic nature of the updates if extreme phase stability is required.
+ * The geometric delay and antenna response are computed every 250 ms and
+ * interpolated in between with natural cubic splines.  The Earth rotates
+ * at 7e-5 rad/s, so over 250 ms the response changes by about 20 urad
+ * and, given a radius of 6e6 m and c=3e8 m/s, the geometric delay by
+ * about 300 ns;  the error of the cubic interpolation is smaller than
+ * these by several orders of magnitude.  Because we use UTC (instead of
+ * UT1) sidereal time is only accurate to +/- 900 ms, so the interpolation
+ * is not the dominant source of Earth orientation error in these
+ * calculations.  The interpolating kernel is recomputed when the
+ * sub-sample residual or the direction cosines of the arms have changed
+ * by more than a fraction of the kernel's accuracy.
  * @n@n
  * The output time series is padded to capture the interpolation kernel
  * structure resulting from possible sharp edges at the start or end of the
@@ -250,6 +696,9 @@ static void highfreq_kernel(double *cached_kernel, int kernel_length, double res
  * kernel's impulse response, the output time series is, in general, not
  * the same duration as the input time series due to Doppler compression or
  * resulting from Earth rotation.
+ * @n@n
+ * Use XLALSimMultiDetectorStrainREAL8TimeSeries() to project the same
+ * polarizations into several detectors.
  */
 REAL8TimeSeries *XLALSimDetectorStrainREAL8TimeSeries(
 	const REAL8TimeSeries *hplus,
@@ -260,189 +709,12 @@ REAL8TimeSeries *XLALSimDetectorStrainREAL8TimeSeries(
 	const LALDetector *detector
 )
 {
-	/* mean arm length in samples */
-	const double arm_length_samples = (detector->frDetector.xArmMidpoint + detector->frDetector.yArmMidpoint) / (LAL_C_SI * hplus->deltaT);
-	/* kernel length in samples.  increase by 28 times the arm length
-	 * to accomodate the additional signal delay. */
-	const int kernel_length = 67 + 48 * lround(2.0 * arm_length_samples);
-	/* 0.25 s or 1 sample whichever is larger */
-	const unsigned det_resp_interval = round(0.25 / hplus->deltaT) < 1 ? 1 : round(0.25 / hplus->deltaT);
-	REAL8TimeSeries *xsignal = NULL;
-	REAL8TimeSeries *ysignal = NULL;
-	LALREAL8TimeSeriesInterp *xinterp = NULL;
-	LALREAL8TimeSeriesInterp *yinterp = NULL;
-	struct highfreq_kernel_data xdata;
-	struct highfreq_kernel_data ydata;
-	double fxplus = XLAL_REAL8_FAIL_NAN;
-	double fxcross = XLAL_REAL8_FAIL_NAN;
-	double fyplus = XLAL_REAL8_FAIL_NAN;
-	double fycross = XLAL_REAL8_FAIL_NAN;
-	double geometric_delay = XLAL_REAL8_FAIL_NAN;
-	LIGOTimeGPS t;	/* a time */
-	double dt;	/* an offset */
-	char *name;
 	REAL8TimeSeries *h = NULL;
-	unsigned i;
-
-	/* check input */
-
-	LAL_CHECK_VALID_SERIES(hplus, NULL);
-	LAL_CHECK_VALID_SERIES(hcross, NULL);
-	LAL_CHECK_CONSISTENT_TIME_SERIES(hplus, hcross, NULL);
-	/* test that the input's length can be treated as a signed valued
-	 * without overflow, and that adding the kernel length plus an
-	 * Earth diameter's worth of samples won't overflow */
-	if((int) hplus->data->length < 0 || (int) (hplus->data->length + kernel_length + 2.0 * LAL_REARTH_SI / LAL_C_SI / hplus->deltaT) < 0) {
-		XLALPrintError("%s(): error: input series too long\n", __func__);
-		XLAL_ERROR_NULL(XLAL_EBADLEN);
-	}
-
-	/* generate name */
-
-	name = XLALMalloc(strlen(detector->frDetector.prefix) + 11);
-	if(!name)
-		goto error;
-	sprintf(name, "%s injection", detector->frDetector.prefix);
-
-	/* allocate output time series.  the time series' duration is
-	 * adjusted to account for Doppler-induced dilation of the
-	 * waveform, and is padded to accomodate ringing of the
-	 * interpolation kernel.  the sign of dt follows from the
-	 * observation that time stamps in the output time series are
-	 * mapped to time stamps in the input time series by adding the
-	 * output of XLALTimeDelayFromEarthCenter(), so if that number is
-	 * larger at the start of the waveform than at the end then the
-	 * output time series must be longer than the input.  (the Earth's
-	 * rotation is not super-luminal so we don't have to account for
-	 * time reversals in the mapping) */
-
-	/* time (at geocentre) of end of waveform */
-	t = hplus->epoch;
-	if(!XLALGPSAdd(&t, hplus->data->length * hplus->deltaT)) {
-		XLALFree(name);
-		goto error;
-	}
-	/* change in geometric delay from start to end */
-	dt = XLALTimeDelayFromEarthCenter(detector->location, right_ascension, declination, &hplus->epoch) - XLALTimeDelayFromEarthCenter(detector->location, right_ascension, declination, &t);
-	/* allocate, lengthen sequence to incorporate time delay caused by
-	 * beyond-long-wavelength effect */
-	h = XLALCreateREAL8TimeSeries(name, &hplus->epoch, hplus->f0, hplus->deltaT, &hplus->sampleUnits, (int) hplus->data->length + kernel_length - 1 + ceil(dt / hplus->deltaT) + lround(4.0 * arm_length_samples));
-	XLALFree(name);
-	if(!h)
-		goto error;
-
-	/* shift the epoch so that the start of the input time series
-	 * passes through this detector at the time of the sample at offset
-	 * (kernel_length-1)/2   we assume the kernel is sufficiently short
-	 * that it doesn't matter whether we compute the geometric delay at
-	 * the start or middle of the kernel. */
-
-	geometric_delay = XLALTimeDelayFromEarthCenter(detector->location, right_ascension, declination, &h->epoch);
-	if(XLAL_IS_REAL8_FAIL_NAN(geometric_delay))
-		goto error;
-	if(!XLALGPSAdd(&h->epoch, geometric_delay - (kernel_length - 1) / 2 * h->deltaT))
-		goto error;
-
-	/* round epoch to an integer sample boundary so that
-	 * XLALSimAddInjectionREAL8TimeSeries() can use no-op code path.
-	 * note:  we assume a sample boundary occurs on the integer second.
-	 * if this isn't the case (e.g, time-shifted injections or some GEO
-	 * data) that's OK, but we might end up paying for a second
-	 * sub-sample time shift when adding the the time series into the
-	 * target data stream in XLALSimAddInjectionREAL8TimeSeries().
-	 * don't bother checking for errors, this is changing the timestamp
-	 * by less than 1 sample, if we're that close to overflowing it'll
-	 * be caught in the loop below. */
-
-	dt = XLALGPSModf(&dt, &h->epoch);
-	XLALGPSAdd(&h->epoch, round(dt / h->deltaT) * h->deltaT - dt);
-
-	/* Compute signals at the times of samples in hplus in advance.
-	 * It reduces the computational cost for interpolation */
-
-	xsignal = XLALCreateREAL8TimeSeries("xsignal", &hplus->epoch, hplus->f0, hplus->deltaT, &hplus->sampleUnits, (int) hplus->data->length);
-	ysignal = XLALCreateREAL8TimeSeries("ysignal", &hplus->epoch, hplus->f0, hplus->deltaT, &hplus->sampleUnits, (int) hplus->data->length);
-	for(i = 0; i < hplus->data->length; i++) {
-		t = hplus->epoch;
-		if(!XLALGPSAdd(&t, i * hplus->deltaT))
-			goto error;
-		/* Compute detector's response. Here the geometric delay
-		 * from geocenter is neglected since it is small compared
-		 * to the rotational period of the Earth */
-		if(!(i % det_resp_interval)) {
-			double armlen = XLAL_REAL8_FAIL_NAN;
-			double xcos = XLAL_REAL8_FAIL_NAN;
-			double ycos = XLAL_REAL8_FAIL_NAN;
-			XLALComputeDetAMResponseParts(&armlen, &xcos, &ycos, &fxplus, &fyplus, &fxcross, &fycross, detector, right_ascension, declination, psi, XLALGreenwichMeanSiderealTime(&t));
-		}
-		xsignal->data->data[i] = fxplus * hplus->data->data[i] + fxcross * hcross->data->data[i];
-		ysignal->data->data[i] = fyplus * hplus->data->data[i] + fycross * hcross->data->data[i];
-		if(XLAL_IS_REAL8_FAIL_NAN(xsignal->data->data[i]) || XLAL_IS_REAL8_FAIL_NAN(ysignal->data->data[i]))
-			goto error;
-	}
-
-	/* initialize interpolators. */
-
-	/* use filtering interpolators.  see TimeSeriesInterp.c for
-	 * meaning of welch_factor */
-	xdata.welch_factor = ydata.welch_factor = 1.0 / ((kernel_length - 1.) / 2. + 1.);
-	xinterp = XLALREAL8TimeSeriesInterpCreate(xsignal, kernel_length, highfreq_kernel, &xdata);
-	yinterp = XLALREAL8TimeSeriesInterpCreate(ysignal, kernel_length, highfreq_kernel, &ydata);
-	if(!xinterp || !yinterp)
-		goto error;
-
-	/* compute output sample by sample */
-	/* FIXME: Now xdata and ydata are not renewed until geometric delay
-	 * changes significantly. This can cause systematic errors. For
-	 * example, if the detector is on the North pole, xdata and ydata
-	 * are never renewed although armcos can be changing. */
-
-	for(i = 0; i < h->data->length; i++) {
-		/* time of sample in detector */
-		t = h->epoch;
-		if(!XLALGPSAdd(&t, i * h->deltaT))
-			goto error;
-
-		/* geometric delay from geocentre and highfreq_kernel_data */
-		if(!(i % det_resp_interval)) {
-			geometric_delay = -XLALTimeDelayFromEarthCenter(detector->location, right_ascension, declination, &t);
-			/* Compute highfreq_kernel_data */
-			double armlen = XLAL_REAL8_FAIL_NAN;
-			XLALComputeDetAMResponseParts(&armlen, &xdata.armcos, &ydata.armcos, &fxplus, &fyplus, &fxcross, &fycross, detector, right_ascension, declination, psi, XLALGreenwichMeanSiderealTime(&t));
-			armlen /= LAL_C_SI * h->deltaT;
-			xdata.T = armlen;
-			ydata.T = armlen;
-		}
-		if(XLAL_IS_REAL8_FAIL_NAN(geometric_delay))
-			goto error;
-		if(XLAL_IS_REAL8_FAIL_NAN(xdata.T) || XLAL_IS_REAL8_FAIL_NAN(ydata.T) || XLAL_IS_REAL8_FAIL_NAN(xdata.armcos) || XLAL_IS_REAL8_FAIL_NAN(ydata.armcos))
-			goto error;
-
-		/* time of sample at geocentre */
-		if(!XLALGPSAdd(&t, geometric_delay))
-			goto error;
 
-		/* evaluate linear combination of interpolators */
-		h->data->data[i] = XLALREAL8TimeSeriesInterpEval(xinterp, &t, 0) + XLALREAL8TimeSeriesInterpEval(yinterp, &t, 0);
+	if(XLALSimMultiDetectorStrainREAL8TimeSeries(&h, hplus, hcross, right_ascension, declination, psi, detector, 1) < 0)
+		XLAL_ERROR_NULL(XLAL_EFUNC);
 
-		if(XLAL_IS_REAL8_FAIL_NAN(h->data->data[i]))
-			goto error;
-	}
-
-	/* done */
-	XLALREAL8TimeSeriesInterpDestroy(xinterp);
-	XLALREAL8TimeSeriesInterpDestroy(yinterp);
-	XLALDestroyREAL8TimeSeries(xsignal);
-	XLALDestroyREAL8TimeSeries(ysignal);
 	return h;
-
-error:
-	XLALREAL8TimeSeriesInterpDestroy(xinterp);
-	XLALREAL8TimeSeriesInterpDestroy(yinterp);
-	XLALDestroyREAL8TimeSeries(xsignal);
-	XLALDestroyREAL8TimeSeries(ysignal);
-	XLALDestroyREAL8TimeSeries(h);
-	XLAL_ERROR_NULL(XLAL_EFUNC);
 }
 
 
@@ -2378,3 +2650,600 @@ freereturn:
 		XLAL_ERROR(errnum);
 	return 0;
 }
+
+
+/*
+ * ============================================================================
+ *
+ *                      Frequency-Domain Injection Engine
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * The engine synthesizes the detector strain of frequency-domain waveforms
+ * directly on a grid of overlapping chunks.  The geocentric arrival time
+ * of each frequency, t(f), is obtained from the derivative of the
+ * waveform's phase, and the waveform is split between the chunks with
+ * windows W_k(t(f)) that sum to unity.  To the extent that the stationary
+ * phase approximation holds, the part of the waveform assigned to a chunk
+ * is confined in time to that chunk, so it can be sampled on the chunk's
+ * coarse frequency grid without wrap-around, and the detector response
+ * can be evaluated at the chunk's time.  The contributions of all
+ * injections to a chunk are summed in the frequency domain, the chunk is
+ * transformed to the time domain with one inverse FFT, and the chunks are
+ * added to the target.
+ */
+
+
+/* default duration of the chunk FFTs */
+#define FD_INJECTION_DEFAULT_CHUNK_DURATION 32.0	/* s */
+/* bins whose power is below this fraction of the peak do not update the
+ * unwrapped arrival time */
+#define FD_INJECTION_POWER_THRESHOLD 1e-12
+/* minimum number of chunk frequency bins a waveform's frequency must sweep
+ * through per chunk spacing for the split between chunks to be accurate to
+ * about 1% */
+#define FD_INJECTION_MIN_SWEEP_BINS 64
+/* bins whose power is below this fraction of the peak are not checked
+ * against FD_INJECTION_MIN_SWEEP_BINS */
+#define FD_INJECTION_SWEEP_THRESHOLD 1e-4
+
+
+struct fd_injection {
+	LIGOTimeGPS epoch;	/* start of the waveform at the geocentre */
+	unsigned length;	/* number of frequency bins */
+	COMPLEX16 *hplus;	/* plus polarization on the chunk frequency grid */
+	COMPLEX16 *hcross;	/* cross polarization on the chunk frequency grid */
+	double *t;	/* arrival time at the geocentre relative to epoch */
+	double tmin;	/* earliest arrival time */
+	double tmax;	/* latest arrival time */
+	double right_ascension;
+	double declination;
+	double psi;
+};
+
+
+struct tagLALSimFDInjectionEngine {
+	double deltaT;	/* sample interval of the targets */
+	unsigned fftlen;	/* chunk FFT length in samples */
+	unsigned hop;	/* chunk spacing in samples */
+	LALUnit sampleUnits;	/* units of the injections' frequency series */
+	REAL8FFTPlan *revplan;	/* cached reverse plan */
+	REAL8TimeSeries *segment;	/* time series of one chunk */
+	COMPLEX16FrequencySeries *work;	/* spectrum of one chunk */
+	unsigned num_injections;
+	unsigned max_injections;
+	struct fd_injection *injections;
+};
+
+
+static void fd_injection_free(struct fd_injection *injection)
+{
+	XLALFree(injection->hplus);
+	XLALFree(injection->hcross);
+	XLALFree(injection->t);
+}
+
+
+/* arrival time of input bin n, modulo the input's period, from the phase
+ * increment to the next bin (or from the previous bin, for the last
+ * one) */
+static double fd_injection_group_delay(const COMPLEX16FrequencySeries *hptilde, const COMPLEX16FrequencySeries *hctilde, unsigned n)
+{
+	const COMPLEX16 *hp = hptilde->data->data;
+	const COMPLEX16 *hc = hctilde->data->data;
+	COMPLEX16 z;
+
+	if(n + 1 < hptilde->data->length)
+		z = hp[n + 1] * conj(hp[n]) + hc[n + 1] * conj(hc[n]);
+	else
+		z = hp[n] * conj(hp[n - 1]) + hc[n] * conj(hc[n - 1]);
+	return -carg(z) / (LAL_TWOPI * hptilde->deltaF);
+}
+
+
+/* replaces the power of chunk bin j, stored in injection->t[j], with its
+ * arrival time, unwrapped from the arrival time tprev of the neighbouring
+ * bin closer to the peak, and returns it.  n is the corresponding input
+ * bin */
+static double fd_injection_track(struct fd_injection *injection, unsigned j, double tprev, double threshold, const COMPLEX16FrequencySeries *hptilde, const COMPLEX16FrequencySeries *hctilde, unsigned n)
+{
+	const double period = 1. / hptilde->deltaF;
+	double t;
+
+	/* insignificant bins take the time of the neighbouring significant
+	 * one */
+	if(injection->t[j] <= threshold)
+		return injection->t[j] = tprev;
+
+	t = fd_injection_group_delay(hptilde, hctilde, n);
+	t += period * round((tprev - t) / period);
+
+	if(t < injection->tmin)
+		injection->tmin = t;
+	if(t > injection->tmax)
+		injection->tmax = t;
+	return injection->t[j] = t;
+}
+
+
+/**
+ * @brief Creates an engine that injects frequency-domain waveforms
+ * @details
+ * The engine synthesizes the detector strain of frequency-domain
+ * waveforms, such as those returned by XLALSimInspiralChooseFDWaveform(),
+ * without transforming the full-length waveforms to the time domain.  The
+ * target time series is covered by chunks whose FFTs are chunk_duration
+ * long and which are spaced by a quarter of that.  Each waveform is split
+ * between the chunks according to the arrival time of each of its
+ * frequencies, which is computed from the derivative of the waveform's
+ * phase, and the antenna response, the geometric delay and its rate of
+ * change (the Doppler shift) are evaluated at the time of each chunk.  All
+ * the injections contributing to a chunk are summed in the frequency
+ * domain and transformed to the time domain with one inverse FFT, whose
+ * plan is created once, by this function, and reused.
+ *
+ * The split is only accurate where a waveform's frequency changes by many
+ * chunk frequency bins over a chunk spacing, so
+ * XLALSimFDInjectionEngineAddInjection() rejects waveforms that chirp too
+ * slowly for the chunk duration.  The default 32 s chunks accept binary
+ * neutron stars starting above about 30 Hz;  a binary neutron star starting
+ * at 10 Hz needs 512 s chunks.
+ *
+ * Waveforms are queued with XLALSimFDInjectionEngineAddInjection() and
+ * added to the data of a detector with
+ * XLALSimFDInjectionEngineInjectREAL8TimeSeries(), which can be called for
+ * several detectors with the same queue.
+ *
+ * @param[in] deltaT Sample interval of the target time series
+ * @param[in] chunk_duration Duration of the chunk FFTs in seconds,
+ * rounded up to a power of two number of samples, or 0 for the default of
+ * 32 s
+ *
+ * @returns
+ * Pointer to the engine, which must be destroyed with
+ * XLALDestroySimFDInjectionEngine(), or NULL on failure.
+ *
+ * @note
+ * The split of a waveform between chunks relies on the stationary phase
+ * approximation:  the waveform's frequency must sweep through many
+ * frequency bins of the chunk FFTs within each chunk.  Waveforms whose rate
+ * of change of frequency falls below 256 / chunk_duration^2 at any
+ * frequency carrying significant power are rejected;  with this bound the
+ * error of the split is about 1% of the amplitude.
+ */
+LALSimFDInjectionEngine *XLALCreateSimFDInjectionEngine(
+	REAL8 deltaT,
+	REAL8 chunk_duration
+)
+{
+	LALSimFDInjectionEngine *engine;
+	LIGOTimeGPS epoch = LIGOTIMEGPSZERO;
+	unsigned long fftlen;
+
+	if(!(deltaT > 0.) || chunk_duration < 0.)
+		XLAL_ERROR_NULL(XLAL_EINVAL);
+	if(chunk_duration == 0.)
+		chunk_duration = FD_INJECTION_DEFAULT_CHUNK_DURATION;
+
+	fftlen = round_up_to_power_of_two(ceil(chunk_duration / deltaT));
+	if(fftlen < 8 || fftlen > 1UL << 31) {
+		XLALPrintError("%s(): error: chunk duration must be between 8 and 2^31 samples\n", __func__);
+		XLAL_ERROR_NULL(XLAL_EINVAL);
+	}
+
+	engine = XLALCalloc(1, sizeof(*engine));
+	if(!engine)
+		XLAL_ERROR_NULL(XLAL_ENOMEM);
+	engine->deltaT = deltaT;
+	engine->fftlen = fftlen;
+	engine->hop = fftlen / 4;
+	engine->revplan = XLALCreateReverseREAL8FFTPlan(fftlen, 0);
+	engine->segment = XLALCreateREAL8TimeSeries(NULL, &epoch, 0., deltaT, &lalDimensionlessUnit, fftlen);
+	engine->work = XLALCreateCOMPLEX16FrequencySeries(NULL, &epoch, 0., 1. / (fftlen * deltaT), &lalDimensionlessUnit, fftlen / 2 + 1);
+	if(!engine->revplan || !engine->segment || !engine->work) {
+		XLALDestroySimFDInjectionEngine(engine);
+		XLAL_ERROR_NULL(XLAL_EFUNC);
+	}
+
+	return engine;
+}
+
+
+/**
+ * @brief Destroys an engine created with XLALCreateSimFDInjectionEngine()
+ * together with its queue of injections
+ */
+void XLALDestroySimFDInjectionEngine(LALSimFDInjectionEngine *engine)
+{
+	if(!engine)
+		return;
+	XLALSimFDInjectionEngineClear(engine);
+	XLALFree(engine->injections);
+	XLALDestroyREAL8FFTPlan(engine->revplan);
+	XLALDestroyREAL8TimeSeries(engine->segment);
+	XLALDestroyCOMPLEX16FrequencySeries(engine->work);
+	XLALFree(engine);
+}
+
+
+/**
+ * @brief Removes all injections from the queue of an engine
+ * @details
+ * The FFT plan and workspace are kept, so the engine can be reused for the
+ * injections of the next data segment.
+ */
+void XLALSimFDInjectionEngineClear(LALSimFDInjectionEngine *engine)
+{
+	unsigned i;
+
+	if(!engine)
+		return;
+	for(i = 0; i < engine->num_injections; i++)
+		fd_injection_free(&engine->injections[i]);
+	engine->num_injections = 0;
+}
+
+
+/**
+ * @brief Returns the frequency resolution of the chunk FFTs of an engine
+ * @details
+ * The frequency resolution of the waveforms passed to
+ * XLALSimFDInjectionEngineAddInjection() must be this divided by a
+ * positive integer.
+ */
+REAL8 XLALSimFDInjectionEngineGetDeltaF(const LALSimFDInjectionEngine *engine)
+{
+	if(!engine)
+		XLAL_ERROR_REAL8(XLAL_EFAULT);
+	return engine->work->deltaF;
+}
+
+
+/**
+ * @brief Adds a frequency-domain waveform to the queue of an engine
+ * @details
+ * The waveform is resampled to the frequency grid of the chunk FFTs and
+ * the arrival time of each of its frequencies is computed, so the input
+ * frequency series can be destroyed after this call.
+ *
+ * The frequency series' epochs must be set to the start of the
+ * corresponding time series at the geocentre, e.g. by adding the
+ * geocentric arrival time of the signal to the epochs of the series
+ * returned by XLALSimInspiralChooseFDWaveform().  The inverse of their
+ * frequency resolution must be an integer multiple of the chunk duration
+ * (see XLALSimFDInjectionEngineGetDeltaF()) and at least as long as the
+ * signal.  Each frequency must reach the detector at a single time, as for
+ * the inspiral, merger and ringdown of a compact binary, so signals that
+ * overlap in frequency must be added as separate injections.
+ *
+ * The waveform's frequency must change quickly enough for the stationary
+ * phase approximation to hold on the engine's chunks (see
+ * XLALCreateSimFDInjectionEngine());  otherwise the waveform is not queued,
+ * the chunk duration it requires is reported, and XLAL_EINVAL is raised.
+ *
+ * @param[in,out] engine Pointer to the engine
+ * @param[in] hptilde Pointer to a COMPLEX16FrequencySeries containing the plus polarization waveform
+ * @param[in] hctilde Pointer to a COMPLEX16FrequencySeries containing the cross polarization waveform
+ * @param[in] right_ascension The right ascension of the source in radians
+ * @param[in] declination The declination of the source in radians
+ * @param[in] psi The polarization angle giving the orientation of the wave co-ordinate system in radians
+ *
+ * @retval 0 Success
+ * @retval <0 Failure
+ */
+int XLALSimFDInjectionEngineAddInjection(
+	LALSimFDInjectionEngine *engine,
+	const COMPLEX16FrequencySeries *hptilde,
+	const COMPLEX16FrequencySeries *hctilde,
+	REAL8 right_ascension,
+	REAL8 declination,
+	REAL8 psi
+)
+{
+	struct fd_injection injection;
+	const COMPLEX16 *hp, *hc;
+	double ratio, period, peak, tpeak, tprev;
+	double chunk_duration, max_step;
+	unsigned stride, n, j, jpeak;
+
+	/* check input */
+
+	if(!engine)
+		XLAL_ERROR(XLAL_EFAULT);
+	LAL_CHECK_VALID_SERIES(hptilde, XLAL_FAILURE);
+	LAL_CHECK_VALID_SERIES(hctilde, XLAL_FAILURE);
+	if(XLALGPSCmp(&hptilde->epoch, &hctilde->epoch) || hptilde->deltaF != hctilde->deltaF || hptilde->data->length != hctilde->data->length || XLALUnitCompare(&hptilde->sampleUnits, &hctilde->sampleUnits)) {
+		XLALPrintError("%s(): error: input frequency series are not consistent\n", __func__);
+		XLAL_ERROR(XLAL_EINVAL);
+	}
+	if(hptilde->f0 != 0. || hptilde->data->length < 2) {
+		XLALPrintError("%s(): error: input frequency series must start at DC and contain at least 2 bins\n", __func__);
+		XLAL_ERROR(XLAL_EINVAL);
+	}
+	ratio = engine->work->deltaF / hptilde->deltaF;
+	if(!(ratio >= 0.5) || fabs(ratio - round(ratio)) > 1e-9 * ratio) {
+		XLALPrintError("%s(): error: input frequency resolution %g Hz is not the chunk frequency resolution %g Hz divided by an integer\n", __func__, hptilde->deltaF, engine->work->deltaF);
+		XLAL_ERROR(XLAL_EINVAL);
+	}
+	stride = round(ratio);
+
+	/* all injections must have the same units */
+
+	if(engine->num_injections && XLALUnitCompare(&hptilde->sampleUnits, &engine->sampleUnits)) {
+		XLALPrintError("%s(): error: input units do not match those of the queued injections\n", __func__);
+		XLAL_ERROR(XLAL_EUNIT);
+	}
+
+	/* grow the queue */
+
+	if(engine->num_injections == engine->max_injections) {
+		unsigned max_injections = engine->max_injections ? 2 * engine->max_injections : 16;
+		struct fd_injection *injections = XLALRealloc(engine->injections, max_injections * sizeof(*injections));
+		if(!injections)
+			XLAL_ERROR(XLAL_ENOMEM);
+		engine->injections = injections;
+		engine->max_injections = max_injections;
+	}
+
+	/* resample to the chunk frequency grid by taking every stride-th
+	 * bin, dropping frequencies above the Nyquist frequency of the
+	 * targets */
+
+	injection.epoch = hptilde->epoch;
+	injection.length = (hptilde->data->length - 1) / stride + 1;
+	if(injection.length > engine->work->data->length)
+		injection.length = engine->work->data->length;
+	injection.hplus = XLALMalloc(injection.length * sizeof(*injection.hplus));
+	injection.hcross = XLALMalloc(injection.length * sizeof(*injection.hcross));
+	injection.t = XLALMalloc(injection.length * sizeof(*injection.t));
+	if(!injection.hplus || !injection.hcross || !injection.t) {
+		fd_injection_free(&injection);
+		XLAL_ERROR(XLAL_ENOMEM);
+	}
+	injection.right_ascension = right_ascension;
+	injection.declination = declination;
+	injection.psi = psi;
+
+	/* the arrival time of frequency f is -(1 / 2 pi) d phase / df.  the
+	 * phase increment between neighbouring input bins gives it modulo
+	 * the input's period;  it is unwrapped by requiring continuity in
+	 * frequency, outwards from the bin with the most power, which is
+	 * placed within the input's period.  the bins at the edges of the
+	 * band can be dominated by spectral leakage whose phase carries no
+	 * timing information, so they are not used as the reference.  the
+	 * power in both polarizations is used so that neither needs to be
+	 * non-zero */
+
+	hp = hptilde->data->data;
+	hc = hctilde->data->data;
+	period = 1. / hptilde->deltaF;
+	for(j = 0, jpeak = 0, peak = 0.; j < injection.length; j++) {
+		n = j * stride;
+		injection.hplus[j] = hp[n];
+		injection.hcross[j] = hc[n];
+		injection.t[j] = cabs(hp[n]) * cabs(hp[n]) + cabs(hc[n]) * cabs(hc[n]);
+		if(injection.t[j] > peak) {
+			peak = injection.t[j];
+			jpeak = j;
+		}
+	}
+	if(peak == 0.) {
+		/* nothing to inject */
+		fd_injection_free(&injection);
+		return 0;
+	}
+
+	tpeak = fd_injection_group_delay(hptilde, hctilde, jpeak * stride);
+	tpeak -= period * floor(tpeak / period);
+
+	injection.tmin = +INFINITY;
+	injection.tmax = -INFINITY;
+	for(j = jpeak, tprev = tpeak; j < injection.length; j++)
+		tprev = fd_injection_track(&injection, j, tprev, FD_INJECTION_POWER_THRESHOLD * peak, hptilde, hctilde, j * stride);
+	for(j = jpeak, tprev = tpeak; j-- > 0;)
+		tprev = fd_injection_track(&injection, j, tprev, FD_INJECTION_POWER_THRESHOLD * peak, hptilde, hctilde, j * stride);
+
+	/* the frequency must sweep through FD_INJECTION_MIN_SWEEP_BINS chunk
+	 * bins within a chunk spacing, i.e. the rate of change of the
+	 * frequency must be at least 4 * FD_INJECTION_MIN_SWEEP_BINS /
+	 * chunk_duration^2.  the arrival times are compared across that many
+	 * bins rather than between neighbours, which averages out the ripple
+	 * in t(f) caused by the ends of the waveform */
+
+	chunk_duration = engine->fftlen * engine->deltaT;
+	for(j = 0, max_step = 0.; j + FD_INJECTION_MIN_SWEEP_BINS < injection.length; j++) {
+		const unsigned l = j + FD_INJECTION_MIN_SWEEP_BINS;
+		if(cabs(injection.hplus[j]) * cabs(injection.hplus[j]) + cabs(injection.hcross[j]) * cabs(injection.hcross[j]) < FD_INJECTION_SWEEP_THRESHOLD * peak)
+			continue;
+		if(cabs(injection.hplus[l]) * cabs(injection.hplus[l]) + cabs(injection.hcross[l]) * cabs(injection.hcross[l]) < FD_INJECTION_SWEEP_THRESHOLD * peak)
+			continue;
+		if(fabs(injection.t[l] - injection.t[j]) > max_step)
+			max_step = fabs(injection.t[l] - injection.t[j]);
+	}
+	if(max_step > engine->hop * engine->deltaT) {
+		XLALPrintError("%s(): error: waveform's frequency changes too slowly for %g s chunks, the stationary phase approximation requires chunks of at least %g s\n", __func__, chunk_duration, sqrt(4. * max_step * chunk_duration));
+		fd_injection_free(&injection);
+		XLAL_ERROR(XLAL_EINVAL);
+	}
+
+	engine->sampleUnits = hptilde->sampleUnits;
+	engine->injections[engine->num_injections++] = injection;
+
+	return 0;
+}
+
+
+/**
+ * @brief Adds the strain of the queued injections to the data of a
+ * detector
+ * @details
+ * The antenna response, the geometric delay and its rate of change are
+ * evaluated at the centre of each chunk, and the x- and y-arm transfer
+ * functions are applied at each frequency, so the result includes the
+ * Doppler shift due to the rotation of the Earth and deviations from the
+ * long-wavelength limit.  Only the chunks overlapping both the target and
+ * at least one injection are synthesized, with one inverse FFT each.  The
+ * queue is left unchanged so the same injections can be added to the data
+ * of other detectors.
+ *
+ * @param[in,out] engine Pointer to the engine
+ * @param[in,out] target Time series to inject strain into;  its sample
+ * interval must be that of the engine
+ * @param[in] detector Detector to use when computing strain
+ * @param[in] response Response function transforming strain to detector
+ * output units, or NULL for unit response;  frequencies are rounded to the
+ * nearest bin and clamped to its domain of definition
+ *
+ * @retval 0 Success
+ * @retval <0 Failure
+ */
+int XLALSimFDInjectionEngineInjectREAL8TimeSeries(
+	LALSimFDInjectionEngine *engine,
+	REAL8TimeSeries *target,
+	const LALDetector *detector,
+	const COMPLEX16FrequencySeries *response
+)
+{
+	const double delay_step = 1.;	/* s, for the rate of change of the delay */
+	COMPLEX16FrequencySeries *work;
+	REAL8TimeSeries *segment;
+	LALUnit sampleUnits;
+	double hop_duration;
+	double tmin, tmax;
+	unsigned i, j;
+	long k;
+
+	/* check input */
+
+	if(!engine || !detector)
+		XLAL_ERROR(XLAL_EFAULT);
+	LAL_CHECK_VALID_SERIES(target, XLAL_FAILURE);
+	if(fabs(target->deltaT - engine->deltaT) > LAL_REAL8_EPS)
+		XLAL_ERROR(XLAL_ETIME);
+	if(target->f0 != 0.)
+		XLAL_ERROR(XLAL_EFREQ);
+	if(!engine->num_injections)
+		return 0;
+	if(!XLALUnitMultiply(&sampleUnits, &engine->sampleUnits, &lalHertzUnit))
+		XLAL_ERROR(XLAL_EFUNC);
+	if(!response && XLALUnitCompare(&target->sampleUnits, &sampleUnits))
+		XLAL_ERROR(XLAL_EUNIT);
+
+	work = engine->work;
+	segment = engine->segment;
+	hop_duration = engine->hop * engine->deltaT;
+
+	/* span of arrival times at the geocentre relative to the target */
+
+	tmin = +INFINITY;
+	tmax = -INFINITY;
+	for(i = 0; i < engine->num_injections; i++) {
+		const struct fd_injection *injection = &engine->injections[i];
+		const double dt = XLALGPSDiff(&injection->epoch, &target->epoch);
+		if(dt + injection->tmin < tmin)
+			tmin = dt + injection->tmin;
+		if(dt + injection->tmax > tmax)
+			tmax = dt + injection->tmax;
+	}
+
+	/* chunk k is centred on sample k * hop of the target, its window
+	 * covers the hop on either side and its FFT the two hops on either
+	 * side.  loop over the chunks whose FFTs overlap the target and
+	 * whose windows overlap an injection */
+
+	for(k = -1; (k - 2) * (long) engine->hop < (long) target->data->length; k++) {
+		const double tc = k * hop_duration;
+		const long start = (k - 2) * (long) engine->hop;
+		LIGOTimeGPS t_centre = target->epoch;
+		double gmst;
+		int empty = 1;
+
+		if(tc + hop_duration <= tmin || tc - hop_duration >= tmax)
+			continue;
+
+		if(!XLALGPSAdd(&t_centre, tc))
+			XLAL_ERROR(XLAL_EFUNC);
+		gmst = XLALGreenwichMeanSiderealTime(&t_centre);
+		if(XLAL_IS_REAL8_FAIL_NAN(gmst))
+			XLAL_ERROR(XLAL_EFUNC);
+
+		memset(work->data->data, 0, work->data->length * sizeof(*work->data->data));
+		work->epoch = target->epoch;
+		if(!XLALGPSAdd(&work->epoch, start * engine->deltaT))
+			XLAL_ERROR(XLAL_EFUNC);
+
+		for(i = 0; i < engine->num_injections; i++) {
+			const struct fd_injection *injection = &engine->injections[i];
+			/* start of the waveform relative to the chunk's centre */
+			const double dt = XLALGPSDiff(&injection->epoch, &t_centre);
+			LIGOTimeGPS t_before = t_centre, t_after = t_centre;
+			double xcos, ycos, fxplus, fyplus, fxcross, fycross, armlen;
+			double delay, delay_dot;
+
+			if(dt + injection->tmax <= -hop_duration || dt + injection->tmin >= hop_duration)
+				continue;
+			empty = 0;
+
+			XLALComputeDetAMResponseParts(&armlen, &xcos, &ycos, &fxplus, &fyplus, &fxcross, &fycross, detector, injection->right_ascension, injection->declination, injection->psi, gmst);
+			if(!XLALGPSAdd(&t_before, -delay_step) || !XLALGPSAdd(&t_after, +delay_step))
+				XLAL_ERROR(XLAL_EFUNC);
+			delay = XLALTimeDelayFromEarthCenter(detector->location, injection->right_ascension, injection->declination, &t_centre);
+			delay_dot = (XLALTimeDelayFromEarthCenter(detector->location, injection->right_ascension, injection->declination, &t_after) - XLALTimeDelayFromEarthCenter(detector->location, injection->right_ascension, injection->declination, &t_before)) / (2. * delay_step);
+			if(XLAL_IS_REAL8_FAIL_NAN(delay) || XLAL_IS_REAL8_FAIL_NAN(delay_dot))
+				XLAL_ERROR(XLAL_EFUNC);
+
+			for(j = 1; j < injection->length && j < work->data->length - 1; j++) {
+				/* arrival time at the geocentre relative to the
+				 * chunk's centre, in hops */
+				const double t = dt + injection->t[j];
+				const double x = t / hop_duration;
+				const double f = j * work->deltaF;
+				double w;
+				COMPLEX16 Tx, Ty, fac;
+
+				if(x <= -1. || x >= 1.)
+					continue;
+				w = cos(LAL_PI_2 * x);
+				w *= w;
+
+				/* arm transfer functions, and the phase that
+				 * moves the waveform from its epoch to the time
+				 * it reaches the detector, relative to the start
+				 * of the chunk's FFT */
+				Tx = XLALComputeDetArmTransferFunction(f * armlen / LAL_C_SI, xcos);
+				Ty = XLALComputeDetArmTransferFunction(f * armlen / LAL_C_SI, ycos);
+				fac = w * cexp(-I * LAL_TWOPI * f * (dt + 2. * hop_duration + delay + delay_dot * t));
+				if(response) {
+					long l = floor((f - response->f0) / response->deltaF + 0.5);
+					if(l < 0)
+						l = 0;
+					else if(l > (long) response->data->length - 1)
+						l = response->data->length - 1;
+					if(response->data->data[l] == 0.0)
+						continue;
+					fac /= response->data->data[l];
+				}
+
+				work->data->data[j] += fac * ((Tx * fxplus + Ty * fyplus) * injection->hplus[j] + (Tx * fxcross + Ty * fycross) * injection->hcross[j]);
+			}
+		}
+		if(empty)
+			continue;
+
+		/* return the chunk to the time domain and add it to the
+		 * target.  the DC and Nyquist components are zeroed */
+
+		work->sampleUnits = engine->sampleUnits;
+		work->data->data[0] = 0.;
+		work->data->data[work->data->length - 1] = 0.;
+		if(XLALREAL8FreqTimeFFT(segment, work, engine->revplan))
+			XLAL_ERROR(XLAL_EFUNC);
+		for(j = start < 0 ? -start : 0; j < engine->fftlen && start + (long) j < (long) target->data->length; j++)
+			target->data->data[start + j] += segment->data->data[j];
+	}
+
+	return 0;
+}
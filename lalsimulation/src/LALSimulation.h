@@ -51,6 +51,11 @@
  * XLALSimAddInjectionREAL8TimeSeries(data, strain, NULL);
  * @endcode
  *
+ * Frequency-domain waveforms can be injected without transforming them to
+ * the time domain by queueing them in an engine created with
+ * XLALCreateSimFDInjectionEngine(), and adding their strain to the data of
+ * each detector with XLALSimFDInjectionEngineInjectREAL8TimeSeries().
+ *
  * ### Coordinate Systems
  *
  * The diagram below illustrates the relationship between the wave frame
@@ -154,6 +159,19 @@ REAL8TimeSeries *XLALSimDetectorStrainREAL8TimeSeries(
 	const LALDetector *detector
 );
 
+#ifndef SWIG /* exclude from SWIG interface */
+int XLALSimMultiDetectorStrainREAL8TimeSeries(
+	REAL8TimeSeries **h,
+	const REAL8TimeSeries *hplus,
+	const REAL8TimeSeries *hcross,
+	REAL8 right_ascension,
+	REAL8 declination,
+	REAL8 psi,
+	const LALDetector *detectors,
+	UINT4 num_detectors
+);
+#endif
+
 int XLALSimAddInjectionREAL8TimeSeries(
 	REAL8TimeSeries *target,
 	REAL8TimeSeries *h,
@@ -210,6 +228,42 @@ int XLALSimInjectLWLDetectorStrainREAL4TimeSeries(
 	const COMPLEX8FrequencySeries *response
 );
 
+/** Incomplete type for an engine injecting frequency-domain waveforms. */
+typedef struct tagLALSimFDInjectionEngine LALSimFDInjectionEngine;
+
+LALSimFDInjectionEngine *XLALCreateSimFDInjectionEngine(
+	REAL8 deltaT,
+	REAL8 chunk_duration
+);
+
+void XLALDestroySimFDInjectionEngine(
+	LALSimFDInjectionEngine *engine
+);
+
+void XLALSimFDInjectionEngineClear(
+	LALSimFDInjectionEngine *engine
+);
+
+REAL8 XLALSimFDInjectionEngineGetDeltaF(
+	const LALSimFDInjectionEngine *engine
+);
+
+int XLALSimFDInjectionEngineAddInjection(
+	LALSimFDInjectionEngine *engine,
+	const COMPLEX16FrequencySeries *hptilde,
+	const COMPLEX16FrequencySeries *hctilde,
+	REAL8 right_ascension,
+	REAL8 declination,
+	REAL8 psi
+);
+
+int XLALSimFDInjectionEngineInjectREAL8TimeSeries(
+	LALSimFDInjectionEngine *engine,
+	REAL8TimeSeries *target,
+	const LALDetector *detector,
+	const COMPLEX16FrequencySeries *response
+);
+
 /** @} */
 
 #if 0
@@ -0,0 +1,142 @@
+/*
+ *  Copyright (C) 2018 The LALSuite developers
+ *
+ *  Time time-domain waveforms whose orbital dynamics are integrated with
+ *  the adaptive Runge-Kutta integrator, for each of its steppers.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with with program; see the file COPYING. If not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ *  MA  02111-1307  USA
+ */
+
+/*
+ * Usage: AdaptiveRungeKuttaBench
+ *
+ * For each approximant and stepper, prints the number of samples, the
+ * wall-clock time per waveform, the speed-up relative to the GSL stepper,
+ * and the maximum difference in h+ from the GSL waveform relative to the
+ * peak of |h+|. The stepper is changed with
+ * XLALAdaptiveRungeKuttaSetDefaultStepper(), so only integrators created
+ * with XLALAdaptiveRungeKutta4Init() are affected.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <lal/LALAdaptiveRungeKuttaIntegrator.h>
+#include <lal/LALConstants.h>
+#include <lal/LALDatatypes.h>
+#include <lal/LALSimInspiral.h>
+#include <lal/LogPrintf.h>
+#include <lal/TimeSeries.h>
+
+/* minimum time spent timing each configuration (s) */
+#define MIN_BENCH_TIME 2.0
+
+static const Approximant approximants[] = {
+  SpinTaylorT4,
+  SEOBNRv3,
+};
+
+static const LALAdaptiveRungeKuttaStepper steppers[] = {
+  LAL_ADAPTIVE_RK_STEPPER_GSL,
+  LAL_ADAPTIVE_RK_STEPPER_RKF45,
+  LAL_ADAPTIVE_RK_STEPPER_DOPRI5,
+};
+
+static const char *const stepper_names[] = { "GSL", "RKF45", "DOPRI5" };
+
+static int generate(Approximant approximant, REAL8TimeSeries **hplus) {
+  REAL8TimeSeries *hcross = NULL;
+  /* a precessing BBH */
+  int ret = XLALSimInspiralChooseTDWaveform(hplus, &hcross,
+      20. * LAL_MSUN_SI, 12. * LAL_MSUN_SI, 0.3, 0., 0.2, 0., 0.25, -0.1,
+      1e8 * LAL_PC_SI, 0.4, 0., 0., 0., 0.,
+      1. / 4096., 20., 20., NULL, approximant);
+  XLALDestroyREAL8TimeSeries(hcross);
+  return ret;
+}
+
+static REAL8 time_per_waveform(Approximant approximant, REAL8TimeSeries **hplus) {
+  REAL8 start, elapsed;
+  UINT4 n = 0;
+
+  /* warm up, and keep the waveform for comparison */
+  if (generate(approximant, hplus) != XLAL_SUCCESS)
+    return -1.;
+
+  start = XLALGetTimeOfDay();
+  do {
+    REAL8TimeSeries *hp = NULL;
+    int ret = generate(approximant, &hp);
+    XLALDestroyREAL8TimeSeries(hp);
+    if (ret != XLAL_SUCCESS)
+      return -1.;
+    n++;
+    elapsed = XLALGetTimeOfDay() - start;
+  } while (elapsed < MIN_BENCH_TIME);
+
+  return elapsed / n;
+}
+
+/* maximum difference between two waveforms aligned at their ends, relative to the peak of |ref| */
+static REAL8 max_relative_difference(const REAL8TimeSeries *ref, const REAL8TimeSeries *h) {
+  const size_t nref = ref->data->length, nh = h->data->length;
+  const size_t n = nref < nh ? nref : nh;
+  REAL8 peak = 0., diff = 0.;
+  for (size_t j = 0; j < nref; j++)
+    peak = fmax(peak, fabs(ref->data->data[j]));
+  for (size_t j = 1; j <= n; j++)
+    diff = fmax(diff, fabs(ref->data->data[nref - j] - h->data->data[nh - j]));
+  return peak > 0. ? diff / peak : diff;
+}
+
+int main(void) {
+  const LALAdaptiveRungeKuttaStepper default_stepper = XLALAdaptiveRungeKuttaGetDefaultStepper();
+  size_t a, s;
+
+  printf("%-14s %8s %9s %14s %8s %12s\n", "approximant", "stepper", "samples", "t/wf [s]", "speedup", "max |dh+|");
+  for (a = 0; a < sizeof(approximants) / sizeof(*approximants); a++) {
+    REAL8TimeSeries *ref = NULL;
+    REAL8 tref = 0.;
+    for (s = 0; s < sizeof(steppers) / sizeof(*steppers); s++) {
+      REAL8TimeSeries *hplus = NULL;
+      REAL8 t;
+      XLALAdaptiveRungeKuttaSetDefaultStepper(steppers[s]);
+      t = time_per_waveform(approximants[a], &hplus);
+      if (t < 0) {
+        fprintf(stderr, "failed to generate %s with the %s stepper\n",
+            XLALSimInspiralGetStringFromApproximant(approximants[a]), stepper_names[s]);
+        return 1;
+      }
+      if (steppers[s] == LAL_ADAPTIVE_RK_STEPPER_GSL) {
+        ref = hplus;
+        tref = t;
+      }
+      printf("%-14s %8s %9u %14.6e %8.2f %12.3e\n",
+          XLALSimInspiralGetStringFromApproximant(approximants[a]),
+          stepper_names[s], hplus->data->length, t, tref / t,
+          max_relative_difference(ref, hplus));
+      fflush(stdout);
+      if (hplus != ref)
+        XLALDestroyREAL8TimeSeries(hplus);
+    }
+    XLALDestroyREAL8TimeSeries(ref);
+  }
+
+  XLALAdaptiveRungeKuttaSetDefaultStepper(default_stepper);
+
+  return 0;
+}
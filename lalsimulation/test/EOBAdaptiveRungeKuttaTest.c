@@ -0,0 +1,83 @@
+/*
+ *  Copyright (C) 2018 The LALSuite developers
+ *
+ *  Check that the orbital dynamics of an EOB waveform sampled with the dense
+ *  output of the inlined steppers of the adaptive Runge-Kutta integrator
+ *  agree with the cubic-spline interpolation of the GSL stepper.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with with program; see the file COPYING. If not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ *  MA  02111-1307  USA
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <lal/LALAdaptiveRungeKuttaIntegrator.h>
+#include <lal/LALConstants.h>
+#include <lal/LALDatatypes.h>
+#include <lal/LALMalloc.h>
+#include <lal/LALSimIMR.h>
+#include <lal/TimeSeries.h>
+#include <lal/XLALError.h>
+
+/* maximum difference between two waveforms aligned at their ends, relative to the peak of |ref| */
+static REAL8 max_relative_difference(const REAL8TimeSeries *ref, const REAL8TimeSeries *h) {
+  const size_t nref = ref->data->length, nh = h->data->length;
+  const size_t n = nref < nh ? nref : nh;
+  REAL8 peak = 0., diff = 0.;
+  for (size_t j = 0; j < nref; j++)
+    peak = fmax(peak, fabs(ref->data->data[j]));
+  for (size_t j = 1; j <= n; j++)
+    diff = fmax(diff, fabs(ref->data->data[nref - j] - h->data->data[nh - j]));
+  return peak > 0. ? diff / peak : diff;
+}
+
+/* EOBNRv2 integrates its dynamics with XLALAdaptiveRungeKutta4() */
+static int generate(REAL8TimeSeries **hplus) {
+  REAL8TimeSeries *hcross = NULL;
+  int ret = XLALSimIMREOBNRv2DominantMode(hplus, &hcross, 0., 1. / 16384.,
+      75. * LAL_MSUN_SI, 25. * LAL_MSUN_SI, 10., 1e6 * LAL_PC_SI, 0.);
+  XLALDestroyREAL8TimeSeries(hcross);
+  return ret;
+}
+
+int main(void) {
+  REAL8TimeSeries *spline = NULL, *dense = NULL;
+  REAL8 diff;
+
+  /* the inlined steppers are opt-in */
+  XLAL_CHECK_MAIN(XLALAdaptiveRungeKuttaGetDefaultStepper() == LAL_ADAPTIVE_RK_STEPPER_GSL, XLAL_EFAILED);
+  XLAL_CHECK_MAIN(generate(&spline) == XLAL_SUCCESS, XLAL_EFUNC);
+
+  /* the inlined RKF45 stepper takes the same steps as the GSL one, so only the interpolation differs */
+  XLAL_CHECK_MAIN(XLALAdaptiveRungeKuttaSetDefaultStepper(LAL_ADAPTIVE_RK_STEPPER_RKF45) == XLAL_SUCCESS, XLAL_EFUNC);
+  XLAL_CHECK_MAIN(generate(&dense) == XLAL_SUCCESS, XLAL_EFUNC);
+  XLAL_CHECK_MAIN(XLALAdaptiveRungeKuttaSetDefaultStepper(LAL_ADAPTIVE_RK_STEPPER_GSL) == XLAL_SUCCESS, XLAL_EFUNC);
+
+  diff = max_relative_difference(spline, dense);
+  printf("EOBNRv2: %u samples with the spline, %u with dense output, maximum |dh+| %.3e\n",
+      spline->data->length, dense->data->length, diff);
+  XLAL_CHECK_MAIN(abs((int) spline->data->length - (int) dense->data->length) <= 1, XLAL_EFAILED,
+      "waveform lengths differ: %u != %u", spline->data->length, dense->data->length);
+  XLAL_CHECK_MAIN(diff < 1e-3, XLAL_EFAILED, "dense output differs from the spline by %g", diff);
+
+  XLALDestroyREAL8TimeSeries(spline);
+  XLALDestroyREAL8TimeSeries(dense);
+
+  LALCheckMemoryLeaks();
+
+  return EXIT_SUCCESS;
+}
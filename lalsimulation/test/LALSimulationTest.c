@@ -6,6 +6,8 @@
 #include <lal/LALDetectors.h>
 #include <lal/DetResponse.h>
 #include <lal/TimeSeries.h>
+#include <lal/FrequencySeries.h>
+#include <lal/TimeFreqFFT.h>
 #include <lal/Units.h>
 #include <lal/TimeDelay.h>
 #include <lal/LALSimulation.h>
@@ -85,6 +87,92 @@ static void compute_answer(REAL8TimeSeries *mdl, LIGOTimeGPS epoch, double ampl,
 	}
 }
 
+/* hplus = ampl * cos(phase) and hcross = ampl * sin(phase) of a linear chirp starting at t = 0, tapered over 2 s at each end */
+static void chirp(double t, double duration, double ampl, double f0, double fdot, double *hplus, double *hcross)
+{
+	double phase = LAL_TWOPI * (f0 * t + 0.5 * fdot * t * t);
+
+	if(t < 0. || t > duration)
+		ampl = 0.;
+	else if(t < 2.)
+		ampl *= pow(sin(LAL_PI_2 * t / 2.), 2);
+	else if(t > duration - 2.)
+		ampl *= pow(sin(LAL_PI_2 * (duration - t) / 2.), 2);
+	*hplus = ampl * cos(phase);
+	*hcross = ampl * sin(phase);
+}
+
+static void add_chirp(REAL8TimeSeries *hplus, REAL8TimeSeries *hcross, LIGOTimeGPS start, double duration, double ampl, double f0, double fdot)
+{
+	double t0 = XLALGPSDiff(&hplus->epoch, &start);
+	unsigned i;
+
+	for(i = 0; i < hplus->data->length; i++) {
+		double hp, hc;
+		chirp(t0 + i * hplus->deltaT, duration, ampl, f0, fdot, &hp, &hc);
+		hplus->data->data[i] += hp;
+		hcross->data->data[i] += hc;
+	}
+}
+
+/* add the signal the detector observes from a chirp added with add_chirp(), neglecting the frequency dependence of the arms' response other than the light travel time to their midpoints */
+static void compute_chirp_answer(REAL8TimeSeries *mdl, LIGOTimeGPS start, double duration, double ampl, double f0, double fdot, REAL8 right_ascension, REAL8 declination, REAL8 psi, const LALDetector *detector)
+{
+	double armlen, xcos, ycos, fxplus, fxcross, fyplus, fycross;
+	unsigned i;
+
+	for(i = 0; i < mdl->data->length; i++) {
+		LIGOTimeGPS t = mdl->epoch;
+		double hp, hc, t0;
+		XLALGPSAdd(&t, i * mdl->deltaT);
+
+		XLALComputeDetAMResponseParts(&armlen, &xcos, &ycos, &fxplus, &fyplus, &fxcross, &fycross, detector, right_ascension, declination, psi, XLALGreenwichMeanSiderealTime(&t));
+
+		XLALGPSAdd(&t, -XLALTimeDelayFromEarthCenter(detector->location, right_ascension, declination, &t));
+		t0 = XLALGPSDiff(&t, &start);
+
+		chirp(t0 - xcos * armlen / LAL_C_SI / 2., duration, ampl, f0, fdot, &hp, &hc);
+		mdl->data->data[i] += fxplus * hp + fxcross * hc;
+		chirp(t0 - ycos * armlen / LAL_C_SI / 2., duration, ampl, f0, fdot, &hp, &hc);
+		mdl->data->data[i] += fyplus * hp + fycross * hc;
+	}
+}
+
+/* hplus = ampl * (f / f0)^(2/3) * cos(phase) and hcross = ampl * (f / f0)^(2/3) * sin(phase) of the leading-order inspiral of a compact binary sweeping from f0 at t = 0 to coalescence at t = tc, tapered over 2 s at the start and between 3/4 fmax and fmax at the end */
+static void inspiral(double t, double tc, double ampl, double f0, double fmax, double *hplus, double *hcross)
+{
+	double x = (tc - t) / tc;
+	double f, phase;
+
+	*hplus = *hcross = 0.;
+	if(t < 0. || x <= 0.)
+		return;
+	f = f0 * pow(x, -3. / 8.);
+	if(f > fmax)
+		return;
+	phase = -LAL_TWOPI * f0 * tc * 8. / 5. * pow(x, 5. / 8.);
+	ampl *= pow(f / f0, 2. / 3.);
+	if(t < 2.)
+		ampl *= pow(sin(LAL_PI_2 * t / 2.), 2);
+	if(f > 0.75 * fmax)
+		ampl *= pow(sin(LAL_PI_2 * (fmax - f) / (0.25 * fmax)), 2);
+	*hplus = ampl * cos(phase);
+	*hcross = ampl * sin(phase);
+}
+
+static void add_inspiral(REAL8TimeSeries *hplus, REAL8TimeSeries *hcross, LIGOTimeGPS start, double tc, double ampl, double f0, double fmax)
+{
+	double t0 = XLALGPSDiff(&hplus->epoch, &start);
+	unsigned i;
+
+	for(i = 0; i < hplus->data->length; i++) {
+		double hp, hc;
+		inspiral(t0 + i * hplus->deltaT, tc, ampl, f0, fmax, &hp, &hc);
+		hplus->data->data[i] += hp;
+		hcross->data->data[i] += hc;
+	}
+}
+
 static REAL8TimeSeries *error(const REAL8TimeSeries *s1, const REAL8TimeSeries *s0)
 {
 	REAL8TimeSeries *result = copy_series(s1);
@@ -202,5 +290,217 @@ int main(void)
 	XLALDestroyREAL8TimeSeries(short_dst);
 	XLALDestroyREAL8TimeSeries(mdl);
 
+	{
+	LALDetector detectors[3];
+	REAL8TimeSeries *multi_dst[3];
+	unsigned d, i;
+
+	detectors[0] = lalCachedDetectors[LAL_LHO_4K_DETECTOR];
+	detectors[1] = lalCachedDetectors[LAL_LLO_4K_DETECTOR];
+	detectors[2] = lalCachedDetectors[LAL_VIRGO_DETECTOR];
+	f = 100.0;
+	dt = 1.0 / (f * 4.0);
+	length_origin = 1024 * 3;
+	start_mdl = 1024;
+	length_mdl = 1024;
+
+	hplus = new_series(dt, length_origin, 0.0);
+	hcross = copy_series(hplus);
+
+	add_circular_polarized_sine(hplus, hcross, hplus->epoch, ampl, f);
+	if(XLALSimMultiDetectorStrainREAL8TimeSeries(multi_dst, hplus, hcross, right_ascension, declination, psi, detectors, 3) < 0) {
+		fprintf(stderr, "XLALSimMultiDetectorStrainREAL8TimeSeries() failed\n");
+		exit(1);
+	}
+
+	for(d = 0; d < 3; d++) {
+		fprintf(stderr, "injecting unit amplitude %g Hz circular polarized monochromatic GWs sampled at %g Hz into %s data with the multi-detector projection\n", f, 1/ dt, detectors[d].frDetector.name);
+
+		/* must agree exactly with the single-detector projection */
+		dst = XLALSimDetectorStrainREAL8TimeSeries(hplus, hcross, right_ascension, declination, psi, &detectors[d]);
+		if(XLALGPSCmp(&dst->epoch, &multi_dst[d]->epoch) || dst->data->length != multi_dst[d]->data->length) {
+			fprintf(stderr, "multi-detector projection does not match single-detector projection\n");
+			exit(1);
+		}
+		for(i = 0; i < dst->data->length; i++)
+			if(dst->data->data[i] != multi_dst[d]->data->data[i]) {
+				fprintf(stderr, "multi-detector projection does not match single-detector projection\n");
+				exit(1);
+			}
+
+		short_dst = XLALCutREAL8TimeSeries(multi_dst[d], start_mdl, length_mdl);
+		mdl = copy_series(short_dst);
+		compute_answer(mdl, hplus->epoch,  ampl, f, right_ascension, declination, psi, &detectors[d]);
+
+		check_result(mdl, short_dst, 0.0012, -0.0016, 0.0016);
+
+		XLALDestroyREAL8TimeSeries(dst);
+		XLALDestroyREAL8TimeSeries(multi_dst[d]);
+		XLALDestroyREAL8TimeSeries(short_dst);
+		XLALDestroyREAL8TimeSeries(mdl);
+	}
+
+	XLALDestroyREAL8TimeSeries(hplus);
+	XLALDestroyREAL8TimeSeries(hcross);
+	}
+
+	{
+	LALDetector detectors[2];
+	LALSimFDInjectionEngine *engine;
+	COMPLEX16FrequencySeries *hptilde, *hctilde;
+	REAL8FFTPlan *plan;
+	LIGOTimeGPS start, target_epoch = gps_zero;
+	unsigned d, c;
+
+	detectors[0] = lalCachedDetectors[LAL_LHO_4K_DETECTOR];
+	detectors[1] = lalCachedDetectors[LAL_VIRGO_DETECTOR];
+	dt = 1.0 / 1024.0;
+	length_origin = 128 * 1024;
+	XLALGPSAdd(&target_epoch, 10.123456789);
+
+	hptilde = XLALCreateCOMPLEX16FrequencySeries(NULL, &gps_zero, 0.0, 0.0, &lalDimensionlessUnit, length_origin / 2 + 1);
+	hctilde = XLALCreateCOMPLEX16FrequencySeries(NULL, &gps_zero, 0.0, 0.0, &lalDimensionlessUnit, length_origin / 2 + 1);
+	plan = XLALCreateForwardREAL8FFTPlan(length_origin, 0);
+	engine = XLALCreateSimFDInjectionEngine(dt, 16.0);
+	if(!hptilde || !hctilde || !plan || !engine) {
+		fprintf(stderr, "failed to create frequency-domain injection engine\n");
+		exit(1);
+	}
+
+	/* queue two chirps, the second running past the end of the
+	 * targets, and inject them into the data of both detectors */
+
+	for(c = 0; c < 2; c++) {
+		hplus = new_series(dt, length_origin, 0.0);
+		hcross = copy_series(hplus);
+		start = hplus->epoch;
+		if(c == 0) {
+			XLALGPSAdd(&start, 50.0);
+			add_chirp(hplus, hcross, start, 40.0, ampl, 30.0, 4.0);
+		} else {
+			XLALGPSAdd(&start, 100.0);
+			add_chirp(hplus, hcross, start, 20.0, 0.7 * ampl, 40.0, 10.0);
+		}
+		if(XLALREAL8TimeFreqFFT(hptilde, hplus, plan) || XLALREAL8TimeFreqFFT(hctilde, hcross, plan) || XLALSimFDInjectionEngineAddInjection(engine, hptilde, hctilde, right_ascension, declination, psi) < 0) {
+			fprintf(stderr, "failed to queue injection\n");
+			exit(1);
+		}
+		XLALDestroyREAL8TimeSeries(hplus);
+		XLALDestroyREAL8TimeSeries(hcross);
+	}
+
+	for(d = 0; d < 2; d++) {
+		fprintf(stderr, "injecting linear chirps sampled at %g Hz into %s data with the frequency-domain injection engine\n", 1 / dt, detectors[d].frDetector.name);
+
+		dst = new_series(dt, 100 * 1024, 0.0);
+		dst->epoch = target_epoch;
+		if(XLALSimFDInjectionEngineInjectREAL8TimeSeries(engine, dst, &detectors[d], NULL) < 0) {
+			fprintf(stderr, "XLALSimFDInjectionEngineInjectREAL8TimeSeries() failed\n");
+			exit(1);
+		}
+
+		mdl = new_series(dt, 100 * 1024, 0.0);
+		mdl->epoch = target_epoch;
+		start = gps_zero;
+		XLALGPSAdd(&start, 50.0);
+		compute_chirp_answer(mdl, start, 40.0, ampl, 30.0, 4.0, right_ascension, declination, psi, &detectors[d]);
+		XLALGPSAdd(&start, 50.0);
+		compute_chirp_answer(mdl, start, 20.0, 0.7 * ampl, 40.0, 10.0, right_ascension, declination, psi, &detectors[d]);
+
+		check_result(mdl, dst, 0.0001, -0.0002, 0.0002);
+
+		XLALDestroyREAL8TimeSeries(dst);
+		XLALDestroyREAL8TimeSeries(mdl);
+	}
+
+	XLALDestroySimFDInjectionEngine(engine);
+	XLALDestroyREAL8FFTPlan(plan);
+	XLALDestroyCOMPLEX16FrequencySeries(hptilde);
+	XLALDestroyCOMPLEX16FrequencySeries(hctilde);
+	}
+
+	{
+	LALSimFDInjectionEngine *engine;
+	COMPLEX16FrequencySeries *hptilde, *hctilde;
+	REAL8FFTPlan *plan;
+	LIGOTimeGPS start = gps_zero, target_epoch = gps_zero;
+	int errnum, retval;
+
+	/* a 1000 s binary neutron star-like inspiral from 10 Hz, whose
+	 * frequency changes too slowly for 32 s chunks */
+
+	detector = lalCachedDetectors[LAL_LHO_4K_DETECTOR];
+	dt = 1.0 / 1024.0;
+	length_origin = 1024 * 1024;
+	XLALGPSAdd(&start, 10.0);
+	XLALGPSAdd(&target_epoch, 5.123456789);
+
+	hplus = new_series(dt, length_origin, 0.0);
+	hcross = copy_series(hplus);
+	add_inspiral(hplus, hcross, start, 1000.0, ampl, 10.0, 400.0);
+
+	hptilde = XLALCreateCOMPLEX16FrequencySeries(NULL, &gps_zero, 0.0, 0.0, &lalDimensionlessUnit, length_origin / 2 + 1);
+	hctilde = XLALCreateCOMPLEX16FrequencySeries(NULL, &gps_zero, 0.0, 0.0, &lalDimensionlessUnit, length_origin / 2 + 1);
+	plan = XLALCreateForwardREAL8FFTPlan(length_origin, 0);
+	if(!hptilde || !hctilde || !plan || XLALREAL8TimeFreqFFT(hptilde, hplus, plan) || XLALREAL8TimeFreqFFT(hctilde, hcross, plan)) {
+		fprintf(stderr, "failed to transform inspiral to the frequency domain\n");
+		exit(1);
+	}
+
+	fprintf(stderr, "checking that the frequency-domain injection engine rejects a 10 Hz inspiral with 32 s chunks\n");
+
+	engine = XLALCreateSimFDInjectionEngine(dt, 32.0);
+	if(!engine) {
+		fprintf(stderr, "failed to create frequency-domain injection engine\n");
+		exit(1);
+	}
+	XLAL_TRY(retval = XLALSimFDInjectionEngineAddInjection(engine, hptilde, hctilde, right_ascension, declination, psi), errnum);
+	if(retval >= 0 || errnum != XLAL_EINVAL) {
+		fprintf(stderr, "XLALSimFDInjectionEngineAddInjection() accepted an inspiral too slow for its chunks\n");
+		exit(1);
+	}
+	XLALDestroySimFDInjectionEngine(engine);
+
+	/* with long enough chunks the engine must agree with the
+	 * time-domain injection path */
+
+	fprintf(stderr, "injecting a 10 Hz inspiral sampled at %g Hz into LHO data with the frequency-domain injection engine and 512 s chunks\n", 1 / dt);
+
+	engine = XLALCreateSimFDInjectionEngine(dt, 512.0);
+	if(!engine || XLALSimFDInjectionEngineAddInjection(engine, hptilde, hctilde, right_ascension, declination, psi) < 0) {
+		fprintf(stderr, "failed to queue injection\n");
+		exit(1);
+	}
+
+	dst = new_series(dt, 1100 * 1024, 0.0);
+	dst->epoch = target_epoch;
+	if(XLALSimFDInjectionEngineInjectREAL8TimeSeries(engine, dst, &detector, NULL) < 0) {
+		fprintf(stderr, "XLALSimFDInjectionEngineInjectREAL8TimeSeries() failed\n");
+		exit(1);
+	}
+
+	mdl = new_series(dt, 1100 * 1024, 0.0);
+	mdl->epoch = target_epoch;
+	short_dst = XLALSimDetectorStrainREAL8TimeSeries(hplus, hcross, right_ascension, declination, psi, &detector);
+	if(!short_dst || XLALSimAddInjectionREAL8TimeSeries(mdl, short_dst, NULL) < 0) {
+		fprintf(stderr, "time-domain injection failed\n");
+		exit(1);
+	}
+
+	/* the inspiral's amplitude grows to about 10 before the taper at its
+	 * end, where the time-domain path's own error is about 0.02 */
+	check_result(mdl, dst, 0.001, -0.04, 0.04);
+
+	XLALDestroyREAL8TimeSeries(hplus);
+	XLALDestroyREAL8TimeSeries(hcross);
+	XLALDestroyREAL8TimeSeries(short_dst);
+	XLALDestroyREAL8TimeSeries(dst);
+	XLALDestroyREAL8TimeSeries(mdl);
+	XLALDestroySimFDInjectionEngine(engine);
+	XLALDestroyREAL8FFTPlan(plan);
+	XLALDestroyCOMPLEX16FrequencySeries(hptilde);
+	XLALDestroyCOMPLEX16FrequencySeries(hctilde);
+	}
+
 	exit(0);
 }
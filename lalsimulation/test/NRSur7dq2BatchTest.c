@@ -0,0 +1,99 @@
+/*
+ *  Copyright (C) 2018 The LALSuite developers
+ *
+ *  Check that XLALSimInspiralNRSur7dq2PolarizationsBatch() returns the same
+ *  polarizations as repeated calls to XLALSimInspiralNRSur7dq2Polarizations().
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with with program; see the file COPYING. If not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ *  MA  02111-1307  USA
+ */
+
+#include <lal/LALConfig.h>
+
+#ifndef LAL_HDF5_ENABLED
+int main(void) { return 77; /* NRSur7dq2 needs HDF5 */ }
+#else
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <lal/Date.h>
+#include <lal/FileIO.h>
+#include <lal/LALConstants.h>
+#include <lal/LALDatatypes.h>
+#include <lal/LALMalloc.h>
+#include <lal/LALSimIMR.h>
+#include <lal/TimeSeries.h>
+#include <lal/XLALError.h>
+
+#define NPOINTS 4
+
+static int compare(const REAL8TimeSeries *single, const REAL8TimeSeries *batch, UINT4 k, const char *name) {
+  XLAL_CHECK(single && batch, XLAL_EFAULT, "%s[%u] was not generated", name, k);
+  XLAL_CHECK(single->data->length == batch->data->length, XLAL_EFAILED,
+      "%s[%u] lengths differ: %u != %u", name, k, single->data->length, batch->data->length);
+  XLAL_CHECK(XLALGPSCmp(&single->epoch, &batch->epoch) == 0, XLAL_EFAILED, "%s[%u] epochs differ", name, k);
+  for (UINT4 j = 0; j < single->data->length; j++)
+    XLAL_CHECK(single->data->data[j] == batch->data->data[j], XLAL_EFAILED,
+        "%s[%u] differs at sample %u: %.17g != %.17g", name, k, j, single->data->data[j], batch->data->data[j]);
+  return XLAL_SUCCESS;
+}
+
+int main(void) {
+  const REAL8 deltaT = 1. / 4096., fMin = 0., fRef = 0.;
+  const REAL8 phiRef[NPOINTS] = {0., 0.7, 1.9, 4.2};
+  const REAL8 inclination[NPOINTS] = {0.3, 1.2, 2.0, 0.};
+  const REAL8 m1[NPOINTS] = {40. * LAL_MSUN_SI, 50. * LAL_MSUN_SI, 30. * LAL_MSUN_SI, 60. * LAL_MSUN_SI};
+  const REAL8 m2[NPOINTS] = {30. * LAL_MSUN_SI, 30. * LAL_MSUN_SI, 20. * LAL_MSUN_SI, 40. * LAL_MSUN_SI};
+  const REAL8 distance[NPOINTS] = {1e8 * LAL_PC_SI, 2e8 * LAL_PC_SI, 5e8 * LAL_PC_SI, 1e9 * LAL_PC_SI};
+  const REAL8 s1x[NPOINTS] = {0., 0.3, -0.2, 0.5};
+  const REAL8 s1y[NPOINTS] = {0., 0.1, 0.4, -0.3};
+  const REAL8 s1z[NPOINTS] = {0., 0.2, -0.5, 0.1};
+  const REAL8 s2x[NPOINTS] = {0., -0.4, 0.2, 0.};
+  const REAL8 s2y[NPOINTS] = {0., 0.2, 0., 0.6};
+  const REAL8 s2z[NPOINTS] = {0., 0.5, 0.3, -0.2};
+  REAL8TimeSeries *hplus[NPOINTS] = {NULL}, *hcross[NPOINTS] = {NULL};
+  char *path;
+
+  /* the surrogate data are not installed with LALSimulation */
+  path = XLALFileResolvePath("NRSur7dq2.h5");
+  if (path == NULL) {
+    fprintf(stderr, "NRSur7dq2.h5 not found in $LAL_DATA_PATH, skipping test\n");
+    XLALClearErrno();
+    return 77;
+  }
+  XLALFree(path);
+
+  XLAL_CHECK_MAIN(XLALSimInspiralNRSur7dq2PolarizationsBatch(hplus, hcross, NPOINTS, phiRef, inclination,
+        deltaT, m1, m2, distance, fMin, fRef, s1x, s1y, s1z, s2x, s2y, s2z, NULL) == XLAL_SUCCESS, XLAL_EFUNC);
+
+  for (UINT4 k = 0; k < NPOINTS; k++) {
+    REAL8TimeSeries *hp = NULL, *hc = NULL;
+    XLAL_CHECK_MAIN(XLALSimInspiralNRSur7dq2Polarizations(&hp, &hc, phiRef[k], inclination[k], deltaT,
+          m1[k], m2[k], distance[k], fMin, fRef, s1x[k], s1y[k], s1z[k], s2x[k], s2y[k], s2z[k], NULL) == XLAL_SUCCESS, XLAL_EFUNC);
+    XLAL_CHECK_MAIN(compare(hp, hplus[k], k, "hplus") == XLAL_SUCCESS, XLAL_EFUNC);
+    XLAL_CHECK_MAIN(compare(hc, hcross[k], k, "hcross") == XLAL_SUCCESS, XLAL_EFUNC);
+    XLALDestroyREAL8TimeSeries(hp);
+    XLALDestroyREAL8TimeSeries(hc);
+    XLALDestroyREAL8TimeSeries(hplus[k]);
+    XLALDestroyREAL8TimeSeries(hcross[k]);
+  }
+
+  printf("NRSur7dq2: batch of %d polarizations matches single evaluations\n", NPOINTS);
+
+  return EXIT_SUCCESS;
+}
+
+#endif
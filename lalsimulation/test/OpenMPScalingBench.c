@@ -0,0 +1,148 @@
+/*
+ *  Copyright (C) 2018 The LALSuite developers
+ *
+ *  Time frequency-domain waveforms whose loops over frequency bins are
+ *  parallelised with OpenMP, for a range of segment lengths and numbers
+ *  of threads.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with with program; see the file COPYING. If not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ *  MA  02111-1307  USA
+ */
+
+/*
+ * Usage: OpenMPScalingBench [max_threads]
+ *
+ * For each approximant and segment length, prints the number of frequency
+ * bins, the wall-clock time per waveform for 1, 2, 4, ... up to max_threads
+ * threads, and the speed-up relative to one thread. The threshold below
+ * which loops run serially is set to zero, so that every configuration is
+ * timed in parallel.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <lal/FrequencySeries.h>
+#include <lal/LALConstants.h>
+#include <lal/LALDatatypes.h>
+#include <lal/LALSimInspiral.h>
+#include <lal/LogPrintf.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* minimum time spent timing each configuration (s) */
+#define MIN_BENCH_TIME 0.5
+
+static const Approximant approximants[] = {
+  TaylorF2,
+  IMRPhenomC,
+  IMRPhenomD,
+  IMRPhenomPv2,
+};
+
+/* segment lengths (s); 1 / deltaF */
+static const REAL8 durations[] = { 8, 64, 512, 4096 };
+
+static int generate(Approximant approximant, REAL8 deltaF, size_t *length) {
+  COMPLEX16FrequencySeries *hptilde = NULL;
+  COMPLEX16FrequencySeries *hctilde = NULL;
+  /* a BNS for the inspiral-only model, a BBH for the IMR models */
+  const int bns = (approximant == TaylorF2);
+  const REAL8 m1 = (bns ? 1.4 : 10.) * LAL_MSUN_SI;
+  const REAL8 m2 = (bns ? 1.3 : 8.) * LAL_MSUN_SI;
+  const REAL8 s1x = (approximant == IMRPhenomPv2) ? 0.3 : 0.;
+  int ret;
+
+  ret = XLALSimInspiralChooseFDWaveform(&hptilde, &hctilde,
+      m1, m2, s1x, 0., 0.2, 0., 0., -0.1,
+      1e8 * LAL_PC_SI, 0.4, 0., 0., 0., 0.,
+      deltaF, 20., bns ? 2048. : 0., 20., NULL, approximant);
+  if (ret == XLAL_SUCCESS)
+    *length = hptilde->data->length;
+
+  XLALDestroyCOMPLEX16FrequencySeries(hptilde);
+  XLALDestroyCOMPLEX16FrequencySeries(hctilde);
+  return ret;
+}
+
+static REAL8 time_per_waveform(Approximant approximant, REAL8 deltaF, size_t *length) {
+  REAL8 start, elapsed;
+  UINT4 n = 0;
+
+  /* warm up */
+  if (generate(approximant, deltaF, length) != XLAL_SUCCESS)
+    return -1.;
+
+  start = XLALGetTimeOfDay();
+  do {
+    if (generate(approximant, deltaF, length) != XLAL_SUCCESS)
+      return -1.;
+    n++;
+    elapsed = XLALGetTimeOfDay() - start;
+  } while (elapsed < MIN_BENCH_TIME);
+
+  return elapsed / n;
+}
+
+int main(int argc, char **argv) {
+  int max_threads = 1;
+  size_t a, d;
+
+#ifdef _OPENMP
+  max_threads = omp_get_max_threads();
+#endif
+  if (argc > 1)
+    max_threads = atoi(argv[1]);
+  if (max_threads < 1) {
+    fprintf(stderr, "usage: %s [max_threads]\n", argv[0]);
+    return 1;
+  }
+#ifndef _OPENMP
+  fprintf(stderr, "%s: built without OpenMP; all timings use one thread\n", argv[0]);
+#endif
+
+  XLALSimInspiralSetOpenMPThreshold(0);
+
+  printf("%-14s %9s %9s %8s %14s %8s\n", "approximant", "T [s]", "bins", "threads", "t/wf [s]", "speedup");
+  for (a = 0; a < sizeof(approximants) / sizeof(*approximants); a++) {
+    for (d = 0; d < sizeof(durations) / sizeof(*durations); d++) {
+      REAL8 serial = 0.;
+      for (int threads = 1; threads <= max_threads; threads *= 2) {
+        size_t length = 0;
+        REAL8 t;
+        XLALSimInspiralSetOpenMPNumThreads(threads);
+        t = time_per_waveform(approximants[a], 1. / durations[d], &length);
+        if (t < 0) {
+          fprintf(stderr, "failed to generate %s with T = %g s\n",
+              XLALSimInspiralGetStringFromApproximant(approximants[a]), durations[d]);
+          return 1;
+        }
+        if (threads == 1)
+          serial = t;
+        printf("%-14s %9g %9zu %8d %14.6e %8.2f\n",
+            XLALSimInspiralGetStringFromApproximant(approximants[a]),
+            durations[d], length, threads, t, serial / t);
+        fflush(stdout);
+      }
+    }
+  }
+
+  XLALSimInspiralSetOpenMPNumThreads(0);
+  XLALSimInspiralSetOpenMPThreshold(LAL_SIM_INSPIRAL_OPENMP_DEFAULT_THRESHOLD);
+
+  return 0;
+}
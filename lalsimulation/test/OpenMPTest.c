@@ -29,7 +29,6 @@
 #include <lal/LALSimIMR.h>
 #include <lal/Units.h>
 
-#include <omp.h>
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
@@ -68,106 +67,47 @@ static int series_differ(
     return ret;
 }
 
-typedef enum {
-  OMP_FIRST = 0,
-  OMP_TaylorF2,
-  OMP_IMRPhenomP,
-  OMP_LAST
-} OpenMPCapableWaveforms;
+static const Approximant OpenMPCapableWaveforms[] = {
+  TaylorF2,
+  IMRPhenomC,
+  IMRPhenomD,
+  IMRPhenomPv2,
+};
 
-static void GenerateOMPWaveform(OpenMPCapableWaveforms wf, COMPLEX16FrequencySeries *hptilde, COMPLEX16FrequencySeries *hctilde) {
+static int GenerateOMPWaveform(Approximant approximant, COMPLEX16FrequencySeries **hptilde, COMPLEX16FrequencySeries **hctilde) {
   REAL8 m1 = 1.4;
   REAL8 m2 = 5.6;
-  REAL8 m1_SI = m1 * LAL_MSUN_SI;
-  REAL8 m2_SI = m2 * LAL_MSUN_SI;
   REAL8 s1x = 0.3;
   REAL8 s1y = 0;
   REAL8 s1z = 0.45;
   REAL8 s2x = 0;
   REAL8 s2y = 0;
   REAL8 s2z = 0.45;
-  REAL8 lnhatx = sin(0.4);
-  REAL8 lnhaty = 0;
-  REAL8 lnhatz = cos(0.4);
+  REAL8 inclination = 0.4;
   REAL8 f_min = 10;
   REAL8 f_ref = 10;
   REAL8 f_max = 0;
   REAL8 phi_ref = 0;
-  REAL8 deltaF = 1. / 1024;
+  REAL8 deltaF = 1. / 64;
   REAL8 distance = 1e6 * LAL_PC_SI;
-  REAL8 quadpar1 = 1.;
-  REAL8 quadpar2 = 1.;
-  REAL8 lambda1 = 0;
-  REAL8 lambda2 = 0;
-  LALSimInspiralSpinOrder spinO = LAL_SIM_INSPIRAL_SPIN_ORDER_0PN;
-  LALSimInspiralTidalOrder tidalO = LAL_SIM_INSPIRAL_TIDAL_ORDER_0PN;
-  INT4 phaseO = LAL_PNORDER_THREE_POINT_FIVE;
-  INT4 amplitudeO = LAL_PNORDER_THREE_POINT_FIVE;
-
-  REAL8 eta, chi1_l, chi2_l, chip, thetaJ, alpha0;
-  UINT4 IMRPhenomP_version = 2;
-
-  switch (wf) {
-    case OMP_TaylorF2:
-      XLALSimInspiralTaylorF2(
-          &hptilde, phi_ref, deltaF,
-          m1_SI, m2_SI,
-          s1z, s2z, f_min, f_max, f_ref, distance,
-	  quadpar1, quadpar2,
-          lambda1, lambda2,
-          spinO,
-          tidalO,
-          phaseO,
-          amplitudeO);
-      break;
-    case OMP_IMRPhenomP:
-      m1 = 5.6;
-      m2 = 22.4;
-      XLALSimIMRPhenomPCalculateModelParameters(
-          &chi1_l,            /**< Output: aligned spin on companion 1 */
-          &chi2_l,            /**< Output: aligned spin on companion 2 */
-          &chip,              /**< Output: Effective spin in the orbital plane */
-          &eta,               /**< Output: Symmetric mass-ratio */
-          &thetaJ,            /**< Output: Angle between J0 and line of sight (z-direction) */
-          &alpha0,            /**< Output: Initial value of alpha angle */
-          m1_SI,              /**< Mass of companion 1 (kg) */
-          m2_SI,              /**< Mass of companion 2 (kg) */
-          f_ref,              /**< Starting GW frequency (Hz) */
-          lnhatx,             /**< Initial value of LNhatx: orbital angular momentum unit vector */
-          lnhaty,             /**< Initial value of LNhaty */
-          lnhatz,             /**< Initial value of LNhatz */
-          s1x,                /**< Initial value of s1x: dimensionless spin of larger BH */
-          s1y,                /**< Initial value of s1y: dimensionless spin of larger BH */
-          s1z,                /**< Initial value of s1z: dimensionless spin of larger BH */
-          s2x,                /**< Initial value of s2x: dimensionless spin of larger BH */
-          s2y,                /**< Initial value of s2y: dimensionless spin of larger BH */
-          s2z);               /**< Initial value of s2z: dimensionless spin of larger BH */
-        XLALSimIMRPhenomP(
-          &hptilde,           /**< Frequency-domain waveform h+ */
-          &hctilde,           /**< Frequency-domain waveform hx */
-          chi1_l,             /**< aligned spin on companion 1 */
-          chi2_l,             /**< aligned spin on companion 2 */
-          chip,               /**< Effective spin in the orbital plane */
-          eta,                /**< Symmetric mass-ratio */
-          thetaJ,             /**< Angle between J0 and line of sight (z-direction) */
-          m1_SI + m2_SI,      /**< Total mass of binary (kg) */
-          distance,           /**< Distance of source (m) */
-          alpha0,             /**< Initial value of alpha angle */
-          phi_ref,            /**< Orbital coalescence phase (rad) */
-          deltaF,             /**< Sampling frequency (Hz) */
-          f_min,              /**< Starting GW frequency (Hz) */
-          f_max,              /**< End frequency; 0 defaults to ringdown cutoff freq */
-          f_ref,              /**< Reference frequency */
-          IMRPhenomP_version);/**< Version number: 1 uses IMRPhenomC, 2 uses IMRPhenomD */
-      break;
-    default:
-      XLALPrintError("Error: waveform %d not listed under OpenMPCapableWaveforms.\n", wf);
+
+  if (XLALSimInspiralGetSpinSupportFromApproximant(approximant) != LAL_SIM_INSPIRAL_PRECESSINGSPIN) {
+    s1x = 0;
+  }
+  if (approximant == IMRPhenomC || approximant == IMRPhenomPv2) {
+    m1 *= 4;
+    m2 *= 4;
   }
 
+  return XLALSimInspiralChooseFDWaveform(hptilde, hctilde,
+      m1 * LAL_MSUN_SI, m2 * LAL_MSUN_SI, s1x, s1y, s1z, s2x, s2y, s2z,
+      distance, inclination, phi_ref, 0., 0., 0.,
+      deltaF, f_min, f_max, f_ref, NULL, approximant);
 }
 
 int main (int argc, char **argv) {
     int num_threads;
+    size_t k;
     COMPLEX16FrequencySeries *base_hptilde = NULL;
     COMPLEX16FrequencySeries *base_hctilde = NULL;
 
@@ -176,27 +116,33 @@ int main (int argc, char **argv) {
     (void)argc;
     (void)argv;
 
+    /* Run every loop over frequency bins in parallel, however short. */
+    XLALSimInspiralSetOpenMPThreshold(0);
 
     /* Loop over all OMP capable waveforms we know */
-    for (OpenMPCapableWaveforms wf = OMP_FIRST+1; wf < OMP_LAST; wf++)
+    for (k = 0; k < sizeof(OpenMPCapableWaveforms) / sizeof(*OpenMPCapableWaveforms); k++)
     {
+      Approximant wf = OpenMPCapableWaveforms[k];
 
       /* Check that using 2-8 threads gives an answer that is identical to using 1 thread. */
-      for (num_threads = 1; num_threads < 8; num_threads++)
+      for (num_threads = 1; num_threads <= 8; num_threads++)
       {
 	  COMPLEX16FrequencySeries *hptilde = NULL;
 	  COMPLEX16FrequencySeries *hctilde = NULL;
 
-	  omp_set_num_threads(num_threads);
+	  XLALSimInspiralSetOpenMPNumThreads(num_threads);
 
-	  GenerateOMPWaveform(wf, hptilde, hctilde);
+	  if (GenerateOMPWaveform(wf, &hptilde, &hctilde) != XLAL_SUCCESS) {
+	      XLALPrintError("Error: failed to generate waveform %s.\n", XLALSimInspiralGetStringFromApproximant(wf));
+	      return 1;
+	  }
 
 	  if (num_threads == 1) {
 	      base_hptilde = hptilde;
 	      base_hctilde = hctilde;
 	  }
 	  else if (series_differ(base_hptilde, hptilde) || series_differ(base_hctilde, hctilde)) {
-	      XLALPrintError("Error: frequency series differ for waveform %d.\n", wf);
+	      XLALPrintError("Error: frequency series differ for waveform %s with %d threads.\n", XLALSimInspiralGetStringFromApproximant(wf), num_threads);
 	      return 1;
 	  }
 	  else {
@@ -204,7 +150,14 @@ int main (int argc, char **argv) {
 	      XLALDestroyCOMPLEX16FrequencySeries(hctilde);
 	  }
       }
+
+      XLALDestroyCOMPLEX16FrequencySeries(base_hptilde);
+      XLALDestroyCOMPLEX16FrequencySeries(base_hctilde);
+      base_hptilde = base_hctilde = NULL;
    }
 
+   XLALSimInspiralSetOpenMPNumThreads(0);
+   XLALSimInspiralSetOpenMPThreshold(LAL_SIM_INSPIRAL_OPENMP_DEFAULT_THRESHOLD);
+
    return 0;
 }
@@ -0,0 +1,137 @@
+/*
+ *  Copyright (C) 2018 The LALSuite developers
+ *
+ *  Check that ROM data read through the shared, memory-mapped data store
+ *  agree with the same data read directly from the HDF5 file, both when the
+ *  cache is built and when an existing cache is mapped, and that the store
+ *  is only used when it has been enabled.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with with program; see the file COPYING. If not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ *  MA  02111-1307  USA
+ */
+
+#include <lal/LALConfig.h>
+
+#ifndef LAL_HDF5_ENABLED
+int main(void) { return 77; /* don't do any testing */ }
+#else
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+
+#include <lal/AVFactories.h>
+#include <lal/H5FileIO.h>
+#include <lal/LALDatatypes.h>
+#include <lal/LALMalloc.h>
+#include <lal/XLALError.h>
+
+#include "LALSimROMDataStore.h"
+
+#define FNAME "ROMDataStoreTest.h5"
+#define GROUP "sub1"
+#define VLEN 37
+#define NROWS 5
+#define NCOLS 7
+
+static int write_file(void) {
+  REAL8Vector *v = XLALCreateREAL8Vector(VLEN);
+  REAL8Array *B = XLALCreateREAL8ArrayL(2, NROWS, NCOLS);
+  LALH5File *file, *group;
+  XLAL_CHECK(v && B, XLAL_EFUNC);
+  for (UINT4 i = 0; i < VLEN; i++)
+    v->data[i] = rand() / (RAND_MAX + 1.0) - 0.5;
+  for (UINT4 i = 0; i < NROWS * NCOLS; i++)
+    B->data[i] = rand() / (RAND_MAX + 1.0) - 0.5;
+  file = XLALH5FileOpen(FNAME, "w");
+  XLAL_CHECK(file, XLAL_EFUNC);
+  group = XLALH5GroupOpen(file, GROUP);
+  XLAL_CHECK(group, XLAL_EFUNC);
+  XLAL_CHECK(XLALH5FileWriteREAL8Vector(group, "v", v) == 0, XLAL_EFUNC);
+  XLAL_CHECK(XLALH5FileWriteREAL8Array(group, "B", B) == 0, XLAL_EFUNC);
+  XLALH5FileClose(group);
+  XLALH5FileClose(file);
+  XLALDestroyREAL8Vector(v);
+  XLALDestroyREAL8Array(B);
+  return XLAL_SUCCESS;
+}
+
+/* compare the datasets read through the store with those read directly */
+static int compare(const ROMDataStoreGroup *store) {
+  LALH5File *file = XLALH5FileOpen(FNAME, "r");
+  REAL8Vector *v = XLALH5FileReadREAL8Vector(file, GROUP "/v");
+  REAL8Array *B = XLALH5FileReadREAL8Array(file, GROUP "/B");
+  gsl_vector *sv = NULL;
+  gsl_matrix *sB = NULL;
+  XLALH5FileClose(file);
+  XLAL_CHECK(v && B, XLAL_EFUNC);
+
+  XLAL_CHECK(ROMDataStore_GetREAL8Vector(&sv, store, "v") == XLAL_SUCCESS, XLAL_EFUNC);
+  XLAL_CHECK(ROMDataStore_GetREAL8Matrix(&sB, store, "B") == XLAL_SUCCESS, XLAL_EFUNC);
+  XLAL_CHECK(sv->size == v->length, XLAL_EFAILED, "vector length %zu != %u", sv->size, v->length);
+  XLAL_CHECK(sB->size1 == NROWS && sB->size2 == NCOLS, XLAL_EFAILED, "matrix is %zux%zu", sB->size1, sB->size2);
+  for (size_t i = 0; i < sv->size; i++)
+    XLAL_CHECK(gsl_vector_get(sv, i) == v->data[i], XLAL_EFAILED, "vector differs at %zu", i);
+  for (size_t i = 0; i < NROWS; i++)
+    for (size_t j = 0; j < NCOLS; j++)
+      XLAL_CHECK(gsl_matrix_get(sB, i, j) == B->data[i * NCOLS + j], XLAL_EFAILED, "matrix differs at (%zu,%zu)", i, j);
+  XLAL_CHECK(ROMDataStore_GetData(store, "missing", NULL, NULL, NULL) == NULL && xlalErrno == XLAL_ENAME, XLAL_EFAILED);
+  XLALClearErrno();
+
+  gsl_vector_free(sv);
+  gsl_matrix_free(sB);
+  XLALDestroyREAL8Vector(v);
+  XLALDestroyREAL8Array(B);
+  return XLAL_SUCCESS;
+}
+
+int main(void) {
+  const ROMDataStoreGroup *store, *again;
+
+  XLAL_CHECK_MAIN(write_file() == XLAL_SUCCESS, XLAL_EFUNC);
+
+  /* the store is opt-in */
+  XLAL_CHECK_MAIN(unsetenv(ROMDATASTORE_CACHE_DIR_ENV) == 0, XLAL_ESYS);
+  XLAL_CHECK_MAIN(ROMDataStore_OpenGroup(FNAME, GROUP) == NULL, XLAL_EFAILED, "store used without %s", ROMDATASTORE_CACHE_DIR_ENV);
+  XLAL_CHECK_MAIN(setenv(ROMDATASTORE_CACHE_DIR_ENV, "", 1) == 0, XLAL_ESYS);
+  XLAL_CHECK_MAIN(ROMDataStore_OpenGroup(FNAME, GROUP) == NULL, XLAL_EFAILED, "store used with empty %s", ROMDATASTORE_CACHE_DIR_ENV);
+
+  /* build the cache in the current directory */
+  XLAL_CHECK_MAIN(setenv(ROMDATASTORE_CACHE_DIR_ENV, ".", 1) == 0, XLAL_ESYS);
+  store = ROMDataStore_OpenGroup(FNAME, GROUP);
+  XLAL_CHECK_MAIN(store, XLAL_EFAILED, "unable to cache group %s of %s", GROUP, FNAME);
+  XLAL_CHECK_MAIN(compare(store) == XLAL_SUCCESS, XLAL_EFUNC);
+
+  /* a second user shares the mapping */
+  again = ROMDataStore_OpenGroup(FNAME, GROUP);
+  XLAL_CHECK_MAIN(again == store, XLAL_EFAILED, "group mapped twice");
+  ROMDataStore_CloseGroup(again);
+  XLAL_CHECK_MAIN(compare(store) == XLAL_SUCCESS, XLAL_EFUNC);
+  ROMDataStore_CloseGroup(store);
+
+  /* map the existing cache file */
+  store = ROMDataStore_OpenGroup(FNAME, GROUP);
+  XLAL_CHECK_MAIN(store, XLAL_EFAILED, "unable to map cache of group %s of %s", GROUP, FNAME);
+  XLAL_CHECK_MAIN(compare(store) == XLAL_SUCCESS, XLAL_EFUNC);
+  ROMDataStore_Cleanup();
+
+  LALCheckMemoryLeaks();
+
+  return EXIT_SUCCESS;
+}
+
+#endif
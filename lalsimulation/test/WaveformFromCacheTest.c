@@ -28,6 +28,7 @@
 #include <math.h>
 #include <lal/LALSimInspiralWaveformCache.h>
 #include <lal/FrequencySeries.h>
+#include <stdio.h>
 #include <time.h>
 #include <lal/LALConstants.h>
 
@@ -35,7 +36,8 @@ int main(void) {
     clock_t s1, e1, s2, e2;
     double diff1, diff2;
     unsigned int i;
-    REAL8 plusdiff, crossdiff, temp;
+    REAL8 plusdiff, crossdiff, norm, temp;
+    int failed = 0;
     REAL8TimeSeries *hplus = NULL;
     REAL8TimeSeries *hcross = NULL;
     REAL8TimeSeries *hplusC = NULL;
@@ -221,7 +223,6 @@ int main(void) {
     ret = XLALSimInspiralChooseFDWaveformFromCache(&hptildeC, &hctildeC,
             phiref2, df, m1, m2, s1x, s1y, s1z, s2x, s2y, s2z, f_min, f_max,
             f_ref, dist2, inc2, LALpars, approxFD, cache, NULL);
-    XLALDestroyDict(LALpars);
     e2 = clock();
     diff2 = (double) (e2 - s2) / CLOCKS_PER_SEC;
     if( ret == XLAL_FAILURE )
@@ -249,8 +250,148 @@ int main(void) {
     XLALDestroyCOMPLEX16FrequencySeries(hctildeC);
     hptilde = hctilde = hptildeC = hctildeC = NULL;
 
+    XLALDestroySimInspiralWaveformCache(cache);
+
+    //
+    // Test LRU behaviour of a cache holding two FD waveforms
+    //
+
+    cache = XLALCreateSimInspiralWaveformCache();
+    XLALSimInspiralWaveformCacheSetBudget(cache, 2,
+            LAL_SIM_INSPIRAL_WAVEFORM_CACHE_DEFAULT_BYTES);
+
+    // Cache waveforms A and B, which differ in mass
+    ret = XLALSimInspiralChooseFDWaveformFromCache(&hptildeC, &hctildeC,
+            phiref1, df, m1, m2, s1x, s1y, s1z, s2x, s2y, s2z, f_min, f_max,
+            f_ref, dist1, inc1, LALpars, approxFD, cache, NULL);
+    if( ret == XLAL_FAILURE )
+        XLAL_ERROR(XLAL_EFUNC);
+    XLALDestroyCOMPLEX16FrequencySeries(hptildeC);
+    XLALDestroyCOMPLEX16FrequencySeries(hctildeC);
+    ret = XLALSimInspiralChooseFDWaveformFromCache(&hptildeC, &hctildeC,
+            phiref1, df, 1.5 * m1, m2, s1x, s1y, s1z, s2x, s2y, s2z, f_min,
+            f_max, f_ref, dist1, inc1, LALpars, approxFD, cache, NULL);
+    if( ret == XLAL_FAILURE )
+        XLAL_ERROR(XLAL_EFUNC);
+    XLALDestroyCOMPLEX16FrequencySeries(hptildeC);
+    XLALDestroyCOMPLEX16FrequencySeries(hctildeC);
+
+    // A with new extrinsic parameters must be transformed from the cached A
+    ret = XLALSimInspiralChooseFDWaveform(&hptilde, &hctilde,
+					  m1, m2, s1x, s1y, s1z, s2x, s2y, s2z,
+					  dist2, inc2, phiref2, 0., 0., 0.,
+					  df, f_min, f_max, f_ref,
+					  LALpars, approxFD);
+    if( ret == XLAL_FAILURE )
+        XLAL_ERROR(XLAL_EFUNC);
+    ret = XLALSimInspiralChooseFDWaveformFromCache(&hptildeC, &hctildeC,
+            phiref2, df, m1, m2, s1x, s1y, s1z, s2x, s2y, s2z, f_min, f_max,
+            f_ref, dist2, inc2, LALpars, approxFD, cache, NULL);
+    if( ret == XLAL_FAILURE )
+        XLAL_ERROR(XLAL_EFUNC);
+
+    plusdiff = crossdiff = norm = 0.;
+    for(i=0; i < hptilde->data->length; i++)
+    {
+        temp = cabs(hptilde->data->data[i] - hptildeC->data->data[i]);
+        if(temp > plusdiff) plusdiff = temp;
+        temp = cabs(hctilde->data->data[i] - hctildeC->data->data[i]);
+        if(temp > crossdiff) crossdiff = temp;
+        temp = cabs(hptilde->data->data[i]);
+        if(temp > norm) norm = temp;
+    }
+    printf("Comparing waveforms from ChooseFDWaveform and ChooseFDWaveformFromCache\n");
+    printf("when the latter is transformed from the older of two cached waveforms...\n");
+    printf("Largest difference in plus polarization is: %.16g\n", plusdiff);
+    printf("Largest difference in cross polarization is: %.16g\n\n", crossdiff);
+    if( plusdiff > 1e-10 * norm || crossdiff > 1e-10 * norm ) {
+        fprintf(stderr, "FAILED: transformed waveform differs from ChooseFDWaveform\n");
+        failed = 1;
+    }
+
+    XLALDestroyCOMPLEX16FrequencySeries(hptilde);
+    XLALDestroyCOMPLEX16FrequencySeries(hctilde);
+    XLALDestroyCOMPLEX16FrequencySeries(hptildeC);
+    XLALDestroyCOMPLEX16FrequencySeries(hctildeC);
+    hptilde = hctilde = hptildeC = hctildeC = NULL;
+
+    // A third mass evicts B, the least recently used waveform, so
+    // requesting B again must generate it
+    ret = XLALSimInspiralChooseFDWaveformFromCache(&hptildeC, &hctildeC,
+            phiref1, df, 2. * m1, m2, s1x, s1y, s1z, s2x, s2y, s2z, f_min,
+            f_max, f_ref, dist1, inc1, LALpars, approxFD, cache, NULL);
+    if( ret == XLAL_FAILURE )
+        XLAL_ERROR(XLAL_EFUNC);
+    XLALDestroyCOMPLEX16FrequencySeries(hptildeC);
+    XLALDestroyCOMPLEX16FrequencySeries(hctildeC);
+    ret = XLALSimInspiralChooseFDWaveformFromCache(&hptildeC, &hctildeC,
+            phiref1, df, 1.5 * m1, m2, s1x, s1y, s1z, s2x, s2y, s2z, f_min,
+            f_max, f_ref, dist1, inc1, LALpars, approxFD, cache, NULL);
+    if( ret == XLAL_FAILURE )
+        XLAL_ERROR(XLAL_EFUNC);
+    XLALDestroyCOMPLEX16FrequencySeries(hptildeC);
+    XLALDestroyCOMPLEX16FrequencySeries(hctildeC);
+
+    // Changing the LALDict in place must not reuse waveforms cached with
+    // its previous contents
+    XLALSimInspiralWaveformParamsInsertTidalLambda1(LALpars, 100.);
+    ret = XLALSimInspiralChooseFDWaveformFromCache(&hptildeC, &hctildeC,
+            phiref1, df, 1.5 * m1, m2, s1x, s1y, s1z, s2x, s2y, s2z, f_min,
+            f_max, f_ref, dist1, inc1, LALpars, approxFD, cache, NULL);
+    if( ret == XLAL_FAILURE )
+        XLAL_ERROR(XLAL_EFUNC);
+    XLALDestroyCOMPLEX16FrequencySeries(hptildeC);
+    XLALDestroyCOMPLEX16FrequencySeries(hctildeC);
+
+    // An identical request is a hit
+    ret = XLALSimInspiralChooseFDWaveformFromCache(&hptildeC, &hctildeC,
+            phiref1, df, 1.5 * m1, m2, s1x, s1y, s1z, s2x, s2y, s2z, f_min,
+            f_max, f_ref, dist1, inc1, LALpars, approxFD, cache, NULL);
+    if( ret == XLAL_FAILURE )
+        XLAL_ERROR(XLAL_EFUNC);
+    XLALDestroyCOMPLEX16FrequencySeries(hptildeC);
+    XLALDestroyCOMPLEX16FrequencySeries(hctildeC);
+    hptildeC = hctildeC = NULL;
+
+    printf("Cache holds %u waveforms (%zu bytes): %llu hits, %llu transforms, %llu misses\n\n",
+            cache->nEntries, cache->bytes, (unsigned long long) cache->hits,
+            (unsigned long long) cache->transforms,
+            (unsigned long long) cache->misses);
+    if( cache->nEntries != 2 || cache->hits != 1 || cache->transforms != 1
+            || cache->misses != 5 ) {
+        fprintf(stderr, "FAILED: unexpected cache counters\n");
+        failed = 1;
+    }
+
+    // SEOBNRv1 ignores the amplitude order, so a change of phiRef is
+    // transformed even when a nonzero one is given
+    XLALSimInspiralWaveformCacheClear(cache);
+    XLALSimInspiralWaveformParamsInsertTidalLambda1(LALpars, 0.);
+    XLALSimInspiralWaveformParamsInsertPNAmplitudeOrder(LALpars, 3);
+    ret = XLALSimInspiralChooseTDWaveformFromCache(&hplusC, &hcrossC, phiref1,
+        dt, m1, m2, s1x, s1y, s1z, s2x, s2y, s2z, f_min, f_ref, dist1, inc1,
+        LALpars, approx, cache);
+    if( ret == XLAL_FAILURE )
+        XLAL_ERROR(XLAL_EFUNC);
+    XLALDestroyREAL8TimeSeries(hplusC);
+    XLALDestroyREAL8TimeSeries(hcrossC);
+    hplusC = hcrossC = NULL;
+    ret = XLALSimInspiralChooseTDWaveformFromCache(&hplusC, &hcrossC, phiref2,
+        dt, m1, m2, s1x, s1y, s1z, s2x, s2y, s2z, f_min, f_ref, dist1, inc1,
+        LALpars, approx, cache);
+    if( ret == XLAL_FAILURE )
+        XLAL_ERROR(XLAL_EFUNC);
+    XLALDestroyREAL8TimeSeries(hplusC);
+    XLALDestroyREAL8TimeSeries(hcrossC);
+    hplusC = hcrossC = NULL;
+    if( cache->transforms != 2 ) {
+        fprintf(stderr, "FAILED: SEOBNRv1 with ampO=3 was not transformed\n");
+        failed = 1;
+    }
+
+    XLALDestroyDict(LALpars);
     XLALDestroySimInspiralWaveformCache(cache);
     LALCheckMemoryLeaks();
 
-    return 0;
+    return failed;
 }